@@ -0,0 +1,46 @@
+#include "sensor_sim/beam_scanner.h"
+#include <benchmark/benchmark.h>
+
+using namespace nng;
+
+namespace {
+
+std::vector<WorldObject> make_objects(std::size_t n) {
+    std::vector<WorldObject> objects(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        objects[i].id = static_cast<uint32_t>(i + 1);
+        objects[i].azimuth_deg = static_cast<double>((i * 7919) % 36000) / 100.0;
+        objects[i].range_m = 1000.0 + static_cast<double>(i % 40000);
+    }
+    return objects;
+}
+
+} // anonymous namespace
+
+// Rebuilding the index from the world, as every scanning tick does
+void BM_AzimuthIndexBuild(benchmark::State& state) {
+    auto objects = make_objects(static_cast<std::size_t>(state.range(0)));
+    AzimuthIndex index;
+    for (auto _ : state) {
+        index.build(objects);
+        benchmark::DoNotOptimize(index.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AzimuthIndexBuild)->Arg(1000)->Arg(10000);
+
+// One 50 Hz tick of a 12 rpm, 3 degree beam: build plus the painted sector
+void BM_BeamTick(benchmark::State& state) {
+    auto objects = make_objects(static_cast<std::size_t>(state.range(0)));
+    AzimuthIndex index;
+    BeamScanner beam;
+    std::vector<WorldObject> painted;
+    for (auto _ : state) {
+        index.build(objects);
+        beam.advance(0.02);
+        beam.select(index, objects, painted);
+        benchmark::DoNotOptimize(painted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BeamTick)->Arg(1000)->Arg(10000);
@@ -0,0 +1,50 @@
+#include "control_node/command_handler.h"
+#include "gateway/stats_manager.h"
+#include "common/logger.h"
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// Parse and dispatch of one command, answer included; the commands a
+// dashboard polls, plus a SET and an unknown verb
+void BM_HandleCommand(benchmark::State& state) {
+    static const char* COMMANDS[] = {"GET HEALTH", "get stats", "GET RATES 7",
+                                     "SET CRC=ON", "FROB X"};
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    StatsManager stats;
+    stats.record_rx(7, 1, 1000);
+    CommandHandler handler(stats, Logger::instance());
+    handler.set_stats_max_age_ms(60000); // measure the handler, not snapshot builds
+    const char* cmd = COMMANDS[state.range(0)];
+    for (auto _ : state)
+        benchmark::DoNotOptimize(handler.handle(cmd));
+    state.SetLabel(cmd);
+}
+BENCHMARK(BM_HandleCommand)->DenseRange(0, 4);
+
+// A health sweep as one BATCH, answered into a reused output buffer
+void BM_RespondBatch(benchmark::State& state) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    StatsManager stats;
+    CommandHandler handler(stats, Logger::instance());
+    std::string batch = "BATCH";
+    for (int i = 0; i < state.range(0); ++i)
+        batch += "\nGET HEALTH";
+    std::vector<uint8_t> out;
+    for (auto _ : state) {
+        out.clear();
+        handler.respond(batch, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * state.range(0)));
+}
+BENCHMARK(BM_RespondBatch)->Arg(16)->Arg(256);
+
+} // anonymous namespace
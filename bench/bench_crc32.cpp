@@ -0,0 +1,48 @@
+#include "common/crc32.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// Throughput of one implementation at one buffer size; bytes_per_second
+// in the output is the GB/s figure
+void BM_Crc32(benchmark::State& state, Crc32Impl impl) {
+    if (!crc32_impl_supported(impl)) {
+        state.SkipWithError("not supported on this CPU");
+        return;
+    }
+    std::vector<uint8_t> buf(static_cast<std::size_t>(state.range(0)));
+    for (std::size_t i = 0; i < buf.size(); ++i)
+        buf[i] = static_cast<uint8_t>(i * 31u);
+
+    uint32_t crc = 0;
+    for (auto _ : state) {
+        crc = crc32_update_with(impl, crc, buf.data(), buf.size());
+        benchmark::DoNotOptimize(crc);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buf.size()));
+}
+
+// 43 bytes is a TRACK frame; 1046 is the largest frame
+#define NNG_CRC_SIZES ->Arg(43)->Arg(256)->Arg(1046)->Arg(64 << 10)
+
+BENCHMARK_CAPTURE(BM_Crc32, table, Crc32Impl::TABLE) NNG_CRC_SIZES;
+BENCHMARK_CAPTURE(BM_Crc32, slice8, Crc32Impl::SLICE8) NNG_CRC_SIZES;
+BENCHMARK_CAPTURE(BM_Crc32, slice16, Crc32Impl::SLICE16) NNG_CRC_SIZES;
+BENCHMARK_CAPTURE(BM_Crc32, pclmul, Crc32Impl::PCLMUL) NNG_CRC_SIZES;
+BENCHMARK_CAPTURE(BM_Crc32, armv8, Crc32Impl::ARMV8) NNG_CRC_SIZES;
+
+// What crc32() dispatches to on this machine
+void BM_Crc32Active(benchmark::State& state) {
+    std::vector<uint8_t> buf(static_cast<std::size_t>(state.range(0)), 0x5A);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(crc32(buf.data(), buf.size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buf.size()));
+    state.SetLabel(crc32_impl_name(crc32_active_impl()));
+}
+BENCHMARK(BM_Crc32Active) NNG_CRC_SIZES;
+
+} // anonymous namespace
@@ -0,0 +1,407 @@
+// End-to-end pipeline harness: an open-loop LoadGenerator (plus an optional
+// FaultInjector) sending into a live Gateway, over loopback UDP or an
+// in-process MemoryFrameChannel. For each configuration it sweeps the
+// offered load and reports what the gateway took in, the loss and the
+// sender->processing latency, then the saturation throughput (most frames
+// per second received) and the loss onset (lowest offered rate losing
+// more than --loss-threshold percent).
+//
+// Not a Google Benchmark suite: every step runs a whole gateway for
+// --step seconds, as one measurement.
+
+#include "common/crc32.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "gateway/udp_socket.h"
+#include "sensor_sim/fault_injector.h"
+#include "sensor_sim/frame_arena.h"
+#include "sensor_sim/load_generator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+enum class Transport { MEMORY, UDP };
+
+const char* transport_name(Transport t) {
+    return t == Transport::MEMORY ? "memory" : "udp";
+}
+
+struct RunConfig {
+    bool crc = false;
+    bool record = false;
+    Severity log_level = Severity::WARN;
+};
+
+std::string config_name(const RunConfig& c) {
+    std::string level = severity_str(c.log_level);
+    level.erase(level.find_last_not_of(' ') + 1); // padded for the log columns
+    return std::string("crc=") + (c.crc ? "on" : "off") +
+           " record=" + (c.record ? "on" : "off") + " log=" + level;
+}
+
+struct Options {
+    std::vector<double> rates = {5000, 10000, 20000, 50000, 100000, 200000};
+    double step_s = 1.0;
+    std::vector<Transport> transports = {Transport::MEMORY, Transport::UDP};
+    bool matrix = false;     // every crc x record x log combination
+    uint16_t port = 5600;
+    double loss_pct = 0.0;   // FaultInjector loss on the sender
+    double loss_threshold_pct = 0.1;
+    std::size_t channel_capacity = 4096;
+    RngMode rng = RngMode::FAST;
+};
+
+struct StepResult {
+    double offered_fps = 0.0;
+    double sent_fps = 0.0;     // what the sender got out
+    double received_fps = 0.0; // frames the gateway counted, over the send time
+    uint64_t sent = 0;         // after the injector
+    uint64_t received = 0;
+    double loss_pct = 0.0;     // of sent
+    HistogramSnapshot latency; // sender ts_ns -> gateway dequeue, ns
+};
+
+// Discards everything written to it: log formatting is still paid for
+class NullBuf : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+uint64_t steady_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t wall_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// What the sender's frames pass through before the transport: the fault
+// injector when loss is configured, then a CRC32 appended to every frame
+// (the simulator sends v1 frames without one)
+class SenderSink : public IFrameSink {
+public:
+    SenderSink(IFrameSink& out, bool crc, FaultInjector* injector)
+        : out_(out), crc_(crc), injector_(injector) {}
+
+    bool send(const std::vector<uint8_t>& buf) override {
+        FrameView v{buf.data(), buf.size()};
+        return send_batch(&v, 1) == 1;
+    }
+
+    std::size_t send_batch(const FrameView* frames, std::size_t count) override {
+        const FrameView* views = frames;
+        if (injector_ || crc_) {
+            arena_.clear();
+            for (std::size_t i = 0; i < count; ++i) {
+                std::size_t len = frames[i].len;
+                uint8_t* p = arena_.append(len + (crc_ ? FRAME_CRC_SIZE : 0));
+                std::memcpy(p, frames[i].data, len);
+                if (crc_) {
+                    uint32_t crc = crc32(p, len);
+                    std::memcpy(p + len, &crc, sizeof(crc));
+                }
+            }
+            if (injector_) {
+                injector_->apply(arena_, sends_);
+                views = sends_.data();
+                count = sends_.size();
+            } else {
+                views = arena_.views();
+            }
+        }
+        std::size_t n = out_.send_batch(views, count);
+        sent_ += count;
+        return n;
+    }
+
+    // Frames handed to the transport (after losses)
+    uint64_t sent() const { return sent_; }
+
+private:
+    IFrameSink& out_;
+    bool crc_;
+    FaultInjector* injector_;
+    FrameArena arena_;
+    std::vector<FrameView> sends_;
+    uint64_t sent_ = 0;
+};
+
+std::vector<WorldObject> make_objects(std::size_t n) {
+    std::vector<WorldObject> objects(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        WorldObject& o = objects[i];
+        o.id = static_cast<uint32_t>(i + 1);
+        o.classification = TrackClass::FIXED_WING;
+        o.spawn_time_s = 0.0;
+        o.lifetime_s = 1e9;
+        o.azimuth_deg = static_cast<double>(i) * 360.0 / static_cast<double>(n);
+        o.elevation_deg = 5.0;
+        o.range_m = 10000.0 + 100.0 * static_cast<double>(i);
+        o.speed_mps = 200.0;
+        o.heading_deg = 90.0;
+        o.rcs_dbsm = 10.0;
+        o.is_hostile = false;
+        o.noise_stddev = 1.0;
+    }
+    return objects;
+}
+
+// Gateway rx_total stops moving for 100 ms, or 2 s pass
+void wait_drained(Gateway& gateway) {
+    uint64_t last = gateway.stats().get_global_stats().rx_total;
+    for (int quiet = 0, waited = 0; quiet < 10 && waited < 200; ++waited) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        uint64_t now = gateway.stats().get_global_stats().rx_total;
+        quiet = now == last ? quiet + 1 : 0;
+        last = now;
+    }
+}
+
+bool run_step(const Options& opt, Transport transport, const RunConfig& cfg, double rate,
+              const std::string& record_path, StepResult& out) {
+    GatewayConfig gw;
+    gw.crc_enabled = cfg.crc;
+    gw.record_enabled = cfg.record;
+    gw.record_path = record_path;
+    gw.log_level = cfg.log_level;
+    gw.udp_port = opt.port;
+
+    std::unique_ptr<MemoryFrameChannel> channel;
+    std::unique_ptr<UdpFrameSink> udp;
+    if (transport == Transport::MEMORY) {
+        channel = std::make_unique<MemoryFrameChannel>(opt.channel_capacity);
+        MemoryFrameChannel* ch = channel.get();
+        gw.source_factory = [ch](std::size_t) { return ch->source(10); };
+    }
+
+    Gateway gateway(gw);
+    std::thread gateway_thread([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (!gateway.is_running()) {
+        gateway.stop();
+        gateway_thread.join();
+        return false;
+    }
+
+    IFrameSink* transport_sink = nullptr;
+    if (channel) {
+        transport_sink = &channel->sink();
+    } else {
+        udp = std::make_unique<UdpFrameSink>();
+        if (!udp->connect("127.0.0.1", opt.port)) {
+            gateway.stop();
+            gateway_thread.join();
+            return false;
+        }
+        transport_sink = udp.get();
+    }
+
+    std::unique_ptr<FaultInjector> injector;
+    if (opt.loss_pct > 0.0) {
+        FaultConfig faults;
+        faults.loss_pct = opt.loss_pct;
+        injector = std::make_unique<FaultInjector>(faults, 200, opt.rng);
+    }
+    SenderSink sink(*transport_sink, cfg.crc, injector.get());
+
+    LoadOptions lo;
+    lo.rate_fps = rate;
+    lo.duration_s = opt.step_s;
+    lo.rng = opt.rng;
+    LoadGenerator load(lo, 1, 100);
+    const std::vector<WorldObject> objects = make_objects(64);
+
+    load.start(steady_now_ns(), wall_now_ns());
+    while (!load.done()) {
+        uint64_t now = steady_now_ns();
+        if (load.send_due(objects, now, sink) > 0)
+            continue;
+        uint64_t wake = load.next_due_ns();
+        if (wake > now)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wake - now));
+    }
+    LoadStats ls = load.stats();
+
+    wait_drained(gateway);
+    gateway.stop();
+    gateway_thread.join();
+
+    GlobalStats g = gateway.stats().get_global_stats();
+    double send_s = static_cast<double>(ls.elapsed_ns) / 1e9;
+    out.offered_fps = rate;
+    out.sent_fps = ls.achieved_fps();
+    out.sent = sink.sent();
+    out.received = g.rx_total;
+    out.received_fps = send_s > 0.0 ? static_cast<double>(g.rx_total) / send_s : 0.0;
+    out.loss_pct = out.sent > out.received
+        ? 100.0 * static_cast<double>(out.sent - out.received) / static_cast<double>(out.sent)
+        : 0.0;
+    out.latency = gateway.stats().get_all_source_latency().latency;
+    std::remove(record_path.c_str());
+    return true;
+}
+
+void print_header() {
+    std::cout << std::setw(10) << "offered/s" << std::setw(11) << "sent/s"
+              << std::setw(11) << "received/s" << std::setw(8) << "loss%"
+              << std::setw(9) << "p50us" << std::setw(9) << "p99us"
+              << std::setw(10) << "p99.9us" << std::setw(10) << "maxus" << "\n";
+}
+
+void print_step(const StepResult& r) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::cout << std::fixed << std::setprecision(0)
+              << std::setw(10) << r.offered_fps << std::setw(11) << r.sent_fps
+              << std::setw(11) << r.received_fps
+              << std::setprecision(2) << std::setw(8) << r.loss_pct
+              << std::setprecision(1)
+              << std::setw(9) << us(r.latency.percentile(0.50))
+              << std::setw(9) << us(r.latency.percentile(0.99))
+              << std::setw(10) << us(r.latency.percentile(0.999))
+              << std::setw(10) << us(r.latency.max) << "\n";
+}
+
+bool parse_rates(const std::string& list, std::vector<double>& out) {
+    out.clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        double v = std::strtod(item.c_str(), &end);
+        if (end == item.c_str() || *end != '\0' || v <= 0.0)
+            return false;
+        out.push_back(v);
+    }
+    return !out.empty();
+}
+
+void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --rates <a,b,...>      Offered loads, frames/s (default 5000,...,200000)\n"
+              << "  --step <seconds>       Send time per load step (default 1)\n"
+              << "  --transport <t>        memory, udp or both (default both)\n"
+              << "  --matrix               Every crc x record x log combination\n"
+              << "                         (default: baseline, then one change at a time)\n"
+              << "  --port <port>          Loopback UDP port (default 5600)\n"
+              << "  --loss <pct>           Sender-side FaultInjector loss (default 0)\n"
+              << "  --loss-threshold <pct> Loss counted as onset (default 0.1)\n"
+              << "  --channel <frames>     MemoryFrameChannel capacity (default 4096)\n"
+              << "  --std-rng              Simulator std::mt19937 instead of the fast engine\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--rates" && has_value) {
+            if (!parse_rates(argv[++i], opt.rates)) {
+                std::cerr << "Bad --rates list\n";
+                return 1;
+            }
+        } else if (arg == "--step" && has_value) {
+            opt.step_s = std::atof(argv[++i]);
+        } else if (arg == "--transport" && has_value) {
+            std::string t = argv[++i];
+            if (t == "memory")
+                opt.transports = {Transport::MEMORY};
+            else if (t == "udp")
+                opt.transports = {Transport::UDP};
+            else if (t != "both") {
+                std::cerr << "Unknown transport: " << t << "\n";
+                return 1;
+            }
+        } else if (arg == "--matrix") {
+            opt.matrix = true;
+        } else if (arg == "--port" && has_value) {
+            opt.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--loss" && has_value) {
+            opt.loss_pct = std::atof(argv[++i]);
+        } else if (arg == "--loss-threshold" && has_value) {
+            opt.loss_threshold_pct = std::atof(argv[++i]);
+        } else if (arg == "--channel" && has_value) {
+            opt.channel_capacity = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else if (arg == "--std-rng") {
+            opt.rng = RngMode::STD;
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opt.step_s <= 0.0) {
+        std::cerr << "--step must be positive\n";
+        return 1;
+    }
+
+    std::vector<RunConfig> configs;
+    if (opt.matrix) {
+        for (int crc = 0; crc < 2; ++crc)
+            for (int rec = 0; rec < 2; ++rec)
+                for (Severity lvl : {Severity::WARN, Severity::DEBUG})
+                    configs.push_back(RunConfig{crc != 0, rec != 0, lvl});
+    } else {
+        configs.push_back(RunConfig{});
+        configs.push_back(RunConfig{true, false, Severity::WARN});
+        configs.push_back(RunConfig{false, true, Severity::WARN});
+        configs.push_back(RunConfig{false, false, Severity::DEBUG});
+    }
+
+    // Gateway logging goes nowhere; the events are still formatted
+    NullBuf null_buf;
+    std::ostream null_out(&null_buf);
+    Logger::instance().set_output(null_out);
+
+    const std::string record_path = "/tmp/nng_bench_e2e_" + std::to_string(getpid()) + ".bin";
+
+    for (Transport transport : opt.transports) {
+        for (const RunConfig& cfg : configs) {
+            std::cout << "\n=== " << transport_name(transport) << " " << config_name(cfg) << " ===\n";
+            print_header();
+            double saturation = 0.0;
+            double onset = 0.0;
+            for (double rate : opt.rates) {
+                StepResult r;
+                if (!run_step(opt, transport, cfg, rate, record_path, r)) {
+                    std::cerr << "Could not start the gateway over " << transport_name(transport) << "\n";
+                    return 1;
+                }
+                print_step(r);
+                if (r.received_fps > saturation)
+                    saturation = r.received_fps;
+                if (onset == 0.0 && r.loss_pct > opt.loss_threshold_pct)
+                    onset = rate;
+            }
+            std::cout << std::setprecision(0) << "Saturation: " << saturation << " frames/s, loss onset: ";
+            if (onset > 0.0)
+                std::cout << onset << " frames/s offered\n";
+            else
+                std::cout << "none up to " << opt.rates.back() << " frames/s\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "common/event_bus.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+using namespace nng;
+
+namespace {
+
+EventRecord make_event() {
+    EventRecord ev{};
+    ev.id = EventId::EVT_TRACK_UPDATE;
+    ev.category = EventCategory::TRACKING;
+    ev.severity = Severity::INFO;
+    ev.timestamp_ns = 1;
+    ev.fields.kind = EventDetail::Kind::TRACK;
+    ev.fields.src_id = 1;
+    ev.fields.track = {42, 1, 2};
+    return ev;
+}
+
+// publish() to range(0) plain subscribers of the event's category (0:
+// nobody listening, the cost a hot path pays for an unwatched event)
+void BM_EventBusPublish(benchmark::State& state) {
+    EventBus bus;
+    uint64_t seen = 0;
+    for (int64_t i = 0; i < state.range(0); ++i)
+        bus.subscribe(EventCategory::TRACKING, [&seen](const EventRecord&) { ++seen; });
+    EventRecord ev = make_event();
+    for (auto _ : state)
+        bus.publish(ev);
+    benchmark::DoNotOptimize(seen);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_EventBusPublish)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+// One async subscriber that drops on overflow: publish() is a queue push
+void BM_EventBusPublishAsync(benchmark::State& state) {
+    EventBus bus;
+    bus.subscribe_async(EventCategory::TRACKING, [](const EventRecord&) {});
+    EventRecord ev = make_event();
+    for (auto _ : state)
+        bus.publish(ev);
+    bus.flush();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_EventBusPublishAsync)->UseRealTime();
+
+} // anonymous namespace
@@ -0,0 +1,60 @@
+#include "common/logger.h"
+#include <benchmark/benchmark.h>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+using namespace nng;
+
+namespace {
+
+// Accepts and discards everything, so only formatting is measured
+class NullBuf : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuf g_null_buf;
+std::ostream g_null_out(&g_null_buf);
+
+// log() at INFO with the logger set to range(0) (a Severity): DEBUG/INFO
+// format and write the line, WARN and above filter it out
+void BM_LoggerLog(benchmark::State& state) {
+    Logger& log = Logger::instance();
+    log.set_output(g_null_out);
+    log.set_level(static_cast<Severity>(state.range(0)));
+    const std::string name = "EVT_TRACK_UPDATE";
+    const std::string detail = "src_id=1 track_id=42 range_m=12000";
+    for (auto _ : state)
+        log.log(Severity::INFO, EventCategory::TRACKING, name, detail);
+    log.set_level(Severity::INFO);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_LoggerLog)
+    ->Arg(static_cast<int>(Severity::DEBUG))
+    ->Arg(static_cast<int>(Severity::WARN))
+    ->ArgName("level");
+
+// Typed detail, synchronous then async (formatting moves to the writer)
+void BM_LoggerLogEvent(benchmark::State& state) {
+    Logger& log = Logger::instance();
+    log.set_output(g_null_out);
+    log.set_level(Severity::DEBUG);
+    bool async = state.range(0) != 0;
+    if (async)
+        log.start_async();
+    EventDetail detail;
+    detail.kind = EventDetail::Kind::TRACK;
+    detail.src_id = 1;
+    detail.track = {42, 1, 2};
+    for (auto _ : state)
+        log.log_event(Severity::INFO, EventCategory::TRACKING, EventId::EVT_TRACK_UPDATE, detail);
+    if (async)
+        log.stop_async();
+    log.set_level(Severity::INFO);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_LoggerLogEvent)->Arg(0)->Arg(1)->ArgName("async")->UseRealTime();
+
+} // anonymous namespace
@@ -0,0 +1,47 @@
+#include "sensor_sim/measurement_generator.h"
+#include <benchmark/benchmark.h>
+
+using namespace nng;
+
+namespace {
+
+std::vector<WorldObject> make_objects(std::size_t n) {
+    std::vector<WorldObject> objects;
+    objects.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        WorldObject obj{};
+        obj.id = static_cast<uint32_t>(i + 1);
+        obj.classification = TrackClass::FIXED_WING;
+        obj.lifetime_s = 1e9;
+        obj.azimuth_deg = static_cast<double>(i % 360);
+        obj.elevation_deg = 5.0;
+        obj.range_m = 5000.0 + static_cast<double>(i % 30000);
+        obj.speed_mps = 200.0;
+        obj.rcs_dbsm = static_cast<double>(i % 30) - 10.0;
+        obj.noise_stddev = 10.0;
+        objects.push_back(obj);
+    }
+    return objects;
+}
+
+void run_tick(benchmark::State& state, RngMode mode) {
+    auto objects = make_objects(static_cast<std::size_t>(state.range(0)));
+    MeasurementGenerator mg(1, 42, mode);
+    FrameArena arena;
+    uint64_t ts = 0;
+    for (auto _ : state) {
+        arena.clear();
+        mg.generate_tracks(objects, ++ts, arena);
+        mg.generate_plots(objects, ts, arena);
+        benchmark::DoNotOptimize(arena.bytes());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // anonymous namespace
+
+// One tick's tracks and plots into an arena, per RNG mode
+void BM_MeasureTickStd(benchmark::State& state) { run_tick(state, RngMode::STD); }
+void BM_MeasureTickFast(benchmark::State& state) { run_tick(state, RngMode::FAST); }
+BENCHMARK(BM_MeasureTickStd)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_MeasureTickFast)->Arg(1000)->Arg(10000);
@@ -0,0 +1,76 @@
+#include "gateway/plot_associator.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// range(0) live tracks from one sensor spread over 360 deg x 100 km, and
+// a plot near a random one of them per iteration, as a stress picture
+// would send (each plot also sees the tracks around it)
+void BM_AssociatePlot(benchmark::State& state) {
+    const uint32_t live = static_cast<uint32_t>(state.range(0));
+    AssociationOptions o;
+    o.capacity = live;
+    o.ttl_ms = 0;
+    PlotAssociator a(o);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int32_t> az(0, 359999);
+    std::uniform_int_distribution<uint32_t> range(1000, 100000);
+    std::vector<PlotPayload> plots(4096);
+    std::vector<TrackPayload> tracks(live);
+    for (uint32_t id = 0; id < live; ++id) {
+        tracks[id] = TrackPayload{};
+        tracks[id].track_id = id;
+        tracks[id].azimuth_mdeg = az(rng);
+        tracks[id].range_m = range(rng);
+        a.update(1, tracks[id], 0);
+    }
+    std::uniform_int_distribution<int32_t> noise(-300, 300);
+    for (std::size_t i = 0; i < plots.size(); ++i) {
+        const TrackPayload& t = tracks[rng() % live];
+        plots[i] = PlotPayload{};
+        plots[i].plot_id = static_cast<uint32_t>(i);
+        plots[i].azimuth_mdeg = t.azimuth_mdeg + noise(rng);
+        plots[i].range_m = t.range_m + noise(rng);
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        PlotView plot(reinterpret_cast<const uint8_t*>(&plots[i]));
+        benchmark::DoNotOptimize(a.associate(1, plot, 0));
+        i = (i + 1) & (plots.size() - 1);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["gated/plot"] =
+        static_cast<double>(a.stats().gated) / static_cast<double>(a.stats().plots);
+}
+BENCHMARK(BM_AssociatePlot)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// A track moving by a few metres per update, mostly within its cell
+void BM_AssociatorUpdate(benchmark::State& state) {
+    const uint32_t live = static_cast<uint32_t>(state.range(0));
+    AssociationOptions o;
+    o.capacity = live;
+    o.ttl_ms = 0;
+    PlotAssociator a(o);
+    TrackPayload t{};
+    uint32_t i = 0;
+    uint32_t pass = 0;
+    for (auto _ : state) {
+        t.track_id = i;
+        t.azimuth_mdeg = static_cast<int32_t>((i * 7919u) % 360000u);
+        t.range_m = 1000 + (i * 104729u) % 99000u + pass;
+        benchmark::DoNotOptimize(a.update(1, t, 0));
+        if (++i == live) {
+            i = 0;
+            pass += 50;
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_AssociatorUpdate)->Arg(10000);
+
+} // anonymous namespace
@@ -0,0 +1,79 @@
+#include "common/spsc_ring.h"
+#include "common/mpsc_queue.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// Push/pop on one thread: the cost of the ring operations themselves
+template <typename Q>
+void BM_SingleThreadRoundTrip(benchmark::State& state) {
+    Q q(1024);
+    uint64_t v = 0;
+    for (auto _ : state) {
+        q.try_push(v);
+        q.try_pop(v);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SingleThreadRoundTrip, SpscRing<uint64_t>);
+BENCHMARK_TEMPLATE(BM_SingleThreadRoundTrip, MpscQueue<uint64_t>);
+
+// One producer thread, one consumer thread; batch size from the argument
+template <typename Q>
+void BM_ProducerConsumer(benchmark::State& state) {
+    const std::size_t batch = static_cast<std::size_t>(state.range(0));
+    const uint64_t items = 1 << 20;
+    for (auto _ : state) {
+        Q q(4096);
+        std::thread producer([&]() {
+            std::vector<uint64_t> buf(batch);
+            uint64_t sent = 0;
+            while (sent < items) {
+                std::size_t want = std::min<uint64_t>(batch, items - sent);
+                sent += q.try_push_n(buf.data(), want);
+            }
+        });
+        std::vector<uint64_t> out(batch);
+        uint64_t received = 0;
+        while (received < items)
+            received += q.try_pop_n(out.data(), batch);
+        producer.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+}
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, SpscRing<uint64_t>)->Arg(1)->Arg(16)->Arg(64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, MpscQueue<uint64_t>)->Arg(1)->Arg(16)->Arg(64)->UseRealTime();
+
+// Four producers into one MPSC consumer
+void BM_MpscFanIn(benchmark::State& state) {
+    const int producers = 4;
+    const uint64_t per_producer = 1 << 18;
+    for (auto _ : state) {
+        MpscQueue<uint64_t> q(4096);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&]() {
+                uint64_t sent = 0;
+                while (sent < per_producer)
+                    sent += q.try_push(sent) ? 1 : 0;
+            });
+        }
+        uint64_t v = 0;
+        uint64_t received = 0;
+        while (received < producers * per_producer)
+            received += q.try_pop(v) ? 1 : 0;
+        for (auto& t : threads)
+            t.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * producers * per_producer));
+}
+BENCHMARK(BM_MpscFanIn)->UseRealTime();
+
+} // anonymous namespace
@@ -0,0 +1,46 @@
+#include "gateway/sequence_tracker.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// In-order frames round-robin over range(0) active sources, spread over
+// the src_id space the way sensor ids are assigned in practice
+void BM_Track(benchmark::State& state, SeqStorage storage) {
+    const std::size_t sources = static_cast<std::size_t>(state.range(0));
+    std::vector<uint16_t> ids(sources);
+    for (std::size_t i = 0; i < sources; ++i)
+        ids[i] = static_cast<uint16_t>(i * 40503u); // odd multiplier: all distinct
+    std::vector<uint32_t> seqs(sources, 0);
+
+    SequenceTracker tracker(storage);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        SeqEvent ev = tracker.track(ids[i], seqs[i]++);
+        benchmark::DoNotOptimize(ev);
+        if (++i == sources)
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_Track, flat, SeqStorage::FLAT)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_Track, hash_map, SeqStorage::HASH_MAP)->Arg(1)->Arg(100)->Arg(10000);
+
+// One source losing every other frame, for window sizes range(0): each
+// gap advances the ring by two bits
+void BM_TrackGaps(benchmark::State& state) {
+    SequenceTracker tracker(SeqStorage::FLAT, static_cast<std::size_t>(state.range(0)));
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        SeqEvent ev = tracker.track(1, seq);
+        benchmark::DoNotOptimize(ev);
+        seq += 2;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TrackGaps)->Arg(64)->Arg(1024)->Arg(4096);
+
+} // anonymous namespace
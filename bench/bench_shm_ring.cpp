@@ -0,0 +1,47 @@
+#include "gateway/shm_ring.h"
+#include "common/protocol.h"
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+std::string bench_ring_name() { return "nng-bench-" + std::to_string(::getpid()); }
+
+// One sender and the receiver on the same thread: range(0) frames pushed
+// in one send_batch() and taken back in one receive_batch(), i.e. the
+// per-frame cost of the ring itself (copy in, publish, view out)
+void BM_ShmRingBatch(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::string name = bench_ring_name();
+    ShmFrameSource source;
+    ShmFrameSink sink;
+    if (!source.open(name, 4096) || !sink.connect(name)) {
+        state.SkipWithError("shm ring unavailable");
+        return;
+    }
+    source.set_timeout_ms(0);
+
+    std::vector<uint8_t> frame(FRAME_HEADER_SIZE + sizeof(TrackPayload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::TRACK);
+    hdr.payload_len = sizeof(TrackPayload);
+    serialize_header(hdr, frame.data());
+    std::vector<FrameView> views(n, FrameView{frame.data(), frame.size()});
+    FrameBatch batch(n);
+
+    for (auto _ : state) {
+        sink.send_batch(views.data(), n);
+        benchmark::DoNotOptimize(source.receive_batch(batch));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * frame.size()));
+}
+BENCHMARK(BM_ShmRingBatch)->Arg(1)->Arg(64);
+
+} // anonymous namespace
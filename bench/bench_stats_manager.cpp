@@ -0,0 +1,49 @@
+#include "gateway/stats_manager.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// src_ids spread over the id space like sensor ids
+std::vector<uint16_t> source_ids(std::size_t n) {
+    std::vector<uint16_t> ids(n);
+    for (std::size_t i = 0; i < n; ++i)
+        ids[i] = static_cast<uint16_t>(1 + i * 40503u);
+    return ids;
+}
+
+template <typename Recorder>
+void run_record_rx(benchmark::State& state, Recorder& rec) {
+    auto ids = source_ids(static_cast<std::size_t>(state.range(0)));
+    std::vector<uint32_t> seqs(ids.size(), 0);
+    uint64_t ts = 1000000000ULL;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        ts += 1000;
+        rec.record_rx(ids[i], seqs[i]++, ts, ts - 500);
+        if (++i == ids.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// record_rx() on the manager itself (under its lock), round-robin over
+// range(0) sources, with a sender timestamp so the histograms are fed too
+void BM_StatsRecordRx(benchmark::State& state) {
+    StatsManager stats;
+    run_record_rx(state, stats);
+}
+BENCHMARK(BM_StatsRecordRx)->Arg(1)->Arg(16)->Arg(1024);
+
+// Same through a writer shard, as the ingest workers do (no lock)
+void BM_StatsShardRecordRx(benchmark::State& state) {
+    StatsManager stats;
+    stats.set_writer_shards(1);
+    run_record_rx(state, stats.shard(0));
+}
+BENCHMARK(BM_StatsShardRecordRx)->Arg(1)->Arg(16)->Arg(1024);
+
+} // anonymous namespace
@@ -0,0 +1,76 @@
+#include "control_node/tcp_framer.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// A stream of frames of state.range(0) bytes, fed in TCP-segment-sized
+// reads of state.range(1) bytes and popped as views; bytes_per_second is
+// the framing throughput
+void BM_FramerFeedPop(benchmark::State& state) {
+    auto frame_len = static_cast<std::size_t>(state.range(0));
+    auto read_len = static_cast<std::size_t>(state.range(1));
+    std::vector<uint8_t> stream;
+    while (stream.size() < (256u << 10))
+        TcpFramer::encode_append(std::string(frame_len, 'x'), stream);
+
+    TcpFramer framer;
+    std::size_t frames = 0;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < stream.size(); i += read_len) {
+            framer.feed(stream.data() + i, std::min(read_len, stream.size() - i));
+            while (framer.has_frame()) {
+                benchmark::DoNotOptimize(framer.pop_view().data());
+                ++frames;
+            }
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+    state.SetItemsProcessed(static_cast<int64_t>(frames));
+}
+// GET STATS-sized commands, typical responses, large responses; 1448 is
+// one Ethernet segment, 16 KiB one ControlNode read
+BENCHMARK(BM_FramerFeedPop)
+    ->Args({16, 1448})->Args({16, 16384})
+    ->Args({512, 1448})->Args({512, 16384})
+    ->Args({16384, 16384});
+
+// Same, copying each frame out (pop_frame)
+void BM_FramerFeedPopCopy(benchmark::State& state) {
+    auto frame_len = static_cast<std::size_t>(state.range(0));
+    std::vector<uint8_t> stream;
+    while (stream.size() < (256u << 10))
+        TcpFramer::encode_append(std::string(frame_len, 'x'), stream);
+
+    TcpFramer framer;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < stream.size(); i += 16384) {
+            framer.feed(stream.data() + i, std::min<std::size_t>(16384, stream.size() - i));
+            while (framer.has_frame())
+                benchmark::DoNotOptimize(framer.pop_frame());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+BENCHMARK(BM_FramerFeedPopCopy)->Arg(16)->Arg(512);
+
+// Encoding responses into one reused output buffer
+void BM_FramerEncodeAppend(benchmark::State& state) {
+    std::string payload(static_cast<std::size_t>(state.range(0)), 'y');
+    std::vector<uint8_t> out;
+    for (auto _ : state) {
+        out.clear();
+        for (int i = 0; i < 64; ++i)
+            TcpFramer::encode_append(payload, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 64 * payload.size()));
+}
+BENCHMARK(BM_FramerEncodeAppend)->Arg(16)->Arg(512)->Arg(16384);
+
+} // anonymous namespace
@@ -0,0 +1,103 @@
+#include "gateway/telemetry_parser.h"
+#include "common/crc32.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// A PLOT-typed frame with range(0) payload bytes (+ CRC when with_crc)
+std::vector<uint8_t> make_frame(std::size_t payload_len, bool with_crc, uint32_t seq = 0) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + payload_len + (with_crc ? FRAME_CRC_SIZE : 0));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::PLOT);
+    hdr.src_id = 1;
+    hdr.seq = seq;
+    hdr.payload_len = static_cast<uint16_t>(payload_len);
+    serialize_header(hdr, buf.data());
+    for (std::size_t i = 0; i < payload_len; ++i)
+        buf[FRAME_HEADER_SIZE + i] = static_cast<uint8_t>(i);
+    if (with_crc) {
+        uint32_t crc = crc32(buf.data(), FRAME_HEADER_SIZE + payload_len);
+        std::memcpy(buf.data() + FRAME_HEADER_SIZE + payload_len, &crc, sizeof(crc));
+    }
+    return buf;
+}
+
+// One datagram at a time; range(0) payload bytes, range(1) CRC on/off
+void BM_ParseFrame(benchmark::State& state) {
+    bool with_crc = state.range(1) != 0;
+    auto frame = make_frame(static_cast<std::size_t>(state.range(0)), with_crc);
+    ParsedFrame pf;
+    for (auto _ : state) {
+        ParseError err = parse_frame(frame.data(), frame.size(), with_crc, pf);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(pf.payload_ptr);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+
+// A receive batch of 64 datagrams through parse_frames()
+void BM_ParseFrames(benchmark::State& state) {
+    bool with_crc = state.range(1) != 0;
+    constexpr std::size_t BATCH = 64;
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<FrameView> views;
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < BATCH; ++i)
+        frames.push_back(make_frame(static_cast<std::size_t>(state.range(0)), with_crc,
+                                    static_cast<uint32_t>(i)));
+    for (const auto& f : frames) {
+        views.push_back(FrameView{f.data(), f.size()});
+        bytes += f.size();
+    }
+    ParsedFrameBatch batch(BATCH);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(parse_frames(views.data(), views.size(), with_crc, batch));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+// Reading the three fields a TRACK event needs: whole-struct copy vs view
+void BM_TrackFieldsCopy(benchmark::State& state) {
+    uint8_t buf[64 * sizeof(TrackPayload)] = {};
+    for (auto _ : state) {
+        uint32_t sum = 0;
+        for (std::size_t i = 0; i < 64; ++i) {
+            TrackPayload t = deserialize_track(buf + i * sizeof(TrackPayload));
+            sum += t.track_id + t.classification + t.threat_level;
+        }
+        benchmark::DoNotOptimize(sum);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 64));
+}
+
+void BM_TrackFieldsView(benchmark::State& state) {
+    uint8_t buf[64 * sizeof(TrackPayload)] = {};
+    for (auto _ : state) {
+        uint32_t sum = 0;
+        for (std::size_t i = 0; i < 64; ++i) {
+            TrackView t(buf + i * sizeof(TrackPayload));
+            sum += t.track_id() + t.classification() + t.threat_level();
+        }
+        benchmark::DoNotOptimize(sum);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 64));
+}
+
+} // anonymous namespace
+
+// 21 bytes is a PLOT payload, 25 a TRACK, 1024 the largest
+#define NNG_PARSE_ARGS ->ArgsProduct({{21, 25, 256, 1024}, {0, 1}})->ArgNames({"payload", "crc"})
+
+BENCHMARK(BM_ParseFrame) NNG_PARSE_ARGS;
+BENCHMARK(BM_ParseFrames) NNG_PARSE_ARGS;
+BENCHMARK(BM_TrackFieldsCopy);
+BENCHMARK(BM_TrackFieldsView);
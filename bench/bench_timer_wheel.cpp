@@ -0,0 +1,56 @@
+#include "gateway/timer_wheel.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+constexpr uint64_t TICK_NS = 10'000'000;
+constexpr uint64_t TIMEOUT_NS = 5'000'000'000;
+
+// Re-arm on every frame, round-robin over range(0) live timers, time
+// moving 1 us per frame with an advance() per 64 frames (one rx batch):
+// what source timeouts and track expiry cost the ingest path
+void BM_TimerWheelRearm(benchmark::State& state) {
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    TimerWheel wheel(n, TICK_NS, 0);
+    std::vector<uint32_t> fired;
+    uint64_t now = 0;
+    for (uint32_t id = 0; id < n; ++id)
+        wheel.arm(id, TIMEOUT_NS);
+    uint32_t id = 0;
+    for (auto _ : state) {
+        now += 1000;
+        wheel.arm(id, now + TIMEOUT_NS);
+        if (++id == n)
+            id = 0;
+        if ((id & 63) == 0)
+            wheel.advance(now, fired);
+    }
+    benchmark::DoNotOptimize(fired.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_TimerWheelRearm)->Arg(100)->Arg(10000)->Arg(100000);
+
+// Arm range(0) timers and let them all expire, one by one in ticks
+void BM_TimerWheelExpire(benchmark::State& state) {
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    TimerWheel wheel(n, TICK_NS, 0);
+    std::vector<uint32_t> fired;
+    fired.reserve(n);
+    uint64_t now = 0;
+    for (auto _ : state) {
+        for (uint32_t id = 0; id < n; ++id)
+            wheel.arm(id, now + TIMEOUT_NS + id * 1000);
+        fired.clear();
+        now += TIMEOUT_NS + n * 1000;
+        wheel.advance(now, fired);
+        benchmark::DoNotOptimize(fired.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * n);
+}
+BENCHMARK(BM_TimerWheelExpire)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+} // anonymous namespace
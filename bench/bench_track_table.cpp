@@ -0,0 +1,52 @@
+#include "gateway/track_table.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+// range(0) live tracks over 16 sources, updated round-robin as a busy air
+// picture would be
+void BM_TrackTableUpdate(benchmark::State& state) {
+    const uint32_t live = static_cast<uint32_t>(state.range(0));
+    TrackTable table(TrackTable::DEFAULT_CAPACITY, 0);
+    TrackPayload t{};
+    t.threat_level = 2;
+    uint64_t ts = 0;
+    uint32_t i = 0;
+    for (auto _ : state) {
+        t.track_id = i / 16;
+        t.range_m = i;
+        benchmark::DoNotOptimize(table.update(static_cast<uint16_t>(i % 16), t, ++ts));
+        if (++i == live)
+            i = 0;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_TrackTableUpdate)->Arg(1000)->Arg(100000);
+
+// A full table scan into a snapshot, the GET TRACKS path
+void BM_TrackPictureSnapshot(benchmark::State& state) {
+    const uint32_t live = static_cast<uint32_t>(state.range(0));
+    TrackPicture picture(TrackTable::DEFAULT_CAPACITY, 0);
+    picture.set_writers(1);
+    TrackPayload t{};
+    for (uint32_t i = 0; i < live; ++i) {
+        t.track_id = i;
+        t.threat_level = static_cast<uint8_t>(i % 5);
+        picture.table(0).update(1, t, i);
+    }
+    std::vector<TrackRecord> out;
+    TrackQuery query;
+    query.min_threat = static_cast<uint8_t>(state.range(1));
+    for (auto _ : state) {
+        picture.snapshot(out, query);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * live);
+}
+BENCHMARK(BM_TrackPictureSnapshot)->Args({100000, 0})->Args({100000, 4})->Unit(benchmark::kMillisecond);
+
+} // anonymous namespace
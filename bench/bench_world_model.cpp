@@ -0,0 +1,50 @@
+#include "sensor_sim/world_model.h"
+#include <benchmark/benchmark.h>
+
+using namespace nng;
+
+namespace {
+
+WorldModel make_world(std::size_t n) {
+    WorldModel wm;
+    wm.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        WorldObject obj{};
+        obj.id = static_cast<uint32_t>(i + 1);
+        obj.classification = TrackClass::FIXED_WING;
+        obj.lifetime_s = 1e9;
+        obj.azimuth_deg = static_cast<double>(i % 360);
+        obj.range_m = 20000.0 + static_cast<double>(i % 1000);
+        obj.speed_mps = 50.0 + static_cast<double>(i % 200);
+        obj.heading_deg = static_cast<double>((i * 37) % 360);
+        wm.add_object(obj);
+    }
+    return wm;
+}
+
+} // anonymous namespace
+
+// Kinematics only (the SoA arrays)
+void BM_WorldStep(benchmark::State& state) {
+    WorldModel wm = make_world(static_cast<std::size_t>(state.range(0)));
+    double t = 0.0;
+    for (auto _ : state) {
+        t += 0.001;
+        wm.step(0.001, t);
+        benchmark::DoNotOptimize(wm.kinematics().azimuth_deg.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldStep)->Arg(1000)->Arg(100000);
+
+// Step plus the WorldObject view the measurement generator reads
+void BM_WorldTick(benchmark::State& state) {
+    WorldModel wm = make_world(static_cast<std::size_t>(state.range(0)));
+    double t = 0.0;
+    for (auto _ : state) {
+        t += 0.001;
+        benchmark::DoNotOptimize(wm.tick(0.001, t).data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldTick)->Arg(1000)->Arg(100000);
@@ -5,6 +5,7 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <poll.h>
+#include <cerrno>
 #include <cstring>
 
 namespace nng {
@@ -38,42 +39,97 @@ bool CliClient::connect(const std::string& host, uint16_t port) {
 }
 
 std::string CliClient::send_command(const std::string& cmd) {
-    if (sockfd_ < 0)
-        return "";
+    auto responses = send_commands({cmd});
+    return responses.empty() ? "" : responses.front();
+}
+
+std::vector<std::string> CliClient::send_commands(const std::vector<std::string>& cmds) {
+    std::vector<uint8_t> out;
+    for (const auto& cmd : cmds)
+        TcpFramer::encode_append(cmd, out);
+    return exchange(out, cmds.size());
+}
+
+std::vector<std::string> CliClient::send_batch(const std::vector<std::string>& cmds) {
+    if (cmds.empty())
+        return {};
+    std::string batch = "BATCH";
+    for (const auto& cmd : cmds) {
+        batch += '\n';
+        batch += cmd;
+    }
+    std::vector<uint8_t> out;
+    TcpFramer::encode_append(batch, out);
+    return exchange(out, cmds.size());
+}
 
-    // Encode and send
-    auto encoded = TcpFramer::encode(cmd);
-    ssize_t sent = ::send(sockfd_, encoded.data(), encoded.size(), 0);
-    if (sent != static_cast<ssize_t>(encoded.size()))
-        return "";
+bool CliClient::get_stats(GlobalStats& out, HealthState* health) {
+    std::string response = send_command("GET STATS BIN");
+    StatsWireView view;
+    if (!decode_stats_wire(response.data(), response.size(), view) ||
+        view.kind != StatsWireKind::STATS)
+        return false;
+    out = view.global;
+    if (health)
+        *health = view.health;
+    return true;
+}
 
-    // Receive response with framing
-    TcpFramer framer;
+bool CliClient::poll_sources(SourceStatsTable& table) {
+    std::string cmd = "GET SOURCES BIN";
+    if (table.version != 0)
+        cmd += " SINCE=" + std::to_string(table.version);
+    std::string response = send_command(cmd);
+    StatsWireView view;
+    return decode_stats_wire(response.data(), response.size(), view) && table.apply(view);
+}
+
+std::vector<std::string> CliClient::exchange(const std::vector<uint8_t>& out, std::size_t expected) {
+    std::vector<std::string> responses;
+    if (sockfd_ < 0)
+        return responses;
+
+    std::size_t sent = 0;
     uint8_t buf[4096];
+    while (responses.size() < expected) {
+        while (framer_.has_frame() && responses.size() < expected)
+            responses.push_back(framer_.pop_frame());
+        if (responses.size() == expected)
+            break;
 
-    while (!framer.has_frame()) {
         struct pollfd pfd{};
         pfd.fd = sockfd_;
         pfd.events = POLLIN;
+        if (sent < out.size())
+            pfd.events |= POLLOUT;
 
-        int ret = ::poll(&pfd, 1, 5000); // 5 second timeout
+        int ret = ::poll(&pfd, 1, TIMEOUT_MS);
         if (ret <= 0)
-            return "";
-
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
-            return "";
-
-        if (!(pfd.revents & POLLIN))
-            continue;
-
-        ssize_t n = ::recv(sockfd_, buf, sizeof(buf), 0);
-        if (n <= 0)
-            return "";
-
-        framer.feed(buf, static_cast<std::size_t>(n));
+            break;
+
+        if (pfd.revents & (POLLERR | POLLNVAL))
+            break;
+
+        if (pfd.revents & POLLOUT) {
+            ssize_t n = ::send(sockfd_, out.data() + sent, out.size() - sent,
+                               MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                break;
+            if (n > 0)
+                sent += static_cast<std::size_t>(n);
+        }
+
+        if (pfd.revents & (POLLIN | POLLHUP)) {
+            ssize_t n = ::recv(sockfd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                break;
+            if (n > 0)
+                framer_.feed(buf, static_cast<std::size_t>(n));
+        }
     }
-
-    return framer.pop_frame();
+    if (responses.size() < expected)
+        close(); // a late response would answer the next command
+    return responses;
 }
 
 void CliClient::close() {
@@ -81,6 +137,7 @@ void CliClient::close() {
         ::close(sockfd_);
         sockfd_ = -1;
     }
+    framer_.reset();
 }
 
 } // namespace nng
@@ -1,11 +1,16 @@
 #pragma once
+#include "control_node/stats_wire.h"
+#include "control_node/tcp_framer.h"
 #include <string>
 #include <cstdint>
+#include <vector>
 
 namespace nng {
 
 class CliClient {
 public:
+    static constexpr int TIMEOUT_MS = 5000; // without progress
+
     CliClient() = default;
     ~CliClient();
 
@@ -15,13 +20,37 @@ public:
     // Send a command and receive the response
     std::string send_command(const std::string& cmd);
 
+    // Pipelined: write every command (coalesced into as few sends as the
+    // socket allows), then collect the responses in order. Responses are
+    // read while sending, so long pipelines cannot deadlock on full
+    // socket buffers. Fewer responses than commands means the connection
+    // failed or timed out; it is then closed.
+    std::vector<std::string> send_commands(const std::vector<std::string>& cmds);
+
+    // The commands as one BATCH frame, run in order by the server: one
+    // request and one response per command, answered in one round trip.
+    // Commands must be single lines, at most CommandHandler::MAX_BATCH.
+    std::vector<std::string> send_batch(const std::vector<std::string>& cmds);
+
+    // GET STATS BIN, decoded; false on failure
+    bool get_stats(GlobalStats& out, HealthState* health = nullptr);
+
+    // GET SOURCES BIN SINCE=<table.version>: the server sends only the
+    // sources that changed since the table's version (everything the
+    // first time) and the table is brought up to date
+    bool poll_sources(SourceStatsTable& table);
+
     // Close connection
     void close();
 
     bool is_connected() const { return sockfd_ >= 0; }
 
 private:
+    // Send out (already framed) and read expected response frames
+    std::vector<std::string> exchange(const std::vector<uint8_t>& out, std::size_t expected);
+
     int sockfd_ = -1;
+    TcpFramer framer_; // responses, kept across calls
 };
 
 } // namespace nng
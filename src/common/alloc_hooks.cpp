@@ -0,0 +1,86 @@
+// Global operator new/delete counted by AllocTracker. Linked into an
+// executable through the nng_alloc_hooks object library; every variant
+// is replaced so that all of them agree on malloc/free.
+#include "common/alloc_tracker.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* allocate(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (p)
+        nng::AllocTracker::on_alloc(size);
+    return p;
+}
+
+void* allocate_aligned(std::size_t size, std::size_t align) {
+    if (align < sizeof(void*))
+        align = sizeof(void*);
+    void* p = nullptr;
+    if (posix_memalign(&p, align, size ? size : 1) != 0)
+        return nullptr;
+    nng::AllocTracker::on_alloc(size);
+    return p;
+}
+
+void release(void* p) {
+    if (!p)
+        return;
+    nng::AllocTracker::on_free();
+    std::free(p);
+}
+
+struct MarkInstalled {
+    MarkInstalled() { nng::AllocTracker::mark_installed(); }
+} g_mark_installed;
+
+} // anonymous namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = allocate_aligned(size, static_cast<std::size_t>(align)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    if (void* p = allocate_aligned(size, static_cast<std::size_t>(align)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
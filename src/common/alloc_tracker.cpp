@@ -0,0 +1,154 @@
+#include "common/alloc_tracker.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace nng {
+
+std::atomic<bool> AllocTracker::installed_{false};
+std::atomic<bool> AllocTracker::enabled_{false};
+
+namespace {
+
+struct Slot {
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> sizes[ALLOC_SIZE_BUCKETS] = {};
+    // name is written before name_len is published
+    char name[AllocTracker::NAME_MAX + 1] = {};
+    std::atomic<std::size_t> name_len{0};
+    std::atomic<bool> hot{false};
+};
+
+// Static storage, zero-initialized before any constructor runs: usable
+// from the very first operator new
+Slot g_slots[AllocTracker::MAX_THREADS];
+std::atomic<std::size_t> g_next_slot{0};
+thread_local Slot* t_slot = nullptr;
+
+// Shared by the threads past MAX_THREADS, so updated read-modify-write
+constexpr std::size_t SHARED_SLOT = AllocTracker::MAX_THREADS - 1;
+
+Slot* my_slot() {
+    if (!t_slot) {
+        std::size_t i = g_next_slot.fetch_add(1, std::memory_order_relaxed);
+        t_slot = &g_slots[i < SHARED_SLOT ? i : SHARED_SLOT];
+    }
+    return t_slot;
+}
+
+void bump(Slot* s, std::atomic<uint64_t>& c, uint64_t by) {
+    if (s == &g_slots[SHARED_SLOT])
+        c.fetch_add(by, std::memory_order_relaxed);
+    else
+        c.store(c.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+AllocCounts read(const Slot& s) {
+    AllocCounts c;
+    c.allocs = s.allocs.load(std::memory_order_relaxed);
+    c.frees = s.frees.load(std::memory_order_relaxed);
+    c.bytes = s.bytes.load(std::memory_order_relaxed);
+    for (std::size_t b = 0; b < ALLOC_SIZE_BUCKETS; ++b)
+        c.sizes[b] = s.sizes[b].load(std::memory_order_relaxed);
+    return c;
+}
+
+std::mutex g_baseline_mutex;
+AllocCounts g_baseline[AllocTracker::MAX_THREADS];
+
+} // anonymous namespace
+
+void AllocCounts::add(const AllocCounts& o) {
+    allocs += o.allocs;
+    frees += o.frees;
+    bytes += o.bytes;
+    for (std::size_t b = 0; b < ALLOC_SIZE_BUCKETS; ++b)
+        sizes[b] += o.sizes[b];
+}
+
+void AllocCounts::subtract(const AllocCounts& o) {
+    allocs -= o.allocs;
+    frees -= o.frees;
+    bytes -= o.bytes;
+    for (std::size_t b = 0; b < ALLOC_SIZE_BUCKETS; ++b)
+        sizes[b] -= o.sizes[b];
+}
+
+std::size_t AllocTracker::size_bucket(std::size_t size) {
+    std::size_t b = 0;
+    while (size != 0 && b + 1 < ALLOC_SIZE_BUCKETS) {
+        size >>= 1;
+        ++b;
+    }
+    return b;
+}
+
+void AllocTracker::count_alloc(std::size_t size) {
+    Slot* s = my_slot();
+    bump(s, s->allocs, 1);
+    bump(s, s->bytes, size);
+    bump(s, s->sizes[size_bucket(size)], 1);
+}
+
+void AllocTracker::count_free() {
+    Slot* s = my_slot();
+    bump(s, s->frees, 1);
+}
+
+void AllocTracker::name_thread(const char* name, bool hot_path) {
+    Slot* s = my_slot();
+    std::size_t len = std::min(std::strlen(name), NAME_MAX);
+    s->name_len.store(0, std::memory_order_relaxed);
+    std::memcpy(s->name, name, len);
+    s->name[len] = '\0';
+    s->hot.store(hot_path, std::memory_order_relaxed);
+    s->name_len.store(len, std::memory_order_release);
+    // A named thread counts from here; what came before (e.g. the main
+    // thread's startup) is not its share
+    std::size_t i = static_cast<std::size_t>(s - g_slots);
+    if (i != SHARED_SLOT) {
+        std::lock_guard<std::mutex> lock(g_baseline_mutex);
+        g_baseline[i] = read(*s);
+    }
+}
+
+AllocReport AllocTracker::report() {
+    AllocReport out;
+    out.installed = installed();
+    out.enabled = enabled();
+    std::size_t used = std::min(g_next_slot.load(std::memory_order_relaxed), MAX_THREADS);
+    ThreadAllocs unnamed;
+
+    std::lock_guard<std::mutex> lock(g_baseline_mutex);
+    for (std::size_t i = 0; i < used; ++i) {
+        const Slot& s = g_slots[i];
+        AllocCounts c = read(s);
+        c.subtract(g_baseline[i]);
+        out.total.add(c);
+        std::size_t len = s.name_len.load(std::memory_order_acquire);
+        if (len == 0) {
+            unnamed.counts.add(c);
+            continue;
+        }
+        ThreadAllocs t;
+        t.name.assign(s.name, len);
+        t.hot = s.hot.load(std::memory_order_relaxed);
+        t.counts = c;
+        if (t.hot)
+            out.hot.add(c);
+        out.threads.push_back(std::move(t));
+    }
+    out.threads.push_back(std::move(unnamed));
+    return out;
+}
+
+void AllocTracker::reset() {
+    std::lock_guard<std::mutex> lock(g_baseline_mutex);
+    std::size_t used = std::min(g_next_slot.load(std::memory_order_relaxed), MAX_THREADS);
+    for (std::size_t i = 0; i < used; ++i)
+        g_baseline[i] = read(g_slots[i]);
+}
+
+} // namespace nng
@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+// Allocation sizes by power of two: bucket k counts sizes in
+// [2^(k-1), 2^k) (bucket 0: zero-byte requests); the last takes the rest
+constexpr std::size_t ALLOC_SIZE_BUCKETS = 32;
+
+struct AllocCounts {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0; // requested by the allocations
+    std::array<uint64_t, ALLOC_SIZE_BUCKETS> sizes{};
+
+    void add(const AllocCounts& o);
+    void subtract(const AllocCounts& o);
+};
+
+struct ThreadAllocs {
+    std::string name; // "" for threads never named
+    bool hot = false; // named as a hot-path (per-frame) thread
+    AllocCounts counts;
+};
+
+struct AllocReport {
+    bool installed = false; // the operator new/delete hooks are linked in
+    bool enabled = false;
+    AllocCounts total;
+    AllocCounts hot;                  // the hot-path threads only
+    std::vector<ThreadAllocs> threads; // named threads, then one unnamed entry
+};
+
+// Heap allocation accounting. Linking the nng_alloc_hooks object library
+// into an executable replaces the global operator new/delete with
+// malloc-based versions that, while enabled, count every allocation and
+// its size on the calling thread. Each thread gets a fixed slot on its
+// first counted allocation (the hooks never allocate themselves); slots
+// are single-writer relaxed atomics, readable from any thread. Threads
+// past MAX_THREADS share the last slot.
+//
+// Disabled (the default), a hook costs one relaxed load over malloc/free.
+// Counts only grow; reset() moves the baseline report() subtracts.
+class AllocTracker {
+public:
+    static constexpr std::size_t MAX_THREADS = 256;
+    static constexpr std::size_t NAME_MAX = 23;
+
+    static bool installed() { return installed_.load(std::memory_order_relaxed); }
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void set_enabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+
+    // Label the calling thread's counts (cut to NAME_MAX), which then
+    // start from zero; hot_path marks a thread whose allocations are
+    // charged per frame
+    static void name_thread(const char* name, bool hot_path);
+
+    // Counts since the last reset()
+    static AllocReport report();
+    static void reset();
+
+    // Hook side
+    static void mark_installed() { installed_.store(true, std::memory_order_relaxed); }
+    static void on_alloc(std::size_t size) {
+        if (enabled())
+            count_alloc(size);
+    }
+    static void on_free() {
+        if (enabled())
+            count_free();
+    }
+
+    static std::size_t size_bucket(std::size_t size);
+
+private:
+    static void count_alloc(std::size_t size);
+    static void count_free();
+
+    static std::atomic<bool> installed_;
+    static std::atomic<bool> enabled_;
+};
+
+} // namespace nng
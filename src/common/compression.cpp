@@ -0,0 +1,245 @@
+#include "common/compression.h"
+#include <cctype>
+#include <cstring>
+
+#if NNG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace nng {
+namespace {
+
+// --- LZ4 block format ---
+// Sequences of [token][literal length ext][literals][u16 offset][match
+// length ext]; the last sequence is literals only. End-of-block rules: the
+// last 5 bytes are literals and no match starts in the last 12.
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t MF_LIMIT = 12;
+constexpr std::size_t LAST_LITERALS = 5;
+constexpr std::size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 14;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Append a length continuation (the part beyond the token's 15)
+bool put_length(uint8_t*& op, const uint8_t* end, std::size_t len) {
+    while (len >= 255) {
+        if (op >= end)
+            return false;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= end)
+        return false;
+    *op++ = static_cast<uint8_t>(len);
+    return true;
+}
+
+bool put_sequence(uint8_t*& op, const uint8_t* end, const uint8_t* lit, std::size_t lit_len,
+                  std::size_t offset, std::size_t match_len) {
+    if (op >= end)
+        return false;
+    uint8_t* token = op++;
+    std::size_t ml = match_len ? match_len - MIN_MATCH : 0;
+    *token = static_cast<uint8_t>(((lit_len >= 15 ? 15 : lit_len) << 4) | (ml >= 15 ? 15 : ml));
+    if (lit_len >= 15 && !put_length(op, end, lit_len - 15))
+        return false;
+    if (static_cast<std::size_t>(end - op) < lit_len)
+        return false;
+    if (lit_len > 0)
+        std::memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (match_len == 0)
+        return true;
+    if (end - op < 2)
+        return false;
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    return ml < 15 || put_length(op, end, ml - 15);
+}
+
+std::size_t lz4_compress(const uint8_t* src, std::size_t n, uint8_t* dst, std::size_t cap) {
+    // Positions + 1, so 0 means empty
+    thread_local uint32_t table[1u << HASH_BITS];
+    std::memset(table, 0, sizeof(table));
+
+    uint8_t* op = dst;
+    const uint8_t* end = dst + cap;
+    std::size_t anchor = 0;
+    if (n > MF_LIMIT) {
+        std::size_t ip = 0;
+        const std::size_t match_limit = n - MF_LIMIT;
+        while (ip < match_limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t& slot = table[hash4(seq)];
+            std::size_t ref = slot;
+            slot = static_cast<uint32_t>(ip + 1);
+            if (ref == 0 || ip - (ref - 1) > MAX_OFFSET || read32(src + ref - 1) != seq) {
+                ++ip;
+                continue;
+            }
+            --ref;
+
+            std::size_t len = MIN_MATCH;
+            while (ip + len < n - LAST_LITERALS && src[ref + len] == src[ip + len])
+                ++len;
+            if (!put_sequence(op, end, src + anchor, ip - anchor, ip - ref, len))
+                return 0;
+            ip += len;
+            anchor = ip;
+        }
+    }
+    if (!put_sequence(op, end, src + anchor, n - anchor, 0, 0))
+        return 0;
+    return static_cast<std::size_t>(op - dst);
+}
+
+bool get_length(const uint8_t*& ip, const uint8_t* end, std::size_t& len) {
+    uint8_t b;
+    do {
+        if (ip >= end)
+            return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool lz4_decompress(const uint8_t* src, std::size_t n, uint8_t* dst, std::size_t dst_len) {
+    const uint8_t* ip = src;
+    const uint8_t* in_end = src + n;
+    uint8_t* op = dst;
+    uint8_t* out_end = dst + dst_len;
+
+    while (ip < in_end) {
+        uint8_t token = *ip++;
+        std::size_t lit = token >> 4;
+        if (lit == 15 && !get_length(ip, in_end, lit))
+            return false;
+        if (static_cast<std::size_t>(in_end - ip) < lit ||
+            static_cast<std::size_t>(out_end - op) < lit)
+            return false;
+        std::memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == in_end)
+            break; // last sequence
+
+        if (in_end - ip < 2)
+            return false;
+        std::size_t offset = ip[0] | (std::size_t{ip[1]} << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - dst))
+            return false;
+        std::size_t len = token & 15;
+        if (len == 15 && !get_length(ip, in_end, len))
+            return false;
+        len += MIN_MATCH;
+        if (static_cast<std::size_t>(out_end - op) < len)
+            return false;
+
+        const uint8_t* match = op - offset;
+        if (offset >= len) {
+            std::memcpy(op, match, len);
+            op += len;
+        } else {
+            // Overlapping copy repeats the last offset bytes
+            for (std::size_t i = 0; i < len; ++i)
+                *op++ = match[i];
+        }
+    }
+    return op == out_end;
+}
+
+} // anonymous namespace
+
+const char* codec_name(Codec codec) {
+    switch (codec) {
+        case Codec::NONE: return "none";
+        case Codec::LZ4:  return "lz4";
+        case Codec::ZSTD: return "zstd";
+    }
+    return "?";
+}
+
+bool parse_codec(std::string_view name, Codec& out) {
+    for (Codec c : {Codec::NONE, Codec::LZ4, Codec::ZSTD}) {
+        const char* n = codec_name(c);
+        if (name.size() != std::strlen(n))
+            continue;
+        bool match = true;
+        for (std::size_t i = 0; i < name.size() && match; ++i)
+            match = std::tolower(static_cast<unsigned char>(name[i])) == n[i];
+        if (match) {
+            out = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool codec_available(Codec codec) {
+    switch (codec) {
+        case Codec::NONE:
+        case Codec::LZ4:
+            return true;
+        case Codec::ZSTD:
+            return NNG_HAVE_ZSTD != 0;
+    }
+    return false;
+}
+
+std::size_t compress_block(Codec codec, const uint8_t* src, std::size_t n,
+                           uint8_t* dst, std::size_t cap, int level) {
+    switch (codec) {
+        case Codec::NONE:
+            if (n > cap)
+                return 0;
+            std::memcpy(dst, src, n);
+            return n;
+        case Codec::LZ4:
+            return lz4_compress(src, n, dst, cap);
+        case Codec::ZSTD: {
+#if NNG_HAVE_ZSTD
+            std::size_t r = ZSTD_compress(dst, cap, src, n, level);
+            return ZSTD_isError(r) ? 0 : r;
+#else
+            (void)level;
+            return 0;
+#endif
+        }
+    }
+    return 0;
+}
+
+bool decompress_block(Codec codec, const uint8_t* src, std::size_t n,
+                      uint8_t* dst, std::size_t dst_len) {
+    switch (codec) {
+        case Codec::NONE:
+            if (n != dst_len)
+                return false;
+            std::memcpy(dst, src, n);
+            return true;
+        case Codec::LZ4:
+            return lz4_decompress(src, n, dst, dst_len);
+        case Codec::ZSTD: {
+#if NNG_HAVE_ZSTD
+            std::size_t r = ZSTD_decompress(dst, dst_len, src, n);
+            return !ZSTD_isError(r) && r == dst_len;
+#else
+            return false;
+#endif
+        }
+    }
+    return false;
+}
+
+} // namespace nng
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace nng {
+
+// Block codecs for recorded chunks. LZ4 (block format, no frame header)
+// is built in; ZSTD needs libzstd at build time (NNG_HAVE_ZSTD).
+enum class Codec : uint16_t {
+    NONE = 0,
+    LZ4  = 1,
+    ZSTD = 2,
+};
+
+const char* codec_name(Codec codec);
+bool parse_codec(std::string_view name, Codec& out); // "none", "lz4", "zstd"
+bool codec_available(Codec codec);
+
+// Compress n bytes into dst (capacity cap). Returns the compressed size,
+// or 0 if the codec is unavailable or the output would not fit in cap;
+// callers store the data raw then. level is used by ZSTD only.
+std::size_t compress_block(Codec codec, const uint8_t* src, std::size_t n,
+                           uint8_t* dst, std::size_t cap, int level = 1);
+
+// Decompress exactly dst_len bytes. False on corrupt input, a size
+// mismatch or an unavailable codec; never writes past dst + dst_len.
+bool decompress_block(Codec codec, const uint8_t* src, std::size_t n,
+                      uint8_t* dst, std::size_t dst_len);
+
+} // namespace nng
@@ -0,0 +1,70 @@
+#include "common/container.h"
+#include "common/crc32.h"
+#include <cstring>
+
+namespace nng {
+
+ContainerBuilder::ContainerBuilder(std::size_t max_datagram, bool with_crc)
+    : max_datagram_(max_datagram), with_crc_(with_crc) {}
+
+std::size_t ContainerBuilder::overhead() const {
+    return CONTAINER_HEADER_SIZE + (with_crc_ ? FRAME_CRC_SIZE : 0);
+}
+
+void ContainerBuilder::add(const uint8_t* frame, std::size_t len) {
+    // body_len and frame_count are 16-bit
+    bool full = !open_.empty() &&
+                (open_.size() + len + (with_crc_ ? FRAME_CRC_SIZE : 0) > max_datagram_ ||
+                 open_.size() - CONTAINER_HEADER_SIZE + len > 0xFFFF ||
+                 open_frames_ == 0xFFFF);
+    if (full)
+        flush();
+
+    if (open_.empty()) {
+        open_.reserve(max_datagram_ > overhead() + len ? max_datagram_ : overhead() + len);
+        open_.resize(CONTAINER_HEADER_SIZE);
+    }
+    open_.insert(open_.end(), frame, frame + len);
+    ++open_frames_;
+}
+
+void ContainerBuilder::flush() {
+    if (open_.empty())
+        return;
+
+    ContainerHeader hdr{};
+    hdr.version = PROTOCOL_VERSION_V2;
+    hdr.flags = with_crc_ ? CONTAINER_FLAG_CRC : 0;
+    hdr.frame_count = open_frames_;
+    hdr.body_len = static_cast<uint16_t>(open_.size() - CONTAINER_HEADER_SIZE);
+    serialize_container_header(hdr, open_.data());
+
+    if (with_crc_) {
+        uint32_t crc = crc32(open_.data(), open_.size());
+        uint8_t crc_bytes[FRAME_CRC_SIZE];
+        std::memcpy(crc_bytes, &crc, sizeof(crc));
+        open_.insert(open_.end(), crc_bytes, crc_bytes + FRAME_CRC_SIZE);
+    }
+
+    done_.push_back(std::move(open_));
+    open_.clear();
+    open_frames_ = 0;
+}
+
+std::vector<std::vector<uint8_t>> ContainerBuilder::take() {
+    std::vector<std::vector<uint8_t>> out;
+    out.swap(done_);
+    return out;
+}
+
+std::vector<std::vector<uint8_t>> pack_containers(
+        const std::vector<std::vector<uint8_t>>& frames,
+        std::size_t max_datagram, bool with_crc) {
+    ContainerBuilder builder(max_datagram, with_crc);
+    for (const auto& f : frames)
+        builder.add(f);
+    builder.flush();
+    return builder.take();
+}
+
+} // namespace nng
@@ -0,0 +1,44 @@
+#pragma once
+#include "common/protocol.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace nng {
+
+// Packs v1 frames into protocol v2 containers of at most max_datagram
+// bytes, in order. A frame too big for an empty container gets a container
+// of its own. Frames must not carry a per-frame CRC.
+class ContainerBuilder {
+public:
+    explicit ContainerBuilder(std::size_t max_datagram = CONTAINER_MAX_DATAGRAM,
+                              bool with_crc = true);
+
+    // Append one frame, closing the current container first if it is full
+    void add(const uint8_t* frame, std::size_t len);
+    void add(const std::vector<uint8_t>& frame) { add(frame.data(), frame.size()); }
+
+    // Close the open container (if any)
+    void flush();
+
+    // Closed containers, oldest first; the builder is left empty
+    std::vector<std::vector<uint8_t>> take();
+
+    std::size_t max_datagram() const { return max_datagram_; }
+
+private:
+    std::size_t overhead() const;
+
+    std::size_t max_datagram_;
+    bool with_crc_;
+    std::vector<uint8_t> open_;  // header placeholder + frames so far
+    uint16_t open_frames_ = 0;
+    std::vector<std::vector<uint8_t>> done_;
+};
+
+// Pack a tick's frames into as few datagrams as fit
+std::vector<std::vector<uint8_t>> pack_containers(
+    const std::vector<std::vector<uint8_t>>& frames,
+    std::size_t max_datagram = CONTAINER_MAX_DATAGRAM, bool with_crc = true);
+
+} // namespace nng
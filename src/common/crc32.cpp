@@ -1,4 +1,17 @@
 #include "common/crc32.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NNG_CRC32_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define NNG_CRC32_ARM 1
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
 
 namespace nng {
 namespace {
@@ -15,25 +28,261 @@ constexpr uint32_t make_crc_entry(uint32_t idx) {
     return crc;
 }
 
+// entries[0] is the classic table; entries[k][i] is the CRC of byte i
+// followed by k zero bytes, for slicing-by-N
+constexpr std::size_t SLICES = 16;
+
 struct CrcTable {
-    uint32_t entries[256];
+    uint32_t entries[SLICES][256];
     constexpr CrcTable() : entries{} {
         for (uint32_t i = 0; i < 256; ++i)
-            entries[i] = make_crc_entry(i);
+            entries[0][i] = make_crc_entry(i);
+        for (std::size_t k = 1; k < SLICES; ++k)
+            for (uint32_t i = 0; i < 256; ++i)
+                entries[k][i] = (entries[k - 1][i] >> 8) ^ entries[0][entries[k - 1][i] & 0xFF];
     }
 };
 
 constexpr CrcTable table{};
 
-} // anonymous namespace
+// The kernels below take and return the raw register (pre/post
+// inversion is done by crc32_update_with()).
 
-uint32_t crc32_update(uint32_t crc, const uint8_t* data, std::size_t len) {
-    crc = ~crc;
+uint32_t crc_table(uint32_t crc, const uint8_t* data, std::size_t len) {
     for (std::size_t i = 0; i < len; ++i) {
         uint8_t idx = static_cast<uint8_t>(crc ^ data[i]);
-        crc = (crc >> 8) ^ table.entries[idx];
+        crc = (crc >> 8) ^ table.entries[0][idx];
+    }
+    return crc;
+}
+
+uint32_t load_le32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+uint32_t crc_slice8(uint32_t crc, const uint8_t* data, std::size_t len) {
+    const auto& t = table.entries;
+    while (len >= 8) {
+        uint32_t a = load_le32(data) ^ crc;
+        uint32_t b = load_le32(data + 4);
+        crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+              t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+        data += 8;
+        len -= 8;
+    }
+    return crc_table(crc, data, len);
+}
+
+uint32_t crc_slice16(uint32_t crc, const uint8_t* data, std::size_t len) {
+    const auto& t = table.entries;
+    while (len >= 16) {
+        uint32_t a = load_le32(data) ^ crc;
+        uint32_t b = load_le32(data + 4);
+        uint32_t c = load_le32(data + 8);
+        uint32_t d = load_le32(data + 12);
+        crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24] ^
+              t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF]  ^ t[8][b >> 24] ^
+              t[7][c & 0xFF]  ^ t[6][(c >> 8) & 0xFF]  ^ t[5][(c >> 16) & 0xFF]  ^ t[4][c >> 24] ^
+              t[3][d & 0xFF]  ^ t[2][(d >> 8) & 0xFF]  ^ t[1][(d >> 16) & 0xFF]  ^ t[0][d >> 24];
+        data += 16;
+        len -= 16;
+    }
+    return crc_table(crc, data, len);
+}
+
+#if NNG_CRC32_X86
+// Below this the folding setup costs more than it saves
+constexpr std::size_t PCLMUL_MIN_LEN = 64;
+
+// Unaligned 16-byte load
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i load128(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// x * k (both 64-bit halves), plus the next block
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i fold(__m128i x, __m128i k, __m128i next) {
+    __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+// Fold 64 bytes per step with carry-less multiplies, then reduce to 32
+// bits (Barrett). Constants are x^n mod P for the reflected polynomial,
+// as in Intel's "Fast CRC Computation Using PCLMULQDQ" paper.
+__attribute__((target("pclmul,sse4.1")))
+uint32_t crc_pclmul_blocks(uint32_t crc, const uint8_t* buf, std::size_t len) {
+    // len >= 64 and a multiple of 16
+    alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x1 = _mm_xor_si128(load128(buf), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = load128(buf + 16);
+    __m128i x3 = load128(buf + 32);
+    __m128i x4 = load128(buf + 48);
+    buf += 64;
+    len -= 64;
+
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    while (len >= 64) {
+        x1 = fold(x1, k, load128(buf));
+        x2 = fold(x2, k, load128(buf + 16));
+        x3 = fold(x3, k, load128(buf + 32));
+        x4 = fold(x4, k, load128(buf + 48));
+        buf += 64;
+        len -= 64;
+    }
+
+    // Four lanes into one, then any remaining 16-byte blocks
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x1 = fold(x1, k, x2);
+    x1 = fold(x1, k, x3);
+    x1 = fold(x1, k, x4);
+    while (len >= 16) {
+        x1 = fold(x1, k, load128(buf));
+        buf += 16;
+        len -= 16;
+    }
+
+    // 128 -> 64 bits
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x2r = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2r = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2r);
+
+    // Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2r = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+    x2r = _mm_clmulepi64_si128(_mm_and_si128(x2r, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, x2r);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t crc_pclmul(uint32_t crc, const uint8_t* data, std::size_t len) {
+    if (len >= PCLMUL_MIN_LEN) {
+        std::size_t blocks = len & ~static_cast<std::size_t>(15);
+        crc = crc_pclmul_blocks(crc, data, blocks);
+        data += blocks;
+        len -= blocks;
     }
-    return ~crc;
+    return crc_slice8(crc, data, len);
+}
+
+bool cpu_has_pclmul() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+#endif
+
+#if NNG_CRC32_ARM
+__attribute__((target("+crc")))
+uint32_t crc_armv8(uint32_t crc, const uint8_t* data, std::size_t len) {
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, data, sizeof(v));
+        crc = __crc32d(crc, v);
+        data += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        crc = __crc32b(crc, *data++);
+        --len;
+    }
+    return crc;
+}
+
+bool cpu_has_armv8_crc() {
+    return (::getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+#endif
+
+using CrcKernel = uint32_t (*)(uint32_t, const uint8_t*, std::size_t);
+
+CrcKernel kernel_for(Crc32Impl impl) {
+    switch (impl) {
+        case Crc32Impl::TABLE:   return crc_table;
+        case Crc32Impl::SLICE8:  return crc_slice8;
+        case Crc32Impl::SLICE16: return crc_slice16;
+#if NNG_CRC32_X86
+        case Crc32Impl::PCLMUL:  return crc_pclmul;
+#endif
+#if NNG_CRC32_ARM
+        case Crc32Impl::ARMV8:   return crc_armv8;
+#endif
+        default:                 return nullptr;
+    }
+}
+
+Crc32Impl select_impl() {
+#if NNG_CRC32_X86
+    if (cpu_has_pclmul())
+        return Crc32Impl::PCLMUL;
+#endif
+#if NNG_CRC32_ARM
+    if (cpu_has_armv8_crc())
+        return Crc32Impl::ARMV8;
+#endif
+    return Crc32Impl::SLICE8;
+}
+
+// Chosen during static initialization, before main()
+const Crc32Impl active_impl = select_impl();
+const CrcKernel active_kernel = kernel_for(active_impl);
+
+} // anonymous namespace
+
+const char* crc32_impl_name(Crc32Impl impl) {
+    switch (impl) {
+        case Crc32Impl::TABLE:   return "table";
+        case Crc32Impl::SLICE8:  return "slice8";
+        case Crc32Impl::SLICE16: return "slice16";
+        case Crc32Impl::PCLMUL:  return "pclmul";
+        case Crc32Impl::ARMV8:   return "armv8";
+    }
+    return "unknown";
+}
+
+bool crc32_impl_supported(Crc32Impl impl) {
+    switch (impl) {
+        case Crc32Impl::TABLE:
+        case Crc32Impl::SLICE8:
+        case Crc32Impl::SLICE16:
+            return true;
+#if NNG_CRC32_X86
+        case Crc32Impl::PCLMUL:
+            return cpu_has_pclmul();
+#endif
+#if NNG_CRC32_ARM
+        case Crc32Impl::ARMV8:
+            return cpu_has_armv8_crc();
+#endif
+        default:
+            return false;
+    }
+}
+
+Crc32Impl crc32_active_impl() {
+    return active_impl;
+}
+
+uint32_t crc32_update_with(Crc32Impl impl, uint32_t crc, const uint8_t* data, std::size_t len) {
+    return ~kernel_for(impl)(~crc, data, len);
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, std::size_t len) {
+    // A caller running during static init may get here before active_kernel
+    CrcKernel kernel = active_kernel ? active_kernel : crc_slice8;
+    return ~kernel(~crc, data, len);
 }
 
 uint32_t crc32(const uint8_t* data, std::size_t len) {
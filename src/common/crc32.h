@@ -10,4 +10,22 @@ uint32_t crc32(const uint8_t* data, std::size_t len);
 // Incremental CRC32: feed chunks, start with crc=0
 uint32_t crc32_update(uint32_t crc, const uint8_t* data, std::size_t len);
 
+// CRC32 implementations. crc32()/crc32_update() use the fastest one the
+// CPU supports, chosen once at startup; all give identical results.
+enum class Crc32Impl {
+    TABLE,   // byte at a time, one 256-entry table
+    SLICE8,  // 8 bytes per step, 8 tables
+    SLICE16, // 16 bytes per step, 16 tables
+    PCLMUL,  // x86 carry-less multiply folding (SSE4.1 + PCLMULQDQ)
+    ARMV8,   // aarch64 CRC32 instructions
+};
+
+const char* crc32_impl_name(Crc32Impl impl);
+bool crc32_impl_supported(Crc32Impl impl);
+Crc32Impl crc32_active_impl();
+
+// crc32_update() with a specific implementation (tests, benchmarks).
+// impl must be supported.
+uint32_t crc32_update_with(Crc32Impl impl, uint32_t crc, const uint8_t* data, std::size_t len);
+
 } // namespace nng
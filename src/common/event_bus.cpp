@@ -1,45 +1,260 @@
 #include "common/event_bus.h"
+#include "common/mpsc_queue.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
 
 namespace nng {
 
-uint32_t EventBus::subscribe(EventCategory cat, Callback cb) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    uint32_t id = next_id_++;
-    subs_.push_back({id, cat, false, std::move(cb)});
-    return id;
+std::string EventDetail::render() const {
+    char buf[160];
+    int n = 0;
+    switch (kind) {
+        case Kind::NONE:
+            return std::string();
+        case Kind::FRAME_ERROR:
+            if (frame_error.frame_len > 0)
+                n = std::snprintf(buf, sizeof(buf), "error=%s len=%u",
+                                  frame_error.error, frame_error.frame_len);
+            else
+                n = std::snprintf(buf, sizeof(buf), "error=%s", frame_error.error);
+            break;
+        case Kind::SOURCE:
+            n = std::snprintf(buf, sizeof(buf), "src_id=%u", src_id);
+            break;
+        case Kind::SEQUENCE:
+            if (seq.gap > 0)
+                n = std::snprintf(buf, sizeof(buf), "src_id=%u expected=%u actual=%u gap=%u",
+                                  src_id, seq.expected, seq.actual, seq.gap);
+            else
+                n = std::snprintf(buf, sizeof(buf), "src_id=%u expected=%u actual=%u",
+                                  src_id, seq.expected, seq.actual);
+            break;
+        case Kind::PLOT:
+            n = std::snprintf(buf, sizeof(buf), "src_id=%u plot_id=%u range=%um",
+                              src_id, plot.plot_id, plot.range_m);
+            break;
+        case Kind::TRACK:
+            n = std::snprintf(buf, sizeof(buf), "src_id=%u track_id=%u class=%u threat=%u",
+                              src_id, track.track_id, track.classification, track.threat_level);
+            break;
+        case Kind::HEARTBEAT:
+            n = std::snprintf(buf, sizeof(buf), "subsystem=%u state=%u cpu=%u%% mem=%u%%",
+                              heartbeat.subsystem_id, heartbeat.state,
+                              heartbeat.cpu_pct, heartbeat.mem_pct);
+            break;
+        case Kind::ENGAGEMENT:
+            n = std::snprintf(buf, sizeof(buf), "weapon=%u mode=%u track=%u rounds=%u",
+                              engagement.weapon_id, engagement.mode,
+                              engagement.track, engagement.rounds);
+            break;
+        case Kind::COALESCED:
+            if (coalesced.amount != coalesced.count)
+                n = std::snprintf(buf, sizeof(buf), "src_id=%u suppressed=%u total=%u window_ms=%u",
+                                  src_id, coalesced.count, coalesced.amount, coalesced.window_ms);
+            else
+                n = std::snprintf(buf, sizeof(buf), "src_id=%u suppressed=%u window_ms=%u",
+                                  src_id, coalesced.count, coalesced.window_ms);
+            break;
+        case Kind::ASSOCIATION:
+            if (association.track_src != src_id)
+                n = std::snprintf(buf, sizeof(buf),
+                                  "src_id=%u plot_id=%u track_id=%u track_src=%u d_az=%dmdeg d_range=%dm",
+                                  src_id, association.plot_id, association.track_id,
+                                  association.track_src, association.d_az_mdeg, association.d_range_m);
+            else
+                n = std::snprintf(buf, sizeof(buf),
+                                  "src_id=%u plot_id=%u track_id=%u d_az=%dmdeg d_range=%dm",
+                                  src_id, association.plot_id, association.track_id,
+                                  association.d_az_mdeg, association.d_range_m);
+            break;
+    }
+    if (n <= 0)
+        return std::string();
+    return std::string(buf, static_cast<std::size_t>(n) < sizeof(buf) ? n : sizeof(buf) - 1);
 }
 
-uint32_t EventBus::subscribe_all(Callback cb) {
+namespace {
+
+// Idle dispatcher: spin briefly, then yield, then sleep
+void backoff(unsigned& idle) {
+    ++idle;
+    if (idle < 64)
+        return;
+    if (idle < 256)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+} // anonymous namespace
+
+struct EventBus::AsyncSubscriber {
+    AsyncSubscriber(Callback callback, const AsyncOptions& opts)
+        : cb(std::move(callback)), queue(opts.queue_capacity), overflow(opts.overflow) {}
+
+    // Publisher side (any thread). A failed push means the queue is full
+    // (not that another publisher got in first), so DROP only sheds
+    // when the subscriber has really fallen behind.
+    void push(const EventRecord& event) {
+        while (!queue.try_push(event)) {
+            if (overflow == EventOverflow::DROP || stopping.load(std::memory_order_acquire)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+        }
+        enqueued.fetch_add(1, std::memory_order_release);
+    }
+
+    // Dispatcher thread: deliver until stopped, then drain what is left
+    void run() {
+        EventRecord event;
+        unsigned idle = 0;
+        for (;;) {
+            if (queue.try_pop(event)) {
+                cb(event);
+                delivered.store(delivered.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_release);
+                idle = 0;
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) && queue.empty())
+                return;
+            backoff(idle);
+        }
+    }
+
+    void stop() {
+        stopping.store(true, std::memory_order_release);
+        if (thread.get_id() == std::this_thread::get_id())
+            thread.detach(); // unsubscribed from its own callback
+        else if (thread.joinable())
+            thread.join();
+    }
+
+    Callback cb;
+    MpscQueue<EventRecord> queue;
+    EventOverflow overflow;
+    std::atomic<uint64_t> enqueued{0};
+    std::atomic<uint64_t> delivered{0}; // dispatcher only
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+EventBus::EventBus() {
     std::lock_guard<std::mutex> lock(mutex_);
-    uint32_t id = next_id_++;
-    subs_.push_back({id, EventCategory::TRACKING, true, std::move(cb)});
-    return id;
+    publish_list({});
 }
 
-void EventBus::unsubscribe(uint32_t sub_id) {
+EventBus::~EventBus() {
+    for (const auto& s : list_.load(std::memory_order_acquire)->subs) {
+        if (s->async)
+            s->async->stop();
+    }
+}
+
+void EventBus::publish_list(std::vector<std::shared_ptr<const Subscription>> subs) {
+    auto list = std::make_unique<SubscriberList>();
+    list->subs = std::move(subs);
+    for (const auto& s : list->subs) {
+        for (std::size_t c = 0; c < CATEGORY_COUNT; ++c) {
+            if (s->category_mask & (1u << c))
+                list->by_category[c].push_back(s.get());
+        }
+    }
+    list_.store(list.get(), std::memory_order_release);
+    lists_.push_back(std::move(list));
+}
+
+uint32_t EventBus::add(uint32_t category_mask, Callback cb, const AsyncOptions* async) {
+    auto sub = std::make_shared<Subscription>();
+    sub->category_mask = category_mask;
+    if (async) {
+        sub->async = std::make_shared<AsyncSubscriber>(std::move(cb), *async);
+        // The thread keeps its subscriber alive (needed once detached)
+        sub->async->thread = std::thread([a = sub->async] { a->run(); });
+    } else {
+        sub->cb = std::move(cb);
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
-    subs_.erase(
-        std::remove_if(subs_.begin(), subs_.end(),
-            [sub_id](const Subscription& s) { return s.id == sub_id; }),
-        subs_.end());
+    sub->id = next_id_++;
+    auto subs = list_.load(std::memory_order_relaxed)->subs;
+    subs.push_back(sub);
+    publish_list(std::move(subs));
+    return sub->id;
 }
 
-void EventBus::publish(const EventRecord& event) {
-    // Copy subscriber list under lock, then invoke without lock held
-    // to avoid deadlock if a callback calls publish/subscribe.
-    std::vector<Callback> to_call;
+uint32_t EventBus::subscribe(EventCategory cat, Callback cb) {
+    return add(1u << index(cat), std::move(cb), nullptr);
+}
+
+uint32_t EventBus::subscribe_all(Callback cb) {
+    return add(ALL_CATEGORIES, std::move(cb), nullptr);
+}
+
+uint32_t EventBus::subscribe_async(EventCategory cat, Callback cb, AsyncOptions opts) {
+    return add(1u << index(cat), std::move(cb), &opts);
+}
+
+uint32_t EventBus::subscribe_all_async(Callback cb, AsyncOptions opts) {
+    return add(ALL_CATEGORIES, std::move(cb), &opts);
+}
+
+void EventBus::unsubscribe(uint32_t sub_id) {
+    std::shared_ptr<AsyncSubscriber> async;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& s : subs_) {
-            if (s.all_categories || s.category == event.category) {
-                to_call.push_back(s.cb);
-            }
-        }
+        auto subs = list_.load(std::memory_order_relaxed)->subs;
+        auto it = std::find_if(subs.begin(), subs.end(),
+            [sub_id](const auto& s) { return s->id == sub_id; });
+        if (it == subs.end())
+            return;
+        async = (*it)->async;
+        subs.erase(it);
+        publish_list(std::move(subs));
     }
-    for (const auto& cb : to_call) {
-        cb(event);
+    // Joined without the lock: the dispatcher may still publish/subscribe
+    if (async)
+        async->stop();
+}
+
+void EventBus::publish(const EventRecord& event) {
+    // Callbacks may subscribe/unsubscribe: the list walked here stays valid
+    const SubscriberList* list = list_.load(std::memory_order_acquire);
+    for (const Subscription* s : list->by_category[index(event.category)]) {
+        if (s->async)
+            s->async->push(event);
+        else
+            s->cb(event);
+    }
+}
+
+void EventBus::flush() {
+    for (const auto& s : list_.load(std::memory_order_acquire)->subs) {
+        if (!s->async)
+            continue;
+        while (s->async->delivered.load(std::memory_order_acquire) <
+               s->async->enqueued.load(std::memory_order_acquire))
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+bool EventBus::subscriber_stats(uint32_t sub_id, SubscriberStats& out) const {
+    for (const auto& s : list_.load(std::memory_order_acquire)->subs) {
+        if (s->id != sub_id)
+            continue;
+        if (!s->async)
+            return false;
+        out.delivered = s->async->delivered.load(std::memory_order_relaxed);
+        out.dropped = s->async->dropped.load(std::memory_order_relaxed);
+        out.queued = s->async->queue.size();
+        return true;
     }
+    return false;
 }
 
 } // namespace nng
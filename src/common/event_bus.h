@@ -1,47 +1,174 @@
 #pragma once
 #include "common/types.h"
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <mutex>
 
 namespace nng {
 
+// Typed, fixed-size detail of an event. Publishers fill the fields; text is
+// rendered by render() only when a sink needs it.
+struct EventDetail {
+    enum class Kind : uint8_t {
+        NONE,        // no structured detail (see EventRecord::detail)
+        FRAME_ERROR, // error=<name> [len=<frame_len>]
+        SOURCE,      // src_id=<src_id>
+        SEQUENCE,    // src_id expected actual [gap]
+        PLOT,
+        TRACK,
+        HEARTBEAT,
+        ENGAGEMENT,
+        COALESCED,   // src_id=<src_id> suppressed=<count> [total=<amount>] window_ms=<ms>
+        ASSOCIATION, // src_id plot_id track_id [track_src] d_az d_range
+    };
+
+    struct FrameError { const char* error; uint32_t frame_len; }; // error: static string
+    struct Sequence   { uint32_t expected; uint32_t actual; uint32_t gap; };
+    struct Plot       { uint32_t plot_id; uint32_t range_m; };
+    struct Track      { uint32_t track_id; uint8_t classification; uint8_t threat_level; };
+    struct Heartbeat  { uint16_t subsystem_id; uint8_t state; uint8_t cpu_pct; uint8_t mem_pct; };
+    struct Engagement { uint16_t weapon_id; uint8_t mode; uint32_t track; uint16_t rounds; };
+    struct Coalesced  { uint32_t count; uint32_t amount; uint32_t window_ms; };
+    struct Association {
+        uint32_t plot_id; uint32_t track_id; uint16_t track_src;
+        int32_t d_az_mdeg; int32_t d_range_m;
+    };
+
+    Kind     kind = Kind::NONE;
+    uint16_t src_id = 0;
+    union {
+        FrameError frame_error;
+        Sequence   seq;
+        Plot       plot;
+        Track      track;
+        Heartbeat  heartbeat;
+        Engagement engagement;
+        Coalesced  coalesced;
+        Association association;
+    };
+
+    EventDetail() : seq{} {}
+
+    // Text form, as written to the log
+    std::string render() const;
+};
+
 struct EventRecord {
     EventId       id;
     EventCategory category;
     Severity      severity;
     uint64_t      timestamp_ns;
-    std::string   detail;
+    std::string   detail;  // free text, for events without structured fields
+    EventDetail   fields{};
+
+    // detail, or fields rendered when the event is structured
+    std::string detail_text() const {
+        return fields.kind == EventDetail::Kind::NONE ? detail : fields.render();
+    }
+};
+
+// What publish() does when an async subscriber's queue is full
+enum class EventOverflow {
+    DROP,  // discard the event for that subscriber and count it
+    BLOCK, // wait for the subscriber's dispatcher to make room
+};
+
+struct AsyncOptions {
+    std::size_t   queue_capacity = 1024; // rounded up to a power of two
+    EventOverflow overflow = EventOverflow::DROP;
 };
 
+// Delivery counters of one async subscriber
+struct SubscriberStats {
+    uint64_t delivered = 0; // callbacks run
+    uint64_t dropped   = 0; // events lost to a full queue
+    std::size_t queued = 0; // waiting in the queue now
+};
+
+// Publish/subscribe by EventCategory. Plain subscribers are called on the
+// publishing thread. Async subscribers each get a bounded lock-free queue
+// drained by their own dispatcher thread, so a slow callback only delays
+// (or, with EventOverflow::DROP, loses) its own events, never the
+// publisher.
+//
+// Subscriptions are read-copy-update: every change builds a new immutable
+// SubscriberList (one array per category) and swaps it in, so publish()
+// is one atomic load with no lock and no allocation. Replaced lists are
+// kept until the bus is destroyed, as a publisher may still be walking
+// one; they only accumulate as subscriptions change, which is rare.
 class EventBus {
 public:
     using Callback = std::function<void(const EventRecord&)>;
 
+    EventBus();
+    // Stops async dispatchers after they drain their queues
+    ~EventBus();
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
     // Subscribe to a specific category. Returns subscription ID.
     uint32_t subscribe(EventCategory cat, Callback cb);
 
     // Subscribe to all events. Returns subscription ID.
     uint32_t subscribe_all(Callback cb);
 
-    // Unsubscribe by ID.
+    // Same, delivered asynchronously on a dispatcher thread
+    uint32_t subscribe_async(EventCategory cat, Callback cb, AsyncOptions opts = {});
+    uint32_t subscribe_all_async(Callback cb, AsyncOptions opts = {});
+
+    // Unsubscribe by ID. An async subscriber's queued events are delivered
+    // first (unless it unsubscribes itself from its own callback).
     void unsubscribe(uint32_t sub_id);
 
-    // Publish an event (calls matching subscribers synchronously).
+    // Publish an event: calls matching plain subscribers synchronously and
+    // queues it for matching async ones.
     void publish(const EventRecord& event);
 
+    // Wait until every async subscriber has handled what was queued so far
+    void flush();
+
+    // Counters of an async subscriber; false for plain or unknown IDs
+    bool subscriber_stats(uint32_t sub_id, SubscriberStats& out) const;
+
+    // True if publishing to cat would reach anyone. Lock-free, so hot
+    // paths can skip building events nobody receives.
+    bool has_subscribers(EventCategory cat) const {
+        return !list_.load(std::memory_order_acquire)->by_category[index(cat)].empty();
+    }
+
 private:
+    struct AsyncSubscriber; // queue + dispatcher thread, see event_bus.cpp
+
+    static constexpr std::size_t CATEGORY_COUNT = static_cast<std::size_t>(EventCategory::CONTROL) + 1;
+    static constexpr uint32_t ALL_CATEGORIES = (1u << CATEGORY_COUNT) - 1;
+
+    static std::size_t index(EventCategory cat) { return static_cast<std::size_t>(cat); }
+
     struct Subscription {
-        uint32_t      id;
-        EventCategory category;
-        bool          all_categories;
-        Callback      cb;
+        uint32_t id;
+        uint32_t category_mask; // bit per EventCategory
+        Callback cb;
+        std::shared_ptr<AsyncSubscriber> async; // set for async subscribers
     };
 
-    std::mutex mutex_;
-    std::vector<Subscription> subs_;
+    // Immutable once published
+    struct SubscriberList {
+        std::vector<std::shared_ptr<const Subscription>> subs; // subscription order
+        std::vector<const Subscription*> by_category[CATEGORY_COUNT];
+    };
+
+    uint32_t add(uint32_t category_mask, Callback cb, const AsyncOptions* async);
+    // Build a list from subs and publish it; caller holds mutex_
+    void publish_list(std::vector<std::shared_ptr<const Subscription>> subs);
+
+    std::atomic<const SubscriberList*> list_{nullptr};
+    std::mutex mutex_; // serializes subscription changes
+    std::vector<std::unique_ptr<const SubscriberList>> lists_; // every list published
     uint32_t next_id_ = 1;
 };
 
@@ -0,0 +1,88 @@
+#include "common/histogram.h"
+#include <cmath>
+
+namespace nng {
+
+std::size_t HistogramLayout::bucket(uint64_t value) {
+    if (value < SUB_COUNT)
+        return static_cast<std::size_t>(value);
+    unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+    if (msb >= MAX_EXP)
+        return BUCKETS - 1;
+    unsigned shift = msb - SUB_BITS;
+    std::size_t sub = static_cast<std::size_t>(value >> shift) & (SUB_COUNT - 1);
+    return SUB_COUNT + shift * SUB_COUNT + sub;
+}
+
+uint64_t HistogramLayout::upper_bound(std::size_t i) {
+    if (i < SUB_COUNT)
+        return i;
+    std::size_t shift = (i - SUB_COUNT) / SUB_COUNT;
+    std::size_t sub = (i - SUB_COUNT) % SUB_COUNT;
+    uint64_t lower = static_cast<uint64_t>(SUB_COUNT + sub) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    for (std::size_t i = 0; i < counts.size(); ++i)
+        counts[i] += other.counts[i];
+    count += other.count;
+    if (other.max > max)
+        max = other.max;
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    // Bucket counts may run ahead of count while a writer is mid-record
+    uint64_t total = 0;
+    for (uint64_t c : counts)
+        total += c;
+    if (total == 0)
+        return 0;
+
+    if (q < 0.0)
+        q = 0.0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (rank == 0)
+        rank = 1;
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            if (i == counts.size() - 1)
+                return max; // overflow bucket
+            uint64_t v = HistogramLayout::upper_bound(i);
+            return v < max ? v : max;
+        }
+    }
+    return max;
+}
+
+void Histogram::add_to(HistogramSnapshot& out) const {
+    for (std::size_t i = 0; i < HistogramLayout::BUCKETS; ++i)
+        out.counts[i] += counts_[i].load(std::memory_order_relaxed);
+    out.count += count_.load(std::memory_order_relaxed);
+    uint64_t m = max_.load(std::memory_order_relaxed);
+    if (m > out.max)
+        out.max = m;
+}
+
+void Histogram::add(const Histogram& other) {
+    for (std::size_t i = 0; i < HistogramLayout::BUCKETS; ++i) {
+        counts_[i].store(counts_[i].load(std::memory_order_relaxed) +
+                         other.counts_[i].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    }
+    count_.store(count_.load(std::memory_order_relaxed) + other.count(), std::memory_order_relaxed);
+    uint64_t m = other.max_.load(std::memory_order_relaxed);
+    if (m > max_.load(std::memory_order_relaxed))
+        max_.store(m, std::memory_order_relaxed);
+}
+
+void Histogram::reset() {
+    for (auto& c : counts_)
+        c.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace nng
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace nng {
+
+// Log-linear bucketing of non-negative values (HDR-histogram style): values
+// below 16 get their own bucket, above that each power of two is split
+// into 16 linear sub-buckets, so a value is reported within 1/16 (6.25%)
+// of what was recorded. Values at or above 2^MAX_EXP (~68 s in ns) share
+// the top bucket; the maximum is kept exactly.
+struct HistogramLayout {
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr std::size_t SUB_COUNT = std::size_t{1} << SUB_BITS;
+    static constexpr unsigned MAX_EXP = 36;
+    static constexpr std::size_t BUCKETS = SUB_COUNT + (MAX_EXP - SUB_BITS) * SUB_COUNT;
+
+    static std::size_t bucket(uint64_t value);
+    // Largest value that falls in bucket i
+    static uint64_t upper_bound(std::size_t i);
+};
+
+// Plain copy of a histogram for reading, merging and percentiles
+struct HistogramSnapshot {
+    std::array<uint64_t, HistogramLayout::BUCKETS> counts{};
+    uint64_t count = 0;
+    uint64_t max = 0;
+
+    void merge(const HistogramSnapshot& other);
+    // Value at quantile q in [0, 1] (bucket upper bound, capped at max);
+    // 0 when empty
+    uint64_t percentile(double q) const;
+};
+
+// Fixed-size histogram with one writer and any number of readers. record()
+// is a relaxed load + store per counter: no locks, no allocation. A reader
+// may see a record() half applied (bucket counted, total not yet).
+class Histogram {
+public:
+    void record(uint64_t value) {
+        bump(counts_[HistogramLayout::bucket(value)]);
+        bump(count_);
+        if (value > max_.load(std::memory_order_relaxed))
+            max_.store(value, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    // Add this histogram's counts into out
+    void add_to(HistogramSnapshot& out) const;
+    // Writer side: fold other's counts into this one
+    void add(const Histogram& other);
+    void reset();
+
+private:
+    static void bump(std::atomic<uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts_[HistogramLayout::BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+} // namespace nng
@@ -1,10 +1,14 @@
 #include "common/logger.h"
+#include "common/mpsc_queue.h"
+#include <algorithm>
 #include <chrono>
-#include <iomanip>
+#include <cstdio>
 #include <iostream>
-#include <sstream>
+#include <string_view>
 #include <ctime>
+#include <cctype>
 #include <cstring>
+#include <utility>
 
 namespace nng {
 
@@ -33,24 +37,167 @@ const char* category_str(EventCategory c) {
     return "??????????";
 }
 
+namespace {
+
+bool iequals(std::string_view a, const char* b) {
+    std::size_t n = std::strlen(b);
+    if (a.size() != n)
+        return false;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::toupper(static_cast<unsigned char>(a[i])) != b[i])
+            return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool parse_severity(std::string_view name, Severity& out) {
+    static constexpr std::pair<const char*, Severity> NAMES[] = {
+        {"DEBUG", Severity::DEBUG}, {"INFO", Severity::INFO},   {"WARN", Severity::WARN},
+        {"ALARM", Severity::ALARM}, {"ERROR", Severity::ERROR}, {"FATAL", Severity::FATAL},
+    };
+    for (const auto& [n, sev] : NAMES) {
+        if (iequals(name, n)) {
+            out = sev;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_category(std::string_view name, EventCategory& out) {
+    static constexpr std::pair<const char*, EventCategory> NAMES[] = {
+        {"TRACKING", EventCategory::TRACKING}, {"THREAT", EventCategory::THREAT},
+        {"IFF", EventCategory::IFF},           {"ENGAGEMENT", EventCategory::ENGAGEMENT},
+        {"NETWORK", EventCategory::NETWORK},   {"HEALTH", EventCategory::HEALTH},
+        {"CONTROL", EventCategory::CONTROL},
+    };
+    for (const auto& [n, cat] : NAMES) {
+        if (iequals(name, n)) {
+            out = cat;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+uint64_t realtime_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void format_record(LogLineFormatter& fmt, std::string& out, const LogRecord& rec) {
+    std::string_view name(rec.name, rec.name_len);
+    if (rec.fields.kind != EventDetail::Kind::NONE)
+        fmt.append(out, rec.ts_ns, rec.sev, rec.cat, name, rec.fields.render());
+    else
+        fmt.append(out, rec.ts_ns, rec.sev, rec.cat, name, std::string_view(rec.text, rec.text_len));
+}
+
+// Idle writer: spin briefly, then yield, then sleep
+void backoff(unsigned& idle) {
+    ++idle;
+    if (idle < 64)
+        return;
+    if (idle < 256)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+void set_name(LogRecord& rec, std::string_view name) {
+    rec.name_len = static_cast<uint8_t>(std::min(name.size(), LogRecord::NAME_MAX));
+    std::memcpy(rec.name, name.data(), rec.name_len);
+}
+
+} // anonymous namespace
+
+void LogLineFormatter::append(std::string& out, uint64_t ts_ns, Severity sev, EventCategory cat,
+                              std::string_view event_name, std::string_view detail) {
+    auto sec = static_cast<int64_t>(ts_ns / 1000000000ULL);
+    if (sec != cached_sec_) {
+        auto t = static_cast<std::time_t>(sec);
+        std::tm utc{};
+        gmtime_r(&t, &utc);
+        char tmp[64]; // sized for any int fields, keeps -Wformat-truncation quiet
+        std::snprintf(tmp, sizeof(tmp), "%04d-%02d-%02dT%02d:%02d:%02d.",
+                      utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                      utc.tm_hour, utc.tm_min, utc.tm_sec);
+        std::memcpy(prefix_, tmp, PREFIX_LEN);
+        cached_sec_ = sec;
+    }
+
+    // prefix(20) "mmmZ [" sev(5) "] [" cat(10) "] " name(20)
+    constexpr std::size_t HEAD_LEN = PREFIX_LEN + 6 + 5 + 3 + 10 + 2 + LogRecord::NAME_MAX;
+    std::size_t pos = out.size();
+    out.resize(pos + HEAD_LEN);
+    char* p = &out[pos];
+
+    std::memcpy(p, prefix_, PREFIX_LEN);
+    p += PREFIX_LEN;
+    auto ms = static_cast<unsigned>((ts_ns / 1000000ULL) % 1000);
+    p[0] = static_cast<char>('0' + ms / 100);
+    p[1] = static_cast<char>('0' + ms / 10 % 10);
+    p[2] = static_cast<char>('0' + ms % 10);
+    std::memcpy(p + 3, "Z [", 3);
+    p += 6;
+    std::memcpy(p, severity_str(sev), 5);
+    std::memcpy(p + 5, "] [", 3);
+    p += 8;
+    std::memcpy(p, category_str(cat), 10);
+    std::memcpy(p + 10, "] ", 2);
+    p += 12;
+
+    // Pad event_name to 20 chars
+    std::size_t name_len = std::min(event_name.size(), LogRecord::NAME_MAX);
+    std::memcpy(p, event_name.data(), name_len);
+    std::memset(p + name_len, ' ', LogRecord::NAME_MAX - name_len);
+
+    out.append(detail.data(), detail.size());
+    out += '\n';
+}
+
 Logger::Logger() : out_(&std::cout) {}
 
+Logger::~Logger() {
+    stop_async();
+}
+
 Logger& Logger::instance() {
     static Logger inst;
     return inst;
 }
 
 void Logger::set_level(Severity level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    level_ = level;
+    std::lock_guard<std::mutex> lock(level_mutex_);
+    for (auto& l : cat_level_)
+        l.store(level, std::memory_order_relaxed);
+    min_level_.store(level, std::memory_order_relaxed);
+    level_.store(level, std::memory_order_relaxed);
 }
 
 Severity Logger::get_level() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return level_;
+    return level_.load(std::memory_order_relaxed);
+}
+
+void Logger::set_level(EventCategory cat, Severity level) {
+    std::lock_guard<std::mutex> lock(level_mutex_);
+    cat_level_[static_cast<std::size_t>(cat)].store(level, std::memory_order_relaxed);
+    Severity lowest = level;
+    for (const auto& l : cat_level_)
+        lowest = std::min(lowest, l.load(std::memory_order_relaxed));
+    min_level_.store(lowest, std::memory_order_relaxed);
+}
+
+Severity Logger::get_level(EventCategory cat) const {
+    return cat_level_[static_cast<std::size_t>(cat)].load(std::memory_order_relaxed);
 }
 
 void Logger::set_output(std::ostream& os) {
+    flush();
     std::lock_guard<std::mutex> lock(mutex_);
     out_ = &os;
 }
@@ -58,38 +205,117 @@ void Logger::set_output(std::ostream& os) {
 void Logger::log(Severity sev, EventCategory cat,
                  const std::string& event_name,
                  const std::string& detail) {
+    // Severity filter
+    if (!enabled(sev, cat))
+        return;
+
+    if (is_async()) {
+        LogRecord rec;
+        rec.ts_ns = realtime_ns();
+        rec.sev = sev;
+        rec.cat = cat;
+        set_name(rec, event_name);
+        rec.text_len = static_cast<uint16_t>(std::min(detail.size(), LogRecord::TEXT_MAX));
+        std::memcpy(rec.text, detail.data(), rec.text_len);
+        enqueue(rec);
+        return;
+    }
+
+    // Per-thread, so the buffer's capacity and the cached second carry over
+    thread_local LogLineFormatter fmt;
+    thread_local std::string line;
+    line.clear();
+    fmt.append(line, realtime_ns(), sev, cat, event_name, detail);
     std::lock_guard<std::mutex> lock(mutex_);
+    if (out_)
+        out_->write(line.data(), static_cast<std::streamsize>(line.size()));
+}
 
-    // Severity filter
-    if (static_cast<uint8_t>(sev) < static_cast<uint8_t>(level_))
+void Logger::log_event(Severity sev, EventCategory cat, EventId id, const EventDetail& detail) {
+    if (!enabled(sev, cat))
         return;
 
-    if (!out_)
+    if (!is_async()) {
+        log(sev, cat, event_name(id), detail.render());
         return;
+    }
 
-    // Timestamp: ISO 8601 with milliseconds
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+    LogRecord rec;
+    rec.ts_ns = realtime_ns();
+    rec.sev = sev;
+    rec.cat = cat;
+    set_name(rec, event_name(id));
+    rec.fields = detail;
+    enqueue(rec);
+}
 
-    std::tm utc{};
-    gmtime_r(&time_t_now, &utc);
+void Logger::enqueue(const LogRecord& rec) {
+    // A failed push means the queue was full, however many threads log
+    if (queue_->try_push(rec))
+        enqueued_.fetch_add(1, std::memory_order_release);
+    else
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+}
 
-    // Pad event_name to 20 chars
-    char evt_buf[21];
-    std::memset(evt_buf, ' ', 20);
-    evt_buf[20] = '\0';
-    std::size_t name_len = event_name.size();
-    if (name_len > 20) name_len = 20;
-    std::memcpy(evt_buf, event_name.data(), name_len);
-
-    *out_ << std::put_time(&utc, "%Y-%m-%dT%H:%M:%S")
-          << '.' << std::setfill('0') << std::setw(3) << ms.count() << 'Z'
-          << " [" << severity_str(sev) << "] "
-          << "[" << category_str(cat) << "] "
-          << evt_buf
-          << detail << '\n';
+void Logger::start_async(std::size_t capacity) {
+    std::lock_guard<std::mutex> guard(async_mutex_);
+    if (is_async())
+        return;
+    // The queue outlives stop_async(): a log() racing with it may still
+    // push (and is written after the next start_async())
+    if (!queue_)
+        queue_ = std::make_unique<MpscQueue<LogRecord>>(capacity);
+    stopping_.store(false);
+    writer_ = std::thread(&Logger::writer_loop, this);
+    async_.store(true, std::memory_order_release);
+}
+
+void Logger::stop_async() {
+    std::lock_guard<std::mutex> guard(async_mutex_);
+    if (!is_async())
+        return;
+    async_.store(false, std::memory_order_release);
+    stopping_.store(true);
+    writer_.join();
+}
+
+void Logger::flush() {
+    if (!is_async())
+        return;
+    while (written_.load(std::memory_order_acquire) < enqueued_.load(std::memory_order_acquire))
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+void Logger::writer_loop() {
+    constexpr std::size_t BATCH = 64;
+    std::unique_ptr<LogRecord[]> batch(new LogRecord[BATCH]);
+    LogLineFormatter fmt;
+    std::string buf;
+    buf.reserve(BATCH * 128);
+    unsigned idle = 0;
+
+    while (true) {
+        std::size_t n = queue_->try_pop_n(batch.get(), BATCH);
+        if (n == 0) {
+            if (stopping_.load() && queue_->empty())
+                break;
+            backoff(idle);
+            continue;
+        }
+        idle = 0;
+
+        buf.clear();
+        for (std::size_t i = 0; i < n; ++i)
+            format_record(fmt, buf, batch[i]);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (out_) {
+                out_->write(buf.data(), static_cast<std::streamsize>(buf.size()));
+                out_->flush();
+            }
+        }
+        written_.fetch_add(n, std::memory_order_release);
+    }
 }
 
 } // namespace nng
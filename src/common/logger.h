@@ -1,17 +1,85 @@
 #pragma once
 #include "common/types.h"
+#include "common/event_bus.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <ostream>
 #include <mutex>
+#include <thread>
 
 namespace nng {
 
+template <typename T> class MpscQueue;
+
+// One message as queued by the async logger: fixed size, no pointers into
+// the caller's memory. Typed records carry the EventDetail and are only
+// rendered by the writer thread; free-text ones carry their text.
+struct LogRecord {
+    static constexpr std::size_t NAME_MAX = 20;  // event names are padded/cut to this
+    static constexpr std::size_t TEXT_MAX = 192; // longer free text is truncated
+
+    uint64_t      ts_ns = 0; // CLOCK_REALTIME when logged
+    Severity      sev = Severity::INFO;
+    EventCategory cat = EventCategory::CONTROL;
+    uint8_t       name_len = 0;
+    uint16_t      text_len = 0;
+    EventDetail   fields{}; // used when fields.kind != NONE
+    char          name[NAME_MAX] = {};
+    char          text[TEXT_MAX] = {};
+};
+
+// Formats log lines without iostreams. The "YYYY-MM-DDTHH:MM:SS." prefix
+// is rebuilt only when the second changes; the rest is copied in with
+// memcpy. Not thread-safe: each writer owns one.
+class LogLineFormatter {
+public:
+    // Append one line (with newline) to out. Lines look like
+    // 2025-07-15T14:23:01.001Z [INFO ] [TRACKING  ] EVT_TRACK_NEW       detail...
+    void append(std::string& out, uint64_t ts_ns, Severity sev, EventCategory cat,
+                std::string_view event_name, std::string_view detail);
+
+private:
+    static constexpr std::size_t PREFIX_LEN = 20; // up to and including the '.'
+
+    int64_t cached_sec_ = -1;
+    char prefix_[PREFIX_LEN] = {};
+};
+
 class Logger {
 public:
+    static constexpr std::size_t DEFAULT_ASYNC_CAPACITY = 8192; // records
+    static constexpr std::size_t CATEGORY_COUNT = 7;
+
+    ~Logger();
+
+    // Threshold for every category (overrides per-category levels)
     void set_level(Severity level);
     Severity get_level() const;
 
+    // Threshold for one category, e.g. DEBUG for TRACKING only
+    void set_level(EventCategory cat, Severity level);
+    Severity get_level(EventCategory cat) const;
+
+    // True if a message at sev in cat would be written. Lock-free, so
+    // callers can skip formatting messages that would be filtered out.
+    bool enabled(Severity sev, EventCategory cat) const {
+        return static_cast<uint8_t>(sev) >=
+               static_cast<uint8_t>(cat_level_[static_cast<std::size_t>(cat)].load(
+                   std::memory_order_relaxed));
+    }
+
+    // True if sev passes in at least one category
+    bool enabled(Severity sev) const {
+        return static_cast<uint8_t>(sev) >=
+               static_cast<uint8_t>(min_level_.load(std::memory_order_relaxed));
+    }
+
     // Set output stream (default: std::cout). Caller owns the stream lifetime.
+    // In async mode, records already queued are written to the old stream.
     void set_output(std::ostream& os);
 
     // Log a structured message.
@@ -20,6 +88,25 @@ public:
              const std::string& event_name,
              const std::string& detail);
 
+    // Same, with typed detail: in async mode the text is rendered by the
+    // writer thread, not the caller
+    void log_event(Severity sev, EventCategory cat, EventId id, const EventDetail& detail);
+
+    // Async mode: log() pushes a LogRecord into a lock-free queue of
+    // capacity records and returns; a background thread formats and writes
+    // them in batches. Records that find the queue full are dropped and
+    // counted. stop_async() (also run on destruction) writes out everything
+    // queued before returning to synchronous logging.
+    void start_async(std::size_t capacity = DEFAULT_ASYNC_CAPACITY);
+    void stop_async();
+    bool is_async() const { return async_.load(std::memory_order_acquire); }
+
+    // Wait until every record queued so far has been written (async mode)
+    void flush();
+
+    // Records dropped because the async queue was full
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
     static Logger& instance();
 
     // Prevent copy
@@ -29,13 +116,36 @@ public:
 private:
     Logger();
 
-    mutable std::mutex mutex_;
-    Severity level_ = Severity::INFO;
+    void enqueue(const LogRecord& rec);
+    void writer_loop();
+
+    mutable std::mutex mutex_; // guards out_ and the writes to it
+    std::mutex level_mutex_; // serializes level setters (min_level_ update)
+    std::atomic<Severity> level_{Severity::INFO};
+    std::atomic<Severity> min_level_{Severity::INFO}; // lowest of cat_level_
+    std::atomic<Severity> cat_level_[CATEGORY_COUNT] = {
+        Severity::INFO, Severity::INFO, Severity::INFO, Severity::INFO,
+        Severity::INFO, Severity::INFO, Severity::INFO,
+    };
     std::ostream* out_ = nullptr; // set in constructor to &std::cout
+
+    std::mutex async_mutex_; // serializes start_async/stop_async
+    std::unique_ptr<MpscQueue<LogRecord>> queue_;
+    std::thread writer_;
+    std::atomic<bool> async_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
 };
 
 // Helpers for converting enums to padded strings (used by logger and tests)
 const char* severity_str(Severity s);
 const char* category_str(EventCategory c);
 
+// Parse an unpadded, case-insensitive name ("DEBUG", "tracking").
+// Return false if unknown.
+bool parse_severity(std::string_view name, Severity& out);
+bool parse_category(std::string_view name, EventCategory& out);
+
 } // namespace nng
@@ -0,0 +1,115 @@
+#include "common/mmap_log_sink.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace nng {
+
+MmapLogSink::MmapLogSink() : stream_(this) {}
+
+MmapLogSink::~MmapLogSink() {
+    close();
+}
+
+bool MmapLogSink::open(const std::string& path, std::size_t segment_bytes,
+                       std::size_t max_segments) {
+    close();
+    path_ = path;
+    segment_bytes_ = std::max(segment_bytes, MIN_SEGMENT_BYTES);
+    max_segments_ = max_segments;
+    written_ = 0;
+    errors_ = 0;
+    trim_errors_ = 0;
+    return map_segment(0);
+}
+
+void MmapLogSink::close() {
+    unmap_segment();
+}
+
+std::string MmapLogSink::segment_path(uint64_t index) const {
+    return path_ + "." + std::to_string(index);
+}
+
+bool MmapLogSink::map_segment(uint64_t index) {
+    std::string p = segment_path(index);
+    int fd = ::open(p.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    // Reserve the blocks up front so page faults never hit a full disk;
+    // fall back to a sparse file where fallocate is unsupported
+    auto size = static_cast<off_t>(segment_bytes_);
+    if (::posix_fallocate(fd, 0, size) != 0 && ::ftruncate(fd, size) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* addr = ::mmap(nullptr, segment_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    base_ = static_cast<char*>(addr);
+    used_ = 0;
+    index_ = index;
+
+    if (max_segments_ > 0 && index >= max_segments_)
+        ::unlink(segment_path(index - max_segments_).c_str());
+    return true;
+}
+
+void MmapLogSink::unmap_segment() {
+    if (!base_)
+        return;
+    ::munmap(base_, segment_bytes_);
+    // Drop the unused preallocated tail
+    if (::ftruncate(fd_, static_cast<off_t>(used_)) != 0)
+        ++trim_errors_;
+    ::close(fd_);
+    base_ = nullptr;
+    fd_ = -1;
+    used_ = 0;
+}
+
+std::streamsize MmapLogSink::xsputn(const char* s, std::streamsize n) {
+    auto left = static_cast<std::size_t>(n);
+    while (left > 0) {
+        if (!base_)
+            break;
+        if (used_ == segment_bytes_ ||
+            (left <= segment_bytes_ && left > segment_bytes_ - used_)) {
+            // Rotate rather than split a write that fits in one segment
+            uint64_t next = index_ + 1;
+            unmap_segment();
+            if (!map_segment(next))
+                break;
+        }
+        std::size_t chunk = std::min(left, segment_bytes_ - used_);
+        std::memcpy(base_ + used_, s, chunk);
+        used_ += chunk;
+        written_ += chunk;
+        s += chunk;
+        left -= chunk;
+    }
+    errors_ += left;
+    return n - static_cast<std::streamsize>(left);
+}
+
+MmapLogSink::int_type MmapLogSink::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+    char ch = traits_type::to_char_type(c);
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+}
+
+int MmapLogSink::sync() {
+    return 0;
+}
+
+} // namespace nng
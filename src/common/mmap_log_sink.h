@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace nng {
+
+// Log output that appends into a memory-mapped file instead of issuing a
+// write() per line. Each segment file is preallocated to segment_bytes and
+// mapped; lines are copied into the mapping and the kernel writes dirty
+// pages back on its own schedule. When a segment is full the sink rotates
+// to the next one (<path>.0, <path>.1, ...), trimming the finished file to
+// the bytes written. With max_segments > 0 the oldest segment beyond that
+// count is deleted.
+//
+// Use it through stream(), e.g. Logger::instance().set_output(sink.stream()).
+// Not thread-safe on its own; Logger serializes writes to its output. Until
+// close(), the active segment ends in zero bytes after the last line.
+class MmapLogSink : public std::streambuf {
+public:
+    static constexpr std::size_t DEFAULT_SEGMENT_BYTES = 64 * 1024 * 1024;
+    static constexpr std::size_t MIN_SEGMENT_BYTES = 4096;
+
+    MmapLogSink();
+    ~MmapLogSink() override;
+
+    MmapLogSink(const MmapLogSink&) = delete;
+    MmapLogSink& operator=(const MmapLogSink&) = delete;
+
+    // Open the first segment, <path>.0. segment_bytes is raised to at least
+    // MIN_SEGMENT_BYTES.
+    bool open(const std::string& path, std::size_t segment_bytes = DEFAULT_SEGMENT_BYTES,
+              std::size_t max_segments = 0);
+
+    // Trim and unmap the active segment
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+
+    std::ostream& stream() { return stream_; }
+
+    // Path of segment index
+    std::string segment_path(uint64_t index) const;
+
+    uint64_t segment_index() const { return index_; }   // active segment
+    uint64_t bytes_written() const { return written_; } // across all segments
+    uint64_t write_errors() const { return errors_; }    // bytes lost to failed rotations
+    uint64_t trim_errors() const { return trim_errors_; } // segments left at full size
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int_type overflow(int_type c) override;
+    int sync() override; // no msync: write-back is left to the kernel
+
+private:
+    bool map_segment(uint64_t index);
+    void unmap_segment();
+
+    std::ostream stream_;
+    std::string path_;
+    std::size_t segment_bytes_ = DEFAULT_SEGMENT_BYTES;
+    std::size_t max_segments_ = 0;
+    int fd_ = -1;
+    char* base_ = nullptr;
+    std::size_t used_ = 0;
+    uint64_t index_ = 0;
+    uint64_t written_ = 0;
+    uint64_t errors_ = 0;
+    uint64_t trim_errors_ = 0;
+};
+
+} // namespace nng
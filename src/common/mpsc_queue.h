@@ -0,0 +1,104 @@
+#pragma once
+#include "common/spsc_ring.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace nng {
+
+// Bounded multi-producer / single-consumer queue. Capacity is rounded up to
+// a power of two. Any number of threads may push; exactly one thread pops.
+//
+// Producers claim slots by CAS on the tail (a batch claims a contiguous
+// run with one CAS), write them, then mark each slot ready with its
+// sequence number. The consumer pops slots in order once they are marked,
+// so a producer that is slow to finish only delays items behind its own.
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(std::size_t capacity)
+        : capacity_(round_up_pow2(capacity > 0 ? capacity : 1)),
+          mask_(capacity_ - 1),
+          cells_(new Cell[capacity_]) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Producer side (any thread). Returns false only if the queue is full.
+    bool try_push(const T& value) {
+        return try_push_n(&value, 1) == 1;
+    }
+
+    // Push up to count values as one contiguous run; returns how many fit.
+    std::size_t try_push_n(const T* values, std::size_t count) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        std::size_t n = 0;
+        for (;;) {
+            std::size_t used = pos - head_.load(std::memory_order_acquire);
+            if (used > capacity_) {
+                // pos is stale: other producers moved the tail on and the
+                // consumer popped past it since it was read
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            n = count < capacity_ - used ? count : capacity_ - used;
+            if (n == 0)
+                return 0; // full (a newer tail would only be fuller)
+            if (tail_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                break;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            Cell& c = cells_[(pos + i) & mask_];
+            c.value = values[i];
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Consumer side. Returns false if nothing is ready.
+    bool try_pop(T& out) {
+        return try_pop_n(&out, 1) == 1;
+    }
+
+    // Pop up to max ready values, in order; returns how many were taken.
+    std::size_t try_pop_n(T* out, std::size_t max) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t n = 0;
+        while (n < max) {
+            Cell& c = cells_[(head + n) & mask_];
+            if (c.seq.load(std::memory_order_acquire) != head + n + 1)
+                break;
+            out[n] = c.value;
+            ++n;
+        }
+        if (n > 0)
+            head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Claimed slots, including ones still being written. Approximate when
+    // called concurrently with push/pop.
+    std::size_t size() const {
+        std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty() const { return size() == 0; }
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq{0}; // pos + 1 once the value at pos is ready
+        T value{};
+    };
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{0}; // shared by producers
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_{0}; // consumer only
+};
+
+} // namespace nng
@@ -1,7 +1,9 @@
 #pragma once
 #include "common/types.h"
+#include <cstddef>
 #include <cstring>
 #include <cstdint>
+#include <type_traits>
 
 namespace nng {
 
@@ -62,6 +64,17 @@ struct EngagementPayload {
 };
 static_assert(sizeof(EngagementPayload) == 13, "EngagementPayload must be 13 bytes");
 
+// Protocol v2 datagram: frame_count v1 frames (header + payload, no
+// per-frame CRC) back to back in body_len bytes. With CONTAINER_FLAG_CRC a
+// CRC32 over the container header and body follows the body.
+struct ContainerHeader {
+    uint8_t  version;     // PROTOCOL_VERSION_V2
+    uint8_t  flags;       // CONTAINER_FLAG_*
+    uint16_t frame_count;
+    uint16_t body_len;
+};
+static_assert(sizeof(ContainerHeader) == CONTAINER_HEADER_SIZE, "ContainerHeader must be 6 bytes");
+
 #pragma pack(pop)
 
 // --- Serialization (little-endian, memcpy-based for packed structs on x86) ---
@@ -76,6 +89,16 @@ inline TelemetryHeader deserialize_header(const uint8_t* buf) {
     return h;
 }
 
+inline void serialize_container_header(const ContainerHeader& h, uint8_t* buf) {
+    std::memcpy(buf, &h, sizeof(ContainerHeader));
+}
+
+inline ContainerHeader deserialize_container_header(const uint8_t* buf) {
+    ContainerHeader h;
+    std::memcpy(&h, buf, sizeof(ContainerHeader));
+    return h;
+}
+
 inline void serialize_plot(const PlotPayload& p, uint8_t* buf) {
     std::memcpy(buf, &p, sizeof(PlotPayload));
 }
@@ -116,4 +139,245 @@ inline EngagementPayload deserialize_engagement(const uint8_t* buf) {
     return e;
 }
 
+// --- Zero-copy views ---
+// Read single fields of a wire struct where it lies in the frame, instead
+// of copying the whole struct out to look at two of them. Fields are
+// little-endian on the wire: a load is a plain (unaligned) memcpy on a
+// little-endian host and byte-swapped on a big-endian one.
+
+constexpr bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+template <typename T>
+constexpr T byte_swap(T v) {
+    static_assert(std::is_integral_v<T>, "byte_swap needs an integer");
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    if constexpr (sizeof(T) == 2)
+        u = static_cast<U>(__builtin_bswap16(u));
+    else if constexpr (sizeof(T) == 4)
+        u = static_cast<U>(__builtin_bswap32(u));
+    else if constexpr (sizeof(T) == 8)
+        u = static_cast<U>(__builtin_bswap64(u));
+    return static_cast<T>(u);
+}
+
+template <typename T>
+inline T load_le(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    if constexpr (!HOST_LITTLE_ENDIAN && sizeof(T) > 1)
+        v = byte_swap(v);
+    return v;
+}
+
+// Base of the views: S is the packed struct whose bytes data points at
+template <typename S>
+class WireView {
+public:
+    using Struct = S;
+    static constexpr std::size_t SIZE = sizeof(S);
+
+    explicit WireView(const uint8_t* data) : data_(data) {}
+    const uint8_t* data() const { return data_; }
+
+    // The whole struct, for callers that keep it
+    S copy() const {
+        S s;
+        std::memcpy(&s, data_, sizeof(S));
+        return s;
+    }
+
+protected:
+    template <typename T, std::size_t Offset>
+    T field() const {
+        static_assert(Offset + sizeof(T) <= sizeof(S), "field runs past the struct");
+        return load_le<T>(data_ + Offset);
+    }
+
+private:
+    const uint8_t* data_;
+};
+
+// Offsets are summed from the field sizes; the static_asserts after each
+// view tie them to the packed struct, so neither can change alone.
+
+class HeaderView : public WireView<TelemetryHeader> {
+public:
+    using WireView::WireView;
+    static constexpr std::size_t VERSION     = 0;
+    static constexpr std::size_t MSG_TYPE    = VERSION + sizeof(uint8_t);
+    static constexpr std::size_t SRC_ID      = MSG_TYPE + sizeof(uint8_t);
+    static constexpr std::size_t SEQ         = SRC_ID + sizeof(uint16_t);
+    static constexpr std::size_t TS_NS       = SEQ + sizeof(uint32_t);
+    static constexpr std::size_t PAYLOAD_LEN = TS_NS + sizeof(uint64_t);
+    static constexpr std::size_t END         = PAYLOAD_LEN + sizeof(uint16_t);
+
+    uint8_t  version() const     { return field<uint8_t, VERSION>(); }
+    uint8_t  msg_type() const    { return field<uint8_t, MSG_TYPE>(); }
+    uint16_t src_id() const      { return field<uint16_t, SRC_ID>(); }
+    uint32_t seq() const         { return field<uint32_t, SEQ>(); }
+    uint64_t ts_ns() const       { return field<uint64_t, TS_NS>(); }
+    uint16_t payload_len() const { return field<uint16_t, PAYLOAD_LEN>(); }
+};
+static_assert(HeaderView::MSG_TYPE == offsetof(TelemetryHeader, msg_type) &&
+              HeaderView::SRC_ID == offsetof(TelemetryHeader, src_id) &&
+              HeaderView::SEQ == offsetof(TelemetryHeader, seq) &&
+              HeaderView::TS_NS == offsetof(TelemetryHeader, ts_ns) &&
+              HeaderView::PAYLOAD_LEN == offsetof(TelemetryHeader, payload_len) &&
+              HeaderView::END == sizeof(TelemetryHeader),
+              "HeaderView must match TelemetryHeader");
+
+class PlotView : public WireView<PlotPayload> {
+public:
+    using WireView::WireView;
+    static constexpr std::size_t PLOT_ID      = 0;
+    static constexpr std::size_t AZIMUTH      = PLOT_ID + sizeof(uint32_t);
+    static constexpr std::size_t ELEVATION    = AZIMUTH + sizeof(int32_t);
+    static constexpr std::size_t RANGE        = ELEVATION + sizeof(int32_t);
+    static constexpr std::size_t AMPLITUDE    = RANGE + sizeof(uint32_t);
+    static constexpr std::size_t DOPPLER      = AMPLITUDE + sizeof(int16_t);
+    static constexpr std::size_t QUALITY      = DOPPLER + sizeof(int16_t);
+    static constexpr std::size_t END          = QUALITY + sizeof(uint8_t);
+
+    uint32_t plot_id() const        { return field<uint32_t, PLOT_ID>(); }
+    int32_t  azimuth_mdeg() const   { return field<int32_t, AZIMUTH>(); }
+    int32_t  elevation_mdeg() const { return field<int32_t, ELEVATION>(); }
+    uint32_t range_m() const        { return field<uint32_t, RANGE>(); }
+    int16_t  amplitude_db() const   { return field<int16_t, AMPLITUDE>(); }
+    int16_t  doppler_mps() const    { return field<int16_t, DOPPLER>(); }
+    uint8_t  quality() const        { return field<uint8_t, QUALITY>(); }
+};
+static_assert(PlotView::AZIMUTH == offsetof(PlotPayload, azimuth_mdeg) &&
+              PlotView::ELEVATION == offsetof(PlotPayload, elevation_mdeg) &&
+              PlotView::RANGE == offsetof(PlotPayload, range_m) &&
+              PlotView::AMPLITUDE == offsetof(PlotPayload, amplitude_db) &&
+              PlotView::DOPPLER == offsetof(PlotPayload, doppler_mps) &&
+              PlotView::QUALITY == offsetof(PlotPayload, quality) &&
+              PlotView::END == sizeof(PlotPayload),
+              "PlotView must match PlotPayload");
+
+class TrackView : public WireView<TrackPayload> {
+public:
+    using WireView::WireView;
+    static constexpr std::size_t TRACK_ID       = 0;
+    static constexpr std::size_t CLASSIFICATION = TRACK_ID + sizeof(uint32_t);
+    static constexpr std::size_t THREAT_LEVEL   = CLASSIFICATION + sizeof(uint8_t);
+    static constexpr std::size_t IFF_STATUS     = THREAT_LEVEL + sizeof(uint8_t);
+    static constexpr std::size_t AZIMUTH        = IFF_STATUS + sizeof(uint8_t);
+    static constexpr std::size_t ELEVATION      = AZIMUTH + sizeof(int32_t);
+    static constexpr std::size_t RANGE          = ELEVATION + sizeof(int32_t);
+    static constexpr std::size_t VELOCITY       = RANGE + sizeof(uint32_t);
+    static constexpr std::size_t RCS            = VELOCITY + sizeof(int16_t);
+    static constexpr std::size_t UPDATE_COUNT   = RCS + sizeof(int16_t);
+    static constexpr std::size_t END            = UPDATE_COUNT + sizeof(uint16_t);
+
+    uint32_t track_id() const       { return field<uint32_t, TRACK_ID>(); }
+    uint8_t  classification() const { return field<uint8_t, CLASSIFICATION>(); }
+    uint8_t  threat_level() const   { return field<uint8_t, THREAT_LEVEL>(); }
+    uint8_t  iff_status() const     { return field<uint8_t, IFF_STATUS>(); }
+    int32_t  azimuth_mdeg() const   { return field<int32_t, AZIMUTH>(); }
+    int32_t  elevation_mdeg() const { return field<int32_t, ELEVATION>(); }
+    uint32_t range_m() const        { return field<uint32_t, RANGE>(); }
+    int16_t  velocity_mps() const   { return field<int16_t, VELOCITY>(); }
+    int16_t  rcs_dbsm() const       { return field<int16_t, RCS>(); }
+    uint16_t update_count() const   { return field<uint16_t, UPDATE_COUNT>(); }
+};
+static_assert(TrackView::CLASSIFICATION == offsetof(TrackPayload, classification) &&
+              TrackView::THREAT_LEVEL == offsetof(TrackPayload, threat_level) &&
+              TrackView::IFF_STATUS == offsetof(TrackPayload, iff_status) &&
+              TrackView::AZIMUTH == offsetof(TrackPayload, azimuth_mdeg) &&
+              TrackView::ELEVATION == offsetof(TrackPayload, elevation_mdeg) &&
+              TrackView::RANGE == offsetof(TrackPayload, range_m) &&
+              TrackView::VELOCITY == offsetof(TrackPayload, velocity_mps) &&
+              TrackView::RCS == offsetof(TrackPayload, rcs_dbsm) &&
+              TrackView::UPDATE_COUNT == offsetof(TrackPayload, update_count) &&
+              TrackView::END == sizeof(TrackPayload),
+              "TrackView must match TrackPayload");
+
+class HeartbeatView : public WireView<HeartbeatPayload> {
+public:
+    using WireView::WireView;
+    static constexpr std::size_t SUBSYSTEM_ID = 0;
+    static constexpr std::size_t STATE        = SUBSYSTEM_ID + sizeof(uint16_t);
+    static constexpr std::size_t CPU_PCT      = STATE + sizeof(uint8_t);
+    static constexpr std::size_t MEM_PCT      = CPU_PCT + sizeof(uint8_t);
+    static constexpr std::size_t UPTIME       = MEM_PCT + sizeof(uint8_t);
+    static constexpr std::size_t ERROR_CODE   = UPTIME + sizeof(uint32_t);
+    static constexpr std::size_t END          = ERROR_CODE + sizeof(uint16_t);
+
+    uint16_t subsystem_id() const { return field<uint16_t, SUBSYSTEM_ID>(); }
+    uint8_t  state() const        { return field<uint8_t, STATE>(); }
+    uint8_t  cpu_pct() const      { return field<uint8_t, CPU_PCT>(); }
+    uint8_t  mem_pct() const      { return field<uint8_t, MEM_PCT>(); }
+    uint32_t uptime_s() const     { return field<uint32_t, UPTIME>(); }
+    uint16_t error_code() const   { return field<uint16_t, ERROR_CODE>(); }
+};
+static_assert(HeartbeatView::STATE == offsetof(HeartbeatPayload, state) &&
+              HeartbeatView::CPU_PCT == offsetof(HeartbeatPayload, cpu_pct) &&
+              HeartbeatView::MEM_PCT == offsetof(HeartbeatPayload, mem_pct) &&
+              HeartbeatView::UPTIME == offsetof(HeartbeatPayload, uptime_s) &&
+              HeartbeatView::ERROR_CODE == offsetof(HeartbeatPayload, error_code) &&
+              HeartbeatView::END == sizeof(HeartbeatPayload),
+              "HeartbeatView must match HeartbeatPayload");
+
+class EngagementView : public WireView<EngagementPayload> {
+public:
+    using WireView::WireView;
+    static constexpr std::size_t WEAPON_ID      = 0;
+    static constexpr std::size_t MODE           = WEAPON_ID + sizeof(uint16_t);
+    static constexpr std::size_t ASSIGNED_TRACK = MODE + sizeof(uint8_t);
+    static constexpr std::size_t ROUNDS         = ASSIGNED_TRACK + sizeof(uint32_t);
+    static constexpr std::size_t BARREL_TEMP    = ROUNDS + sizeof(uint16_t);
+    static constexpr std::size_t BURST_COUNT    = BARREL_TEMP + sizeof(int16_t);
+    static constexpr std::size_t END            = BURST_COUNT + sizeof(uint16_t);
+
+    uint16_t weapon_id() const        { return field<uint16_t, WEAPON_ID>(); }
+    uint8_t  mode() const             { return field<uint8_t, MODE>(); }
+    uint32_t assigned_track() const   { return field<uint32_t, ASSIGNED_TRACK>(); }
+    uint16_t rounds_remaining() const { return field<uint16_t, ROUNDS>(); }
+    int16_t  barrel_temp_c() const    { return field<int16_t, BARREL_TEMP>(); }
+    uint16_t burst_count() const      { return field<uint16_t, BURST_COUNT>(); }
+};
+static_assert(EngagementView::MODE == offsetof(EngagementPayload, mode) &&
+              EngagementView::ASSIGNED_TRACK == offsetof(EngagementPayload, assigned_track) &&
+              EngagementView::ROUNDS == offsetof(EngagementPayload, rounds_remaining) &&
+              EngagementView::BARREL_TEMP == offsetof(EngagementPayload, barrel_temp_c) &&
+              EngagementView::BURST_COUNT == offsetof(EngagementPayload, burst_count) &&
+              EngagementView::END == sizeof(EngagementPayload),
+              "EngagementView must match EngagementPayload");
+
+class ContainerView : public WireView<ContainerHeader> {
+public:
+    using WireView::WireView;
+    static constexpr std::size_t VERSION     = 0;
+    static constexpr std::size_t FLAGS       = VERSION + sizeof(uint8_t);
+    static constexpr std::size_t FRAME_COUNT = FLAGS + sizeof(uint8_t);
+    static constexpr std::size_t BODY_LEN    = FRAME_COUNT + sizeof(uint16_t);
+    static constexpr std::size_t END         = BODY_LEN + sizeof(uint16_t);
+
+    uint8_t  version() const     { return field<uint8_t, VERSION>(); }
+    uint8_t  flags() const       { return field<uint8_t, FLAGS>(); }
+    uint16_t frame_count() const { return field<uint16_t, FRAME_COUNT>(); }
+    uint16_t body_len() const    { return field<uint16_t, BODY_LEN>(); }
+};
+static_assert(ContainerView::FLAGS == offsetof(ContainerHeader, flags) &&
+              ContainerView::FRAME_COUNT == offsetof(ContainerHeader, frame_count) &&
+              ContainerView::BODY_LEN == offsetof(ContainerHeader, body_len) &&
+              ContainerView::END == sizeof(ContainerHeader),
+              "ContainerView must match ContainerHeader");
+
+// Payload struct carried by each message type, and its view
+template <MsgType T> struct MsgPayload;
+template <> struct MsgPayload<MsgType::PLOT>       { using type = PlotPayload;       using view = PlotView; };
+template <> struct MsgPayload<MsgType::TRACK>      { using type = TrackPayload;      using view = TrackView; };
+template <> struct MsgPayload<MsgType::HEARTBEAT>  { using type = HeartbeatPayload;  using view = HeartbeatView; };
+template <> struct MsgPayload<MsgType::ENGAGEMENT> { using type = EngagementPayload; using view = EngagementView; };
+
+template <typename P>
+inline P deserialize_payload(const uint8_t* buf) {
+    P p;
+    std::memcpy(&p, buf, sizeof(P));
+    return p;
+}
+
 } // namespace nng
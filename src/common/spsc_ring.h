@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace nng {
+
+// Cache line size assumed for padding hot indices apart
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Smallest power of two >= n (n > 0)
+inline std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+// Bounded single-producer / single-consumer ring. Capacity is rounded up to
+// a power of two. One thread may push and one (other) thread may pop; no
+// locks, no allocation after construction.
+//
+// Producer and consumer indices live on their own cache lines, and each
+// side keeps a cached copy of the other's index so it only touches the
+// shared line when the ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity)
+        : slots_(round_up_pow2(capacity > 0 ? capacity : 1)),
+          mask_(slots_.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side. Returns false if the ring is full.
+    bool try_push(const T& value) {
+        return try_push_n(&value, 1) == 1;
+    }
+
+    // Push up to count values; returns how many fit. One release store
+    // publishes the whole run.
+    std::size_t try_push_n(const T* values, std::size_t count) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t free = slots_.size() - (tail - head_cache_);
+        if (free < count) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            free = slots_.size() - (tail - head_cache_);
+        }
+        std::size_t n = count < free ? count : free;
+        for (std::size_t i = 0; i < n; ++i)
+            slots_[(tail + i) & mask_] = values[i];
+        if (n > 0)
+            tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool try_pop(T& out) {
+        return try_pop_n(&out, 1) == 1;
+    }
+
+    // Pop up to max values into out; returns how many were taken.
+    std::size_t try_pop_n(T* out, std::size_t max) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t avail = tail_cache_ - head;
+        if (avail < max) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            avail = tail_cache_ - head;
+        }
+        std::size_t n = max < avail ? max : avail;
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = slots_[(head + i) & mask_];
+        if (n > 0)
+            head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Approximate when called concurrently with push/pop
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    std::size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_;
+
+    // Consumer-owned line: head and the consumer's view of tail
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_ = 0;
+    // Producer-owned line: tail and the producer's view of head
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_ = 0;
+    char pad_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+};
+
+} // namespace nng
@@ -0,0 +1,189 @@
+#include "common/thread_placement.h"
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace nng {
+namespace {
+
+constexpr const char* ROLE_NAMES[THREAD_ROLE_COUNT] = {
+    "ingest", "worker", "dispatcher", "writer", "control",
+};
+
+std::string trim_lower(const std::string& s) {
+    auto start = s.find_first_not_of(" \t");
+    if (start == std::string::npos)
+        return std::string();
+    auto end = s.find_last_not_of(" \t");
+    std::string out = s.substr(start, end - start + 1);
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::string part;
+    std::istringstream iss(s);
+    while (std::getline(iss, part, sep))
+        parts.push_back(part);
+    return parts;
+}
+
+bool parse_cpu(const std::string& s, int& out) {
+    if (s.empty() || s.size() > 4 || !std::all_of(s.begin(), s.end(), ::isdigit))
+        return false;
+    out = std::stoi(s);
+    return out < CPU_SETSIZE;
+}
+
+} // anonymous namespace
+
+const char* thread_role_name(ThreadRole role) {
+    auto i = static_cast<std::size_t>(role);
+    return i < THREAD_ROLE_COUNT ? ROLE_NAMES[i] : "unknown";
+}
+
+bool parse_cpu_list(const std::string& list, std::vector<int>& cpus) {
+    std::vector<int> out;
+    for (const auto& raw : split(list, ',')) {
+        std::string item = trim_lower(raw);
+        auto dash = item.find('-');
+        int lo = 0;
+        int hi = 0;
+        bool ok = dash == std::string::npos
+            ? parse_cpu(item, lo) && (hi = lo, true)
+            : parse_cpu(trim_lower(item.substr(0, dash)), lo) &&
+              parse_cpu(trim_lower(item.substr(dash + 1)), hi) && lo <= hi;
+        if (!ok)
+            return false;
+        for (int c = lo; c <= hi; ++c)
+            out.push_back(c);
+    }
+    if (out.empty())
+        return false;
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    cpus = std::move(out);
+    return true;
+}
+
+std::string format_cpu_list(const std::vector<int>& cpus) {
+    std::string out;
+    for (std::size_t i = 0; i < cpus.size();) {
+        std::size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+            ++j;
+        if (!out.empty())
+            out += ',';
+        out += std::to_string(cpus[i]);
+        if (j > i)
+            out += '-' + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+bool ThreadPlacement::set(const std::string& spec, std::string* error) {
+    std::array<std::vector<int>, THREAD_ROLE_COUNT> parsed;
+    std::string lower = trim_lower(spec);
+    if (!lower.empty() && lower != "off") {
+        for (const auto& raw : split(lower, ';')) {
+            std::string clause = trim_lower(raw);
+            if (clause.empty())
+                continue;
+            auto eq = clause.find('=');
+            if (eq == std::string::npos) {
+                if (error)
+                    *error = "expected role=cpus in '" + clause + "'";
+                return false;
+            }
+            std::string key = trim_lower(clause.substr(0, eq));
+            auto it = std::find_if(std::begin(ROLE_NAMES), std::end(ROLE_NAMES),
+                                   [&key](const char* name) { return key == name; });
+            if (it == std::end(ROLE_NAMES)) {
+                if (error)
+                    *error = "unknown thread role '" + key + "'";
+                return false;
+            }
+            std::string list = clause.substr(eq + 1);
+            if (!parse_cpu_list(list, parsed[static_cast<std::size_t>(it - std::begin(ROLE_NAMES))])) {
+                if (error)
+                    *error = "bad cpu list '" + trim_lower(list) + "'";
+                return false;
+            }
+        }
+    }
+    cpus = std::move(parsed);
+    return true;
+}
+
+std::string ThreadPlacement::spec() const {
+    std::string out;
+    for (std::size_t r = 0; r < THREAD_ROLE_COUNT; ++r) {
+        if (cpus[r].empty())
+            continue;
+        if (!out.empty())
+            out += ';';
+        out += std::string(ROLE_NAMES[r]) + '=' + format_cpu_list(cpus[r]);
+    }
+    return out.empty() ? "OFF" : out;
+}
+
+bool ThreadPlacement::empty() const {
+    return std::all_of(cpus.begin(), cpus.end(), [](const auto& c) { return c.empty(); });
+}
+
+bool ThreadPlacement::pin(ThreadRole r, std::size_t index) const {
+    const std::vector<int>& list = role(r);
+    if (list.empty())
+        return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (r == ThreadRole::INGEST || r == ThreadRole::WORKER) {
+        CPU_SET(list[index % list.size()], &set);
+    } else {
+        for (int c : list)
+            CPU_SET(c, &set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+std::size_t numa_node_count() {
+    static const std::size_t count = [] {
+        std::size_t n = 0;
+        while (::access(("/sys/devices/system/node/node" + std::to_string(n)).c_str(), F_OK) == 0)
+            ++n;
+        return n > 0 ? n : std::size_t{1};
+    }();
+    return count;
+}
+
+int current_numa_node() {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+        return 0;
+    return static_cast<int>(node);
+}
+
+bool place_on_local_node(const void* data, std::size_t bytes) {
+    if (!data || bytes == 0 || numa_node_count() < 2)
+        return true;
+    int node = current_numa_node();
+    if (node < 0 || node >= 64)
+        return false;
+    // mbind() works on whole pages: take every page the range touches
+    const auto page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(page - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes + page - 1) & ~(page - 1);
+    unsigned long mask = 1UL << node;
+    return ::syscall(SYS_mbind, start, end - start, MPOL_PREFERRED, &mask,
+                     sizeof(mask) * 8, MPOL_MF_MOVE) == 0;
+}
+
+} // namespace nng
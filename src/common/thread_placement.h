@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+// The kinds of long-lived thread the processes run, each placed as a group
+enum class ThreadRole : uint8_t {
+    INGEST,      // socket receive: the inline ingest loop or the rx stage
+    WORKER,      // pipelined validate stage
+    DISPATCHER,  // event formatting and publishing
+    WRITER,      // recording (record stage and the recorder's writer)
+    CONTROL,     // control node event loop and metrics listener
+};
+constexpr std::size_t THREAD_ROLE_COUNT = 5;
+
+const char* thread_role_name(ThreadRole role);
+
+// Which CPUs each thread role runs on. Spec syntax (case-insensitive),
+// clauses separated by ';', in the style of the ingress filter:
+//   ingest=0-3;worker=4-7;dispatcher=8;writer=9;control=9
+// A role without a clause is left where the scheduler puts it; "" and
+// "OFF" pin nothing. The i-th ingest or worker thread gets one CPU of its
+// list (cpus[i % n]), so each receive thread can sit next to the IRQs of
+// its queue; the other roles may use their whole list.
+//
+// With numa_local, a pinned thread also moves the memory it owns (frame
+// batches, pipeline pools, track tables, stats shards) to its CPU's NUMA
+// node; pages it allocates later land there by first touch anyway.
+struct ThreadPlacement {
+    std::array<std::vector<int>, THREAD_ROLE_COUNT> cpus;
+    bool numa_local = true;
+
+    // Replace the per-role CPU lists. On a syntax error nothing changes,
+    // false is returned and error (if given) says why.
+    bool set(const std::string& spec, std::string* error = nullptr);
+    // Normalised spec ("OFF" when nothing is pinned)
+    std::string spec() const;
+    bool empty() const;
+
+    const std::vector<int>& role(ThreadRole r) const { return cpus[static_cast<std::size_t>(r)]; }
+
+    // Pin the calling thread as the index-th thread of role: true when
+    // done or nothing to do, false if the kernel refused (CPU offline or
+    // outside the process's cpuset)
+    bool pin(ThreadRole r, std::size_t index = 0) const;
+};
+
+// "0-3,8" -> {0, 1, 2, 3, 8}, sorted and without repeats
+bool parse_cpu_list(const std::string& list, std::vector<int>& cpus);
+std::string format_cpu_list(const std::vector<int>& cpus);
+
+// NUMA nodes the host has (1 without NUMA or sysfs)
+std::size_t numa_node_count();
+// Node of the CPU the calling thread is on (0 if unknown)
+int current_numa_node();
+// Move the pages holding [data, data + bytes) to the calling thread's
+// node. No-op (true) on a single-node host.
+bool place_on_local_node(const void* data, std::size_t bytes);
+
+} // namespace nng
@@ -0,0 +1,178 @@
+#include "common/track_delta.h"
+
+namespace nng {
+namespace {
+
+std::size_t put_varint(uint64_t v, uint8_t* out) {
+    std::size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(v);
+    return n;
+}
+
+std::size_t put_zigzag(int64_t v, uint8_t* out) {
+    return put_varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63), out);
+}
+
+// At most max_bytes bytes; false if truncated or longer
+bool get_varint(const uint8_t* in, std::size_t len, std::size_t& at, std::size_t max_bytes,
+                uint64_t& v) {
+    v = 0;
+    for (std::size_t i = 0; i < max_bytes; ++i) {
+        if (at >= len)
+            return false;
+        uint8_t b = in[at++];
+        v |= static_cast<uint64_t>(b & 0x7F) << (7 * i);
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool get_zigzag(const uint8_t* in, std::size_t len, std::size_t& at, std::size_t max_bytes,
+                int64_t& v) {
+    uint64_t u = 0;
+    if (!get_varint(in, len, at, max_bytes, u))
+        return false;
+    v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+    return true;
+}
+
+// A field's mask bit and its widest varint
+struct Field {
+    uint8_t bit;
+    std::size_t max_bytes;
+};
+constexpr Field AZIMUTH{TRACK_DELTA_AZIMUTH, 5};
+constexpr Field ELEVATION{TRACK_DELTA_ELEVATION, 5};
+constexpr Field RANGE{TRACK_DELTA_RANGE, 5};
+constexpr Field VELOCITY{TRACK_DELTA_VELOCITY, 3};
+constexpr Field RCS{TRACK_DELTA_RCS, 3};
+constexpr Field COUNT{TRACK_DELTA_COUNT, 3};
+
+} // anonymous namespace
+
+std::size_t write_track_delta(const TrackPayload* base, const TrackPayload& track, uint8_t* out) {
+    static const TrackPayload zero{};
+    const TrackPayload& b = base ? *base : zero;
+    const int64_t d[] = {
+        int64_t{track.azimuth_mdeg} - b.azimuth_mdeg,
+        int64_t{track.elevation_mdeg} - b.elevation_mdeg,
+        int64_t{track.range_m} - b.range_m,
+        int64_t{track.velocity_mps} - b.velocity_mps,
+        int64_t{track.rcs_dbsm} - b.rcs_dbsm,
+        int64_t{track.update_count} - (int64_t{b.update_count} + 1),
+    };
+    const uint8_t bits[] = {AZIMUTH.bit, ELEVATION.bit, RANGE.bit, VELOCITY.bit, RCS.bit, COUNT.bit};
+
+    uint8_t mask = base ? 0 : TRACK_DELTA_KEY;
+    if (track.classification != b.classification || track.threat_level != b.threat_level ||
+        track.iff_status != b.iff_status)
+        mask |= TRACK_DELTA_CLASS;
+    for (std::size_t f = 0; f < 6; ++f) {
+        if (d[f] != 0)
+            mask |= bits[f];
+    }
+
+    std::size_t n = put_varint(track.track_id, out);
+    out[n++] = mask;
+    if (base)
+        n += put_varint(b.update_count, out + n);
+    if (mask & TRACK_DELTA_CLASS) {
+        out[n++] = track.classification;
+        out[n++] = track.threat_level;
+        out[n++] = track.iff_status;
+    }
+    for (std::size_t f = 0; f < 6; ++f) {
+        if (mask & bits[f])
+            n += put_zigzag(d[f], out + n);
+    }
+    return n;
+}
+
+std::size_t read_track_delta(const uint8_t* in, std::size_t len, TrackDelta& out) {
+    out = TrackDelta{};
+    std::size_t at = 0;
+    uint64_t v = 0;
+    if (!get_varint(in, len, at, 5, v) || v > UINT32_MAX)
+        return 0;
+    out.track_id = static_cast<uint32_t>(v);
+    if (at >= len)
+        return 0;
+    out.mask = in[at++];
+    if (!out.keyframe()) {
+        if (!get_varint(in, len, at, 3, v) || v > UINT16_MAX)
+            return 0;
+        out.ref = static_cast<uint16_t>(v);
+    }
+    if (out.mask & TRACK_DELTA_CLASS) {
+        if (len - at < 3)
+            return 0;
+        out.classification = in[at];
+        out.threat_level = in[at + 1];
+        out.iff_status = in[at + 2];
+        at += 3;
+    }
+    const Field fields[] = {AZIMUTH, ELEVATION, RANGE, VELOCITY, RCS, COUNT};
+    int64_t* values[] = {&out.azimuth, &out.elevation, &out.range, &out.velocity, &out.rcs, &out.count};
+    for (std::size_t f = 0; f < 6; ++f) {
+        if ((out.mask & fields[f].bit) && !get_zigzag(in, len, at, fields[f].max_bytes, *values[f]))
+            return 0;
+    }
+    return at;
+}
+
+bool apply_track_delta(const TrackDelta& delta, const TrackPayload* base, TrackPayload& out) {
+    static const TrackPayload zero{};
+    if (!delta.keyframe() && (!base || base->update_count != delta.ref))
+        return false;
+    const TrackPayload& b = delta.keyframe() ? zero : *base;
+
+    out = b;
+    out.track_id = delta.track_id;
+    if (delta.mask & TRACK_DELTA_CLASS) {
+        out.classification = delta.classification;
+        out.threat_level = delta.threat_level;
+        out.iff_status = delta.iff_status;
+    }
+    // Wrapping like the sender's subtraction did
+    out.azimuth_mdeg = static_cast<int32_t>(static_cast<uint32_t>(b.azimuth_mdeg) +
+                                            static_cast<uint32_t>(delta.azimuth));
+    out.elevation_mdeg = static_cast<int32_t>(static_cast<uint32_t>(b.elevation_mdeg) +
+                                              static_cast<uint32_t>(delta.elevation));
+    out.range_m = static_cast<uint32_t>(b.range_m + static_cast<uint32_t>(delta.range));
+    out.velocity_mps = static_cast<int16_t>(b.velocity_mps + delta.velocity);
+    out.rcs_dbsm = static_cast<int16_t>(b.rcs_dbsm + delta.rcs);
+    out.update_count = static_cast<uint16_t>(b.update_count + 1 + delta.count);
+    return true;
+}
+
+TrackDeltaEncoder::TrackDeltaEncoder(uint32_t keyframe_interval)
+    : interval_(keyframe_interval > 0 ? keyframe_interval : DEFAULT_KEYFRAME_INTERVAL) {}
+
+std::size_t TrackDeltaEncoder::encode(const TrackPayload& track, uint8_t* out) {
+    if (refs_.empty())
+        refs_.resize(65536);
+    Ref& ref = refs_[track.track_id & 0xFFFF];
+    bool key = !ref.valid || ref.last.track_id != track.track_id || ++ref.since_key >= interval_;
+    std::size_t n = write_track_delta(key ? nullptr : &ref.last, track, out);
+    if (key) {
+        ref.since_key = 0;
+        ++keyframes_;
+    } else {
+        ++deltas_;
+    }
+    ref.last = track;
+    ref.valid = true;
+    return n;
+}
+
+void TrackDeltaEncoder::reset() {
+    for (Ref& r : refs_)
+        r.valid = false;
+}
+
+} // namespace nng
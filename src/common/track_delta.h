@@ -0,0 +1,104 @@
+#pragma once
+#include "common/protocol.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nng {
+
+// TRACK_DELTA payload: one or more track records back to back, each the
+// change from the previous update of that track_id by the same source,
+// for links where 43 bytes per track update is too much.
+//
+//   varint  track_id
+//   u8      mask (TRACK_DELTA_*)
+//   varint  ref: update_count of the update this is relative to (not in keyframes)
+//   3 x u8  classification, threat_level, iff_status       (if CLASS)
+//   zigzag varint deltas of azimuth_mdeg, elevation_mdeg,
+//           range_m, velocity_mps, rcs_dbsm                 (each if its bit)
+//   zigzag varint update_count - (ref + 1)                  (if COUNT)
+//
+// A keyframe is a delta from an all-zero track, so it needs no earlier
+// state; senders send one for a new track and every so many updates, and
+// a receiver that missed a frame picks the track up again there. Fields
+// that did not change are left out, and update_count is implied when it
+// went up by one, so a typical update of a moving track takes 6-9 bytes.
+constexpr uint8_t TRACK_DELTA_CLASS     = 0x01;
+constexpr uint8_t TRACK_DELTA_AZIMUTH   = 0x02;
+constexpr uint8_t TRACK_DELTA_ELEVATION = 0x04;
+constexpr uint8_t TRACK_DELTA_RANGE     = 0x08;
+constexpr uint8_t TRACK_DELTA_VELOCITY  = 0x10;
+constexpr uint8_t TRACK_DELTA_RCS       = 0x20;
+constexpr uint8_t TRACK_DELTA_COUNT     = 0x40;
+constexpr uint8_t TRACK_DELTA_KEY       = 0x80;
+
+// Longest record: every field present with its widest varint
+constexpr std::size_t TRACK_DELTA_MAX_RECORD = 5 + 1 + 3 + 3 + 5 + 5 + 5 + 3 + 3 + 3;
+
+// One record as read off the wire
+struct TrackDelta {
+    uint32_t track_id = 0;
+    uint8_t  mask = 0;
+    uint16_t ref = 0;
+    uint8_t  classification = 0;
+    uint8_t  threat_level = 0;
+    uint8_t  iff_status = 0;
+    int64_t  azimuth = 0;
+    int64_t  elevation = 0;
+    int64_t  range = 0;
+    int64_t  velocity = 0;
+    int64_t  rcs = 0;
+    int64_t  count = 0;
+
+    bool keyframe() const { return (mask & TRACK_DELTA_KEY) != 0; }
+};
+
+// Write track's record at out (TRACK_DELTA_MAX_RECORD bytes free) relative
+// to base, or as a keyframe without one; returns its length
+std::size_t write_track_delta(const TrackPayload* base, const TrackPayload& track, uint8_t* out);
+
+// Read the record at in[0, len); its length, or 0 if it is malformed
+std::size_t read_track_delta(const uint8_t* in, std::size_t len, TrackDelta& out);
+
+// The track a record describes, given the update it is relative to (null
+// for keyframes). False if a delta's base is missing or is not the update
+// named by ref.
+bool apply_track_delta(const TrackDelta& delta, const TrackPayload* base, TrackPayload& out);
+
+// Sender side: the last update sent for each track_id and when its last
+// keyframe went out. Tracks are kept by track_id & 0xFFFF (as
+// MeasurementGenerator counts updates); another id in the same slot just
+// starts with a keyframe.
+class TrackDeltaEncoder {
+public:
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 16;
+
+    // A keyframe at least every keyframe_interval updates of a track (1:
+    // every update; 0 means the default)
+    explicit TrackDeltaEncoder(uint32_t keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Append track's record at out (TRACK_DELTA_MAX_RECORD bytes free);
+    // returns its length
+    std::size_t encode(const TrackPayload& track, uint8_t* out);
+
+    // Next update of every track is a keyframe
+    void reset();
+
+    uint32_t keyframe_interval() const { return interval_; }
+    uint64_t keyframes() const { return keyframes_; }
+    uint64_t deltas() const { return deltas_; }
+
+private:
+    struct Ref {
+        TrackPayload last{};
+        uint32_t since_key = 0; // updates since the last keyframe
+        bool valid = false;
+    };
+
+    uint32_t interval_;
+    std::vector<Ref> refs_; // 65536 once the first track is encoded
+    uint64_t keyframes_ = 0;
+    uint64_t deltas_ = 0;
+};
+
+} // namespace nng
@@ -4,8 +4,10 @@
 
 namespace nng {
 
-// Protocol version
+// Protocol version. A v1 datagram is a single frame; a v2 datagram is a
+// container of v1 frames (see ContainerHeader in protocol.h).
 constexpr uint8_t PROTOCOL_VERSION = 1;
+constexpr uint8_t PROTOCOL_VERSION_V2 = 2;
 
 // Message types
 enum class MsgType : uint8_t {
@@ -13,8 +15,12 @@ enum class MsgType : uint8_t {
     TRACK           = 0x02,
     HEARTBEAT       = 0x03,
     ENGAGEMENT      = 0x04,
+    TRACK_DELTA     = 0x05, // packed track updates, see common/track_delta.h
 };
 
+// Highest valid msg_type; per-type tables are indexed by msg_type
+constexpr uint8_t MSG_TYPE_MAX = static_cast<uint8_t>(MsgType::TRACK_DELTA);
+
 // Track classification
 enum class TrackClass : uint8_t {
     UNKNOWN          = 0x00,
@@ -88,6 +94,7 @@ enum class EventId : uint16_t {
     EVT_TRACK_UPDATE      = 0x0101,
     EVT_TRACK_LOST        = 0x0102,
     EVT_TRACK_CLASSIFY    = 0x0103,
+    EVT_PLOT_ASSOCIATED   = 0x0104,
     EVT_THREAT_EVAL       = 0x0200,
     EVT_THREAT_CRITICAL   = 0x0201,
     EVT_IFF_RESPONSE      = 0x0300,
@@ -108,10 +115,91 @@ enum class EventId : uint16_t {
     EVT_CONFIG_CHANGE     = 0x0700,
 };
 
+// Event names, one entry per EventId. event_name() is a table lookup built
+// from this list at compile time.
+struct EventIdName {
+    EventId     id;
+    const char* name;
+};
+
+constexpr EventIdName EVENT_ID_NAMES[] = {
+    {EventId::EVT_TRACK_NEW,         "EVT_TRACK_NEW"},
+    {EventId::EVT_TRACK_UPDATE,      "EVT_TRACK_UPDATE"},
+    {EventId::EVT_TRACK_LOST,        "EVT_TRACK_LOST"},
+    {EventId::EVT_TRACK_CLASSIFY,    "EVT_TRACK_CLASSIFY"},
+    {EventId::EVT_PLOT_ASSOCIATED,   "EVT_PLOT_ASSOCIATED"},
+    {EventId::EVT_THREAT_EVAL,       "EVT_THREAT_EVAL"},
+    {EventId::EVT_THREAT_CRITICAL,   "EVT_THREAT_CRITICAL"},
+    {EventId::EVT_IFF_RESPONSE,      "EVT_IFF_RESPONSE"},
+    {EventId::EVT_IFF_FOE,           "EVT_IFF_FOE"},
+    {EventId::EVT_ENGAGE_START,      "EVT_ENGAGE_START"},
+    {EventId::EVT_ENGAGE_CEASE,      "EVT_ENGAGE_CEASE"},
+    {EventId::EVT_WEAPON_STATUS,     "EVT_WEAPON_STATUS"},
+    {EventId::EVT_AMMO_LOW,          "EVT_AMMO_LOW"},
+    {EventId::EVT_SEQ_GAP,           "EVT_SEQ_GAP"},
+    {EventId::EVT_SEQ_REORDER,       "EVT_SEQ_REORDER"},
+    {EventId::EVT_FRAME_MALFORMED,   "EVT_FRAME_MALFORMED"},
+    {EventId::EVT_CRC_FAIL,          "EVT_CRC_FAIL"},
+    {EventId::EVT_SOURCE_ONLINE,     "EVT_SOURCE_ONLINE"},
+    {EventId::EVT_SOURCE_TIMEOUT,    "EVT_SOURCE_TIMEOUT"},
+    {EventId::EVT_HEARTBEAT_OK,      "EVT_HEARTBEAT_OK"},
+    {EventId::EVT_HEARTBEAT_DEGRADE, "EVT_HEARTBEAT_DEGRADE"},
+    {EventId::EVT_HEARTBEAT_ERROR,   "EVT_HEARTBEAT_ERROR"},
+    {EventId::EVT_CONFIG_CHANGE,     "EVT_CONFIG_CHANGE"},
+};
+
+namespace detail {
+
+// EventId is (group << 8) | index; names are stored [group][index]
+constexpr std::size_t EVENT_GROUPS = 8;
+constexpr std::size_t EVENT_GROUP_SIZE = 8;
+
+struct EventNameTable {
+    const char* names[EVENT_GROUPS][EVENT_GROUP_SIZE];
+    constexpr EventNameTable() : names{} {
+        for (auto& group : names)
+            for (auto& name : group)
+                name = "UNKNOWN";
+        for (const auto& e : EVENT_ID_NAMES) {
+            auto v = static_cast<uint16_t>(e.id);
+            names[v >> 8][v & 0xFF] = e.name;
+        }
+    }
+};
+
+constexpr bool event_ids_fit_table() {
+    for (const auto& e : EVENT_ID_NAMES) {
+        auto v = static_cast<uint16_t>(e.id);
+        if ((v >> 8) >= EVENT_GROUPS || (v & 0xFF) >= EVENT_GROUP_SIZE)
+            return false;
+    }
+    return true;
+}
+static_assert(event_ids_fit_table(), "EventId outside the event name table; grow it");
+
+constexpr EventNameTable EVENT_NAME_TABLE{};
+
+} // namespace detail
+
+constexpr const char* event_name(EventId id) {
+    auto v = static_cast<uint16_t>(id);
+    std::size_t group = v >> 8;
+    std::size_t index = v & 0xFF;
+    if (group >= detail::EVENT_GROUPS || index >= detail::EVENT_GROUP_SIZE)
+        return "UNKNOWN";
+    return detail::EVENT_NAME_TABLE.names[group][index];
+}
+
 // Telemetry frame header size (without payload)
 // version(1) + msg_type(1) + src_id(2) + seq(4) + ts_ns(8) + payload_len(2) = 18
 constexpr std::size_t FRAME_HEADER_SIZE = 18;
 constexpr std::size_t FRAME_CRC_SIZE    = 4;
 constexpr std::size_t MAX_PAYLOAD_SIZE  = 1024;
 
+// v2 container: 6-byte header, then frames, then an optional CRC32
+constexpr std::size_t CONTAINER_HEADER_SIZE = 6;
+constexpr uint8_t     CONTAINER_FLAG_CRC    = 0x01;
+// Largest container that fits a 1500-byte Ethernet MTU (IPv4 + UDP headers)
+constexpr std::size_t CONTAINER_MAX_DATAGRAM = 1500 - 20 - 8;
+
 } // namespace nng
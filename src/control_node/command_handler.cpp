@@ -1,131 +1,750 @@
 #include "control_node/command_handler.h"
+#include "control_node/keyword_map.h"
+#include "control_node/stats_wire.h"
+#include "control_node/tcp_framer.h"
+#include "common/alloc_tracker.h"
 #include <sstream>
+#include <iomanip>
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
 
 namespace nng {
 
+namespace {
+
+enum class Verb : uint8_t { GET, SET, SUBSCRIBE, UNSUBSCRIBE, BATCH };
+enum class GetKey : uint8_t { HEALTH, STATS, SOURCES, LATENCY, RATES, FILTER, RUNTIME, PROFILE, ALLOC, TRACKS, FORWARD };
+enum class SetKey : uint8_t {
+    LOG_LEVEL, CRC, STATS_MAX_AGE_MS, FILTER, RECORD, EVENT_LEVEL, PLOT_SAMPLE, OVERLOAD, PROFILE, ALLOC,
+    FORWARD_FILTER
+};
+
+constexpr Keyword<Verb> VERB_WORDS[] = {
+    {"GET", Verb::GET},
+    {"SET", Verb::SET},
+    {"SUBSCRIBE", Verb::SUBSCRIBE},
+    {"UNSUBSCRIBE", Verb::UNSUBSCRIBE},
+    {"BATCH", Verb::BATCH},
+};
+constexpr Keyword<GetKey> GET_WORDS[] = {
+    {"HEALTH", GetKey::HEALTH},
+    {"STATS", GetKey::STATS},
+    {"SOURCES", GetKey::SOURCES},
+    {"LATENCY", GetKey::LATENCY},
+    {"RATES", GetKey::RATES},
+    {"FILTER", GetKey::FILTER},
+    {"RUNTIME", GetKey::RUNTIME},
+    {"PROFILE", GetKey::PROFILE},
+    {"ALLOC", GetKey::ALLOC},
+    {"TRACKS", GetKey::TRACKS},
+    {"FORWARD", GetKey::FORWARD},
+};
+constexpr Keyword<SetKey> SET_WORDS[] = {
+    {"LOG_LEVEL", SetKey::LOG_LEVEL},
+    {"CRC", SetKey::CRC},
+    {"STATS_MAX_AGE_MS", SetKey::STATS_MAX_AGE_MS},
+    {"FILTER", SetKey::FILTER},
+    {"RECORD", SetKey::RECORD},
+    {"EVENT_LEVEL", SetKey::EVENT_LEVEL},
+    {"PLOT_SAMPLE", SetKey::PLOT_SAMPLE},
+    {"OVERLOAD", SetKey::OVERLOAD},
+    {"PROFILE", SetKey::PROFILE},
+    {"ALLOC", SetKey::ALLOC},
+    {"FORWARD_FILTER", SetKey::FORWARD_FILTER},
+};
+
+constexpr auto VERBS = make_keyword_map(VERB_WORDS);
+constexpr auto GET_KEYS = make_keyword_map(GET_WORDS);
+constexpr auto SET_KEYS = make_keyword_map(SET_WORDS);
+static_assert(VERBS.perfect() && GET_KEYS.perfect() && SET_KEYS.perfect(),
+              "keyword tables need a collision-free seed");
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && is_space(s.front()))
+        s.remove_prefix(1);
+    while (!s.empty() && is_space(s.back()))
+        s.remove_suffix(1);
+    return s;
+}
+
+// Next whitespace-separated token of s; s is left with what follows it
+std::string_view next_token(std::string_view& s) {
+    std::size_t start = 0;
+    while (start < s.size() && is_space(s[start]))
+        ++start;
+    std::size_t end = start;
+    while (end < s.size() && !is_space(s[end]))
+        ++end;
+    std::string_view token = s.substr(start, end - start);
+    s.remove_prefix(end);
+    return token;
+}
+
+// Next line of s without its line ending; s is left with what follows it
+std::string_view next_line(std::string_view& s) {
+    std::size_t end = std::min(s.find('\n'), s.size());
+    std::string_view line = s.substr(0, end);
+    s.remove_prefix(std::min(end + 1, s.size()));
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return line;
+}
+
+std::string upper(std::string_view s) {
+    std::string out(s);
+    for (char& c : out)
+        c = ascii_upper(c);
+    return out;
+}
+
+// ON / OFF value of a SET; false if it is neither
+bool parse_on_off(std::string_view s, bool& out) {
+    if (iequals_upper(s, "ON")) {
+        out = true;
+        return true;
+    }
+    if (iequals_upper(s, "OFF")) {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+// Whole of s as an unsigned decimal
+template <typename T>
+bool parse_uint(std::string_view s, T& out) {
+    auto r = std::from_chars(s.data(), s.data() + s.size(), out);
+    return !s.empty() && r.ec == std::errc() && r.ptr == s.data() + s.size();
+}
+
+// Optional source id argument: empty or "ALL" gives -1, a decimal or
+// 0x-prefixed hex id gives the id, anything else -2
+int parse_source_arg(std::string_view args) {
+    std::string_view src = trim(args);
+    if (src.empty() || iequals_upper(src, "ALL"))
+        return -1;
+    int base = 10;
+    if (src.size() > 2 && src[0] == '0' && (src[1] == 'x' || src[1] == 'X')) {
+        src.remove_prefix(2);
+        base = 16;
+    }
+    uint32_t id = 0;
+    auto r = std::from_chars(src.data(), src.data() + src.size(), id, base);
+    if (r.ec != std::errc() || r.ptr != src.data() + src.size() || id > 0xFFFF)
+        return -2;
+    return static_cast<int>(id);
+}
+
+void append_field(std::string& out, std::string_view name, uint64_t value) {
+    char digits[24];
+    auto r = std::to_chars(digits, digits + sizeof(digits), value);
+    out += name;
+    out.append(digits, static_cast<std::size_t>(r.ptr - digits));
+}
+
+} // anonymous namespace
+
 CommandHandler::CommandHandler(StatsManager& stats, Logger& logger)
     : stats_(stats), logger_(logger) {}
 
-std::string CommandHandler::handle(const std::string& command) {
+void CommandHandler::set_runtime_config(RuntimeConfig* runtime) {
+    runtime_ = runtime;
+    if (runtime_ && !filter_)
+        filter_ = &runtime_->filter();
+}
+
+std::size_t CommandHandler::batch_body(std::string_view command) {
+    std::string_view rest = command;
+    Verb verb;
+    if (!VERBS.find(next_token(rest), verb) || verb != Verb::BATCH)
+        return std::string_view::npos;
+    return command.size() - rest.size();
+}
+
+std::string CommandHandler::handle(std::string_view command) {
     if (command.empty())
         return "ERR EMPTY_COMMAND";
 
-    // Parse command: first word is the verb
-    std::istringstream iss(command);
-    std::string verb;
-    iss >> verb;
-
-    // Convert to uppercase for comparison
-    std::transform(verb.begin(), verb.end(), verb.begin(), ::toupper);
+    // First word is the verb
+    std::string_view rest = command;
+    Verb verb;
+    if (!VERBS.find(next_token(rest), verb))
+        return "ERR UNKNOWN_COMMAND";
+    switch (verb) {
+        case Verb::GET:
+            return handle_get(trim(rest));
+        case Verb::SET:
+            return handle_set(rest);
+        case Verb::SUBSCRIBE:
+        case Verb::UNSUBSCRIBE:
+            return "ERR STREAMING_UNAVAILABLE"; // needs a connection: see ControlNode
+        case Verb::BATCH: {
+            std::vector<uint8_t> framed;
+            handle_batch(rest, framed);
+            return std::string(framed.begin(), framed.end());
+        }
+    }
+    return "ERR UNKNOWN_COMMAND";
+}
 
-    std::string rest;
-    std::getline(iss, rest);
-    // Trim leading whitespace
-    auto pos = rest.find_first_not_of(" \t");
-    if (pos != std::string::npos)
-        rest = rest.substr(pos);
+void CommandHandler::respond(std::string_view command, std::vector<uint8_t>& out) {
+    std::size_t body = batch_body(command);
+    if (body != std::string_view::npos)
+        handle_batch(command.substr(body), out);
     else
-        rest.clear();
+        TcpFramer::encode_append(handle(command), out);
+}
 
-    if (verb == "GET")
-        return handle_get(rest);
-    else if (verb == "SET")
-        return handle_set(rest);
+void CommandHandler::handle_batch(std::string_view body, std::vector<uint8_t>& out) {
+    // Count first, so a bad batch runs nothing
+    std::size_t count = 0;
+    for (std::string_view rest = body; !rest.empty();) {
+        if (!trim(next_line(rest)).empty())
+            ++count;
+    }
+    if (count == 0) {
+        TcpFramer::encode_append("ERR EMPTY_BATCH", out);
+        return;
+    }
+    if (count > MAX_BATCH) {
+        TcpFramer::encode_append("ERR BATCH_TOO_LARGE", out);
+        return;
+    }
 
-    return "ERR UNKNOWN_COMMAND";
+    for (std::string_view rest = body; !rest.empty();) {
+        std::string_view line = next_line(rest);
+        if (trim(line).empty())
+            continue;
+        bool nested = batch_body(line) != std::string_view::npos;
+        TcpFramer::encode_append(nested ? "ERR NESTED_BATCH" : handle(line), out);
+    }
 }
 
-std::string CommandHandler::handle_get(const std::string& args) {
-    std::string what = args;
-    std::transform(what.begin(), what.end(), what.begin(), ::toupper);
+std::string CommandHandler::stats_text() const {
+    auto snap = stats_.snapshot(stats_max_age_ms_ * 1000000ULL);
+    const GlobalStats& g = snap->global;
+    std::string out;
+    out.reserve(256);
+    out += "STATS";
+    append_field(out, "\nrx_total=", g.rx_total);
+    append_field(out, "\nmalformed_total=", g.malformed_total);
+    append_field(out, "\ngap_total=", g.gap_total);
+    append_field(out, "\nreorder_total=", g.reorder_total);
+    append_field(out, "\nduplicate_total=", g.duplicate_total);
+    append_field(out, "\ncrc_fail_total=", g.crc_fail_total);
+    append_field(out, "\nfiltered_total=", g.filtered_total);
+    append_field(out, "\nsnapshot_version=", snap->version);
+    append_field(out, "\nsnapshot_age_us=", snap->age_ns() / 1000);
+    return out;
+}
 
-    if (what == "HEALTH") {
-        auto health = stats_.get_health();
-        switch (health) {
-            case HealthState::OK:       return "HEALTH OK";
-            case HealthState::DEGRADED: return "HEALTH DEGRADED";
-            case HealthState::ERROR:    return "HEALTH ERROR";
-        }
-        return "HEALTH UNKNOWN";
+bool CommandHandler::parse_subscribe(std::string_view args, bool unsubscribe,
+                                     SubscribeRequest& out) {
+    out = SubscribeRequest{};
+    std::string_view what = next_token(args);
+    if (what.empty()) {
+        if (!unsubscribe)
+            return false;
+        out.category_mask = ~0u;
+        out.stats = true;
+        return true;
     }
 
-    if (what == "STATS") {
-        auto g = stats_.get_global_stats();
-        std::ostringstream oss;
-        oss << "STATS\n";
-        oss << "rx_total=" << g.rx_total << "\n";
-        oss << "malformed_total=" << g.malformed_total << "\n";
-        oss << "gap_total=" << g.gap_total << "\n";
-        oss << "reorder_total=" << g.reorder_total << "\n";
-        oss << "duplicate_total=" << g.duplicate_total << "\n";
-        oss << "crc_fail_total=" << g.crc_fail_total;
-        return oss.str();
+    if (iequals_upper(what, "STATS")) {
+        out.stats = true;
+        std::string_view interval = next_token(args);
+        if (unsubscribe)
+            return interval.empty();
+        uint64_t ms = 0;
+        if (!parse_uint(interval, ms) || ms == 0 || !trim(args).empty())
+            return false;
+        out.interval_ms = ms;
+        return true;
     }
+    if (!trim(args).empty())
+        return false;
+    if (iequals_upper(what, "ALL")) {
+        out.category_mask = ~0u;
+        return true;
+    }
+    std::size_t start = 0;
+    while (start <= what.size()) {
+        std::size_t end = std::min(what.find(',', start), what.size());
+        EventCategory cat;
+        if (!parse_category(what.substr(start, end - start), cat))
+            return false;
+        out.category_mask |= 1u << static_cast<unsigned>(cat);
+        start = end + 1;
+    }
+    return true;
+}
 
+std::string CommandHandler::handle_get(std::string_view args) {
+    GetKey key;
+    std::string_view rest = args;
+    if (!GET_KEYS.find(next_token(rest), key))
+        return "ERR UNKNOWN_COMMAND";
+    rest = trim(rest);
+
+    switch (key) {
+        case GetKey::HEALTH:
+            if (!rest.empty())
+                break;
+            switch (stats_.get_health()) {
+                case HealthState::OK:       return "HEALTH OK";
+                case HealthState::DEGRADED: return "HEALTH DEGRADED";
+                case HealthState::ERROR:    return "HEALTH ERROR";
+            }
+            return "HEALTH UNKNOWN";
+        case GetKey::STATS:
+            if (rest.empty())
+                return stats_text();
+            if (iequals_upper(rest, "BIN")) {
+                std::string out;
+                encode_stats_wire(*stats_.snapshot(stats_max_age_ms_ * 1000000ULL), out);
+                return out;
+            }
+            break;
+        case GetKey::SOURCES:
+            return handle_get_sources(rest);
+        case GetKey::LATENCY:
+            return handle_get_latency(rest);
+        case GetKey::RATES:
+            return handle_get_rates(rest);
+        case GetKey::FILTER:
+            if (!rest.empty())
+                break;
+            if (!filter_)
+                return "ERR FILTER_UNAVAILABLE";
+            return "FILTER " + filter_->spec();
+        case GetKey::RUNTIME:
+            if (!rest.empty())
+                break;
+            if (!runtime_)
+                return "ERR RUNTIME_UNAVAILABLE";
+            return runtime_text();
+        case GetKey::PROFILE:
+            return handle_get_profile(rest);
+        case GetKey::ALLOC:
+            if (!rest.empty())
+                break;
+            return handle_get_alloc();
+        case GetKey::TRACKS:
+            return handle_get_tracks(rest);
+        case GetKey::FORWARD:
+            if (!rest.empty())
+                break;
+            return handle_get_forward();
+    }
     return "ERR UNKNOWN_COMMAND";
 }
 
-std::string CommandHandler::handle_set(const std::string& args) {
+std::string CommandHandler::handle_get_profile(std::string_view args) {
+    if (!profiler_)
+        return "ERR PROFILE_UNAVAILABLE";
+    ProfileReport report;
+    if (!report.compiled)
+        return "ERR PROFILE_NOT_BUILT";
+    std::string_view thread = next_token(args);
+    if (!trim(args).empty())
+        return "ERR UNKNOWN_COMMAND";
+    if (!profiler_->report(report, std::string(thread)))
+        return "ERR UNKNOWN_THREAD";
+
+    std::ostringstream oss;
+    oss << "PROFILE thread=" << (thread.empty() ? std::string_view("all") : thread)
+        << "\nenabled=" << (report.enabled ? 1 : 0)
+        << "\nclock=" << report.clock
+        << "\nthreads=";
+    for (std::size_t i = 0; i < report.threads.size(); ++i)
+        oss << (i ? "," : "") << report.threads[i];
+    for (std::size_t s = 0; s < PROFILE_STAGE_COUNT; ++s) {
+        const char* name = PROFILE_STAGE_NAMES[s];
+        const StageTiming& t = report.stages[s];
+        oss << "\n" << name << "_count=" << t.ns.count
+            << "\n" << name << "_p50_ns=" << t.ns.percentile(0.50)
+            << "\n" << name << "_p99_ns=" << t.ns.percentile(0.99)
+            << "\n" << name << "_p999_ns=" << t.ns.percentile(0.999)
+            << "\n" << name << "_max_ns=" << t.ns.max
+            << "\n" << name << "_total_ns=" << t.total_ns;
+    }
+    return oss.str();
+}
+
+std::string CommandHandler::handle_get_tracks(std::string_view args) {
+    if (!tracks_)
+        return "ERR TRACKS_UNAVAILABLE";
+    TrackQuery query;
+    std::string_view filter = next_token(args);
+    if (!trim(args).empty())
+        return "ERR UNKNOWN_COMMAND";
+    if (!filter.empty()) {
+        constexpr std::string_view THREAT = "THREAT>=";
+        unsigned threat = 0;
+        if (filter.size() <= THREAT.size() || !iequals_upper(filter.substr(0, THREAT.size()), THREAT) ||
+            !parse_uint(filter.substr(THREAT.size()), threat) || threat > 255)
+            return "ERR INVALID_TRACK_FILTER";
+        query.min_threat = static_cast<uint8_t>(threat);
+    }
+    query.now_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    tracks_->snapshot(track_buf_, query);
+
+    std::size_t shown = std::min(track_buf_.size(), MAX_TRACK_LINES);
+    std::string out;
+    out.reserve(64 + shown * 96);
+    append_field(out, "TRACKS count=", track_buf_.size());
+    append_field(out, " shown=", shown);
+    append_field(out, " dropped=", tracks_->dropped());
+    for (std::size_t i = 0; i < shown; ++i) {
+        const TrackRecord& r = track_buf_[i];
+        const TrackPayload t = r.track;
+        uint64_t age_ms = query.now_ns > r.last_update_ns ? (query.now_ns - r.last_update_ns) / 1000000 : 0;
+        char line[192];
+        int n = std::snprintf(line, sizeof(line),
+            "\nsrc_id=%u track_id=%u class=%u threat=%u iff=%u az_mdeg=%d el_mdeg=%d range_m=%u"
+            " velocity_mps=%d rcs_dbsm=%d updates=%u age_ms=%llu",
+            r.src_id, t.track_id, t.classification, t.threat_level, t.iff_status, t.azimuth_mdeg,
+            t.elevation_mdeg, t.range_m, t.velocity_mps, t.rcs_dbsm, r.update_count,
+            static_cast<unsigned long long>(age_ms));
+        out.append(line, static_cast<std::size_t>(std::min<int>(n, sizeof(line) - 1)));
+    }
+    return out;
+}
+
+std::string CommandHandler::handle_get_forward() {
+    if (!forward_)
+        return "ERR FORWARD_UNAVAILABLE";
+    ForwardStats s = forward_->stats();
+    std::string out;
+    append_field(out, "FORWARD targets=", forward_->options().targets.size());
+    out += " filter=";
+    out += forward_->filter().spec();
+    append_field(out, "\nframes=", s.frames);
+    append_field(out, "\nfiltered=", s.filtered);
+    append_field(out, "\ndatagrams=", s.datagrams);
+    append_field(out, "\nsend_failures=", s.send_failures);
+    return out;
+}
+
+uint64_t CommandHandler::frames_seen() const {
+    GlobalStats g = stats_.get_global_stats();
+    return g.rx_total + g.malformed_total + g.filtered_total;
+}
+
+std::string CommandHandler::handle_get_alloc() {
+    if (!AllocTracker::installed())
+        return "ERR ALLOC_NOT_INSTALLED";
+    AllocReport report = AllocTracker::report();
+    uint64_t frames = frames_seen() - alloc_frames_base_;
+
+    std::ostringstream oss;
+    oss << "ALLOC enabled=" << (report.enabled ? 1 : 0)
+        << "\nframes=" << frames
+        << "\nallocs=" << report.total.allocs
+        << "\nfrees=" << report.total.frees
+        << "\nbytes=" << report.total.bytes
+        << "\nhot_allocs=" << report.hot.allocs
+        << "\nhot_bytes=" << report.hot.bytes
+        << "\nhot_allocs_per_frame=" << std::fixed << std::setprecision(4)
+        << (frames ? static_cast<double>(report.hot.allocs) / static_cast<double>(frames) : 0.0);
+    for (const ThreadAllocs& t : report.threads) {
+        const std::string& name = t.name.empty() ? std::string("other") : t.name;
+        oss << "\nthread." << name << "=allocs:" << t.counts.allocs
+            << ",frees:" << t.counts.frees << ",bytes:" << t.counts.bytes
+            << (t.hot ? ",hot" : "");
+    }
+    // Size buckets by upper bound, empty ones left out
+    for (std::size_t b = 0; b < ALLOC_SIZE_BUCKETS; ++b) {
+        if (report.total.sizes[b] == 0)
+            continue;
+        oss << "\nsize_";
+        if (b + 1 == ALLOC_SIZE_BUCKETS)
+            oss << "max";
+        else
+            oss << "lt_" << (uint64_t{1} << b);
+        oss << "=" << report.total.sizes[b];
+    }
+    return oss.str();
+}
+
+std::string CommandHandler::handle_get_sources(std::string_view args) {
+    if (!iequals_upper(next_token(args), "BIN"))
+        return "ERR UNKNOWN_COMMAND";
+    std::string_view since = next_token(args);
+    if (!trim(args).empty())
+        return "ERR UNKNOWN_COMMAND";
+
+    uint64_t base_version = 0;
+    if (!since.empty()) {
+        if (since.size() < 6 || !iequals_upper(since.substr(0, 6), "SINCE=") ||
+            !parse_uint(since.substr(6), base_version))
+            return "ERR INVALID_VERSION";
+    }
+
+    auto snap = stats_.snapshot(stats_max_age_ms_ * 1000000ULL);
+    // An unknown base (too old, or from before a restart) gets a full response
+    const StatsSnapshot* base = nullptr;
+    for (const auto& h : history_) {
+        if (h->version == base_version)
+            base = h.get();
+    }
+    std::string out;
+    encode_sources_wire(*snap, base, out);
+
+    if (history_.empty() || history_.back()->version != snap->version) {
+        if (history_.size() == DELTA_HISTORY)
+            history_.erase(history_.begin());
+        history_.push_back(snap);
+    }
+    return out;
+}
+
+std::string CommandHandler::handle_get_latency(std::string_view args) {
+    int id = parse_source_arg(args);
+    if (id == -2)
+        return "ERR INVALID_SOURCE";
+
+    SourceLatency lat;
+    std::string src = "all";
+    if (id < 0) {
+        lat = stats_.get_all_source_latency();
+    } else {
+        if (!stats_.get_source_latency(static_cast<uint16_t>(id), lat))
+            return "ERR UNKNOWN_SOURCE";
+        src = std::to_string(id);
+    }
+
+    std::ostringstream oss;
+    oss << "LATENCY src=" << src;
+    auto put = [&oss](const char* name, const HistogramSnapshot& h) {
+        oss << "\n" << name << "_count=" << h.count
+            << "\n" << name << "_p50_ns=" << h.percentile(0.50)
+            << "\n" << name << "_p99_ns=" << h.percentile(0.99)
+            << "\n" << name << "_p999_ns=" << h.percentile(0.999)
+            << "\n" << name << "_max_ns=" << h.max;
+    };
+    put("interarrival", lat.interarrival);
+    put("latency", lat.latency);
+    return oss.str();
+}
+
+std::string CommandHandler::handle_get_rates(std::string_view args) {
+    int id = parse_source_arg(args);
+    if (id == -2)
+        return "ERR INVALID_SOURCE";
+
+    WindowedRates rates;
+    std::string src = "all";
+    if (id < 0) {
+        rates = stats_.get_global_rates();
+    } else {
+        if (!stats_.get_source_rates(static_cast<uint16_t>(id), rates))
+            return "ERR UNKNOWN_SOURCE";
+        src = std::to_string(id);
+    }
+
+    std::ostringstream oss;
+    oss << "RATES src=" << src << std::fixed << std::setprecision(1);
+    for (std::size_t m = 0; m < RATE_METRIC_COUNT; ++m) {
+        const char* name = RATE_METRIC_NAMES[m];
+        oss << "\n" << name << "_1s=" << rates.last_1s.per_sec[m]
+            << "\n" << name << "_10s=" << rates.last_10s.per_sec[m]
+            << "\n" << name << "_60s=" << rates.last_60s.per_sec[m];
+    }
+    return oss.str();
+}
+
+std::string CommandHandler::handle_set(std::string_view args) {
     // Expect KEY=VALUE
     auto eq_pos = args.find('=');
-    if (eq_pos == std::string::npos)
+    if (eq_pos == std::string_view::npos)
         return "ERR INVALID_SET_SYNTAX";
+    std::string_view key = trim(args.substr(0, eq_pos));
+    std::string_view value = trim(args.substr(eq_pos + 1));
 
-    std::string key = args.substr(0, eq_pos);
-    std::string value = args.substr(eq_pos + 1);
+    // LOG_LEVEL.<category> is LOG_LEVEL for one category
+    std::size_t dot = key.find('.');
+    SetKey k;
+    if (!SET_KEYS.find(key.substr(0, dot), k) || (dot != std::string_view::npos && k != SetKey::LOG_LEVEL)) {
+        // Generic key-value storage
+        std::string name = upper(key);
+        std::string response = "OK " + name + "=";
+        response += value;
+        config_[std::move(name)] = std::string(value);
+        return response;
+    }
 
-    // Trim whitespace
-    auto trim = [](std::string& s) {
-        auto start = s.find_first_not_of(" \t");
-        auto end = s.find_last_not_of(" \t");
-        if (start == std::string::npos) { s.clear(); return; }
-        s = s.substr(start, end - start + 1);
-    };
-    trim(key);
-    trim(value);
-
-    // Convert key to uppercase
-    std::transform(key.begin(), key.end(), key.begin(), ::toupper);
-
-    // Special handling for known keys
-    if (key == "LOG_LEVEL") {
-        std::string val_upper = value;
-        std::transform(val_upper.begin(), val_upper.end(), val_upper.begin(), ::toupper);
-
-        Severity level = Severity::INFO;
-        if (val_upper == "DEBUG") level = Severity::DEBUG;
-        else if (val_upper == "INFO") level = Severity::INFO;
-        else if (val_upper == "WARN") level = Severity::WARN;
-        else if (val_upper == "ALARM") level = Severity::ALARM;
-        else if (val_upper == "ERROR") level = Severity::ERROR;
-        else if (val_upper == "FATAL") level = Severity::FATAL;
-        else return "ERR INVALID_LOG_LEVEL";
-
-        logger_.set_level(level);
-        config_[key] = val_upper;
-        return "OK LOG_LEVEL=" + val_upper;
-    }
-
-    if (key == "CRC") {
-        std::string val_upper = value;
-        std::transform(val_upper.begin(), val_upper.end(), val_upper.begin(), ::toupper);
-
-        if (val_upper == "ON") {
-            crc_enabled_ = true;
-            config_[key] = "ON";
-            return "OK CRC=ON";
-        } else if (val_upper == "OFF") {
-            crc_enabled_ = false;
-            config_[key] = "OFF";
-            return "OK CRC=OFF";
+    switch (k) {
+        case SetKey::LOG_LEVEL: {
+            Severity level = Severity::INFO;
+            if (!parse_severity(value, level))
+                return "ERR INVALID_LOG_LEVEL";
+            if (dot == std::string_view::npos) {
+                // Global level replaces any per-category ones
+                logger_.set_level(level);
+                for (auto it = config_.begin(); it != config_.end();) {
+                    if (it->first.rfind("LOG_LEVEL.", 0) == 0)
+                        it = config_.erase(it);
+                    else
+                        ++it;
+                }
+            } else {
+                EventCategory cat;
+                if (!parse_category(key.substr(dot + 1), cat))
+                    return "ERR INVALID_LOG_CATEGORY";
+                logger_.set_level(cat, level);
+            }
+            std::string name = upper(key);
+            std::string val = upper(value);
+            std::string response = "OK " + name + "=" + val;
+            config_[std::move(name)] = std::move(val);
+            return response;
+        }
+        case SetKey::CRC: {
+            bool on = false;
+            if (!parse_on_off(value, on))
+                return "ERR INVALID_CRC_VALUE";
+            crc_enabled_ = on;
+            if (runtime_)
+                runtime_->set_crc(on);
+            config_["CRC"] = on ? "ON" : "OFF";
+            return on ? "OK CRC=ON" : "OK CRC=OFF";
+        }
+        case SetKey::RECORD: {
+            bool on = false;
+            if (!parse_on_off(value, on))
+                return "ERR INVALID_RECORD_VALUE";
+            if (!runtime_ || !runtime_->set_recording(on))
+                return "ERR RECORDING_UNAVAILABLE";
+            config_["RECORD"] = on ? "ON" : "OFF";
+            return on ? "OK RECORD=ON" : "OK RECORD=OFF";
+        }
+        case SetKey::EVENT_LEVEL: {
+            Severity level = Severity::DEBUG;
+            if (!parse_severity(value, level))
+                return "ERR INVALID_EVENT_LEVEL";
+            if (!runtime_)
+                return "ERR RUNTIME_UNAVAILABLE";
+            runtime_->set_event_level(level);
+            std::string& stored = config_["EVENT_LEVEL"];
+            stored = upper(value);
+            return "OK EVENT_LEVEL=" + stored;
         }
-        return "ERR INVALID_CRC_VALUE";
+        case SetKey::PLOT_SAMPLE: {
+            uint32_t n = 0;
+            if (!parse_uint(value, n) || n == 0)
+                return "ERR INVALID_PLOT_SAMPLE";
+            if (!runtime_)
+                return "ERR RUNTIME_UNAVAILABLE";
+            runtime_->set_plot_sample(n);
+            std::string& stored = config_["PLOT_SAMPLE"];
+            stored = std::to_string(n);
+            return "OK PLOT_SAMPLE=" + stored;
+        }
+        case SetKey::OVERLOAD: {
+            OverloadMode mode;
+            if (iequals_upper(value, "AUTO"))
+                mode = OverloadMode::AUTO;
+            else if (iequals_upper(value, "ON"))
+                mode = OverloadMode::ON;
+            else if (iequals_upper(value, "OFF"))
+                mode = OverloadMode::OFF;
+            else
+                return "ERR INVALID_OVERLOAD_MODE";
+            if (!runtime_)
+                return "ERR RUNTIME_UNAVAILABLE";
+            runtime_->set_overload_mode(mode);
+            std::string& stored = config_["OVERLOAD"];
+            stored = overload_mode_name(mode);
+            return "OK OVERLOAD=" + stored;
+        }
+        case SetKey::PROFILE: {
+            if (!profiler_)
+                return "ERR PROFILE_UNAVAILABLE";
+            if (iequals_upper(value, "RESET")) {
+                profiler_->reset();
+                return "OK PROFILE=RESET";
+            }
+            bool on = false;
+            if (!parse_on_off(value, on))
+                return "ERR INVALID_PROFILE_VALUE";
+            profiler_->set_enabled(on);
+            config_["PROFILE"] = on ? "ON" : "OFF";
+            return on ? "OK PROFILE=ON" : "OK PROFILE=OFF";
+        }
+        case SetKey::ALLOC: {
+            if (!AllocTracker::installed())
+                return "ERR ALLOC_NOT_INSTALLED";
+            if (iequals_upper(value, "RESET")) {
+                AllocTracker::reset();
+                alloc_frames_base_ = frames_seen();
+                return "OK ALLOC=RESET";
+            }
+            bool on = false;
+            if (!parse_on_off(value, on))
+                return "ERR INVALID_ALLOC_VALUE";
+            // Counting starts over when switched on
+            if (on && !AllocTracker::enabled()) {
+                AllocTracker::reset();
+                alloc_frames_base_ = frames_seen();
+            }
+            AllocTracker::set_enabled(on);
+            config_["ALLOC"] = on ? "ON" : "OFF";
+            return on ? "OK ALLOC=ON" : "OK ALLOC=OFF";
+        }
+        case SetKey::STATS_MAX_AGE_MS: {
+            uint64_t ms = 0;
+            if (!parse_uint(value, ms))
+                return "ERR INVALID_STATS_MAX_AGE";
+            stats_max_age_ms_ = ms;
+            std::string& stored = config_["STATS_MAX_AGE_MS"];
+            stored = std::to_string(ms);
+            return "OK STATS_MAX_AGE_MS=" + stored;
+        }
+        case SetKey::FILTER:
+            if (!filter_)
+                return "ERR FILTER_UNAVAILABLE";
+            if (!filter_->set(std::string(value)))
+                return "ERR INVALID_FILTER";
+            config_["FILTER"] = filter_->spec();
+            return "OK FILTER=" + filter_->spec();
+        case SetKey::FORWARD_FILTER:
+            if (!forward_)
+                return "ERR FORWARD_UNAVAILABLE";
+            if (!forward_->filter().set(std::string(value)))
+                return "ERR INVALID_FILTER";
+            config_["FORWARD_FILTER"] = forward_->filter().spec();
+            return "OK FORWARD_FILTER=" + forward_->filter().spec();
     }
+    return "ERR INVALID_SET_SYNTAX";
+}
 
-    // Generic key-value storage
-    config_[key] = value;
-    return "OK " + key + "=" + value;
+std::string CommandHandler::runtime_text() const {
+    const RuntimeConfig& r = *runtime_;
+    std::string out = "RUNTIME";
+    out += r.crc() ? "\ncrc=ON" : "\ncrc=OFF";
+    out += r.recording() ? "\nrecord=ON" : "\nrecord=OFF";
+    out += r.recorder_open() ? "\nrecorder=OPEN" : "\nrecorder=CLOSED";
+    out += "\nevent_level=";
+    out += trim(severity_str(r.event_level()));
+    out += "\neffective_event_level=";
+    out += trim(severity_str(r.effective_event_level()));
+    append_field(out, "\nplot_sample=", r.plot_sample());
+    out += "\noverload_mode=";
+    out += overload_mode_name(r.overload_mode());
+    out += r.overload_detected() ? "\noverload_detected=1" : "\noverload_detected=0";
+    out += r.overloaded() ? "\noverloaded=1" : "\noverloaded=0";
+    append_field(out, "\noverload_entries=", r.overload_entries());
+    out += "\nfilter=";
+    out += r.filter().spec();
+    return out;
 }
 
 std::string CommandHandler::get_config(const std::string& key) const {
@@ -1,31 +1,130 @@
 #pragma once
 #include "gateway/stats_manager.h"
+#include "gateway/ingress_filter.h"
+#include "gateway/runtime_config.h"
+#include "gateway/stage_profiler.h"
+#include "gateway/track_table.h"
+#include "gateway/frame_forwarder.h"
 #include "common/logger.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace nng {
 
+// Arguments of SUBSCRIBE / UNSUBSCRIBE. Subscriptions belong to a
+// connection, so ControlNode keeps them; CommandHandler only parses.
+struct SubscribeRequest {
+    uint32_t category_mask = 0; // bit per EventCategory
+    bool stats = false;
+    uint64_t interval_ms = 0;   // SUBSCRIBE STATS period
+};
+
 class CommandHandler {
 public:
+    static constexpr std::size_t MAX_BATCH = 256; // commands per BATCH
+    // Snapshots kept as delta bases for GET SOURCES BIN SINCE=<version>
+    static constexpr std::size_t DELTA_HISTORY = 16;
+
     explicit CommandHandler(StatsManager& stats, Logger& logger);
 
-    // Process a command string, return a response string
-    std::string handle(const std::string& command);
+    // Process a command string, return a response string.
+    // "BATCH\n<command>\n<command>..." runs each command in order; its
+    // response is their responses, each length-prefixed as a TCP frame
+    // (a bad batch: one ERR frame), so the wire carries one ordinary frame
+    // per command.
+    std::string handle(std::string_view command);
+
+    // Append the framed response(s) to out: one frame, or one per command
+    // of a BATCH
+    void respond(std::string_view command, std::vector<uint8_t>& out);
 
     // Get current config value (for testing)
     std::string get_config(const std::string& key) const;
 
     // Check if CRC is enabled
-    bool crc_enabled() const { return crc_enabled_; }
+    bool crc_enabled() const { return runtime_ ? runtime_->crc() : crc_enabled_; }
+
+    // GET STATS response body, from a snapshot up to stats_max_age_ms old
+    std::string stats_text() const;
+
+    // "STATS <interval_ms>", "ALL" or "<category>[,<category>...]"; for
+    // UNSUBSCRIBE (unsubscribe true) the interval is not given and empty
+    // args mean everything. False if malformed.
+    static bool parse_subscribe(std::string_view args, bool unsubscribe, SubscribeRequest& out);
+
+    // GET STATS reuses a published stats snapshot up to this old (0: always
+    // fresh); also SET STATS_MAX_AGE_MS=<ms>
+    void set_stats_max_age_ms(uint64_t ms) { stats_max_age_ms_ = ms; }
+
+    // Filter changed by SET FILTER=<spec> and shown by GET FILTER
+    // (e.g. &Gateway::ingress_filter()); not owned
+    void set_ingress_filter(IngressFilter* filter) { filter_ = filter; }
+
+    // Live gateway knobs (e.g. &Gateway::runtime()); not owned. SET CRC,
+    // RECORD, EVENT_LEVEL, PLOT_SAMPLE and OVERLOAD change them, GET RUNTIME
+    // shows them, and SET/GET FILTER use its filter unless one was set.
+    void set_runtime_config(RuntimeConfig* runtime);
+
+    // Stage timings shown by GET PROFILE [<thread>] and switched by SET
+    // PROFILE=ON|OFF|RESET (e.g. &Gateway::profiler()); not owned
+    void set_profiler(StageProfiler* profiler) { profiler_ = profiler; }
+
+    // Tracks listed by GET TRACKS [threat>=N] (e.g. &Gateway::tracks());
+    // not owned
+    void set_track_picture(const TrackPicture* tracks) { tracks_ = tracks; }
+
+    // Forwarding shown by GET FORWARD, its filter changed by SET
+    // FORWARD_FILTER=<spec> (e.g. &Gateway::forwarding()); not owned
+    void set_forwarding(ForwardHub* forward) { forward_ = forward; }
+
+    // GET TRACKS lists at most this many (highest threat first); the
+    // header line still gives the full count
+    static constexpr std::size_t MAX_TRACK_LINES = 50000;
 
 private:
-    std::string handle_get(const std::string& args);
-    std::string handle_set(const std::string& args);
+    // Body of a BATCH: one command per line, blank lines skipped. Appends
+    // one frame per command, or a single ERR frame for a bad batch.
+    void handle_batch(std::string_view body, std::vector<uint8_t>& out);
+    // Offset of a BATCH command's body (after the verb), npos if the
+    // command is not one
+    static std::size_t batch_body(std::string_view command);
+    std::string handle_get(std::string_view args);
+    std::string handle_set(std::string_view args);
+    // GET LATENCY [src_id]: per-source (or combined) histogram percentiles
+    std::string handle_get_latency(std::string_view args);
+    // GET RATES [src_id]: per-second rates over 1/10/60 s
+    std::string handle_get_rates(std::string_view args);
+    // GET SOURCES BIN [SINCE=<version>]: see stats_wire.h
+    std::string handle_get_sources(std::string_view args);
+    // GET PROFILE [<thread>]: per-stage timing percentiles, all threads merged
+    std::string handle_get_profile(std::string_view args);
+    // GET TRACKS [threat>=N]: one line per live track
+    std::string handle_get_tracks(std::string_view args);
+    // GET ALLOC: AllocTracker counts, per thread and per frame
+    std::string handle_get_alloc();
+    // GET FORWARD: targets, filter and forwarding counters
+    std::string handle_get_forward();
+    // Frames the stats have seen (received, malformed or filtered)
+    uint64_t frames_seen() const;
+    std::string runtime_text() const;
 
     StatsManager& stats_;
     Logger& logger_;
+    IngressFilter* filter_ = nullptr;
+    RuntimeConfig* runtime_ = nullptr;
+    StageProfiler* profiler_ = nullptr;
+    const TrackPicture* tracks_ = nullptr;
+    ForwardHub* forward_ = nullptr;
+    std::vector<TrackRecord> track_buf_; // GET TRACKS snapshot, reused
+    uint64_t alloc_frames_base_ = 0; // frames_seen() when ALLOC counting last started
+    uint64_t stats_max_age_ms_ = 0;
+    // Snapshots served in binary, oldest first
+    std::vector<std::shared_ptr<const StatsSnapshot>> history_;
     std::unordered_map<std::string, std::string> config_;
     bool crc_enabled_ = true;
 };
@@ -3,14 +3,133 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <poll.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 
 namespace nng {
+namespace {
+
+constexpr std::size_t HTTP_REQUEST_MAX = 4096;
+// A metrics connection gets this long in all, request and response, so a
+// stalled scraper cannot hold up the ones queued behind it
+constexpr uint64_t HTTP_CONNECTION_TIMEOUT_MS = 2000;
+constexpr int EPOLL_BATCH = 64;
+constexpr uint64_t NS_PER_MS = 1000000;
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool is_verb(std::string_view command, const char* verb) {
+    std::size_t n = std::strlen(verb);
+    if (command.size() < n || (command.size() > n && command[n] != ' ' && command[n] != '\t'))
+        return false;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::toupper(static_cast<unsigned char>(command[i])) != verb[i])
+            return false;
+    }
+    return true;
+}
+
+int open_listener(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    int optval = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, SOMAXCONN) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void close_listener(int& fd) {
+    if (fd >= 0) {
+        ::shutdown(fd, SHUT_RDWR);
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void close_fd(int& fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// Wait for events on a non-blocking fd until deadline_ns; false on timeout
+bool poll_until(int fd, short events, uint64_t deadline_ns) {
+    for (;;) {
+        uint64_t now = steady_ns();
+        if (now >= deadline_ns)
+            return false;
+        struct pollfd pfd{};
+        pfd.fd = fd;
+        pfd.events = events;
+        int ms = static_cast<int>((deadline_ns - now + NS_PER_MS - 1) / NS_PER_MS);
+        int ret = ::poll(&pfd, 1, ms);
+        if (ret > 0)
+            return true;
+        if (ret < 0 && errno != EINTR)
+            return false;
+    }
+}
+
+bool send_all(int fd, const char* data, std::size_t len, uint64_t deadline_ns) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (!poll_until(fd, POLLOUT, deadline_ns))
+                return false;
+            continue;
+        }
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool send_http(int fd, const char* status, std::string_view body, uint64_t deadline_ns) {
+    char head[192];
+    int n = std::snprintf(head, sizeof(head),
+                          "HTTP/1.1 %s\r\n"
+                          "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                          "Content-Length: %zu\r\n"
+                          "Connection: close\r\n\r\n",
+                          status, body.size());
+    return n > 0 && send_all(fd, head, static_cast<std::size_t>(n), deadline_ns) &&
+           send_all(fd, body.data(), body.size(), deadline_ns);
+}
+
+} // anonymous namespace
 
 ControlNode::ControlNode(uint16_t port, StatsManager& stats, Logger& logger)
-    : port_(port), stats_(stats), logger_(logger), handler_(stats, logger) {}
+    : port_(port), stats_(stats), logger_(logger), handler_(stats, logger), metrics_(stats) {
+    handler_.set_stats_max_age_ms(STATS_MAX_AGE_MS);
+}
 
 ControlNode::~ControlNode() {
     stop();
@@ -20,33 +139,49 @@ bool ControlNode::start() {
     if (running_.load())
         return true;
 
-    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    listen_fd_ = open_listener(port_);
     if (listen_fd_ < 0)
         return false;
 
-    int optval = 1;
-    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
-
-    struct sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port_);
-
-    if (::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
-        ::close(listen_fd_);
-        listen_fd_ = -1;
-        return false;
+    if (metrics_port_ != 0) {
+        metrics_fd_ = open_listener(metrics_port_);
+        if (metrics_fd_ < 0) {
+            close_listener(listen_fd_);
+            return false;
+        }
     }
 
-    if (::listen(listen_fd_, 8) < 0) {
-        ::close(listen_fd_);
-        listen_fd_ = -1;
+    reserve_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    accept_resume_ns_ = 0;
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    bool ok = epoll_fd_ >= 0 && wake_fd_ >= 0;
+    ev.data.fd = listen_fd_;
+    ok = ok && ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) == 0;
+    ev.data.fd = wake_fd_;
+    ok = ok && ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) == 0;
+    if (!ok) {
+        close_fd(epoll_fd_);
+        close_fd(wake_fd_);
+        close_fd(reserve_fd_);
+        close_listener(listen_fd_);
+        close_listener(metrics_fd_);
         return false;
     }
 
     should_stop_.store(false);
     running_.store(true);
-    accept_thread_ = std::thread(&ControlNode::accept_loop, this);
+    if (bus_) {
+        AsyncOptions opts;
+        opts.queue_capacity = EVENT_QUEUE;
+        opts.overflow = EventOverflow::DROP;
+        bus_sub_ = bus_->subscribe_all_async([this](const EventRecord& e) { on_event(e); }, opts);
+    }
+    loop_thread_ = std::thread(&ControlNode::event_loop, this);
+    if (metrics_fd_ >= 0)
+        metrics_thread_ = std::thread(&ControlNode::metrics_loop, this);
 
     return true;
 }
@@ -55,117 +190,462 @@ void ControlNode::stop() {
     if (!running_.load())
         return;
 
+    // No more events; the bus drains what it has queued for us first
+    if (bus_ && bus_sub_ != 0) {
+        bus_->unsubscribe(bus_sub_);
+        bus_sub_ = 0;
+    }
+
     should_stop_.store(true);
+    uint64_t one = 1;
+    ssize_t w = ::write(wake_fd_, &one, sizeof(one));
+    (void)w;
+
+    // Close the metrics listener to unblock its accept
+    close_listener(metrics_fd_);
+
+    // The event loop closes every client on its way out
+    if (loop_thread_.joinable())
+        loop_thread_.join();
+    if (metrics_thread_.joinable())
+        metrics_thread_.join();
+
+    close_listener(listen_fd_);
+    close_fd(epoll_fd_);
+    close_fd(wake_fd_);
+    close_fd(reserve_fd_);
+    {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        events_.clear();
+    }
+    event_mask_.store(0);
+    running_.store(false);
+}
 
-    // Close listen socket to unblock accept
-    if (listen_fd_ >= 0) {
-        ::shutdown(listen_fd_, SHUT_RDWR);
-        ::close(listen_fd_);
-        listen_fd_ = -1;
+void ControlNode::event_loop() {
+    placement_.pin(ThreadRole::CONTROL);
+    struct epoll_event events[EPOLL_BATCH];
+    uint64_t next_stats_ns = 0;
+    while (!should_stop_.load()) {
+        // Sleep until the next stats push is due, and wake once a second
+        // while a subscriber lags to check how long it has
+        int timeout_ms = -1;
+        uint64_t now = steady_ns();
+        if (next_stats_ns != 0)
+            timeout_ms = next_stats_ns > now ? static_cast<int>((next_stats_ns - now + NS_PER_MS - 1) / NS_PER_MS) : 0;
+        if (any_lagging_ && (timeout_ms < 0 || timeout_ms > 1000))
+            timeout_ms = 1000;
+        if (accept_resume_ns_ != 0) {
+            int resume_ms = accept_resume_ns_ > now
+                ? static_cast<int>((accept_resume_ns_ - now + NS_PER_MS - 1) / NS_PER_MS) : 0;
+            if (timeout_ms < 0 || timeout_ms > resume_ms)
+                timeout_ms = resume_ms;
+        }
+
+        int n = ::epoll_wait(epoll_fd_, events, EPOLL_BATCH, timeout_ms);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t count;
+                ssize_t r = ::read(wake_fd_, &count, sizeof(count));
+                (void)r;
+                continue; // should_stop_ is checked by the loop; events are pushed below
+            }
+            if (fd == listen_fd_) {
+                accept_clients();
+                continue;
+            }
+            auto it = clients_.find(fd);
+            if (it == clients_.end())
+                continue; // closed earlier in this batch
+            Connection& c = *it->second;
+            uint32_t e = events[i].events;
+            bool alive = true;
+            if (e & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                alive = on_readable(c);
+            if (alive && (e & EPOLLOUT))
+                alive = flush(c) && serve(c); // commands held back while the backlog was full
+            if (alive)
+                update_events(c);
+            else
+                close_client(fd);
+        }
+
+        now = steady_ns();
+        if (accept_resume_ns_ != 0 && now >= accept_resume_ns_)
+            resume_accept();
+        next_stats_ns = push_updates(now);
+        if (now - last_lag_check_ns_ >= 1000 * NS_PER_MS) {
+            last_lag_check_ns_ = now;
+            drop_laggards(now);
+        }
     }
 
-    // Close all client sockets
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        for (int fd : client_fds_) {
-            ::shutdown(fd, SHUT_RDWR);
+    while (!clients_.empty())
+        close_client(clients_.begin()->first);
+}
+
+void ControlNode::accept_clients() {
+    for (;;) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                // The connection stays pending, and the level-triggered
+                // listener would wake the loop again at once
+                if (refuse_pending())
+                    continue;
+                pause_accept();
+            }
+            return; // EAGAIN: accepted everything pending
+        }
+        if (clients_.size() >= max_clients_) {
+            ::close(fd);
+            clients_rejected_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto c = std::make_unique<Connection>();
+        c->fd = fd;
+        c->events = EPOLLIN;
+        struct epoll_event ev{};
+        ev.events = c->events;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
             ::close(fd);
+            continue;
         }
-        client_fds_.clear();
+        clients_.emplace(fd, std::move(c));
+        client_count_.store(clients_.size(), std::memory_order_relaxed);
     }
+}
 
-    if (accept_thread_.joinable())
-        accept_thread_.join();
+bool ControlNode::refuse_pending() {
+    if (reserve_fd_ < 0)
+        return false;
+    close_fd(reserve_fd_);
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd >= 0) {
+        ::close(fd);
+        clients_rejected_.fetch_add(1, std::memory_order_relaxed);
+    }
+    reserve_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return fd >= 0 && reserve_fd_ >= 0;
+}
 
-    // Join all client threads
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        for (auto& t : client_threads_) {
-            if (t.joinable())
-                t.join();
+void ControlNode::pause_accept() {
+    if (accept_resume_ns_ == 0) {
+        struct epoll_event ev{};
+        ev.data.fd = listen_fd_;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, listen_fd_, &ev);
+    }
+    accept_resume_ns_ = steady_ns() + ACCEPT_BACKOFF_MS * NS_PER_MS;
+}
+
+void ControlNode::resume_accept() {
+    if (accept_resume_ns_ == 0)
+        return;
+    accept_resume_ns_ = 0;
+    if (reserve_fd_ < 0)
+        reserve_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, listen_fd_, &ev);
+}
+
+bool ControlNode::on_readable(Connection& c) {
+    uint8_t buf[16384];
+    // Level-triggered: data left in the socket wakes the loop again
+    for (std::size_t total = 0; total < MAX_READ_PER_TURN;) {
+        ssize_t n = ::recv(c.fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            c.framer.feed(buf, static_cast<std::size_t>(n));
+            total += static_cast<std::size_t>(n);
+            if (static_cast<std::size_t>(n) < sizeof(buf))
+                break;
+            continue;
         }
-        client_threads_.clear();
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        return false; // closed by the peer, or an error
     }
+    return serve(c);
+}
 
-    running_.store(false);
+bool ControlNode::serve(Connection& c) {
+    // A flush that empties the backlog lets more commands through: the
+    // client may have sent everything already, so no EPOLLIN would follow
+    do {
+        while (c.out.size() - c.out_pos < MAX_PENDING_OUTPUT && c.framer.has_frame()) {
+            std::string_view command = c.framer.pop_view(); // valid until the next feed()
+            if (is_verb(command, "SUBSCRIBE") || is_verb(command, "UNSUBSCRIBE"))
+                TcpFramer::encode_append(subscribe(c, command), c.out);
+            else
+                handler_.respond(command, c.out); // a BATCH answers with a frame per command
+        }
+        if (!flush(c))
+            return false;
+    } while (c.framer.has_frame() && c.out.size() - c.out_pos < MAX_PENDING_OUTPUT);
+    return true;
 }
 
-void ControlNode::accept_loop() {
-    while (!should_stop_.load()) {
-        struct pollfd pfd{};
-        pfd.fd = listen_fd_;
-        pfd.events = POLLIN;
+std::string ControlNode::subscribe(Connection& c, std::string_view command) {
+    bool unsubscribe = is_verb(command, "UNSUBSCRIBE");
+    std::string_view args = command.substr(unsubscribe ? 11 : 9);
+    SubscribeRequest req;
+    if (!CommandHandler::parse_subscribe(args, unsubscribe, req))
+        return unsubscribe ? "ERR INVALID_UNSUBSCRIBE" : "ERR INVALID_SUBSCRIBE";
+
+    if (unsubscribe) {
+        c.event_mask &= ~req.category_mask;
+        if (req.stats)
+            c.stats_interval_ns = 0;
+        update_event_mask();
+        return "OK UNSUBSCRIBED";
+    }
+    if (req.stats) {
+        uint64_t ms = std::max(req.interval_ms, MIN_STATS_INTERVAL_MS);
+        c.stats_interval_ns = ms * NS_PER_MS;
+        c.next_stats_ns = steady_ns(); // first push right away
+        return "OK SUBSCRIBED STATS interval_ms=" + std::to_string(ms);
+    }
+    if (!bus_)
+        return "ERR EVENTS_UNAVAILABLE";
+    c.event_mask |= req.category_mask;
+    update_event_mask();
+    return "OK SUBSCRIBED";
+}
 
-        int ret = ::poll(&pfd, 1, 100); // 100ms timeout
-        if (ret <= 0 || should_stop_.load())
-            continue;
+void ControlNode::update_event_mask() {
+    uint32_t mask = 0;
+    for (const auto& kv : clients_)
+        mask |= kv.second->event_mask;
+    event_mask_.store(mask, std::memory_order_relaxed);
+}
 
-        if (!(pfd.revents & POLLIN))
-            continue;
+void ControlNode::on_event(const EventRecord& e) {
+    if ((event_mask_.load(std::memory_order_relaxed) & (1u << static_cast<unsigned>(e.category))) == 0)
+        return;
+    PendingEvent pe{e.category, "PUSH EVENT "};
+    event_format_.append(pe.frame, e.timestamp_ns, e.severity, e.category, event_name(e.id),
+                         e.detail_text());
+    pe.frame.pop_back(); // newline
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        if (events_.size() >= EVENT_QUEUE) {
+            pushes_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        wake = events_.empty(); // the loop has not been woken for these yet
+        events_.push_back(std::move(pe));
+    }
+    if (wake) {
+        uint64_t one = 1;
+        ssize_t w = ::write(wake_fd_, &one, sizeof(one));
+        (void)w;
+    }
+}
 
-        struct sockaddr_in client_addr{};
-        socklen_t client_len = sizeof(client_addr);
-        int client_fd = ::accept(listen_fd_,
-            reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
+bool ControlNode::push(Connection& c, std::string_view frame, uint64_t now_ns) {
+    std::size_t pending = c.out.size() - c.out_pos;
+    if (pending + frame.size() > MAX_PUSH_BACKLOG) {
+        ++c.dropped;
+        pushes_dropped_.fetch_add(1, std::memory_order_relaxed);
+        if (c.lagging_since_ns == 0)
+            c.lagging_since_ns = now_ns;
+        any_lagging_ = true;
+        return false;
+    }
+    if (c.dropped > 0) {
+        TcpFramer::encode_append("PUSH LAGGING dropped=" + std::to_string(c.dropped), c.out);
+        c.dropped = 0;
+    }
+    c.lagging_since_ns = 0;
+    TcpFramer::encode_append(frame, c.out);
+    return true;
+}
 
-        if (client_fd < 0)
+uint64_t ControlNode::push_updates(uint64_t now_ns) {
+    pushed_.clear();
+    delivering_.clear();
+    {
+        std::lock_guard<std::mutex> lock(events_mutex_);
+        delivering_.swap(events_);
+    }
+
+    std::string stats; // built once, for every client due
+    uint64_t next_stats = 0;
+    for (auto& kv : clients_) {
+        Connection& c = *kv.second;
+        bool touched = false;
+        if (c.event_mask != 0) {
+            for (const auto& e : delivering_) {
+                if (c.event_mask & (1u << static_cast<unsigned>(e.category))) {
+                    push(c, e.frame, now_ns);
+                    touched = true;
+                }
+            }
+        }
+        if (c.stats_interval_ns != 0) {
+            if (c.next_stats_ns <= now_ns) {
+                if (stats.empty())
+                    stats = "PUSH " + handler_.stats_text();
+                push(c, stats, now_ns);
+                touched = true;
+                // Skip ticks missed while the loop was busy
+                c.next_stats_ns += c.stats_interval_ns;
+                if (c.next_stats_ns <= now_ns)
+                    c.next_stats_ns = now_ns + c.stats_interval_ns;
+            }
+            if (next_stats == 0 || c.next_stats_ns < next_stats)
+                next_stats = c.next_stats_ns;
+        }
+        if (touched)
+            pushed_.push_back(kv.first);
+    }
+
+    // One send() per client for everything pushed this round
+    for (int fd : pushed_) {
+        Connection& c = *clients_[fd];
+        if (flush(c))
+            update_events(c);
+        else
+            close_client(fd);
+    }
+    return next_stats;
+}
+
+void ControlNode::drop_laggards(uint64_t now_ns) {
+    pushed_.clear();
+    any_lagging_ = false;
+    for (auto& kv : clients_) {
+        Connection& c = *kv.second;
+        if (c.lagging_since_ns == 0)
             continue;
+        if (c.out.size() - c.out_pos < MAX_PUSH_BACKLOG / 2)
+            c.lagging_since_ns = 0; // caught up; LAGGING goes out with its next push
+        else if (now_ns - c.lagging_since_ns >= LAG_DISCONNECT_MS * NS_PER_MS)
+            pushed_.push_back(kv.first);
+        else
+            any_lagging_ = true;
+    }
+    for (int fd : pushed_) {
+        close_client(fd);
+        lag_disconnects_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 
-        {
-            std::lock_guard<std::mutex> lock(clients_mutex_);
-            client_fds_.push_back(client_fd);
-            client_threads_.emplace_back(&ControlNode::client_loop, this, client_fd);
+bool ControlNode::flush(Connection& c) {
+    while (c.out_pos < c.out.size()) {
+        ssize_t n = ::send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.out_pos += static_cast<std::size_t>(n);
+            continue;
         }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break; // EPOLLOUT resumes
+        return false;
+    }
+    if (c.out_pos == c.out.size()) {
+        c.out.clear();
+        c.out_pos = 0;
     }
+    return true;
 }
 
-void ControlNode::client_loop(int client_fd) {
-    TcpFramer framer;
-    uint8_t buf[4096];
+void ControlNode::update_events(Connection& c) {
+    std::size_t pending = c.out.size() - c.out_pos;
+    // A client with a full backlog is not read until it drains
+    uint32_t want = pending < MAX_PENDING_OUTPUT ? uint32_t{EPOLLIN} : 0u;
+    if (pending > 0)
+        want |= EPOLLOUT;
+    if (want == c.events)
+        return;
+    c.events = want;
+    struct epoll_event ev{};
+    ev.events = want;
+    ev.data.fd = c.fd;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, c.fd, &ev);
+}
 
+void ControlNode::close_client(int fd) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    auto it = clients_.find(fd);
+    bool subscribed = it != clients_.end() && it->second->event_mask != 0;
+    clients_.erase(fd);
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+    if (subscribed)
+        update_event_mask();
+    // An fd is free again
+    resume_accept();
+}
+
+void ControlNode::metrics_loop() {
+    placement_.pin(ThreadRole::CONTROL);
     while (!should_stop_.load()) {
         struct pollfd pfd{};
-        pfd.fd = client_fd;
+        pfd.fd = metrics_fd_;
         pfd.events = POLLIN;
 
         int ret = ::poll(&pfd, 1, 100);
-        if (ret < 0)
-            break;
-        if (ret == 0)
+        if (ret <= 0 || should_stop_.load() || !(pfd.revents & POLLIN))
             continue;
 
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
-            break;
-
-        if (!(pfd.revents & POLLIN))
+        int client_fd = ::accept4(metrics_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0)
             continue;
+        serve_metrics(client_fd);
+        ::close(client_fd);
+    }
+}
 
-        ssize_t n = ::recv(client_fd, buf, sizeof(buf), 0);
+void ControlNode::serve_metrics(int client_fd) {
+    const uint64_t deadline_ns = steady_ns() + HTTP_CONNECTION_TIMEOUT_MS * NS_PER_MS;
+    // Read up to the end of the request headers; the body (if any) is ignored
+    char req[HTTP_REQUEST_MAX];
+    std::size_t len = 0;
+    while (len < sizeof(req)) {
+        if (!poll_until(client_fd, POLLIN, deadline_ns))
+            return;
+        ssize_t n = ::recv(client_fd, req + len, sizeof(req) - len, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            continue;
         if (n <= 0)
+            return;
+        len += static_cast<std::size_t>(n);
+        if (std::string_view(req, len).find("\r\n\r\n") != std::string_view::npos)
             break;
-
-        framer.feed(buf, static_cast<std::size_t>(n));
-
-        while (framer.has_frame()) {
-            std::string command = framer.pop_frame();
-            std::string response = handler_.handle(command);
-
-            auto encoded = TcpFramer::encode(response);
-            ssize_t sent = ::send(client_fd, encoded.data(), encoded.size(), 0);
-            if (sent < 0)
-                break;
-        }
     }
 
-    ::close(client_fd);
-
-    // Remove from client list
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        client_fds_.erase(
-            std::remove(client_fds_.begin(), client_fds_.end(), client_fd),
-            client_fds_.end());
+    std::string_view request(req, len);
+    std::string_view line = request.substr(0, request.find("\r\n"));
+    if (line.rfind("GET ", 0) != 0) {
+        send_http(client_fd, "405 Method Not Allowed", "method not allowed\n", deadline_ns);
+        return;
+    }
+    std::string_view path = line.substr(4, line.find(' ', 4) - 4);
+    path = path.substr(0, path.find('?'));
+    if (path != "/metrics") {
+        send_http(client_fd, "404 Not Found", "not found\n", deadline_ns);
+        return;
     }
+    send_http(client_fd, "200 OK", metrics_.render(), deadline_ns);
 }
 
 } // namespace nng
@@ -2,47 +2,186 @@
 #include "gateway/stats_manager.h"
 #include "common/logger.h"
 #include "control_node/command_handler.h"
+#include "control_node/metrics_exporter.h"
+#include "control_node/tcp_framer.h"
+#include "common/event_bus.h"
+#include "common/thread_placement.h"
 #include <cstdint>
 #include <thread>
 #include <atomic>
-#include <vector>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace nng {
 
+// Command server: one epoll thread serves every client over non-blocking
+// sockets, each with its own framer and output buffer, so thousands of
+// monitoring connections cost a few KiB each and no thread.
+//
+// SUBSCRIBE <category>[,...] | ALL streams EventBus events to the client
+// and SUBSCRIBE STATS <interval_ms> the GET STATS body every interval, as
+// frames starting "PUSH " between the command responses. The node takes
+// events off the bus on one async subscription (dropping, never blocking
+// the publisher), formats each once and fans it out from the event loop;
+// pushes that arrive together go out in one send(). A client more than
+// MAX_PUSH_BACKLOG behind loses pushes, is told how many by a
+// "PUSH LAGGING dropped=<n>" frame once it catches up, and is
+// disconnected if it stays behind for LAG_DISCONNECT_MS.
 class ControlNode {
 public:
+    // Clients polling GET STATS share snapshots up to this old
+    static constexpr uint64_t STATS_MAX_AGE_MS = 100;
+    // Responses queued for a client that is not reading; past this its
+    // further commands wait until the backlog drains
+    static constexpr std::size_t MAX_PENDING_OUTPUT = 1 << 20;
+    // Read from one client per event-loop turn at most; what is left waits
+    // for the next turn, so a client streaming commands neither holds the
+    // loop nor grows its unparsed input past this
+    static constexpr std::size_t MAX_READ_PER_TURN = 64 * 1024;
+    static constexpr std::size_t MAX_PUSH_BACKLOG = 256 * 1024;
+    static constexpr uint64_t LAG_DISCONNECT_MS = 10000;
+    static constexpr uint64_t MIN_STATS_INTERVAL_MS = 10;
+    // Formatted events waiting for the event loop; more are dropped
+    static constexpr std::size_t EVENT_QUEUE = 4096;
+    // Command clients connected at once; further connections are closed
+    static constexpr std::size_t DEFAULT_MAX_CLIENTS = 10000;
+    // Out of fds with no reserve to refuse connections with, the listener
+    // is left alone this long (or until a client closes)
+    static constexpr uint64_t ACCEPT_BACKOFF_MS = 100;
+
     ControlNode(uint16_t port, StatsManager& stats, Logger& logger);
     ~ControlNode();
 
-    // Start listening (spawns accept thread)
+    // Also serve GET /metrics over HTTP on this port (0: off, the default).
+    // Call before start().
+    void set_metrics_port(uint16_t port) { metrics_port_ = port; }
+
+    // Source of the events SUBSCRIBE streams (e.g. &Gateway::events());
+    // not owned. Call before start().
+    void set_event_bus(EventBus* bus) { bus_ = bus; }
+
+    // CPUs for the event loop and metrics threads (the CONTROL role, e.g.
+    // GatewayConfig::placement), away from the ingest cores. Call before
+    // start().
+    void set_thread_placement(const ThreadPlacement& placement) { placement_ = placement; }
+
+    // Cap on connected command clients. Call before start().
+    void set_max_clients(std::size_t n) { max_clients_ = n; }
+
+    // Start listening (spawns the event loop thread, and the metrics thread
+    // when a metrics port is set)
     bool start();
 
-    // Stop (closes all connections, joins thread)
+    // Stop (closes all connections, joins threads)
     void stop();
 
     bool is_running() const { return running_.load(); }
 
+    // Connected command clients
+    std::size_t client_count() const { return client_count_.load(std::memory_order_relaxed); }
+    // Connections closed on accept: over the client cap, or out of fds
+    uint64_t clients_rejected() const { return clients_rejected_.load(std::memory_order_relaxed); }
+
+    // Pushes not delivered: lost to a lagging client or a full event queue
+    uint64_t pushes_dropped() const { return pushes_dropped_.load(std::memory_order_relaxed); }
+    // Subscribers disconnected for lagging
+    uint64_t lag_disconnects() const { return lag_disconnects_.load(std::memory_order_relaxed); }
+
     // Access command handler (for testing)
     CommandHandler& handler() { return handler_; }
 
+    // Exporter behind /metrics (e.g. to add queue depths)
+    MetricsExporter& metrics() { return metrics_; }
+
 private:
-    void accept_loop();
-    void client_loop(int client_fd);
+    struct Connection {
+        int fd = -1;
+        TcpFramer framer;
+        std::vector<uint8_t> out; // encoded responses not yet sent
+        std::size_t out_pos = 0;
+        uint32_t events = 0;      // registered with epoll
+
+        uint32_t event_mask = 0;        // SUBSCRIBE categories
+        uint64_t stats_interval_ns = 0; // SUBSCRIBE STATS; 0: off
+        uint64_t next_stats_ns = 0;
+        uint64_t dropped = 0;           // pushes lost since the last LAGGING notice
+        uint64_t lagging_since_ns = 0;  // 0: keeping up
+    };
+
+    struct PendingEvent {
+        EventCategory category;
+        std::string frame;
+    };
+
+    void event_loop();
+    void accept_clients();
+    // Out of fds: close one pending connection using the reserve fd; false
+    // if that was not possible
+    bool refuse_pending();
+    // Take the listener out of, or back into, the epoll set
+    void pause_accept();
+    void resume_accept();
+    // Read what is available and answer complete commands; false once the
+    // client is gone
+    bool on_readable(Connection& c);
+    // Answer buffered commands and send, until the framer is empty or the
+    // backlog is full; false if the send failed
+    bool serve(Connection& c);
+    // SUBSCRIBE / UNSUBSCRIBE for c; the response
+    std::string subscribe(Connection& c, std::string_view command);
+    void update_event_mask();
+    // Bus dispatcher thread: format and queue for the event loop
+    void on_event(const EventRecord& e);
+    // Fan queued events and due stats out; returns the next stats deadline (0: none)
+    uint64_t push_updates(uint64_t now_ns);
+    bool push(Connection& c, std::string_view frame, uint64_t now_ns);
+    void drop_laggards(uint64_t now_ns);
+    bool flush(Connection& c);
+    void update_events(Connection& c);
+    void close_client(int fd);
+    // Serves one scrape per connection, one connection at a time
+    void metrics_loop();
+    void serve_metrics(int client_fd);
 
     uint16_t port_;
     StatsManager& stats_;
     Logger& logger_;
     CommandHandler handler_;
+    MetricsExporter metrics_;
 
     int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1; // eventfd: stop() wakes the event loop
+    int reserve_fd_ = -1; // held so a connection can be refused when out of fds
+    uint16_t metrics_port_ = 0;
+    ThreadPlacement placement_;
+    int metrics_fd_ = -1;
+    std::thread metrics_thread_;
     std::atomic<bool> running_{false};
     std::atomic<bool> should_stop_{false};
-    std::thread accept_thread_;
+    std::thread loop_thread_;
+
+    // Event loop thread only
+    std::unordered_map<int, std::unique_ptr<Connection>> clients_;
+    std::vector<int> pushed_; // clients pushed to this round
+    uint64_t last_lag_check_ns_ = 0;
+    bool any_lagging_ = false;
+    uint64_t accept_resume_ns_ = 0; // listener paused until then; 0: listening
+    std::size_t max_clients_ = DEFAULT_MAX_CLIENTS;
+    std::atomic<std::size_t> client_count_{0};
+    std::atomic<uint64_t> clients_rejected_{0};
 
-    std::mutex clients_mutex_;
-    std::vector<std::thread> client_threads_;
-    std::vector<int> client_fds_;
+    EventBus* bus_ = nullptr;
+    uint32_t bus_sub_ = 0;
+    LogLineFormatter event_format_;          // bus dispatcher thread only
+    std::atomic<uint32_t> event_mask_{0};   // union of the clients' categories
+    std::mutex events_mutex_;
+    std::vector<PendingEvent> events_;      // dispatcher -> event loop
+    std::vector<PendingEvent> delivering_;  // event loop only
+    std::atomic<uint64_t> pushes_dropped_{0};
+    std::atomic<uint64_t> lag_disconnects_{0};
 };
 
 } // namespace nng
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace nng {
+
+constexpr char ascii_upper(char c) {
+    return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// s equals the upper-case word, ignoring the case of s
+constexpr bool iequals_upper(std::string_view s, std::string_view word) {
+    if (s.size() != word.size())
+        return false;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (ascii_upper(s[i]) != word[i])
+            return false;
+    }
+    return true;
+}
+
+template <typename T>
+struct Keyword {
+    std::string_view name; // upper case
+    T value;
+};
+
+// Case-insensitive keyword -> value map built at compile time. The
+// constructor searches for a hash seed under which no two names share a
+// slot, so a lookup is one hash of the token and one comparison, with no
+// copy or case conversion of the token. perfect() is false if no seed was
+// found (check it with a static_assert).
+template <typename T, std::size_t N>
+class KeywordMap {
+public:
+    static constexpr std::size_t SLOTS = [] {
+        std::size_t n = 1;
+        while (n < 2 * N)
+            n <<= 1;
+        return n;
+    }();
+
+    constexpr explicit KeywordMap(const Keyword<T> (&words)[N]) {
+        for (std::size_t i = 0; i < N; ++i)
+            words_[i] = words[i];
+        for (uint32_t seed = 0; seed < MAX_SEED; ++seed) {
+            if (try_seed(seed)) {
+                seed_ = seed;
+                return;
+            }
+        }
+    }
+
+    constexpr bool perfect() const { return seed_ != MAX_SEED; }
+
+    // Value of the keyword token matches; false if it is none of them
+    constexpr bool find(std::string_view token, T& out) const {
+        int16_t i = slots_[slot(token, seed_)];
+        if (i < 0 || !iequals_upper(token, words_[i].name))
+            return false;
+        out = words_[i].value;
+        return true;
+    }
+
+private:
+    static constexpr uint32_t MAX_SEED = 4096;
+
+    // FNV-1a of the upper-cased token
+    static constexpr std::size_t slot(std::string_view s, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (char c : s) {
+            h ^= static_cast<uint8_t>(ascii_upper(c));
+            h *= 16777619u;
+        }
+        return (h ^ (h >> 15)) & (SLOTS - 1);
+    }
+
+    constexpr bool try_seed(uint32_t seed) {
+        for (auto& s : slots_)
+            s = -1;
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t s = slot(words_[i].name, seed);
+            if (slots_[s] >= 0)
+                return false;
+            slots_[s] = static_cast<int16_t>(i);
+        }
+        return true;
+    }
+
+    Keyword<T> words_[N] = {};
+    int16_t slots_[SLOTS] = {};
+    uint32_t seed_ = MAX_SEED;
+};
+
+template <typename T, std::size_t N>
+constexpr KeywordMap<T, N> make_keyword_map(const Keyword<T> (&words)[N]) {
+    return KeywordMap<T, N>(words);
+}
+
+} // namespace nng
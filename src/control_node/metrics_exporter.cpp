@@ -0,0 +1,180 @@
+#include "control_node/metrics_exporter.h"
+#include <charconv>
+
+namespace nng {
+namespace {
+
+constexpr std::size_t INITIAL_BUFFER = 64 * 1024;
+
+struct SourceFamily {
+    const char* name;
+    const char* help;
+    uint64_t SourceStats::*field;
+};
+
+constexpr SourceFamily SOURCE_FAMILIES[] = {
+    {"nng_source_rx_frames_total", "Frames received from the source.", &SourceStats::rx_count},
+    {"nng_source_malformed_frames_total", "Malformed frames from the source.", &SourceStats::malformed},
+    {"nng_source_gaps_total", "Frames missing from the source's sequence.", &SourceStats::gaps},
+    {"nng_source_reorders_total", "Out-of-order frames from the source.", &SourceStats::reorders},
+    {"nng_source_duplicates_total", "Duplicate frames from the source.", &SourceStats::duplicates},
+};
+
+constexpr double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+constexpr const char* QUANTILE_LABELS[] = {"0.5", "0.9", "0.99", "0.999"};
+
+} // anonymous namespace
+
+MetricsExporter::MetricsExporter(StatsManager& stats) : stats_(stats) {
+    buf_.reserve(INITIAL_BUFFER);
+}
+
+std::string_view MetricsExporter::render() {
+    buf_.clear();
+    render_global();
+    render_sources();
+    render_latency();
+    if (pipeline_)
+        render_queues();
+    return buf_;
+}
+
+void MetricsExporter::render_global() {
+    GlobalStats g = stats_.get_global_stats();
+    family("nng_rx_frames_total", "counter", "Frames received.");
+    sample("nng_rx_frames_total", g.rx_total);
+    family("nng_malformed_frames_total", "counter", "Frames that failed to parse.");
+    sample("nng_malformed_frames_total", g.malformed_total);
+    family("nng_gaps_total", "counter", "Frames missing from source sequences.");
+    sample("nng_gaps_total", g.gap_total);
+    family("nng_reorders_total", "counter", "Frames received out of order.");
+    sample("nng_reorders_total", g.reorder_total);
+    family("nng_duplicates_total", "counter", "Duplicate frames.");
+    sample("nng_duplicates_total", g.duplicate_total);
+    family("nng_crc_failures_total", "counter", "Frames that failed the CRC check.");
+    sample("nng_crc_failures_total", g.crc_fail_total);
+    family("nng_filtered_frames_total", "counter", "Frames dropped by the ingress filter.");
+    sample("nng_filtered_frames_total", g.filtered_total);
+
+    family("nng_health", "gauge", "0 = OK, 1 = DEGRADED, 2 = ERROR.");
+    sample("nng_health", static_cast<uint64_t>(stats_.get_health()));
+}
+
+void MetricsExporter::render_sources() {
+    stats_.get_all_source_stats(sources_);
+    family("nng_sources", "gauge", "Sources seen.");
+    sample("nng_sources", sources_.size());
+
+    for (const auto& f : SOURCE_FAMILIES) {
+        family(f.name, "counter", f.help);
+        for (const auto& s : sources_)
+            sample(f.name, "src", s.src_id, s.*f.field);
+    }
+}
+
+void MetricsExporter::render_latency() {
+    LatencyStats lat = stats_.get_latency_stats();
+    const std::pair<const char*, const StageLatency*> stages[] = {
+        {"wire", &lat.wire}, {"queue", &lat.queue}, {"process", &lat.process},
+    };
+    family("nng_stage_latency_ns", "summary", "Time spent per ingest stage.");
+    for (const auto& [stage, st] : stages) {
+        sample("nng_stage_latency_ns_sum", "stage", stage, st->total_ns);
+        sample("nng_stage_latency_ns_count", "stage", stage, st->count);
+    }
+    family("nng_stage_latency_max_ns", "gauge", "Longest time spent in an ingest stage.");
+    for (const auto& [stage, st] : stages)
+        sample("nng_stage_latency_max_ns", "stage", stage, st->max_ns);
+
+    SourceLatency all = stats_.get_all_source_latency();
+    const struct {
+        const char* name;
+        const char* help;
+        const HistogramSnapshot& snap;
+    } hists[] = {
+        {"nng_interarrival_ns", "Time between consecutive frames of a source, all sources.",
+         all.interarrival},
+        {"nng_source_latency_ns", "Receive time minus sender timestamp, all sources.",
+         all.latency},
+    };
+    for (const auto& h : hists) {
+        family(h.name, "summary", h.help);
+        for (std::size_t q = 0; q < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++q)
+            sample(h.name, "quantile", QUANTILE_LABELS[q], h.snap.percentile(QUANTILES[q]));
+        buf_ += h.name;
+        buf_ += "_count ";
+        append(h.snap.count);
+        buf_ += '\n';
+    }
+}
+
+void MetricsExporter::render_queues() {
+    PipelineStats p = pipeline_();
+    const std::pair<const char*, const QueueStats*> queues[] = {
+        {"rx", &p.rx}, {"record", &p.record}, {"dispatch", &p.dispatch},
+        {"priority", &p.priority},
+    };
+    family("nng_queue_depth", "gauge", "Elements waiting in an inter-stage queue.");
+    for (const auto& [q, st] : queues)
+        sample("nng_queue_depth", "queue", q, st->depth);
+    family("nng_queue_high_water", "gauge", "Deepest an inter-stage queue has been.");
+    for (const auto& [q, st] : queues)
+        sample("nng_queue_high_water", "queue", q, st->high_water);
+    family("nng_queue_enqueued_total", "counter", "Elements pushed to an inter-stage queue.");
+    for (const auto& [q, st] : queues)
+        sample("nng_queue_enqueued_total", "queue", q, st->enqueued);
+    family("nng_queue_dropped_total", "counter", "Elements dropped at a full inter-stage queue.");
+    for (const auto& [q, st] : queues)
+        sample("nng_queue_dropped_total", "queue", q, st->dropped);
+}
+
+void MetricsExporter::family(const char* name, const char* type, const char* help) {
+    buf_ += "# HELP ";
+    buf_ += name;
+    buf_ += ' ';
+    buf_ += help;
+    buf_ += "\n# TYPE ";
+    buf_ += name;
+    buf_ += ' ';
+    buf_ += type;
+    buf_ += '\n';
+}
+
+void MetricsExporter::sample(const char* name, uint64_t value) {
+    buf_ += name;
+    buf_ += ' ';
+    append(value);
+    buf_ += '\n';
+}
+
+void MetricsExporter::sample(const char* name, const char* label, const char* label_value,
+                             uint64_t value) {
+    buf_ += name;
+    buf_ += '{';
+    buf_ += label;
+    buf_ += "=\"";
+    buf_ += label_value;
+    buf_ += "\"} ";
+    append(value);
+    buf_ += '\n';
+}
+
+void MetricsExporter::sample(const char* name, const char* label, uint64_t label_value,
+                             uint64_t value) {
+    buf_ += name;
+    buf_ += '{';
+    buf_ += label;
+    buf_ += "=\"";
+    append(label_value);
+    buf_ += "\"} ";
+    append(value);
+    buf_ += '\n';
+}
+
+void MetricsExporter::append(uint64_t value) {
+    char digits[20];
+    auto res = std::to_chars(digits, digits + sizeof(digits), value);
+    buf_.append(digits, res.ptr);
+}
+
+} // namespace nng
@@ -0,0 +1,51 @@
+#pragma once
+#include "gateway/stats_manager.h"
+#include "gateway/pipeline.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nng {
+
+// Renders the gateway's counters in the Prometheus text exposition format
+// (0.0.4, also accepted by OpenMetrics scrapers) for an HTTP /metrics
+// endpoint.
+//
+// The text goes into a buffer owned by the exporter and the per-source
+// counters into a scratch vector; both are reused across scrapes, so once
+// they have grown to fit, a scrape does not allocate. Per-source series are
+// plain counters; latency histograms are exported for all sources combined
+// (as summaries), which keeps a 10k-source scrape to one pass over the
+// counters. Not thread-safe: render from one thread at a time.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(StatsManager& stats);
+
+    // Queue depths are exported when set, e.g. to a lambda returning
+    // Gateway::pipeline_stats()
+    void set_pipeline_stats(std::function<PipelineStats()> fn) { pipeline_ = std::move(fn); }
+
+    // Render every metric. The view stays valid until the next render().
+    std::string_view render();
+
+private:
+    void family(const char* name, const char* type, const char* help);
+    void sample(const char* name, uint64_t value);
+    void sample(const char* name, const char* label, const char* label_value, uint64_t value);
+    void sample(const char* name, const char* label, uint64_t label_value, uint64_t value);
+    void append(uint64_t value);
+
+    void render_global();
+    void render_sources();
+    void render_latency();
+    void render_queues();
+
+    StatsManager& stats_;
+    std::function<PipelineStats()> pipeline_;
+    std::string buf_;
+    std::vector<SourceStats> sources_;
+};
+
+} // namespace nng
@@ -0,0 +1,153 @@
+#include "control_node/stats_wire.h"
+#include <algorithm>
+
+namespace nng {
+
+namespace {
+
+bool same(const SourceStats& a, const SourceStats& b) {
+    return a.rx_count == b.rx_count && a.malformed == b.malformed && a.gaps == b.gaps &&
+           a.reorders == b.reorders && a.duplicates == b.duplicates &&
+           a.last_seq == b.last_seq && a.last_ts_ns == b.last_ts_ns;
+}
+
+template <typename T>
+void append(std::string& out, const T& v) {
+    const char* p = reinterpret_cast<const char*>(&v);
+    out.append(p, sizeof(T));
+}
+
+StatsWireHeader header_for(const StatsSnapshot& snap, StatsWireKind kind) {
+    StatsWireHeader h{};
+    h.magic = STATS_WIRE_MAGIC;
+    h.version = STATS_WIRE_VERSION;
+    h.kind = static_cast<uint8_t>(kind);
+    h.health = static_cast<uint8_t>(snap.health);
+    h.snapshot_version = snap.version;
+    return h;
+}
+
+} // anonymous namespace
+
+void encode_stats_wire(const StatsSnapshot& snap, std::string& out) {
+    StatsWireHeader h = header_for(snap, StatsWireKind::STATS);
+    h.count = 1;
+    out.reserve(out.size() + sizeof(h) + sizeof(GlobalStatsRecord));
+    append(out, h);
+    append(out, to_record(snap.global));
+}
+
+void encode_sources_wire(const StatsSnapshot& snap, const StatsSnapshot* base, std::string& out) {
+    StatsWireHeader h = header_for(snap, StatsWireKind::SOURCES);
+    std::size_t at = out.size();
+    out.resize(at + sizeof(h) + snap.sources.size() * sizeof(SourceStatsRecord));
+    char* rec = &out[at + sizeof(h)];
+    uint32_t count = 0;
+
+    // Both source lists are sorted by src_id: walk them together
+    bool delta = base != nullptr;
+    std::size_t b = 0;
+    for (const SourceStats& s : snap.sources) {
+        if (delta) {
+            while (b < base->sources.size() && base->sources[b].src_id < s.src_id) {
+                delta = false; // gone from snap
+                ++b;
+            }
+        }
+        if (delta && b < base->sources.size() && base->sources[b].src_id == s.src_id &&
+            same(base->sources[b++], s))
+            continue;
+        SourceStatsRecord r = to_record(s);
+        std::memcpy(rec + count * sizeof(r), &r, sizeof(r));
+        ++count;
+    }
+    if (delta && b < base->sources.size())
+        delta = false;
+
+    if (!delta && base) {
+        // A source disappeared (a reset): send everything
+        out.resize(at);
+        encode_sources_wire(snap, nullptr, out);
+        return;
+    }
+    h.count = count;
+    if (delta) {
+        h.flags = STATS_WIRE_DELTA;
+        h.base_version = base->version;
+    }
+    std::memcpy(&out[at], &h, sizeof(h));
+    out.resize(at + sizeof(h) + count * sizeof(SourceStatsRecord));
+}
+
+bool decode_stats_wire(const void* data, std::size_t len, StatsWireView& out) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    StatsWireHeader h;
+    if (len < sizeof(h))
+        return false;
+    std::memcpy(&h, p, sizeof(h));
+    if (h.magic != STATS_WIRE_MAGIC || h.version != STATS_WIRE_VERSION ||
+        h.health > static_cast<uint8_t>(HealthState::ERROR))
+        return false;
+    p += sizeof(h);
+    len -= sizeof(h);
+
+    out.delta = (h.flags & STATS_WIRE_DELTA) != 0;
+    out.health = static_cast<HealthState>(h.health);
+    out.version = h.snapshot_version;
+    out.base_version = h.base_version;
+    out.sources.clear();
+    switch (static_cast<StatsWireKind>(h.kind)) {
+        case StatsWireKind::STATS: {
+            GlobalStatsRecord r;
+            if (h.count != 1 || len != sizeof(r))
+                return false;
+            std::memcpy(&r, p, sizeof(r));
+            out.kind = StatsWireKind::STATS;
+            out.global = from_record(r);
+            return true;
+        }
+        case StatsWireKind::SOURCES: {
+            if (len != uint64_t{h.count} * sizeof(SourceStatsRecord))
+                return false;
+            out.kind = StatsWireKind::SOURCES;
+            out.sources.resize(h.count);
+            for (uint32_t i = 0; i < h.count; ++i) {
+                SourceStatsRecord r;
+                std::memcpy(&r, p + i * sizeof(r), sizeof(r));
+                out.sources[i] = from_record(r);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SourceStatsTable::apply(const StatsWireView& view) {
+    if (view.kind != StatsWireKind::SOURCES)
+        return false;
+    if (!view.delta) {
+        sources = view.sources;
+        version = view.version;
+        return true;
+    }
+    if (view.base_version != version || version == 0)
+        return false;
+
+    // Overlay the changed sources (both sorted), adding new ones
+    std::vector<SourceStats> merged;
+    merged.reserve(sources.size() + view.sources.size());
+    std::size_t i = 0;
+    for (const SourceStats& s : view.sources) {
+        while (i < sources.size() && sources[i].src_id < s.src_id)
+            merged.push_back(sources[i++]);
+        if (i < sources.size() && sources[i].src_id == s.src_id)
+            ++i;
+        merged.push_back(s);
+    }
+    merged.insert(merged.end(), sources.begin() + static_cast<std::ptrdiff_t>(i), sources.end());
+    sources.swap(merged);
+    version = view.version;
+    return true;
+}
+
+} // namespace nng
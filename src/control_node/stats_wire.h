@@ -0,0 +1,137 @@
+#pragma once
+#include "gateway/stats_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+// Binary stats responses (GET STATS BIN, GET SOURCES BIN). All integers
+// little-endian; the payload of one response frame is
+//
+//   StatsWireHeader
+//   GlobalStatsRecord              (STATS)
+//   SourceStatsRecord[count]       (SOURCES, sorted by src_id)
+//
+// With STATS_WIRE_DELTA the response holds only the records that changed
+// since base_version, a snapshot version the client received before; the
+// client overlays them on its copy. A full response (no flag) replaces it.
+
+constexpr uint32_t STATS_WIRE_MAGIC = 0x4253544E; // "NTSB"
+constexpr uint8_t  STATS_WIRE_VERSION = 1;
+constexpr uint8_t  STATS_WIRE_DELTA = 0x01;
+
+enum class StatsWireKind : uint8_t {
+    STATS   = 1,
+    SOURCES = 2,
+};
+
+#pragma pack(push, 1)
+
+struct StatsWireHeader {
+    uint32_t magic;            // STATS_WIRE_MAGIC
+    uint8_t  version;          // STATS_WIRE_VERSION
+    uint8_t  kind;             // StatsWireKind
+    uint8_t  flags;            // STATS_WIRE_DELTA
+    uint8_t  health;           // HealthState
+    uint64_t snapshot_version; // of the counters sent
+    uint64_t base_version;     // delta base (0 if full)
+    uint32_t count;            // records that follow
+};
+static_assert(sizeof(StatsWireHeader) == 28, "StatsWireHeader must be 28 bytes");
+
+struct GlobalStatsRecord {
+    uint64_t rx_total;
+    uint64_t malformed_total;
+    uint64_t gap_total;
+    uint64_t reorder_total;
+    uint64_t duplicate_total;
+    uint64_t crc_fail_total;
+    uint64_t filtered_total;
+};
+static_assert(sizeof(GlobalStatsRecord) == 56, "GlobalStatsRecord must be 56 bytes");
+
+struct SourceStatsRecord {
+    uint16_t src_id;
+    uint16_t reserved;
+    uint32_t last_seq;
+    uint64_t rx_count;
+    uint64_t malformed;
+    uint64_t gaps;
+    uint64_t reorders;
+    uint64_t duplicates;
+    uint64_t last_ts_ns;
+};
+static_assert(sizeof(SourceStatsRecord) == 56, "SourceStatsRecord must be 56 bytes");
+
+#pragma pack(pop)
+
+inline GlobalStatsRecord to_record(const GlobalStats& g) {
+    return GlobalStatsRecord{g.rx_total, g.malformed_total, g.gap_total, g.reorder_total,
+                             g.duplicate_total, g.crc_fail_total, g.filtered_total};
+}
+
+inline GlobalStats from_record(const GlobalStatsRecord& r) {
+    GlobalStats g;
+    g.rx_total = r.rx_total;
+    g.malformed_total = r.malformed_total;
+    g.gap_total = r.gap_total;
+    g.reorder_total = r.reorder_total;
+    g.duplicate_total = r.duplicate_total;
+    g.crc_fail_total = r.crc_fail_total;
+    g.filtered_total = r.filtered_total;
+    return g;
+}
+
+inline SourceStatsRecord to_record(const SourceStats& s) {
+    return SourceStatsRecord{s.src_id, 0, s.last_seq, s.rx_count, s.malformed,
+                             s.gaps, s.reorders, s.duplicates, s.last_ts_ns};
+}
+
+inline SourceStats from_record(const SourceStatsRecord& r) {
+    SourceStats s;
+    s.src_id = r.src_id;
+    s.rx_count = r.rx_count;
+    s.malformed = r.malformed;
+    s.gaps = r.gaps;
+    s.reorders = r.reorders;
+    s.duplicates = r.duplicates;
+    s.last_seq = r.last_seq;
+    s.last_ts_ns = r.last_ts_ns;
+    return s;
+}
+
+// Append a response to out. With base (the snapshot the client holds,
+// older than snap) only the sources that differ are written and the
+// delta flag is set; a base with a source snap lacks gives a full
+// response, as a delta cannot remove one.
+void encode_stats_wire(const StatsSnapshot& snap, std::string& out);
+void encode_sources_wire(const StatsSnapshot& snap, const StatsSnapshot* base, std::string& out);
+
+// A decoded response
+struct StatsWireView {
+    StatsWireKind kind = StatsWireKind::STATS;
+    bool delta = false;
+    HealthState health = HealthState::OK;
+    uint64_t version = 0;
+    uint64_t base_version = 0;
+    GlobalStats global;               // STATS
+    std::vector<SourceStats> sources; // SOURCES
+};
+
+// False if data is not a well-formed response (e.g. an ERR text)
+bool decode_stats_wire(const void* data, std::size_t len, StatsWireView& out);
+
+// Per-source counters kept up to date by delta polling
+struct SourceStatsTable {
+    uint64_t version = 0; // of the last response applied (0: none)
+    std::vector<SourceStats> sources; // sorted by src_id
+
+    // Replace (full) or overlay (delta) with a decoded SOURCES response;
+    // false if it is a delta against a version other than ours
+    bool apply(const StatsWireView& view);
+};
+
+} // namespace nng
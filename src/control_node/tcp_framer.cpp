@@ -1,78 +1,106 @@
 #include "control_node/tcp_framer.h"
+#include <algorithm>
 #include <cstring>
 
 namespace nng {
+namespace {
+
+uint32_t read_header(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+} // anonymous namespace
+
+void TcpFramer::write_header(uint32_t len, uint8_t* dst) {
+    // Big-endian length prefix
+    dst[0] = static_cast<uint8_t>((len >> 24) & 0xFF);
+    dst[1] = static_cast<uint8_t>((len >> 16) & 0xFF);
+    dst[2] = static_cast<uint8_t>((len >> 8) & 0xFF);
+    dst[3] = static_cast<uint8_t>(len & 0xFF);
+}
 
 std::vector<uint8_t> TcpFramer::encode(const std::string& payload) {
     return encode(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
 }
 
 std::vector<uint8_t> TcpFramer::encode(const uint8_t* data, std::size_t len) {
-    std::vector<uint8_t> result(4 + len);
-    // Big-endian length prefix
-    uint32_t be_len = static_cast<uint32_t>(len);
-    result[0] = static_cast<uint8_t>((be_len >> 24) & 0xFF);
-    result[1] = static_cast<uint8_t>((be_len >> 16) & 0xFF);
-    result[2] = static_cast<uint8_t>((be_len >> 8) & 0xFF);
-    result[3] = static_cast<uint8_t>(be_len & 0xFF);
+    std::vector<uint8_t> result(HEADER_SIZE + len);
+    write_header(static_cast<uint32_t>(len), result.data());
     if (data && len > 0)
-        std::memcpy(result.data() + 4, data, len);
+        std::memcpy(result.data() + HEADER_SIZE, data, len);
     return result;
 }
 
+void TcpFramer::encode_append(std::string_view payload, std::vector<uint8_t>& out) {
+    std::size_t at = out.size();
+    out.resize(at + HEADER_SIZE + payload.size());
+    write_header(static_cast<uint32_t>(payload.size()), out.data() + at);
+    if (!payload.empty())
+        std::memcpy(out.data() + at + HEADER_SIZE, payload.data(), payload.size());
+}
+
+void TcpFramer::make_room(std::size_t len) {
+    if (head_ == tail_) {
+        head_ = scan_ = tail_ = 0;
+        if (buf_.size() > SHRINK_BYTES && len <= SHRINK_BYTES)
+            std::vector<uint8_t>().swap(buf_); // don't keep a huge frame's buffer
+    } else if (tail_ + len > buf_.size() && head_ > 0) {
+        // Move the unread bytes to the front
+        std::memmove(buf_.data(), buf_.data() + head_, tail_ - head_);
+        scan_ -= head_;
+        tail_ -= head_;
+        head_ = 0;
+    }
+    if (tail_ + len > buf_.size())
+        buf_.resize(std::max(tail_ + len, buf_.size() * 2));
+}
+
 void TcpFramer::feed(const uint8_t* data, std::size_t len) {
-    for (std::size_t i = 0; i < len; ++i)
-        buffer_.push_back(data[i]);
-    try_extract_frames();
+    if (len == 0)
+        return;
+    make_room(len);
+    std::memcpy(buf_.data() + tail_, data, len);
+    tail_ += len;
+    scan_frames();
 }
 
-void TcpFramer::try_extract_frames() {
-    while (buffer_.size() >= 4) {
-        // Read length (big-endian)
-        uint32_t frame_len = (static_cast<uint32_t>(buffer_[0]) << 24) |
-                             (static_cast<uint32_t>(buffer_[1]) << 16) |
-                             (static_cast<uint32_t>(buffer_[2]) << 8) |
-                             static_cast<uint32_t>(buffer_[3]);
+void TcpFramer::scan_frames() {
+    while (tail_ - scan_ >= HEADER_SIZE) {
+        uint32_t frame_len = read_header(buf_.data() + scan_);
 
         // Sanity check to prevent memory exhaustion
-        if (frame_len > 10 * 1024 * 1024) {
-            // Malformed: reset and discard
-            buffer_.clear();
+        if (frame_len > MAX_FRAME) {
+            // Malformed: discard everything after the complete frames
+            tail_ = scan_;
             return;
         }
 
-        if (buffer_.size() < 4 + frame_len)
+        if (tail_ - scan_ < HEADER_SIZE + frame_len)
             return; // Not enough data yet
 
-        // Extract frame payload
-        std::string payload;
-        payload.reserve(frame_len);
-        for (std::size_t i = 0; i < frame_len; ++i)
-            payload.push_back(static_cast<char>(buffer_[4 + i]));
-
-        // Remove frame from buffer
-        for (std::size_t i = 0; i < 4 + frame_len; ++i)
-            buffer_.pop_front();
-
-        ready_frames_.push_back(std::move(payload));
+        scan_ += HEADER_SIZE + frame_len;
+        ++ready_;
     }
 }
 
-bool TcpFramer::has_frame() const {
-    return !ready_frames_.empty();
+std::string_view TcpFramer::pop_view() {
+    if (ready_ == 0)
+        return {};
+    uint32_t frame_len = read_header(buf_.data() + head_);
+    std::string_view frame(reinterpret_cast<const char*>(buf_.data() + head_ + HEADER_SIZE), frame_len);
+    head_ += HEADER_SIZE + frame_len;
+    --ready_;
+    return frame;
 }
 
 std::string TcpFramer::pop_frame() {
-    if (ready_frames_.empty())
-        return {};
-    std::string frame = std::move(ready_frames_.front());
-    ready_frames_.pop_front();
-    return frame;
+    return std::string(pop_view());
 }
 
 void TcpFramer::reset() {
-    buffer_.clear();
-    ready_frames_.clear();
+    head_ = scan_ = tail_ = 0;
+    ready_ = 0;
 }
 
 } // namespace nng
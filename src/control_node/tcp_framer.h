@@ -1,37 +1,61 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
-#include <deque>
 
 namespace nng {
 
+// Length-prefixed framing ([u32_be length][payload]) over one contiguous
+// buffer: feed() appends with memcpy, complete frames are found as bytes
+// arrive, and pop_view() hands a frame out in place. Consumed bytes are
+// reclaimed by moving the unread tail to the front when space runs out.
 class TcpFramer {
 public:
+    static constexpr std::size_t HEADER_SIZE = 4;
+    // Larger lengths are taken as garbage: the partial data is dropped
+    static constexpr uint32_t MAX_FRAME = 10 * 1024 * 1024;
+
     // Encode: prepend 4-byte big-endian length to payload
     static std::vector<uint8_t> encode(const std::string& payload);
     static std::vector<uint8_t> encode(const uint8_t* data, std::size_t len);
+    // Append the encoded frame to out (no temporary)
+    static void encode_append(std::string_view payload, std::vector<uint8_t>& out);
+    // Write the length prefix for a len-byte payload to dst[0..3]
+    static void write_header(uint32_t len, uint8_t* dst);
 
     // Decode: feed bytes incrementally, extract complete frames
     void feed(const uint8_t* data, std::size_t len);
 
     // Check if a complete frame is available
-    bool has_frame() const;
+    bool has_frame() const { return ready_ > 0; }
 
     // Pop the next complete frame (payload only, no length prefix)
     std::string pop_frame();
 
+    // Pop the next complete frame without copying ({} if none). The view
+    // points into the framer and stays valid until the next feed() or
+    // reset().
+    std::string_view pop_view();
+
     // Reset internal buffer
     void reset();
 
-    // How many bytes are buffered
-    std::size_t buffered_bytes() const { return buffer_.size(); }
+    // Bytes received that are not yet part of a complete frame
+    std::size_t buffered_bytes() const { return tail_ - scan_; }
 
 private:
-    std::deque<uint8_t> buffer_;
-    std::deque<std::string> ready_frames_;
+    // An empty buffer larger than this is released before reuse
+    static constexpr std::size_t SHRINK_BYTES = 64 * 1024;
+
+    void make_room(std::size_t len);
+    void scan_frames();
 
-    void try_extract_frames();
+    std::vector<uint8_t> buf_;
+    std::size_t head_ = 0; // next frame to pop
+    std::size_t scan_ = 0; // end of the complete frames
+    std::size_t tail_ = 0; // end of the data
+    std::size_t ready_ = 0; // complete frames in [head_, scan_)
 };
 
 } // namespace nng
@@ -0,0 +1,111 @@
+#include "gateway/event_coalescer.h"
+#include <algorithm>
+
+namespace nng {
+namespace {
+
+constexpr EventId COALESCED_IDS[] = {
+    EventId::EVT_SEQ_GAP,
+    EventId::EVT_SEQ_REORDER,
+    EventId::EVT_FRAME_MALFORMED,
+    EventId::EVT_CRC_FAIL,
+};
+
+} // anonymous namespace
+
+EventCoalescer::EventCoalescer(uint64_t window_ns, uint32_t burst)
+    : window_ns_(window_ns), burst_(burst) {}
+
+EventCoalescer::~EventCoalescer() = default;
+
+int EventCoalescer::kind_of(EventId id) {
+    for (std::size_t k = 0; k < KINDS; ++k) {
+        if (COALESCED_IDS[k] == id)
+            return static_cast<int>(k);
+    }
+    return -1;
+}
+
+EventCoalescer::Slot& EventCoalescer::slot(std::size_t kind, uint16_t src_id) {
+    auto& page = pages_[kind][src_id >> PAGE_BITS];
+    if (!page)
+        page = std::make_unique<Page>();
+    return page->slots[src_id & (PAGE_SIZE - 1)];
+}
+
+bool EventCoalescer::admit(EventId id, uint16_t src_id, uint32_t amount, uint64_t now_ns,
+                           CoalescedEvents& summary) {
+    summary.count = 0;
+    int kind = kind_of(id);
+    if (!enabled() || kind < 0)
+        return true;
+
+    Slot& s = slot(static_cast<std::size_t>(kind), src_id);
+    if (!s.active || now_ns >= s.window_start + window_ns_) {
+        if (s.suppressed > 0)
+            summary = CoalescedEvents{id, src_id, s.suppressed, s.amount, window_ns_};
+        s.window_start = now_ns;
+        s.passed = 0;
+        s.suppressed = 0;
+        s.amount = 0;
+        s.active = true;
+    }
+
+    if (s.passed < burst_) {
+        ++s.passed;
+        return true;
+    }
+
+    ++s.suppressed;
+    s.amount += amount;
+    suppressed_total_.store(suppressed_total_.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+    if (!s.pending) {
+        s.pending = true;
+        pending_.push_back(static_cast<uint32_t>(kind) << 16 | src_id);
+        uint64_t due = s.window_start + window_ns_;
+        if (due < next_flush_ns())
+            next_flush_ns_.store(due, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void EventCoalescer::flush(uint64_t now_ns, std::vector<CoalescedEvents>& out) {
+    if (now_ns < next_flush_ns())
+        return;
+    flush_pending(now_ns, false, out);
+}
+
+void EventCoalescer::flush_all(std::vector<CoalescedEvents>& out) {
+    flush_pending(NEVER, true, out);
+}
+
+void EventCoalescer::flush_pending(uint64_t now_ns, bool all, std::vector<CoalescedEvents>& out) {
+    uint64_t next = NEVER;
+    std::size_t kept = 0;
+    for (uint32_t key : pending_) {
+        std::size_t kind = key >> 16;
+        auto src_id = static_cast<uint16_t>(key & 0xFFFF);
+        Slot& s = slot(kind, src_id);
+        uint64_t due = s.window_start + window_ns_;
+
+        // Still collecting: keep it listed
+        if (s.suppressed > 0 && !all && now_ns < due) {
+            next = std::min(next, due);
+            pending_[kept++] = key;
+            continue;
+        }
+        // Due; nothing suppressed means admit() reported it when the next
+        // window opened
+        if (s.suppressed > 0)
+            out.push_back(CoalescedEvents{COALESCED_IDS[kind], src_id, s.suppressed,
+                                          s.amount, window_ns_});
+        s.suppressed = 0;
+        s.amount = 0;
+        s.pending = false;
+    }
+    pending_.resize(kept);
+    next_flush_ns_.store(next, std::memory_order_relaxed);
+}
+
+} // namespace nng
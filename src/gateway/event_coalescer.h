@@ -0,0 +1,96 @@
+#pragma once
+#include "common/types.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace nng {
+
+// Events of one (EventId, src_id) key folded into a single summary
+struct CoalescedEvents {
+    EventId  id = EventId::EVT_SEQ_GAP;
+    uint16_t src_id = 0;
+    uint32_t count = 0;     // events suppressed
+    uint64_t amount = 0;    // their summed size (frames missing, for gaps)
+    uint64_t window_ns = 0; // span they were collected over
+};
+
+// Rate limiter for the fault events a lossy link raises once per bad frame
+// (EVT_SEQ_GAP, EVT_SEQ_REORDER, EVT_FRAME_MALFORMED, EVT_CRC_FAIL). Each
+// (EventId, src_id) key passes up to `burst` events per window; the rest
+// are only counted, and once the window closes they come out as one
+// CoalescedEvents summary. A fault storm therefore costs a bounded number
+// of formatted, logged and published events. Other event ids always pass.
+//
+// Per-source slots sit in pages allocated on first use. Not thread-safe,
+// except next_flush_ns() and suppressed_total(), which any thread may read.
+class EventCoalescer {
+public:
+    static constexpr uint64_t DEFAULT_WINDOW_NS = 1000000000ULL;
+    static constexpr uint32_t DEFAULT_BURST = 5;
+
+    // window_ns 0 disables coalescing: every event passes
+    explicit EventCoalescer(uint64_t window_ns = DEFAULT_WINDOW_NS,
+                            uint32_t burst = DEFAULT_BURST);
+    ~EventCoalescer();
+
+    EventCoalescer(const EventCoalescer&) = delete;
+    EventCoalescer& operator=(const EventCoalescer&) = delete;
+
+    bool enabled() const { return window_ns_ > 0; }
+
+    // Whether the event should be emitted. amount is its size (gap length,
+    // else 1). When the key's previous window closed with suppressed
+    // events, their summary is written to summary (count > 0); emit it
+    // before this event.
+    bool admit(EventId id, uint16_t src_id, uint32_t amount, uint64_t now_ns,
+               CoalescedEvents& summary);
+
+    // Append summaries of windows closed by now_ns that admit() has not
+    // already reported. Returns at once before next_flush_ns().
+    void flush(uint64_t now_ns, std::vector<CoalescedEvents>& out);
+    // Append every pending summary, closed or not (e.g. at shutdown)
+    void flush_all(std::vector<CoalescedEvents>& out);
+
+    // Earliest time a pending summary becomes due
+    uint64_t next_flush_ns() const { return next_flush_ns_.load(std::memory_order_relaxed); }
+
+    // Events suppressed so far
+    uint64_t suppressed_total() const { return suppressed_total_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t KINDS = 4;
+    static constexpr std::size_t PAGE_BITS = 8;
+    static constexpr std::size_t PAGE_SIZE = std::size_t{1} << PAGE_BITS;
+    static constexpr std::size_t PAGE_COUNT = 65536 / PAGE_SIZE;
+    static constexpr uint64_t NEVER = ~uint64_t{0};
+
+    struct Slot {
+        uint64_t window_start = 0;
+        uint32_t passed = 0;
+        uint32_t suppressed = 0;
+        uint64_t amount = 0;
+        bool     active = false;  // a window has been opened
+        bool     pending = false; // listed in pending_
+    };
+
+    struct Page {
+        Slot slots[PAGE_SIZE];
+    };
+
+    // Index of a coalesced event id, or -1
+    static int kind_of(EventId id);
+    Slot& slot(std::size_t kind, uint16_t src_id);
+    void flush_pending(uint64_t now_ns, bool all, std::vector<CoalescedEvents>& out);
+
+    uint64_t window_ns_;
+    uint32_t burst_;
+    std::unique_ptr<Page> pages_[KINDS][PAGE_COUNT];
+    std::vector<uint32_t> pending_; // kind << 16 | src_id, with suppressed events
+    std::atomic<uint64_t> next_flush_ns_{NEVER};
+    std::atomic<uint64_t> suppressed_total_{0};
+};
+
+} // namespace nng
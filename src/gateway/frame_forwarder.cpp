@@ -0,0 +1,183 @@
+#include "gateway/frame_forwarder.h"
+#include "gateway/frame_pool.h"
+#include "gateway/udp_socket.h"
+#include "common/crc32.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace nng {
+
+bool parse_forward_target(const std::string& target, std::string& host, uint16_t& port) {
+    std::size_t colon = target.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == target.size())
+        return false;
+    uint32_t value = 0;
+    for (std::size_t i = colon + 1; i < target.size(); ++i) {
+        char c = target[i];
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+        if (value > 65535)
+            return false;
+    }
+    if (value == 0)
+        return false;
+    host = target.substr(0, colon);
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+FrameForwarder::FrameForwarder(std::size_t max_datagram, bool crc, const IngressFilter* filter)
+    : max_datagram_(max_datagram),
+      crc_(crc),
+      filter_(filter) {
+    // The largest frame a datagram can hold still gets a container of its own
+    std::size_t overhead = CONTAINER_HEADER_SIZE + (crc_ ? FRAME_CRC_SIZE : 0);
+    slot_size_ = std::max(max_datagram_, FramePool::SLOT_SIZE + overhead);
+    buf_.resize(MAX_PENDING * slot_size_);
+}
+
+void FrameForwarder::add_sink(std::unique_ptr<IFrameSink> sink) {
+    if (sink)
+        sinks_.push_back(std::move(sink));
+}
+
+bool FrameForwarder::add(const TelemetryHeader& header, const uint8_t* payload) {
+    if (filter_ && !filter_->allows(header.src_id, header.msg_type)) {
+        filtered_.store(filtered_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::size_t len = sizeof(TelemetryHeader) + header.payload_len;
+    std::size_t tail = crc_ ? FRAME_CRC_SIZE : 0;
+    // body_len and frame_count are 16-bit
+    if (open_len_ > 0 &&
+        (open_len_ + len + tail > max_datagram_ ||
+         open_len_ - CONTAINER_HEADER_SIZE + len > 0xFFFF || open_frames_ == 0xFFFF))
+        close_container();
+    if (open_len_ == 0) {
+        if (pending_ == MAX_PENDING)
+            flush();
+        open_len_ = CONTAINER_HEADER_SIZE;
+    }
+
+    uint8_t* at = buf_.data() + pending_ * slot_size_ + open_len_;
+    serialize_header(header, at);
+    if (header.payload_len > 0)
+        std::memcpy(at + sizeof(TelemetryHeader), payload, header.payload_len);
+    open_len_ += len;
+    ++open_frames_;
+    frames_.store(frames_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameForwarder::close_container() {
+    if (open_len_ == 0)
+        return;
+    uint8_t* slot = buf_.data() + pending_ * slot_size_;
+
+    ContainerHeader hdr{};
+    hdr.version = PROTOCOL_VERSION_V2;
+    hdr.flags = crc_ ? CONTAINER_FLAG_CRC : 0;
+    hdr.frame_count = open_frames_;
+    hdr.body_len = static_cast<uint16_t>(open_len_ - CONTAINER_HEADER_SIZE);
+    serialize_container_header(hdr, slot);
+    if (crc_) {
+        uint32_t crc = crc32(slot, open_len_);
+        std::memcpy(slot + open_len_, &crc, sizeof(crc));
+        open_len_ += FRAME_CRC_SIZE;
+    }
+
+    views_[pending_] = FrameView{slot, open_len_};
+    ++pending_;
+    open_len_ = 0;
+    open_frames_ = 0;
+}
+
+void FrameForwarder::flush() {
+    close_container();
+    if (pending_ == 0)
+        return;
+    uint64_t sent = 0;
+    uint64_t failed = 0;
+    for (auto& sink : sinks_) {
+        std::size_t n = sink->send_batch(views_, pending_);
+        sent += n;
+        failed += pending_ - n;
+    }
+    pending_ = 0;
+    datagrams_.store(datagrams_.load(std::memory_order_relaxed) + sent, std::memory_order_relaxed);
+    if (failed > 0) {
+        send_failures_.store(send_failures_.load(std::memory_order_relaxed) + failed,
+                             std::memory_order_relaxed);
+    }
+}
+
+ForwardStats FrameForwarder::stats() const {
+    ForwardStats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.filtered = filtered_.load(std::memory_order_relaxed);
+    s.datagrams = datagrams_.load(std::memory_order_relaxed);
+    s.send_failures = send_failures_.load(std::memory_order_relaxed);
+    return s;
+}
+
+ForwardHub::ForwardHub(const ForwardOptions& options) : options_(options) {
+    // An invalid spec forwards everything; set_writers() callers see it in options()
+    filter_.set(options_.filter);
+}
+
+bool ForwardHub::set_writers(std::size_t n, std::string* error) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    while (forwarders_.size() < n) {
+        auto fwd = std::make_unique<FrameForwarder>(options_.max_datagram, options_.crc, &filter_);
+        for (const std::string& target : options_.targets) {
+            std::string host;
+            uint16_t port = 0;
+            auto sink = std::make_unique<UdpFrameSink>();
+            bool ok = parse_forward_target(target, host, port) && sink->connect(host, port);
+            in_addr addr{};
+            if (ok && ::inet_pton(AF_INET, host.c_str(), &addr) == 1 &&
+                IN_MULTICAST(ntohl(addr.s_addr)))
+                ok = sink->set_multicast(options_.multicast_ttl, options_.multicast_loop);
+            if (!ok) {
+                if (error)
+                    *error = target;
+                forwarders_.clear();
+                return false;
+            }
+            sink->set_gso(true);
+            fwd->add_sink(std::move(sink));
+        }
+        forwarders_.push_back(std::move(fwd));
+    }
+    return true;
+}
+
+std::size_t ForwardHub::writers() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return forwarders_.size();
+}
+
+FrameForwarder& ForwardHub::forwarder(std::size_t i) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return *forwarders_[i];
+}
+
+ForwardStats ForwardHub::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    ForwardStats total;
+    for (const auto& f : forwarders_) {
+        ForwardStats s = f->stats();
+        total.frames += s.frames;
+        total.filtered += s.filtered;
+        total.datagrams += s.datagrams;
+        total.send_failures += s.send_failures;
+    }
+    return total;
+}
+
+} // namespace nng
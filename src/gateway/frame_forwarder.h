@@ -0,0 +1,123 @@
+#pragma once
+#include "gateway/frame_source.h"
+#include "gateway/ingress_filter.h"
+#include "common/protocol.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+// Where and how validated frames are republished
+struct ForwardOptions {
+    // "host:port" each: a multicast group (224.0.0.0/4) or a unicast sink.
+    // Empty: no forwarding.
+    std::vector<std::string> targets;
+    // IngressFilter spec (type=..., src=...) of the frames to forward;
+    // empty forwards every validated frame
+    std::string filter;
+    std::size_t max_datagram = CONTAINER_MAX_DATAGRAM; // container size limit
+    bool crc = true;          // CRC32 on each container
+    int multicast_ttl = 1;    // hops for multicast targets
+    bool multicast_loop = true; // multicast also delivered on this host
+};
+
+// Split "host:port"; false if either part is missing or the port is not
+// 1..65535
+bool parse_forward_target(const std::string& target, std::string& host, uint16_t& port);
+
+struct ForwardStats {
+    uint64_t frames = 0;        // frames packed for forwarding
+    uint64_t filtered = 0;      // validated frames the filter kept back
+    uint64_t datagrams = 0;     // containers handed to the sinks, all sinks
+    uint64_t send_failures = 0; // containers a sink did not accept
+};
+
+// Republishes one ingest worker's validated frames. Frames are packed back
+// to back into protocol v2 containers of at most max_datagram bytes in a
+// fixed buffer, and flush() hands the closed containers to every sink with
+// one send_batch() each (sendmmsg() or GSO for a UdpFrameSink), so
+// forwarding a busy batch costs a few syscalls and no allocation.
+// Single writer: add() and flush() on the owning thread only; stats()
+// from any thread.
+class FrameForwarder {
+public:
+    // Containers held before add() flushes on its own
+    static constexpr std::size_t MAX_PENDING = 64;
+
+    // filter (not owned, may be null) is checked on every add()
+    FrameForwarder(std::size_t max_datagram, bool crc, const IngressFilter* filter);
+
+    FrameForwarder(const FrameForwarder&) = delete;
+    FrameForwarder& operator=(const FrameForwarder&) = delete;
+
+    void add_sink(std::unique_ptr<IFrameSink> sink);
+    std::size_t sinks() const { return sinks_.size(); }
+
+    // Queue one validated frame: its header and header.payload_len bytes
+    // of payload. False if the filter kept it back.
+    bool add(const TelemetryHeader& header, const uint8_t* payload);
+
+    // Close the open container and send everything queued
+    void flush();
+
+    ForwardStats stats() const;
+
+private:
+    void close_container();
+
+    std::size_t max_datagram_;
+    std::size_t slot_size_; // bytes per container in buf_: fits the largest frame
+    bool crc_;
+    const IngressFilter* filter_;
+    std::vector<std::unique_ptr<IFrameSink>> sinks_;
+
+    std::vector<uint8_t> buf_;   // MAX_PENDING slots of slot_size_
+    FrameView views_[MAX_PENDING]{};
+    std::size_t pending_ = 0;    // closed containers in buf_
+    std::size_t open_len_ = 0;   // bytes of the open container (0: none)
+    uint16_t open_frames_ = 0;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> filtered_{0};
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> send_failures_{0};
+};
+
+// The gateway's forwarding: the shared filter and one FrameForwarder per
+// ingest worker, kept between runs so their counters can still be read.
+class ForwardHub {
+public:
+    explicit ForwardHub(const ForwardOptions& options = {});
+
+    ForwardHub(const ForwardHub&) = delete;
+    ForwardHub& operator=(const ForwardHub&) = delete;
+
+    bool enabled() const { return !options_.targets.empty(); }
+    const ForwardOptions& options() const { return options_; }
+
+    // Frames forwarded; can be changed while running
+    IngressFilter& filter() { return filter_; }
+    const IngressFilter& filter() const { return filter_; }
+
+    // Make sure there are at least n forwarders, each with a UdpFrameSink
+    // per target. False (error says which target) if a target is invalid
+    // or its socket could not be set up; the forwarders are then removed.
+    bool set_writers(std::size_t n, std::string* error = nullptr);
+    std::size_t writers() const;
+    FrameForwarder& forwarder(std::size_t i);
+
+    ForwardStats stats() const; // all forwarders
+
+private:
+    ForwardOptions options_;
+    IngressFilter filter_;
+    mutable std::shared_mutex mutex_; // guards forwarders_ itself
+    std::vector<std::unique_ptr<FrameForwarder>> forwarders_;
+};
+
+} // namespace nng
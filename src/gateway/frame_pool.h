@@ -0,0 +1,111 @@
+#pragma once
+#include "common/types.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace nng {
+
+// Non-owning view of one frame's bytes. Valid until the owning slot is reused.
+struct FrameView {
+    const uint8_t* data = nullptr;
+    std::size_t    len  = 0;
+    // Kernel receive time (CLOCK_REALTIME ns), 0 if the source has none
+    uint64_t       rx_ts_ns = 0;
+};
+
+// Fixed slab of equally sized, cache-line aligned frame slots.
+// Allocated once up front; slots are addressed by index and never freed.
+class FramePool {
+public:
+    // Holds the largest valid telemetry frame (18 + 1024 + 4) with headroom
+    static constexpr std::size_t SLOT_SIZE = 2048;
+    static_assert(SLOT_SIZE >= FRAME_HEADER_SIZE + MAX_PAYLOAD_SIZE + FRAME_CRC_SIZE,
+                  "FramePool slot must hold the largest valid telemetry frame");
+
+    explicit FramePool(std::size_t slot_count)
+        : slot_count_(slot_count),
+          slab_(new (std::align_val_t(64)) uint8_t[slot_count * SLOT_SIZE]) {}
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    uint8_t* slot(std::size_t i) { return slab_.get() + i * SLOT_SIZE; }
+    const uint8_t* slot(std::size_t i) const { return slab_.get() + i * SLOT_SIZE; }
+    std::size_t slot_count() const { return slot_count_; }
+
+private:
+    struct AlignedDelete {
+        void operator()(uint8_t* p) const { ::operator delete[](p, std::align_val_t(64)); }
+    };
+
+    std::size_t slot_count_;
+    std::unique_ptr<uint8_t[], AlignedDelete> slab_;
+};
+
+// A batch of received frames backed by a FramePool: frame i lives in slot i
+// (or, for zero-copy sources, in source memory via commit_view()).
+// Sources write straight into the next free slot and commit its length;
+// consumers read FrameViews. Reusing the batch costs no allocation.
+class FrameBatch {
+public:
+    explicit FrameBatch(std::size_t capacity)
+        : pool_(capacity > 0 ? capacity : 1), views_(pool_.slot_count()) {}
+
+    std::size_t capacity() const { return pool_.slot_count(); }
+    std::size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == capacity(); }
+    void clear() { count_ = 0; }
+
+    // Writable slot i (FramePool::SLOT_SIZE bytes)
+    uint8_t* slot(std::size_t i) { return pool_.slot(i); }
+    // Next slot a source should fill
+    uint8_t* next_slot() { return pool_.slot(count_); }
+
+    // Commit next_slot() as a frame of len bytes (clamped to the slot size)
+    void commit(std::size_t len, uint64_t rx_ts_ns = 0) {
+        if (len > FramePool::SLOT_SIZE)
+            len = FramePool::SLOT_SIZE;
+        views_[count_] = FrameView{pool_.slot(count_), len, rx_ts_ns};
+        ++count_;
+    }
+
+    // Commit a frame that lives in source-owned memory instead of a slot
+    // (zero-copy sources). The source must keep it valid until its next
+    // receive_batch() call.
+    void commit_view(const uint8_t* data, std::size_t len, uint64_t rx_ts_ns = 0) {
+        views_[count_] = FrameView{data, len, rx_ts_ns};
+        ++count_;
+    }
+
+    // Copy any frames committed by view into their own slots, so the batch
+    // no longer depends on source memory (e.g. before handing it to another
+    // thread). Frames longer than a slot are truncated.
+    void detach() {
+        for (std::size_t i = 0; i < count_; ++i) {
+            FrameView& v = views_[i];
+            uint8_t* own = pool_.slot(i);
+            if (v.data == own)
+                continue;
+            if (v.len > FramePool::SLOT_SIZE)
+                v.len = FramePool::SLOT_SIZE;
+            if (v.len > 0)
+                std::memcpy(own, v.data, v.len);
+            v.data = own;
+        }
+    }
+
+    const FrameView& operator[](std::size_t i) const { return views_[i]; }
+    // All committed frames, contiguous (e.g. for IFrameSink::send_batch)
+    const FrameView* views() const { return views_.data(); }
+
+private:
+    FramePool pool_;
+    std::vector<FrameView> views_;
+    std::size_t count_ = 0;
+};
+
+} // namespace nng
@@ -1,48 +1,312 @@
 #include "gateway/frame_recorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace nng {
+namespace {
+
+constexpr std::size_t IO_ALIGN = 4096; // O_DIRECT buffer, size and offset alignment
+
+void backoff(unsigned& idle) {
+    ++idle;
+    if (idle < 64)
+        return;
+    if (idle < 256)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+std::size_t align_up(std::size_t n, std::size_t a) {
+    return (n + a - 1) / a * a;
+}
+
+} // anonymous namespace
+
+void FrameRecorder::FreeDeleter::operator()(char* p) const {
+    std::free(p);
+}
 
 FrameRecorder::~FrameRecorder() {
     close();
 }
 
-bool FrameRecorder::open(const std::string& path) {
+bool FrameRecorder::open(const std::string& path, const RecorderOptions& options) {
     close();
-    file_.open(path, std::ios::binary | std::ios::trunc);
-    if (!file_.is_open())
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+        return false;
+
+    block_bytes_ = align_up(std::max(options.block_bytes, MIN_BLOCK_BYTES), IO_ALIGN);
+
+    // File header, padded so chunks start sector-aligned for O_DIRECT
+    std::size_t header_bytes = options.direct_io ? IO_ALIGN : sizeof(RecordingFileHeader);
+    std::vector<char> head(header_bytes, 0);
+    RecordingFileHeader fh{};
+    std::memcpy(fh.magic, RECORDING_MAGIC, sizeof(fh.magic));
+    fh.version = RECORDING_VERSION;
+    fh.header_bytes = static_cast<uint32_t>(header_bytes);
+    fh.chunk_bytes = static_cast<uint32_t>(block_bytes_);
+    fh.created_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    std::memcpy(head.data(), &fh, sizeof(fh));
+    direct_ = false;
+    if (!write_all(head.data(), head.size())) {
+        ::close(fd_);
+        fd_ = -1;
         return false;
-    frame_count_ = 0;
+    }
+    offset_ = header_bytes;
+    index_.clear();
+
+    // Reserve the blocks without changing the file size; a hint only
+    if (options.preallocate_bytes > 0)
+        (void)::fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0,
+                          static_cast<off_t>(options.preallocate_bytes));
+    if (options.direct_io)
+        set_direct(true);
+    align_ = direct_ ? IO_ALIGN : 8;
+
+    std::size_t count = std::max<std::size_t>(options.block_count, 2);
+    blocks_.clear();
+    blocks_.resize(count);
+    free_ = std::make_unique<SpscRing<uint32_t>>(count);
+    full_ = std::make_unique<SpscRing<uint32_t>>(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        blocks_[i].data.reset(static_cast<char*>(std::aligned_alloc(IO_ALIGN, block_bytes_)));
+        if (!blocks_[i].data) {
+            ::close(fd_);
+            fd_ = -1;
+            blocks_.clear();
+            return false;
+        }
+        free_->try_push(i);
+    }
+
+    codec_ = codec_available(options.codec) ? options.codec : Codec::NONE;
+    codec_level_ = options.codec_level;
+    scratch_.reset();
+    if (codec_ != Codec::NONE) {
+        scratch_.reset(static_cast<char*>(std::aligned_alloc(IO_ALIGN, block_bytes_)));
+        if (!scratch_)
+            codec_ = Codec::NONE;
+    }
+
+    drop_when_full_ = options.drop_when_full;
+    placement_ = options.placement;
+    cur_ = nullptr;
+    next_frame_ = 0;
+    stopping_.store(false);
+    failed_.store(false);
+    frame_count_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    stalls_.store(0, std::memory_order_relaxed);
+    blocks_written_.store(0, std::memory_order_relaxed);
+    write_errors_.store(0, std::memory_order_relaxed);
+    raw_bytes_.store(0, std::memory_order_relaxed);
+    stored_bytes_.store(0, std::memory_order_relaxed);
+    writer_ = std::thread(&FrameRecorder::writer_loop, this);
     return true;
 }
 
+void FrameRecorder::set_direct(bool on) {
+    int flags = ::fcntl(fd_, F_GETFL);
+    if (flags < 0)
+        return;
+    flags = on ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+    // Filesystems without O_DIRECT support refuse it; stay buffered
+    if (::fcntl(fd_, F_SETFL, flags) == 0)
+        direct_ = on;
+}
+
+void FrameRecorder::count_drop() {
+    dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
 bool FrameRecorder::record(uint64_t rx_timestamp_ns,
                            const uint8_t* frame_data, std::size_t frame_len) {
-    if (!file_.is_open())
+    if (fd_ < 0 || failed_.load(std::memory_order_relaxed))
         return false;
+    if (frame_data == nullptr)
+        frame_len = 0;
+
+    std::size_t need = FRAME_RECORD_HEADER + frame_len;
+    if (sizeof(ChunkHeader) + need > block_bytes_) {
+        count_drop();
+        return false;
+    }
 
-    // Write timestamp (8 bytes)
-    file_.write(reinterpret_cast<const char*>(&rx_timestamp_ns), sizeof(rx_timestamp_ns));
+    // Frames never span chunks: start a new one if this does not fit
+    if (cur_ && cur_->used + need > block_bytes_)
+        submit_block();
+    if (!cur_) {
+        if (drop_when_full_ && free_->empty()) {
+            count_drop();
+            return false;
+        }
+        if (!acquire_block())
+            return false;
+    }
+
+    char* p = cur_->data.get() + cur_->used;
+    auto len = static_cast<uint32_t>(frame_len);
+    std::memcpy(p, &rx_timestamp_ns, sizeof(rx_timestamp_ns));
+    std::memcpy(p + sizeof(rx_timestamp_ns), &len, sizeof(len));
+    if (frame_len > 0)
+        std::memcpy(p + FRAME_RECORD_HEADER, frame_data, frame_len);
+    cur_->used += need;
+
+    ChunkHeader& h = cur_->header;
+    if (h.frame_count == 0) {
+        h.first_frame = next_frame_;
+        h.min_ts_ns = rx_timestamp_ns;
+        h.max_ts_ns = rx_timestamp_ns;
+    } else {
+        h.min_ts_ns = std::min(h.min_ts_ns, rx_timestamp_ns);
+        h.max_ts_ns = std::max(h.max_ts_ns, rx_timestamp_ns);
+    }
+    ++h.frame_count;
+    uint16_t src_id;
+    if (recorded_src_id(frame_data, frame_len, src_id))
+        chunk_mark_source(h, src_id);
+
+    ++next_frame_;
+    frame_count_.store(frame_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool FrameRecorder::acquire_block() {
+    if (!free_->try_pop(cur_index_)) {
+        stalls_.store(stalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        unsigned idle = 0;
+        while (!free_->try_pop(cur_index_)) {
+            if (failed_.load(std::memory_order_relaxed))
+                return false;
+            backoff(idle);
+        }
+    }
+    cur_ = &blocks_[cur_index_];
+    cur_->used = sizeof(ChunkHeader);
+    cur_->header = ChunkHeader{};
+    return true;
+}
+
+void FrameRecorder::submit_block() {
+    // Never fails: the ring holds every block
+    full_->try_push(cur_index_);
+    cur_ = nullptr;
+}
 
-    // Write frame length (4 bytes)
-    uint32_t len = static_cast<uint32_t>(frame_len);
-    file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
+void FrameRecorder::writer_loop() {
+    placement_.pin(ThreadRole::WRITER);
+    unsigned idle = 0;
+    while (true) {
+        uint32_t index;
+        if (!full_->try_pop(index)) {
+            if (stopping_.load(std::memory_order_acquire) && full_->empty())
+                break;
+            backoff(idle);
+            continue;
+        }
+        idle = 0;
 
-    // Write frame data
-    if (frame_len > 0 && frame_data != nullptr) {
-        file_.write(reinterpret_cast<const char*>(frame_data), frame_len);
+        Block& block = blocks_[index];
+        if (!failed_.load(std::memory_order_relaxed) && !write_block(block)) {
+            write_errors_.store(write_errors_.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+            failed_.store(true, std::memory_order_relaxed);
+        }
+        free_->try_push(index);
     }
 
-    if (!file_.good())
+    if (!failed_.load(std::memory_order_relaxed) && !write_index()) {
+        write_errors_.store(write_errors_.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        failed_.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool FrameRecorder::write_block(Block& block) {
+    ChunkHeader& h = block.header;
+    h.magic = CHUNK_MAGIC;
+    h.codec = static_cast<uint16_t>(Codec::NONE);
+    h.raw_bytes = static_cast<uint32_t>(block.used - sizeof(ChunkHeader));
+    h.stored_bytes = h.raw_bytes;
+
+    // Compress into the scratch block; keep it only if it is smaller
+    char* out = block.data.get();
+    if (codec_ != Codec::NONE) {
+        std::size_t n = compress_block(
+            codec_, reinterpret_cast<const uint8_t*>(out + sizeof(ChunkHeader)), h.raw_bytes,
+            reinterpret_cast<uint8_t*>(scratch_.get() + sizeof(ChunkHeader)),
+            h.raw_bytes > 0 ? h.raw_bytes - 1 : 0, codec_level_);
+        if (n > 0) {
+            out = scratch_.get();
+            h.codec = static_cast<uint16_t>(codec_);
+            h.stored_bytes = static_cast<uint32_t>(n);
+        }
+    }
+
+    // Both buffers are a multiple of IO_ALIGN, so the padding always fits
+    std::size_t used = sizeof(ChunkHeader) + h.stored_bytes;
+    std::size_t disk = align_up(used, align_);
+    std::memset(out + used, 0, disk - used);
+    h.disk_bytes = static_cast<uint32_t>(disk);
+    std::memcpy(out, &h, sizeof(h));
+
+    if (!write_all(out, disk))
         return false;
+    index_.push_back(ChunkIndexEntry{offset_, h});
+    offset_ += disk;
+    blocks_written_.store(blocks_written_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    raw_bytes_.store(raw_bytes_.load(std::memory_order_relaxed) + h.raw_bytes,
+                     std::memory_order_relaxed);
+    stored_bytes_.store(stored_bytes_.load(std::memory_order_relaxed) + h.stored_bytes,
+                        std::memory_order_relaxed);
+    return true;
+}
+
+bool FrameRecorder::write_index() {
+    // The index and trailer are unaligned
+    if (direct_)
+        set_direct(false);
+    RecordingTrailer t{offset_, static_cast<uint32_t>(index_.size()), TRAILER_MAGIC};
+    return write_all(index_.data(), index_.size() * sizeof(ChunkIndexEntry)) &&
+           write_all(&t, sizeof(t));
+}
 
-    ++frame_count_;
+bool FrameRecorder::write_all(const void* data, std::size_t len) {
+    auto* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::write(fd_, p, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        len -= static_cast<std::size_t>(n);
+    }
     return true;
 }
 
 void FrameRecorder::close() {
-    if (file_.is_open()) {
-        file_.close();
-    }
+    if (fd_ < 0)
+        return;
+    if (cur_ && cur_->header.frame_count > 0)
+        submit_block();
+    cur_ = nullptr;
+    stopping_.store(true, std::memory_order_release);
+    writer_.join();
+    ::close(fd_);
+    fd_ = -1;
 }
 
 } // namespace nng
@@ -1,33 +1,136 @@
 #pragma once
-#include <string>
-#include <fstream>
+#include "gateway/frame_pool.h"
+#include "gateway/recording_format.h"
+#include "common/spsc_ring.h"
+#include "common/thread_placement.h"
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace nng {
 
+struct RecorderOptions {
+    // One block is one chunk of the file. Rounded up to a multiple of 4096,
+    // and to at least MIN_BLOCK_BYTES so any datagram fits.
+    std::size_t block_bytes = 1024 * 1024;
+    std::size_t block_count = 16;          // blocks in flight between record() and the writer
+    bool        direct_io = false;         // O_DIRECT; buffered where the filesystem refuses it
+    uint64_t    preallocate_bytes = 0;     // fallocate this much up front (size unchanged)
+    bool        drop_when_full = false;    // drop frames instead of waiting for a free block
+    Codec       codec = Codec::NONE;       // chunk compression, run on the writer thread
+    int         codec_level = 1;           // ZSTD level
+    ThreadPlacement placement;             // the writer thread runs as ThreadRole::WRITER
+};
+
+// Writes the chunked recording format (recording_format.h), which
+// RecordingReader and ReplayFrameSource read.
+//
+// record() only copies the frame into the current block of a ring of
+// large aligned blocks, keeping the chunk's frame count, timestamp range
+// and source bitmap as it goes. A writer thread started by open() writes
+// each filled block as one chunk with a single write(), notes it for the
+// index and hands the block back, so the caller never touches the file.
+// With a codec set, the writer compresses each chunk first; chunks that do
+// not shrink are stored raw. If the writer falls behind and every block is full,
+// record() waits for one (counted in stalls()), or with drop_when_full
+// drops the frame (counted in dropped_frames()). close() writes out the
+// partial block and the index, and joins the writer.
+//
+// One thread may record at a time (callers serialize concurrent writers);
+// the counters may be read from any thread.
 class FrameRecorder {
 public:
+    static constexpr std::size_t MIN_BLOCK_BYTES = 128 * 1024;
+
     FrameRecorder() = default;
     ~FrameRecorder();
 
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
     // Open file for writing
-    bool open(const std::string& path);
+    bool open(const std::string& path, const RecorderOptions& options = {});
 
-    // Record one frame with its receive timestamp
+    // Record one frame with its receive timestamp. Fails for frames larger
+    // than a chunk (counted as dropped).
     bool record(uint64_t rx_timestamp_ns,
                 const uint8_t* frame_data, std::size_t frame_len);
+    bool record(uint64_t rx_timestamp_ns, const FrameView& frame) {
+        return record(rx_timestamp_ns, frame.data, frame.len);
+    }
 
-    // Close file
+    // Write out everything recorded and close the file
     void close();
 
     // How many frames recorded so far
-    uint64_t frame_count() const { return frame_count_; }
+    uint64_t frame_count() const { return frame_count_.load(std::memory_order_relaxed); }
+    // Frames dropped because every block was waiting to be written, or
+    // too large for a chunk
+    uint64_t dropped_frames() const { return dropped_.load(std::memory_order_relaxed); }
+    // Times record() had to wait for the writer
+    uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+    uint64_t blocks_written() const { return blocks_written_.load(std::memory_order_relaxed); }
+    // Chunk payload bytes before and after compression
+    uint64_t raw_bytes() const { return raw_bytes_.load(std::memory_order_relaxed); }
+    uint64_t stored_bytes() const { return stored_bytes_.load(std::memory_order_relaxed); }
+    // Failed writes; after one, record() returns false
+    uint64_t write_errors() const { return write_errors_.load(std::memory_order_relaxed); }
+    bool direct_io() const { return direct_; }
 
-    bool is_open() const { return file_.is_open(); }
+    bool is_open() const { return fd_ >= 0; }
 
 private:
-    std::ofstream file_;
-    uint64_t frame_count_ = 0;
+    struct FreeDeleter {
+        void operator()(char* p) const;
+    };
+    struct Block {
+        std::unique_ptr<char, FreeDeleter> data;
+        std::size_t used = 0; // bytes filled, chunk header space included
+        ChunkHeader header{};
+    };
+
+    bool acquire_block();
+    void submit_block();
+    bool write_block(Block& block);
+    bool write_all(const void* data, std::size_t len);
+    bool write_index();
+    void set_direct(bool on);
+    void writer_loop();
+    void count_drop();
+
+    int fd_ = -1;
+    bool direct_ = false;
+    std::size_t align_ = 8; // chunks are padded to this (4096 with O_DIRECT)
+    Codec codec_ = Codec::NONE;
+    int codec_level_ = 1;
+    std::unique_ptr<char, FreeDeleter> scratch_; // writer: compressed chunk
+    bool drop_when_full_ = false;
+    std::size_t block_bytes_ = 0;
+    ThreadPlacement placement_;
+    std::vector<Block> blocks_;
+    std::unique_ptr<SpscRing<uint32_t>> free_; // writer -> record()
+    std::unique_ptr<SpscRing<uint32_t>> full_; // record() -> writer
+    Block* cur_ = nullptr;   // block being filled
+    uint32_t cur_index_ = 0;
+    uint64_t next_frame_ = 0;
+    std::thread writer_;
+    // Writer thread only
+    uint64_t offset_ = 0;
+    std::vector<ChunkIndexEntry> index_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> failed_{false};
+
+    std::atomic<uint64_t> frame_count_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> blocks_written_{0};
+    std::atomic<uint64_t> write_errors_{0};
+    std::atomic<uint64_t> raw_bytes_{0};
+    std::atomic<uint64_t> stored_bytes_{0};
 };
 
 } // namespace nng
@@ -1,6 +1,10 @@
 #pragma once
+#include "gateway/frame_pool.h"
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <cstdint>
+#include <cstddef>
 
 namespace nng {
 
@@ -10,6 +14,24 @@ public:
 
     // Receive one frame into buf. Returns true if a frame was received.
     virtual bool receive(std::vector<uint8_t>& buf) = 0;
+
+    // Fill batch (cleared first) with up to batch.capacity() frames, written
+    // in place into the batch's slots. Returns the number of frames received
+    // (0 on timeout / no data). Default: one receive() copied into slot 0;
+    // sources that can batch or fill slots directly override this.
+    virtual std::size_t receive_batch(FrameBatch& batch) {
+        batch.clear();
+        if (!receive(scratch_))
+            return 0;
+        std::size_t len = std::min(scratch_.size(), FramePool::SLOT_SIZE);
+        if (len > 0)
+            std::memcpy(batch.next_slot(), scratch_.data(), len);
+        batch.commit(len);
+        return 1;
+    }
+
+private:
+    std::vector<uint8_t> scratch_;
 };
 
 class IFrameSink {
@@ -18,6 +40,32 @@ public:
 
     // Send one frame. Returns true on success.
     virtual bool send(const std::vector<uint8_t>& buf) = 0;
+
+    // Send count frames in order. Returns how many were sent. Default: one
+    // send() per frame, stopping at the first failure; sinks that can hand
+    // several frames to the kernel at once override this, and datagram
+    // sinks may skip a frame that fails and go on with the rest.
+    virtual std::size_t send_batch(const FrameView* frames, std::size_t count) {
+        std::size_t sent = 0;
+        for (; sent < count; ++sent) {
+            scratch_.assign(frames[sent].data, frames[sent].data + frames[sent].len);
+            if (!send(scratch_))
+                break;
+        }
+        return sent;
+    }
+
+    // Convenience overload for owned frames (e.g. a simulator tick)
+    std::size_t send_batch(const std::vector<std::vector<uint8_t>>& frames) {
+        views_.clear();
+        for (const auto& f : frames)
+            views_.push_back(FrameView{f.data(), f.size()});
+        return send_batch(views_.data(), views_.size());
+    }
+
+private:
+    std::vector<uint8_t> scratch_;
+    std::vector<FrameView> views_;
 };
 
 } // namespace nng
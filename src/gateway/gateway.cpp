@@ -1,274 +1,1209 @@
 #include "gateway/gateway.h"
 #include "gateway/udp_socket.h"
+#include "gateway/io_uring_source.h"
+#include "gateway/packet_ring_source.h"
+#include "gateway/shm_ring.h"
 #include "replay/replay_engine.h"
+#include "common/alloc_tracker.h"
 #include <chrono>
-#include <sstream>
-#include <iomanip>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 
 namespace nng {
+namespace {
+
+// Same clock as kernel socket timestamps (SO_TIMESTAMPNS)
+uint64_t realtime_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// CPU time the calling thread has used
+uint64_t thread_cpu_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Wait strategy for a stage whose queue is empty (or full): spin briefly,
+// then yield, then sleep so an idle pipeline does not burn its cores
+void backoff(unsigned& idle) {
+    ++idle;
+    if (idle < 64)
+        return;
+    if (idle < 256)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+// Hand a batch to a queue sized for the whole pool. The push is retried
+// rather than dropped: a lost batch would shrink the pool for good.
+template <typename Queue, typename T>
+void push_owned(Queue& q, const T& item) {
+    unsigned full = 0;
+    while (!q.try_push(item))
+        backoff(full);
+}
+
+} // anonymous namespace
 
 Gateway::Gateway(const GatewayConfig& config)
-    : config_(config) {
+    : config_(config),
+      tracks_(config.track_capacity, config.track_ttl_ms * 1000000ULL,
+              config.timer_tick_ms * 1000000ULL),
+      forward_(config.forward),
+      coalescer_(config.event_window_ms * 1000000ULL, config.event_burst),
+      monitor_(config.overload) {
     Logger::instance().set_level(config_.log_level);
+    runtime_.set_crc(config_.crc_enabled);
+    runtime_.set_event_level(config_.event_level);
+    runtime_.set_plot_sample(config_.plot_sample);
+    profiler_.set_enabled(config_.profile);
+    std::string error;
+    if (!runtime_.filter().set(config_.ingress_filter, &error)) {
+        Logger::instance().log(Severity::WARN, EventCategory::CONTROL, "EVT_CONFIG_CHANGE",
+            "Invalid ingress filter '" + config_.ingress_filter + "' (" + error +
+            "), accepting all frames");
+    }
+    if (!forward_.filter().set(config_.forward.filter, &error)) {
+        Logger::instance().log(Severity::WARN, EventCategory::CONTROL, "EVT_CONFIG_CHANGE",
+            "Invalid forward filter '" + config_.forward.filter + "' (" + error +
+            "), forwarding all frames");
+    }
 }
 
 Gateway::~Gateway() {
     stop();
 }
 
-void Gateway::run() {
-    if (running_.load())
-        return;
+bool Gateway::open_sources() {
+    workers_.clear();
 
-    // Create frame source
     if (!config_.replay_path.empty()) {
-        // Replay mode
+        // Replay mode (always a single worker)
         auto replay = std::make_unique<ReplayFrameSource>();
         if (!replay->open(config_.replay_path)) {
             Logger::instance().log(Severity::ERROR, EventCategory::NETWORK,
                 "EVT_SOURCE_TIMEOUT", "Failed to open replay file: " + config_.replay_path);
-            return;
+            return false;
         }
         replay->set_speed(0.0); // As fast as possible for processing
-        source_ = std::move(replay);
-    } else {
-        // UDP mode
-        auto udp = std::make_unique<UdpFrameSource>();
-        if (!udp->bind(config_.udp_port)) {
-            Logger::instance().log(Severity::ERROR, EventCategory::NETWORK,
-                "EVT_SOURCE_TIMEOUT", "Failed to bind UDP port " + std::to_string(config_.udp_port));
-            return;
+        auto worker = std::make_unique<IngestWorker>(config_.reorder_window);
+        worker->source = std::move(replay);
+        stats_.set_writer_shards(1);
+        worker->stats = &stats_.shard(0);
+        workers_.push_back(std::move(worker));
+        return true;
+    }
+
+    std::size_t count = config_.ingest_workers > 0 ? config_.ingest_workers : 1;
+    stats_.set_writer_shards(count);
+    if (config_.source_factory) {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto worker = std::make_unique<IngestWorker>(config_.reorder_window);
+            worker->source = config_.source_factory(i);
+            if (!worker->source) {
+                workers_.clear();
+                return false;
+            }
+            worker->stats = &stats_.shard(i);
+            workers_.push_back(std::move(worker));
         }
-        udp->set_timeout_ms(100);
-        source_ = std::move(udp);
+        return true;
     }
 
+    // UDP mode: one socket per worker, sharing the port via SO_REUSEPORT
+    // (or one shared-memory ring per worker)
+    bool reuse_port = count > 1;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto worker = std::make_unique<IngestWorker>(config_.reorder_window);
+
+        if (config_.rx_backend == RxBackend::SHM) {
+            // No socket to fall back to: senders are looking for this ring
+            std::string name = count > 1 ? config_.shm_name + "." + std::to_string(i)
+                                         : config_.shm_name;
+            auto shm = std::make_unique<ShmFrameSource>();
+            if (!shm->open(name, config_.shm_slots)) {
+                Logger::instance().log(Severity::ERROR, EventCategory::NETWORK,
+                    "EVT_SOURCE_TIMEOUT", "Failed to create shared-memory ring " + name);
+                workers_.clear();
+                return false;
+            }
+            shm->set_timeout_ms(100);
+            worker->source = std::move(shm);
+        } else if (config_.rx_backend == RxBackend::IO_URING) {
+            auto uring = std::make_unique<IoUringFrameSource>();
+            if (uring->bind(config_.udp_port, reuse_port)) {
+                uring->set_timeout_ms(100);
+                worker->source = std::move(uring);
+            } else if (i == 0) {
+                Logger::instance().log(Severity::WARN, EventCategory::NETWORK,
+                    "EVT_CONFIG_CHANGE", "io_uring unavailable, falling back to socket receive");
+            }
+        } else if (config_.rx_backend == RxBackend::PACKET_RING) {
+            auto ring = std::make_unique<PacketRingFrameSource>();
+            if (ring->bind(config_.capture_interface, config_.udp_port, reuse_port)) {
+                ring->set_timeout_ms(100);
+                worker->source = std::move(ring);
+            } else if (i == 0) {
+                Logger::instance().log(Severity::WARN, EventCategory::NETWORK,
+                    "EVT_CONFIG_CHANGE", "Packet ring capture on " + config_.capture_interface +
+                    " unavailable, falling back to socket receive");
+            }
+        }
+
+        if (!worker->source) {
+            auto udp = std::make_unique<UdpFrameSource>();
+            if (!udp->bind(config_.udp_port, reuse_port)) {
+                Logger::instance().log(Severity::ERROR, EventCategory::NETWORK,
+                    "EVT_SOURCE_TIMEOUT", "Failed to bind UDP port " + std::to_string(config_.udp_port));
+                workers_.clear();
+                return false;
+            }
+            udp->set_timeout_ms(100);
+            udp->set_busy_poll_us(config_.busy_poll_us);
+            worker->source = std::move(udp);
+        }
+
+        worker->stats = &stats_.shard(i);
+        workers_.push_back(std::move(worker));
+    }
+    return true;
+}
+
+void Gateway::init_worker_state() {
+    if (config_.track_capacity > 0)
+        tracks_.set_writers(workers_.size());
+    bool forward = false;
+    if (forward_.enabled()) {
+        std::string target;
+        forward = forward_.set_writers(workers_.size(), &target);
+        if (!forward) {
+            Logger::instance().log(Severity::ERROR, EventCategory::NETWORK, "EVT_CONFIG_CHANGE",
+                "Cannot forward to '" + target + "', forwarding disabled");
+        }
+    }
+    if (config_.association.enabled) {
+        std::lock_guard<std::mutex> lock(associators_mutex_);
+        while (associators_.size() < workers_.size())
+            associators_.push_back(std::make_unique<PlotAssociator>(config_.association));
+    }
+    uint64_t now = realtime_ns();
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+        IngestWorker& w = *workers_[i];
+        // Its shard's records may still hold a previous run's tracker state
+        w.stats->reset_writer_state();
+        if (config_.track_capacity > 0) {
+            w.tracks = &tracks_.table(i);
+            // A record is at least 2 bytes: decoding never grows it
+            w.decoded.reserve(MAX_PAYLOAD_SIZE / 2);
+        }
+        if (config_.source_timeout_ms > 0)
+            w.source_timers = std::make_unique<TimerWheel>(
+                std::size_t{65536}, config_.timer_tick_ms * 1000000ULL, now);
+        if (forward)
+            w.forwarder = &forward_.forwarder(i);
+        if (config_.association.enabled)
+            w.associator = associators_[i].get();
+        // Grows only for batches of containers or delta frames, then stays
+        if (config_.priority_lanes && !config_.pipelined)
+            w.bulk.reserve(config_.rx_batch_size * 2);
+    }
+}
+
+template <typename Emit>
+void Gateway::expire_timers(IngestWorker& worker, uint64_t now_ns, Emit&& emit) {
+    if (worker.source_timers) {
+        worker.fired.clear();
+        worker.source_timers->advance(now_ns, worker.fired);
+        const uint64_t timeout_ns = config_.source_timeout_ms * 1000000ULL;
+        for (uint32_t src_id : worker.fired) {
+            // Frames since it was armed pushed the deadline back
+            SourceRecord& source = worker.stats->resolve(static_cast<uint16_t>(src_id));
+            if (source.last_frame_ns + timeout_ns > now_ns) {
+                worker.source_timers->arm(src_id, source.last_frame_ns + timeout_ns);
+                continue;
+            }
+            source.timer_armed = false;
+            FrameOutcome out;
+            out.expiry = TimerExpiry::SOURCE_TIMEOUT;
+            out.header.src_id = static_cast<uint16_t>(src_id);
+            out.lane = classify_lane(out);
+            emit(out);
+        }
+    }
+    if (worker.associator)
+        worker.associator->expire(now_ns);
+    if (worker.tracks) {
+        worker.lost.clear();
+        worker.tracks->expire(now_ns, worker.lost);
+        for (const TrackRecord& r : worker.lost) {
+            if (worker.associator)
+                worker.associator->remove(r.src_id, r.track.track_id);
+            FrameOutcome out;
+            out.expiry = TimerExpiry::TRACK_LOST;
+            out.header.src_id = r.src_id;
+            out.payload_len = sizeof(TrackPayload);
+            std::memcpy(out.payload, &r.track, sizeof(TrackPayload));
+            out.lane = classify_lane(out);
+            emit(out);
+        }
+    }
+}
+
+template <typename Emit>
+void Gateway::emit_decoded(IngestWorker& worker, const FrameOutcome& out, Emit&& emit) {
+    if (worker.decoded.empty() || !want_event(EventCategory::TRACKING, Severity::DEBUG))
+        return;
+    FrameOutcome track;
+    track.header = out.header;
+    track.header.msg_type = static_cast<uint8_t>(MsgType::TRACK);
+    track.header.payload_len = sizeof(TrackPayload);
+    track.payload_len = sizeof(TrackPayload);
+    for (const TrackPayload& t : worker.decoded) {
+        std::memcpy(track.payload, &t, sizeof(TrackPayload));
+        track.lane = classify_lane(track);
+        emit(track);
+    }
+}
+
+void Gateway::run() {
+    if (running_.load())
+        return;
+
+    if (!open_sources())
+        return;
+    init_worker_state();
+
     // Open recorder if enabled
     if (config_.record_enabled) {
-        if (!recorder_.open(config_.record_path)) {
+        RecorderOptions options = config_.record_options;
+        options.placement = config_.placement;
+        if (!recorder_.open(config_.record_path, options)) {
             Logger::instance().log(Severity::WARN, EventCategory::NETWORK,
                 "EVT_CONFIG_CHANGE", "Failed to open record file: " + config_.record_path);
         }
     }
+    runtime_.set_recorder_open(recorder_.is_open());
+
+    monitor_ = OverloadMonitor(config_.overload);
+    monitor_active_ = config_.overload.enabled && config_.replay_path.empty();
+    runtime_.set_overload_detected(false);
+    load_period_start_ns_ = steady_ns();
+    load_batches_ = 0;
+    load_full_batches_ = 0;
 
     running_.store(true);
+
+    if (Logger::instance().enabled(Severity::INFO, EventCategory::CONTROL)) {
+        Logger::instance().log(Severity::INFO, EventCategory::CONTROL,
+            "EVT_CONFIG_CHANGE", "Gateway started on port " + std::to_string(config_.udp_port) +
+            " workers=" + std::to_string(workers_.size()) +
+            (config_.pipelined ? " pipelined" : "") +
+            (config_.placement.empty() ? "" : " cpus=" + config_.placement.spec()));
+    }
+
+    if (config_.pipelined) {
+        run_pipelined();
+    } else if (workers_.size() == 1) {
+        ingest_loop(*workers_[0]);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(workers_.size());
+        for (auto& w : workers_)
+            threads.emplace_back(&Gateway::ingest_loop, this, std::ref(*w));
+
+        for (auto& t : threads)
+            t.join();
+    }
+
+    // Summaries still collecting when the gateway stopped
+    flush_coalesced(true);
+
+    // Close recorder
+    if (recorder_.is_open()) {
+        runtime_.set_recorder_open(false);
+        recorder_.close();
+    }
+    runtime_.set_overload_detected(false);
+
+    workers_.clear();
+    // Cleared here rather than on entry, so a stop() that lands while the
+    // sources are still being opened is not lost
     should_stop_.store(false);
+    running_.store(false);
 
     Logger::instance().log(Severity::INFO, EventCategory::CONTROL,
-        "EVT_CONFIG_CHANGE", "Gateway started on port " + std::to_string(config_.udp_port));
+        "EVT_CONFIG_CHANGE", "Gateway stopped");
+}
 
-    std::vector<uint8_t> buf;
+bool Gateway::replay_finished(IngestWorker& worker) const {
+    if (config_.replay_path.empty())
+        return false;
+    auto* replay = dynamic_cast<ReplayFrameSource*>(worker.source.get());
+    return replay && replay->is_done();
+}
+
+bool Gateway::place_thread(ThreadRole role, std::size_t index) {
+    if (config_.placement.role(role).empty())
+        return false;
+    if (config_.placement.pin(role, index))
+        return true;
+    Logger::instance().log(Severity::WARN, EventCategory::CONTROL, "EVT_CONFIG_CHANGE",
+        std::string("Cannot pin ") + thread_role_name(role) + " thread " +
+        std::to_string(index) + " to cpus " + format_cpu_list(config_.placement.role(role)));
+    return false;
+}
+
+void Gateway::place_worker_memory(IngestWorker& worker, FrameBatch* batch) {
+    if (!config_.placement.numa_local)
+        return;
+    if (batch)
+        place_on_local_node(batch->slot(0), batch->capacity() * FramePool::SLOT_SIZE);
+    if (worker.stats)
+        place_on_local_node(worker.stats, sizeof(StatsShard));
+    if (worker.tracks)
+        place_on_local_node(worker.tracks->data(), worker.tracks->data_bytes());
+}
+
+void Gateway::ingest_loop(IngestWorker& worker) {
+    const std::size_t index = worker_index(worker);
+    const std::string thread_name = "ingest" + std::to_string(index);
+    NNG_PROFILE_THREAD(profiler_, thread_name);
+    AllocTracker::name_thread(thread_name.c_str(), true);
+    const bool pinned = place_thread(ThreadRole::INGEST, index);
+    // Frame slots live for the whole loop: no per-frame allocation or copy
+    FrameBatch batch(config_.rx_batch_size);
+    if (pinned)
+        place_worker_memory(worker, &batch);
+    const bool sampler = monitor_active_ && &worker == workers_[0].get();
+    if (sampler)
+        load_cpu_start_ns_ = thread_cpu_ns();
     while (!should_stop_.load()) {
-        if (!source_->receive(buf)) {
-            // Check if replay is done
-            if (!config_.replay_path.empty()) {
-                auto* replay = dynamic_cast<ReplayFrameSource*>(source_.get());
-                if (replay && replay->is_done()) {
-                    break;
-                }
+        std::size_t n = receive(worker, batch);
+        flush_coalesced();
+        expire_timers(worker, realtime_ns(), [this](const FrameOutcome& out) { dispatch_outcome(out); });
+        if (sampler) {
+            // A batch that comes back full means more was waiting
+            ++load_batches_;
+            if (n == batch.capacity())
+                ++load_full_batches_;
+            uint64_t now = steady_ns();
+            if (now - load_period_start_ns_ >= config_.overload.interval_ms * 1000000ULL) {
+                sample_load(now, static_cast<double>(load_full_batches_) /
+                                 static_cast<double>(load_batches_));
+                load_batches_ = 0;
+                load_full_batches_ = 0;
             }
+        }
+        if (n == 0) {
+            if (replay_finished(worker))
+                break;
             continue;
         }
 
-        auto now = std::chrono::steady_clock::now();
-        uint64_t rx_timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-            now.time_since_epoch()).count();
+        // One dequeue timestamp per batch: all frames left the kernel together
+        uint64_t dequeue_ns = realtime_ns();
 
-        process_frame(buf, rx_timestamp_ns);
+        // Datagrams are recorded as received (v2 containers stay packed)
+        record_batch(batch, dequeue_ns);
+
+        const ParsedFrameBatch& parsed = worker.parsed;
+        parse(worker, batch);
+        if (parsed.filtered_count > 0)
+            worker.stats->record_filtered(parsed.filtered_count);
+        // Priority outcomes go out as validated, bulk ones after the batch
+        auto dispatch = [this, &worker](const FrameOutcome& out) {
+            if (!config_.priority_lanes || out.lane == Lane::PRIORITY)
+                dispatch_outcome(out);
+            else
+                worker.bulk.push_back(out);
+        };
+        for (std::size_t i = 0; i < parsed.count; ++i) {
+            FrameOutcome out;
+            validate_frame(worker, batch[parsed.sources[i]], i, dequeue_ns, out);
+            dispatch(out);
+            emit_decoded(worker, out, dispatch);
+        }
+        if (worker.forwarder)
+            worker.forwarder->flush();
+        for (const FrameOutcome& out : worker.bulk)
+            dispatch_outcome(out);
+        worker.bulk.clear();
     }
+}
 
-    // Close recorder
-    if (config_.record_enabled) {
-        recorder_.close();
+std::size_t Gateway::worker_index(const IngestWorker& worker) const {
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i].get() == &worker)
+            return i;
     }
+    return 0;
+}
 
-    running_.store(false);
+std::size_t Gateway::receive(IngestWorker& worker, FrameBatch& batch) {
+#if NNG_PROFILE
+    ThreadProfile* profile = StageProfiler::current();
+    if (profile && profile->enabled()) {
+        // Only receives that returned frames count: idle waits are not work
+        uint64_t start = StageProfiler::now_ticks();
+        std::size_t n = worker.source->receive_batch(batch);
+        if (n > 0)
+            profile->record(ProfileStage::RECEIVE, StageProfiler::now_ticks() - start);
+        return n;
+    }
+#endif
+    return worker.source->receive_batch(batch);
+}
 
-    Logger::instance().log(Severity::INFO, EventCategory::CONTROL,
-        "EVT_CONFIG_CHANGE", "Gateway stopped");
+void Gateway::parse(IngestWorker& worker, const FrameBatch& batch) {
+    NNG_PROFILE_SCOPE(PARSE);
+    parse_frames(batch.views(), batch.size(), runtime_.crc(), worker.parsed, &runtime_.filter());
+}
+
+void Gateway::record_batch(const FrameBatch& batch, uint64_t dequeue_ns) {
+    if (!runtime_.recording() || !recorder_.is_open())
+        return;
+    NNG_PROFILE_SCOPE(RECORD);
+    for (std::size_t i = 0; i < batch.size(); ++i)
+        record_frame(batch[i], dequeue_ns);
 }
 
 void Gateway::stop() {
     should_stop_.store(true);
 }
 
-void Gateway::process_frame(const std::vector<uint8_t>& frame, uint64_t rx_timestamp_ns) {
-    // Record if enabled
-    if (config_.record_enabled && recorder_.is_open()) {
-        recorder_.record(rx_timestamp_ns, frame.data(), frame.size());
+AssociationStats Gateway::association_stats() const {
+    AssociationStats s;
+    std::lock_guard<std::mutex> lock(associators_mutex_);
+    for (const auto& a : associators_)
+        s.merge(a->stats());
+    return s;
+}
+
+PipelineStats Gateway::pipeline_stats() const {
+    PipelineStats s;
+    s.rx = rx_meter_.snapshot();
+    s.record = record_meter_.snapshot();
+    s.dispatch = dispatch_meter_.snapshot();
+    s.priority = priority_meter_.snapshot();
+    return s;
+}
+
+void Gateway::record_frame(const FrameView& frame, uint64_t dequeue_ns) {
+    if (!runtime_.recording() || !recorder_.is_open())
+        return;
+
+    // Prefer the kernel receive time; sources without one (replay) use dequeue
+    uint64_t rx_timestamp_ns = frame.rx_ts_ns ? frame.rx_ts_ns : dequeue_ns;
+
+    // Pipelined recording has a single writer thread
+    if (workers_.size() > 1 && !config_.pipelined) {
+        std::lock_guard<std::mutex> lock(recorder_mutex_);
+        recorder_.record(rx_timestamp_ns, frame);
+    } else {
+        recorder_.record(rx_timestamp_ns, frame);
     }
+}
 
-    // Parse frame
-    ParsedFrame parsed;
-    auto err = parse_frame(frame.data(), frame.size(), config_.crc_enabled, parsed);
+void Gateway::validate_frame(IngestWorker& worker, const FrameView& datagram, std::size_t i,
+                             uint64_t dequeue_ns, FrameOutcome& out) {
+    StatsShard& stats = *worker.stats;
+    uint64_t rx_timestamp_ns = datagram.rx_ts_ns ? datagram.rx_ts_ns : dequeue_ns;
 
-    if (err != ParseError::OK) {
-        stats_.record_malformed(0);
+    out.error = worker.parsed.errors[i];
+    out.frame_len = worker.parsed.frame_lens[i];
 
-        std::string error_str;
-        switch (err) {
-            case ParseError::TOO_SHORT:      error_str = "TOO_SHORT"; break;
-            case ParseError::BAD_VERSION:    error_str = "BAD_VERSION"; break;
-            case ParseError::BAD_MSG_TYPE:   error_str = "BAD_MSG_TYPE"; break;
-            case ParseError::PAYLOAD_TOO_LONG: error_str = "PAYLOAD_TOO_LONG"; break;
-            case ParseError::TRUNCATED:      error_str = "TRUNCATED"; break;
-            case ParseError::CRC_MISMATCH:   error_str = "CRC_MISMATCH"; break;
-            default:                         error_str = "UNKNOWN"; break;
+    if (out.error != ParseError::OK) {
+        stats.record_malformed(0);
+        if (out.error == ParseError::CRC_MISMATCH)
+            stats.record_crc_fail(0);
+        return;
+    }
+
+    // The source's record, looked up once for the tracker, stats and timer
+    const TelemetryHeader& header = worker.parsed.headers[i];
+    out.header = header;
+    SourceRecord& source = stats.resolve(header.src_id);
+    {
+        NNG_PROFILE_SCOPE(TRACK);
+        if (!source.window)
+            source.window = worker.tracker.window(header.src_id);
+        out.seq = worker.tracker.track(source.seq, source.window, header.src_id, header.seq);
+    }
+
+    // Keep the bytes the event formatters read
+    out.payload_len = static_cast<uint16_t>(
+        std::min<std::size_t>(header.payload_len, MAX_EVENT_PAYLOAD));
+    if (out.payload_len > 0)
+        std::memcpy(out.payload, worker.parsed.payload_ptrs[i], out.payload_len);
+    out.lane = classify_lane(out);
+
+    // Record stats
+    NNG_PROFILE_SCOPE(STATS);
+    stats.record_rx(source, header.seq, rx_timestamp_ns, header.ts_ns);
+
+    switch (out.seq.result) {
+        case SeqResult::GAP:
+            stats.record_gap(source, out.seq.gap_size);
+            break;
+        case SeqResult::REORDER:
+            stats.record_reorder(source);
+            break;
+        case SeqResult::DUPLICATE:
+            stats.record_duplicate(source);
+            break;
+        default:
+            break;
+    }
+
+    if (datagram.rx_ts_ns)
+        stats.record_latency(header.ts_ns, datagram.rx_ts_ns, dequeue_ns, realtime_ns());
+
+    // Timers run on the gateway's clock: dequeue time, also in replay. A
+    // frame only moves the record's last_frame_ns; the wheel is touched
+    // when the timer is not armed, and re-armed from there when it fires.
+    if (worker.source_timers) {
+        source.last_frame_ns = dequeue_ns;
+        if (!source.timer_armed) {
+            worker.source_timers->arm(header.src_id, dequeue_ns + config_.source_timeout_ms * 1000000ULL);
+            source.timer_armed = true;
+        }
+    }
+
+    // Downstream consumers get each frame once
+    if (worker.forwarder && out.seq.result != SeqResult::DUPLICATE)
+        worker.forwarder->add(header, worker.parsed.payload_ptrs[i]);
+
+    // Late frames (reorders, duplicates) carry an older position: skip them
+    worker.decoded.clear();
+    if ((worker.tracks || worker.associator) && out.seq.result != SeqResult::REORDER &&
+        out.seq.result != SeqResult::DUPLICATE) {
+        if (header.msg_type == static_cast<uint8_t>(MsgType::TRACK) &&
+            header.payload_len >= sizeof(TrackPayload)) {
+            TrackPayload track = deserialize_payload<TrackPayload>(worker.parsed.payload_ptrs[i]);
+            if (worker.tracks)
+                worker.tracks->update(header.src_id, track, dequeue_ns);
+            if (worker.associator)
+                worker.associator->update(header.src_id, track, dequeue_ns);
+        } else if (worker.tracks && header.msg_type == static_cast<uint8_t>(MsgType::TRACK_DELTA)) {
+            decode_track_deltas(worker, header.src_id, worker.parsed.payload_ptrs[i],
+                                header.payload_len, dequeue_ns);
         }
+    }
 
-        if (err == ParseError::CRC_MISMATCH) {
-            stats_.record_crc_fail(0);
-            publish_event(EventId::EVT_CRC_FAIL, EventCategory::NETWORK,
-                Severity::WARN, "error=" + error_str);
+    // A late plot is still a measurement; a duplicate was associated already
+    if (worker.associator && header.msg_type == static_cast<uint8_t>(MsgType::PLOT) &&
+        header.payload_len >= PlotView::SIZE && out.seq.result != SeqResult::DUPLICATE) {
+        out.assoc = worker.associator->associate(header.src_id,
+                                                 PlotView(worker.parsed.payload_ptrs[i]), dequeue_ns);
+    }
+}
+
+void Gateway::decode_track_deltas(IngestWorker& worker, uint16_t src_id, const uint8_t* payload,
+                                  std::size_t len, uint64_t now_ns) {
+    TrackDelta delta;
+    TrackPayload track;
+    for (std::size_t at = 0; at < len;) {
+        // A malformed record ends the frame; the records before it stand
+        std::size_t n = read_track_delta(payload + at, len - at, delta);
+        if (n == 0)
+            break;
+        at += n;
+        if (worker.tracks->apply(src_id, delta, now_ns, track)) {
+            worker.decoded.push_back(track);
+            if (worker.associator)
+                worker.associator->update(src_id, track, now_ns);
+        }
+    }
+}
+
+void Gateway::dispatch_outcome(const FrameOutcome& out) {
+    NNG_PROFILE_SCOPE(DISPATCH);
+    if (out.expiry != TimerExpiry::NONE) {
+        publish_expiry(out);
+        return;
+    }
+    if (out.error != ParseError::OK) {
+        EventDetail detail;
+        detail.kind = EventDetail::Kind::FRAME_ERROR;
+        detail.frame_error.error = parse_error_str(out.error);
+        if (out.error == ParseError::CRC_MISMATCH) {
+            detail.frame_error.frame_len = 0; // rendered as "error=CRC_MISMATCH"
+            publish_fault(EventId::EVT_CRC_FAIL, detail, 1);
         } else {
-            publish_event(EventId::EVT_FRAME_MALFORMED, EventCategory::NETWORK,
-                Severity::WARN, "error=" + error_str + " len=" + std::to_string(frame.size()));
+            detail.frame_error.frame_len = static_cast<uint32_t>(out.frame_len);
+            publish_fault(EventId::EVT_FRAME_MALFORMED, detail, 1);
         }
         return;
     }
 
-    // Track sequence
-    auto seq_result = tracker_.track(parsed.header.src_id, parsed.header.seq);
-
-    // Record stats
-    stats_.record_rx(parsed.header.src_id, parsed.header.seq, rx_timestamp_ns);
+    const TelemetryHeader& header = out.header;
 
     // Handle sequence anomalies
-    switch (seq_result.result) {
-        case SeqResult::FIRST:
+    switch (out.seq.result) {
+        case SeqResult::FIRST: {
+            EventDetail detail;
+            detail.kind = EventDetail::Kind::SOURCE;
+            detail.src_id = header.src_id;
             publish_event(EventId::EVT_SOURCE_ONLINE, EventCategory::NETWORK,
-                Severity::INFO, "src_id=" + std::to_string(parsed.header.src_id));
+                Severity::INFO, detail);
             break;
+        }
 
         case SeqResult::GAP:
-            stats_.record_gap(parsed.header.src_id, seq_result.gap_size);
-            publish_event(EventId::EVT_SEQ_GAP, EventCategory::NETWORK,
-                Severity::WARN, "src_id=" + std::to_string(parsed.header.src_id) +
-                " expected=" + std::to_string(seq_result.expected_seq) +
-                " actual=" + std::to_string(seq_result.actual_seq) +
-                " gap=" + std::to_string(seq_result.gap_size));
-            break;
-
-        case SeqResult::REORDER:
-            stats_.record_reorder(parsed.header.src_id);
-            publish_event(EventId::EVT_SEQ_REORDER, EventCategory::NETWORK,
-                Severity::WARN, "src_id=" + std::to_string(parsed.header.src_id) +
-                " expected=" + std::to_string(seq_result.expected_seq) +
-                " actual=" + std::to_string(seq_result.actual_seq));
+        case SeqResult::REORDER: {
+            EventDetail detail;
+            detail.kind = EventDetail::Kind::SEQUENCE;
+            detail.src_id = header.src_id;
+            detail.seq.expected = out.seq.expected_seq;
+            detail.seq.actual = out.seq.actual_seq;
+            bool gap = out.seq.result == SeqResult::GAP;
+            detail.seq.gap = gap ? static_cast<uint32_t>(out.seq.gap_size) : 0;
+            publish_fault(gap ? EventId::EVT_SEQ_GAP : EventId::EVT_SEQ_REORDER,
+                          detail, gap ? detail.seq.gap : 1);
             break;
+        }
 
         case SeqResult::DUPLICATE:
-            stats_.record_duplicate(parsed.header.src_id);
-            break;
-
         case SeqResult::OK:
             // Normal frame, no special logging needed
             break;
     }
 
-    // Process by message type
-    MsgType msg_type = static_cast<MsgType>(parsed.header.msg_type);
-    switch (msg_type) {
-        case MsgType::TRACK: {
-            if (parsed.header.payload_len >= sizeof(TrackPayload)) {
-                TrackPayload track = deserialize_track(parsed.payload_ptr);
-                std::ostringstream detail;
-                detail << "src_id=" << parsed.header.src_id
-                       << " track_id=" << track.track_id
-                       << " class=" << static_cast<int>(track.classification)
-                       << " threat=" << static_cast<int>(track.threat_level);
-                publish_event(EventId::EVT_TRACK_UPDATE, EventCategory::TRACKING,
-                    Severity::DEBUG, detail.str());
+    // Process by message type: one table lookup, no switch
+    using MsgHandler = void (Gateway::*)(const FrameOutcome&);
+    static constexpr MsgHandler handlers[MSG_TYPE_MAX + 1] = {
+        nullptr,
+        &Gateway::dispatch_msg<MsgType::PLOT>,
+        &Gateway::dispatch_msg<MsgType::TRACK>,
+        &Gateway::dispatch_msg<MsgType::HEARTBEAT>,
+        &Gateway::dispatch_msg<MsgType::ENGAGEMENT>,
+        nullptr, // TRACK_DELTA: its tracks come as TRACK outcomes (emit_decoded)
+    };
+    static_assert(static_cast<uint8_t>(MsgType::PLOT) == 1 &&
+                  static_cast<uint8_t>(MsgType::TRACK) == 2 &&
+                  static_cast<uint8_t>(MsgType::HEARTBEAT) == 3 &&
+                  static_cast<uint8_t>(MsgType::ENGAGEMENT) == 4 &&
+                  static_cast<uint8_t>(MsgType::TRACK_DELTA) == 5,
+                  "handlers[] must follow MsgType values");
+
+    // parse_frame() already rejected msg_type outside [PLOT, MSG_TYPE_MAX]
+    if (header.msg_type <= MSG_TYPE_MAX && handlers[header.msg_type])
+        (this->*handlers[header.msg_type])(out);
+}
+
+void Gateway::publish_expiry(const FrameOutcome& out) {
+    EventDetail detail;
+    detail.src_id = out.header.src_id;
+    if (out.expiry == TimerExpiry::SOURCE_TIMEOUT) {
+        if (!want_event(EventCategory::NETWORK, Severity::WARN))
+            return;
+        detail.kind = EventDetail::Kind::SOURCE;
+        publish_event(EventId::EVT_SOURCE_TIMEOUT, EventCategory::NETWORK, Severity::WARN, detail);
+        return;
+    }
+    if (!want_event(EventCategory::TRACKING, Severity::INFO))
+        return;
+    TrackView track(out.payload);
+    detail.kind = EventDetail::Kind::TRACK;
+    detail.track.track_id = track.track_id();
+    detail.track.classification = track.classification();
+    detail.track.threat_level = track.threat_level();
+    publish_event(EventId::EVT_TRACK_LOST, EventCategory::TRACKING, Severity::INFO, detail);
+}
+
+template <MsgType T>
+void Gateway::dispatch_msg(const FrameOutcome& out) {
+    using View = typename MsgPayload<T>::view;
+    if (out.header.payload_len < View::SIZE)
+        return;
+    if constexpr (T == MsgType::PLOT)
+        on_payload(out.header, View(out.payload), out.assoc);
+    else
+        on_payload(out.header, View(out.payload));
+}
+
+void Gateway::on_payload(const TelemetryHeader& header, TrackView track) {
+    if (!want_event(EventCategory::TRACKING, Severity::DEBUG))
+        return;
+    EventDetail detail;
+    detail.kind = EventDetail::Kind::TRACK;
+    detail.src_id = header.src_id;
+    detail.track.track_id = track.track_id();
+    detail.track.classification = track.classification();
+    detail.track.threat_level = track.threat_level();
+    publish_event(EventId::EVT_TRACK_UPDATE, EventCategory::TRACKING,
+        Severity::DEBUG, detail);
+}
+
+void Gateway::on_payload(const TelemetryHeader& header, PlotView plot,
+                         const PlotAssociation& assoc) {
+    uint32_t sample = runtime_.plot_sample();
+    if (sample > 1 && header.seq % sample != 0)
+        return;
+    if (!want_event(EventCategory::TRACKING, Severity::DEBUG))
+        return;
+    EventDetail detail;
+    if (assoc.result == PlotAssociation::Result::ASSOCIATED) {
+        detail.kind = EventDetail::Kind::ASSOCIATION;
+        detail.src_id = header.src_id;
+        detail.association.plot_id = plot.plot_id();
+        detail.association.track_id = assoc.track_id;
+        detail.association.track_src = assoc.track_src;
+        detail.association.d_az_mdeg = assoc.d_az_mdeg;
+        detail.association.d_range_m = assoc.d_range_m;
+        publish_event(EventId::EVT_PLOT_ASSOCIATED, EventCategory::TRACKING,
+            Severity::DEBUG, detail);
+        return;
+    }
+    // Not associated with association on: a duplicate of a plot already seen
+    if (assoc.result == PlotAssociation::Result::NONE && config_.association.enabled)
+        return;
+    // A new-track candidate (or association off)
+    detail.kind = EventDetail::Kind::PLOT;
+    detail.src_id = header.src_id;
+    detail.plot.plot_id = plot.plot_id();
+    detail.plot.range_m = plot.range_m();
+    publish_event(EventId::EVT_TRACK_NEW, EventCategory::TRACKING,
+        Severity::DEBUG, detail);
+}
+
+void Gateway::on_payload(const TelemetryHeader& header, HeartbeatView hb) {
+    SubsystemState state = static_cast<SubsystemState>(hb.state());
+
+    EventId evt_id = EventId::EVT_HEARTBEAT_OK;
+    Severity sev = Severity::DEBUG;
+    if (state == SubsystemState::DEGRADED) {
+        evt_id = EventId::EVT_HEARTBEAT_DEGRADE;
+        sev = Severity::WARN;
+    } else if (state == SubsystemState::ERROR || state == SubsystemState::OFFLINE) {
+        evt_id = EventId::EVT_HEARTBEAT_ERROR;
+        sev = Severity::ALARM;
+    }
+    if (!want_event(EventCategory::HEALTH, sev))
+        return;
+
+    EventDetail detail;
+    detail.kind = EventDetail::Kind::HEARTBEAT;
+    detail.src_id = header.src_id;
+    detail.heartbeat.subsystem_id = hb.subsystem_id();
+    detail.heartbeat.state = hb.state();
+    detail.heartbeat.cpu_pct = hb.cpu_pct();
+    detail.heartbeat.mem_pct = hb.mem_pct();
+    publish_event(evt_id, EventCategory::HEALTH, sev, detail);
+}
+
+void Gateway::on_payload(const TelemetryHeader& header, EngagementView eng) {
+    if (!want_event(EventCategory::ENGAGEMENT, Severity::INFO))
+        return;
+    EventDetail detail;
+    detail.kind = EventDetail::Kind::ENGAGEMENT;
+    detail.src_id = header.src_id;
+    detail.engagement.weapon_id = eng.weapon_id();
+    detail.engagement.mode = eng.mode();
+    detail.engagement.track = eng.assigned_track();
+    detail.engagement.rounds = eng.rounds_remaining();
+    publish_event(EventId::EVT_WEAPON_STATUS, EventCategory::ENGAGEMENT,
+        Severity::INFO, detail);
+}
+
+// --- Staged pipeline ---
+
+Gateway::WorkerPipeline::WorkerPipeline(std::size_t worker, std::size_t batches,
+                                        std::size_t batch_size)
+    : rx_q(batches), free_q(batches) {
+    pool.reserve(batches);
+    for (std::size_t i = 0; i < batches; ++i) {
+        pool.push_back(std::make_unique<RxBatch>(batch_size));
+        pool.back()->worker = worker;
+        push_owned(free_q, pool.back().get());
+    }
+}
+
+bool Gateway::validators_done() const {
+    return std::all_of(workers_.begin(), workers_.end(), [](const auto& w) {
+        return w->pipe->validate_done.load(std::memory_order_acquire);
+    });
+}
+
+void Gateway::run_pipelined() {
+    std::size_t batches = config_.pipeline_batches > 0 ? config_.pipeline_batches : 1;
+    for (std::size_t i = 0; i < workers_.size(); ++i)
+        workers_[i]->pipe = std::make_unique<WorkerPipeline>(i, batches, config_.rx_batch_size);
+    // Room for every batch in flight, so pushing a batch never waits long
+    record_q_ = std::make_unique<MpscQueue<RxBatch*>>(batches * workers_.size());
+    dispatch_q_ = std::make_unique<MpscQueue<FrameOutcome>>(config_.dispatch_queue_depth);
+    priority_q_ = std::make_unique<MpscQueue<FrameOutcome>>(config_.priority_queue_depth);
+    rx_meter_.reset();
+    record_meter_.reset();
+    dispatch_meter_.reset();
+    priority_meter_.reset();
+
+    std::vector<std::thread> validators;
+    validators.reserve(workers_.size());
+    for (auto& w : workers_)
+        validators.emplace_back(&Gateway::validate_stage, this, std::ref(*w));
+    std::thread dispatcher(&Gateway::dispatch_stage, this);
+    std::thread recorder;
+    // Started whenever a recorder is open: recording can be resumed later
+    if (recorder_.is_open())
+        recorder = std::thread(&Gateway::record_stage, this);
+
+    if (workers_.size() == 1) {
+        receive_stage(*workers_[0]);
+    } else {
+        std::vector<std::thread> receivers;
+        receivers.reserve(workers_.size());
+        for (auto& w : workers_)
+            receivers.emplace_back(&Gateway::receive_stage, this, std::ref(*w));
+
+        for (auto& t : receivers)
+            t.join();
+    }
+
+    // Downstream stages drain what is queued, then exit
+    for (auto& t : validators)
+        t.join();
+    dispatcher.join();
+    if (recorder.joinable())
+        recorder.join();
+}
+
+void Gateway::receive_stage(IngestWorker& worker) {
+    const std::size_t index = worker_index(worker);
+    const std::string thread_name = "rx" + std::to_string(index);
+    NNG_PROFILE_THREAD(profiler_, thread_name);
+    AllocTracker::name_thread(thread_name.c_str(), true);
+    WorkerPipeline& pipe = *worker.pipe;
+    // The receive thread fills the pool's batches: they live on its node
+    if (place_thread(ThreadRole::INGEST, index) && config_.placement.numa_local) {
+        for (auto& b : pipe.pool)
+            place_on_local_node(b->frames.slot(0), b->frames.capacity() * FramePool::SLOT_SIZE);
+    }
+    // Replay must not lose frames: it always waits for the pipeline
+    QueueFullPolicy policy = config_.replay_path.empty() ? config_.queue_full_policy
+                                                         : QueueFullPolicy::BLOCK;
+    FrameBatch discard(config_.rx_batch_size);
+    RxBatch* batch = nullptr;
+    unsigned idle = 0;
+
+    while (!should_stop_.load()) {
+        // Every batch in flight means the pipeline is full
+        if (!batch && !pipe.free_q.try_pop(batch))
+            batch = nullptr;
+
+        if (!batch) {
+            if (policy == QueueFullPolicy::BLOCK) {
+                backoff(idle);
+                continue;
             }
-            break;
+            // Keep draining the socket so the loss is counted, not silent
+            std::size_t n = worker.source->receive_batch(discard);
+            if (n > 0)
+                rx_meter_.on_drop(n);
+            else if (replay_finished(worker))
+                break;
+            continue;
         }
+        idle = 0;
 
-        case MsgType::PLOT: {
-            if (parsed.header.payload_len >= sizeof(PlotPayload)) {
-                PlotPayload plot = deserialize_plot(parsed.payload_ptr);
-                std::ostringstream detail;
-                detail << "src_id=" << parsed.header.src_id
-                       << " plot_id=" << plot.plot_id
-                       << " range=" << plot.range_m << "m";
-                publish_event(EventId::EVT_TRACK_NEW, EventCategory::TRACKING,
-                    Severity::DEBUG, detail.str());
-            }
-            break;
+        std::size_t n = receive(worker, batch->frames);
+        if (n == 0) {
+            if (replay_finished(worker))
+                break;
+            continue;
         }
 
-        case MsgType::HEARTBEAT: {
-            if (parsed.header.payload_len >= sizeof(HeartbeatPayload)) {
-                HeartbeatPayload hb = deserialize_heartbeat(parsed.payload_ptr);
-                SubsystemState state = static_cast<SubsystemState>(hb.state);
-
-                EventId evt_id = EventId::EVT_HEARTBEAT_OK;
-                Severity sev = Severity::DEBUG;
-                if (state == SubsystemState::DEGRADED) {
-                    evt_id = EventId::EVT_HEARTBEAT_DEGRADE;
-                    sev = Severity::WARN;
-                } else if (state == SubsystemState::ERROR || state == SubsystemState::OFFLINE) {
-                    evt_id = EventId::EVT_HEARTBEAT_ERROR;
-                    sev = Severity::ALARM;
-                }
-
-                std::ostringstream detail;
-                detail << "subsystem=" << hb.subsystem_id
-                       << " state=" << static_cast<int>(hb.state)
-                       << " cpu=" << static_cast<int>(hb.cpu_pct) << "%"
-                       << " mem=" << static_cast<int>(hb.mem_pct) << "%";
-                publish_event(evt_id, EventCategory::HEALTH, sev, detail.str());
+        // Zero-copy source memory is only valid until the next receive
+        batch->frames.detach();
+        batch->dequeue_ns = realtime_ns();
+
+        // The ring holds the whole pool: there is always room
+        push_owned(pipe.rx_q, batch);
+        rx_meter_.on_push(pipe.rx_q.size());
+        batch = nullptr;
+    }
+    pipe.rx_done.store(true, std::memory_order_release);
+}
+
+void Gateway::validate_stage(IngestWorker& worker) {
+    const std::size_t index = worker_index(worker);
+    const std::string thread_name = "validate" + std::to_string(index);
+    NNG_PROFILE_THREAD(profiler_, thread_name);
+    AllocTracker::name_thread(thread_name.c_str(), true);
+    // Tracking, stats and timers are the validate thread's in a pipeline
+    if (place_thread(ThreadRole::WORKER, index))
+        place_worker_memory(worker, nullptr);
+    WorkerPipeline& pipe = *worker.pipe;
+    const QueueFullPolicy policy = config_.queue_full_policy;
+    // Replay must not lose events to overload shedding
+    const bool shed = config_.replay_path.empty();
+    unsigned idle = 0;
+
+    auto push = [this, policy, shed](const FrameOutcome& out) {
+        const bool priority = config_.priority_lanes && out.lane == Lane::PRIORITY;
+        MpscQueue<FrameOutcome>& q = priority ? *priority_q_ : *dispatch_q_;
+        QueueMeter& meter = priority ? priority_meter_ : dispatch_meter_;
+        unsigned full = 0;
+        while (!q.try_push(out)) {
+            // Overloaded, a full bulk lane drops: blocking on it would
+            // hold up the priority frames behind
+            bool drop = priority ? config_.priority_queue_policy == QueueFullPolicy::DROP
+                                 : policy == QueueFullPolicy::DROP ||
+                                   (shed && config_.priority_lanes && runtime_.overloaded());
+            if (drop) {
+                meter.on_drop(1);
+                return;
             }
-            break;
+            backoff(full);
         }
+        meter.on_push(q.size());
+    };
 
-        case MsgType::ENGAGEMENT: {
-            if (parsed.header.payload_len >= sizeof(EngagementPayload)) {
-                EngagementPayload eng = deserialize_engagement(parsed.payload_ptr);
-                std::ostringstream detail;
-                detail << "weapon=" << eng.weapon_id
-                       << " mode=" << static_cast<int>(eng.mode)
-                       << " track=" << eng.assigned_track
-                       << " rounds=" << eng.rounds_remaining;
-                publish_event(EventId::EVT_WEAPON_STATUS, EventCategory::ENGAGEMENT,
-                    Severity::INFO, detail.str());
-            }
-            break;
+    while (true) {
+        // Timers are checked when idle too: that is when sources time out
+        expire_timers(worker, realtime_ns(), push);
+        RxBatch* batch = nullptr;
+        if (!pipe.rx_q.try_pop(batch)) {
+            if (pipe.rx_done.load(std::memory_order_acquire) && pipe.rx_q.empty())
+                break;
+            backoff(idle);
+            continue;
+        }
+        idle = 0;
+        rx_meter_.on_pop();
+
+        const ParsedFrameBatch& parsed = worker.parsed;
+        parse(worker, batch->frames);
+        if (parsed.filtered_count > 0)
+            worker.stats->record_filtered(parsed.filtered_count);
+        for (std::size_t i = 0; i < parsed.count; ++i) {
+            FrameOutcome out;
+            validate_frame(worker, batch->frames[parsed.sources[i]], i, batch->dequeue_ns, out);
+            push(out);
+            emit_decoded(worker, out, push);
+        }
+        if (worker.forwarder)
+            worker.forwarder->flush();
+
+        // A lagging recorder sheds recordings rather than ingest
+        bool record = runtime_.recording() && recorder_.is_open();
+        if (record && policy == QueueFullPolicy::DROP &&
+            record_q_->size() >= record_q_->capacity() / 2) {
+            record_meter_.on_drop(batch->frames.size());
+            record = false;
+        }
+
+        if (record) {
+            push_owned(*record_q_, batch);
+            record_meter_.on_push(record_q_->size());
+        } else {
+            push_owned(pipe.free_q, batch);
+        }
+    }
+    pipe.validate_done.store(true, std::memory_order_release);
+}
+
+void Gateway::record_stage() {
+    NNG_PROFILE_THREAD(profiler_, "record");
+    AllocTracker::name_thread("record", true);
+    place_thread(ThreadRole::WRITER, 0);
+    constexpr std::size_t MAX_POP = 16;
+    RxBatch* batches[MAX_POP];
+    unsigned idle = 0;
+    while (true) {
+        std::size_t n = record_q_->try_pop_n(batches, MAX_POP);
+        if (n == 0) {
+            if (validators_done() && record_q_->empty())
+                break;
+            backoff(idle);
+            continue;
+        }
+        idle = 0;
+
+        for (std::size_t b = 0; b < n; ++b) {
+            RxBatch* batch = batches[b];
+            record_meter_.on_pop();
+            record_batch(batch->frames, batch->dequeue_ns);
+            push_owned(workers_[batch->worker]->pipe->free_q, batch);
+        }
+    }
+}
+
+void Gateway::dispatch_stage() {
+    NNG_PROFILE_THREAD(profiler_, "dispatch");
+    AllocTracker::name_thread("dispatch", true);
+    place_thread(ThreadRole::DISPATCHER, 0);
+    // Summaries are checked when idle and every so many events under load
+    constexpr unsigned FLUSH_EVERY = 256;
+    unsigned idle = 0;
+    unsigned since_flush = 0;
+    FrameOutcome out;
+    if (monitor_active_)
+        load_cpu_start_ns_ = thread_cpu_ns();
+    auto check_load = [this] {
+        if (!monitor_active_)
+            return;
+        uint64_t now = steady_ns();
+        if (now - load_period_start_ns_ >= config_.overload.interval_ms * 1000000ULL)
+            sample_load(now, pipeline_fill());
+    };
+    while (true) {
+        // Strict priority: a bulk event only when no priority one waits
+        if (priority_q_->try_pop(out)) {
+            priority_meter_.on_pop();
+        } else if (dispatch_q_->try_pop(out)) {
+            dispatch_meter_.on_pop();
+        } else {
+            if (validators_done() && priority_q_->empty() && dispatch_q_->empty())
+                break;
+            flush_coalesced();
+            check_load();
+            backoff(idle);
+            continue;
+        }
+        idle = 0;
+        dispatch_outcome(out);
+        if (++since_flush == FLUSH_EVERY) {
+            since_flush = 0;
+            flush_coalesced();
+            check_load();
         }
     }
 }
 
-void Gateway::publish_event(EventId id, EventCategory cat, Severity sev, const std::string& detail) {
-    // Log
-    const char* event_name = "UNKNOWN";
-    switch (id) {
-        case EventId::EVT_TRACK_NEW:        event_name = "EVT_TRACK_NEW"; break;
-        case EventId::EVT_TRACK_UPDATE:     event_name = "EVT_TRACK_UPDATE"; break;
-        case EventId::EVT_TRACK_LOST:       event_name = "EVT_TRACK_LOST"; break;
-        case EventId::EVT_SEQ_GAP:          event_name = "EVT_SEQ_GAP"; break;
-        case EventId::EVT_SEQ_REORDER:      event_name = "EVT_SEQ_REORDER"; break;
-        case EventId::EVT_FRAME_MALFORMED:  event_name = "EVT_FRAME_MALFORMED"; break;
-        case EventId::EVT_CRC_FAIL:         event_name = "EVT_CRC_FAIL"; break;
-        case EventId::EVT_SOURCE_ONLINE:    event_name = "EVT_SOURCE_ONLINE"; break;
-        case EventId::EVT_SOURCE_TIMEOUT:   event_name = "EVT_SOURCE_TIMEOUT"; break;
-        case EventId::EVT_HEARTBEAT_OK:     event_name = "EVT_HEARTBEAT_OK"; break;
-        case EventId::EVT_HEARTBEAT_DEGRADE:event_name = "EVT_HEARTBEAT_DEGRADE"; break;
-        case EventId::EVT_HEARTBEAT_ERROR:  event_name = "EVT_HEARTBEAT_ERROR"; break;
-        case EventId::EVT_CONFIG_CHANGE:    event_name = "EVT_CONFIG_CHANGE"; break;
-        case EventId::EVT_WEAPON_STATUS:    event_name = "EVT_WEAPON_STATUS"; break;
-        default: break;
-    }
-
-    Logger::instance().log(sev, cat, event_name, detail);
-
-    // Publish to event bus
-    EventRecord record;
-    record.id = id;
-    record.category = cat;
-    record.severity = sev;
-    record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
-    record.detail = detail;
-    events_.publish(record);
+double Gateway::pipeline_fill() const {
+    double fill = std::max(static_cast<double>(dispatch_q_->size()) /
+                           static_cast<double>(dispatch_q_->capacity()),
+                           static_cast<double>(priority_q_->size()) /
+                           static_cast<double>(priority_q_->capacity()));
+    for (const auto& w : workers_) {
+        const WorkerPipeline& pipe = *w->pipe;
+        fill = std::max(fill, static_cast<double>(pipe.rx_q.size()) /
+                              static_cast<double>(pipe.pool.size()));
+    }
+    return std::min(fill, 1.0);
+}
+
+void Gateway::sample_load(uint64_t now_ns, double queue_fill) {
+    uint64_t cpu = thread_cpu_ns();
+    uint64_t wall = now_ns - load_period_start_ns_;
+    double busy = wall > 0 ? static_cast<double>(cpu - load_cpu_start_ns_) / static_cast<double>(wall)
+                           : 0.0;
+    load_period_start_ns_ = now_ns;
+    load_cpu_start_ns_ = cpu;
+    // A busy-polling receive loop keeps its core busy whatever the load
+    if (config_.busy_poll_us > 0 && !config_.pipelined)
+        busy = 0.0;
+
+    bool was = monitor_.overloaded();
+    bool overloaded = monitor_.sample(queue_fill, busy);
+    if (overloaded == was)
+        return;
+    runtime_.set_overload_detected(overloaded);
+    if (Logger::instance().enabled(Severity::WARN, EventCategory::CONTROL)) {
+        int fill_pct = static_cast<int>(queue_fill * 100.0);
+        int cpu_pct = static_cast<int>(busy * 100.0);
+        Logger::instance().log(Severity::WARN, EventCategory::CONTROL, "EVT_CONFIG_CHANGE",
+            std::string(overloaded ? "Overload detected, shedding events below INFO"
+                                   : "Overload cleared, events restored") +
+            " (queue " + std::to_string(fill_pct) + "%, cpu " + std::to_string(cpu_pct) + "%" +
+            (runtime_.overload_mode() == OverloadMode::AUTO ? ")" : ", overload mode forced)"));
+    }
+}
+
+bool Gateway::want_event(EventCategory cat, Severity sev) {
+    if (sev < runtime_.effective_event_level())
+        return false;
+    return Logger::instance().enabled(sev, cat) || events_.has_subscribers(cat);
+}
+
+void Gateway::publish_event(EventId id, EventCategory cat, Severity sev, const EventDetail& detail) {
+    if (sev < runtime_.effective_event_level())
+        return;
+    bool log = Logger::instance().enabled(sev, cat);
+    bool bus = events_.has_subscribers(cat);
+    if (!log && !bus)
+        return;
+
+    // Text is rendered only for the log; subscribers get the typed fields
+    if (log) {
+        NNG_PROFILE_SCOPE(LOG);
+        Logger::instance().log_event(sev, cat, id, detail);
+    }
+
+    if (bus) {
+        NNG_PROFILE_SCOPE(PUBLISH);
+        EventRecord record;
+        record.id = id;
+        record.category = cat;
+        record.severity = sev;
+        record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        record.fields = detail;
+        events_.publish(record);
+    }
+}
+
+void Gateway::publish_fault(EventId id, const EventDetail& detail, uint32_t amount) {
+    if (!want_event(EventCategory::NETWORK, Severity::WARN))
+        return;
+
+    if (coalescer_.enabled()) {
+        CoalescedEvents summary;
+        bool emit;
+        {
+            std::unique_lock<std::mutex> lock(coalescer_mutex_, std::defer_lock);
+            if (workers_.size() > 1 && !config_.pipelined)
+                lock.lock();
+            emit = coalescer_.admit(id, detail.src_id, amount, steady_ns(), summary);
+        }
+        if (summary.count > 0)
+            publish_coalesced(summary);
+        if (!emit)
+            return;
+    }
+    publish_event(id, EventCategory::NETWORK, Severity::WARN, detail);
+}
+
+void Gateway::publish_coalesced(const CoalescedEvents& summary) {
+    EventDetail detail;
+    detail.kind = EventDetail::Kind::COALESCED;
+    detail.src_id = summary.src_id;
+    detail.coalesced.count = summary.count;
+    detail.coalesced.amount = static_cast<uint32_t>(
+        std::min<uint64_t>(summary.amount, UINT32_MAX));
+    detail.coalesced.window_ms = static_cast<uint32_t>(summary.window_ns / 1000000ULL);
+    publish_event(summary.id, EventCategory::NETWORK, Severity::WARN, detail);
+}
+
+void Gateway::flush_coalesced(bool all) {
+    if (!coalescer_.enabled())
+        return;
+    uint64_t now = steady_ns();
+    if (!all && now < coalescer_.next_flush_ns())
+        return;
+
+    std::unique_lock<std::mutex> lock(coalescer_mutex_, std::defer_lock);
+    if (workers_.size() > 1 && !config_.pipelined)
+        lock.lock();
+    coalesced_.clear();
+    if (all)
+        coalescer_.flush_all(coalesced_);
+    else
+        coalescer_.flush(now, coalesced_);
+    for (const auto& summary : coalesced_)
+        publish_coalesced(summary);
 }
 
 } // namespace nng
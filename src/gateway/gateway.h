@@ -1,25 +1,141 @@
 #pragma once
 #include "gateway/frame_source.h"
 #include "gateway/telemetry_parser.h"
+#include "gateway/ingress_filter.h"
 #include "gateway/sequence_tracker.h"
 #include "gateway/stats_manager.h"
 #include "gateway/frame_recorder.h"
+#include "gateway/event_coalescer.h"
+#include "gateway/runtime_config.h"
+#include "gateway/pipeline.h"
+#include "gateway/stage_profiler.h"
+#include "gateway/track_table.h"
+#include "gateway/plot_associator.h"
+#include "gateway/timer_wheel.h"
+#include "gateway/frame_forwarder.h"
 #include "common/logger.h"
 #include "common/event_bus.h"
 #include "common/types.h"
+#include "common/spsc_ring.h"
+#include "common/mpsc_queue.h"
+#include "common/thread_placement.h"
 #include <string>
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace nng {
 
+// How UDP ingest sockets are read
+enum class RxBackend {
+    SOCKET,   // poll() + recvmmsg() (UdpFrameSource)
+    IO_URING, // multishot recv + provided buffers (IoUringFrameSource)
+    PACKET_RING, // AF_PACKET mmap ring capture (PacketRingFrameSource)
+    SHM,      // shared-memory ring from co-located senders (ShmFrameSource)
+};
+
 struct GatewayConfig {
     uint16_t udp_port        = 5000;
     bool     crc_enabled     = true;
     bool     record_enabled  = false;
     std::string record_path  = "./recorded/session.bin";
+    RecorderOptions record_options; // block ring, O_DIRECT, preallocation
     std::string replay_path;  // if non-empty, use replay instead of UDP
     Severity log_level       = Severity::INFO;
+    std::size_t rx_batch_size = 64; // max frames taken per receive_batch()
+    // Number of UDP ingest threads. Each worker binds its own SO_REUSEPORT
+    // socket and keeps its own SequenceTracker and stats shard; the kernel
+    // hashes each sender's flow onto one worker. Ignored in replay mode.
+    std::size_t ingest_workers = 1;
+    // IO_URING / PACKET_RING fall back to SOCKET if unavailable
+    RxBackend rx_backend = RxBackend::SOCKET;
+    // Interface PACKET_RING captures on
+    std::string capture_interface = "lo";
+    // SHM: ring name (worker i of several reads "<shm_name>.<i>") and slots
+    std::string shm_name = "nng";
+    std::size_t shm_slots = 4096;
+    // SOCKET backend: spin on non-blocking receives this long before
+    // blocking (lower p99 latency after idle gaps, costs a core). 0 = off.
+    int busy_poll_us = 0;
+
+    // Staged pipeline: receive, validate/track, record and event dispatch
+    // each on their own thread(s), joined by lock-free queues, so a slow
+    // recorder or subscriber no longer stalls the receive loop. Off runs
+    // every stage inline on the receive thread.
+    bool pipelined = false;
+    std::size_t pipeline_batches = 64;       // in-flight rx batches per worker
+    std::size_t dispatch_queue_depth = 8192; // pending events, all workers
+    QueueFullPolicy queue_full_policy = QueueFullPolicy::BLOCK;
+
+    // Priority lanes (see Lane): priority events are published ahead of
+    // bulk ones. Inline, a batch's bulk events wait until its priority
+    // ones are out; pipelined, priority events have their own queue,
+    // drained first. queue_full_policy is the bulk queue's, except that
+    // while overloaded a full bulk queue drops rather than holds up the
+    // frames behind it. Off runs a single lane in arrival order.
+    bool priority_lanes = true;
+    std::size_t priority_queue_depth = 1024; // pending priority events, all workers
+    QueueFullPolicy priority_queue_policy = QueueFullPolicy::BLOCK;
+
+    // Sequence numbers remembered per source for telling late frames
+    // apart as reorders or duplicates (power of two, 64..4096)
+    std::size_t reorder_window = 1024;
+
+    // Early-drop filter spec (see IngressFilter); empty accepts everything.
+    // Can be changed while running through ingress_filter().
+    std::string ingress_filter;
+
+    // Fault events (gaps, reorders, malformed, CRC failures) per source:
+    // at most event_burst per window are emitted, the rest fold into one
+    // summary event per window (see EventCoalescer). 0 ms: emit them all.
+    uint64_t event_window_ms = 1000;
+    uint32_t event_burst = EventCoalescer::DEFAULT_BURST;
+
+    // Starting values of the runtime knobs (see RuntimeConfig): events
+    // below event_level are never raised, and one PLOT in plot_sample is
+    uint32_t plot_sample = 1;
+    Severity event_level = Severity::DEBUG;
+    // Automatic load shedding. Not used in replay, which always runs flat out.
+    OverloadOptions overload;
+
+    // If set (and not replaying), worker i reads from source_factory(i)
+    // instead of a UDP socket: in-process harnesses (MemoryFrameChannel)
+    // and tests. udp_port and rx_backend are then ignored; a null source
+    // fails run().
+    std::function<std::unique_ptr<IFrameSource>(std::size_t worker)> source_factory;
+
+    // Start with per-stage hot-path timing on (see StageProfiler; needs a
+    // build with NNG_PROFILE, and can be switched while running)
+    bool profile = false;
+
+    // Live track picture (see TrackTable): slots per ingest worker (0: no
+    // table), and how long a track not updated stays in it
+    std::size_t track_capacity = TrackTable::DEFAULT_CAPACITY;
+    uint64_t track_ttl_ms = 10000;
+    // A source silent this long raises EVT_SOURCE_TIMEOUT once (0: never);
+    // a track dropped for age raises EVT_TRACK_LOST. Both run on timer
+    // wheels of timer_tick_ms resolution.
+    uint64_t source_timeout_ms = 5000;
+    uint64_t timer_tick_ms = 10;
+
+    // Plot-to-track association (see PlotAssociator), per ingest worker
+    // against the tracks it has seen: each PLOT raises EVT_PLOT_ASSOCIATED
+    // with the track it gates into, or EVT_TRACK_NEW as a new-track
+    // candidate. Off, every PLOT raises EVT_TRACK_NEW.
+    AssociationOptions association;
+
+    // Republish validated frames (duplicates left out) to multicast groups
+    // or unicast sinks, packed into v2 containers (see FrameForwarder)
+    ForwardOptions forward;
+
+    // CPUs of the ingest (inline loop or rx stage), worker (validate),
+    // dispatcher and writer threads; the control node takes the control
+    // role from it too. With numa_local each pinned ingest or worker
+    // thread moves its batches, pipeline pool, track table and stats
+    // shard to its own NUMA node.
+    ThreadPlacement placement;
 };
 
 class Gateway {
@@ -27,7 +143,8 @@ public:
     explicit Gateway(const GatewayConfig& config);
     ~Gateway();
 
-    // Run the main loop (blocking, until stop() is called from another thread)
+    // Run the main loop (blocking, until stop() is called from another
+    // thread; a stop() before run() gets going still ends it)
     void run();
     void stop();
 
@@ -38,19 +155,176 @@ public:
     EventBus& events() { return events_; }
     Logger& logger() { return Logger::instance(); }
 
-    // Get config
+    // Get config (starting values; runtime() holds the live ones)
     const GatewayConfig& config() const { return config_; }
 
+    // CRC, recording, event level, plot sampling, overload mode and the
+    // ingress filter, changeable while running (e.g. by CommandHandler)
+    RuntimeConfig& runtime() { return runtime_; }
+
+    // Frames it rejects are dropped before CRC, tracking and stats
+    IngressFilter& ingress_filter() { return runtime_.filter(); }
+
+    // Recording counters (frames, stalls, drops)
+    const FrameRecorder& recorder() const { return recorder_; }
+
+    // Inter-stage queue metrics (all zero unless pipelined)
+    PipelineStats pipeline_stats() const;
+
+    // Fault events folded into summaries so far
+    uint64_t events_coalesced() const { return coalescer_.suppressed_total(); }
+
+    // Per-thread, per-stage timings (e.g. for CommandHandler GET PROFILE)
+    StageProfiler& profiler() { return profiler_; }
+
+    // Latest state of every live track (e.g. for CommandHandler GET TRACKS)
+    const TrackPicture& tracks() const { return tracks_; }
+
+    // Validated-frame forwarding: its filter and counters (e.g. for
+    // CommandHandler GET FORWARD)
+    ForwardHub& forwarding() { return forward_; }
+
+    // Plot association counters, all workers (zero unless enabled)
+    AssociationStats association_stats() const;
+
 private:
-    void process_frame(const std::vector<uint8_t>& frame, uint64_t rx_timestamp_ns);
-    void publish_event(EventId id, EventCategory cat, Severity sev, const std::string& detail);
+    // Batch pool and private queues of one worker's pipeline
+    struct WorkerPipeline {
+        WorkerPipeline(std::size_t worker, std::size_t batches, std::size_t batch_size);
+
+        std::vector<std::unique_ptr<RxBatch>> pool;
+        SpscRing<RxBatch*> rx_q;    // receive -> validate
+        MpscQueue<RxBatch*> free_q; // validate or record -> receive (recycle)
+        std::atomic<bool> rx_done{false};
+        std::atomic<bool> validate_done{false};
+    };
+
+    // Per-thread ingest state. Nothing in here is shared between workers.
+    struct IngestWorker {
+        explicit IngestWorker(std::size_t reorder_window)
+            : tracker(SeqStorage::FLAT, reorder_window) {}
+
+        std::unique_ptr<IFrameSource> source;
+        SequenceTracker tracker;
+        StatsShard* stats = nullptr;          // this worker's shard of stats_
+        TrackTable* tracks = nullptr;         // this worker's table of tracks_ (if any)
+        std::unique_ptr<TimerWheel> source_timers; // by src_id (if source_timeout_ms)
+        std::vector<uint32_t> fired;          // expired source timers, reused
+        std::vector<TrackRecord> lost;        // expired tracks, reused
+        FrameForwarder* forwarder = nullptr;  // this worker's of forward_ (if forwarding)
+        PlotAssociator* associator = nullptr; // this worker's of associators_ (if associating)
+        std::unique_ptr<WorkerPipeline> pipe; // only when pipelined
+        ParsedFrameBatch parsed;              // parse_frames() results, reused
+        std::vector<TrackPayload> decoded;    // tracks of the last TRACK_DELTA frame
+        std::vector<FrameOutcome> bulk;       // inline: bulk outcomes held back to batch end
+    };
+
+    bool open_sources();
+    // Give each worker its table of tracks_ (none if track_capacity is 0),
+    // its source timers, its forwarder and its associator
+    void init_worker_state();
+    // Turn the worker's timers due by now_ns into outcomes, each handed
+    // to emit (dispatch_outcome inline, the dispatch queue pipelined)
+    template <typename Emit> void expire_timers(IngestWorker& worker, uint64_t now_ns, Emit&& emit);
+    // One TRACK outcome per track the frame of out decoded to (a
+    // TRACK_DELTA frame, via worker.decoded), for the track update events
+    template <typename Emit> void emit_decoded(IngestWorker& worker, const FrameOutcome& out, Emit&& emit);
+    void ingest_loop(IngestWorker& worker);
+    // Pin the calling thread as the index-th of role (config.placement);
+    // false if it stays unpinned
+    bool place_thread(ThreadRole role, std::size_t index);
+    // With numa_local, move the worker's own memory, and batch if given,
+    // to the calling thread's node
+    void place_worker_memory(IngestWorker& worker, FrameBatch* batch);
+    std::size_t worker_index(const IngestWorker& worker) const;
+    // The hot-path steps shared by the inline and pipelined loops, each
+    // timed as its ProfileStage
+    std::size_t receive(IngestWorker& worker, FrameBatch& batch);
+    void parse(IngestWorker& worker, const FrameBatch& batch);
+    void record_batch(const FrameBatch& batch, uint64_t dequeue_ns);
+    bool replay_finished(IngestWorker& worker) const;
+    // dequeue_ns: CLOCK_REALTIME when the frame's batch left the source
+    void record_frame(const FrameView& frame, uint64_t dequeue_ns);
+    // Track and count result i of the batch last given to parse_frames()
+    // (results in worker.parsed); datagram is the one it came from. Fills
+    // out for dispatch_outcome().
+    void validate_frame(IngestWorker& worker, const FrameView& datagram, std::size_t i,
+                        uint64_t dequeue_ns, FrameOutcome& out);
+    // Apply each record of a TRACK_DELTA payload to the worker's track
+    // table, appending the tracks to worker.decoded
+    void decode_track_deltas(IngestWorker& worker, uint16_t src_id, const uint8_t* payload,
+                             std::size_t len, uint64_t now_ns);
+    // Format and publish the events of one validated frame
+    void dispatch_outcome(const FrameOutcome& out);
+    // EVT_SOURCE_TIMEOUT / EVT_TRACK_LOST of a fired timer
+    void publish_expiry(const FrameOutcome& out);
+    // Per-MsgType handlers; dispatch_outcome() indexes a table of
+    // dispatch_msg<T> by msg_type, each forwarding to its on_payload(),
+    // which reads the fields it needs in place through the payload's view
+    // (a PLOT's also gets the plot's association)
+    template <MsgType T> void dispatch_msg(const FrameOutcome& out);
+    void on_payload(const TelemetryHeader& header, PlotView plot, const PlotAssociation& assoc);
+    void on_payload(const TelemetryHeader& header, TrackView track);
+    void on_payload(const TelemetryHeader& header, HeartbeatView hb);
+    void on_payload(const TelemetryHeader& header, EngagementView eng);
+    // Log and publish; returns early when neither the log level nor any
+    // subscriber wants the event. want_event() lets callers skip filling detail.
+    bool want_event(EventCategory cat, Severity sev);
+    void publish_event(EventId id, EventCategory cat, Severity sev, const EventDetail& detail);
+    // publish_event() for a NETWORK/WARN fault event, through the coalescer;
+    // amount is the event's size for the summary (gap length, else 1)
+    void publish_fault(EventId id, const EventDetail& detail, uint32_t amount);
+    void publish_coalesced(const CoalescedEvents& summary);
+    // Emit summaries whose window has closed (all: every pending one)
+    void flush_coalesced(bool all = false);
+    // Feed the overload monitor one period's queue fill and this thread's
+    // CPU use once the period is over; called from one thread only
+    void sample_load(uint64_t now_ns, double queue_fill);
+    // Largest fill of the pipeline queues (0..1)
+    double pipeline_fill() const;
+
+    // Pipeline stages
+    void run_pipelined();
+    void receive_stage(IngestWorker& worker);
+    void validate_stage(IngestWorker& worker);
+    void record_stage();
+    void dispatch_stage();
 
     GatewayConfig config_;
-    std::unique_ptr<IFrameSource> source_;
-    SequenceTracker tracker_;
-    StatsManager stats_;
+    std::vector<std::unique_ptr<IngestWorker>> workers_;
+    StatsManager stats_; // ingest stats (merged view when sharded)
+    TrackPicture tracks_;
+    ForwardHub forward_;
+    // One per ingest worker, kept across runs; the mutex guards the vector
+    std::vector<std::unique_ptr<PlotAssociator>> associators_;
+    mutable std::mutex associators_mutex_;
     EventBus events_;
+    RuntimeConfig runtime_;
     FrameRecorder recorder_;
+    std::mutex recorder_mutex_; // taken only when several workers record
+    EventCoalescer coalescer_;
+    StageProfiler profiler_;
+    std::mutex coalescer_mutex_; // taken only when several workers dispatch
+    std::vector<CoalescedEvents> coalesced_; // flush output, reused
+
+    // Fan-in queues shared by all workers' validate stages
+    std::unique_ptr<MpscQueue<RxBatch*>> record_q_;       // -> record stage
+    std::unique_ptr<MpscQueue<FrameOutcome>> dispatch_q_; // -> dispatch stage, bulk lane
+    std::unique_ptr<MpscQueue<FrameOutcome>> priority_q_; // -> dispatch stage, priority lane
+    bool validators_done() const;
+
+    QueueMeter rx_meter_;
+    QueueMeter record_meter_;
+    QueueMeter dispatch_meter_;
+    QueueMeter priority_meter_;
+
+    // Load sampling, by worker 0 inline or the dispatch stage pipelined
+    OverloadMonitor monitor_;
+    bool monitor_active_ = false;
+    uint64_t load_period_start_ns_ = 0;
+    uint64_t load_cpu_start_ns_ = 0;
+    uint64_t load_batches_ = 0;      // inline: receive batches this period
+    uint64_t load_full_batches_ = 0; // ... of which came back full
 
     std::atomic<bool> running_{false};
     std::atomic<bool> should_stop_{false};
@@ -1,4 +1,8 @@
 #include "gateway/gateway.h"
+#include "common/logger.h"
+#include "common/mmap_log_sink.h"
+#include "common/compression.h"
+#include "common/alloc_tracker.h"
 #include <iostream>
 #include <string>
 #include <csignal>
@@ -21,8 +25,43 @@ void print_usage(const char* prog) {
               << "  --crc               Enable CRC validation (default)\n"
               << "  --no-crc            Disable CRC validation\n"
               << "  --record <path>     Record frames to file\n"
+              << "  --record-direct     Write the recording with O_DIRECT\n"
+              << "  --record-prealloc-mb <n> Preallocate the recording file (default: 0)\n"
+              << "  --record-codec <c>  Compress recorded chunks: none, lz4, zstd (default: none)\n"
               << "  --replay <path>     Replay frames from file instead of UDP\n"
               << "  --log-level <level> Log level: DEBUG, INFO, WARN, ALARM, ERROR, FATAL\n"
+              << "  --rx-batch <n>      Max datagrams per receive call (default: 64)\n"
+              << "  --workers <n>       UDP ingest threads sharing the port (default: 1)\n"
+              << "  --rx <backend>      Receive backend: socket, io_uring, packet_ring, shm (default: socket)\n"
+              << "  --capture-if <name> Interface for --rx packet_ring (default: lo)\n"
+              << "  --shm-name <name>   Ring for --rx shm, <name>.<i> per worker if several (default: nng)\n"
+              << "  --busy-poll <us>    Spin this long before blocking on receive (default: 0)\n"
+              << "  --pipeline          Run receive/validate/record/dispatch as separate stages\n"
+              << "  --queue-policy <p>  Pipeline queue full: block, drop (default: block)\n"
+              << "  --no-priority-lanes Publish events in arrival order (no priority lane)\n"
+              << "  --reorder-window <n> Late frames tracked per source, 64..4096 (default: 1024)\n"
+              << "  --filter <spec>     Drop frames early, e.g. \"type=TRACK;src=1-8\" (default: all)\n"
+              << "  --event-window-ms <ms> Fault event coalescing window, 0 = off (default: 1000)\n"
+              << "  --event-burst <n>   Fault events per source and window before coalescing (default: 5)\n"
+              << "  --event-level <level> Raise no events below this severity (default: DEBUG)\n"
+              << "  --plot-sample <n>   Raise an event for one PLOT in n (default: 1)\n"
+              << "  --no-overload       Never shed events automatically under load\n"
+              << "  --async-log         Format and write log lines on a background thread\n"
+              << "  --profile           Time each hot-path stage; summary printed on exit\n"
+              << "  --track-capacity <n> Track table slots per ingest worker, 0 = none (default: 262144)\n"
+              << "  --track-ttl-ms <ms> Drop tracks not updated for this long (default: 10000)\n"
+              << "  --source-timeout-ms <ms> Raise EVT_SOURCE_TIMEOUT after this long without frames (default: 5000)\n"
+              << "  --timer-tick-ms <ms> Resolution of the source and track deadlines (default: 10)\n"
+              << "  --associate         Associate plots with live tracks (EVT_PLOT_ASSOCIATED / EVT_TRACK_NEW)\n"
+              << "  --assoc-gate <deg>,<m> Association gate half-widths, azimuth and range (default: 1,500)\n"
+              << "  --forward <host:port> Republish validated frames there (multicast or unicast; repeatable)\n"
+              << "  --forward-filter <spec> Only forward matching frames (type=..;src=.., as the ingress filter)\n"
+              << "  --forward-ttl <n>   Hops for multicast forwarding (default: 1)\n"
+              << "  --cpus <spec>       Pin thread roles, e.g. \"ingest=0-3;worker=4-7;dispatcher=8;writer=9\"\n"
+              << "  --no-numa-local     Leave pinned threads' buffers where they were allocated\n"
+              << "  --alloc-track       Count heap allocations per thread; summary printed on exit\n"
+              << "  --log-file <path>   Log to memory-mapped segments <path>.0, <path>.1, ...\n"
+              << "  --log-segment-mb <n> Log segment size before rotating (default: 64)\n"
               << "  --help              Show this help\n";
 }
 
@@ -37,6 +76,10 @@ nng::Severity parse_log_level(const std::string& level) {
 }
 
 int main(int argc, char* argv[]) {
+    bool async_log = false;
+    bool alloc_track = false;
+    std::string log_file;
+    std::size_t log_segment_mb = 64;
     nng::GatewayConfig config;
 
     for (int i = 1; i < argc; ++i) {
@@ -50,10 +93,118 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--record" && i + 1 < argc) {
             config.record_enabled = true;
             config.record_path = argv[++i];
+        } else if (arg == "--record-direct") {
+            config.record_options.direct_io = true;
+        } else if (arg == "--record-prealloc-mb" && i + 1 < argc) {
+            config.record_options.preallocate_bytes = std::stoull(argv[++i]) * 1024 * 1024;
+        } else if (arg == "--record-codec" && i + 1 < argc) {
+            std::string name = argv[++i];
+            nng::Codec codec;
+            if (!nng::parse_codec(name, codec) || !nng::codec_available(codec)) {
+                std::cerr << "Unknown or unavailable codec: " << name << "\n";
+                return 1;
+            }
+            config.record_options.codec = codec;
         } else if (arg == "--replay" && i + 1 < argc) {
             config.replay_path = argv[++i];
         } else if (arg == "--log-level" && i + 1 < argc) {
             config.log_level = parse_log_level(argv[++i]);
+        } else if (arg == "--rx-batch" && i + 1 < argc) {
+            config.rx_batch_size = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--workers" && i + 1 < argc) {
+            config.ingest_workers = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--rx" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "io_uring") {
+                config.rx_backend = nng::RxBackend::IO_URING;
+            } else if (backend == "packet_ring") {
+                config.rx_backend = nng::RxBackend::PACKET_RING;
+            } else if (backend == "shm") {
+                config.rx_backend = nng::RxBackend::SHM;
+            } else if (backend == "socket") {
+                config.rx_backend = nng::RxBackend::SOCKET;
+            } else {
+                std::cerr << "Unknown receive backend: " << backend << "\n";
+                return 1;
+            }
+        } else if (arg == "--shm-name" && i + 1 < argc) {
+            config.shm_name = argv[++i];
+        } else if (arg == "--capture-if" && i + 1 < argc) {
+            config.capture_interface = argv[++i];
+        } else if (arg == "--busy-poll" && i + 1 < argc) {
+            config.busy_poll_us = std::stoi(argv[++i]);
+        } else if (arg == "--pipeline") {
+            config.pipelined = true;
+        } else if (arg == "--queue-policy" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "block") {
+                config.queue_full_policy = nng::QueueFullPolicy::BLOCK;
+            } else if (policy == "drop") {
+                config.queue_full_policy = nng::QueueFullPolicy::DROP;
+            } else {
+                std::cerr << "Unknown queue policy: " << policy << "\n";
+                return 1;
+            }
+        } else if (arg == "--no-priority-lanes") {
+            config.priority_lanes = false;
+        } else if (arg == "--reorder-window" && i + 1 < argc) {
+            config.reorder_window = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            config.ingress_filter = argv[++i];
+        } else if (arg == "--event-window-ms" && i + 1 < argc) {
+            config.event_window_ms = std::stoull(argv[++i]);
+        } else if (arg == "--event-burst" && i + 1 < argc) {
+            config.event_burst = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--event-level" && i + 1 < argc) {
+            config.event_level = parse_log_level(argv[++i]);
+        } else if (arg == "--plot-sample" && i + 1 < argc) {
+            config.plot_sample = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--no-overload") {
+            config.overload.enabled = false;
+        } else if (arg == "--log-file" && i + 1 < argc) {
+            log_file = argv[++i];
+        } else if (arg == "--log-segment-mb" && i + 1 < argc) {
+            log_segment_mb = std::stoull(argv[++i]);
+        } else if (arg == "--profile") {
+            config.profile = true;
+        } else if (arg == "--track-capacity" && i + 1 < argc) {
+            config.track_capacity = std::stoull(argv[++i]);
+        } else if (arg == "--track-ttl-ms" && i + 1 < argc) {
+            config.track_ttl_ms = std::stoull(argv[++i]);
+        } else if (arg == "--source-timeout-ms" && i + 1 < argc) {
+            config.source_timeout_ms = std::stoull(argv[++i]);
+        } else if (arg == "--timer-tick-ms" && i + 1 < argc) {
+            config.timer_tick_ms = std::stoull(argv[++i]);
+        } else if (arg == "--associate") {
+            config.association.enabled = true;
+        } else if (arg == "--assoc-gate" && i + 1 < argc) {
+            std::string gate = argv[++i];
+            std::size_t comma = gate.find(',');
+            if (comma == std::string::npos) {
+                std::cerr << "Invalid --assoc-gate: expected <deg>,<m>\n";
+                return 1;
+            }
+            config.association.gate_az_mdeg =
+                static_cast<uint32_t>(std::stod(gate.substr(0, comma)) * 1000.0);
+            config.association.gate_range_m = static_cast<uint32_t>(std::stoul(gate.substr(comma + 1)));
+        } else if (arg == "--forward" && i + 1 < argc) {
+            config.forward.targets.push_back(argv[++i]);
+        } else if (arg == "--forward-filter" && i + 1 < argc) {
+            config.forward.filter = argv[++i];
+        } else if (arg == "--forward-ttl" && i + 1 < argc) {
+            config.forward.multicast_ttl = std::stoi(argv[++i]);
+        } else if (arg == "--cpus" && i + 1 < argc) {
+            std::string error;
+            if (!config.placement.set(argv[++i], &error)) {
+                std::cerr << "Invalid --cpus: " << error << "\n";
+                return 1;
+            }
+        } else if (arg == "--no-numa-local") {
+            config.placement.numa_local = false;
+        } else if (arg == "--alloc-track") {
+            alloc_track = true;
+        } else if (arg == "--async-log") {
+            async_log = true;
         } else if (arg == "--help") {
             print_usage(argv[0]);
             return 0;
@@ -68,6 +219,16 @@ int main(int argc, char* argv[]) {
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
+    // Declared before the gateway so it outlives the gateway's last log line
+    nng::MmapLogSink log_sink;
+    if (!log_file.empty()) {
+        if (!log_sink.open(log_file, log_segment_mb * 1024 * 1024)) {
+            std::cerr << "Cannot open log file: " << log_file << ".0\n";
+            return 1;
+        }
+        nng::Logger::instance().set_output(log_sink.stream());
+    }
+
     nng::Gateway gateway(config);
     g_gateway = &gateway;
 
@@ -78,10 +239,38 @@ int main(int argc, char* argv[]) {
     if (!config.replay_path.empty()) {
         std::cout << "Replaying from: " << config.replay_path << "\n";
     }
+    if (config.ingest_workers > 1) {
+        std::cout << "Ingest workers: " << config.ingest_workers << "\n";
+    }
+    if (config.pipelined) {
+        std::cout << "Pipeline: enabled (queue policy "
+                  << (config.queue_full_policy == nng::QueueFullPolicy::DROP ? "drop" : "block")
+                  << ")\n";
+    }
+    std::cout << "Priority lanes: " << (config.priority_lanes ? "enabled" : "disabled") << "\n";
+    if (config.association.enabled) {
+        std::cout << "Plot association: gate " << config.association.gate_az_mdeg / 1000.0
+                  << " deg x " << config.association.gate_range_m << " m\n";
+    }
     std::cout << "CRC validation: " << (config.crc_enabled ? "enabled" : "disabled") << "\n";
+    std::cout << "Ingress filter: " << gateway.ingress_filter().spec() << "\n";
+    if (!config.placement.empty()) {
+        std::cout << "Thread placement: " << config.placement.spec() << " (NUMA nodes: "
+                  << nng::numa_node_count()
+                  << (config.placement.numa_local ? ", buffers moved to their threads" : "")
+                  << ")\n";
+    }
     std::cout << "Press Ctrl+C to stop.\n\n";
 
+    if (async_log)
+        nng::Logger::instance().start_async();
+
+    nng::AllocTracker::set_enabled(alloc_track);
     gateway.run();
+    nng::AllocTracker::set_enabled(false);
+
+    // Write out queued log lines before the summary
+    nng::Logger::instance().stop_async();
 
     // Print final stats
     auto stats = gateway.stats().get_global_stats();
@@ -91,7 +280,117 @@ int main(int argc, char* argv[]) {
               << "CRC failures:    " << stats.crc_fail_total << "\n"
               << "Sequence gaps:   " << stats.gap_total << "\n"
               << "Reorders:        " << stats.reorder_total << "\n"
-              << "Duplicates:      " << stats.duplicate_total << "\n";
+              << "Duplicates:      " << stats.duplicate_total << "\n"
+              << "Filtered:        " << stats.filtered_total << "\n"
+              << "Events coalesced: " << gateway.events_coalesced() << "\n"
+              << "Live tracks:     " << gateway.tracks().size() << " (dropped="
+              << gateway.tracks().dropped() << " delta_rejected="
+              << gateway.tracks().delta_rejected() << ")\n";
+    if (config.association.enabled) {
+        nng::AssociationStats assoc = gateway.association_stats();
+        std::cout << "Plots associated: " << assoc.associated << " of " << assoc.plots
+                  << " (candidates=" << assoc.candidates << " gated=" << assoc.gated
+                  << " tracks=" << assoc.tracks << " dropped=" << assoc.dropped << ")\n";
+    }
+    if (gateway.forwarding().enabled()) {
+        nng::ForwardStats fwd = gateway.forwarding().stats();
+        std::cout << "Forwarded:       " << fwd.frames << " frames in " << fwd.datagrams
+                  << " datagrams (filtered=" << fwd.filtered
+                  << " send_failures=" << fwd.send_failures << ")\n";
+    }
+    if (config.record_enabled) {
+        const auto& rec = gateway.recorder();
+        std::cout << "Recorded:        " << rec.frame_count() << " (stalls=" << rec.stalls()
+                  << " dropped=" << rec.dropped_frames() << " write_errors="
+                  << rec.write_errors() << ")\n";
+        if (rec.raw_bytes() > 0 && config.record_options.codec != nng::Codec::NONE)
+            std::cout << "Compression:     " << nng::codec_name(config.record_options.codec) << " "
+                      << rec.raw_bytes() << " -> " << rec.stored_bytes() << " bytes ("
+                      << (100.0 * static_cast<double>(rec.stored_bytes()) /
+                          static_cast<double>(rec.raw_bytes()))
+                      << "%)\n";
+    }
+    if (!log_file.empty())
+        std::cout << "Log bytes:       " << log_sink.bytes_written() << " in "
+                  << log_sink.segment_index() + 1 << " segment(s)\n";
+    if (async_log)
+        std::cout << "Log lines dropped: " << nng::Logger::instance().dropped() << "\n";
+
+    if (config.pipelined) {
+        auto p = gateway.pipeline_stats();
+        auto queue = [](const char* name, const nng::QueueStats& q) {
+            std::cout << name << "enqueued=" << q.enqueued << " dropped=" << q.dropped
+                      << " high_water=" << q.high_water << "\n";
+        };
+        std::cout << "\n=== Pipeline Queues ===\n";
+        queue("rx:       ", p.rx);
+        queue("record:   ", p.record);
+        queue("dispatch: ", p.dispatch);
+        queue("priority: ", p.priority);
+    }
+
+    auto lat = gateway.stats().get_latency_stats();
+    if (lat.process.count > 0) {
+        auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+        std::cout << "\n=== Ingest Latency (mean / max us) ===\n";
+        if (lat.wire.count > 0)
+            std::cout << "Sender->kernel:  " << us(lat.wire.mean_ns()) << " / "
+                      << us(lat.wire.max_ns) << "\n";
+        std::cout << "Kernel->dequeue: " << us(lat.queue.mean_ns()) << " / "
+                  << us(lat.queue.max_ns) << "\n"
+                  << "Kernel->done:    " << us(lat.process.mean_ns()) << " / "
+                  << us(lat.process.max_ns) << "\n";
+    }
+
+    // Percentiles of receive time minus header.ts_ns; with an open-loop
+    // sender (sensor_sim --load) ts_ns is the due time, so this includes
+    // any time frames waited to be sent
+    auto e2e = gateway.stats().get_all_source_latency().latency;
+    if (e2e.count > 0) {
+        auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+        std::cout << "\n=== Sender->receive Latency (us) ===\n"
+                  << "Frames: " << e2e.count << "\n"
+                  << "p50=" << us(e2e.percentile(0.50)) << " p90=" << us(e2e.percentile(0.90))
+                  << " p99=" << us(e2e.percentile(0.99)) << " p99.9=" << us(e2e.percentile(0.999))
+                  << " max=" << us(e2e.max) << "\n";
+    }
+
+    nng::ProfileReport profile;
+    if (config.profile && gateway.profiler().report(profile)) {
+        if (!profile.compiled) {
+            std::cout << "\n(--profile: built without NNG_PROFILE)\n";
+        } else {
+            auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+            std::cout << "\n=== Stage Profile (us; " << profile.clock << ") ===\n";
+            for (std::size_t s = 0; s < nng::PROFILE_STAGE_COUNT; ++s) {
+                const nng::StageTiming& t = profile.stages[s];
+                if (t.ns.count == 0)
+                    continue;
+                std::cout << nng::PROFILE_STAGE_NAMES[s] << ": count=" << t.ns.count
+                          << " p50=" << us(t.ns.percentile(0.50))
+                          << " p99=" << us(t.ns.percentile(0.99))
+                          << " max=" << us(t.ns.max)
+                          << " total_ms=" << static_cast<double>(t.total_ns) / 1e6 << "\n";
+            }
+        }
+    }
+
+    if (alloc_track) {
+        nng::AllocReport allocs = nng::AllocTracker::report();
+        uint64_t frames = stats.rx_total + stats.malformed_total + stats.filtered_total;
+        std::cout << "\n=== Heap Allocations ===\n";
+        for (const auto& t : allocs.threads) {
+            if (t.counts.allocs == 0 && t.counts.frees == 0)
+                continue;
+            std::cout << (t.name.empty() ? std::string("(other)") : t.name) << ": allocs="
+                      << t.counts.allocs << " frees=" << t.counts.frees
+                      << " bytes=" << t.counts.bytes << (t.hot ? " [hot]" : "") << "\n";
+        }
+        if (frames > 0)
+            std::cout << "Hot-path allocs per frame: "
+                      << static_cast<double>(allocs.hot.allocs) / static_cast<double>(frames)
+                      << "\n";
+    }
 
     g_gateway = nullptr;
     return 0;
@@ -0,0 +1,154 @@
+#include "gateway/ingress_filter.h"
+#include "common/types.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace nng {
+namespace {
+
+std::string trim_upper(const std::string& s) {
+    auto start = s.find_first_not_of(" \t");
+    if (start == std::string::npos)
+        return std::string();
+    auto end = s.find_last_not_of(" \t");
+    std::string out = s.substr(start, end - start + 1);
+    std::transform(out.begin(), out.end(), out.begin(), ::toupper);
+    return out;
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::string part;
+    std::istringstream iss(s);
+    while (std::getline(iss, part, sep))
+        parts.push_back(part);
+    return parts;
+}
+
+// Decimal or 0x-prefixed hex, no trailing junk
+bool parse_number(const std::string& s, unsigned long max, unsigned long& out) {
+    if (s.empty())
+        return false;
+    try {
+        std::size_t used = 0;
+        out = std::stoul(s, &used, 0);
+        return used == s.size() && out <= max;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool parse_msg_type(const std::string& s, unsigned long& out) {
+    static const struct { const char* name; MsgType type; } names[] = {
+        {"PLOT", MsgType::PLOT},
+        {"TRACK", MsgType::TRACK},
+        {"HEARTBEAT", MsgType::HEARTBEAT},
+        {"ENGAGEMENT", MsgType::ENGAGEMENT},
+        {"TRACK_DELTA", MsgType::TRACK_DELTA},
+    };
+    for (const auto& n : names) {
+        if (s == n.name) {
+            out = static_cast<uint8_t>(n.type);
+            return true;
+        }
+    }
+    return parse_number(s, 255, out);
+}
+
+void set_bit(uint64_t* bits, unsigned long i) {
+    bits[i >> 6] |= 1ULL << (i & 63);
+}
+
+} // anonymous namespace
+
+IngressFilter::IngressFilter() {
+    tables_.push_back(std::make_unique<Table>());
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+IngressFilter::~IngressFilter() = default;
+
+bool IngressFilter::compile(const std::string& spec, Table& out, std::string& error) {
+    std::string upper = trim_upper(spec);
+    if (upper.empty() || upper == "ALL" || upper == "OFF")
+        return true; // Table defaults to accept-all
+
+    bool have_types = false;
+    bool have_sources = false;
+    for (const auto& raw : split(upper, ';')) {
+        std::string clause = trim_upper(raw);
+        if (clause.empty())
+            continue;
+        auto eq = clause.find('=');
+        if (eq == std::string::npos) {
+            error = "expected key=values in '" + clause + "'";
+            return false;
+        }
+        std::string key = trim_upper(clause.substr(0, eq));
+        auto values = split(clause.substr(eq + 1), ',');
+
+        if (key == "TYPE") {
+            have_types = true;
+            for (const auto& v : values) {
+                unsigned long t = 0;
+                if (!parse_msg_type(trim_upper(v), t)) {
+                    error = "bad msg_type '" + trim_upper(v) + "'";
+                    return false;
+                }
+                set_bit(out.types, t);
+            }
+        } else if (key == "SRC") {
+            have_sources = true;
+            for (const auto& v : values) {
+                std::string item = trim_upper(v);
+                auto dash = item.find('-');
+                unsigned long lo = 0;
+                unsigned long hi = 0;
+                bool ok = dash == std::string::npos
+                    ? parse_number(item, 0xFFFF, lo) && (hi = lo, true)
+                    : parse_number(trim_upper(item.substr(0, dash)), 0xFFFF, lo) &&
+                      parse_number(trim_upper(item.substr(dash + 1)), 0xFFFF, hi) && lo <= hi;
+                if (!ok) {
+                    error = "bad src_id '" + item + "'";
+                    return false;
+                }
+                for (unsigned long s = lo; s <= hi; ++s)
+                    set_bit(out.sources, s);
+            }
+        } else {
+            error = "unknown filter key '" + key + "'";
+            return false;
+        }
+    }
+
+    if (!have_types)
+        std::fill(std::begin(out.types), std::end(out.types), ~0ULL);
+    if (!have_sources)
+        std::fill(std::begin(out.sources), std::end(out.sources), ~0ULL);
+    out.all = !have_types && !have_sources;
+    out.spec = out.all ? "ALL" : upper;
+    return true;
+}
+
+bool IngressFilter::set(const std::string& spec, std::string* error) {
+    auto table = std::make_unique<Table>();
+    std::string err;
+    if (!compile(spec, *table, err)) {
+        if (error)
+            *error = err;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    table_.store(table.get(), std::memory_order_release);
+    tables_.push_back(std::move(table));
+    return true;
+}
+
+std::string IngressFilter::spec() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return table_.load(std::memory_order_acquire)->spec;
+}
+
+} // namespace nng
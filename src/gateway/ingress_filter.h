@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+// Early-drop filter on (src_id, msg_type), applied by parse_frames() as
+// soon as a frame's header is read, before CRC, sequence tracking and
+// stats. Rules are compiled into bitmaps, so a check is two bit tests.
+//
+// Spec syntax (case-insensitive), clauses separated by ';':
+//   type=TRACK,ENGAGEMENT   msg_type names or numbers
+//   src=1-8,12,0x20         src_id values and inclusive ranges
+// A dimension without a clause accepts everything. "", "ALL" and "OFF"
+// accept all frames.
+//
+// set() may be called from any thread while ingest threads call allows():
+// a new table is published atomically and old tables are kept until the
+// filter is destroyed (updates are rare and each table is ~8 KB).
+class IngressFilter {
+public:
+    IngressFilter();
+    ~IngressFilter();
+
+    IngressFilter(const IngressFilter&) = delete;
+    IngressFilter& operator=(const IngressFilter&) = delete;
+
+    // Replace the rules. On a syntax error the rules are left unchanged,
+    // false is returned and error (if given) says why.
+    bool set(const std::string& spec, std::string* error = nullptr);
+
+    // The spec in effect, normalised ("ALL" when accepting everything)
+    std::string spec() const;
+
+    bool accepts_all() const {
+        return table_.load(std::memory_order_acquire)->all;
+    }
+
+    bool allows(uint16_t src_id, uint8_t msg_type) const {
+        const Table* t = table_.load(std::memory_order_acquire);
+        return t->all ||
+               (((t->types[msg_type >> 6] >> (msg_type & 63)) & 1) &&
+                ((t->sources[src_id >> 6] >> (src_id & 63)) & 1));
+    }
+
+private:
+    struct Table {
+        bool all = true;
+        uint64_t types[256 / 64] = {};
+        uint64_t sources[65536 / 64] = {};
+        std::string spec = "ALL";
+    };
+
+    static bool compile(const std::string& spec, Table& out, std::string& error);
+
+    std::atomic<const Table*> table_;
+    mutable std::mutex mutex_; // serialises set(); guards tables_
+    std::vector<std::unique_ptr<Table>> tables_; // current and retired
+};
+
+} // namespace nng
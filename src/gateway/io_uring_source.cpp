@@ -0,0 +1,262 @@
+#include "gateway/io_uring_source.h"
+#include "gateway/udp_socket.h"
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+namespace nng {
+namespace {
+
+constexpr unsigned SQ_ENTRIES = 8;
+constexpr uint16_t BUF_GROUP = 0;
+constexpr uint64_t RECV_TAG = 1;
+
+int sys_io_uring_setup(unsigned entries, struct io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags, const void* arg, std::size_t argsz) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                                      flags, arg, argsz));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+void* map_ring(std::size_t size, int fd, off_t offset) {
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, offset);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+template <typename T>
+T* at_offset(void* base, uint32_t off) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + off);
+}
+
+} // anonymous namespace
+
+IoUringFrameSource::IoUringFrameSource()
+    : buffers_(BUF_COUNT), single_(1) {
+    lent_.reserve(BUF_COUNT);
+}
+
+IoUringFrameSource::~IoUringFrameSource() {
+    close();
+}
+
+bool IoUringFrameSource::bind(uint16_t port, bool reuse_port) {
+    close();
+
+    sockfd_ = bind_udp_socket(port, reuse_port);
+    if (sockfd_ < 0)
+        return false;
+
+    if (!setup_ring() || !setup_buffers() || !arm_recv()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool IoUringFrameSource::setup_ring() {
+    struct io_uring_params p{};
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = 4 * BUF_COUNT; // room for every buffer to complete at once
+
+    ring_fd_ = sys_io_uring_setup(SQ_ENTRIES, &p);
+    if (ring_fd_ < 0)
+        return false;
+
+    // Timed waits need IORING_ENTER_EXT_ARG
+    if (!(p.features & IORING_FEAT_EXT_ARG))
+        return false;
+
+    sq_ring_sz_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_sz_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_sz_ = std::max(sq_ring_sz_, cq_ring_sz_);
+        cq_ring_sz_ = sq_ring_sz_;
+    }
+
+    sq_ptr_ = map_ring(sq_ring_sz_, ring_fd_, IORING_OFF_SQ_RING);
+    if (!sq_ptr_)
+        return false;
+    cq_ptr_ = single_mmap ? sq_ptr_ : map_ring(cq_ring_sz_, ring_fd_, IORING_OFF_CQ_RING);
+    if (!cq_ptr_)
+        return false;
+
+    sqes_sz_ = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(map_ring(sqes_sz_, ring_fd_, IORING_OFF_SQES));
+    if (!sqes_)
+        return false;
+
+    sq_tail_  = at_offset<unsigned>(sq_ptr_, p.sq_off.tail);
+    sq_mask_  = at_offset<unsigned>(sq_ptr_, p.sq_off.ring_mask);
+    sq_array_ = at_offset<unsigned>(sq_ptr_, p.sq_off.array);
+    cq_head_  = at_offset<unsigned>(cq_ptr_, p.cq_off.head);
+    cq_tail_  = at_offset<unsigned>(cq_ptr_, p.cq_off.tail);
+    cq_mask_  = at_offset<unsigned>(cq_ptr_, p.cq_off.ring_mask);
+    cqes_     = at_offset<io_uring_cqe>(cq_ptr_, p.cq_off.cqes);
+    return true;
+}
+
+bool IoUringFrameSource::setup_buffers() {
+    buf_ring_sz_ = BUF_COUNT * sizeof(struct io_uring_buf);
+    void* mem = ::mmap(nullptr, buf_ring_sz_, PROT_READ | PROT_WRITE,
+                       MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (mem == MAP_FAILED)
+        return false;
+    buf_ring_ = static_cast<io_uring_buf_ring*>(mem);
+
+    struct io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(mem);
+    reg.ring_entries = BUF_COUNT;
+    reg.bgid = BUF_GROUP;
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+        return false;
+
+    // Hand every buffer to the kernel
+    buf_tail_ = 0;
+    for (uint16_t bid = 0; bid < BUF_COUNT; ++bid)
+        lent_.push_back(bid);
+    recycle_buffers();
+    return true;
+}
+
+bool IoUringFrameSource::arm_recv() {
+    // Single producer: we are the only writer of the SQ tail
+    unsigned tail = *sq_tail_;
+    unsigned idx = tail & *sq_mask_;
+
+    io_uring_sqe* sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = sockfd_;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = RECV_TAG;
+
+    sq_array_[idx] = idx;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+    armed_ = sys_io_uring_enter(ring_fd_, 1, 0, 0, nullptr, 0) == 1;
+    return armed_;
+}
+
+bool IoUringFrameSource::wait_cqe() {
+    struct __kernel_timespec ts{};
+    ts.tv_sec = timeout_ms_ / 1000;
+    ts.tv_nsec = static_cast<long long>(timeout_ms_ % 1000) * 1000000;
+
+    struct io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = timeout_ms_ >= 0 ? reinterpret_cast<uint64_t>(&ts) : 0;
+
+    int ret = sys_io_uring_enter(ring_fd_, 0, 1,
+                                 IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                 &arg, sizeof(arg));
+    return ret >= 0; // -ETIME on timeout
+}
+
+void IoUringFrameSource::recycle_buffers() {
+    if (lent_.empty())
+        return;
+    // Index entries from the ring base rather than via buf_ring_->bufs: in
+    // C++ the header's __DECLARE_FLEX_ARRAY shifts bufs past the tail word.
+    auto* bufs = reinterpret_cast<struct io_uring_buf*>(buf_ring_);
+    for (uint16_t bid : lent_) {
+        struct io_uring_buf* b = &bufs[buf_tail_ & (BUF_COUNT - 1)];
+        b->addr = reinterpret_cast<uint64_t>(buffers_.slot(bid));
+        b->len = static_cast<uint32_t>(FramePool::SLOT_SIZE);
+        b->bid = bid;
+        ++buf_tail_;
+    }
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+    lent_.clear();
+}
+
+std::size_t IoUringFrameSource::receive_batch(FrameBatch& batch) {
+    batch.clear();
+    if (ring_fd_ < 0)
+        return 0;
+
+    // Views from the previous batch are dead now: return their buffers
+    recycle_buffers();
+
+    // Multishot ends on ENOBUFS or errors; re-arm once buffers are back
+    if (!armed_ && !arm_recv())
+        return 0;
+
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        if (!wait_cqe())
+            return 0;
+        tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    }
+
+    while (head != tail && !batch.full()) {
+        const io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+        ++head;
+
+        if (!(cqe->flags & IORING_CQE_F_MORE))
+            armed_ = false;
+
+        if (cqe->res < 0 || !(cqe->flags & IORING_CQE_F_BUFFER))
+            continue;
+
+        auto bid = static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        lent_.push_back(bid);
+        auto len = std::min(static_cast<std::size_t>(cqe->res), FramePool::SLOT_SIZE);
+        batch.commit_view(buffers_.slot(bid), len);
+    }
+
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return batch.size();
+}
+
+bool IoUringFrameSource::receive(std::vector<uint8_t>& buf) {
+    if (receive_batch(single_) == 0) {
+        buf.clear();
+        return false;
+    }
+    buf.assign(single_[0].data, single_[0].data + single_[0].len);
+    return true;
+}
+
+void IoUringFrameSource::close() {
+    if (sqes_)
+        ::munmap(sqes_, sqes_sz_);
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+        ::munmap(cq_ptr_, cq_ring_sz_);
+    if (sq_ptr_)
+        ::munmap(sq_ptr_, sq_ring_sz_);
+    if (ring_fd_ >= 0)
+        ::close(ring_fd_);
+    if (buf_ring_)
+        ::munmap(buf_ring_, buf_ring_sz_);
+    if (sockfd_ >= 0)
+        ::close(sockfd_);
+
+    sqes_ = nullptr;
+    cq_ptr_ = nullptr;
+    sq_ptr_ = nullptr;
+    buf_ring_ = nullptr;
+    ring_fd_ = -1;
+    sockfd_ = -1;
+    armed_ = false;
+    lent_.clear();
+}
+
+} // namespace nng
@@ -0,0 +1,85 @@
+#pragma once
+#include "gateway/frame_source.h"
+#include "gateway/frame_pool.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace nng {
+
+// UDP frame source driven by io_uring: one multishot IORING_OP_RECV stays
+// armed on the socket and the kernel picks receive buffers from a
+// registered provided-buffer ring. receive_batch() only reaps completions,
+// so there is no poll()+recvfrom() pair per datagram and, when traffic is
+// flowing, no syscall at all. Frames are handed out as views into the
+// provided buffers, which are recycled on the next receive_batch() call.
+//
+// Uses the raw io_uring syscalls (no liburing). bind() returns false if the
+// kernel lacks io_uring, provided buffer rings or multishot recv; callers
+// are expected to fall back to UdpFrameSource.
+class IoUringFrameSource : public IFrameSource {
+public:
+    // Provided receive buffers (power of two), each FramePool::SLOT_SIZE
+    static constexpr unsigned BUF_COUNT = 256;
+
+    IoUringFrameSource();
+    ~IoUringFrameSource() override;
+
+    // Bind a UDP socket, set up the ring and buffers, and arm the receive
+    bool bind(uint16_t port, bool reuse_port = false);
+
+    // Receive one datagram (copied out of the provided buffer)
+    bool receive(std::vector<uint8_t>& buf) override;
+
+    // Reap up to batch.capacity() completions, waiting up to the timeout for
+    // the first one. Frames are zero-copy views into the buffer ring.
+    std::size_t receive_batch(FrameBatch& batch) override;
+
+    void close();
+
+    // Set receive timeout in milliseconds (negative = wait indefinitely)
+    void set_timeout_ms(int ms) { timeout_ms_ = ms; }
+
+    bool is_open() const { return ring_fd_ >= 0; }
+
+private:
+    bool setup_ring();
+    bool setup_buffers();
+    bool arm_recv();
+    bool wait_cqe();
+    void recycle_buffers();
+
+    int sockfd_ = -1;
+    int ring_fd_ = -1;
+    int timeout_ms_ = 100;
+    bool armed_ = false;
+
+    // Mapped SQ/CQ rings
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    std::size_t sq_ring_sz_ = 0;
+    std::size_t cq_ring_sz_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_sz_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    // Provided buffer ring and its backing slab
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    std::size_t buf_ring_sz_ = 0;
+    uint16_t buf_tail_ = 0;
+    FramePool buffers_;
+    std::vector<uint16_t> lent_; // buffer ids handed out by the last batch
+    FrameBatch single_;          // backing batch for receive()
+};
+
+} // namespace nng
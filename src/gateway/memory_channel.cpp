@@ -0,0 +1,84 @@
+#include "gateway/memory_channel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace nng {
+
+class MemoryFrameChannel::Source : public IFrameSource {
+public:
+    Source(MemoryFrameChannel& ch, int timeout_ms) : ch_(ch), timeout_ms_(timeout_ms) {}
+
+    bool receive(std::vector<uint8_t>& buf) override {
+        FrameBatch one(1);
+        if (receive_batch(one) == 0)
+            return false;
+        buf.assign(one[0].data, one[0].data + one[0].len);
+        return true;
+    }
+
+    std::size_t receive_batch(FrameBatch& batch) override {
+        batch.clear();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+        while (true) {
+            std::size_t n = ch_.pop(batch);
+            if (n > 0 || std::chrono::steady_clock::now() >= deadline)
+                return n;
+            // Short naps: a sender rarely leaves the channel idle for long
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+private:
+    MemoryFrameChannel& ch_;
+    int timeout_ms_;
+};
+
+MemoryFrameChannel::MemoryFrameChannel(std::size_t capacity)
+    : pool_(round_up_pow2(capacity > 0 ? capacity : 1)),
+      free_(pool_.slot_count()),
+      filled_(pool_.slot_count()),
+      sink_(*this) {
+    for (std::size_t i = 0; i < pool_.slot_count(); ++i)
+        free_.try_push(static_cast<uint32_t>(i));
+}
+
+std::unique_ptr<IFrameSource> MemoryFrameChannel::source(int timeout_ms) {
+    return std::make_unique<Source>(*this, timeout_ms);
+}
+
+bool MemoryFrameChannel::push(const uint8_t* data, std::size_t len) {
+    uint32_t slot;
+    if (!free_.try_pop(slot)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    len = std::min(len, FramePool::SLOT_SIZE);
+    if (len > 0)
+        std::memcpy(pool_.slot(slot), data, len);
+    // Cannot fail: there are as many filled_ entries as slots
+    filled_.try_push(Entry{slot, static_cast<uint32_t>(len)});
+    sent_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+std::size_t MemoryFrameChannel::pop(FrameBatch& batch) {
+    Entry e;
+    while (!batch.full() && filled_.try_pop(e)) {
+        if (e.len > 0)
+            std::memcpy(batch.next_slot(), pool_.slot(e.slot), e.len);
+        batch.commit(e.len);
+        free_.try_push(e.slot);
+    }
+    return batch.size();
+}
+
+std::size_t MemoryFrameChannel::Sink::send_batch(const FrameView* frames, std::size_t count) {
+    std::size_t sent = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        sent += ch_.push(frames[i].data, frames[i].len) ? 1 : 0;
+    return sent;
+}
+
+} // namespace nng
@@ -0,0 +1,70 @@
+#pragma once
+#include "common/spsc_ring.h"
+#include "gateway/frame_pool.h"
+#include "gateway/frame_source.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nng {
+
+// In-process datagram pipe: one thread sends through sink(), one thread
+// receives through a source() given to a Gateway (GatewayConfig::
+// source_factory), with no socket in between. Frames are copied into a
+// fixed pool of FramePool::SLOT_SIZE slots; like a full socket buffer, a
+// send finding every slot taken drops the frame and counts it. Lock-free
+// (two SPSC rings of slot indices), no allocation after construction.
+class MemoryFrameChannel {
+public:
+    explicit MemoryFrameChannel(std::size_t capacity = 4096);
+
+    MemoryFrameChannel(const MemoryFrameChannel&) = delete;
+    MemoryFrameChannel& operator=(const MemoryFrameChannel&) = delete;
+
+    // Producer end (one thread)
+    IFrameSink& sink() { return sink_; }
+
+    // Consumer end (one thread). receive_batch() waits up to timeout_ms for
+    // the first frame, then takes whatever else is queued. The source
+    // refers to the channel, which must outlive it.
+    std::unique_ptr<IFrameSource> source(int timeout_ms = 100);
+
+    std::size_t capacity() const { return pool_.slot_count(); }
+    uint64_t sent() const { return sent_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint32_t slot;
+        uint32_t len;
+    };
+
+    class Sink : public IFrameSink {
+    public:
+        explicit Sink(MemoryFrameChannel& ch) : ch_(ch) {}
+        bool send(const std::vector<uint8_t>& buf) override {
+            return ch_.push(buf.data(), buf.size());
+        }
+        // Every frame is offered; returns the number that found a slot
+        std::size_t send_batch(const FrameView* frames, std::size_t count) override;
+
+    private:
+        MemoryFrameChannel& ch_;
+    };
+
+    class Source;
+
+    bool push(const uint8_t* data, std::size_t len);
+    std::size_t pop(FrameBatch& batch);
+
+    FramePool pool_;
+    SpscRing<uint32_t> free_;  // consumer -> producer
+    SpscRing<Entry> filled_;   // producer -> consumer
+    Sink sink_;
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace nng
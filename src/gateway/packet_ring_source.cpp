@@ -0,0 +1,265 @@
+#include "gateway/packet_ring_source.h"
+#include "gateway/udp_socket.h"
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+
+#ifndef PACKET_IGNORE_OUTGOING
+#define PACKET_IGNORE_OUTGOING 23
+#endif
+
+namespace nng {
+namespace {
+
+constexpr std::size_t IPV4_MIN_HEADER = 20;
+constexpr std::size_t UDP_HEADER = 8;
+constexpr uint8_t IPPROTO_UDP_NUM = 17;
+
+tpacket_block_desc* block_desc(uint8_t* ring, std::size_t block) {
+    return reinterpret_cast<tpacket_block_desc*>(
+        ring + block * PacketRingFrameSource::BLOCK_SIZE);
+}
+
+uint16_t load_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// Locate the UDP payload for dst port in an IPv4 packet. Returns false for
+// anything else (other ports, fragments, truncated or malformed headers).
+bool udp_payload(const uint8_t* ip, std::size_t len, uint16_t port, FrameView& out) {
+    if (len < IPV4_MIN_HEADER || (ip[0] >> 4) != 4)
+        return false;
+    std::size_t ihl = static_cast<std::size_t>(ip[0] & 0x0F) * 4;
+    if (ihl < IPV4_MIN_HEADER || len < ihl + UDP_HEADER)
+        return false;
+    if (ip[9] != IPPROTO_UDP_NUM || (load_be16(ip + 6) & 0x3FFF) != 0)
+        return false;
+
+    const uint8_t* udp = ip + ihl;
+    if (load_be16(udp + 2) != port)
+        return false;
+    std::size_t udp_len = load_be16(udp + 4);
+    if (udp_len < UDP_HEADER || udp_len > len - ihl)
+        return false;
+
+    out = FrameView{udp + UDP_HEADER, udp_len - UDP_HEADER};
+    return true;
+}
+
+// cBPF: accept unfragmented IPv4/UDP to port, drop the rest. The packet
+// socket is SOCK_DGRAM, so offsets start at the IP header.
+bool attach_port_filter(int fd, uint16_t port) {
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 9),                 // ip proto
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP_NUM, 0, 6),
+        BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 6),                 // frag bits
+        BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x3FFF, 4, 0),
+        BPF_STMT(BPF_LDX | BPF_B   | BPF_MSH, 0),                 // x = ihl
+        BPF_STMT(BPF_LD  | BPF_H   | BPF_IND, 2),                 // udp dport
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, port, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct sock_fprog prog{};
+    prog.len = static_cast<unsigned short>(sizeof(code) / sizeof(code[0]));
+    prog.filter = code;
+    return ::setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0;
+}
+
+bool attach_drop_filter(int fd) {
+    struct sock_filter code[] = { BPF_STMT(BPF_RET | BPF_K, 0) };
+    struct sock_fprog prog{};
+    prog.len = 1;
+    prog.filter = code;
+    return ::setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0;
+}
+
+} // anonymous namespace
+
+PacketRingFrameSource::~PacketRingFrameSource() {
+    close();
+}
+
+bool PacketRingFrameSource::bind(const std::string& interface, uint16_t port, bool fanout) {
+    close();
+    port_ = port;
+
+    unsigned ifindex = ::if_nametoindex(interface.c_str());
+    if (ifindex == 0)
+        return false;
+
+    fd_ = ::socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (fd_ < 0)
+        return false;
+
+    if (!attach_port_filter(fd_, port) || !setup_ring()) {
+        close();
+        return false;
+    }
+
+    // Loopback shows every datagram twice; keep only the inbound copy
+    int one = 1;
+    ::setsockopt(fd_, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one));
+
+    struct sockaddr_ll addr{};
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_IP);
+    addr.sll_ifindex = static_cast<int>(ifindex);
+    if (::bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close();
+        return false;
+    }
+
+    if (fanout) {
+        int arg = port | (PACKET_FANOUT_HASH << 16);
+        if (::setsockopt(fd_, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) < 0) {
+            close();
+            return false;
+        }
+    }
+
+    // Own the port so the stack neither queues nor ICMP-rejects the datagrams
+    claim_fd_ = bind_udp_socket(port, fanout);
+    if (claim_fd_ < 0 || !attach_drop_filter(claim_fd_)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool PacketRingFrameSource::setup_ring() {
+    int version = TPACKET_V3;
+    if (::setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+        return false;
+
+    struct tpacket_req3 req{};
+    req.tp_block_size = static_cast<unsigned>(BLOCK_SIZE);
+    req.tp_block_nr = static_cast<unsigned>(BLOCK_COUNT);
+    req.tp_frame_size = static_cast<unsigned>(FramePool::SLOT_SIZE);
+    req.tp_frame_nr = static_cast<unsigned>(BLOCK_SIZE * BLOCK_COUNT / FramePool::SLOT_SIZE);
+    req.tp_retire_blk_tov = BLOCK_TIMEOUT_MS;
+    if (::setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+        return false;
+
+    ring_sz_ = BLOCK_SIZE * BLOCK_COUNT;
+    void* mem = ::mmap(nullptr, ring_sz_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (mem == MAP_FAILED)
+        return false;
+    ring_ = static_cast<uint8_t*>(mem);
+    block_ = 0;
+    in_block_ = false;
+    return true;
+}
+
+bool PacketRingFrameSource::next_block() {
+    tpacket_block_desc* desc = block_desc(ring_, block_);
+    auto ready = [desc] {
+        return (__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE)
+                & TP_STATUS_USER) != 0;
+    };
+
+    if (!ready()) {
+        struct pollfd pfd{};
+        pfd.fd = fd_;
+        pfd.events = POLLIN | POLLERR;
+        if (::poll(&pfd, 1, timeout_ms_) <= 0 || !ready())
+            return false; // Timeout or error
+    }
+
+    in_block_ = true;
+    pkts_left_ = desc->hdr.bh1.num_pkts;
+    pkt_ = reinterpret_cast<const uint8_t*>(desc) + desc->hdr.bh1.offset_to_first_pkt;
+    return true;
+}
+
+void PacketRingFrameSource::release_block() {
+    tpacket_block_desc* desc = block_desc(ring_, block_);
+    __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    block_ = (block_ + 1) % BLOCK_COUNT;
+    in_block_ = false;
+}
+
+std::size_t PacketRingFrameSource::receive_batch(FrameBatch& batch) {
+    batch.clear();
+    if (fd_ < 0)
+        return 0;
+
+    // The previous batch's views pointed into a block that is now spent
+    if (in_block_ && pkts_left_ == 0)
+        release_block();
+
+    while (batch.empty()) {
+        if (!in_block_ && !next_block())
+            return 0;
+
+        while (pkts_left_ > 0 && !batch.full()) {
+            const auto* hdr = reinterpret_cast<const tpacket3_hdr*>(pkt_);
+            pkt_ += hdr->tp_next_offset;
+            --pkts_left_;
+
+            const auto* sll = reinterpret_cast<const sockaddr_ll*>(
+                reinterpret_cast<const uint8_t*>(hdr) + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+            if (sll->sll_pkttype == PACKET_OUTGOING)
+                continue;
+
+            FrameView payload;
+            if (udp_payload(reinterpret_cast<const uint8_t*>(hdr) + hdr->tp_net,
+                            hdr->tp_snaplen, port_, payload))
+                batch.commit_view(payload.data, payload.len,
+                                  static_cast<uint64_t>(hdr->tp_sec) * 1000000000ULL +
+                                  hdr->tp_nsec);
+        }
+
+        // Nothing usable in this block: hand it back and look at the next
+        if (batch.empty())
+            release_block();
+    }
+    return batch.size();
+}
+
+bool PacketRingFrameSource::receive(std::vector<uint8_t>& buf) {
+    if (receive_batch(single_) == 0) {
+        buf.clear();
+        return false;
+    }
+    buf.assign(single_[0].data, single_[0].data + single_[0].len);
+    return true;
+}
+
+uint64_t PacketRingFrameSource::ring_drops() {
+    if (fd_ >= 0) {
+        // Reading the counters resets them in the kernel
+        struct tpacket_stats_v3 st{};
+        socklen_t len = sizeof(st);
+        if (::getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &st, &len) == 0)
+            drops_ += st.tp_drops;
+    }
+    return drops_;
+}
+
+void PacketRingFrameSource::close() {
+    if (ring_)
+        ::munmap(ring_, ring_sz_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    if (claim_fd_ >= 0)
+        ::close(claim_fd_);
+
+    ring_ = nullptr;
+    fd_ = -1;
+    claim_fd_ = -1;
+    in_block_ = false;
+    pkts_left_ = 0;
+    pkt_ = nullptr;
+}
+
+} // namespace nng
@@ -0,0 +1,77 @@
+#pragma once
+#include "gateway/frame_source.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+// Kernel-bypass style capture of the telemetry UDP port: an AF_PACKET
+// socket with a memory-mapped TPACKET_V3 receive ring (PACKET_RX_RING).
+// The kernel writes whole IPv4 packets into ring blocks; receive_batch()
+// walks a block in place, strips the IP/UDP headers and hands out views of
+// the UDP payloads, so frames reach parse_frame() without a copy or a
+// per-datagram syscall. A block is returned to the kernel on the next call.
+// Frames carry the ring's kernel capture timestamp.
+//
+// A classic BPF filter keeps only UDP datagrams for the port. The port is
+// also claimed with a UDP socket that drops everything, so the kernel does
+// not answer senders with ICMP port-unreachable.
+//
+// Needs CAP_NET_RAW; bind() returns false without it.
+class PacketRingFrameSource : public IFrameSource {
+public:
+    // Ring geometry: BLOCK_COUNT blocks of BLOCK_SIZE bytes
+    static constexpr std::size_t BLOCK_SIZE  = 1 << 20;
+    static constexpr std::size_t BLOCK_COUNT = 16;
+    // A partly filled block is handed to userspace after this long
+    static constexpr unsigned BLOCK_TIMEOUT_MS = 1;
+
+    PacketRingFrameSource() = default;
+    ~PacketRingFrameSource() override;
+
+    // Capture UDP datagrams to port on the named interface ("lo", "eth0").
+    // With fanout, sockets sharing a port form a PACKET_FANOUT_HASH group so
+    // the kernel spreads flows across them.
+    bool bind(const std::string& interface, uint16_t port, bool fanout = false);
+
+    // Receive one datagram payload
+    bool receive(std::vector<uint8_t>& buf) override;
+
+    // Hand out up to batch.capacity() payloads from the current ring block,
+    // waiting up to the timeout for a block. Frames are zero-copy views.
+    std::size_t receive_batch(FrameBatch& batch) override;
+
+    void close();
+
+    // Set receive timeout in milliseconds (negative = wait indefinitely)
+    void set_timeout_ms(int ms) { timeout_ms_ = ms; }
+
+    bool is_open() const { return fd_ >= 0; }
+
+    // Packets the kernel dropped because the ring was full (cumulative)
+    uint64_t ring_drops();
+
+private:
+    bool setup_ring();
+    bool next_block();
+    void release_block();
+
+    int fd_ = -1;
+    int claim_fd_ = -1; // UDP socket holding the port
+    uint16_t port_ = 0;
+    int timeout_ms_ = 100;
+
+    uint8_t* ring_ = nullptr;
+    std::size_t ring_sz_ = 0;
+    std::size_t block_ = 0;         // block being read
+    bool in_block_ = false;         // block_ is owned by us
+    uint32_t pkts_left_ = 0;        // packets not yet walked in block_
+    const uint8_t* pkt_ = nullptr;  // next packet header in block_
+    uint64_t drops_ = 0;
+
+    FrameBatch single_{1}; // backing batch for receive()
+};
+
+} // namespace nng
@@ -0,0 +1,153 @@
+#pragma once
+#include "gateway/frame_pool.h"
+#include "gateway/telemetry_parser.h"
+#include "gateway/sequence_tracker.h"
+#include "gateway/plot_associator.h"
+#include "common/protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace nng {
+
+// Types shared by the staged gateway pipeline:
+//   receive -> validate/track -> { record, event dispatch }
+// Stages run on their own threads and hand work over through SpscRing
+// (one producer) and MpscQueue (fan-in from several workers).
+
+// What a producer does when the next stage's queue is full
+enum class QueueFullPolicy {
+    BLOCK, // wait for space (backpressure into the socket buffer)
+    DROP,  // discard and count
+};
+
+// Snapshot of one inter-stage queue. depth/high_water are in queue
+// elements (batches for rx/record, events for dispatch); dropped is in
+// frames for rx/record and events for dispatch.
+struct QueueStats {
+    uint64_t    enqueued   = 0;
+    uint64_t    dropped    = 0;
+    std::size_t depth      = 0;
+    std::size_t high_water = 0;
+};
+
+struct PipelineStats {
+    QueueStats rx;       // receive -> validate
+    QueueStats record;   // validate -> recorder
+    QueueStats dispatch; // validate -> event dispatch (bulk lane)
+    QueueStats priority; // validate -> event dispatch (priority lane)
+};
+
+// Counters for one queue (summed over ingest workers). Lock-free, so
+// stats can be read from any thread while the pipeline runs.
+class QueueMeter {
+public:
+    void on_push(std::size_t depth_after) {
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        std::size_t hw = high_water_.load(std::memory_order_relaxed);
+        while (depth_after > hw &&
+               !high_water_.compare_exchange_weak(hw, depth_after, std::memory_order_relaxed)) {}
+    }
+    void on_pop() { dequeued_.fetch_add(1, std::memory_order_relaxed); }
+    void on_drop(uint64_t n) { dropped_.fetch_add(n, std::memory_order_relaxed); }
+
+    QueueStats snapshot() const {
+        QueueStats s;
+        s.enqueued = enqueued_.load(std::memory_order_relaxed);
+        uint64_t dequeued = dequeued_.load(std::memory_order_relaxed);
+        s.depth = s.enqueued > dequeued ? static_cast<std::size_t>(s.enqueued - dequeued) : 0;
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        s.high_water = high_water_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset() {
+        enqueued_.store(0);
+        dequeued_.store(0);
+        dropped_.store(0);
+        high_water_.store(0);
+    }
+
+private:
+    std::atomic<uint64_t>    enqueued_{0};
+    std::atomic<uint64_t>    dequeued_{0};
+    std::atomic<uint64_t>    dropped_{0};
+    std::atomic<std::size_t> high_water_{0};
+};
+
+// A received batch travelling down the pipeline. Owns its frame bytes
+// (FrameBatch::detach()), so it outlives the source's next receive.
+struct RxBatch {
+    explicit RxBatch(std::size_t capacity) : frames(capacity) {}
+
+    FrameBatch  frames;
+    uint64_t    dequeue_ns = 0;
+    std::size_t worker = 0; // index of the ingest worker whose pool owns it
+};
+
+// Largest payload an event needs to be formatted from
+constexpr std::size_t MAX_EVENT_PAYLOAD =
+    sizeof(TrackPayload) > sizeof(PlotPayload) ? sizeof(TrackPayload) : sizeof(PlotPayload);
+static_assert(MAX_EVENT_PAYLOAD >= sizeof(HeartbeatPayload) &&
+              MAX_EVENT_PAYLOAD >= sizeof(EngagementPayload),
+              "MAX_EVENT_PAYLOAD must hold every event payload");
+
+// A timer that fired instead of a frame (header.src_id is the source;
+// for TRACK_LOST the payload holds the track's last TrackPayload)
+enum class TimerExpiry : uint8_t { NONE, SOURCE_TIMEOUT, TRACK_LOST };
+
+// Which queue a frame's events take to the dispatcher. Priority events
+// are published ahead of any bulk ones waiting, so a plot flood cannot
+// hold up an engagement or a critical threat.
+enum class Lane : uint8_t {
+    PRIORITY, // ENGAGEMENT, failing HEARTBEAT, HIGH/CRITICAL tracks, source timeouts
+    BULK,     // everything else (plots, routine tracks and heartbeats, faults)
+};
+
+// Everything the dispatch stage needs to format and publish a frame's
+// events, captured by value by the validate stage (no strings, no
+// pointers into frame memory).
+struct FrameOutcome {
+    TimerExpiry     expiry = TimerExpiry::NONE;
+    Lane            lane = Lane::BULK; // set by classify_lane()
+    ParseError      error = ParseError::OK;
+    std::size_t     frame_len = 0;
+    TelemetryHeader header{};
+    SeqEvent        seq{};
+    PlotAssociation assoc{};         // PLOT frames, when association is on
+    uint16_t        payload_len = 0; // bytes valid in payload
+    uint8_t         payload[MAX_EVENT_PAYLOAD] = {};
+};
+
+// Lane of an outcome from its expiry or header and captured payload
+inline Lane classify_lane(const FrameOutcome& out) {
+    if (out.expiry == TimerExpiry::SOURCE_TIMEOUT)
+        return Lane::PRIORITY;
+    if (out.error != ParseError::OK)
+        return Lane::BULK;
+    // TRACK_LOST holds the track's last TrackPayload
+    MsgType type = out.expiry == TimerExpiry::TRACK_LOST ? MsgType::TRACK
+                                                         : static_cast<MsgType>(out.header.msg_type);
+    switch (type) {
+        case MsgType::ENGAGEMENT:
+            return Lane::PRIORITY;
+        case MsgType::HEARTBEAT: {
+            if (out.payload_len < sizeof(HeartbeatPayload))
+                return Lane::BULK;
+            auto state = static_cast<SubsystemState>(HeartbeatView(out.payload).state());
+            return state == SubsystemState::ERROR || state == SubsystemState::OFFLINE ? Lane::PRIORITY
+                                                                                      : Lane::BULK;
+        }
+        case MsgType::TRACK: {
+            if (out.payload_len < sizeof(TrackPayload))
+                return Lane::BULK;
+            auto threat = static_cast<ThreatLevel>(TrackView(out.payload).threat_level());
+            return threat == ThreatLevel::HIGH || threat == ThreatLevel::CRITICAL ? Lane::PRIORITY
+                                                                                  : Lane::BULK;
+        }
+        default:
+            return Lane::BULK;
+    }
+}
+
+} // namespace nng
@@ -0,0 +1,242 @@
+#include "gateway/plot_associator.h"
+#include "common/spsc_ring.h"
+#include <algorithm>
+
+namespace nng {
+
+namespace {
+
+// Keep the grid to a few MB per worker however narrow the gates
+constexpr uint32_t MAX_AZ_BINS = 1024;
+constexpr uint32_t MAX_RANGE_BINS = 2048;
+
+// splitmix64 finalizer, as TrackTable: track ids are often sequential
+std::size_t hash_key(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<std::size_t>(key);
+}
+
+} // anonymous namespace
+
+PlotAssociator::PlotAssociator(const AssociationOptions& options)
+    : options_(options),
+      ttl_ns_(options.ttl_ms * 1000000ULL) {
+    options_.gate_az_mdeg = std::clamp<uint32_t>(options_.gate_az_mdeg, 1, FULL_CIRCLE_MDEG);
+    options_.gate_range_m = std::max<uint32_t>(options_.gate_range_m, 1);
+
+    // Cells at least a gate wide: bins of FULL_CIRCLE / az_bins are never
+    // narrower than the gate, and the outermost range bin is open-ended
+    az_bins_ = std::clamp<uint32_t>(FULL_CIRCLE_MDEG / options_.gate_az_mdeg, 1, MAX_AZ_BINS);
+    range_bins_ = std::clamp<uint32_t>(options_.max_range_m / options_.gate_range_m + 1, 1,
+                                       MAX_RANGE_BINS);
+    cell_range_m_ = std::max(options_.gate_range_m, options_.max_range_m / range_bins_ + 1);
+    heads_.assign(static_cast<std::size_t>(az_bins_) * range_bins_, NONE);
+
+    std::size_t capacity = std::max<std::size_t>(options_.capacity, 1);
+    entries_.resize(capacity);
+    free_.reserve(capacity);
+    for (std::size_t id = capacity; id-- > 0;)
+        free_.push_back(static_cast<uint32_t>(id));
+    // At most half full: probes stay short
+    index_.assign(round_up_pow2(std::max<std::size_t>(capacity * 2, 16)), NONE);
+    index_mask_ = index_.size() - 1;
+}
+
+uint32_t PlotAssociator::normalise_az(int32_t az_mdeg) {
+    int32_t az = az_mdeg % FULL_CIRCLE_MDEG;
+    return static_cast<uint32_t>(az < 0 ? az + FULL_CIRCLE_MDEG : az);
+}
+
+uint32_t PlotAssociator::az_bin(uint32_t az_mdeg) const {
+    return static_cast<uint32_t>(static_cast<uint64_t>(az_mdeg) * az_bins_ / FULL_CIRCLE_MDEG);
+}
+
+uint32_t PlotAssociator::range_bin(uint32_t range_m) const {
+    return std::min(range_m / cell_range_m_, range_bins_ - 1);
+}
+
+bool PlotAssociator::stale(const Entry& e, uint64_t now_ns) const {
+    return ttl_ns_ != 0 && now_ns > e.updated_ns && now_ns - e.updated_ns > ttl_ns_;
+}
+
+void PlotAssociator::link(uint32_t id, uint32_t cell) {
+    Entry& e = entries_[id];
+    e.cell = cell;
+    e.prev = NONE;
+    e.next = heads_[cell];
+    if (e.next != NONE)
+        entries_[e.next].prev = id;
+    heads_[cell] = id;
+}
+
+void PlotAssociator::unlink(uint32_t id) {
+    Entry& e = entries_[id];
+    if (e.prev != NONE)
+        entries_[e.prev].next = e.next;
+    else
+        heads_[e.cell] = e.next;
+    if (e.next != NONE)
+        entries_[e.next].prev = e.prev;
+}
+
+std::size_t PlotAssociator::probe(uint64_t key) const {
+    std::size_t i = hash_key(key) & index_mask_;
+    while (index_[i] != NONE && entries_[index_[i]].key != key)
+        i = (i + 1) & index_mask_;
+    return i;
+}
+
+bool PlotAssociator::update(uint16_t src_id, const TrackPayload& track, uint64_t now_ns) {
+    uint64_t key = make_key(src_id, track.track_id);
+    uint32_t az = normalise_az(track.azimuth_mdeg);
+    uint32_t cell = az_bin(az) * range_bins_ + range_bin(track.range_m);
+    std::size_t slot = probe(key);
+    uint32_t id = index_[slot];
+    if (id == NONE) {
+        if (free_.empty()) {
+            bump(dropped_);
+            return false;
+        }
+        id = free_.back();
+        free_.pop_back();
+        index_[slot] = id;
+        entries_[id].key = key;
+        link(id, cell);
+        tracks_.store(++size_, std::memory_order_relaxed);
+    } else if (entries_[id].cell != cell) {
+        unlink(id);
+        link(id, cell);
+    }
+    Entry& e = entries_[id];
+    e.updated_ns = now_ns;
+    e.az_mdeg = az;
+    e.range_m = track.range_m;
+    return true;
+}
+
+bool PlotAssociator::remove(uint16_t src_id, uint32_t track_id) {
+    uint32_t id = index_[probe(make_key(src_id, track_id))];
+    if (id == NONE)
+        return false;
+    erase(id);
+    return true;
+}
+
+void PlotAssociator::erase(uint32_t id) {
+    // Backward-shift deletion: no tombstones lengthen later probes
+    std::size_t i = probe(entries_[id].key);
+    for (std::size_t j = i;;) {
+        j = (j + 1) & index_mask_;
+        if (index_[j] == NONE)
+            break;
+        std::size_t home = hash_key(entries_[index_[j]].key) & index_mask_;
+        // Move j back into the hole at i unless its home lies in (i, j]
+        bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (!stays) {
+            index_[i] = index_[j];
+            i = j;
+        }
+    }
+    index_[i] = NONE;
+    unlink(id);
+    entries_[id].key = 0;
+    free_.push_back(id);
+    tracks_.store(--size_, std::memory_order_relaxed);
+}
+
+PlotAssociation PlotAssociator::associate(uint16_t src_id, PlotView plot, uint64_t now_ns) {
+    const uint32_t az = normalise_az(plot.azimuth_mdeg());
+    const uint32_t range = plot.range_m();
+    const double gate_az = options_.gate_az_mdeg;
+    const double gate_range = options_.gate_range_m;
+
+    // The plot's cell and its neighbours, each once however few bins
+    uint32_t az_cells[3];
+    std::size_t n_az = 0;
+    uint32_t a = az_bin(az);
+    az_cells[n_az++] = a;
+    if (az_bins_ > 1)
+        az_cells[n_az++] = (a + 1) % az_bins_;
+    if (az_bins_ > 2)
+        az_cells[n_az++] = (a + az_bins_ - 1) % az_bins_;
+    uint32_t r = range_bin(range);
+    uint32_t r_lo = r > 0 ? r - 1 : 0;
+    uint32_t r_hi = std::min(r + 1, range_bins_ - 1);
+
+    PlotAssociation best;
+    best.result = PlotAssociation::Result::CANDIDATE;
+    double best_score = 1.0;
+    bool found = false;
+    uint64_t compared = 0;
+    for (std::size_t k = 0; k < n_az; ++k) {
+        for (uint32_t rb = r_lo; rb <= r_hi; ++rb) {
+            for (uint32_t id = heads_[az_cells[k] * range_bins_ + rb]; id != NONE;) {
+                const Entry& e = entries_[id];
+                id = e.next;
+                ++compared;
+                if (options_.same_source && key_src(e.key) != src_id)
+                    continue;
+                if (stale(e, now_ns))
+                    continue;
+                int32_t d_az = static_cast<int32_t>(az) - static_cast<int32_t>(e.az_mdeg);
+                if (d_az > FULL_CIRCLE_MDEG / 2)
+                    d_az -= FULL_CIRCLE_MDEG;
+                else if (d_az <= -FULL_CIRCLE_MDEG / 2)
+                    d_az += FULL_CIRCLE_MDEG;
+                int64_t d_range = static_cast<int64_t>(range) - e.range_m;
+                double x = d_az / gate_az;
+                double y = static_cast<double>(d_range) / gate_range;
+                double score = x * x + y * y;
+                // Nearest inside the gate; the first seen on a tie
+                if (score > best_score || (found && score == best_score))
+                    continue;
+                found = true;
+                best_score = score;
+                best.track_src = key_src(e.key);
+                best.track_id = key_track(e.key);
+                best.d_az_mdeg = d_az;
+                best.d_range_m = static_cast<int32_t>(d_range);
+            }
+        }
+    }
+
+    bump(plots_);
+    bump(gated_, compared);
+    if (found) {
+        best.result = PlotAssociation::Result::ASSOCIATED;
+        bump(associated_);
+    } else {
+        bump(candidates_);
+    }
+    return best;
+}
+
+void PlotAssociator::expire(uint64_t now_ns) {
+    if (ttl_ns_ == 0 || size_ == 0)
+        return;
+    std::size_t n = std::min(SWEEP, entries_.size());
+    for (std::size_t k = 0; k < n; ++k) {
+        uint32_t id = static_cast<uint32_t>(sweep_);
+        if (entries_[id].key != 0 && stale(entries_[id], now_ns))
+            erase(id);
+        if (++sweep_ == entries_.size())
+            sweep_ = 0;
+    }
+}
+
+AssociationStats PlotAssociator::stats() const {
+    AssociationStats s;
+    s.plots = plots_.load(std::memory_order_relaxed);
+    s.associated = associated_.load(std::memory_order_relaxed);
+    s.candidates = candidates_.load(std::memory_order_relaxed);
+    s.gated = gated_.load(std::memory_order_relaxed);
+    s.tracks = tracks_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace nng
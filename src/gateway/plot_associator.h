@@ -0,0 +1,148 @@
+#pragma once
+#include "common/protocol.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nng {
+
+struct AssociationOptions {
+    bool enabled = false;
+    // Half-widths of a track's gate: a plot associates with a track when
+    // (d_az / gate_az)^2 + (d_range / gate_range)^2 <= 1
+    uint32_t gate_az_mdeg = 1000;
+    uint32_t gate_range_m = 500;
+    // Tracks and plots past this share the outermost ring of cells
+    uint32_t max_range_m = 500000;
+    std::size_t capacity = 65536; // tracks held per ingest worker
+    // A track not updated for this long is no longer gated against
+    uint64_t ttl_ms = 10000;
+    // Gate plots only against their own source's tracks (azimuth and
+    // range are relative to each sensor)
+    bool same_source = true;
+};
+
+// What association made of one plot
+struct PlotAssociation {
+    enum class Result : uint8_t {
+        NONE,       // not associated (association off, or a duplicate frame)
+        ASSOCIATED, // inside a track's gate; the nearest such track
+        CANDIDATE,  // inside no gate: a new-track candidate
+    };
+
+    Result   result = Result::NONE;
+    uint16_t track_src = 0;
+    uint32_t track_id = 0;
+    int32_t  d_az_mdeg = 0; // plot minus track, wrapped to (-180000, 180000]
+    int32_t  d_range_m = 0;
+};
+
+struct AssociationStats {
+    uint64_t plots = 0;
+    uint64_t associated = 0;
+    uint64_t candidates = 0;
+    uint64_t gated = 0;   // track comparisons made, over all plots
+    uint64_t tracks = 0;  // held now
+    uint64_t dropped = 0; // new tracks that did not fit
+
+    void merge(const AssociationStats& o) {
+        plots += o.plots;
+        associated += o.associated;
+        candidates += o.candidates;
+        gated += o.gated;
+        tracks += o.tracks;
+        dropped += o.dropped;
+    }
+};
+
+// Plot-to-track association for one ingest worker. Live tracks are
+// bucketed by position into an azimuth x range grid whose cells are at
+// least a gate wide, so a plot is only compared with the tracks in its
+// own cell and the eight around it (azimuth wrapping at 360 degrees)
+// rather than with every track: the cost per plot follows the local
+// track density, not the picture size. Elevation is not gated.
+//
+// A track update moves its entry between cell lists in O(1); entries live
+// in a fixed pool indexed by (src_id, track_id) with open addressing, so
+// nothing is allocated after construction. Written and read by the owning
+// thread only, except stats().
+class PlotAssociator {
+public:
+    explicit PlotAssociator(const AssociationOptions& options = {});
+
+    PlotAssociator(const PlotAssociator&) = delete;
+    PlotAssociator& operator=(const PlotAssociator&) = delete;
+
+    // Add or move a track; false when a new track does not fit
+    bool update(uint16_t src_id, const TrackPayload& track, uint64_t now_ns);
+    bool remove(uint16_t src_id, uint32_t track_id);
+    // Gate a plot from src_id against the live tracks
+    PlotAssociation associate(uint16_t src_id, PlotView plot, uint64_t now_ns);
+    // Remove some of the tracks past the TTL by now_ns: a bounded sweep
+    // that covers the whole pool over successive calls
+    void expire(uint64_t now_ns);
+    std::size_t size() const { return size_; }
+
+    // Any thread
+    AssociationStats stats() const;
+    std::size_t capacity() const { return entries_.size(); }
+    std::size_t cells() const { return heads_.size(); }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr int32_t FULL_CIRCLE_MDEG = 360000;
+    static constexpr std::size_t SWEEP = 64; // entries looked at per expire()
+
+    struct Entry {
+        uint64_t key = 0; // 0: free
+        uint64_t updated_ns = 0;
+        uint32_t az_mdeg = 0; // normalised to [0, 360000)
+        uint32_t range_m = 0;
+        uint32_t cell = 0;
+        uint32_t prev = NONE; // in its cell's list
+        uint32_t next = NONE;
+    };
+
+    static uint64_t make_key(uint16_t src_id, uint32_t track_id) {
+        return (static_cast<uint64_t>(src_id) + 1) << 32 | track_id;
+    }
+    static uint16_t key_src(uint64_t key) { return static_cast<uint16_t>((key >> 32) - 1); }
+    static uint32_t key_track(uint64_t key) { return static_cast<uint32_t>(key); }
+    static uint32_t normalise_az(int32_t az_mdeg);
+
+    uint32_t az_bin(uint32_t az_mdeg) const;
+    uint32_t range_bin(uint32_t range_m) const;
+    bool stale(const Entry& e, uint64_t now_ns) const;
+    void link(uint32_t id, uint32_t cell);
+    void unlink(uint32_t id);
+    // Index slot of key, or of the empty slot where it would go
+    std::size_t probe(uint64_t key) const;
+    void erase(uint32_t id);
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    AssociationOptions options_;
+    uint64_t ttl_ns_;
+    uint32_t az_bins_;
+    uint32_t range_bins_;
+    uint32_t cell_range_m_;
+    std::vector<uint32_t> heads_; // first entry of each cell, az-major
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> index_; // entry id or NONE, power-of-two size
+    std::size_t index_mask_;
+    std::size_t size_ = 0;
+    std::size_t sweep_ = 0;
+
+    std::atomic<uint64_t> plots_{0};
+    std::atomic<uint64_t> associated_{0};
+    std::atomic<uint64_t> candidates_{0};
+    std::atomic<uint64_t> gated_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> tracks_{0};
+};
+
+} // namespace nng
@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <time.h>
+#include <vector>
+
+namespace nng {
+
+// Events counted per second for windowed rates
+enum class RateMetric : uint8_t {
+    RX = 0,
+    MALFORMED,
+    GAPS,
+    REORDERS,
+    DUPLICATES,
+    CRC_FAIL,
+};
+constexpr std::size_t RATE_METRIC_COUNT = 6;
+
+// Lower-case metric name ("rx", "gaps", ...), indexed by RateMetric
+constexpr const char* RATE_METRIC_NAMES[RATE_METRIC_COUNT] = {
+    "rx", "malformed", "gaps", "reorders", "duplicates", "crc_fail",
+};
+
+// Per-second rates of every metric, indexed by RateMetric
+struct RateSet {
+    double per_sec[RATE_METRIC_COUNT] = {};
+
+    double operator[](RateMetric m) const { return per_sec[static_cast<std::size_t>(m)]; }
+};
+
+// Rates over the last 1, 10 and 60 completed seconds
+struct WindowedRates {
+    RateSet last_1s;
+    RateSet last_10s;
+    RateSet last_60s;
+};
+
+// Event counts over a span of seconds, indexed by RateMetric
+struct RateCounts {
+    uint64_t count[RATE_METRIC_COUNT] = {};
+
+    uint64_t operator[](RateMetric m) const { return count[static_cast<std::size_t>(m)]; }
+};
+
+// Seconds on a coarse monotonic clock (cheap enough to read per frame)
+inline uint32_t rate_clock_seconds() {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return static_cast<uint32_t>(ts.tv_sec);
+}
+
+// Ring of per-second buckets covering the last SLOTS seconds. add() is O(1):
+// it lands in slot second % SLOTS, clearing the slot first when it still
+// holds an older second. One writer, any number of readers (relaxed
+// atomics; a reader racing with a slot being recycled may miss a few
+// counts of that second).
+class RateWindow {
+public:
+    static constexpr std::size_t SLOTS = 64; // > the longest window (60 s)
+
+    void add(RateMetric m, uint32_t n, uint32_t now_s) {
+        Slot& s = slots_[now_s % SLOTS];
+        if (s.second.load(std::memory_order_relaxed) != now_s) {
+            for (auto& c : s.counts)
+                c.store(0, std::memory_order_relaxed);
+            s.second.store(now_s, std::memory_order_relaxed);
+        }
+        auto& c = s.counts[static_cast<std::size_t>(m)];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // Add the counts of the `seconds` seconds ending at last_s (inclusive;
+    // at most SLOTS seconds are remembered)
+    void sum(uint32_t last_s, uint32_t seconds, RateCounts& out) const {
+        if (seconds > SLOTS)
+            seconds = SLOTS;
+        for (uint32_t k = 0; k < seconds; ++k) {
+            uint32_t sec = last_s - k;
+            const Slot& s = slots_[sec % SLOTS];
+            if (s.second.load(std::memory_order_relaxed) != sec)
+                continue;
+            for (std::size_t i = 0; i < RATE_METRIC_COUNT; ++i)
+                out.count[i] += s.counts[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Writer side: fold in another window's seconds. Where the two hold
+    // different seconds in a slot, the newer one is kept.
+    void merge(const RateWindow& other) {
+        for (std::size_t i = 0; i < SLOTS; ++i) {
+            const Slot& o = other.slots_[i];
+            Slot& s = slots_[i];
+            uint32_t theirs = o.second.load(std::memory_order_relaxed);
+            uint32_t ours = s.second.load(std::memory_order_relaxed);
+            if (theirs == EMPTY || (ours != EMPTY && static_cast<int32_t>(ours - theirs) > 0))
+                continue;
+            if (ours != theirs) {
+                for (auto& c : s.counts)
+                    c.store(0, std::memory_order_relaxed);
+                s.second.store(theirs, std::memory_order_relaxed);
+            }
+            for (std::size_t m = 0; m < RATE_METRIC_COUNT; ++m) {
+                s.counts[m].store(s.counts[m].load(std::memory_order_relaxed) +
+                                  o.counts[m].load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void reset() {
+        for (auto& s : slots_)
+            s.second.store(EMPTY, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    struct Slot {
+        std::atomic<uint32_t> second{EMPTY};
+        std::atomic<uint32_t> counts[RATE_METRIC_COUNT] = {};
+    };
+
+    Slot slots_[SLOTS];
+};
+
+// Rates over the 1, 10 and 60 completed seconds before now_s, summed over
+// several windows (e.g. one per stats shard)
+inline WindowedRates windowed_rates(const std::vector<const RateWindow*>& windows,
+                                    uint32_t now_s) {
+    WindowedRates r;
+    auto fill = [&](RateSet& set, uint32_t seconds) {
+        RateCounts c;
+        for (const RateWindow* w : windows)
+            w->sum(now_s - 1, seconds, c);
+        for (std::size_t i = 0; i < RATE_METRIC_COUNT; ++i)
+            set.per_sec[i] = static_cast<double>(c.count[i]) / seconds;
+    };
+    fill(r.last_1s, 1);
+    fill(r.last_10s, 10);
+    fill(r.last_60s, 60);
+    return r;
+}
+
+} // namespace nng
@@ -0,0 +1,101 @@
+#pragma once
+#include "common/types.h"
+#include "common/compression.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace nng {
+
+// Recording file format v2 (chunked, indexed). All integers little-endian.
+//
+//   RecordingFileHeader, zero-padded to header_bytes
+//   chunk 0: ChunkHeader, payload, zero padding to disk_bytes
+//   chunk 1 ...
+//   ChunkIndexEntry[chunk_count]
+//   RecordingTrailer (last 16 bytes of the file)
+//
+// A chunk payload is a run of frame records, [u64 rx_ts_ns][u32 len][len
+// bytes], the same records the legacy format (v1) streams without any
+// header. Frames never span chunks. The index lets a reader find a chunk by
+// frame number or timestamp without reading the ones before it; a file
+// whose writer died before writing the index can still be read by walking
+// the chunk headers.
+
+constexpr char     RECORDING_MAGIC[8] = {'N', 'N', 'G', 'R', 'E', 'C', '0', '2'};
+constexpr uint32_t RECORDING_VERSION = 2;
+constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;   // "CHNK"
+constexpr uint32_t TRAILER_MAGIC = 0x5844494E; // "NIDX"
+constexpr std::size_t FRAME_RECORD_HEADER = sizeof(uint64_t) + sizeof(uint32_t);
+constexpr std::size_t SRC_BITMAP_BITS = 1024;
+
+// Payload codec; chosen per chunk (a chunk that does not shrink is stored raw)
+using ChunkCodec = Codec;
+
+#pragma pack(push, 1)
+
+struct RecordingFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_bytes; // offset of the first chunk
+    uint32_t chunk_bytes;  // chunk size the writer used (header included)
+    uint32_t flags;
+    uint64_t created_ns;   // CLOCK_REALTIME at open
+    uint8_t  reserved[32];
+};
+static_assert(sizeof(RecordingFileHeader) == 64, "RecordingFileHeader must be 64 bytes");
+
+struct ChunkHeader {
+    uint32_t magic;          // CHUNK_MAGIC
+    uint16_t codec;          // ChunkCodec of the payload
+    uint16_t flags;
+    uint32_t stored_bytes;   // payload bytes in the file
+    uint32_t raw_bytes;      // payload bytes once decoded
+    uint32_t disk_bytes;     // header + stored payload + padding
+    uint32_t frame_count;
+    uint64_t first_frame;    // recording-wide number of the first frame
+    uint64_t min_ts_ns;
+    uint64_t max_ts_ns;
+    // Bit src_id % SRC_BITMAP_BITS is set for every source with a frame in
+    // the chunk: exact for src_id < 1024, "maybe" above
+    uint8_t  src_bitmap[SRC_BITMAP_BITS / 8];
+};
+static_assert(sizeof(ChunkHeader) == 176, "ChunkHeader must be 176 bytes");
+
+struct ChunkIndexEntry {
+    uint64_t    offset; // of the ChunkHeader
+    ChunkHeader header;
+};
+
+struct RecordingTrailer {
+    uint64_t index_offset;
+    uint32_t chunk_count;
+    uint32_t magic;        // TRAILER_MAGIC
+};
+static_assert(sizeof(RecordingTrailer) == 16, "RecordingTrailer must be 16 bytes");
+
+#pragma pack(pop)
+
+inline bool chunk_may_contain(const ChunkHeader& h, uint16_t src_id) {
+    std::size_t bit = src_id % SRC_BITMAP_BITS;
+    return (h.src_bitmap[bit / 8] >> (bit % 8)) & 1;
+}
+
+inline void chunk_mark_source(ChunkHeader& h, uint16_t src_id) {
+    std::size_t bit = src_id % SRC_BITMAP_BITS;
+    h.src_bitmap[bit / 8] = static_cast<uint8_t>(h.src_bitmap[bit / 8] | (1u << (bit % 8)));
+}
+
+// src_id of a recorded datagram: the v1 header's, or for a v2 container
+// its first frame's. False if the datagram is too short to tell.
+inline bool recorded_src_id(const uint8_t* data, std::size_t len, uint16_t& src_id) {
+    std::size_t at = 2;
+    if (len > 0 && data[0] == PROTOCOL_VERSION_V2)
+        at = CONTAINER_HEADER_SIZE + 2;
+    if (len < at + sizeof(uint16_t))
+        return false;
+    std::memcpy(&src_id, data + at, sizeof(src_id));
+    return true;
+}
+
+} // namespace nng
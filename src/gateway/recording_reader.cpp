@@ -0,0 +1,469 @@
+#include "gateway/recording_reader.h"
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nng {
+namespace {
+
+void backoff(unsigned& idle) {
+    ++idle;
+    if (idle < 64)
+        return;
+    if (idle < 256)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+} // anonymous namespace
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+bool RecordingReader::open(const std::string& path, bool mapped) {
+    close();
+    file_.open(path, std::ios::binary);
+    if (!file_.is_open())
+        return false;
+    if (mapped)
+        mapped_ = map_file(path);
+
+    RecordingFileHeader fh{};
+    file_.read(reinterpret_cast<char*>(&fh), sizeof(fh));
+    chunked_ = file_.gcount() == static_cast<std::streamsize>(sizeof(fh)) &&
+               std::memcmp(fh.magic, RECORDING_MAGIC, sizeof(fh.magic)) == 0;
+    file_.clear();
+
+    if (!chunked_)
+        return rewind();
+
+    header_bytes_ = fh.header_bytes;
+    if (fh.version != RECORDING_VERSION || !load_index()) {
+        close();
+        return false;
+    }
+    path_ = path;
+    if (read_ahead_ > 0)
+        start_prefetch(0);
+    return true;
+}
+
+void RecordingReader::close() {
+    stop_prefetch();
+    unmap_file();
+    if (file_.is_open())
+        file_.close();
+    file_.clear();
+    chunked_ = false;
+    index_.clear();
+    chunk_loaded_ = false;
+    chunk_ = 0;
+    data_ = nullptr;
+    data_len_ = 0;
+    pos_ = 0;
+    map_pos_ = 0;
+    position_ = 0;
+}
+
+bool RecordingReader::map_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st{};
+    bool ok = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    map_len_ = ok ? static_cast<std::size_t>(st.st_size) : 0;
+    if (ok && map_len_ > 0) {
+        void* p = ::mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ok = false;
+        } else {
+            map_ = static_cast<const uint8_t*>(p);
+            // Replay reads front to back: ask for aggressive readahead
+            ::madvise(p, map_len_, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd); // the mapping keeps the file
+    if (!ok)
+        map_len_ = 0;
+    return ok;
+}
+
+void RecordingReader::unmap_file() {
+    if (map_)
+        ::munmap(const_cast<uint8_t*>(map_), map_len_);
+    map_ = nullptr;
+    map_len_ = 0;
+    mapped_ = false;
+}
+
+bool RecordingReader::load_index() {
+    file_.seekg(0, std::ios::end);
+    auto file_size = static_cast<uint64_t>(file_.tellg());
+
+    RecordingTrailer t{};
+    if (file_size >= header_bytes_ + sizeof(t)) {
+        file_.seekg(static_cast<std::streamoff>(file_size - sizeof(t)));
+        file_.read(reinterpret_cast<char*>(&t), sizeof(t));
+    }
+    uint64_t index_bytes = uint64_t{t.chunk_count} * sizeof(ChunkIndexEntry);
+    if (!file_.good() || t.magic != TRAILER_MAGIC ||
+        t.index_offset + index_bytes + sizeof(t) != file_size) {
+        file_.clear();
+        return scan_chunks(file_size);
+    }
+
+    index_.resize(t.chunk_count);
+    file_.seekg(static_cast<std::streamoff>(t.index_offset));
+    file_.read(reinterpret_cast<char*>(index_.data()), static_cast<std::streamsize>(index_bytes));
+    return file_.good();
+}
+
+bool RecordingReader::scan_chunks(uint64_t file_size) {
+    // No index (writer stopped early): walk the chunks, keeping the intact ones
+    index_.clear();
+    uint64_t off = header_bytes_;
+    while (off + sizeof(ChunkHeader) <= file_size) {
+        ChunkHeader h{};
+        file_.seekg(static_cast<std::streamoff>(off));
+        file_.read(reinterpret_cast<char*>(&h), sizeof(h));
+        if (!file_.good() || h.magic != CHUNK_MAGIC || h.disk_bytes < sizeof(h) ||
+            off + h.disk_bytes > file_size ||
+            sizeof(h) + uint64_t{h.stored_bytes} > h.disk_bytes)
+            break;
+        index_.push_back(ChunkIndexEntry{off, h});
+        off += h.disk_bytes;
+    }
+    file_.clear();
+    return true;
+}
+
+bool RecordingReader::read_chunk(std::ifstream& in, const ChunkIndexEntry& e,
+                                 std::vector<uint8_t>& stored, std::vector<uint8_t>& payload,
+                                 const uint8_t*& data) const {
+    const ChunkHeader& h = e.header;
+    auto codec = static_cast<Codec>(h.codec);
+    data = nullptr;
+    if (codec == Codec::NONE && h.stored_bytes != h.raw_bytes)
+        return false;
+
+    const uint8_t* src;
+    if (mapped_) {
+        uint64_t begin = e.offset + sizeof(ChunkHeader);
+        if (begin + h.stored_bytes > map_len_)
+            return false;
+        src = map_ + begin;
+        // Start paging the chunk in now; MADV_SEQUENTIAL alone does not
+        // cover the jump after a seek
+        uint64_t page = begin & ~uint64_t{4095};
+        ::madvise(const_cast<uint8_t*>(map_) + page, begin + h.stored_bytes - page, MADV_WILLNEED);
+        if (codec == Codec::NONE) {
+            data = src;
+            return true;
+        }
+    } else {
+        std::vector<uint8_t>& dst = codec == Codec::NONE ? payload : stored;
+        dst.resize(h.stored_bytes);
+        in.seekg(static_cast<std::streamoff>(e.offset + sizeof(ChunkHeader)));
+        in.read(reinterpret_cast<char*>(dst.data()), static_cast<std::streamsize>(dst.size()));
+        if (!in.good()) {
+            in.clear();
+            return false;
+        }
+        if (codec == Codec::NONE) {
+            data = payload.data();
+            return true;
+        }
+        src = stored.data();
+    }
+
+    payload.resize(h.raw_bytes);
+    if (!decompress_block(codec, src, h.stored_bytes, payload.data(), payload.size()))
+        return false;
+    data = payload.data();
+    return true;
+}
+
+bool RecordingReader::load_chunk(std::size_t i) {
+    chunk_ = i;
+    chunk_loaded_ = false;
+    if (!read_chunk(file_, index_[i], stored_, payload_, data_))
+        return false;
+    data_len_ = index_[i].header.raw_bytes;
+    chunk_loaded_ = true;
+    pos_ = 0;
+    position_ = index_[i].header.first_frame;
+    return true;
+}
+
+bool RecordingReader::advance_chunk() {
+    std::size_t n = chunk_loaded_ ? chunk_ + 1 : chunk_;
+    if (n >= index_.size())
+        return false;
+    if (!prefetch_.joinable())
+        return load_chunk(n);
+
+    // The prefetcher delivers chunks in order, starting where it was told
+    uint32_t slot;
+    unsigned idle = 0;
+    while (!ready_->try_pop(slot))
+        backoff(idle);
+    Prefetched& p = slots_[slot];
+    bool ok = p.ok;
+    payload_.swap(p.payload); // buffers move with the swap, so p.data stays valid
+    data_ = p.data;
+    data_len_ = index_[n].header.raw_bytes;
+    free_->try_push(slot);
+
+    chunk_ = n;
+    chunk_loaded_ = ok;
+    if (!ok)
+        return false;
+    pos_ = 0;
+    position_ = index_[n].header.first_frame;
+    return true;
+}
+
+void RecordingReader::set_read_ahead(std::size_t chunks) {
+    stop_prefetch();
+    read_ahead_ = chunks;
+    if (read_ahead_ > 0 && file_.is_open() && chunked_)
+        start_prefetch(chunk_loaded_ ? chunk_ + 1 : chunk_);
+}
+
+void RecordingReader::start_prefetch(std::size_t from) {
+    if (from >= index_.size())
+        return;
+    slots_.resize(read_ahead_);
+    ready_ = std::make_unique<SpscRing<uint32_t>>(read_ahead_);
+    free_ = std::make_unique<SpscRing<uint32_t>>(read_ahead_);
+    for (uint32_t i = 0; i < read_ahead_; ++i)
+        free_->try_push(i);
+    stop_.store(false);
+    prefetch_ = std::thread(&RecordingReader::prefetch_loop, this, from);
+}
+
+void RecordingReader::stop_prefetch() {
+    if (!prefetch_.joinable())
+        return;
+    stop_.store(true);
+    prefetch_.join();
+}
+
+void RecordingReader::prefetch_loop(std::size_t from) {
+    // Own stream, so it never moves the consumer's file position
+    std::ifstream in;
+    if (!mapped_)
+        in.open(path_, std::ios::binary);
+    std::vector<uint8_t> stored;
+    for (std::size_t c = from; c < index_.size(); ++c) {
+        uint32_t slot;
+        unsigned idle = 0;
+        while (!free_->try_pop(slot)) {
+            if (stop_.load())
+                return;
+            backoff(idle);
+        }
+        Prefetched& p = slots_[slot];
+        p.ok = (mapped_ || in.is_open()) && read_chunk(in, index_[c], stored, p.payload, p.data);
+        ready_->try_push(slot);
+        if (!p.ok || stop_.load())
+            return;
+    }
+}
+
+bool RecordingReader::next(RecordedFrame& out) {
+    if (!file_.is_open())
+        return false;
+    if (!chunked_)
+        return next_legacy(out);
+
+    while (!chunk_loaded_ || pos_ + FRAME_RECORD_HEADER > data_len_) {
+        if (!advance_chunk()) {
+            chunk_ = index_.size();
+            chunk_loaded_ = false;
+            return false;
+        }
+    }
+
+    uint32_t len;
+    std::memcpy(&out.rx_ts_ns, data_ + pos_, sizeof(out.rx_ts_ns));
+    std::memcpy(&len, data_ + pos_ + sizeof(out.rx_ts_ns), sizeof(len));
+    std::size_t at = pos_ + FRAME_RECORD_HEADER;
+    if (at + len > data_len_) {
+        // Corrupt chunk: skip the rest of it
+        pos_ = data_len_;
+        return next(out);
+    }
+    out.data = data_ + at;
+    out.len = len;
+    pos_ = at + len;
+    ++position_;
+    return true;
+}
+
+bool RecordingReader::next_legacy(RecordedFrame& out) {
+    if (mapped_)
+        return next_legacy_mapped(out);
+    uint32_t len = 0;
+    file_.read(reinterpret_cast<char*>(&out.rx_ts_ns), sizeof(out.rx_ts_ns));
+    file_.read(reinterpret_cast<char*>(&len), sizeof(len));
+    if (!file_.good())
+        return false;
+    frame_buf_.resize(len);
+    if (len > 0)
+        file_.read(reinterpret_cast<char*>(frame_buf_.data()), len);
+    if (!file_.good())
+        return false;
+    out.data = frame_buf_.data();
+    out.len = len;
+    ++position_;
+    return true;
+}
+
+bool RecordingReader::next_legacy_mapped(RecordedFrame& out) {
+    if (map_pos_ + FRAME_RECORD_HEADER > map_len_)
+        return false;
+    uint32_t len;
+    std::memcpy(&out.rx_ts_ns, map_ + map_pos_, sizeof(out.rx_ts_ns));
+    std::memcpy(&len, map_ + map_pos_ + sizeof(out.rx_ts_ns), sizeof(len));
+    std::size_t at = map_pos_ + FRAME_RECORD_HEADER;
+    if (len > map_len_ - at)
+        return false; // truncated last record
+    out.data = map_ + at;
+    out.len = len;
+    map_pos_ = at + len;
+    ++position_;
+    return true;
+}
+
+bool RecordingReader::at_end() {
+    if (!file_.is_open())
+        return true;
+    if (!chunked_ && mapped_)
+        return map_pos_ + FRAME_RECORD_HEADER > map_len_;
+    if (!chunked_)
+        return file_.peek() == std::char_traits<char>::eof();
+    if (chunk_loaded_ && pos_ + FRAME_RECORD_HEADER <= data_len_)
+        return false;
+    return (chunk_loaded_ ? chunk_ + 1 : chunk_) >= index_.size();
+}
+
+uint64_t RecordingReader::frame_total() const {
+    if (index_.empty())
+        return 0;
+    const ChunkHeader& last = index_.back().header;
+    return last.first_frame + last.frame_count;
+}
+
+bool RecordingReader::rewind() {
+    file_.clear();
+    file_.seekg(0);
+    map_pos_ = 0;
+    position_ = 0;
+    return file_.good();
+}
+
+bool RecordingReader::seek_frame(uint64_t frame_no) {
+    if (!file_.is_open())
+        return false;
+
+    RecordedFrame f;
+    if (!chunked_) {
+        if (!rewind())
+            return false;
+        while (position_ < frame_no) {
+            if (!next_legacy(f))
+                return false;
+        }
+        return !at_end();
+    }
+
+    stop_prefetch();
+    bool ok = seek_frame_chunked(frame_no);
+    if (read_ahead_ > 0)
+        start_prefetch(chunk_loaded_ ? chunk_ + 1 : index_.size());
+    return ok;
+}
+
+bool RecordingReader::seek_frame_chunked(uint64_t frame_no) {
+    RecordedFrame f;
+    // Last chunk starting at or before frame_no
+    auto it = std::upper_bound(index_.begin(), index_.end(), frame_no,
+        [](uint64_t n, const ChunkIndexEntry& e) { return n < e.header.first_frame; });
+    if (it == index_.begin())
+        return false;
+    --it;
+    if (frame_no >= it->header.first_frame + it->header.frame_count)
+        return false;
+    if (!load_chunk(static_cast<std::size_t>(it - index_.begin())))
+        return false;
+    while (position_ < frame_no) {
+        if (!next(f))
+            return false;
+    }
+    return true;
+}
+
+bool RecordingReader::seek_time(uint64_t ts_ns) {
+    if (!file_.is_open())
+        return false;
+
+    RecordedFrame f;
+    if (!chunked_) {
+        if (!rewind())
+            return false;
+        while (true) {
+            std::streampos at = file_.tellg();
+            std::size_t at_map = map_pos_;
+            uint64_t at_frame = position_;
+            if (!next_legacy(f))
+                return false;
+            if (f.rx_ts_ns >= ts_ns) {
+                file_.seekg(at);
+                map_pos_ = at_map;
+                position_ = at_frame;
+                return true;
+            }
+        }
+    }
+
+    stop_prefetch();
+    bool ok = seek_time_chunked(ts_ns);
+    if (read_ahead_ > 0)
+        start_prefetch(chunk_loaded_ ? chunk_ + 1 : index_.size());
+    return ok;
+}
+
+bool RecordingReader::seek_time_chunked(uint64_t ts_ns) {
+    RecordedFrame f;
+    // Sources interleave, so chunks overlap in time: take the first chunk
+    // that reaches ts_ns and the first frame in it at or after ts_ns
+    for (std::size_t i = 0; i < index_.size(); ++i) {
+        if (index_[i].header.max_ts_ns < ts_ns)
+            continue;
+        if (!load_chunk(i))
+            return false;
+        while (true) {
+            std::size_t at = pos_;
+            uint64_t at_frame = position_;
+            if (!next(f))
+                return false;
+            if (f.rx_ts_ns >= ts_ns) {
+                // next() may have moved on to a later chunk
+                if (chunk_ != i)
+                    return seek_frame_chunked(at_frame);
+                pos_ = at;
+                position_ = at_frame;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace nng
@@ -0,0 +1,140 @@
+#pragma once
+#include "gateway/recording_format.h"
+#include "common/spsc_ring.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nng {
+
+// One frame as returned by RecordingReader::next()
+struct RecordedFrame {
+    uint64_t       rx_ts_ns = 0;
+    const uint8_t* data = nullptr; // valid until the next next()/seek (mapped: until close)
+    uint32_t       len = 0;
+};
+
+// Reads recordings written by FrameRecorder: the chunked v2 format, or
+// the legacy headerless [ts][len][data] stream, detected on open().
+//
+// For v2 the chunk index comes from the trailer, or, if the writer never
+// wrote one, from walking the chunk headers. Chunks are read whole into a
+// buffer (decompressed if stored compressed) and frames handed out from
+// it, so seeking costs one chunk read. With set_read_ahead() a background
+// thread reads and decodes the following chunks while the caller consumes
+// the current one. Legacy files have no index: seeks scan from the start.
+//
+// Opened with mapped = true, the file is mmap'd read-only with
+// MADV_SEQUENTIAL, and frames of legacy files and of uncompressed chunks
+// point straight into the mapping: no read() and no copy per frame.
+// Compressed chunks are decoded from the mapping into a buffer. The index
+// is still read through the stream.
+class RecordingReader {
+public:
+    RecordingReader() = default;
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    // mapped: read through mmap (falls back to the stream if mapping fails)
+    bool open(const std::string& path, bool mapped = false);
+    void close();
+    bool is_open() const { return file_.is_open(); }
+    bool is_mapped() const { return mapped_; }
+
+    // False for the legacy format
+    bool is_chunked() const { return chunked_; }
+
+    // Next frame in file order; false at the end
+    bool next(RecordedFrame& out);
+
+    // Position so the next frame returned is frame_no (counted from 0), or
+    // the first frame with rx_ts_ns >= ts_ns. False if there is none.
+    bool seek_frame(uint64_t frame_no);
+    bool seek_time(uint64_t ts_ns);
+
+    // Number of the frame next() returns next
+    uint64_t position() const { return position_; }
+
+    // True once next() has nothing more to return
+    bool at_end();
+
+    // v2 only: chunk index and total frame count (0 for legacy files)
+    const std::vector<ChunkIndexEntry>& chunks() const { return index_; }
+    uint64_t frame_total() const;
+
+    // Keep up to chunks decoded chunks ready ahead of next() (v2 files);
+    // 0 turns read-ahead off. May be called before or after open().
+    void set_read_ahead(std::size_t chunks);
+
+private:
+    struct Prefetched {
+        std::vector<uint8_t> payload;
+        const uint8_t* data = nullptr; // payload.data(), or into the mapping
+        bool ok = false;
+    };
+
+    bool load_index();
+    bool scan_chunks(uint64_t file_size);
+    bool load_chunk(std::size_t i);
+    bool advance_chunk();
+    bool next_legacy(RecordedFrame& out);
+    bool next_legacy_mapped(RecordedFrame& out);
+    bool rewind();
+    bool map_file(const std::string& path);
+    void unmap_file();
+    bool seek_frame_chunked(uint64_t frame_no);
+    bool seek_time_chunked(uint64_t ts_ns);
+
+    // Read and decode chunk e from in (or the mapping) into payload, and
+    // point data at the frames: payload, or the mapping for a raw chunk.
+    // stored is scratch for compressed bytes.
+    bool read_chunk(std::ifstream& in, const ChunkIndexEntry& e, std::vector<uint8_t>& stored,
+                    std::vector<uint8_t>& payload, const uint8_t*& data) const;
+
+    void start_prefetch(std::size_t from);
+    void stop_prefetch();
+    void prefetch_loop(std::size_t from);
+
+    std::string path_;
+    std::ifstream file_;
+    bool chunked_ = false;
+    uint32_t header_bytes_ = 0;
+    std::vector<ChunkIndexEntry> index_;
+
+    // v2: current chunk
+    std::size_t chunk_ = 0;      // index_ position of the loaded chunk
+    bool chunk_loaded_ = false;
+    std::vector<uint8_t> payload_;
+    std::vector<uint8_t> stored_; // compressed bytes of the chunk being loaded
+    const uint8_t* data_ = nullptr; // frames of the loaded chunk
+    std::size_t data_len_ = 0;
+    std::size_t pos_ = 0;           // read offset in data_
+
+    // Read-ahead: the prefetch thread fills slots with chunks in order
+    std::size_t read_ahead_ = 0;
+    std::vector<Prefetched> slots_;
+    std::unique_ptr<SpscRing<uint32_t>> ready_; // prefetch -> next()
+    std::unique_ptr<SpscRing<uint32_t>> free_;  // next() -> prefetch
+    std::thread prefetch_;
+    std::atomic<bool> stop_{false};
+
+    // Legacy: buffer for the current frame; read offset when mapped
+    std::vector<uint8_t> frame_buf_;
+    std::size_t map_pos_ = 0;
+
+    // Whole-file mapping
+    bool mapped_ = false;
+    const uint8_t* map_ = nullptr;
+    std::size_t map_len_ = 0;
+
+    uint64_t position_ = 0;
+};
+
+} // namespace nng
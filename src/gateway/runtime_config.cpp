@@ -0,0 +1,85 @@
+#include "gateway/runtime_config.h"
+#include <algorithm>
+
+namespace nng {
+
+bool RuntimeConfig::set_recording(bool on) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    if (on && !recorder_open_.load(std::memory_order_relaxed))
+        return false;
+    recording_.store(on, std::memory_order_relaxed);
+    return true;
+}
+
+void RuntimeConfig::set_recorder_open(bool open) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    recorder_open_.store(open, std::memory_order_relaxed);
+    recording_.store(open, std::memory_order_relaxed);
+}
+
+void RuntimeConfig::set_event_level(Severity sev) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    event_level_.store(sev, std::memory_order_relaxed);
+    update_derived();
+}
+
+void RuntimeConfig::set_overload_mode(OverloadMode mode) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    mode_.store(mode, std::memory_order_relaxed);
+    update_derived();
+}
+
+void RuntimeConfig::set_overload_detected(bool on) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    detected_.store(on, std::memory_order_relaxed);
+    update_derived();
+}
+
+void RuntimeConfig::update_derived() {
+    bool on = false;
+    switch (mode_.load(std::memory_order_relaxed)) {
+        case OverloadMode::AUTO: on = detected_.load(std::memory_order_relaxed); break;
+        case OverloadMode::ON:   on = true; break;
+        case OverloadMode::OFF:  on = false; break;
+    }
+    if (on && !overloaded_.load(std::memory_order_relaxed))
+        entries_.fetch_add(1, std::memory_order_relaxed);
+    overloaded_.store(on, std::memory_order_relaxed);
+
+    Severity level = event_level_.load(std::memory_order_relaxed);
+    if (on)
+        level = std::max(level, Severity::INFO);
+    effective_level_.store(level, std::memory_order_relaxed);
+}
+
+OverloadMonitor::OverloadMonitor(const OverloadOptions& options)
+    : options_(options) {}
+
+bool OverloadMonitor::sample(double queue_fill, double cpu_busy) {
+    bool other_way;
+    uint32_t needed;
+    if (overloaded_) {
+        other_way = queue_fill < options_.queue_low && cpu_busy < options_.cpu_low;
+        needed = options_.exit_samples;
+    } else {
+        other_way = queue_fill > options_.queue_high || cpu_busy > options_.cpu_high;
+        needed = options_.enter_samples;
+    }
+    streak_ = other_way ? streak_ + 1 : 0;
+    if (streak_ >= std::max<uint32_t>(needed, 1)) {
+        overloaded_ = !overloaded_;
+        streak_ = 0;
+    }
+    return overloaded_;
+}
+
+const char* overload_mode_name(OverloadMode mode) {
+    switch (mode) {
+        case OverloadMode::AUTO: return "AUTO";
+        case OverloadMode::ON:   return "ON";
+        case OverloadMode::OFF:  return "OFF";
+    }
+    return "AUTO";
+}
+
+} // namespace nng
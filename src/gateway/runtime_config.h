@@ -0,0 +1,123 @@
+#pragma once
+#include "gateway/ingress_filter.h"
+#include "common/types.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace nng {
+
+// Who decides whether the gateway is shedding load
+enum class OverloadMode : uint8_t {
+    AUTO, // the OverloadMonitor, from queue depth and CPU
+    ON,   // forced on
+    OFF,  // forced off
+};
+
+// Knobs an operator changes while the gateway runs (through CommandHandler
+// SET commands), read by the ingest, validate and dispatch threads on every
+// batch or frame. Each is a single relaxed atomic: a change takes effect
+// within a batch or so, never mid-frame, and reading costs a plain load.
+//
+// While overloaded the gateway sheds low-value work: events below INFO
+// (plots, track updates, heartbeat OK) are neither logged nor published.
+// CRC checks, tracking, stats and recording are never shed.
+class RuntimeConfig {
+public:
+    RuntimeConfig() = default;
+    RuntimeConfig(const RuntimeConfig&) = delete;
+    RuntimeConfig& operator=(const RuntimeConfig&) = delete;
+
+    bool crc() const { return crc_.load(std::memory_order_relaxed); }
+    void set_crc(bool on) { crc_.store(on, std::memory_order_relaxed); }
+
+    // Frames are written only while a recorder is open and recording is on
+    bool recording() const { return recording_.load(std::memory_order_relaxed); }
+    // False if no recorder is open
+    bool set_recording(bool on);
+    bool recorder_open() const { return recorder_open_.load(std::memory_order_relaxed); }
+    // Gateway: a recorder was opened or closed (closing stops recording)
+    void set_recorder_open(bool open);
+
+    // Events below this severity are dropped before formatting, whatever
+    // the log level or subscribers
+    Severity event_level() const { return event_level_.load(std::memory_order_relaxed); }
+    void set_event_level(Severity sev);
+    // event_level(), raised to INFO while overloaded: what the hot path checks
+    Severity effective_event_level() const { return effective_level_.load(std::memory_order_relaxed); }
+
+    // One PLOT in n (by seq) raises an event; 0 is taken as 1
+    uint32_t plot_sample() const { return plot_sample_.load(std::memory_order_relaxed); }
+    void set_plot_sample(uint32_t n) { plot_sample_.store(n > 0 ? n : 1, std::memory_order_relaxed); }
+
+    OverloadMode overload_mode() const { return mode_.load(std::memory_order_relaxed); }
+    void set_overload_mode(OverloadMode mode);
+    // Monitor's verdict, used in AUTO mode
+    void set_overload_detected(bool on);
+    bool overload_detected() const { return detected_.load(std::memory_order_relaxed); }
+    // Shedding now (mode and monitor verdict combined)
+    bool overloaded() const { return overloaded_.load(std::memory_order_relaxed); }
+    // Times shedding has started
+    uint64_t overload_entries() const { return entries_.load(std::memory_order_relaxed); }
+
+    // Ingress filter (atomically swappable itself)
+    IngressFilter& filter() { return filter_; }
+    const IngressFilter& filter() const { return filter_; }
+
+private:
+    // Recompute overloaded_ and the effective event level; callers hold
+    // update_mutex_ (setters run on the control and monitor threads)
+    void update_derived();
+
+    std::atomic<bool> crc_{true};
+    std::atomic<bool> recording_{false};
+    std::atomic<bool> recorder_open_{false};
+    std::atomic<Severity> event_level_{Severity::DEBUG};
+    std::atomic<Severity> effective_level_{Severity::DEBUG};
+    std::atomic<uint32_t> plot_sample_{1};
+    std::atomic<OverloadMode> mode_{OverloadMode::AUTO};
+    std::atomic<bool> detected_{false};
+    std::atomic<bool> overloaded_{false};
+    std::atomic<uint64_t> entries_{0};
+    std::mutex update_mutex_;
+    IngressFilter filter_;
+};
+
+struct OverloadOptions {
+    bool enabled = true;        // AUTO mode acts on the monitor's verdict
+    uint64_t interval_ms = 100; // sample period
+    // Queue fill (0..1): pipeline queues, or the share of receive batches
+    // that came back full when running inline
+    double queue_high = 0.75;
+    double queue_low = 0.25;
+    // Busy fraction of the sampling thread's core over the period
+    double cpu_high = 0.95;
+    double cpu_low = 0.70;
+    // Samples in a row over a high mark before shedding starts, and under
+    // both low marks before it stops
+    uint32_t enter_samples = 2;
+    uint32_t exit_samples = 10;
+};
+
+// Hysteresis over queue-fill and CPU samples: overloaded once either signal
+// is over its high mark for enter_samples periods, back to normal once both
+// are under their low marks for exit_samples periods. Fed by one thread.
+class OverloadMonitor {
+public:
+    explicit OverloadMonitor(const OverloadOptions& options = {});
+
+    // One period's signals; returns the verdict
+    bool sample(double queue_fill, double cpu_busy);
+
+    bool overloaded() const { return overloaded_; }
+    const OverloadOptions& options() const { return options_; }
+
+private:
+    OverloadOptions options_;
+    bool overloaded_ = false;
+    uint32_t streak_ = 0; // samples in a row pointing the other way
+};
+
+const char* overload_mode_name(OverloadMode mode);
+
+} // namespace nng
@@ -1,48 +1,98 @@
 #include "gateway/sequence_tracker.h"
+#include <algorithm>
 
 namespace nng {
+namespace {
+
+std::size_t window_for(std::size_t requested) {
+    std::size_t w = SequenceTracker::MIN_WINDOW;
+    while (w < requested && w < SequenceTracker::MAX_WINDOW)
+        w <<= 1;
+    return w;
+}
+
+} // anonymous namespace
+
+SequenceTracker::SequenceTracker(SeqStorage storage, std::size_t window_size)
+    : storage_(storage),
+      window_(window_for(window_size)),
+      words_(window_ / 64) {}
+
+SequenceTracker::Slot SequenceTracker::slot(uint16_t src_id) {
+    if (storage_ == SeqStorage::HASH_MAP) {
+        auto& e = sources_[src_id];
+        if (e.bits.empty())
+            e.bits.assign(words_, 0);
+        return Slot{&e.state, e.bits.data()};
+    }
+
+    auto& page = pages_[src_id >> PAGE_BITS];
+    if (!page)
+        page = std::make_unique<Page>(words_);
+    std::size_t i = src_id & (PAGE_SIZE - 1);
+    return Slot{&page->states[i], page->bits.data() + i * words_};
+}
+
+void SequenceTracker::clear_bits(uint64_t* bits, uint32_t first, uint32_t count) const {
+    if (count >= window_) {
+        std::fill(bits, bits + words_, 0);
+        return;
+    }
+    // At most one wrap of the ring; whole words at a time where possible
+    std::size_t pos = first & (window_ - 1);
+    while (count > 0) {
+        std::size_t off = pos & 63;
+        std::size_t n = std::min<std::size_t>(64 - off, count);
+        uint64_t mask = n == 64 ? ~0ULL : ((1ULL << n) - 1) << off;
+        bits[pos >> 6] &= ~mask;
+        pos = (pos + n) & (window_ - 1);
+        count -= static_cast<uint32_t>(n);
+    }
+}
+
+uint64_t* SequenceTracker::window(uint16_t src_id) {
+    return slot(src_id).bits;
+}
 
 SeqEvent SequenceTracker::track(uint16_t src_id, uint32_t seq) {
-    auto& s = sources_[src_id];
+    Slot sl = slot(src_id);
+    return track(*sl.state, sl.bits, src_id, seq);
+}
+
+SeqEvent SequenceTracker::track(SeqState& s, uint64_t* bits, uint16_t src_id, uint32_t seq) {
+    const std::size_t bit = seq & (window_ - 1);
+    const uint64_t bit_mask = 1ULL << (bit & 63);
 
     if (!s.initialized) {
         s.initialized = true;
+        if (storage_ == SeqStorage::FLAT)
+            ++flat_count_;
         s.next_expected = seq + 1;
-        s.seen_window.reset();
+        std::fill(bits, bits + words_, 0);
+        bits[bit >> 6] |= bit_mask;
         return SeqEvent{SeqResult::FIRST, src_id, 0, seq, 0};
     }
 
-    if (seq == s.next_expected) {
-        // Normal: exactly what we expected
-        s.seen_window <<= 1;
-        s.seen_window.set(WINDOW_SIZE - 1);
+    // Distance ahead of the expected sequence, modulo 2^32
+    uint32_t ahead = seq - s.next_expected;
+    if (ahead < 0x80000000u) {
+        // In order (ahead == 0) or a gap: the skipped numbers and seq
+        // enter the window, the oldest numbers leave it
+        clear_bits(bits, s.next_expected, ahead + 1);
+        bits[bit >> 6] |= bit_mask;
         s.next_expected = seq + 1;
-        return SeqEvent{SeqResult::OK, src_id, seq, seq, 0};
+        if (ahead == 0)
+            return SeqEvent{SeqResult::OK, src_id, seq, seq, 0};
+        return SeqEvent{SeqResult::GAP, src_id, seq - ahead, seq, ahead};
     }
 
-    if (seq > s.next_expected) {
-        // Gap: we skipped some sequence numbers
-        uint32_t gap = seq - s.next_expected;
-        // Shift window by (gap + 1) positions
-        if (gap + 1 >= WINDOW_SIZE) {
-            s.seen_window.reset();
-        } else {
-            s.seen_window <<= (gap + 1);
-        }
-        s.seen_window.set(WINDOW_SIZE - 1);
-        s.next_expected = seq + 1;
-        return SeqEvent{SeqResult::GAP, src_id, seq - gap, seq, gap};
-    }
-
-    // seq < next_expected: either reorder or duplicate
+    // Behind next_expected: either reorder or duplicate
     uint32_t age = s.next_expected - seq;
-    if (age <= WINDOW_SIZE) {
-        std::size_t bit_idx = WINDOW_SIZE - age;
-        if (s.seen_window.test(bit_idx)) {
+    if (age <= window_) {
+        if (bits[bit >> 6] & bit_mask)
             return SeqEvent{SeqResult::DUPLICATE, src_id, s.next_expected, seq, 0};
-        }
         // Not seen before -> reorder
-        s.seen_window.set(bit_idx);
+        bits[bit >> 6] |= bit_mask;
         return SeqEvent{SeqResult::REORDER, src_id, s.next_expected, seq, 0};
     }
 
@@ -51,15 +101,28 @@ SeqEvent SequenceTracker::track(uint16_t src_id, uint32_t seq) {
 }
 
 void SequenceTracker::reset(uint16_t src_id) {
-    sources_.erase(src_id);
+    if (storage_ == SeqStorage::HASH_MAP) {
+        sources_.erase(src_id);
+        return;
+    }
+    auto& page = pages_[src_id >> PAGE_BITS];
+    if (!page)
+        return;
+    auto& s = page->states[src_id & (PAGE_SIZE - 1)];
+    if (s.initialized)
+        --flat_count_;
+    s = SeqState{};
 }
 
 void SequenceTracker::reset_all() {
     sources_.clear();
+    for (auto& page : pages_)
+        page.reset();
+    flat_count_ = 0;
 }
 
 std::size_t SequenceTracker::source_count() const {
-    return sources_.size();
+    return storage_ == SeqStorage::HASH_MAP ? sources_.size() : flat_count_;
 }
 
 } // namespace nng
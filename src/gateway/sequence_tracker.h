@@ -1,8 +1,9 @@
 #pragma once
 #include <cstdint>
 #include <cstddef>
+#include <memory>
 #include <unordered_map>
-#include <bitset>
+#include <vector>
 
 namespace nng {
 
@@ -22,24 +23,88 @@ struct SeqEvent {
     uint32_t  gap_size;
 };
 
+// One source's position in its sequence space. The tracker keeps one per
+// source itself, or callers keep it (see SourceRecord) and pass it in.
+struct SeqState {
+    uint32_t next_expected = 0;
+    bool     initialized   = false;
+};
+
+// How per-source state is stored
+enum class SeqStorage {
+    // Two-level table indexed directly by src_id: 256 pages of 256 states,
+    // each page allocated on first use. One predictable load per frame, no
+    // hashing.
+    FLAT,
+    // unordered_map keyed by src_id; smallest for a handful of sources
+    HASH_MAP,
+};
+
+// Classifies each source's sequence numbers. The last window_size
+// sequence numbers before the next expected one are remembered in a ring
+// bitmap (bit seq % window_size), so late frames within the window are
+// told apart as REORDER or DUPLICATE; older ones count as REORDER.
+// Advancing past a gap clears only the bits it skips over.
+//
+// Sequence numbers are compared modulo 2^32: a frame up to 2^31 ahead of
+// the expected one is OK/GAP (so 0xFFFFFFFF -> 0 is in order), anything
+// else is late.
 class SequenceTracker {
 public:
+    static constexpr std::size_t MIN_WINDOW = 64;
+    static constexpr std::size_t MAX_WINDOW = 4096;
+    static constexpr std::size_t DEFAULT_WINDOW = 64;
+
+    // window_size is rounded up to a power of two in [MIN_WINDOW, MAX_WINDOW]
+    explicit SequenceTracker(SeqStorage storage = SeqStorage::FLAT,
+                             std::size_t window_size = DEFAULT_WINDOW);
+
     SeqEvent track(uint16_t src_id, uint32_t seq);
+    // The same, with the state held by the caller and the source's window
+    // from window(src_id): no lookup by src_id of its own
+    SeqEvent track(SeqState& state, uint64_t* window, uint16_t src_id, uint32_t seq);
+    // src_id's window bitmap, window_size() / 64 words, created on first
+    // use; valid until reset(src_id) or reset_all()
+    uint64_t* window(uint16_t src_id);
     void reset(uint16_t src_id);
     void reset_all();
     std::size_t source_count() const;
 
+    SeqStorage storage() const { return storage_; }
+    std::size_t window_size() const { return window_; }
+
 private:
-    static constexpr std::size_t WINDOW_SIZE = 64;
+    static constexpr std::size_t PAGE_BITS = 8;
+    static constexpr std::size_t PAGE_SIZE = std::size_t{1} << PAGE_BITS;
+    static constexpr std::size_t PAGE_COUNT = 65536 / PAGE_SIZE;
+
+    // A source's state and its window_size / 64 bitmap words
+    struct Slot {
+        SeqState* state;
+        uint64_t* bits;
+    };
 
-    struct SourceState {
-        uint32_t next_expected = 0;
-        bool     initialized   = false;
-        // Sliding window: bit i = 1 means (next_expected - WINDOW_SIZE + i) was seen
-        std::bitset<WINDOW_SIZE> seen_window;
+    struct alignas(64) Page {
+        explicit Page(std::size_t words) : bits(PAGE_SIZE * words, 0) {}
+        SeqState states[PAGE_SIZE];
+        std::vector<uint64_t> bits; // PAGE_SIZE runs of words
     };
 
-    std::unordered_map<uint16_t, SourceState> sources_;
+    struct MapEntry {
+        SeqState state;
+        std::vector<uint64_t> bits;
+    };
+
+    Slot slot(uint16_t src_id);
+    // Clear the bits of count sequence numbers starting at first
+    void clear_bits(uint64_t* bits, uint32_t first, uint32_t count) const;
+
+    SeqStorage storage_;
+    std::size_t window_;
+    std::size_t words_; // bitmap words per source
+    std::unordered_map<uint16_t, MapEntry> sources_; // HASH_MAP
+    std::unique_ptr<Page> pages_[PAGE_COUNT];        // FLAT
+    std::size_t flat_count_ = 0;                     // FLAT: initialized states
 };
 
 } // namespace nng
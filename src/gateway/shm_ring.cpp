@@ -0,0 +1,344 @@
+#include "gateway/shm_ring.h"
+#include "common/spsc_ring.h"
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+namespace nng {
+
+namespace {
+
+constexpr uint32_t SHM_RING_MAGIC = 0x524E474E; // "NGNR"
+constexpr uint32_t SHM_RING_VERSION = 1;
+
+enum : uint32_t { RING_INIT = 0, RING_OPEN = 1, RING_CLOSED = 2 };
+
+// Receiver checks this often before going to sleep on the futex
+constexpr int SPIN_CHECKS = 64;
+
+uint64_t realtime_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Shared (not FUTEX_PRIVATE): waiter and waker may be in different processes
+long futex_wait(std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms) {
+    timespec ts{};
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+    return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+                     &ts, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>* word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr,
+              nullptr, 0);
+}
+
+} // anonymous namespace
+
+// Start of the shared object. Everything in it is accessed through
+// atomics or published by one (a slot's bytes by its seq).
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t slot_count;
+    uint64_t slot_size;
+    std::atomic<uint32_t> state;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head; // next position senders claim
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> dropped;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> waiting; // receiver about to sleep
+    std::atomic<uint32_t> wake;                             // futex word, bumped to wake it
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+// seq == pos: free for the sender claiming pos; pos + 1: frame ready for
+// the receiver; pos + slot_count: taken, free again one lap later
+struct alignas(CACHE_LINE_SIZE) ShmRingSlot {
+    std::atomic<uint64_t> seq;
+    uint64_t ts_ns;
+    uint32_t len;
+    alignas(CACHE_LINE_SIZE) uint8_t data[FramePool::SLOT_SIZE];
+};
+
+ShmRing::~ShmRing() {
+    close();
+}
+
+std::string ShmRing::shm_path(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+bool ShmRing::map(int fd, std::size_t bytes) {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        return false;
+    base_ = static_cast<uint8_t*>(p);
+    bytes_ = bytes;
+    header_ = reinterpret_cast<ShmRingHeader*>(base_);
+    return true;
+}
+
+bool ShmRing::create(const std::string& name, std::size_t slots) {
+    close();
+    std::string path = shm_path(name);
+    std::size_t count = round_up_pow2(std::max<std::size_t>(slots, 2));
+    std::size_t bytes = sizeof(ShmRingHeader) + count * sizeof(ShmRingSlot);
+
+    // A ring left by a receiver that died: its senders see it closed
+    int stale = ::shm_open(path.c_str(), O_RDWR, 0);
+    if (stale >= 0) {
+        struct stat st{};
+        if (::fstat(stale, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(ShmRingHeader) &&
+            map(stale, sizeof(ShmRingHeader))) {
+            if (header_->magic == SHM_RING_MAGIC)
+                header_->state.store(RING_CLOSED, std::memory_order_release);
+            ::munmap(base_, bytes_);
+            header_ = nullptr;
+            base_ = nullptr;
+        }
+        ::close(stale);
+        ::shm_unlink(path.c_str());
+    }
+
+    int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return false;
+    bool mapped = ::ftruncate(fd, static_cast<off_t>(bytes)) == 0 && map(fd, bytes);
+    ::close(fd);
+    if (!mapped) {
+        ::shm_unlink(path.c_str());
+        return false;
+    }
+
+    // ftruncate() zero-fills: only the non-zero fields need setting
+    header_->magic = SHM_RING_MAGIC;
+    header_->version = SHM_RING_VERSION;
+    header_->slot_count = count;
+    header_->slot_size = sizeof(ShmRingSlot);
+    mask_ = count - 1;
+    for (uint64_t i = 0; i < count; ++i)
+        slot(i).seq.store(i, std::memory_order_relaxed);
+    header_->state.store(RING_OPEN, std::memory_order_release);
+
+    owner_ = true;
+    name_ = path;
+    tail_ = 0;
+    held_ = 0;
+    return true;
+}
+
+bool ShmRing::attach(const std::string& name) {
+    close();
+    std::string path = shm_path(name);
+    int fd = ::shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return false;
+    struct stat st{};
+    bool mapped = ::fstat(fd, &st) == 0 &&
+                  static_cast<std::size_t>(st.st_size) >= sizeof(ShmRingHeader) &&
+                  map(fd, static_cast<std::size_t>(st.st_size));
+    ::close(fd);
+    if (!mapped)
+        return false;
+    const ShmRingHeader& h = *header_;
+    bool valid = h.state.load(std::memory_order_acquire) == RING_OPEN &&
+                 h.magic == SHM_RING_MAGIC && h.version == SHM_RING_VERSION &&
+                 h.slot_size == sizeof(ShmRingSlot) && h.slot_count > 0 &&
+                 (h.slot_count & (h.slot_count - 1)) == 0 &&
+                 bytes_ >= sizeof(ShmRingHeader) + h.slot_count * sizeof(ShmRingSlot);
+    if (!valid) {
+        close();
+        return false;
+    }
+    mask_ = h.slot_count - 1;
+    name_ = path;
+    return true;
+}
+
+void ShmRing::close() {
+    if (!header_)
+        return;
+    if (owner_) {
+        header_->state.store(RING_CLOSED, std::memory_order_release);
+        ::shm_unlink(name_.c_str());
+    }
+    ::munmap(base_, bytes_);
+    header_ = nullptr;
+    base_ = nullptr;
+    bytes_ = 0;
+    mask_ = 0;
+    owner_ = false;
+    name_.clear();
+}
+
+bool ShmRing::live() const {
+    return header_ && header_->state.load(std::memory_order_acquire) == RING_OPEN;
+}
+
+ShmRingSlot& ShmRing::slot(uint64_t pos) const {
+    return reinterpret_cast<ShmRingSlot*>(base_ + sizeof(ShmRingHeader))[pos & mask_];
+}
+
+bool ShmRing::ready(uint64_t pos) const {
+    return slot(pos).seq.load(std::memory_order_acquire) == pos + 1;
+}
+
+std::size_t ShmRing::push(const FrameView* frames, std::size_t count, uint64_t ts_ns) {
+    if (!header_ || count == 0)
+        return 0;
+    ShmRingHeader& h = *header_;
+    std::size_t pushed = 0;
+    uint64_t pos = h.head.load(std::memory_order_relaxed);
+    while (pushed < count) {
+        ShmRingSlot& s = slot(pos);
+        uint64_t seq = s.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            if (!h.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                continue; // another sender took it; pos is reloaded
+            std::size_t len = std::min(frames[pushed].len, FramePool::SLOT_SIZE);
+            if (len > 0)
+                std::memcpy(s.data, frames[pushed].data, len);
+            s.len = static_cast<uint32_t>(len);
+            s.ts_ns = ts_ns;
+            s.seq.store(pos + 1, std::memory_order_release);
+            ++pushed;
+            ++pos;
+        } else if (diff < 0) {
+            break; // full: the receiver has not taken this slot's last frame
+        } else {
+            pos = h.head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Pairs with the fence in wait(): either it sees the frames or we see it waiting
+    if (pushed > 0) {
+        h.sent.fetch_add(pushed, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (h.waiting.load(std::memory_order_relaxed)) {
+            h.wake.fetch_add(1, std::memory_order_release);
+            futex_wake(&h.wake);
+        }
+    }
+    return pushed;
+}
+
+void ShmRing::release() {
+    for (; held_ > 0; --held_) {
+        uint64_t pos = tail_ - held_;
+        slot(pos).seq.store(pos + mask_ + 1, std::memory_order_release);
+    }
+}
+
+std::size_t ShmRing::take(FrameBatch& batch) {
+    batch.clear();
+    if (!header_)
+        return 0;
+    release();
+    while (!batch.full() && ready(tail_)) {
+        ShmRingSlot& s = slot(tail_);
+        batch.commit_view(s.data, s.len, s.ts_ns);
+        ++tail_;
+        ++held_;
+    }
+    return batch.size();
+}
+
+bool ShmRing::wait(int timeout_ms) {
+    if (!header_)
+        return false;
+    for (int i = 0; i < SPIN_CHECKS; ++i) {
+        if (ready(tail_))
+            return true;
+    }
+    ShmRingHeader& h = *header_;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        uint32_t word = h.wake.load(std::memory_order_acquire);
+        h.waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready(tail_)) {
+            h.waiting.store(0, std::memory_order_relaxed);
+            return true;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            h.waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        // Returns at once if a sender bumped the word after we read it
+        futex_wait(&h.wake, word, static_cast<int>(left));
+        h.waiting.store(0, std::memory_order_relaxed);
+        if (ready(tail_))
+            return true;
+    }
+}
+
+void ShmRing::count_dropped(uint64_t n) {
+    if (header_ && n > 0)
+        header_->dropped.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t ShmRing::sent() const {
+    return header_ ? header_->sent.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t ShmRing::dropped() const {
+    return header_ ? header_->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+bool ShmFrameSource::receive(std::vector<uint8_t>& buf) {
+    FrameBatch one(1);
+    if (receive_batch(one) == 0)
+        return false;
+    buf.assign(one[0].data, one[0].data + one[0].len);
+    return true;
+}
+
+std::size_t ShmFrameSource::receive_batch(FrameBatch& batch) {
+    std::size_t n = ring_.take(batch);
+    if (n > 0 || !ring_.wait(timeout_ms_))
+        return n;
+    return ring_.take(batch);
+}
+
+bool ShmFrameSink::send(const std::vector<uint8_t>& buf) {
+    FrameView view{buf.data(), buf.size()};
+    return send_batch(&view, 1) == 1;
+}
+
+std::size_t ShmFrameSink::send_batch(const FrameView* frames, std::size_t count) {
+    if (!ring_.live())
+        return 0;
+    uint64_t ts = realtime_ns();
+    std::size_t sent = 0;
+    while (true) {
+        sent += ring_.push(frames + sent, count - sent, ts);
+        if (sent == count)
+            return sent;
+        if (!blocking_ || !ring_.live())
+            break;
+        std::this_thread::yield();
+    }
+    ring_.count_dropped(count - sent);
+    return sent;
+}
+
+} // namespace nng
@@ -0,0 +1,138 @@
+#pragma once
+#include "gateway/frame_source.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+struct ShmRingHeader;
+struct ShmRingSlot;
+
+// A named POSIX shared-memory object ("/dev/shm/<name>") holding a ring of
+// FramePool::SLOT_SIZE frame slots: a bounded MPSC queue with a sequence
+// number per slot, so any number of senders in any process can publish
+// and one receiver consumes, with no lock and no syscall per frame. The
+// receiver sleeps on a futex in the ring; senders only make the wake
+// syscall when it is actually asleep.
+//
+// The receiver (ShmFrameSource) creates the ring and removes its name
+// when closed; senders (ShmFrameSink) attach to a ring that exists.
+class ShmRing {
+public:
+    ShmRing() = default;
+    ~ShmRing();
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // Receiver side: create name with slots (rounded up to a power of
+    // two), replacing a stale ring of that name
+    bool create(const std::string& name, std::size_t slots);
+    // Sender side: map an existing, open ring
+    bool attach(const std::string& name);
+    // Unmap; the creator also marks the ring closed and unlinks its name
+    void close();
+
+    bool is_open() const { return header_ != nullptr; }
+    // False once the creator has closed it (senders should re-attach)
+    bool live() const;
+    std::size_t slots() const { return mask_ + 1; }
+
+    // Sender side, any thread of any process. Copies the frames in order
+    // and returns how many found a free slot; wakes the receiver once for
+    // the lot.
+    std::size_t push(const FrameView* frames, std::size_t count, uint64_t ts_ns);
+    // Frames a sender gave up on
+    void count_dropped(uint64_t n);
+
+    // Receiver side. Give back the slots of the last take(), then commit up
+    // to batch.capacity() ready frames as views of ring memory: they stay
+    // valid until the next take() or release().
+    std::size_t take(FrameBatch& batch);
+    void release();
+    // Wait up to timeout_ms for a frame to be ready; false on timeout
+    bool wait(int timeout_ms);
+
+    // Frames accepted, and frames senders dropped on a full ring
+    uint64_t sent() const;
+    uint64_t dropped() const;
+
+    // "/dev/shm" name for a ring name ("/" prepended if missing)
+    static std::string shm_path(const std::string& name);
+
+private:
+    bool map(int fd, std::size_t bytes);
+    ShmRingSlot& slot(uint64_t pos) const;
+    bool ready(uint64_t pos) const;
+
+    ShmRingHeader* header_ = nullptr;
+    uint8_t* base_ = nullptr;
+    std::size_t bytes_ = 0;
+    uint64_t mask_ = 0;
+    bool owner_ = false;
+    std::string name_;
+    uint64_t tail_ = 0;  // receiver: next slot to take
+    uint64_t held_ = 0;  // receiver: slots lent out by the last take()
+};
+
+// Receives from a ShmRing it creates. receive_batch() hands out views of
+// the ring's slots (no copy); they are returned to the senders on the
+// next call, as with the other zero-copy sources.
+class ShmFrameSource : public IFrameSource {
+public:
+    static constexpr std::size_t DEFAULT_SLOTS = 4096;
+
+    ShmFrameSource() = default;
+    ~ShmFrameSource() override { close(); }
+
+    bool open(const std::string& name, std::size_t slots = DEFAULT_SLOTS) {
+        return ring_.create(name, slots);
+    }
+    void close() { ring_.close(); }
+    bool is_open() const { return ring_.is_open(); }
+
+    // Receive one frame (blocks up to timeout)
+    bool receive(std::vector<uint8_t>& buf) override;
+
+    // Waits up to the timeout for the first frame, then takes what else is
+    // ready. FrameView::rx_ts_ns is when the sender published the frame.
+    std::size_t receive_batch(FrameBatch& batch) override;
+
+    void set_timeout_ms(int ms) { timeout_ms_ = ms; }
+
+    const ShmRing& ring() const { return ring_; }
+
+private:
+    ShmRing ring_;
+    int timeout_ms_ = 100;
+};
+
+// Sends into a ShmRing created by a ShmFrameSource, possibly in another
+// process; several sinks (threads or processes) may share one ring. A full
+// ring drops the frame like a full socket buffer, unless blocking, when
+// the sender waits for room instead.
+class ShmFrameSink : public IFrameSink {
+public:
+    ShmFrameSink() = default;
+    ~ShmFrameSink() override { close(); }
+
+    bool connect(const std::string& name) { return ring_.attach(name); }
+    void close() { ring_.close(); }
+    bool is_open() const { return ring_.is_open(); }
+
+    // Wait for a free slot rather than drop (e.g. replaying a recording)
+    void set_blocking(bool blocking) { blocking_ = blocking; }
+
+    bool send(const std::vector<uint8_t>& buf) override;
+    using IFrameSink::send_batch;
+    // One clock read and at most one wake-up per call
+    std::size_t send_batch(const FrameView* frames, std::size_t count) override;
+
+private:
+    ShmRing ring_;
+    bool blocking_ = false;
+};
+
+} // namespace nng
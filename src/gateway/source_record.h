@@ -0,0 +1,46 @@
+#pragma once
+#include "common/spsc_ring.h"
+#include "gateway/sequence_tracker.h"
+#include <atomic>
+#include <cstdint>
+
+namespace nng {
+
+struct SourceHistograms;
+class RateWindow;
+
+// Single-writer counter: a plain add the reader can load at any time
+struct ShardCounter {
+    std::atomic<uint64_t> v{0};
+    void add(uint64_t n) { v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void set(uint64_t n) { v.store(n, std::memory_order_relaxed); }
+    uint64_t get() const { return v.load(std::memory_order_relaxed); }
+};
+
+// Everything one ingest worker keeps about one source, in two cache
+// lines of its StatsShard: resolved once per frame (StatsShard::resolve)
+// and handed to the tracker, the stats and the source timer, instead of
+// each looking src_id up again. The first line is what every in-order
+// frame touches; the second holds the sequence window's address and the
+// fault counters. Fields marked writer-only are not reset with the stats.
+struct alignas(CACHE_LINE_SIZE) SourceRecord {
+    SeqState seq;                   // writer only (SequenceTracker)
+    std::atomic<bool> seen{false};  // counted since the last stats reset
+    bool timer_armed = false;       // writer only: source timer on the wheel
+    uint64_t last_frame_ns = 0;     // writer only: gateway clock of the latest frame
+    ShardCounter rx_count;
+    ShardCounter last_seq;
+    ShardCounter last_ts_ns;
+    // Created by the writer on the source's first frame / first event
+    std::atomic<SourceHistograms*> hist{nullptr};
+    std::atomic<RateWindow*> rates{nullptr};
+
+    uint64_t* window = nullptr;     // writer only: SequenceTracker::window(src_id)
+    ShardCounter malformed;
+    ShardCounter gaps;
+    ShardCounter reorders;
+    ShardCounter duplicates;
+};
+static_assert(sizeof(SourceRecord) == 2 * CACHE_LINE_SIZE, "SourceRecord must be two cache lines");
+
+} // namespace nng
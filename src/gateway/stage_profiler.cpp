@@ -0,0 +1,95 @@
+#include "gateway/stage_profiler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace nng {
+
+thread_local ThreadProfile* StageProfiler::current_ = nullptr;
+
+void ThreadProfile::reset() {
+    for (std::size_t i = 0; i < PROFILE_STAGE_COUNT; ++i) {
+        hist_[i].reset();
+        total_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+StageProfiler::StageProfiler()
+    : start_ticks_(now_ticks()), start_ns_(steady_now_ns()) {}
+
+uint64_t StageProfiler::steady_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void StageProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& p : profiles_)
+        p->reset();
+}
+
+void StageProfiler::attach(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& p : profiles_) {
+        if (p->name() == name) {
+            current_ = p.get();
+            return;
+        }
+    }
+    profiles_.push_back(std::make_unique<ThreadProfile>(name, enabled_));
+    current_ = profiles_.back().get();
+}
+
+bool StageProfiler::report(ProfileReport& out, const std::string& thread) const {
+    out = ProfileReport{};
+    out.enabled = enabled();
+#if defined(__x86_64__) || defined(__i386__)
+    out.clock = "tsc";
+    // ns per tick from how far both clocks have moved since construction
+    uint64_t ticks = now_ticks() - start_ticks_;
+    uint64_t ns = steady_now_ns() - start_ns_;
+    double ns_per_tick = ticks > 0 ? static_cast<double>(ns) / static_cast<double>(ticks) : 1.0;
+#else
+    out.clock = "steady";
+    double ns_per_tick = 1.0;
+#endif
+    auto to_ns = [ns_per_tick](uint64_t t) {
+        return static_cast<uint64_t>(static_cast<double>(t) * ns_per_tick + 0.5);
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool found = thread.empty();
+    HistogramSnapshot ticks_hist[PROFILE_STAGE_COUNT];
+    uint64_t totals[PROFILE_STAGE_COUNT] = {};
+    for (const auto& p : profiles_) {
+        out.threads.push_back(p->name());
+        if (!thread.empty() && p->name() != thread)
+            continue;
+        found = true;
+        for (std::size_t s = 0; s < PROFILE_STAGE_COUNT; ++s) {
+            auto stage = static_cast<ProfileStage>(s);
+            p->histogram(stage).add_to(ticks_hist[s]);
+            totals[s] += p->total(stage);
+        }
+    }
+    if (!found)
+        return false;
+
+    // Bucket by bucket into ns: each tick bucket's upper bound, rescaled,
+    // lands in the ns bucket it falls in
+    for (std::size_t s = 0; s < PROFILE_STAGE_COUNT; ++s) {
+        const HistogramSnapshot& src = ticks_hist[s];
+        HistogramSnapshot& dst = out.stages[s].ns;
+        for (std::size_t b = 0; b < HistogramLayout::BUCKETS; ++b) {
+            if (src.counts[b] == 0)
+                continue;
+            uint64_t v = to_ns(std::min(HistogramLayout::upper_bound(b), src.max));
+            dst.counts[HistogramLayout::bucket(v)] += src.counts[b];
+        }
+        dst.count = src.count;
+        dst.max = to_ns(src.max);
+        out.stages[s].total_ns = to_ns(totals[s]);
+    }
+    return true;
+}
+
+} // namespace nng
@@ -0,0 +1,184 @@
+#pragma once
+#include "common/histogram.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Set by the build (NNG_PROFILE option); 0 compiles every scope out
+#ifndef NNG_PROFILE
+#define NNG_PROFILE 0
+#endif
+
+namespace nng {
+
+// Hot-path stages timed by the gateway. Scopes nest: DISPATCH includes
+// LOG and PUBLISH.
+enum class ProfileStage : uint8_t {
+    RECEIVE = 0, // receive_batch() calls that returned frames (with the wait)
+    PARSE,       // parse_frames() on a batch, CRC included
+    TRACK,       // SequenceTracker::track(), per frame
+    STATS,       // stats shard updates, per frame
+    DISPATCH,    // event selection, coalescing, logging and publishing, per frame
+    LOG,         // Logger::log_event(): format + write (enqueue when async)
+    PUBLISH,     // EventBus::publish(): subscriber callbacks
+    RECORD,      // FrameRecorder writes of one batch
+};
+constexpr std::size_t PROFILE_STAGE_COUNT = 8;
+
+// Lower-case stage name ("receive", "parse", ...), indexed by ProfileStage
+constexpr const char* PROFILE_STAGE_NAMES[PROFILE_STAGE_COUNT] = {
+    "receive", "parse", "track", "stats", "dispatch", "log", "publish", "record",
+};
+
+// One thread's timings: a histogram and a running total per stage, in
+// clock ticks. Written by its thread only, readable from any thread.
+class ThreadProfile {
+public:
+    ThreadProfile(std::string name, const std::atomic<bool>& enabled)
+        : name_(std::move(name)), enabled_(enabled) {}
+
+    const std::string& name() const { return name_; }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void record(ProfileStage stage, uint64_t ticks) {
+        std::size_t i = static_cast<std::size_t>(stage);
+        hist_[i].record(ticks);
+        total_[i].store(total_[i].load(std::memory_order_relaxed) + ticks,
+                        std::memory_order_relaxed);
+    }
+
+    const Histogram& histogram(ProfileStage stage) const {
+        return hist_[static_cast<std::size_t>(stage)];
+    }
+    uint64_t total(ProfileStage stage) const {
+        return total_[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed);
+    }
+    void reset();
+
+private:
+    std::string name_;
+    const std::atomic<bool>& enabled_;
+    Histogram hist_[PROFILE_STAGE_COUNT];
+    std::atomic<uint64_t> total_[PROFILE_STAGE_COUNT] = {};
+};
+
+// A stage's timings over the threads asked for, in nanoseconds
+struct StageTiming {
+    HistogramSnapshot ns;
+    uint64_t total_ns = 0;
+};
+
+struct ProfileReport {
+    bool compiled = NNG_PROFILE != 0;
+    bool enabled = false;
+    const char* clock = "";          // "tsc" or "steady"
+    std::vector<std::string> threads; // all threads known, in attach order
+    StageTiming stages[PROFILE_STAGE_COUNT];
+};
+
+// Per-thread, per-stage timing of the gateway's hot path. Each gateway
+// thread attach()es a ThreadProfile under a fixed name ("ingest0",
+// "dispatch", ...; attaching a known name again reuses it, so counts
+// build up over restarts) and NNG_PROFILE_SCOPE records into the calling
+// thread's profile while profiling is enabled. A scope costs two clock
+// reads (the TSC where there is one) and a histogram update; disabled, a
+// thread-local and a relaxed load; built with NNG_PROFILE=0, nothing.
+//
+// TSC ticks are converted to ns at report() time, from the TSC and
+// steady_clock distance since the profiler was created.
+class StageProfiler {
+public:
+    StageProfiler();
+
+    StageProfiler(const StageProfiler&) = delete;
+    StageProfiler& operator=(const StageProfiler&) = delete;
+
+    void set_enabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Zero every thread's counts (writers racing with it may keep a few)
+    void reset();
+
+    // The calling thread's profile is name's until detach()
+    void attach(const std::string& name);
+    static void detach() { current_ = nullptr; }
+    // Calling thread's profile, or nullptr
+    static ThreadProfile* current() { return current_; }
+
+    // Merged over all threads, or the one named thread (false if unknown)
+    bool report(ProfileReport& out, const std::string& thread = std::string()) const;
+
+    static uint64_t now_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return steady_now_ns();
+#endif
+    }
+    static uint64_t steady_now_ns();
+
+private:
+    static thread_local ThreadProfile* current_;
+
+    std::atomic<bool> enabled_{false};
+    uint64_t start_ticks_;
+    uint64_t start_ns_;
+    mutable std::mutex mutex_; // guards profiles_ (not their counters)
+    std::vector<std::unique_ptr<ThreadProfile>> profiles_;
+};
+
+// Times its own lifetime into the calling thread's profile as stage
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : stage_(stage) {
+        ThreadProfile* p = StageProfiler::current();
+        if (p && p->enabled()) {
+            profile_ = p;
+            start_ = StageProfiler::now_ticks();
+        }
+    }
+    ~ProfileScope() {
+        if (profile_)
+            profile_->record(stage_, StageProfiler::now_ticks() - start_);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ThreadProfile* profile_ = nullptr;
+    ProfileStage stage_;
+    uint64_t start_ = 0;
+};
+
+// attach() for the rest of the enclosing scope
+class ProfileThread {
+public:
+    ProfileThread(StageProfiler& profiler, const std::string& name) { profiler.attach(name); }
+    ~ProfileThread() { StageProfiler::detach(); }
+
+    ProfileThread(const ProfileThread&) = delete;
+    ProfileThread& operator=(const ProfileThread&) = delete;
+};
+
+} // namespace nng
+
+#define NNG_PROFILE_CONCAT_(a, b) a##b
+#define NNG_PROFILE_CONCAT(a, b) NNG_PROFILE_CONCAT_(a, b)
+
+#if NNG_PROFILE
+#define NNG_PROFILE_SCOPE(stage) \
+    ::nng::ProfileScope NNG_PROFILE_CONCAT(nng_profile_scope_, __LINE__)(::nng::ProfileStage::stage)
+#define NNG_PROFILE_THREAD(profiler, name) \
+    ::nng::ProfileThread NNG_PROFILE_CONCAT(nng_profile_thread_, __LINE__)(profiler, name)
+#else
+#define NNG_PROFILE_SCOPE(stage) ((void)0)
+#define NNG_PROFILE_THREAD(profiler, name) ((void)0)
+#endif
@@ -1,6 +1,352 @@
 #include "gateway/stats_manager.h"
+#include <algorithm>
+#include <chrono>
 
 namespace nng {
+namespace {
+
+// Larger sender->kernel gaps mean the clocks are not comparable
+constexpr uint64_t MAX_WIRE_LATENCY_NS = 60ULL * 1000000000ULL;
+
+void merge_stage(StageLatency& dst, const StageLatency& src) {
+    dst.count    += src.count;
+    dst.total_ns += src.total_ns;
+    if (src.max_ns > dst.max_ns)
+        dst.max_ns = src.max_ns;
+}
+
+bool wire_plausible(uint64_t sender_ts_ns, uint64_t kernel_rx_ns) {
+    return sender_ts_ns <= kernel_rx_ns && kernel_rx_ns - sender_ts_ns < MAX_WIRE_LATENCY_NS;
+}
+
+// Fold per-source counts into a summed view; the most recently seen
+// shard's last_seq/last_ts_ns win
+void merge_source(SourceStats& dst, const SourceStats& src) {
+    dst.rx_count   += src.rx_count;
+    dst.malformed  += src.malformed;
+    dst.gaps       += src.gaps;
+    dst.reorders   += src.reorders;
+    dst.duplicates += src.duplicates;
+    if (src.last_ts_ns >= dst.last_ts_ns) {
+        dst.last_seq = src.last_seq;
+        dst.last_ts_ns = src.last_ts_ns;
+    }
+}
+
+void merge_global(GlobalStats& dst, const GlobalStats& src) {
+    dst.rx_total        += src.rx_total;
+    dst.malformed_total += src.malformed_total;
+    dst.gap_total       += src.gap_total;
+    dst.reorder_total   += src.reorder_total;
+    dst.duplicate_total += src.duplicate_total;
+    dst.crc_fail_total  += src.crc_fail_total;
+    dst.filtered_total  += src.filtered_total;
+}
+
+// Feed one frame into its source's histograms. prev_rx_ns is the source's
+// previous receive time (0 for its first frame).
+void record_timing(SourceHistograms& h, uint64_t prev_rx_ns, uint64_t rx_ns,
+                   uint64_t sender_ts_ns) {
+    if (prev_rx_ns != 0 && rx_ns >= prev_rx_ns)
+        h.interarrival.record(rx_ns - prev_rx_ns);
+    if (sender_ts_ns != 0 && wire_plausible(sender_ts_ns, rx_ns))
+        h.latency.record(rx_ns - sender_ts_ns);
+}
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // anonymous namespace
+
+HealthState health_of(const RateCounts& recent) {
+    if (recent[RateMetric::MALFORMED] > 0 || recent[RateMetric::CRC_FAIL] > 0)
+        return HealthState::ERROR;
+    if (recent[RateMetric::GAPS] > 0 || recent[RateMetric::REORDERS] > 0)
+        return HealthState::DEGRADED;
+    return HealthState::OK;
+}
+
+uint64_t StatsSnapshot::age_ns() const {
+    uint64_t now = steady_ns();
+    return now > taken_ns ? now - taken_ns : 0;
+}
+
+// --- StatsShard ---
+
+StatsShard::~StatsShard() {
+    for (auto& slot : pages_) {
+        Page* page = slot.load(std::memory_order_relaxed);
+        if (!page)
+            continue;
+        for (auto& c : page->sources) {
+            delete c.hist.load(std::memory_order_relaxed);
+            delete c.rates.load(std::memory_order_relaxed);
+        }
+        delete page;
+    }
+}
+
+SourceRecord& StatsShard::resolve(uint16_t src_id) {
+    auto& slot = pages_[src_id >> PAGE_BITS];
+    Page* page = slot.load(std::memory_order_relaxed); // only this thread stores
+    if (!page) {
+        page = new Page();
+        slot.store(page, std::memory_order_release);
+    }
+    SourceRecord& c = page->sources[src_id & (PAGE_SIZE - 1)];
+    if (!c.seen.load(std::memory_order_relaxed)) {
+        if (!c.rates.load(std::memory_order_relaxed))
+            c.rates.store(new RateWindow(), std::memory_order_release);
+        c.seen.store(true, std::memory_order_release);
+    }
+    return c;
+}
+
+void StatsShard::count_rate(SourceRecord& s, RateMetric m, uint32_t n) {
+    uint32_t now = rate_clock_seconds();
+    rates_.add(m, n, now);
+    s.rates.load(std::memory_order_relaxed)->add(m, n, now);
+}
+
+void StatsShard::Stage::add(uint64_t ns) {
+    count.add(1);
+    total_ns.add(ns);
+    if (ns > max_ns.get())
+        max_ns.set(ns);
+}
+
+void StatsShard::Stage::add_to(StageLatency& out) const {
+    out.count    += count.get();
+    out.total_ns += total_ns.get();
+    uint64_t m = max_ns.get();
+    if (m > out.max_ns)
+        out.max_ns = m;
+}
+
+void StatsShard::Stage::reset() {
+    count.set(0);
+    total_ns.set(0);
+    max_ns.set(0);
+}
+
+void StatsShard::record_rx(uint16_t src_id, uint32_t seq, uint64_t ts_ns,
+                           uint64_t sender_ts_ns) {
+    record_rx(resolve(src_id), seq, ts_ns, sender_ts_ns);
+}
+
+void StatsShard::record_rx(SourceRecord& s, uint32_t seq, uint64_t ts_ns,
+                           uint64_t sender_ts_ns) {
+    rx_total_.add(1);
+    SourceHistograms* hist = s.hist.load(std::memory_order_relaxed);
+    if (!hist) {
+        hist = new SourceHistograms();
+        s.hist.store(hist, std::memory_order_release);
+    }
+    record_timing(*hist, s.rx_count.get() ? s.last_ts_ns.get() : 0, ts_ns, sender_ts_ns);
+    s.rx_count.add(1);
+    s.last_seq.set(seq);
+    s.last_ts_ns.set(ts_ns);
+    count_rate(s, RateMetric::RX, 1);
+}
+
+void StatsShard::record_malformed(uint16_t src_id) {
+    malformed_total_.add(1);
+    auto& s = resolve(src_id);
+    s.malformed.add(1);
+    count_rate(s, RateMetric::MALFORMED, 1);
+}
+
+void StatsShard::record_gap(uint16_t src_id, uint32_t gap_size) {
+    record_gap(resolve(src_id), gap_size);
+}
+
+void StatsShard::record_gap(SourceRecord& s, uint32_t gap_size) {
+    gap_total_.add(gap_size);
+    s.gaps.add(gap_size);
+    count_rate(s, RateMetric::GAPS, gap_size);
+}
+
+void StatsShard::record_reorder(uint16_t src_id) {
+    record_reorder(resolve(src_id));
+}
+
+void StatsShard::record_reorder(SourceRecord& s) {
+    reorder_total_.add(1);
+    s.reorders.add(1);
+    count_rate(s, RateMetric::REORDERS, 1);
+}
+
+void StatsShard::record_duplicate(uint16_t src_id) {
+    record_duplicate(resolve(src_id));
+}
+
+void StatsShard::record_duplicate(SourceRecord& s) {
+    duplicate_total_.add(1);
+    s.duplicates.add(1);
+    count_rate(s, RateMetric::DUPLICATES, 1);
+}
+
+void StatsShard::record_crc_fail(uint16_t src_id) {
+    crc_fail_total_.add(1);
+    // CRC failures also count as malformed
+    auto& s = resolve(src_id);
+    s.malformed.add(1);
+    count_rate(s, RateMetric::CRC_FAIL, 1);
+    s.rates.load(std::memory_order_relaxed)->add(RateMetric::MALFORMED, 1, rate_clock_seconds());
+}
+
+void StatsShard::record_filtered(uint64_t count) {
+    filtered_total_.add(count);
+}
+
+void StatsShard::record_latency(uint64_t sender_ts_ns, uint64_t kernel_rx_ns,
+                                uint64_t dequeue_ns, uint64_t done_ns) {
+    if (wire_plausible(sender_ts_ns, kernel_rx_ns))
+        wire_.add(kernel_rx_ns - sender_ts_ns);
+    queue_.add(dequeue_ns > kernel_rx_ns ? dequeue_ns - kernel_rx_ns : 0);
+    process_.add(done_ns > kernel_rx_ns ? done_ns - kernel_rx_ns : 0);
+}
+
+void StatsShard::add_global(GlobalStats& out) const {
+    out.rx_total        += rx_total_.get();
+    out.malformed_total += malformed_total_.get();
+    out.gap_total       += gap_total_.get();
+    out.reorder_total   += reorder_total_.get();
+    out.duplicate_total += duplicate_total_.get();
+    out.crc_fail_total  += crc_fail_total_.get();
+    out.filtered_total  += filtered_total_.get();
+}
+
+void StatsShard::add_latency(LatencyStats& out) const {
+    wire_.add_to(out.wire);
+    queue_.add_to(out.queue);
+    process_.add_to(out.process);
+}
+
+void StatsShard::load(const SourceRecord& c, uint16_t src_id, SourceStats& out) {
+    out.src_id     = src_id;
+    out.rx_count   = c.rx_count.get();
+    out.malformed  = c.malformed.get();
+    out.gaps       = c.gaps.get();
+    out.reorders   = c.reorders.get();
+    out.duplicates = c.duplicates.get();
+    out.last_seq   = static_cast<uint32_t>(c.last_seq.get());
+    out.last_ts_ns = c.last_ts_ns.get();
+}
+
+bool StatsShard::add_source(uint16_t src_id, SourceStats& out) const {
+    const Page* page = pages_[src_id >> PAGE_BITS].load(std::memory_order_acquire);
+    if (!page)
+        return false;
+    const SourceRecord& c = page->sources[src_id & (PAGE_SIZE - 1)];
+    if (!c.seen.load(std::memory_order_acquire))
+        return false;
+    SourceStats s;
+    load(c, src_id, s);
+    out.src_id = src_id;
+    merge_source(out, s);
+    return true;
+}
+
+void StatsShard::add_sources(std::unordered_map<uint16_t, SourceStats>& out) const {
+    for (std::size_t p = 0; p < PAGE_COUNT; ++p) {
+        const Page* page = pages_[p].load(std::memory_order_acquire);
+        if (!page)
+            continue;
+        for (std::size_t i = 0; i < PAGE_SIZE; ++i) {
+            const SourceRecord& c = page->sources[i];
+            if (!c.seen.load(std::memory_order_acquire))
+                continue;
+            auto src_id = static_cast<uint16_t>((p << PAGE_BITS) | i);
+            SourceStats s;
+            load(c, src_id, s);
+            auto& dst = out[src_id];
+            dst.src_id = src_id;
+            merge_source(dst, s);
+        }
+    }
+}
+
+void StatsShard::add_latency_histograms(int src_id, SourceLatency& out) const {
+    auto add = [&out](const SourceRecord& c) {
+        const SourceHistograms* h = c.hist.load(std::memory_order_acquire);
+        if (h) {
+            h->interarrival.add_to(out.interarrival);
+            h->latency.add_to(out.latency);
+        }
+    };
+    if (src_id >= 0) {
+        const Page* page = pages_[src_id >> PAGE_BITS].load(std::memory_order_acquire);
+        if (page)
+            add(page->sources[src_id & (PAGE_SIZE - 1)]);
+        return;
+    }
+    for (const auto& slot : pages_) {
+        const Page* page = slot.load(std::memory_order_acquire);
+        if (!page)
+            continue;
+        for (const auto& c : page->sources)
+            add(c);
+    }
+}
+
+void StatsShard::add_rate_windows(int src_id, std::vector<const RateWindow*>& out) const {
+    if (src_id < 0) {
+        out.push_back(&rates_);
+        return;
+    }
+    const Page* page = pages_[src_id >> PAGE_BITS].load(std::memory_order_acquire);
+    if (!page)
+        return;
+    const SourceRecord& c = page->sources[src_id & (PAGE_SIZE - 1)];
+    if (c.seen.load(std::memory_order_acquire))
+        out.push_back(c.rates.load(std::memory_order_acquire));
+}
+
+void StatsShard::reset() {
+    for (Counter* c : {&rx_total_, &malformed_total_, &gap_total_, &reorder_total_,
+                       &duplicate_total_, &crc_fail_total_, &filtered_total_})
+        c->set(0);
+    wire_.reset();
+    queue_.reset();
+    process_.reset();
+    rates_.reset();
+    for (auto& slot : pages_) {
+        Page* page = slot.load(std::memory_order_acquire);
+        if (!page)
+            continue;
+        for (auto& c : page->sources) {
+            c.seen.store(false, std::memory_order_relaxed);
+            for (Counter* f : {&c.rx_count, &c.malformed, &c.gaps, &c.reorders,
+                               &c.duplicates, &c.last_seq, &c.last_ts_ns})
+                f->set(0);
+            if (SourceHistograms* h = c.hist.load(std::memory_order_acquire)) {
+                h->interarrival.reset();
+                h->latency.reset();
+            }
+            if (RateWindow* r = c.rates.load(std::memory_order_acquire))
+                r->reset();
+        }
+    }
+}
+
+void StatsShard::reset_writer_state() {
+    for (auto& slot : pages_) {
+        Page* page = slot.load(std::memory_order_acquire);
+        if (!page)
+            continue;
+        for (auto& c : page->sources) {
+            c.seq = SeqState{};
+            c.window = nullptr;
+            c.timer_armed = false;
+            c.last_frame_ns = 0;
+        }
+    }
+}
+
+// --- StatsManager ---
 
 SourceStats& StatsManager::get_or_create_source(uint16_t src_id) {
     auto it = sources_.find(src_id);
@@ -12,37 +358,56 @@ SourceStats& StatsManager::get_or_create_source(uint16_t src_id) {
     return it->second;
 }
 
-void StatsManager::record_rx(uint16_t src_id, uint32_t seq, uint64_t ts_ns) {
+void StatsManager::count_rate(uint16_t src_id, RateMetric m, uint32_t n) {
+    uint32_t now = rate_clock_seconds();
+    rates_.add(m, n, now);
+    auto& r = source_rates_[src_id];
+    if (!r)
+        r = std::make_unique<RateWindow>();
+    r->add(m, n, now);
+}
+
+void StatsManager::record_rx(uint16_t src_id, uint32_t seq, uint64_t ts_ns,
+                             uint64_t sender_ts_ns) {
     std::unique_lock lock(mutex_);
     global_.rx_total++;
     auto& s = get_or_create_source(src_id);
+    auto& hist = histograms_[src_id];
+    if (!hist)
+        hist = std::make_unique<SourceHistograms>();
+    record_timing(*hist, s.rx_count ? s.last_ts_ns : 0, ts_ns, sender_ts_ns);
     s.rx_count++;
     s.last_seq = seq;
     s.last_ts_ns = ts_ns;
+    count_rate(src_id, RateMetric::RX, 1);
 }
 
 void StatsManager::record_malformed(uint16_t src_id) {
     std::unique_lock lock(mutex_);
     global_.malformed_total++;
     get_or_create_source(src_id).malformed++;
+    count_rate(src_id, RateMetric::MALFORMED, 1);
 }
 
 void StatsManager::record_gap(uint16_t src_id, uint32_t gap_size) {
     std::unique_lock lock(mutex_);
     global_.gap_total += gap_size;
     get_or_create_source(src_id).gaps += gap_size;
+    count_rate(src_id, RateMetric::GAPS, gap_size);
 }
 
 void StatsManager::record_reorder(uint16_t src_id) {
     std::unique_lock lock(mutex_);
     global_.reorder_total++;
     get_or_create_source(src_id).reorders++;
+    count_rate(src_id, RateMetric::REORDERS, 1);
 }
 
 void StatsManager::record_duplicate(uint16_t src_id) {
     std::unique_lock lock(mutex_);
     global_.duplicate_total++;
     get_or_create_source(src_id).duplicates++;
+    count_rate(src_id, RateMetric::DUPLICATES, 1);
 }
 
 void StatsManager::record_crc_fail(uint16_t src_id) {
@@ -50,43 +415,313 @@ void StatsManager::record_crc_fail(uint16_t src_id) {
     global_.crc_fail_total++;
     // CRC failures also count as malformed
     get_or_create_source(src_id).malformed++;
+    count_rate(src_id, RateMetric::CRC_FAIL, 1);
+    source_rates_[src_id]->add(RateMetric::MALFORMED, 1, rate_clock_seconds());
+}
+
+void StatsManager::record_filtered(uint64_t count) {
+    std::unique_lock lock(mutex_);
+    global_.filtered_total += count;
+}
+
+void StatsManager::record_latency(uint64_t sender_ts_ns, uint64_t kernel_rx_ns,
+                                  uint64_t dequeue_ns, uint64_t done_ns) {
+    std::unique_lock lock(mutex_);
+    if (wire_plausible(sender_ts_ns, kernel_rx_ns))
+        latency_.wire.add(kernel_rx_ns - sender_ts_ns);
+    latency_.queue.add(dequeue_ns > kernel_rx_ns ? dequeue_ns - kernel_rx_ns : 0);
+    latency_.process.add(done_ns > kernel_rx_ns ? done_ns - kernel_rx_ns : 0);
+}
+
+GlobalStats StatsManager::global_locked() const {
+    GlobalStats g = global_;
+    for (const auto& shard : shards_)
+        shard->add_global(g);
+    return g;
 }
 
 GlobalStats StatsManager::get_global_stats() const {
     std::shared_lock lock(mutex_);
-    return global_;
+    return global_locked();
 }
 
 SourceStats StatsManager::get_source_stats(uint16_t src_id) const {
     std::shared_lock lock(mutex_);
+    SourceStats s;
     auto it = sources_.find(src_id);
-    if (it == sources_.end())
-        return SourceStats{};
-    return it->second;
+    if (it != sources_.end())
+        s = it->second;
+    for (const auto& shard : shards_)
+        shard->add_source(src_id, s);
+    return s;
 }
 
 std::vector<SourceStats> StatsManager::get_all_source_stats() const {
     std::shared_lock lock(mutex_);
+    return get_all_locked();
+}
+
+std::vector<SourceStats> StatsManager::get_all_locked() const {
     std::vector<SourceStats> result;
-    result.reserve(sources_.size());
-    for (const auto& [id, s] : sources_)
+    if (shards_.empty()) {
+        result.reserve(sources_.size());
+        for (const auto& [id, s] : sources_)
+            result.push_back(s);
+        return result;
+    }
+
+    auto sources = sources_;
+    for (const auto& shard : shards_)
+        shard->add_sources(sources);
+    result.reserve(sources.size());
+    for (const auto& [id, s] : sources)
         result.push_back(s);
     return result;
 }
 
+void StatsManager::get_all_source_stats(std::vector<SourceStats>& out) const {
+    out.clear();
+    std::shared_lock lock(mutex_);
+    for (const auto& [id, s] : sources_)
+        out.push_back(s);
+    std::sort(out.begin(), out.end(),
+              [](const SourceStats& a, const SourceStats& b) { return a.src_id < b.src_id; });
+    if (shards_.empty())
+        return;
+
+    // Merge the manager's own (sorted) entries with the shard pages, walked
+    // in id order. Results are appended after the own entries, which are
+    // dropped at the end, so nothing but out is touched.
+    const std::size_t own = out.size();
+    std::size_t next = 0;
+    for (std::size_t p = 0; p < StatsShard::PAGE_COUNT; ++p) {
+        bool any = false;
+        for (const auto& shard : shards_)
+            any = any || shard->has_page(p);
+        if (!any)
+            continue;
+        for (std::size_t i = 0; i < StatsShard::PAGE_SIZE; ++i) {
+            auto src_id = static_cast<uint16_t>((p << StatsShard::PAGE_BITS) | i);
+            while (next < own && out[next].src_id < src_id) {
+                SourceStats only_own = out[next++];
+                out.push_back(only_own);
+            }
+            SourceStats s;
+            bool seen = false;
+            if (next < own && out[next].src_id == src_id) {
+                s = out[next++];
+                seen = true;
+            }
+            for (const auto& shard : shards_)
+                seen = shard->add_source(src_id, s) || seen;
+            if (seen)
+                out.push_back(s);
+        }
+    }
+    while (next < own) {
+        SourceStats only_own = out[next++];
+        out.push_back(only_own);
+    }
+    out.erase(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(own));
+}
+
+LatencyStats StatsManager::get_latency_stats() const {
+    std::shared_lock lock(mutex_);
+    LatencyStats lat = latency_;
+    for (const auto& shard : shards_)
+        shard->add_latency(lat);
+    return lat;
+}
+
+bool StatsManager::get_source_latency(uint16_t src_id, SourceLatency& out) const {
+    out = SourceLatency{};
+    std::shared_lock lock(mutex_);
+    bool seen = false;
+    auto it = histograms_.find(src_id);
+    if (it != histograms_.end()) {
+        it->second->interarrival.add_to(out.interarrival);
+        it->second->latency.add_to(out.latency);
+        seen = true;
+    }
+    for (const auto& shard : shards_) {
+        SourceStats ignored;
+        if (shard->add_source(src_id, ignored)) {
+            shard->add_latency_histograms(src_id, out);
+            seen = true;
+        }
+    }
+    return seen;
+}
+
+SourceLatency StatsManager::get_all_source_latency() const {
+    SourceLatency out;
+    std::shared_lock lock(mutex_);
+    for (const auto& [id, h] : histograms_) {
+        h->interarrival.add_to(out.interarrival);
+        h->latency.add_to(out.latency);
+    }
+    for (const auto& shard : shards_)
+        shard->add_latency_histograms(-1, out);
+    return out;
+}
+
+std::vector<const RateWindow*> StatsManager::rate_windows_locked(int src_id) const {
+    std::vector<const RateWindow*> windows;
+    if (src_id < 0) {
+        windows.push_back(&rates_);
+    } else {
+        auto it = source_rates_.find(static_cast<uint16_t>(src_id));
+        if (it != source_rates_.end())
+            windows.push_back(it->second.get());
+    }
+    for (const auto& shard : shards_)
+        shard->add_rate_windows(src_id, windows);
+    return windows;
+}
+
+HealthState StatsManager::health_locked() const {
+    RateCounts recent;
+    uint32_t now = rate_clock_seconds();
+    // Summed in place: the health gauge is read on every metrics scrape
+    rates_.sum(now, HEALTH_WINDOW_S, recent);
+    for (const auto& shard : shards_)
+        shard->rates().sum(now, HEALTH_WINDOW_S, recent);
+    return health_of(recent);
+}
+
+WindowedRates StatsManager::get_global_rates() const {
+    uint32_t now = rate_clock_seconds();
+    std::shared_lock lock(mutex_);
+    return windowed_rates(rate_windows_locked(-1), now);
+}
+
+bool StatsManager::get_source_rates(uint16_t src_id, WindowedRates& out) const {
+    uint32_t now = rate_clock_seconds();
+    std::shared_lock lock(mutex_);
+    auto windows = rate_windows_locked(src_id);
+    if (windows.empty())
+        return false;
+    out = windowed_rates(windows, now);
+    return true;
+}
+
 HealthState StatsManager::get_health() const {
     std::shared_lock lock(mutex_);
-    if (global_.malformed_total > 0 || global_.crc_fail_total > 0)
-        return HealthState::ERROR;
-    if (global_.gap_total > 0 || global_.reorder_total > 0)
-        return HealthState::DEGRADED;
-    return HealthState::OK;
+    return health_locked();
+}
+
+std::shared_ptr<const StatsSnapshot> StatsManager::publish_snapshot() const {
+    std::lock_guard<std::mutex> publish(publish_mutex_);
+    auto snap = std::make_shared<StatsSnapshot>();
+    {
+        std::shared_lock lock(mutex_);
+        snap->global = global_locked();
+        snap->sources = get_all_locked();
+        snap->latency = latency_;
+        for (const auto& shard : shards_)
+            shard->add_latency(snap->latency);
+        snap->health = health_locked();
+        snap->rates = windowed_rates(rate_windows_locked(-1), rate_clock_seconds());
+    }
+    std::sort(snap->sources.begin(), snap->sources.end(),
+              [](const SourceStats& a, const SourceStats& b) { return a.src_id < b.src_id; });
+    snap->version = ++snapshot_version_;
+    snap->taken_ns = steady_ns();
+
+    std::shared_ptr<const StatsSnapshot> published = std::move(snap);
+    std::atomic_store(&snapshot_, published);
+    return published;
+}
+
+std::shared_ptr<const StatsSnapshot> StatsManager::snapshot(uint64_t max_age_ns) const {
+    auto current = std::atomic_load(&snapshot_);
+    if (current && max_age_ns > 0 && current->age_ns() <= max_age_ns)
+        return current;
+
+    // Someone else is rebuilding: their result is at most one build newer
+    if (current && max_age_ns > 0) {
+        std::unique_lock<std::mutex> busy(publish_mutex_, std::try_to_lock);
+        if (!busy.owns_lock())
+            return current;
+    }
+    return publish_snapshot();
 }
 
 void StatsManager::reset() {
     std::unique_lock lock(mutex_);
     global_ = GlobalStats{};
+    latency_ = LatencyStats{};
     sources_.clear();
+    histograms_.clear();
+    rates_.reset();
+    source_rates_.clear();
+    for (auto& shard : shards_)
+        shard->reset();
+    std::atomic_store(&snapshot_, std::shared_ptr<const StatsSnapshot>());
+}
+
+void StatsManager::set_writer_shards(std::size_t n) {
+    std::unique_lock lock(mutex_);
+    while (shards_.size() < n)
+        shards_.push_back(std::make_unique<StatsShard>());
+}
+
+std::size_t StatsManager::writer_shards() const {
+    std::shared_lock lock(mutex_);
+    return shards_.size();
+}
+
+StatsShard& StatsManager::shard(std::size_t i) {
+    std::shared_lock lock(mutex_);
+    return *shards_[i];
+}
+
+void StatsManager::merge_from(const std::vector<const StatsManager*>& shards) {
+    GlobalStats global;
+    LatencyStats latency;
+    std::unordered_map<uint16_t, SourceStats> sources;
+    std::unordered_map<uint16_t, std::unique_ptr<SourceHistograms>> histograms;
+    RateWindow rates;
+    std::unordered_map<uint16_t, std::unique_ptr<RateWindow>> source_rates;
+
+    for (const StatsManager* shard : shards) {
+        if (!shard || shard == this)
+            continue;
+        std::shared_lock shard_lock(shard->mutex_);
+        merge_global(global, shard->global_);
+        merge_stage(latency.wire, shard->latency_.wire);
+        merge_stage(latency.queue, shard->latency_.queue);
+        merge_stage(latency.process, shard->latency_.process);
+
+        for (const auto& [id, src] : shard->sources_) {
+            auto& dst = sources[id];
+            dst.src_id = id;
+            merge_source(dst, src);
+        }
+        for (const auto& [id, h] : shard->histograms_) {
+            auto& dst = histograms[id];
+            if (!dst)
+                dst = std::make_unique<SourceHistograms>();
+            dst->interarrival.add(h->interarrival);
+            dst->latency.add(h->latency);
+        }
+        rates.merge(shard->rates_);
+        for (const auto& [id, r] : shard->source_rates_) {
+            auto& dst = source_rates[id];
+            if (!dst)
+                dst = std::make_unique<RateWindow>();
+            dst->merge(*r);
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    global_ = global;
+    latency_ = latency;
+    sources_.swap(sources);
+    histograms_.swap(histograms);
+    rates_.reset();
+    rates_.merge(rates);
+    source_rates_.swap(source_rates);
 }
 
 } // namespace nng
@@ -1,6 +1,12 @@
 #pragma once
 #include "common/types.h"
+#include "common/spsc_ring.h"
+#include "common/histogram.h"
+#include "gateway/rate_window.h"
+#include "gateway/source_record.h"
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
@@ -15,6 +21,7 @@ struct GlobalStats {
     uint64_t reorder_total   = 0;
     uint64_t duplicate_total = 0;
     uint64_t crc_fail_total  = 0;
+    uint64_t filtered_total  = 0; // dropped by the ingress filter
 };
 
 struct SourceStats {
@@ -28,31 +35,261 @@ struct SourceStats {
     uint64_t last_ts_ns = 0;
 };
 
+// Running latency of one ingest stage, in nanoseconds
+struct StageLatency {
+    uint64_t count    = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns   = 0;
+
+    void add(uint64_t ns) {
+        count++;
+        total_ns += ns;
+        if (ns > max_ns)
+            max_ns = ns;
+    }
+    uint64_t mean_ns() const { return count ? total_ns / count : 0; }
+};
+
+// Where time goes between the sender and the end of processing. All
+// points are CLOCK_REALTIME; only frames with a kernel timestamp count.
+struct LatencyStats {
+    StageLatency wire;    // sender ts_ns -> kernel receive (comparable clocks only)
+    StageLatency queue;   // kernel receive -> dequeued by the gateway
+    StageLatency process; // kernel receive -> processing complete
+};
+
+// Per-source timing, fixed memory: gap between consecutive frames'
+// receive times, and receive time minus the sender's header.ts_ns (only
+// when the clocks look comparable, as for LatencyStats::wire)
+struct SourceHistograms {
+    Histogram interarrival;
+    Histogram latency;
+};
+
+struct SourceLatency {
+    HistogramSnapshot interarrival;
+    HistogramSnapshot latency;
+};
+
 enum class HealthState { OK, DEGRADED, ERROR };
 
+// Health from a span of recent counts: ERROR on malformed or CRC failures,
+// DEGRADED on gaps or reorders, OK otherwise
+HealthState health_of(const RateCounts& recent);
+
+// Immutable point-in-time copy of all counters, published by
+// StatsManager::snapshot(). Each counter is read atomically, but shard
+// writers keep running while it is built, so counters are not consistent
+// with one another (a frame may be in rx_total but not yet in its
+// source's rx_count). Sources are sorted by src_id.
+struct StatsSnapshot {
+    GlobalStats global;
+    LatencyStats latency;
+    std::vector<SourceStats> sources;
+    HealthState health = HealthState::OK;
+    WindowedRates rates;   // all sources
+    uint64_t version  = 0; // increases with every publish
+    uint64_t taken_ns = 0; // steady-clock time it was built
+
+    uint64_t age_ns() const;
+};
+
+// Stats written by exactly one thread (an ingest worker) and readable from
+// any thread. Writers do relaxed load + store on atomics: no locks, no
+// read-modify-write, no allocation once a source's page exists. Global
+// and latency counters sit on their own cache lines, so shards of
+// different workers never share a line. Readers see each counter
+// atomically, not the shard as a whole.
+//
+// Per-source state lives in SourceRecords, which the writer can resolve
+// once per frame and pass to the record_*() overloads taking one (and to
+// SequenceTracker and its source timer); the src_id overloads resolve it
+// themselves.
+class StatsShard {
+public:
+    StatsShard() = default;
+    ~StatsShard();
+
+    StatsShard(const StatsShard&) = delete;
+    StatsShard& operator=(const StatsShard&) = delete;
+
+    // Writer side (the owning thread only); same meaning as StatsManager's
+    void record_rx(uint16_t src_id, uint32_t seq, uint64_t ts_ns, uint64_t sender_ts_ns = 0);
+    void record_malformed(uint16_t src_id);
+    void record_gap(uint16_t src_id, uint32_t gap_size);
+    void record_reorder(uint16_t src_id);
+    void record_duplicate(uint16_t src_id);
+    void record_crc_fail(uint16_t src_id);
+    void record_filtered(uint64_t count);
+    void record_latency(uint64_t sender_ts_ns, uint64_t kernel_rx_ns,
+                        uint64_t dequeue_ns, uint64_t done_ns);
+
+    // The source's record (created on first use, and counted as seen)
+    SourceRecord& resolve(uint16_t src_id);
+    void record_rx(SourceRecord& s, uint32_t seq, uint64_t ts_ns, uint64_t sender_ts_ns = 0);
+    void record_gap(SourceRecord& s, uint32_t gap_size);
+    void record_reorder(SourceRecord& s);
+    void record_duplicate(SourceRecord& s);
+
+    // Reader side (any thread): add this shard's counts into the totals
+    void add_global(GlobalStats& out) const;
+    void add_latency(LatencyStats& out) const;
+    void add_sources(std::unordered_map<uint16_t, SourceStats>& out) const;
+    // Add one source's counts; false if this shard has not seen it
+    bool add_source(uint16_t src_id, SourceStats& out) const;
+    // Add one source's histograms (src_id < 0: every source's)
+    void add_latency_histograms(int src_id, SourceLatency& out) const;
+    // Append the shard's rate window for one source (src_id < 0: the
+    // shard-wide one); nothing if the shard has not seen the source
+    void add_rate_windows(int src_id, std::vector<const RateWindow*>& out) const;
+    // The shard-wide rate window
+    const RateWindow& rates() const { return rates_; }
+
+    // Zero every counter. Increments racing with it may be lost.
+    void reset();
+    // Clear the records' writer-only fields (sequence state and window,
+    // source timer) for a new writer with its own tracker and timers;
+    // counts are kept. Call while no writer is running.
+    void reset_writer_state();
+
+    // Sources are stored in pages of PAGE_SIZE consecutive ids
+    static constexpr std::size_t PAGE_BITS = 8;
+    static constexpr std::size_t PAGE_SIZE = std::size_t{1} << PAGE_BITS;
+    static constexpr std::size_t PAGE_COUNT = 65536 / PAGE_SIZE;
+    // false if the shard has seen no source in page p
+    bool has_page(std::size_t p) const {
+        return pages_[p].load(std::memory_order_acquire) != nullptr;
+    }
+
+private:
+    using Counter = ShardCounter;
+
+    struct Stage {
+        Counter count;
+        Counter total_ns;
+        Counter max_ns;
+        void add(uint64_t ns);
+        void add_to(StageLatency& out) const;
+        void reset();
+    };
+
+    struct Page {
+        SourceRecord sources[PAGE_SIZE];
+    };
+
+    static void load(const SourceRecord& c, uint16_t src_id, SourceStats& out);
+    void count_rate(SourceRecord& s, RateMetric m, uint32_t n);
+
+    alignas(CACHE_LINE_SIZE) Counter rx_total_;
+    Counter malformed_total_;
+    Counter gap_total_;
+    Counter reorder_total_;
+    Counter duplicate_total_;
+    Counter crc_fail_total_;
+    Counter filtered_total_;
+    alignas(CACHE_LINE_SIZE) Stage wire_;
+    Stage queue_;
+    Stage process_;
+    alignas(CACHE_LINE_SIZE) RateWindow rates_;
+    // Pages are created by the writer and published with a release store
+    alignas(CACHE_LINE_SIZE) std::atomic<Page*> pages_[PAGE_COUNT] = {};
+};
+
+// Process-wide stats. record_*() update the manager's own counters under
+// a lock. For many writer threads, set_writer_shards() gives each writer
+// its own StatsShard instead; the get_*() readers sum the shards without
+// ever blocking their writers.
 class StatsManager {
 public:
-    void record_rx(uint16_t src_id, uint32_t seq, uint64_t ts_ns);
+    // ts_ns is the receive time. With sender_ts_ns (header.ts_ns), also
+    // feeds the source's latency histogram; inter-arrival times come from
+    // consecutive ts_ns.
+    void record_rx(uint16_t src_id, uint32_t seq, uint64_t ts_ns, uint64_t sender_ts_ns = 0);
     void record_malformed(uint16_t src_id);
     void record_gap(uint16_t src_id, uint32_t gap_size);
     void record_reorder(uint16_t src_id);
     void record_duplicate(uint16_t src_id);
     void record_crc_fail(uint16_t src_id);
+    // Frames rejected by the ingress filter (counted per batch, not per source)
+    void record_filtered(uint64_t count);
+
+    // Record one frame's timeline. The wire stage is skipped when the
+    // sender timestamp is not a plausible wall-clock time before the kernel
+    // receive (e.g. simulation-relative timestamps).
+    void record_latency(uint64_t sender_ts_ns, uint64_t kernel_rx_ns,
+                        uint64_t dequeue_ns, uint64_t done_ns);
 
     GlobalStats get_global_stats() const;
     SourceStats get_source_stats(uint16_t src_id) const;
     std::vector<SourceStats> get_all_source_stats() const;
+    // Same, sorted by src_id, into out (cleared first). Reuses out's
+    // capacity, so repeated calls stop allocating once it is big enough.
+    void get_all_source_stats(std::vector<SourceStats>& out) const;
+    LatencyStats get_latency_stats() const;
+    // One source's histograms; false if it has not been seen
+    bool get_source_latency(uint16_t src_id, SourceLatency& out) const;
+    // Histograms of all sources combined
+    SourceLatency get_all_source_latency() const;
 
+    // ERROR if anything was malformed or failed CRC in the last
+    // HEALTH_WINDOW_S seconds (including the current one), DEGRADED on
+    // recent gaps or reorders, OK otherwise. Recovers once faults stop.
     HealthState get_health() const;
+    static constexpr uint32_t HEALTH_WINDOW_S = 10;
 
+    // Per-second rates over the last 1/10/60 completed seconds, kept in a
+    // per-second ring updated in O(1) with each event
+    WindowedRates get_global_rates() const;
+    // false if the source has not been seen
+    bool get_source_rates(uint16_t src_id, WindowedRates& out) const;
+
+    // Latest published snapshot, rebuilt first if it is older than
+    // max_age_ns (0: always rebuild). Readers share one snapshot via an
+    // atomic pointer swap; a reader that finds a rebuild already running
+    // takes the previous snapshot instead of waiting. Shard writers are
+    // never blocked.
+    std::shared_ptr<const StatsSnapshot> snapshot(uint64_t max_age_ns = 0) const;
+    // Build and publish a fresh snapshot now
+    std::shared_ptr<const StatsSnapshot> publish_snapshot() const;
+
+    // Zero all counters, including shards (see StatsShard::reset)
     void reset();
 
+    // Make at least n writer shards available (existing ones are kept, so
+    // counts survive a restart). Call while no writer is running.
+    void set_writer_shards(std::size_t n);
+    std::size_t writer_shards() const;
+    // Shard i for one writer thread's record_*() calls; i < writer_shards()
+    StatsShard& shard(std::size_t i);
+
+    // Replace this manager's contents with the sum of the given shards
+    // (e.g. one per ingest worker). Per-source last_seq/last_ts_ns are taken
+    // from the shard that saw the source most recently.
+    void merge_from(const std::vector<const StatsManager*>& shards);
+
 private:
     mutable std::shared_mutex mutex_;
     GlobalStats global_;
+    LatencyStats latency_;
     std::unordered_map<uint16_t, SourceStats> sources_;
+    std::unordered_map<uint16_t, std::unique_ptr<SourceHistograms>> histograms_;
+    RateWindow rates_;
+    std::unordered_map<uint16_t, std::unique_ptr<RateWindow>> source_rates_;
+    std::vector<std::unique_ptr<StatsShard>> shards_; // guarded by mutex_
+
+    // Accessed with std::atomic_load/atomic_store
+    mutable std::shared_ptr<const StatsSnapshot> snapshot_;
+    mutable std::mutex publish_mutex_; // one snapshot build at a time
+    mutable uint64_t snapshot_version_ = 0; // guarded by publish_mutex_
 
     SourceStats& get_or_create_source(uint16_t src_id);
+    // Under at least a shared lock of mutex_: own counts plus the shards'
+    GlobalStats global_locked() const;
+    std::vector<SourceStats> get_all_locked() const;
+    std::vector<const RateWindow*> rate_windows_locked(int src_id) const;
+    HealthState health_locked() const;
+    // Under the unique lock
+    void count_rate(uint16_t src_id, RateMetric m, uint32_t n);
 };
 
 } // namespace nng
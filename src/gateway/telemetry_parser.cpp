@@ -1,9 +1,28 @@
 #include "gateway/telemetry_parser.h"
 #include "common/crc32.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace nng {
 
+const char* parse_error_str(ParseError err) {
+    switch (err) {
+        case ParseError::OK:               return "OK";
+        case ParseError::TOO_SHORT:        return "TOO_SHORT";
+        case ParseError::BAD_VERSION:      return "BAD_VERSION";
+        case ParseError::BAD_MSG_TYPE:     return "BAD_MSG_TYPE";
+        case ParseError::PAYLOAD_TOO_LONG: return "PAYLOAD_TOO_LONG";
+        case ParseError::TRUNCATED:        return "TRUNCATED";
+        case ParseError::CRC_MISMATCH:     return "CRC_MISMATCH";
+    }
+    return "UNKNOWN";
+}
+
 ParseError parse_frame(const uint8_t* buf, std::size_t len,
                        bool crc_enabled, ParsedFrame& out) {
     // Minimum size check
@@ -20,7 +39,7 @@ ParseError parse_frame(const uint8_t* buf, std::size_t len,
     // Message type check
     uint8_t mt = out.header.msg_type;
     if (mt < static_cast<uint8_t>(MsgType::PLOT) ||
-        mt > static_cast<uint8_t>(MsgType::ENGAGEMENT))
+        mt > MSG_TYPE_MAX)
         return ParseError::BAD_MSG_TYPE;
 
     // Payload length check
@@ -56,4 +75,250 @@ ParseError parse_frame(const uint8_t* buf, std::size_t len,
     return ParseError::OK;
 }
 
+void ParsedFrameBatch::reserve(std::size_t n) {
+    if (errors.size() >= n)
+        return;
+    errors.resize(n);
+    headers.resize(n);
+    payload_ptrs.resize(n);
+    crcs.resize(n);
+    sources.resize(n);
+    frame_lens.resize(n);
+    error_bits.resize((n + 63) / 64);
+}
+
+ParsedFrame ParsedFrameBatch::frame(std::size_t i) const {
+    ParsedFrame f;
+    f.header = headers[i];
+    f.payload_ptr = payload_ptrs[i];
+    f.crc = crcs[i];
+    f.has_crc = has_crc;
+    return f;
+}
+
+namespace {
+
+constexpr std::size_t LANES = 16;
+
+#if defined(__SSE2__)
+// Header checks for LANES frames: bit i set when frame first+i passes the
+// version, msg_type and length checks. Failing frames get the scalar parser.
+uint32_t header_pass_mask(const FrameView* frames, bool crc_enabled) {
+    alignas(16) uint8_t  version[LANES];
+    alignas(16) uint8_t  msg_type[LANES];
+    alignas(16) uint16_t payload_len[LANES];
+    alignas(16) uint16_t frame_len[LANES];
+
+    // Gather the header fields; short frames get a zero version and fail
+    for (std::size_t i = 0; i < LANES; ++i) {
+        const FrameView& f = frames[i];
+        if (f.len >= FRAME_HEADER_SIZE) {
+            HeaderView h(f.data);
+            version[i] = h.version();
+            msg_type[i] = h.msg_type();
+            payload_len[i] = h.payload_len();
+        } else {
+            version[i] = 0;
+            msg_type[i] = 0;
+            payload_len[i] = 0;
+        }
+        frame_len[i] = static_cast<uint16_t>(f.len < 0xFFFF ? f.len : 0xFFFF);
+    }
+
+    // version == PROTOCOL_VERSION and PLOT <= msg_type <= MSG_TYPE_MAX
+    const uint8_t mt_lo = static_cast<uint8_t>(MsgType::PLOT);
+    const uint8_t mt_span = MSG_TYPE_MAX - mt_lo;
+    __m128i ver = _mm_load_si128(reinterpret_cast<const __m128i*>(version));
+    __m128i mt = _mm_sub_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(msg_type)),
+                              _mm_set1_epi8(static_cast<char>(mt_lo)));
+    __m128i good = _mm_and_si128(
+        _mm_cmpeq_epi8(ver, _mm_set1_epi8(static_cast<char>(PROTOCOL_VERSION))),
+        _mm_cmpeq_epi8(_mm_min_epu8(mt, _mm_set1_epi8(static_cast<char>(mt_span))), mt));
+
+    // payload_len <= MAX_PAYLOAD_SIZE and header + payload (+ crc) <= len.
+    // SSE2 only compares signed 16-bit lanes, so flip the sign bits first.
+    const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i max_pl = _mm_xor_si128(_mm_set1_epi16(static_cast<short>(MAX_PAYLOAD_SIZE)), flip);
+    const __m128i overhead = _mm_set1_epi16(static_cast<short>(
+        FRAME_HEADER_SIZE + (crc_enabled ? FRAME_CRC_SIZE : 0)));
+    __m128i bad[2];
+    for (int h = 0; h < 2; ++h) {
+        __m128i pl = _mm_load_si128(reinterpret_cast<const __m128i*>(payload_len + h * 8));
+        __m128i len = _mm_load_si128(reinterpret_cast<const __m128i*>(frame_len + h * 8));
+        // A wrapped expected length only occurs when payload_len is too long
+        __m128i expected = _mm_add_epi16(pl, overhead);
+        bad[h] = _mm_or_si128(
+            _mm_cmpgt_epi16(_mm_xor_si128(pl, flip), max_pl),
+            _mm_cmpgt_epi16(_mm_xor_si128(expected, flip), _mm_xor_si128(len, flip)));
+    }
+    __m128i bad8 = _mm_packs_epi16(bad[0], bad[1]);
+
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_andnot_si128(bad8, good)));
+}
+#endif
+
+// Appends results to a ParsedFrameBatch, growing it as containers expand
+struct ResultWriter {
+    ParsedFrameBatch& out;
+    const IngressFilter* filter;
+    std::size_t n = 0;
+
+    // True if the filter drops a frame with this header (and counts it)
+    bool rejects(uint16_t src_id, uint8_t msg_type) {
+        if (!filter || filter->allows(src_id, msg_type))
+            return false;
+        ++out.filtered_count;
+        return true;
+    }
+
+    void emit(ParseError err, const ParsedFrame& pf, std::size_t source, std::size_t len) {
+        begin();
+        out.headers[n] = pf.header;
+        finish(err, pf.payload_ptr, pf.crc, source, len);
+    }
+
+    // A header still in the datagram: copied into the results directly
+    void emit(ParseError err, HeaderView header, const uint8_t* payload, uint32_t crc,
+              std::size_t source, std::size_t len) {
+        begin();
+        out.headers[n] = header.copy();
+        finish(err, payload, crc, source, len);
+    }
+
+    void begin() {
+        if (n >= out.errors.size())
+            out.reserve(n < 32 ? 64 : n * 2);
+    }
+
+    void finish(ParseError err, const uint8_t* payload, uint32_t crc, std::size_t source,
+                std::size_t len) {
+        out.errors[n] = err;
+        out.payload_ptrs[n] = payload;
+        out.crcs[n] = crc;
+        out.sources[n] = static_cast<uint32_t>(source);
+        out.frame_lens[n] = static_cast<uint32_t>(len);
+        if (err != ParseError::OK) {
+            out.error_bits[n / 64] |= 1ULL << (n % 64);
+            ++out.error_count;
+        }
+        ++n;
+    }
+};
+
+// Unpack one v2 container. Container-level faults give a single error
+// result; a malformed inner frame is reported and, when its length is
+// still trustworthy, skipped.
+void expand_container(const FrameView& f, std::size_t source, bool crc_enabled,
+                      ResultWriter& w) {
+    ParsedFrame pf{};
+    if (f.len < CONTAINER_HEADER_SIZE) {
+        w.emit(ParseError::TOO_SHORT, pf, source, f.len);
+        return;
+    }
+    ContainerView ch(f.data);
+    const uint16_t body_len = ch.body_len();
+    const uint16_t frame_count = ch.frame_count();
+    bool has_crc = (ch.flags() & CONTAINER_FLAG_CRC) != 0;
+    std::size_t covered = CONTAINER_HEADER_SIZE + body_len;
+    if (f.len < covered + (has_crc ? FRAME_CRC_SIZE : 0)) {
+        w.emit(ParseError::TRUNCATED, pf, source, f.len);
+        return;
+    }
+    if (crc_enabled) {
+        uint32_t crc = 0;
+        if (has_crc)
+            std::memcpy(&crc, f.data + covered, FRAME_CRC_SIZE);
+        if (!has_crc || crc32(f.data, covered) != crc) {
+            w.emit(ParseError::CRC_MISMATCH, pf, source, f.len);
+            return;
+        }
+    }
+
+    const uint8_t* body = f.data + CONTAINER_HEADER_SIZE;
+    std::size_t pos = 0;
+    for (uint16_t k = 0; k < frame_count; ++k) {
+        std::size_t left = body_len - pos;
+        pf = ParsedFrame{};
+        ParseError err = parse_frame(body + pos, left, false, pf);
+        std::size_t frame_len = err == ParseError::TOO_SHORT
+            ? left : FRAME_HEADER_SIZE + pf.header.payload_len;
+        if (err != ParseError::OK || !w.rejects(pf.header.src_id, pf.header.msg_type))
+            w.emit(err, pf, source, frame_len < left ? frame_len : left);
+
+        // Lengths past this point cannot be trusted
+        if (err == ParseError::TOO_SHORT || err == ParseError::TRUNCATED ||
+            err == ParseError::PAYLOAD_TOO_LONG || frame_len > left)
+            return;
+        pos += frame_len;
+    }
+}
+
+// Peek a v1 header's filter fields without validating the rest of it
+bool peek_filter_fields(const FrameView& f, uint16_t& src_id, uint8_t& msg_type) {
+    if (f.len < FRAME_HEADER_SIZE || f.data[0] != PROTOCOL_VERSION)
+        return false;
+    HeaderView h(f.data);
+    msg_type = h.msg_type();
+    src_id = h.src_id();
+    return true;
+}
+
+} // anonymous namespace
+
+std::size_t parse_frames(const FrameView* frames, std::size_t count,
+                         bool crc_enabled, ParsedFrameBatch& out,
+                         const IngressFilter* filter) {
+    out.reserve(count);
+    out.error_count = 0;
+    out.filtered_count = 0;
+    out.has_crc = crc_enabled;
+    std::fill(out.error_bits.begin(), out.error_bits.end(), 0);
+
+    // Skip the per-frame lookups entirely while the filter accepts all
+    if (filter && filter->accepts_all())
+        filter = nullptr;
+
+    ResultWriter w{out, filter};
+    ParsedFrame scratch;
+    std::size_t i = 0;
+    while (i < count) {
+        std::size_t n = count - i < LANES ? count - i : LANES;
+        uint32_t pass = 0;
+#if defined(__SSE2__)
+        if (n == LANES)
+            pass = header_pass_mask(frames + i, crc_enabled);
+#endif
+
+        for (std::size_t k = 0; k < n; ++k, ++i) {
+            const FrameView& f = frames[i];
+            uint16_t src_id = 0;
+            uint8_t msg_type = 0;
+            if (filter && peek_filter_fields(f, src_id, msg_type) && w.rejects(src_id, msg_type))
+                continue;
+            if (pass & (1u << k)) {
+                // Headers already checked: only the CRC is left, and the
+                // header is copied once, straight into the results
+                HeaderView h(f.data);
+                uint32_t crc = 0;
+                ParseError err = ParseError::OK;
+                if (crc_enabled) {
+                    std::size_t covered = FRAME_HEADER_SIZE + h.payload_len();
+                    std::memcpy(&crc, f.data + covered, FRAME_CRC_SIZE);
+                    if (crc32(f.data, covered) != crc)
+                        err = ParseError::CRC_MISMATCH;
+                }
+                w.emit(err, h, f.data + FRAME_HEADER_SIZE, crc, i, f.len);
+            } else if (is_container(f.data, f.len)) {
+                expand_container(f, i, crc_enabled, w);
+            } else {
+                scratch = ParsedFrame{};
+                ParseError err = parse_frame(f.data, f.len, crc_enabled, scratch);
+                w.emit(err, scratch, i, f.len);
+            }
+        }
+    }
+    out.count = w.n;
+    return out.count - out.error_count;
+}
+
 } // namespace nng
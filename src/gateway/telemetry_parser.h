@@ -1,8 +1,11 @@
 #pragma once
 #include "common/protocol.h"
 #include "common/types.h"
+#include "gateway/frame_pool.h"
+#include "gateway/ingress_filter.h"
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 
 namespace nng {
 
@@ -16,6 +19,9 @@ enum class ParseError {
     CRC_MISMATCH,
 };
 
+// Name of a parse error ("TOO_SHORT", ...); static storage
+const char* parse_error_str(ParseError err);
+
 struct ParsedFrame {
     TelemetryHeader header;
     const uint8_t*  payload_ptr = nullptr;
@@ -28,4 +34,51 @@ struct ParsedFrame {
 ParseError parse_frame(const uint8_t* buf, std::size_t len,
                        bool crc_enabled, ParsedFrame& out);
 
+// Results of parse_frames(), stored as structure-of-arrays: entry i of each
+// array belongs to result frame i. error_bits has bit i set when result i
+// failed. A v1 datagram gives one result; a v2 container gives one per
+// inner frame (or a single error result if the container itself is bad).
+struct ParsedFrameBatch {
+    std::vector<ParseError>      errors;
+    std::vector<TelemetryHeader> headers;      // valid when errors[i] == OK
+    std::vector<const uint8_t*>  payload_ptrs; // valid when errors[i] == OK
+    std::vector<uint32_t>        crcs;         // v1 frame CRC (0 inside containers)
+    std::vector<uint32_t>        sources;      // index of the datagram it came from
+    std::vector<uint32_t>        frame_lens;   // bytes of the frame (datagram for v1)
+    std::vector<uint64_t>        error_bits;
+    std::size_t count = 0;
+    std::size_t error_count = 0;
+    std::size_t filtered_count = 0; // frames dropped by the ingress filter
+    bool has_crc = false;
+
+    ParsedFrameBatch() = default;
+    explicit ParsedFrameBatch(std::size_t capacity) { reserve(capacity); }
+
+    // Grow the arrays to hold n results (no-op once large enough)
+    void reserve(std::size_t n);
+
+    bool ok(std::size_t i) const { return (error_bits[i / 64] >> (i % 64) & 1) == 0; }
+    // Result i as parse_frame() would have returned it
+    ParsedFrame frame(std::size_t i) const;
+};
+
+// True if the datagram is a protocol v2 container
+inline bool is_container(const uint8_t* buf, std::size_t len) {
+    return len > 0 && buf[0] == PROTOCOL_VERSION_V2;
+}
+
+// Validate count datagrams at once. Header checks (version, msg_type range,
+// payload length against frame length) run 16 datagrams per step with SSE2;
+// datagrams that fail them are re-parsed one by one for the exact error.
+// v2 containers are unpacked into their frames: with crc_enabled the
+// container must carry CRC32 and it is checked once for all its frames.
+// With a filter, frames it rejects are dropped as soon as their header
+// is read (before the CRC) and only counted in out.filtered_count; inner
+// container frames are filtered after the container CRC.
+// Returns the number of valid frames; results for v1 datagrams match
+// parse_frame().
+std::size_t parse_frames(const FrameView* frames, std::size_t count,
+                         bool crc_enabled, ParsedFrameBatch& out,
+                         const IngressFilter* filter = nullptr);
+
 } // namespace nng
@@ -0,0 +1,146 @@
+#include "gateway/timer_wheel.h"
+#include <algorithm>
+
+namespace nng {
+
+TimerWheel::TimerWheel(std::size_t timers, uint64_t tick_ns, uint64_t now_ns)
+    : nodes_(timers), tick_ns_(tick_ns > 0 ? tick_ns : 1), now_(now_ns / tick_ns_) {
+    std::fill(std::begin(heads_), std::end(heads_), NONE);
+    std::fill(std::begin(level_size_), std::end(level_size_), 0);
+}
+
+uint16_t TimerWheel::bucket_of(uint64_t deadline) const {
+    // Deadlines due now go in the bucket processed next
+    deadline = std::max(deadline, now_);
+    uint64_t diff = deadline ^ now_;
+    std::size_t level = 0;
+    while (level + 1 < LEVELS && diff >= SLOTS) {
+        diff >>= LEVEL_BITS;
+        ++level;
+    }
+    if (diff >= SLOTS) {
+        // Past the top level: top bucket 0, handed down each time the top
+        // level wraps, to be filed again from there (no timer within
+        // range can be in it: its top group is ahead of now_'s)
+        return static_cast<uint16_t>(level * SLOTS);
+    }
+    std::size_t slot = (deadline >> (LEVEL_BITS * level)) & (SLOTS - 1);
+    return static_cast<uint16_t>(level * SLOTS + slot);
+}
+
+void TimerWheel::link(uint32_t id, uint16_t bucket) {
+    ++level_size_[bucket / SLOTS];
+    Node& n = nodes_[id];
+    n.bucket = bucket;
+    n.prev = NONE;
+    n.next = heads_[bucket];
+    if (n.next != NONE)
+        nodes_[n.next].prev = id;
+    heads_[bucket] = id;
+}
+
+void TimerWheel::unlink(uint32_t id) {
+    Node& n = nodes_[id];
+    if (n.prev != NONE)
+        nodes_[n.prev].next = n.next;
+    else
+        heads_[n.bucket] = n.next;
+    if (n.next != NONE)
+        nodes_[n.next].prev = n.prev;
+    --level_size_[n.bucket / SLOTS];
+    n.bucket = NO_BUCKET;
+}
+
+void TimerWheel::arm(uint32_t id, uint64_t deadline_ns) {
+    Node& n = nodes_[id];
+    n.deadline = deadline_ns / tick_ns_;
+    uint16_t bucket = bucket_of(n.deadline);
+    // Re-armed into the bucket it is in already (the usual case for a
+    // deadline pushed back by one more frame): nothing moves
+    if (n.bucket == bucket)
+        return;
+    if (n.bucket != NO_BUCKET)
+        unlink(id);
+    else
+        ++armed_;
+    link(id, bucket);
+}
+
+void TimerWheel::set_now(uint64_t now_ns) {
+    if (armed_ == 0)
+        now_ = now_ns / tick_ns_;
+}
+
+void TimerWheel::cancel(uint32_t id) {
+    if (nodes_[id].bucket == NO_BUCKET)
+        return;
+    unlink(id);
+    --armed_;
+}
+
+void TimerWheel::cascade(uint16_t bucket) {
+    uint32_t id = heads_[bucket];
+    heads_[bucket] = NONE;
+    while (id != NONE) {
+        uint32_t next = nodes_[id].next;
+        --level_size_[bucket / SLOTS];
+        link(id, bucket_of(nodes_[id].deadline));
+        id = next;
+    }
+}
+
+std::size_t TimerWheel::advance(uint64_t now_ns, std::vector<uint32_t>& fired) {
+    uint64_t target = now_ns / tick_ns_;
+    std::size_t count = 0;
+    if (armed_ == 0) {
+        // Nothing to step through
+        now_ = std::max(now_, target + 1);
+        return 0;
+    }
+    while (now_ <= target) {
+        // Groups that just wrapped hand their next bucket down, top first
+        std::size_t level = 0;
+        while (level + 1 < LEVELS &&
+               (now_ & ((uint64_t{1} << (LEVEL_BITS * (level + 1))) - 1)) == 0)
+            ++level;
+        for (; level > 0; --level)
+            cascade(static_cast<uint16_t>(level * SLOTS +
+                ((now_ >> (LEVEL_BITS * level)) & (SLOTS - 1))));
+
+        uint16_t bucket = static_cast<uint16_t>(now_ & (SLOTS - 1));
+        uint32_t id = heads_[bucket];
+        heads_[bucket] = NONE;
+        while (id != NONE) {
+            Node& n = nodes_[id];
+            uint32_t next = n.next;
+            n.bucket = NO_BUCKET;
+            --level_size_[0];
+            if (n.deadline <= now_) {
+                fired.push_back(id);
+                --armed_;
+                ++count;
+            } else {
+                link(id, bucket_of(n.deadline)); // came round from the top early
+            }
+            id = next;
+        }
+        ++now_;
+        if (armed_ == 0) {
+            now_ = std::max(now_, target + 1);
+            break;
+        }
+        // Below the lowest level holding timers nothing can happen before
+        // its next bucket comes round: go straight there
+        std::size_t lowest = 0;
+        while (level_size_[lowest] == 0)
+            ++lowest;
+        if (lowest > 0) {
+            uint64_t span = uint64_t{1} << (LEVEL_BITS * lowest);
+            uint64_t next = (now_ + span - 1) & ~(span - 1); // now_ if on it
+            now_ = std::min(next, target + 1);
+        }
+    }
+    return count;
+}
+
+} // namespace nng
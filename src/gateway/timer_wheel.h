@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nng {
+
+// Hierarchical timing wheel over a fixed set of timer ids [0, timers).
+// Time is cut into ticks of tick_ns; LEVELS wheels of SLOTS buckets each
+// cover ever coarser spans. A timer sits in the bucket of the highest
+// 6-bit group where its deadline tick differs from the wheel's current
+// tick, and moves down a level each time that group comes round, so it
+// fires in the tick of its deadline (never early, at most one tick late
+// relative to advance() calls). Deadlines past the top level wait in its
+// first bucket and are re-filed each time the top level wraps.
+//
+// arm() (also re-arming an armed timer), cancel() and firing are O(1),
+// whatever the number of timers: buckets are intrusive doubly linked
+// lists through a node per id. advance() takes one step per elapsed tick
+// while the bottom level holds timers, otherwise skips to the next bucket
+// of the lowest level that does, plus one step per timer fired or moved
+// down. Single-threaded.
+class TimerWheel {
+public:
+    static constexpr unsigned LEVEL_BITS = 6;
+    static constexpr std::size_t SLOTS = std::size_t{1} << LEVEL_BITS;
+    static constexpr std::size_t LEVELS = 5; // 2^30 ticks: 124 days of 10 ms
+
+    TimerWheel(std::size_t timers, uint64_t tick_ns, uint64_t now_ns = 0);
+
+    // (Re)arm id to fire at deadline_ns; a deadline already past fires in
+    // the next tick
+    void arm(uint32_t id, uint64_t deadline_ns);
+    // Move the clock without stepping through the ticks in between. Only
+    // while nothing is armed (no-op otherwise): for a first arm() long
+    // after the wheel was made.
+    void set_now(uint64_t now_ns);
+    void cancel(uint32_t id);
+    bool armed(uint32_t id) const { return nodes_[id].bucket != NO_BUCKET; }
+
+    // Move time to now_ns, appending the ids whose deadline has passed
+    // (now disarmed) to fired; returns how many
+    std::size_t advance(uint64_t now_ns, std::vector<uint32_t>& fired);
+
+    std::size_t size() const { return armed_; }
+    std::size_t timers() const { return nodes_.size(); }
+    uint64_t tick_ns() const { return tick_ns_; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint16_t NO_BUCKET = UINT16_MAX;
+
+    struct Node {
+        uint64_t deadline = 0; // in ticks
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint16_t bucket = NO_BUCKET;
+    };
+
+    uint16_t bucket_of(uint64_t deadline) const;
+    void link(uint32_t id, uint16_t bucket);
+    void unlink(uint32_t id);
+    // Re-file every timer of a bucket against the current tick
+    void cascade(uint16_t bucket);
+
+    std::vector<Node> nodes_;
+    uint32_t heads_[LEVELS * SLOTS];
+    std::size_t level_size_[LEVELS]; // timers filed on each level
+    uint64_t tick_ns_;
+    uint64_t now_ = 0; // next tick to process
+    std::size_t armed_ = 0;
+};
+
+} // namespace nng
@@ -0,0 +1,304 @@
+#include "gateway/track_table.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+namespace nng {
+
+namespace {
+
+std::size_t table_size(std::size_t capacity) {
+    return round_up_pow2(std::max<std::size_t>(capacity, 16));
+}
+
+bool older_than(const TrackRecord& r, uint64_t now_ns, uint64_t ttl_ns) {
+    return ttl_ns != 0 && now_ns > r.last_update_ns && now_ns - r.last_update_ns > ttl_ns;
+}
+
+} // anonymous namespace
+
+TrackTable::TrackTable(std::size_t capacity, uint64_t ttl_ns, uint64_t tick_ns)
+    : slots_(new Slot[table_size(capacity)]),
+      mask_(table_size(capacity) - 1),
+      max_size_((mask_ + 1) / 4 * 3),
+      ttl_ns_(ttl_ns),
+      wheel_(ttl_ns > 0 ? max_size_ : 0, tick_ns) {
+    if (ttl_ns_ == 0)
+        return;
+    timer_keys_.resize(max_size_);
+    free_timers_.reserve(max_size_);
+    for (std::size_t id = max_size_; id-- > 0;)
+        free_timers_.push_back(static_cast<uint32_t>(id));
+}
+
+std::size_t TrackTable::home(uint64_t key) const {
+    // splitmix64 finalizer: track ids are often sequential
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<std::size_t>(key) & mask_;
+}
+
+TrackRecord TrackTable::load(const Slot& s) {
+    uint64_t words[RECORD_WORDS];
+    for (std::size_t w = 0; w < RECORD_WORDS; ++w)
+        words[w] = s.words[w].load(std::memory_order_relaxed);
+    TrackRecord rec;
+    std::memcpy(&rec, words, sizeof(rec));
+    return rec;
+}
+
+void TrackTable::store(Slot& s, uint64_t key, const TrackRecord& rec) {
+    uint64_t words[RECORD_WORDS] = {};
+    std::memcpy(words, &rec, sizeof(rec));
+    uint32_t v = s.version.load(std::memory_order_relaxed);
+    s.version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.key.store(key, std::memory_order_relaxed);
+    for (std::size_t w = 0; w < RECORD_WORDS; ++w)
+        s.words[w].store(words[w], std::memory_order_relaxed);
+    s.version.store(v + 2, std::memory_order_release);
+}
+
+bool TrackTable::read(const Slot& s, uint64_t& key, TrackRecord& rec) {
+    uint64_t words[RECORD_WORDS];
+    while (true) {
+        uint32_t v = s.version.load(std::memory_order_acquire);
+        if (v & 1)
+            continue;
+        key = s.key.load(std::memory_order_relaxed);
+        for (std::size_t w = 0; w < RECORD_WORDS; ++w)
+            words[w] = s.words[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.version.load(std::memory_order_relaxed) == v)
+            break;
+    }
+    if (key == 0)
+        return false;
+    std::memcpy(&rec, words, sizeof(rec));
+    return true;
+}
+
+bool TrackTable::update(uint16_t src_id, const TrackPayload& track, uint64_t now_ns) {
+    uint64_t key = make_key(src_id, track.track_id);
+    for (std::size_t i = home(key);; i = (i + 1) & mask_) {
+        Slot& s = slots_[i];
+        uint64_t k = s.key.load(std::memory_order_relaxed);
+        if (k == key) {
+            TrackRecord rec = load(s);
+            rec.last_update_ns = now_ns;
+            rec.update_count++;
+            rec.track = track;
+            store(s, key, rec);
+            if (ttl_ns_ != 0)
+                wheel_.arm(s.timer, now_ns + ttl_ns_);
+            return true;
+        }
+        if (k == 0) {
+            std::size_t n = size_.load(std::memory_order_relaxed);
+            if (n >= max_size_) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+                return false;
+            }
+            TrackRecord rec;
+            rec.last_update_ns = now_ns;
+            rec.update_count = 1;
+            rec.src_id = src_id;
+            rec.track = track;
+            store(s, key, rec);
+            size_.store(n + 1, std::memory_order_relaxed);
+            if (ttl_ns_ != 0) {
+                if (wheel_.size() == 0)
+                    wheel_.set_now(now_ns);
+                s.timer = free_timers_.back();
+                free_timers_.pop_back();
+                timer_keys_[s.timer] = key;
+                wheel_.arm(s.timer, now_ns + ttl_ns_);
+            }
+            return true;
+        }
+    }
+}
+
+bool TrackTable::apply(uint16_t src_id, const TrackDelta& delta, uint64_t now_ns,
+                       TrackPayload& out) {
+    TrackRecord rec;
+    const TrackPayload* base = nullptr;
+    if (!delta.keyframe()) {
+        std::size_t i = locate(make_key(src_id, delta.track_id));
+        if (i != SIZE_MAX) {
+            rec = load(slots_[i]);
+            base = &rec.track;
+        }
+    }
+    if (!apply_track_delta(delta, base, out)) {
+        delta_rejected_.store(delta_rejected_.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+        return false;
+    }
+    return update(src_id, out, now_ns);
+}
+
+bool TrackTable::remove(uint16_t src_id, uint32_t track_id) {
+    std::size_t i = locate(make_key(src_id, track_id));
+    if (i == SIZE_MAX)
+        return false;
+    erase(i);
+    return true;
+}
+
+std::size_t TrackTable::locate(uint64_t key) const {
+    for (std::size_t i = home(key);; i = (i + 1) & mask_) {
+        uint64_t k = slots_[i].key.load(std::memory_order_relaxed);
+        if (k == 0)
+            return SIZE_MAX;
+        if (k == key)
+            return i;
+    }
+}
+
+std::size_t TrackTable::expire(uint64_t now_ns, std::vector<TrackRecord>& lost) {
+    if (ttl_ns_ == 0)
+        return 0;
+    fired_.clear();
+    wheel_.advance(now_ns, fired_);
+    for (uint32_t id : fired_) {
+        std::size_t i = locate(timer_keys_[id]);
+        lost.push_back(load(slots_[i]));
+        erase(i);
+    }
+    expired_.store(expired_.load(std::memory_order_relaxed) + fired_.size(),
+                   std::memory_order_relaxed);
+    return fired_.size();
+}
+
+void TrackTable::erase(std::size_t i) {
+    if (ttl_ns_ != 0) {
+        wheel_.cancel(slots_[i].timer);
+        free_timers_.push_back(slots_[i].timer);
+    }
+    // Pull back each later entry of the cluster that may sit at the hole
+    // (its home is not cyclically within (i, j]); the copy lands before
+    // the old slot is overwritten, so a scan going down the array sees it
+    for (std::size_t j = (i + 1) & mask_;; j = (j + 1) & mask_) {
+        Slot& s = slots_[j];
+        uint64_t k = s.key.load(std::memory_order_relaxed);
+        if (k == 0)
+            break;
+        std::size_t h = home(k);
+        bool stays = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+        if (stays)
+            continue;
+        store(slots_[i], k, load(s));
+        slots_[i].timer = s.timer;
+        i = j;
+    }
+    store(slots_[i], 0, TrackRecord{});
+    size_.store(size_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+}
+
+bool TrackTable::find(uint16_t src_id, uint32_t track_id, TrackRecord& out) const {
+    uint64_t key = make_key(src_id, track_id);
+    for (std::size_t i = home(key), n = 0; n <= mask_; i = (i + 1) & mask_, ++n) {
+        uint64_t k = 0;
+        if (!read(slots_[i], k, out))
+            return false;
+        if (k == key)
+            return true;
+    }
+    return false;
+}
+
+void TrackTable::scan(std::vector<TrackRecord>& out, const TrackQuery& query) const {
+    // Downwards: see erase()
+    TrackRecord rec;
+    for (std::size_t i = mask_ + 1; i-- > 0;) {
+        uint64_t key = 0;
+        if (!read(slots_[i], key, rec))
+            continue;
+        if (rec.track.threat_level < query.min_threat)
+            continue;
+        if (query.now_ns != 0 && older_than(rec, query.now_ns, ttl_ns_))
+            continue;
+        out.push_back(rec);
+    }
+}
+
+TrackPicture::TrackPicture(std::size_t capacity, uint64_t ttl_ns, uint64_t tick_ns)
+    : capacity_(capacity), ttl_ns_(ttl_ns), tick_ns_(tick_ns) {}
+
+void TrackPicture::set_writers(std::size_t n) {
+    std::unique_lock lock(mutex_);
+    while (tables_.size() < n)
+        tables_.push_back(std::make_unique<TrackTable>(capacity_, ttl_ns_, tick_ns_));
+}
+
+std::size_t TrackPicture::writers() const {
+    std::shared_lock lock(mutex_);
+    return tables_.size();
+}
+
+TrackTable& TrackPicture::table(std::size_t i) {
+    std::shared_lock lock(mutex_);
+    return *tables_[i];
+}
+
+void TrackPicture::snapshot(std::vector<TrackRecord>& out, const TrackQuery& query) const {
+    out.clear();
+    {
+        std::shared_lock lock(mutex_);
+        for (const auto& t : tables_)
+            t->scan(out, query);
+    }
+
+    // Duplicates (the same track from two workers, or caught mid-move)
+    // next to each other, newest first; keep that one
+    auto by_key = [](const TrackRecord& a, const TrackRecord& b) {
+        if (a.src_id != b.src_id)
+            return a.src_id < b.src_id;
+        uint32_t ta = a.track.track_id, tb = b.track.track_id;
+        if (ta != tb)
+            return ta < tb;
+        return a.last_update_ns > b.last_update_ns;
+    };
+    std::sort(out.begin(), out.end(), by_key);
+    out.erase(std::unique(out.begin(), out.end(),
+                          [](const TrackRecord& a, const TrackRecord& b) {
+                              uint32_t ta = a.track.track_id, tb = b.track.track_id;
+                              return a.src_id == b.src_id && ta == tb;
+                          }),
+              out.end());
+    std::stable_sort(out.begin(), out.end(), [](const TrackRecord& a, const TrackRecord& b) {
+        return a.track.threat_level > b.track.threat_level;
+    });
+}
+
+std::size_t TrackPicture::size() const {
+    std::shared_lock lock(mutex_);
+    std::size_t n = 0;
+    for (const auto& t : tables_)
+        n += t->size();
+    return n;
+}
+
+uint64_t TrackPicture::dropped() const {
+    std::shared_lock lock(mutex_);
+    uint64_t n = 0;
+    for (const auto& t : tables_)
+        n += t->dropped();
+    return n;
+}
+
+uint64_t TrackPicture::delta_rejected() const {
+    std::shared_lock lock(mutex_);
+    uint64_t n = 0;
+    for (const auto& t : tables_)
+        n += t->delta_rejected();
+    return n;
+}
+
+} // namespace nng
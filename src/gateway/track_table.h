@@ -0,0 +1,159 @@
+#pragma once
+#include "common/protocol.h"
+#include "common/spsc_ring.h"
+#include "common/track_delta.h"
+#include "gateway/timer_wheel.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+namespace nng {
+
+// Latest state of one (src_id, track_id)
+struct TrackRecord {
+    uint64_t last_update_ns = 0; // receive time (CLOCK_REALTIME) of the latest frame
+    uint32_t update_count = 0;   // frames folded into the record
+    uint16_t src_id = 0;
+    TrackPayload track{};        // as last received
+};
+
+struct TrackQuery {
+    uint8_t min_threat = 0;
+    // With now_ns, records older than the table's TTL are left out
+    uint64_t now_ns = 0;
+};
+
+// Live tracks written by one thread (an ingest worker) and readable from
+// any thread: open addressing with linear probing over a fixed,
+// power-of-two array of cache-line slots, keyed by (src_id, track_id).
+// An update is one probe and one slot write, with no allocation. Each
+// slot is guarded by a sequence count: readers retry a slot caught
+// mid-write and never block the writer.
+//
+// Every update re-arms the track's timer on a TimerWheel, O(1) however
+// many tracks there are; expire() removes the tracks whose TTL ran out
+// (backward-shift deletion, so no tombstones lengthen probes) and hands
+// them back as lost. Past 3/4 full, new tracks are dropped and counted. A
+// scan may see a track that is being moved twice (snapshots keep one)
+// and, rarely, miss one moved across the end of the array.
+class TrackTable {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = std::size_t{1} << 18;
+    static constexpr uint64_t DEFAULT_TTL_NS = 10'000'000'000ULL;
+    static constexpr uint64_t DEFAULT_TICK_NS = 10'000'000ULL; // expiry resolution
+
+    // capacity is rounded up to a power of two (at least 16); ttl_ns 0
+    // keeps tracks until they are removed
+    explicit TrackTable(std::size_t capacity = DEFAULT_CAPACITY, uint64_t ttl_ns = DEFAULT_TTL_NS,
+                        uint64_t tick_ns = DEFAULT_TICK_NS);
+
+    TrackTable(const TrackTable&) = delete;
+    TrackTable& operator=(const TrackTable&) = delete;
+
+    // Writer side (the owning thread only). update() is false when a new
+    // track does not fit.
+    bool update(uint16_t src_id, const TrackPayload& track, uint64_t now_ns);
+    // update() with the track a TRACK_DELTA record decodes to against the
+    // stored state, left in out. False if the record is a delta whose
+    // reference is not the stored update (a frame was lost since: counted
+    // in delta_rejected(), and the track waits for its next keyframe) or
+    // the track does not fit.
+    bool apply(uint16_t src_id, const TrackDelta& delta, uint64_t now_ns, TrackPayload& out);
+    bool remove(uint16_t src_id, uint32_t track_id);
+    // Remove the tracks not updated within the TTL by now_ns, appending
+    // their last state to lost; returns how many
+    std::size_t expire(uint64_t now_ns, std::vector<TrackRecord>& lost);
+
+    // Reader side (any thread)
+    bool find(uint16_t src_id, uint32_t track_id, TrackRecord& out) const;
+    // Append the matching records, unordered
+    void scan(std::vector<TrackRecord>& out, const TrackQuery& query) const;
+
+    std::size_t size() const { return size_.load(std::memory_order_relaxed); }
+    std::size_t capacity() const { return mask_ + 1; }
+    uint64_t ttl_ns() const { return ttl_ns_; }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t expired() const { return expired_.load(std::memory_order_relaxed); }
+    uint64_t delta_rejected() const { return delta_rejected_.load(std::memory_order_relaxed); }
+
+    // The slot array, e.g. to move it next to the writer's CPU
+    const void* data() const { return slots_.get(); }
+    std::size_t data_bytes() const { return capacity() * sizeof(Slot); }
+
+private:
+    static constexpr std::size_t RECORD_WORDS = 5;
+    static_assert(sizeof(TrackRecord) <= RECORD_WORDS * sizeof(uint64_t), "TrackRecord too big");
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint32_t> version{0};  // odd while being written
+        uint32_t timer = 0;                // writer only: the entry's timer id
+        std::atomic<uint64_t> key{0};      // 0: empty
+        std::atomic<uint64_t> words[RECORD_WORDS] = {};
+    };
+
+    static uint64_t make_key(uint16_t src_id, uint32_t track_id) {
+        return (static_cast<uint64_t>(src_id) + 1) << 32 | track_id;
+    }
+    std::size_t home(uint64_t key) const;
+    // Writer: a slot's contents without the sequence check
+    static TrackRecord load(const Slot& s);
+    static void store(Slot& s, uint64_t key, const TrackRecord& rec);
+    // Reader: a consistent copy of a slot; false if it is empty
+    static bool read(const Slot& s, uint64_t& key, TrackRecord& rec);
+    // Writer: slot of key, or SIZE_MAX
+    std::size_t locate(uint64_t key) const;
+    void erase(std::size_t i);
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    std::size_t max_size_;
+    uint64_t ttl_ns_;
+    // Writer only: one timer per entry (ttl_ns_ > 0), ids moving with
+    // their entry; timer_keys_ maps an id back to its key
+    TimerWheel wheel_;
+    std::vector<uint32_t> free_timers_;
+    std::vector<uint64_t> timer_keys_;
+    std::vector<uint32_t> fired_; // expire() scratch
+    std::atomic<std::size_t> size_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> delta_rejected_{0};
+};
+
+// The gateway's air picture: one TrackTable per ingest worker (as
+// StatsManager has a StatsShard per worker), merged by snapshot().
+class TrackPicture {
+public:
+    explicit TrackPicture(std::size_t capacity = TrackTable::DEFAULT_CAPACITY,
+                          uint64_t ttl_ns = TrackTable::DEFAULT_TTL_NS,
+                          uint64_t tick_ns = TrackTable::DEFAULT_TICK_NS);
+
+    // Make sure there are at least n tables; existing ones are kept
+    void set_writers(std::size_t n);
+    std::size_t writers() const;
+    TrackTable& table(std::size_t i);
+
+    // Live tracks of every table with threat_level >= query.min_threat,
+    // into out (cleared first): one record per (src_id, track_id), the
+    // newest if several workers saw it. Highest threat first, then by
+    // src_id and track_id.
+    void snapshot(std::vector<TrackRecord>& out, const TrackQuery& query) const;
+
+    std::size_t size() const;    // records held, all tables
+    uint64_t dropped() const;    // new tracks that did not fit
+    uint64_t delta_rejected() const; // TRACK_DELTA records without their base
+    std::size_t capacity() const { return capacity_; } // per table
+    uint64_t ttl_ns() const { return ttl_ns_; }
+
+private:
+    std::size_t capacity_;
+    uint64_t ttl_ns_;
+    uint64_t tick_ns_;
+    mutable std::shared_mutex mutex_; // guards tables_ itself, not the tables
+    std::vector<std::unique_ptr<TrackTable>> tables_;
+};
+
+} // namespace nng
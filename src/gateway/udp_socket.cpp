@@ -1,77 +1,192 @@
 #include "gateway/udp_socket.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <cstring>
 #include <cerrno>
+#include <chrono>
+#include <algorithm>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
 
 namespace nng {
+namespace {
 
-// --- UdpFrameSource ---
+constexpr std::size_t RX_CTRL_SIZE = CMSG_SPACE(sizeof(struct timespec));
+// Largest UDP payload one GSO send may carry (IPv4)
+constexpr std::size_t MAX_GSO_BYTES = 65507;
 
-UdpFrameSource::~UdpFrameSource() {
-    close();
+uint64_t cmsg_rx_timestamp(struct msghdr& msg) {
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+                   static_cast<uint64_t>(ts.tv_nsec);
+        }
+    }
+    return 0;
 }
 
-bool UdpFrameSource::bind(uint16_t port) {
-    close();
+} // anonymous namespace
 
-    sockfd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
-    if (sockfd_ < 0)
-        return false;
+int bind_udp_socket(uint16_t port, bool reuse_port) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return -1;
 
     // Allow address reuse
     int optval = 1;
-    ::setsockopt(sockfd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+
+    // Share the port with sibling ingest sockets (flow-hashed by the kernel)
+    if (reuse_port &&
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+        ::close(fd);
+        return -1;
+    }
 
     struct sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
     addr.sin_port = htons(port);
 
-    if (::bind(sockfd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
-        close();
-        return false;
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
     }
 
-    return true;
+    return fd;
 }
 
-bool UdpFrameSource::receive(std::vector<uint8_t>& buf) {
+// --- UdpFrameSource ---
+
+UdpFrameSource::UdpFrameSource()
+    : rx_scratch_(MAX_DATAGRAM_SIZE),
+      rx_iovs_(MAX_BATCH),
+      rx_msgs_(MAX_BATCH),
+      rx_ctrl_(MAX_BATCH * RX_CTRL_SIZE) {
+    for (std::size_t i = 0; i < MAX_BATCH; ++i) {
+        std::memset(&rx_msgs_[i], 0, sizeof(rx_msgs_[i]));
+        rx_iovs_[i].iov_len = FramePool::SLOT_SIZE;
+        rx_msgs_[i].msg_hdr.msg_iov = &rx_iovs_[i];
+        rx_msgs_[i].msg_hdr.msg_iovlen = 1;
+        rx_msgs_[i].msg_hdr.msg_control = rx_ctrl_.data() + i * RX_CTRL_SIZE;
+    }
+}
+
+UdpFrameSource::~UdpFrameSource() {
+    close();
+}
+
+bool UdpFrameSource::bind(uint16_t port, bool reuse_port) {
+    close();
+    sockfd_ = bind_udp_socket(port, reuse_port);
     if (sockfd_ < 0)
         return false;
 
+    // Kernel receive timestamps, so socket-buffer queueing is measurable
+    int optval = 1;
+    ::setsockopt(sockfd_, SOL_SOCKET, SO_TIMESTAMPNS, &optval, sizeof(optval));
+
+    apply_busy_poll();
+    return true;
+}
+
+bool UdpFrameSource::wait_readable(bool spin) {
     // Poll with timeout
     struct pollfd pfd{};
     pfd.fd = sockfd_;
     pfd.events = POLLIN;
 
+    // Busy-poll: zero-timeout polls for the budget before sleeping
+    if (spin && busy_poll_us_ > 0) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(busy_poll_us_);
+        do {
+            if (::poll(&pfd, 1, 0) > 0)
+                return (pfd.revents & POLLIN) != 0;
+        } while (std::chrono::steady_clock::now() < deadline);
+    }
+
     int ret = ::poll(&pfd, 1, timeout_ms_);
     if (ret <= 0)
         return false; // Timeout or error
 
-    if (!(pfd.revents & POLLIN))
+    return (pfd.revents & POLLIN) != 0;
+}
+
+bool UdpFrameSource::receive(std::vector<uint8_t>& buf) {
+    if (sockfd_ < 0)
+        return false;
+
+    if (!wait_readable(true))
         return false;
 
-    // Receive datagram
-    buf.resize(65536); // Max UDP datagram size
+    // Receive datagram into the fixed scratch buffer, then copy out only
+    // the bytes that arrived
     struct sockaddr_in src_addr{};
     socklen_t src_len = sizeof(src_addr);
 
-    ssize_t n = ::recvfrom(sockfd_, buf.data(), buf.size(), 0,
+    ssize_t n = ::recvfrom(sockfd_, rx_scratch_.data(), rx_scratch_.size(), 0,
                            reinterpret_cast<struct sockaddr*>(&src_addr), &src_len);
     if (n <= 0) {
         buf.clear();
         return false;
     }
 
-    buf.resize(static_cast<std::size_t>(n));
+    buf.assign(rx_scratch_.data(), rx_scratch_.data() + n);
     return true;
 }
 
+int UdpFrameSource::recv_into(FrameBatch& batch, std::size_t max_frames) {
+    // Scatter straight into the batch slots (controllen is overwritten by
+    // every call, so it is reset each time)
+    for (std::size_t i = 0; i < max_frames; ++i) {
+        rx_iovs_[i].iov_base = batch.slot(i);
+        rx_msgs_[i].msg_hdr.msg_controllen = RX_CTRL_SIZE;
+    }
+
+    // Take everything queued (up to max_frames) in one call
+    int n = ::recvmmsg(sockfd_, rx_msgs_.data(), static_cast<unsigned int>(max_frames),
+                       MSG_DONTWAIT, nullptr);
+    for (int i = 0; i < n; ++i)
+        batch.commit(rx_msgs_[i].msg_len, cmsg_rx_timestamp(rx_msgs_[i].msg_hdr));
+    return n;
+}
+
+std::size_t UdpFrameSource::receive_batch(FrameBatch& batch) {
+    batch.clear();
+    if (sockfd_ < 0)
+        return 0;
+
+    std::size_t max_frames = batch.capacity();
+    if (max_frames > MAX_BATCH)
+        max_frames = MAX_BATCH;
+
+    // Busy-poll: spin on the receive itself for the budget, then block
+    if (busy_poll_us_ > 0) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(busy_poll_us_);
+        do {
+            if (recv_into(batch, max_frames) > 0)
+                return batch.size();
+        } while (std::chrono::steady_clock::now() < deadline);
+    }
+
+    if (!wait_readable(false))
+        return 0;
+
+    recv_into(batch, max_frames);
+    return batch.size();
+}
+
 void UdpFrameSource::close() {
     if (sockfd_ >= 0) {
         ::close(sockfd_);
@@ -83,8 +198,32 @@ void UdpFrameSource::set_timeout_ms(int ms) {
     timeout_ms_ = ms;
 }
 
+void UdpFrameSource::set_busy_poll_us(int budget_us) {
+    busy_poll_us_ = budget_us > 0 ? budget_us : 0;
+    apply_busy_poll();
+}
+
+void UdpFrameSource::apply_busy_poll() {
+    if (sockfd_ < 0 || busy_poll_us_ == 0)
+        return;
+    // Let the kernel also spin on the device queue inside recv/poll. Failure
+    // (no CAP_NET_ADMIN, no busy-poll support) just leaves the userspace spin.
+    int budget = busy_poll_us_;
+    ::setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL, &budget, sizeof(budget));
+}
+
 // --- UdpFrameSink ---
 
+UdpFrameSink::UdpFrameSink()
+    : tx_iovs_(std::max(MAX_BATCH, MAX_GSO_SEGMENTS)),
+      tx_msgs_(MAX_BATCH) {
+    for (std::size_t i = 0; i < MAX_BATCH; ++i) {
+        std::memset(&tx_msgs_[i], 0, sizeof(tx_msgs_[i]));
+        tx_msgs_[i].msg_hdr.msg_iov = &tx_iovs_[i];
+        tx_msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
 UdpFrameSink::~UdpFrameSink() {
     close();
 }
@@ -114,6 +253,15 @@ bool UdpFrameSink::connect(const std::string& host, uint16_t port) {
     return true;
 }
 
+bool UdpFrameSink::set_multicast(int ttl, bool loopback) {
+    if (sockfd_ < 0)
+        return false;
+    int hops = ttl;
+    int loop = loopback ? 1 : 0;
+    return ::setsockopt(sockfd_, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops)) == 0 &&
+           ::setsockopt(sockfd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) == 0;
+}
+
 bool UdpFrameSink::send(const std::vector<uint8_t>& buf) {
     if (sockfd_ < 0 || buf.empty())
         return false;
@@ -122,6 +270,113 @@ bool UdpFrameSink::send(const std::vector<uint8_t>& buf) {
     return n == static_cast<ssize_t>(buf.size());
 }
 
+std::size_t UdpFrameSink::gso_run(const FrameView* frames, std::size_t count) const {
+    std::size_t len = frames[0].len;
+    if (len == 0)
+        return 1;
+    std::size_t limit = std::min({count, MAX_GSO_SEGMENTS, MAX_GSO_BYTES / len});
+    std::size_t run = 1;
+    while (run < limit && frames[run].len == len)
+        ++run;
+    return run;
+}
+
+int UdpFrameSink::send_gso(const FrameView* frames, std::size_t count) {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        tx_iovs_[i].iov_base = const_cast<uint8_t*>(frames[i].data);
+        tx_iovs_[i].iov_len = frames[i].len;
+        total += frames[i].len;
+    }
+
+    alignas(struct cmsghdr) char ctrl[CMSG_SPACE(sizeof(uint16_t))] = {};
+    struct msghdr msg{};
+    msg.msg_iov = tx_iovs_.data();
+    msg.msg_iovlen = count;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    // Every segment but the last is gso_size bytes; all are here
+    struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_UDP;
+    c->cmsg_type = UDP_SEGMENT;
+    c->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    auto gso_size = static_cast<uint16_t>(frames[0].len);
+    std::memcpy(CMSG_DATA(c), &gso_size, sizeof(gso_size));
+
+    ssize_t n = ::sendmsg(sockfd_, &msg, 0);
+    if (n == static_cast<ssize_t>(total))
+        return 0;
+    return n < 0 ? errno : EIO;
+}
+
+std::size_t UdpFrameSink::send_mmsg(const FrameView* frames, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        tx_iovs_[i].iov_base = const_cast<uint8_t*>(frames[i].data);
+        tx_iovs_[i].iov_len = frames[i].len;
+        tx_msgs_[i].msg_hdr.msg_iov = &tx_iovs_[i];
+    }
+    // sendmmsg() stops at the first datagram it cannot send and reports
+    // the error on the next call: that datagram is lost, the rest still go
+    std::size_t sent = 0;
+    std::size_t pos = 0;
+    while (pos < count) {
+        int n = ::sendmmsg(sockfd_, tx_msgs_.data() + pos, static_cast<unsigned int>(count - pos), 0);
+        if (n > 0) {
+            sent += static_cast<std::size_t>(n);
+            pos += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            ++pos;
+        }
+    }
+    return sent;
+}
+
+std::size_t UdpFrameSink::send_batch(const FrameView* frames, std::size_t count) {
+    if (sockfd_ < 0)
+        return 0;
+
+    std::size_t sent = 0;
+    std::size_t pos = 0;
+    while (pos < count) {
+        std::size_t chunk = 0;
+        if (gso_enabled_) {
+            std::size_t run = gso_run(frames + pos, count - pos);
+            if (run > 1) {
+                int err = send_gso(frames + pos, run);
+                if (err == 0) {
+                    sent += run;
+                    pos += run;
+                    continue;
+                }
+                if (err == EIO || err == EINVAL || err == EOPNOTSUPP) {
+                    // Route or kernel without UDP GSO: stay on sendmmsg from now on
+                    gso_enabled_ = false;
+                } else {
+                    // Transient (e.g. a full socket buffer): this run alone
+                    // goes by sendmmsg, GSO stays on
+                    chunk = std::min(run, MAX_BATCH);
+                }
+            }
+        }
+
+        // Up to MAX_BATCH frames, stopping where a GSO run would start
+        if (chunk == 0) {
+            chunk = 1;
+            while (chunk < MAX_BATCH && pos + chunk < count &&
+                   !(gso_enabled_ && gso_run(frames + pos + chunk, count - pos - chunk) > 1))
+                ++chunk;
+        }
+
+        // A datagram that fails is dropped, as a full socket buffer would
+        sent += send_mmsg(frames + pos, chunk);
+        pos += chunk;
+    }
+    return sent;
+}
+
 void UdpFrameSink::close() {
     if (sockfd_ >= 0) {
         ::close(sockfd_);
@@ -1,52 +1,127 @@
 #pragma once
 #include "gateway/frame_source.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <string>
+#include <vector>
 #include <cstdint>
+#include <cstddef>
 
 namespace nng {
 
+// Create a UDP socket bound to INADDR_ANY:port (SO_REUSEADDR, plus
+// SO_REUSEPORT when reuse_port). Returns the fd, or -1 on failure.
+int bind_udp_socket(uint16_t port, bool reuse_port);
+
 class UdpFrameSource : public IFrameSource {
 public:
-    UdpFrameSource() = default;
+    // Most datagrams pulled from the kernel by one receive_batch() call
+    static constexpr std::size_t MAX_BATCH = 64;
+    // Largest datagram receive() accepts
+    static constexpr std::size_t MAX_DATAGRAM_SIZE = 65536;
+
+    UdpFrameSource();
     ~UdpFrameSource() override;
 
-    // Bind to a UDP port
-    bool bind(uint16_t port);
+    // Bind to a UDP port. With reuse_port, SO_REUSEPORT is set so several
+    // sockets can share the port and the kernel load-balances flows across them.
+    bool bind(uint16_t port, bool reuse_port = false);
 
     // Receive one datagram (blocks up to timeout)
     bool receive(std::vector<uint8_t>& buf) override;
 
+    // Wait up to timeout for the first datagram, then drain whatever else is
+    // queued (up to min(batch.capacity(), MAX_BATCH)) with a single
+    // recvmmsg() straight into the batch slots. Datagrams longer than
+    // FramePool::SLOT_SIZE are truncated. Each frame carries its kernel
+    // receive timestamp (SO_TIMESTAMPNS) in FrameView::rx_ts_ns.
+    std::size_t receive_batch(FrameBatch& batch) override;
+
     // Close socket
     void close();
 
     // Set receive timeout in milliseconds (0 = blocking)
     void set_timeout_ms(int ms);
 
+    // Busy-poll mode: before blocking in poll(), spin on non-blocking
+    // receives for up to budget_us microseconds. Trades a core for lower
+    // wakeup latency after idle gaps. Also requests SO_BUSY_POLL with the
+    // same budget (best effort; raising it past the sysctl default needs
+    // CAP_NET_ADMIN). 0 disables spinning.
+    void set_busy_poll_us(int budget_us);
+
     bool is_open() const { return sockfd_ >= 0; }
 
 private:
+    // Wait for POLLIN; spin first if busy-polling and spin is set
+    bool wait_readable(bool spin);
+    int recv_into(FrameBatch& batch, std::size_t max_frames);
+    void apply_busy_poll();
+
     int sockfd_ = -1;
     int timeout_ms_ = 100;
+    int busy_poll_us_ = 0;
+
+    // Fixed receive() landing buffer (sized once, never re-zeroed)
+    std::vector<uint8_t> rx_scratch_;
+    // recvmmsg() scatter state, wired up once in the constructor
+    std::vector<struct iovec> rx_iovs_;
+    std::vector<struct mmsghdr> rx_msgs_;
+    // Per-message control buffers for the SCM_TIMESTAMPNS cmsg
+    std::vector<uint8_t> rx_ctrl_;
 };
 
 class UdpFrameSink : public IFrameSink {
 public:
-    UdpFrameSink() = default;
+    // Most datagrams handed to the kernel by one sendmmsg() call
+    static constexpr std::size_t MAX_BATCH = 64;
+    // Most segments in one UDP GSO send (kernel UDP_MAX_SEGMENTS)
+    static constexpr std::size_t MAX_GSO_SEGMENTS = 64;
+
+    UdpFrameSink();
     ~UdpFrameSink() override;
 
     // Connect to a remote host:port (sets default destination)
     bool connect(const std::string& host, uint16_t port);
 
+    // Multicast destination: hop limit and whether this host's own
+    // group members get a copy (IP_MULTICAST_TTL / IP_MULTICAST_LOOP).
+    // After connect(); false if the socket rejects either.
+    bool set_multicast(int ttl, bool loopback);
+
     // Send one datagram
     bool send(const std::vector<uint8_t>& buf) override;
 
+    // Send frames with sendmmsg(), MAX_BATCH per syscall. With GSO enabled,
+    // runs of equal-size frames go out as a single UDP_SEGMENT send that the
+    // stack splits into one datagram per frame. Every frame is offered: one
+    // that cannot be sent is skipped, and the count returned leaves it out.
+    using IFrameSink::send_batch;
+    std::size_t send_batch(const FrameView* frames, std::size_t count) override;
+
+    // Enable UDP GSO (UDP_SEGMENT). Switched off again automatically if the
+    // kernel or route rejects it (EIO, EINVAL, EOPNOTSUPP); the frames then
+    // go out via sendmmsg(). Other send errors leave it on.
+    void set_gso(bool enabled) { gso_enabled_ = enabled; }
+    bool gso_enabled() const { return gso_enabled_; }
+
     // Close socket
     void close();
 
     bool is_open() const { return sockfd_ >= 0; }
 
 private:
+    std::size_t gso_run(const FrameView* frames, std::size_t count) const;
+    // 0 once the whole run is sent, or the errno it failed with
+    int send_gso(const FrameView* frames, std::size_t count);
+    std::size_t send_mmsg(const FrameView* frames, std::size_t count);
+
     int sockfd_ = -1;
+    bool gso_enabled_ = false;
+
+    // sendmmsg()/GSO gather state, sized once in the constructor
+    std::vector<struct iovec> tx_iovs_;
+    std::vector<struct mmsghdr> tx_msgs_;
 };
 
 } // namespace nng
@@ -0,0 +1,29 @@
+#include "replay/frame_rewrite.h"
+#include "common/crc32.h"
+#include <cstring>
+
+namespace nng {
+namespace detail {
+
+bool crc_follows(const uint8_t* data, std::size_t crc_len) {
+    uint32_t crc;
+    std::memcpy(&crc, data + crc_len, sizeof(crc));
+    return crc32(data, crc_len) == crc;
+}
+
+void store_crc(uint8_t* data, std::size_t crc_len) {
+    uint32_t crc = crc32(data, crc_len);
+    std::memcpy(data + crc_len, &crc, sizeof(crc));
+}
+
+} // namespace detail
+
+void remap_src_ids(uint8_t* data, std::size_t len, uint16_t offset) {
+    if (offset == 0)
+        return;
+    rewrite_headers(data, len, [offset](TelemetryHeader& h) {
+        h.src_id = static_cast<uint16_t>(h.src_id + offset);
+    });
+}
+
+} // namespace nng
@@ -0,0 +1,90 @@
+#pragma once
+#include "common/protocol.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace nng {
+
+namespace detail {
+
+// True if the crc_len bytes at data are followed by their CRC32
+bool crc_follows(const uint8_t* data, std::size_t crc_len);
+void store_crc(uint8_t* data, std::size_t crc_len);
+
+} // namespace detail
+
+// Call fn(const TelemetryHeader&) for every frame of a recorded datagram:
+// the frame of a v1 datagram, or each frame of a v2 container. Headers
+// that run past the datagram are skipped.
+template <typename Fn>
+void for_each_header(const uint8_t* data, std::size_t len, Fn&& fn) {
+    if (len == 0)
+        return;
+    if (data[0] == PROTOCOL_VERSION) {
+        if (len >= FRAME_HEADER_SIZE)
+            fn(deserialize_header(data));
+        return;
+    }
+    if (data[0] != PROTOCOL_VERSION_V2 || len < CONTAINER_HEADER_SIZE)
+        return;
+    ContainerHeader ch = deserialize_container_header(data);
+    std::size_t end = CONTAINER_HEADER_SIZE + ch.body_len;
+    if (end > len)
+        return;
+    std::size_t pos = CONTAINER_HEADER_SIZE;
+    for (uint16_t k = 0; k < ch.frame_count && pos + FRAME_HEADER_SIZE <= end; ++k) {
+        TelemetryHeader h = deserialize_header(data + pos);
+        fn(h);
+        pos += FRAME_HEADER_SIZE + h.payload_len;
+    }
+}
+
+// Rewrite every frame header of a recorded datagram in place with
+// fn(TelemetryHeader&); payload_len is kept. A CRC32 that was valid
+// before (per frame, or over a v2 container) is recomputed, so a frame
+// the parser accepted still passes; bytes it would reject stay bad.
+template <typename Fn>
+void rewrite_headers(uint8_t* data, std::size_t len, Fn&& fn) {
+    if (len == 0)
+        return;
+
+    if (data[0] == PROTOCOL_VERSION) {
+        if (len < FRAME_HEADER_SIZE)
+            return;
+        TelemetryHeader h = deserialize_header(data);
+        uint16_t payload_len = h.payload_len;
+        std::size_t crc_len = FRAME_HEADER_SIZE + payload_len;
+        bool had_crc = len >= crc_len + FRAME_CRC_SIZE && detail::crc_follows(data, crc_len);
+        fn(h);
+        h.payload_len = payload_len;
+        serialize_header(h, data);
+        if (had_crc)
+            detail::store_crc(data, crc_len);
+        return;
+    }
+
+    if (data[0] != PROTOCOL_VERSION_V2 || len < CONTAINER_HEADER_SIZE)
+        return;
+    ContainerHeader ch = deserialize_container_header(data);
+    std::size_t covered = CONTAINER_HEADER_SIZE + ch.body_len;
+    if (len < covered)
+        return;
+    bool had_crc = (ch.flags & CONTAINER_FLAG_CRC) != 0 && len >= covered + FRAME_CRC_SIZE &&
+                   detail::crc_follows(data, covered);
+    std::size_t pos = CONTAINER_HEADER_SIZE;
+    for (uint16_t k = 0; k < ch.frame_count && pos + FRAME_HEADER_SIZE <= covered; ++k) {
+        TelemetryHeader h = deserialize_header(data + pos);
+        uint16_t payload_len = h.payload_len;
+        fn(h);
+        h.payload_len = payload_len;
+        serialize_header(h, data + pos);
+        pos += FRAME_HEADER_SIZE + payload_len;
+    }
+    if (had_crc)
+        detail::store_crc(data, covered);
+}
+
+// Add offset to every src_id in a recorded datagram (in place)
+void remap_src_ids(uint8_t* data, std::size_t len, uint16_t offset);
+
+} // namespace nng
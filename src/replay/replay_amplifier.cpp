@@ -0,0 +1,182 @@
+#include "replay/replay_amplifier.h"
+#include "replay/frame_rewrite.h"
+#include "gateway/frame_pool.h"
+#include "gateway/recording_reader.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace nng {
+
+ReplayAmplifier::ReplayAmplifier(const AmplifyOptions& options)
+    : options_(options) {}
+
+bool ReplayAmplifier::open(const std::string& path) {
+    RecordingReader reader;
+    if (!reader.open(path, true))
+        return false;
+
+    uint64_t frames = 0;
+    uint64_t last_ts = 0;
+    uint16_t max_src = 0;
+    RecordedFrame f;
+    while (reader.next(f)) {
+        if (frames == 0)
+            first_ts_ns_ = f.rx_ts_ns;
+        last_ts = std::max(last_ts, f.rx_ts_ns);
+        for_each_header(f.data, f.len, [&max_src](const TelemetryHeader& h) {
+            max_src = std::max(max_src, h.src_id);
+        });
+        ++frames;
+    }
+    if (frames == 0 || options_.copies == 0)
+        return false;
+
+    uint32_t stride = options_.src_stride ? options_.src_stride : uint32_t{max_src} + 1;
+    if (uint64_t{stride} * (options_.copies - 1) + max_src > UINT16_MAX)
+        return false;
+
+    path_ = path;
+    recorded_frames_ = frames;
+    span_ns_ = last_ts - first_ts_ns_;
+    // The next pass starts one mean frame interval after this one ends
+    period_ns_ = span_ns_ + (frames > 1 ? span_ns_ / (frames - 1) : 1);
+    stride_ = static_cast<uint16_t>(stride);
+    threads_ = std::max<std::size_t>(1, std::min(options_.threads, options_.copies));
+
+    speed_ = options_.speed;
+    if (options_.target_fps > 0.0) {
+        // copies * frames datagrams per period / speed
+        double per_loop = static_cast<double>(options_.copies) * static_cast<double>(frames);
+        speed_ = span_ns_ > 0 ? options_.target_fps * static_cast<double>(period_ns_) / (per_loop * 1e9)
+                              : 0.0; // no time span to scale: as fast as possible
+    }
+    return true;
+}
+
+bool ReplayAmplifier::run(const SinkFactory& make_sink) {
+    if (path_.empty())
+        return false;
+    stop_.store(false, std::memory_order_relaxed);
+
+    std::vector<std::unique_ptr<IFrameSink>> sinks;
+    for (std::size_t t = 0; t < threads_; ++t) {
+        sinks.push_back(make_sink(t));
+        if (!sinks.back())
+            return false;
+    }
+
+    std::vector<ThreadResult> results(threads_);
+    uint64_t start_ns = ReplayPacer::now_ns();
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads_; ++t)
+        workers.emplace_back([this, t, &sinks, start_ns, &results] {
+            send_loop(t, *sinks[t], start_ns, results[t]);
+        });
+    send_loop(0, *sinks[0], start_ns, results[0]);
+    for (auto& w : workers)
+        w.join();
+
+    frames_sent_ = 0;
+    send_failures_ = 0;
+    pacing_ = PacingStats{};
+    bool ok = true;
+    for (const auto& r : results) {
+        ok = ok && r.ok;
+        frames_sent_ += r.sent;
+        send_failures_ += r.failures;
+        pacing_.merge(r.pacing);
+    }
+    return ok;
+}
+
+void ReplayAmplifier::send_loop(std::size_t thread, IFrameSink& sink, uint64_t start_ns,
+                                ThreadResult& out) {
+    RecordingReader reader;
+    reader.set_read_ahead(2);
+    if (!reader.open(path_, true)) {
+        out.ok = false;
+        return;
+    }
+
+    std::vector<uint16_t> offsets;
+    for (std::size_t k = thread; k < options_.copies; k += threads_)
+        offsets.push_back(static_cast<uint16_t>(k * stride_));
+
+    ReplayPacer pacer;
+    pacer.set_slot_ns(options_.slot_ns);
+    pacer.set_spin_ns(options_.spin_ns);
+    bool paced = speed_ > 0.0;
+
+    FrameBatch batch(BATCH);
+    std::vector<uint64_t> due; // due time of each datagram in batch
+    std::vector<SeqRebase> rebase(UINT16_MAX + 1);
+
+    auto flush = [&] {
+        if (batch.empty())
+            return;
+        if (paced) {
+            uint64_t released = pacer.wait_until(due.front());
+            for (uint64_t d : due)
+                pacer.record(d, released);
+            pacer.count_slot();
+        }
+        std::size_t sent = sink.send_batch(batch.views(), batch.size());
+        out.sent += sent;
+        out.failures += batch.size() - sent;
+        batch.clear();
+        due.clear();
+    };
+
+    RecordedFrame f;
+    for (uint32_t loop = 0; loop < options_.loops; ++loop) {
+        if (loop > 0 && !reader.seek_frame(0))
+            break;
+        uint64_t loop_ns = uint64_t{loop} * period_ns_;
+        // Seqs are rebased once per recorded frame; copies only differ in src_id
+        auto next_seq = [&rebase, loop](uint16_t src_id, uint32_t seq) {
+            SeqRebase& r = rebase[src_id];
+            if (!r.seen) {
+                r.seen = true;
+                r.loop = loop;
+                r.high = seq;
+            } else if (r.loop != loop) {
+                r.loop = loop;
+                r.offset = r.high + 1 - seq;
+            }
+            uint32_t s = seq + r.offset;
+            if (static_cast<int32_t>(s - r.high) > 0)
+                r.high = s;
+            return s;
+        };
+
+        while (!stop_.load(std::memory_order_relaxed) && reader.next(f)) {
+            uint64_t d = 0;
+            if (paced) {
+                uint64_t offset_ns = loop_ns + (f.rx_ts_ns > first_ts_ns_ ? f.rx_ts_ns - first_ts_ns_ : 0);
+                d = start_ns + static_cast<uint64_t>(offset_ns / speed_);
+                if (!batch.empty() && d > due.front() + pacer.slot_ns())
+                    flush();
+            }
+
+            // Oversized records are truncated to the slot
+            std::size_t len = std::min<std::size_t>(f.len, FramePool::SLOT_SIZE);
+            for (uint16_t src_offset : offsets) {
+                if (batch.full())
+                    flush();
+                uint8_t* slot = batch.next_slot();
+                std::memcpy(slot, f.data, len);
+                rewrite_headers(slot, len, [&](TelemetryHeader& h) {
+                    h.seq = next_seq(h.src_id, h.seq);
+                    h.src_id = static_cast<uint16_t>(h.src_id + src_offset);
+                });
+                batch.commit(len);
+                due.push_back(d);
+            }
+        }
+    }
+    flush();
+    out.pacing = pacer.stats();
+}
+
+} // namespace nng
@@ -0,0 +1,102 @@
+#pragma once
+#include "gateway/frame_source.h"
+#include "replay/replay_pacer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+struct AmplifyOptions {
+    std::size_t copies = 10;     // virtual sensors per recorded source
+    uint16_t src_stride = 0;     // copy k adds k * src_stride to src_id; 0: highest src_id + 1
+    std::size_t threads = 1;     // sender threads, each with its own sink
+    double speed = 1.0;          // playback multiplier; 0: as fast as possible
+    double target_fps = 0.0;     // aggregate datagrams/s; sets the speed when > 0
+    std::size_t loops = 1;       // passes over the recording
+    uint64_t slot_ns = ReplayPacer::DEFAULT_SLOT_NS;
+    uint64_t spin_ns = ReplayPacer::DEFAULT_SPIN_NS;
+};
+
+// Load generator: replays one recording as copies virtual sensors. Copy k
+// of a datagram has every src_id raised by k * src_stride and its CRC32s
+// recomputed, so the gateway sees copies * sources independent sources
+// with the recording's traffic shape (bursts, gaps, reorders). On later
+// loops each source's seq carries on from where the previous pass ended,
+// so looping adds no gaps.
+//
+// Copies are split over the sender threads (copy k on thread k % threads).
+// Each thread reads the file through its own mapped reader, paces with its
+// own ReplayPacer against a shared start time, and hands each pacing slot
+// to its sink in one send_batch() call.
+class ReplayAmplifier {
+public:
+    static constexpr std::size_t BATCH = 64; // datagrams per send_batch()
+
+    // Sink for sender thread i; nullptr if it cannot be created
+    using SinkFactory = std::function<std::unique_ptr<IFrameSink>(std::size_t thread)>;
+
+    explicit ReplayAmplifier(const AmplifyOptions& options = {});
+
+    // Scan the recording (datagram count, time span, highest src_id). False
+    // if it cannot be opened, is empty, or the copies' src_ids would not
+    // fit in 16 bits.
+    bool open(const std::string& path);
+
+    // Send every copy for every loop; blocks until done or stop(). False if
+    // not open or a sink could not be created.
+    bool run(const SinkFactory& make_sink);
+
+    // Ask run() to return early (any thread)
+    void stop() { stop_.store(true, std::memory_order_relaxed); }
+
+    uint64_t recorded_frames() const { return recorded_frames_; }
+    uint64_t recorded_span_ns() const { return span_ns_; }
+    uint16_t src_stride() const { return stride_; }
+    std::size_t threads() const { return threads_; }
+    // Playback multiplier in effect (from target_fps when set)
+    double speed() const { return speed_; }
+
+    uint64_t frames_sent() const { return frames_sent_; }
+    uint64_t send_failures() const { return send_failures_; } // datagrams a sink refused
+    PacingStats pacing_stats() const { return pacing_; }
+
+private:
+    // Continues a source's seq across loops
+    struct SeqRebase {
+        uint32_t offset = 0;
+        uint32_t high = 0; // highest seq sent so far
+        uint32_t loop = 0; // pass offset belongs to
+        bool seen = false;
+    };
+
+    struct ThreadResult {
+        bool ok = true;
+        uint64_t sent = 0;
+        uint64_t failures = 0;
+        PacingStats pacing;
+    };
+
+    void send_loop(std::size_t thread, IFrameSink& sink, uint64_t start_ns, ThreadResult& out);
+
+    AmplifyOptions options_;
+    std::string path_;
+    uint64_t recorded_frames_ = 0;
+    uint64_t first_ts_ns_ = 0;
+    uint64_t span_ns_ = 0;
+    uint64_t period_ns_ = 0; // recorded time one loop takes
+    uint16_t stride_ = 0;
+    std::size_t threads_ = 1;
+    double speed_ = 1.0;
+    std::atomic<bool> stop_{false};
+
+    uint64_t frames_sent_ = 0;
+    uint64_t send_failures_ = 0;
+    PacingStats pacing_;
+};
+
+} // namespace nng
@@ -1,5 +1,7 @@
 #include "replay/replay_engine.h"
-#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <functional>
 
 namespace nng {
 
@@ -8,14 +10,29 @@ ReplayFrameSource::~ReplayFrameSource() {
 }
 
 bool ReplayFrameSource::open(const std::string& path) {
+    return open(std::vector<ReplayInput>{ReplayInput{path, 0}});
+}
+
+bool ReplayFrameSource::open(const std::vector<ReplayInput>& inputs) {
     close();
-    file_.open(path, std::ios::binary);
-    if (!file_.is_open())
+    for (const auto& in : inputs) {
+        auto input = std::make_unique<Input>();
+        input->src_offset = in.src_offset;
+        input->reader.set_read_ahead(READ_AHEAD_CHUNKS);
+        if (!input->reader.open(in.path, true)) {
+            close();
+            return false;
+        }
+        inputs_.push_back(std::move(input));
+    }
+    if (inputs_.empty())
         return false;
 
     frames_replayed_ = 0;
-    done_ = false;
     first_frame_ = true;
+    pacer_.reset();
+    rebuild_heap();
+    done_ = exhausted();
     return true;
 }
 
@@ -23,74 +40,215 @@ void ReplayFrameSource::set_speed(double multiplier) {
     speed_multiplier_ = multiplier;
 }
 
-bool ReplayFrameSource::receive(std::vector<uint8_t>& buf) {
-    buf.clear();
+uint64_t ReplayFrameSource::frame_total() const {
+    uint64_t total = 0;
+    for (const auto& in : inputs_) {
+        if (!in->reader.is_chunked())
+            return 0;
+        total += in->reader.frame_total();
+    }
+    return total;
+}
+
+bool ReplayFrameSource::is_chunked() const {
+    return !inputs_.empty() && std::all_of(inputs_.begin(), inputs_.end(),
+        [](const auto& in) { return in->reader.is_chunked(); });
+}
+
+bool ReplayFrameSource::is_mapped() const {
+    return !inputs_.empty() && std::all_of(inputs_.begin(), inputs_.end(),
+        [](const auto& in) { return in->reader.is_mapped(); });
+}
+
+void ReplayFrameSource::advance(std::size_t i) {
+    Input& in = *inputs_[i];
+    if (in.dry || !in.reader.next(in.head))
+        return;
+    heap_.emplace_back(in.head.rx_ts_ns, static_cast<uint32_t>(i));
+    std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+}
+
+void ReplayFrameSource::rebuild_heap() {
+    heap_.clear();
+    consumed_ = -1;
+    has_held_ = false;
+    for (std::size_t i = 0; i < inputs_.size(); ++i)
+        advance(i);
+}
+
+bool ReplayFrameSource::exhausted() const {
+    return heap_.empty() && !has_held_;
+}
 
-    if (!file_.is_open() || done_)
+bool ReplayFrameSource::next_frame(RecordedFrame& frame) {
+    if (has_held_) {
+        frame = held_;
+        has_held_ = false;
+        return true;
+    }
+    if (done_)
         return false;
 
-    // Read timestamp
-    uint64_t ts_ns = 0;
-    file_.read(reinterpret_cast<char*>(&ts_ns), sizeof(ts_ns));
-    if (!file_.good()) {
+    // The previous frame has been copied or handed out: move its input on
+    if (consumed_ >= 0) {
+        advance(static_cast<std::size_t>(consumed_));
+        consumed_ = -1;
+    }
+    if (heap_.empty()) {
         done_ = true;
         return false;
     }
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+    consumed_ = static_cast<int>(heap_.back().second);
+    heap_.pop_back();
+    frame = inputs_[static_cast<std::size_t>(consumed_)]->head;
+    return true;
+}
 
-    // Read frame length
-    uint32_t len = 0;
-    file_.read(reinterpret_cast<char*>(&len), sizeof(len));
-    if (!file_.good()) {
-        done_ = true;
-        return false;
+bool ReplayFrameSource::seek_frame(uint64_t frame_no) {
+    bool ok = inputs_.size() == 1 && inputs_[0]->reader.seek_frame(frame_no);
+    for (auto& in : inputs_)
+        in->dry = !ok;
+    after_seek(ok);
+    return ok;
+}
+
+bool ReplayFrameSource::seek_time(uint64_t ts_ns) {
+    bool ok = false;
+    for (auto& in : inputs_) {
+        in->dry = !in->reader.seek_time(ts_ns); // inputs ending earlier drop out
+        ok = ok || !in->dry;
     }
+    after_seek(ok);
+    return ok;
+}
 
-    // Read frame data
-    buf.resize(len);
-    if (len > 0) {
-        file_.read(reinterpret_cast<char*>(buf.data()), len);
-        if (!file_.good()) {
-            done_ = true;
-            buf.clear();
-            return false;
-        }
+void ReplayFrameSource::after_seek(bool ok) {
+    frames_replayed_ = 0;
+    for (const auto& in : inputs_) {
+        if (!in->dry)
+            frames_replayed_ += in->reader.position();
+    }
+    done_ = !ok;
+    if (ok) {
+        rebuild_heap();
+        done_ = exhausted();
     }
+    has_held_ = false;
+    first_frame_ = true;
+}
 
-    // Handle timing for real-time playback
-    if (speed_multiplier_ > 0.0) {
-        if (first_frame_) {
-            first_frame_ = false;
-            first_frame_ts_ns_ = ts_ns;
-            replay_start_time_ = std::chrono::steady_clock::now();
-        } else {
-            // Calculate how long to wait
-            uint64_t frame_offset_ns = ts_ns - first_frame_ts_ns_;
-            auto target_offset = std::chrono::nanoseconds(
-                static_cast<uint64_t>(frame_offset_ns / speed_multiplier_));
-
-            auto elapsed = std::chrono::steady_clock::now() - replay_start_time_;
-            auto wait_time = target_offset - elapsed;
-
-            if (wait_time.count() > 0) {
-                std::this_thread::sleep_for(wait_time);
-            }
-        }
+std::size_t ReplayFrameSource::copy_frame(const RecordedFrame& frame, uint8_t* dst,
+                                          std::size_t cap) const {
+    std::size_t take = std::min<std::size_t>(frame.len, cap);
+    if (take > 0)
+        std::memcpy(dst, frame.data, take);
+    uint16_t offset = inputs_[static_cast<std::size_t>(consumed_)]->src_offset;
+    remap_src_ids(dst, take, offset);
+    return take;
+}
+
+uint64_t ReplayFrameSource::due_ns(uint64_t ts_ns) {
+    if (first_frame_) {
+        first_frame_ = false;
+        first_frame_ts_ns_ = ts_ns;
+        replay_start_ns_ = pacer_.now();
     }
+    // Frames recorded out of timestamp order are due at once
+    uint64_t offset_ns = ts_ns > first_frame_ts_ns_ ? ts_ns - first_frame_ts_ns_ : 0;
+    return replay_start_ns_ + static_cast<uint64_t>(offset_ns / speed_multiplier_);
+}
+
+void ReplayFrameSource::pace(uint64_t ts_ns) {
+    // Handle timing for real-time playback
+    if (speed_multiplier_ <= 0.0)
+        return;
+    uint64_t due = due_ns(ts_ns);
+    pacer_.record(due, pacer_.wait_until(due));
+    pacer_.count_slot();
+}
 
+void ReplayFrameSource::finish_frame() {
     ++frames_replayed_;
 
-    // Check if more data
-    if (file_.peek() == EOF) {
+    // Check if more data: the heap, or the input just consumed
+    if (heap_.empty() && !has_held_ &&
+        (consumed_ < 0 || inputs_[static_cast<std::size_t>(consumed_)]->reader.at_end())) {
         done_ = true;
     }
+}
 
+bool ReplayFrameSource::next_view(RecordedFrame& frame) {
+    if (!next_frame(frame))
+        return false;
+    if (inputs_[static_cast<std::size_t>(consumed_)]->src_offset != 0) {
+        remap_buf_.resize(frame.len);
+        copy_frame(frame, remap_buf_.data(), remap_buf_.size());
+        frame.data = remap_buf_.data();
+    }
+    pace(frame.rx_ts_ns);
+    finish_frame();
     return true;
 }
 
-void ReplayFrameSource::close() {
-    if (file_.is_open()) {
-        file_.close();
+bool ReplayFrameSource::receive(std::vector<uint8_t>& buf) {
+    buf.clear();
+
+    RecordedFrame frame;
+    if (!next_frame(frame))
+        return false;
+    buf.resize(frame.len);
+    copy_frame(frame, buf.data(), buf.size());
+
+    pace(frame.rx_ts_ns);
+    finish_frame();
+    return true;
+}
+
+void ReplayFrameSource::add_to_batch(FrameBatch& batch, const RecordedFrame& frame) {
+    // Oversized records are truncated to the slot
+    batch.commit(copy_frame(frame, batch.next_slot(), FramePool::SLOT_SIZE));
+    finish_frame();
+}
+
+std::size_t ReplayFrameSource::receive_batch(FrameBatch& batch) {
+    batch.clear();
+
+    RecordedFrame frame;
+    if (speed_multiplier_ <= 0.0) {
+        while (!batch.full() && next_frame(frame))
+            add_to_batch(batch, frame);
+        return batch.size();
+    }
+
+    // Gather the frames due within one slot of the first, then release
+    // them together when the first is due
+    due_.clear();
+    while (!batch.full() && next_frame(frame)) {
+        uint64_t due = due_ns(frame.rx_ts_ns);
+        if (!due_.empty() && due > due_.front() + pacer_.slot_ns()) {
+            held_ = frame;
+            has_held_ = true;
+            break;
+        }
+        due_.push_back(due);
+        add_to_batch(batch, frame);
     }
+    if (due_.empty())
+        return 0;
+
+    uint64_t released = pacer_.wait_until(due_.front());
+    for (uint64_t due : due_)
+        pacer_.record(due, released);
+    pacer_.count_slot();
+    return batch.size();
+}
+
+void ReplayFrameSource::close() {
+    has_held_ = false;
+    inputs_.clear();
+    heap_.clear();
+    consumed_ = -1;
     done_ = true;
 }
 
@@ -1,26 +1,71 @@
 #pragma once
 #include "gateway/frame_source.h"
+#include "gateway/recording_reader.h"
+#include "replay/frame_rewrite.h"
+#include "replay/replay_pacer.h"
+#include <memory>
 #include <string>
-#include <fstream>
 #include <cstdint>
-#include <chrono>
+#include <vector>
 
 namespace nng {
 
+// One recording of a merged replay
+struct ReplayInput {
+    std::string path;
+    uint16_t src_offset = 0; // added to every src_id, e.g. to keep sites apart
+};
+
+// Replays one recording, or several merged into one stream ordered by
+// recorded receive time. Each file keeps its own streaming reader and
+// the next frame comes from a min-heap over the readers' head frames
+// (ties go to the earlier input), so memory is a few chunks per file
+// whatever the file sizes.
 class ReplayFrameSource : public IFrameSource {
 public:
+    static constexpr std::size_t READ_AHEAD_CHUNKS = 4; // decoded on a background thread
+
     ReplayFrameSource() = default;
     ~ReplayFrameSource() override;
 
-    // Open recorded file
+    // Open recorded file (chunked v2 or legacy format), memory-mapped
     bool open(const std::string& path);
+    // Open several files for merged replay; false if any fails to open
+    bool open(const std::vector<ReplayInput>& inputs);
+
+    // Continue from frame number frame_no, or from the first frame whose
+    // receive timestamp is >= ts_ns. Pacing restarts from there, and
+    // frames_replayed() counts from the new position. v2 files go straight
+    // to the right chunk through the index; legacy files are scanned.
+    // seek_frame() needs a single input; seek_time() moves every input.
+    bool seek_frame(uint64_t frame_no);
+    bool seek_time(uint64_t ts_ns);
+
+    // Frames in all inputs (0 if unknown: a legacy-format input)
+    uint64_t frame_total() const;
+    bool is_chunked() const;
+    std::size_t input_count() const { return inputs_.size(); }
 
     // Set playback speed multiplier (1.0 = real-time, 0.0 = as fast as possible)
     void set_speed(double multiplier);
 
+    // Paced playback: deadlines, slot grouping and schedule error
+    ReplayPacer& pacer() { return pacer_; }
+    PacingStats pacing_stats() const { return pacer_.stats(); }
+
+    // Next frame, paced, without a copy: frame.data points into the
+    // mapping (or the decoded chunk) and stays valid until the next call.
+    // Frames of an input with a src_offset are copied to be remapped.
+    bool next_view(RecordedFrame& frame);
+
     // IFrameSource interface
     bool receive(std::vector<uint8_t>& buf) override;
 
+    // Reads records directly into the batch slots. At speed 0 the batch is
+    // filled. Paced, the batch holds the frames due within one pacing slot
+    // of the first, and is returned when that first frame is due.
+    std::size_t receive_batch(FrameBatch& batch) override;
+
     // Is there more data?
     bool is_done() const { return done_; }
 
@@ -29,18 +74,57 @@ public:
 
     void close();
 
-    bool is_open() const { return file_.is_open(); }
+    bool is_open() const { return !inputs_.empty(); }
+    bool is_mapped() const;
 
 private:
-    std::ifstream file_;
+    struct Input {
+        RecordingReader reader;
+        uint16_t src_offset = 0;
+        bool dry = false;   // nothing left after the last seek
+        RecordedFrame head; // next frame; valid until reader advances
+    };
+
+    // Next frame in timestamp order: the one held back by the last paced
+    // batch, else the head of the earliest input
+    bool next_frame(RecordedFrame& frame);
+    // Read input i's next frame into the heap (if it has one)
+    void advance(std::size_t i);
+    // Refill the heap from every input's current position
+    void rebuild_heap();
+    bool exhausted() const;
+    // Copy a frame to dst, remapping its src_ids; returns bytes written
+    std::size_t copy_frame(const RecordedFrame& frame, uint8_t* dst, std::size_t cap) const;
+    // Steady-clock time the frame recorded at ts_ns is due
+    uint64_t due_ns(uint64_t ts_ns);
+    void pace(uint64_t ts_ns);
+    void add_to_batch(FrameBatch& batch, const RecordedFrame& frame);
+    void finish_frame();
+    void after_seek(bool ok);
+
+    std::vector<std::unique_ptr<Input>> inputs_;
+    // Min-heap of (head rx_ts_ns, input index)
+    std::vector<std::pair<uint64_t, uint32_t>> heap_;
+    // Input whose head was handed out last; advanced on the next read so
+    // the frame's bytes stay valid until then
+    int consumed_ = -1;
+    std::vector<uint8_t> remap_buf_;
+
     double speed_multiplier_ = 1.0;
     uint64_t frames_replayed_ = 0;
     bool done_ = false;
 
+    // Frame read but due in a later slot: data stays valid because its
+    // input is not advanced until it is handed out
+    RecordedFrame held_;
+    bool has_held_ = false;
+
     // For timing
+    ReplayPacer pacer_;
     bool first_frame_ = true;
     uint64_t first_frame_ts_ns_ = 0;
-    std::chrono::steady_clock::time_point replay_start_time_;
+    uint64_t replay_start_ns_ = 0;
+    std::vector<uint64_t> due_; // due times of the batch being built
 };
 
 } // namespace nng
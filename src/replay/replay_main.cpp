@@ -1,98 +1,295 @@
+#include "replay/replay_amplifier.h"
 #include "replay/replay_engine.h"
+#include "replay/session_analyzer.h"
 #include "gateway/udp_socket.h"
+#include "gateway/shm_ring.h"
+#include "gateway/telemetry_parser.h"
 #include "common/protocol.h"
 #include <iostream>
+#include <memory>
 #include <string>
 #include <chrono>
 #include <cstring>
+#include <vector>
+
+// --amplify --dry-run: count the datagrams, send nothing
+class DiscardSink : public nng::IFrameSink {
+public:
+    bool send(const std::vector<uint8_t>&) override { return true; }
+    using IFrameSink::send_batch;
+    std::size_t send_batch(const nng::FrameView*, std::size_t count) override { return count; }
+};
 
 void print_usage(const char* prog) {
-    std::cerr << "Usage: " << prog << " --file <path> [options]\n"
+    std::cerr << "Usage: " << prog << " --file <path> [--file <path> ...] [options]\n"
               << "Options:\n"
-              << "  --file <path>     Recorded file to replay (required)\n"
+              << "  --file <path>     Recorded file to replay (required); several are merged\n"
+              << "                    in receive-time order\n"
+              << "  --src-offset <n>  Add n to the src_ids of the preceding --file\n"
               << "  --speed <mult>    Playback speed (1.0 = real-time, 0.0 = fast)\n"
               << "  --host <ip>       Target host (default: 127.0.0.1)\n"
               << "  --port <port>     Target UDP port (default: 5000)\n"
+              << "  --start-frame <n> Start at frame number n (single --file only)\n"
+              << "  --start-ns <ts>   Start at the first frame received at or after ts\n"
               << "  --dry-run         Print frame summaries without sending\n"
+              << "  --gso             Send equal-size frames with UDP GSO\n"
+              << "  --shm <name>      Send through the gateway's shared-memory ring (--rx shm), not UDP;\n"
+              << "                    waits for room instead of dropping\n"
+              << "  --slot-us <n>     Send frames due within n us together (default: 50)\n"
+              << "  --spin-us <n>     Spin instead of sleeping for the last n us (default: 200)\n"
+              << "  --amplify <k>     Send the file as k virtual copies of every source\n"
+              << "  --rate <fps>      Amplify: aggregate datagrams/s (overrides --speed)\n"
+              << "  --loops <n>       Amplify: passes over the file (default: 1)\n"
+              << "  --src-stride <n>  Amplify: src_id step between copies (default: max src_id + 1)\n"
+              << "  --analyze         Parse and track the whole file offline, print stats\n"
+              << "  --threads <n>     Analysis threads (default: one per core), or amplify\n"
+              << "                    sender threads (default: 1)\n"
+              << "  --no-crc          Analysis: frames carry no CRC32\n"
               << "  --help            Show this help\n";
 }
 
 int main(int argc, char* argv[]) {
-    std::string file_path;
+    std::vector<nng::ReplayInput> inputs;
     std::string host = "127.0.0.1";
     uint16_t port = 5000;
     double speed = 1.0;
     bool dry_run = false;
+    bool gso = false;
+    std::string shm_name;
+    long long start_frame = -1;
+    long long start_ns = -1;
+    long long slot_us = -1;
+    long long spin_us = -1;
+    bool analyze = false;
+    nng::AnalysisOptions analysis;
+    std::size_t amplify = 0;
+    nng::AmplifyOptions amp;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--file" && i + 1 < argc) {
-            file_path = argv[++i];
+            inputs.push_back(nng::ReplayInput{argv[++i], 0});
+        } else if (arg == "--src-offset" && i + 1 < argc) {
+            if (inputs.empty()) {
+                std::cerr << "Error: --src-offset must follow a --file\n";
+                return 1;
+            }
+            inputs.back().src_offset = static_cast<uint16_t>(std::stoul(argv[++i]));
         } else if (arg == "--speed" && i + 1 < argc) {
             speed = std::stod(argv[++i]);
         } else if (arg == "--host" && i + 1 < argc) {
             host = argv[++i];
         } else if (arg == "--port" && i + 1 < argc) {
             port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if (arg == "--start-frame" && i + 1 < argc) {
+            start_frame = std::stoll(argv[++i]);
+        } else if (arg == "--start-ns" && i + 1 < argc) {
+            start_ns = std::stoll(argv[++i]);
         } else if (arg == "--dry-run") {
             dry_run = true;
+        } else if (arg == "--gso") {
+            gso = true;
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (arg == "--slot-us" && i + 1 < argc) {
+            slot_us = std::stoll(argv[++i]);
+        } else if (arg == "--spin-us" && i + 1 < argc) {
+            spin_us = std::stoll(argv[++i]);
+        } else if (arg == "--amplify" && i + 1 < argc) {
+            amplify = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            amp.target_fps = std::stod(argv[++i]);
+        } else if (arg == "--loops" && i + 1 < argc) {
+            amp.loops = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--src-stride" && i + 1 < argc) {
+            amp.src_stride = static_cast<uint16_t>(std::stoul(argv[++i]));
+        } else if (arg == "--analyze") {
+            analyze = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            analysis.threads = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--no-crc") {
+            analysis.crc_enabled = false;
         } else if (arg == "--help") {
             print_usage(argv[0]);
             return 0;
         }
     }
 
-    if (file_path.empty()) {
+    if (inputs.empty()) {
         std::cerr << "Error: --file is required\n";
         print_usage(argv[0]);
         return 1;
     }
 
+    const std::string target = shm_name.empty() ? host + ":" + std::to_string(port)
+                                                : "shared-memory ring " + shm_name;
+    // A recording is replayed whole: on the shared ring, senders wait for room
+    auto connect_sink = [&]() -> std::unique_ptr<nng::IFrameSink> {
+        if (!shm_name.empty()) {
+            auto sink = std::make_unique<nng::ShmFrameSink>();
+            if (!sink->connect(shm_name))
+                return nullptr;
+            sink->set_blocking(true);
+            return sink;
+        }
+        auto sink = std::make_unique<nng::UdpFrameSink>();
+        if (!sink->connect(host, port))
+            return nullptr;
+        sink->set_gso(gso);
+        return sink;
+    };
+
+    if (analyze) {
+        const std::string& file_path = inputs.front().path;
+        if (inputs.size() > 1)
+            std::cerr << "Warning: --analyze reads only " << file_path << "\n";
+        auto start_time = std::chrono::steady_clock::now();
+        nng::SessionAnalyzer analyzer(analysis);
+        if (!analyzer.run(file_path)) {
+            std::cerr << "Error: Could not open file: " << file_path << "\n";
+            return 1;
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time);
+        std::cout << "=== Analysis (" << analyzer.threads() << " threads, " << ms.count()
+                  << " ms) ===\n";
+        analyzer.write_report(std::cout);
+        return 0;
+    }
+
+    if (amplify > 0) {
+        amp.copies = amplify;
+        amp.threads = analysis.threads > 0 ? analysis.threads : 1;
+        amp.speed = speed;
+        if (slot_us >= 0)
+            amp.slot_ns = static_cast<uint64_t>(slot_us) * 1000;
+        if (spin_us >= 0)
+            amp.spin_ns = static_cast<uint64_t>(spin_us) * 1000;
+        if (inputs.size() > 1)
+            std::cerr << "Warning: --amplify reads only " << inputs.front().path << "\n";
+
+        nng::ReplayAmplifier amplifier(amp);
+        if (!amplifier.open(inputs.front().path)) {
+            std::cerr << "Error: Could not open " << inputs.front().path
+                      << " for amplification (empty, or src_ids of " << amplify
+                      << " copies do not fit in 16 bits)\n";
+            return 1;
+        }
+        auto make_sink = [&](std::size_t) -> std::unique_ptr<nng::IFrameSink> {
+            if (dry_run)
+                return std::make_unique<DiscardSink>();
+            return connect_sink();
+        };
+
+        auto start_time = std::chrono::steady_clock::now();
+        if (!amplifier.run(make_sink)) {
+            std::cerr << "Error: Could not connect to " << target << "\n";
+            return 1;
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time);
+
+        std::cout << "\n=== Amplified Replay Summary ===\n"
+                  << "Copies: " << amplify << " (src_id stride " << amplifier.src_stride() << "), "
+                  << amplifier.threads() << " sender threads, speed " << amplifier.speed() << "\n"
+                  << "Frames sent: " << amplifier.frames_sent() << " (" << amplifier.send_failures()
+                  << " failed)\n"
+                  << "Duration: " << ms.count() << " ms\n";
+        if (ms.count() > 0)
+            std::cout << "Effective rate: "
+                      << static_cast<double>(amplifier.frames_sent()) * 1000.0 / ms.count()
+                      << " frames/sec\n";
+        if (amplifier.speed() > 0.0) {
+            nng::PacingStats p = amplifier.pacing_stats();
+            std::cout << "Schedule error: mean " << p.mean_abs_error_ns / 1000.0
+                      << " us, late p99/max " << p.late_ns.percentile(0.99) / 1000.0 << "/"
+                      << p.max_late_ns / 1000.0 << " us, " << p.slots << " sends\n";
+        }
+        return 0;
+    }
+
     nng::ReplayFrameSource replay;
-    if (!replay.open(file_path)) {
-        std::cerr << "Error: Could not open file: " << file_path << "\n";
+    if (!replay.open(inputs)) {
+        std::cerr << "Error: Could not open file:";
+        for (const auto& in : inputs)
+            std::cerr << " " << in.path;
+        std::cerr << "\n";
         return 1;
     }
 
     replay.set_speed(speed);
+    if (slot_us >= 0)
+        replay.pacer().set_slot_ns(static_cast<uint64_t>(slot_us) * 1000);
+    if (spin_us >= 0)
+        replay.pacer().set_spin_ns(static_cast<uint64_t>(spin_us) * 1000);
+
+    bool seek_ok = true;
+    if (start_frame >= 0)
+        seek_ok = replay.seek_frame(static_cast<uint64_t>(start_frame));
+    else if (start_ns >= 0)
+        seek_ok = replay.seek_time(static_cast<uint64_t>(start_ns));
+    if (!seek_ok) {
+        std::cerr << "Error: start position is past the end of the recording\n";
+        return 1;
+    }
 
-    nng::UdpFrameSink sink;
+    std::unique_ptr<nng::IFrameSink> sink;
     if (!dry_run) {
-        if (!sink.connect(host, port)) {
-            std::cerr << "Error: Could not connect to " << host << ":" << port << "\n";
+        sink = connect_sink();
+        if (!sink) {
+            std::cerr << "Error: Could not connect to " << target << "\n";
             return 1;
         }
     }
 
     auto start_time = std::chrono::steady_clock::now();
-    std::vector<uint8_t> buf;
+    // As-fast-as-possible replay fills whole batches; paced replay yields
+    // the frames of one pacing slot per call
+    nng::FrameBatch batch(nng::UdpFrameSink::MAX_BATCH);
+    uint64_t frame_no = replay.frames_replayed();
+    nng::ParsedFrameBatch parsed(nng::UdpFrameSink::MAX_BATCH);
 
     while (!replay.is_done()) {
-        if (!replay.receive(buf))
+        std::size_t n = replay.receive_batch(batch);
+        if (n == 0)
             break;
 
         if (dry_run) {
-            // Print frame summary
-            if (buf.size() >= nng::FRAME_HEADER_SIZE) {
-                nng::TelemetryHeader hdr = nng::deserialize_header(buf.data());
-                const char* msg_type_str = "UNKNOWN";
-                switch (static_cast<nng::MsgType>(hdr.msg_type)) {
-                    case nng::MsgType::PLOT:       msg_type_str = "PLOT"; break;
-                    case nng::MsgType::TRACK:      msg_type_str = "TRACK"; break;
-                    case nng::MsgType::HEARTBEAT:  msg_type_str = "HEARTBEAT"; break;
-                    case nng::MsgType::ENGAGEMENT: msg_type_str = "ENGAGEMENT"; break;
+            // Unpacks v2 containers; CRCs are not checked in a dry run
+            nng::parse_frames(batch.views(), n, false, parsed);
+            std::size_t r = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const nng::FrameView& frame = batch[i];
+                ++frame_no;
+                bool container = nng::is_container(frame.data, frame.len);
+                if (container)
+                    std::cout << "Frame " << frame_no << ": container len=" << frame.len << "\n";
+
+                for (; r < parsed.count && parsed.sources[r] == i; ++r) {
+                    const char* indent = container ? "  " : "";
+                    if (parsed.errors[r] == nng::ParseError::TOO_SHORT) {
+                        std::cout << indent << "Frame " << frame_no
+                                  << ": len=" << parsed.frame_lens[r] << " (too short for header)\n";
+                        continue;
+                    }
+                    const nng::TelemetryHeader& hdr = parsed.headers[r];
+                    const char* msg_type_str = "UNKNOWN";
+                    switch (static_cast<nng::MsgType>(hdr.msg_type)) {
+                        case nng::MsgType::PLOT:       msg_type_str = "PLOT"; break;
+                        case nng::MsgType::TRACK:      msg_type_str = "TRACK"; break;
+                        case nng::MsgType::HEARTBEAT:  msg_type_str = "HEARTBEAT"; break;
+                        case nng::MsgType::ENGAGEMENT: msg_type_str = "ENGAGEMENT"; break;
+                        case nng::MsgType::TRACK_DELTA: msg_type_str = "TRACK_DELTA"; break;
+                    }
+                    std::cout << indent << "Frame " << frame_no
+                              << ": src_id=" << hdr.src_id
+                              << " seq=" << hdr.seq
+                              << " type=" << msg_type_str
+                              << " len=" << parsed.frame_lens[r] << "\n";
                 }
-                std::cout << "Frame " << replay.frames_replayed()
-                          << ": src_id=" << hdr.src_id
-                          << " seq=" << hdr.seq
-                          << " type=" << msg_type_str
-                          << " len=" << buf.size() << "\n";
-            } else {
-                std::cout << "Frame " << replay.frames_replayed()
-                          << ": len=" << buf.size() << " (too short for header)\n";
             }
         } else {
-            sink.send(buf);
+            sink->send_batch(batch.views(), n);
         }
     }
 
@@ -107,11 +304,17 @@ int main(int argc, char* argv[]) {
         double rate = static_cast<double>(replay.frames_replayed()) * 1000.0 / duration.count();
         std::cout << "Effective rate: " << rate << " frames/sec\n";
     }
+    if (speed > 0.0) {
+        nng::PacingStats p = replay.pacing_stats();
+        std::cout << "Schedule error: mean " << p.mean_abs_error_ns / 1000.0 << " us, late p50/p99/max "
+                  << p.late_ns.percentile(0.5) / 1000.0 << "/"
+                  << p.late_ns.percentile(0.99) / 1000.0 << "/" << p.max_late_ns / 1000.0
+                  << " us, " << p.early_frames << " frames up to " << p.max_early_ns / 1000.0
+                  << " us early, " << p.slots << " sends\n";
+    }
 
     replay.close();
-    if (!dry_run) {
-        sink.close();
-    }
+    sink.reset();
 
     return 0;
 }
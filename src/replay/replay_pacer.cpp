@@ -0,0 +1,81 @@
+#include "replay/replay_pacer.h"
+#include <chrono>
+#include <thread>
+
+namespace nng {
+
+void PacingStats::merge(const PacingStats& other) {
+    uint64_t total = frames + other.frames;
+    if (total > 0)
+        mean_abs_error_ns = (mean_abs_error_ns * frames + other.mean_abs_error_ns * other.frames) / total;
+    frames = total;
+    slots += other.slots;
+    late_frames += other.late_frames;
+    early_frames += other.early_frames;
+    if (other.max_late_ns > max_late_ns)
+        max_late_ns = other.max_late_ns;
+    if (other.max_early_ns > max_early_ns)
+        max_early_ns = other.max_early_ns;
+    late_ns.merge(other.late_ns);
+}
+
+uint64_t ReplayPacer::now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t ReplayPacer::wait_until(uint64_t deadline_ns) {
+    uint64_t t = now();
+    if (t + spin_ns_ < deadline_ns) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - spin_ns_ - t));
+        t = now();
+    }
+    while (t < deadline_ns)
+        t = now();
+    return t;
+}
+
+void ReplayPacer::record(uint64_t due_ns, uint64_t released_ns) {
+    ++frames_;
+    if (released_ns >= due_ns) {
+        uint64_t late = released_ns - due_ns;
+        if (late > 0)
+            ++late_;
+        if (late > max_late_)
+            max_late_ = late;
+        late_hist_.record(late);
+        abs_error_total_ += late;
+    } else {
+        uint64_t early = due_ns - released_ns;
+        ++early_;
+        if (early > max_early_)
+            max_early_ = early;
+        abs_error_total_ += early;
+    }
+}
+
+PacingStats ReplayPacer::stats() const {
+    PacingStats s;
+    s.frames = frames_;
+    s.slots = slots_;
+    s.late_frames = late_;
+    s.early_frames = early_;
+    s.max_late_ns = max_late_;
+    s.max_early_ns = max_early_;
+    late_hist_.add_to(s.late_ns);
+    s.mean_abs_error_ns = frames_ ? static_cast<double>(abs_error_total_) / frames_ : 0.0;
+    return s;
+}
+
+void ReplayPacer::reset() {
+    frames_ = 0;
+    slots_ = 0;
+    late_ = 0;
+    early_ = 0;
+    max_late_ = 0;
+    max_early_ = 0;
+    abs_error_total_ = 0;
+    late_hist_.reset();
+}
+
+} // namespace nng
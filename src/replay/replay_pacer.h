@@ -0,0 +1,73 @@
+#pragma once
+#include "common/histogram.h"
+#include <cstdint>
+
+namespace nng {
+
+// How closely paced replay kept to the recorded schedule. Error is the
+// time a frame was handed out minus the time it was due; frames of one
+// slot go out together, so some leave up to a slot early.
+struct PacingStats {
+    uint64_t frames = 0;
+    uint64_t slots = 0;        // batches released
+    uint64_t late_frames = 0;  // released after their due time
+    uint64_t early_frames = 0; // released before it (same slot as an earlier frame)
+    uint64_t max_late_ns = 0;
+    uint64_t max_early_ns = 0;
+    HistogramSnapshot late_ns;  // lateness of frames not released early
+    double mean_abs_error_ns = 0.0;
+
+    // Fold in the stats of another pacer (e.g. another sender thread)
+    void merge(const PacingStats& other);
+};
+
+// Waits for replay deadlines on the steady clock. Sleeping all the way
+// oversleeps by tens of microseconds, so wait_until() sleeps until
+// spin_ns before the deadline and then spins on the clock. Frames whose
+// due times fall within slot_ns of the first frame of a batch are
+// released together with it (one sendmmsg() instead of one wake-up per
+// frame). Single-threaded.
+class ReplayPacer {
+public:
+    static constexpr uint64_t DEFAULT_SLOT_NS = 50000;  // 50 us
+    static constexpr uint64_t DEFAULT_SPIN_NS = 200000; // last 200 us are spun
+
+    void set_slot_ns(uint64_t ns) { slot_ns_ = ns; }
+    void set_spin_ns(uint64_t ns) { spin_ns_ = ns; }
+    uint64_t slot_ns() const { return slot_ns_; }
+
+    // Steady-clock time in ns
+    static uint64_t now_ns();
+
+    // The clock deadlines are on and waited against: now_ns() unless
+    // replaced (tests drive it by hand)
+    using Clock = uint64_t (*)();
+    void set_clock(Clock clock) { clock_ = clock; }
+    uint64_t now() const { return clock_(); }
+
+    // Return at or just after deadline_ns; the time it returned
+    uint64_t wait_until(uint64_t deadline_ns);
+
+    // A frame due at due_ns was released at released_ns
+    void record(uint64_t due_ns, uint64_t released_ns);
+    void count_slot() { ++slots_; }
+
+    PacingStats stats() const;
+    void reset();
+
+private:
+    Clock clock_ = &now_ns;
+    uint64_t slot_ns_ = DEFAULT_SLOT_NS;
+    uint64_t spin_ns_ = DEFAULT_SPIN_NS;
+
+    uint64_t frames_ = 0;
+    uint64_t slots_ = 0;
+    uint64_t late_ = 0;
+    uint64_t early_ = 0;
+    uint64_t max_late_ = 0;
+    uint64_t max_early_ = 0;
+    uint64_t abs_error_total_ = 0;
+    Histogram late_hist_;
+};
+
+} // namespace nng
@@ -0,0 +1,201 @@
+#include "replay/session_analyzer.h"
+#include "gateway/frame_pool.h"
+#include <algorithm>
+#include <thread>
+
+namespace nng {
+
+SessionAnalyzer::SessionAnalyzer(const AnalysisOptions& options)
+    : options_(options),
+      threads_(options.threads ? options.threads
+                               : std::max(1u, std::thread::hardware_concurrency())) {
+    stats_.set_writer_shards(threads_);
+    for (std::size_t p = 0; p < threads_; ++p)
+        trackers_.push_back(
+            std::make_unique<SequenceTracker>(SeqStorage::FLAT, options_.reorder_window));
+}
+
+SessionAnalyzer::~SessionAnalyzer() = default;
+
+template <typename Fn>
+void SessionAnalyzer::parallel_for(std::size_t n, Fn fn) {
+    std::size_t workers = std::min(threads_, n);
+    if (workers <= 1) {
+        for (std::size_t i = 0; i < n; ++i)
+            fn(i, 0);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < workers; ++t) {
+        pool.emplace_back([&, t] {
+            for (std::size_t i = t; i < n; i += workers)
+                fn(i, t);
+        });
+    }
+    for (auto& th : pool)
+        th.join();
+}
+
+bool SessionAnalyzer::run(const std::string& path) {
+    RecordingReader reader;
+    if (!reader.open(path, true))
+        return false;
+    datagrams_ = 0;
+    return reader.is_chunked() ? run_chunked(path, reader) : run_legacy(reader);
+}
+
+bool SessionAnalyzer::run_chunked(const std::string& path, RecordingReader& reader) {
+    // One mapped reader per parse thread; chunks are independent
+    std::vector<std::unique_ptr<RecordingReader>> readers;
+    for (std::size_t t = 0; t < threads_; ++t) {
+        readers.push_back(std::make_unique<RecordingReader>());
+        if (!readers.back()->open(path, true))
+            return false;
+    }
+
+    const std::size_t chunk_count = reader.chunks().size();
+    const std::size_t window = options_.window_chunks ? options_.window_chunks : 4 * threads_;
+    window_.resize(window);
+    for (std::size_t first = 0; first < chunk_count; first += window) {
+        std::size_t n = std::min(window, chunk_count - first);
+        parallel_for(n, [&](std::size_t i, std::size_t t) {
+            parse_chunk(*readers[t], first + i, window_[i]);
+        });
+
+        // Replay ends at the first chunk it cannot read
+        std::size_t usable = 0;
+        while (usable < n && window_[usable].ok)
+            ++usable;
+        parallel_for(threads_, [&](std::size_t p, std::size_t) { track_partition(p, usable); });
+        for (std::size_t i = 0; i < usable; ++i)
+            datagrams_ += window_[i].datagrams;
+        if (usable < n)
+            break;
+    }
+    return true;
+}
+
+bool SessionAnalyzer::run_legacy(RecordingReader& reader) {
+    window_.resize(1);
+    Block& block = window_[0];
+    ParsedFrameBatch parsed(1);
+    RecordedFrame frame;
+    bool more = true;
+    while (more) {
+        block.results.clear();
+        block.datagrams = 0;
+        block.ok = true;
+        while (block.datagrams < LEGACY_BLOCK_FRAMES && (more = reader.next(frame)))
+            parse_datagram(frame, parsed, block);
+        parallel_for(threads_, [&](std::size_t p, std::size_t) { track_partition(p, 1); });
+        datagrams_ += block.datagrams;
+    }
+    return true;
+}
+
+void SessionAnalyzer::parse_chunk(RecordingReader& reader, std::size_t chunk, Block& block) const {
+    block.results.clear();
+    block.datagrams = 0;
+    block.ok = true;
+
+    const ChunkHeader& h = reader.chunks()[chunk].header;
+    const uint64_t end = h.first_frame + h.frame_count;
+    if (h.frame_count == 0)
+        return;
+    if (!reader.seek_frame(h.first_frame)) {
+        block.ok = false;
+        return;
+    }
+    ParsedFrameBatch parsed(1);
+    RecordedFrame frame;
+    // A corrupt record makes the reader skip the rest of the chunk, as in
+    // replay: stop once next() has moved on to the next chunk
+    while (reader.position() < end && reader.next(frame) && reader.position() <= end)
+        parse_datagram(frame, parsed, block);
+}
+
+void SessionAnalyzer::parse_datagram(const RecordedFrame& frame, ParsedFrameBatch& parsed,
+                                     Block& block) const {
+    // Same view replay hands the gateway: truncated to one frame slot
+    FrameView view{frame.data, std::min<std::size_t>(frame.len, FramePool::SLOT_SIZE),
+                   frame.rx_ts_ns};
+    parse_frames(&view, 1, options_.crc_enabled, parsed);
+    for (std::size_t i = 0; i < parsed.count; ++i) {
+        FrameResult r{};
+        r.rx_ts_ns = frame.rx_ts_ns;
+        r.error = static_cast<uint8_t>(parsed.errors[i]);
+        if (parsed.errors[i] == ParseError::OK) {
+            r.sender_ts_ns = parsed.headers[i].ts_ns;
+            r.seq = parsed.headers[i].seq;
+            r.src_id = parsed.headers[i].src_id;
+        }
+        block.results.push_back(r);
+    }
+    ++block.datagrams;
+}
+
+void SessionAnalyzer::track_partition(std::size_t p, std::size_t count) {
+    StatsShard& stats = stats_.shard(p);
+    SequenceTracker& tracker = *trackers_[p];
+    for (std::size_t b = 0; b < count; ++b) {
+        for (const FrameResult& r : window_[b].results) {
+            auto err = static_cast<ParseError>(r.error);
+            if (err != ParseError::OK) {
+                if (p == 0) {
+                    stats.record_malformed(0);
+                    if (err == ParseError::CRC_MISMATCH)
+                        stats.record_crc_fail(0);
+                }
+                continue;
+            }
+            if (r.src_id % threads_ != p)
+                continue;
+
+            // One lookup per frame, as the gateway's validate step
+            SourceRecord& source = stats.resolve(r.src_id);
+            if (!source.window)
+                source.window = tracker.window(r.src_id);
+            SeqEvent ev = tracker.track(source.seq, source.window, r.src_id, r.seq);
+            stats.record_rx(source, r.seq, r.rx_ts_ns, r.sender_ts_ns);
+            switch (ev.result) {
+                case SeqResult::GAP:
+                    stats.record_gap(source, ev.gap_size);
+                    break;
+                case SeqResult::REORDER:
+                    stats.record_reorder(source);
+                    break;
+                case SeqResult::DUPLICATE:
+                    stats.record_duplicate(source);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+void SessionAnalyzer::write_report(std::ostream& os) const {
+    GlobalStats g = stats_.get_global_stats();
+    os << "Datagrams:  " << datagrams_ << "\n"
+       << "Frames:     " << g.rx_total << "\n"
+       << "Malformed:  " << g.malformed_total << "\n"
+       << "CRC fail:   " << g.crc_fail_total << "\n"
+       << "Gaps:       " << g.gap_total << "\n"
+       << "Reorders:   " << g.reorder_total << "\n"
+       << "Duplicates: " << g.duplicate_total << "\n";
+
+    SourceLatency lat = stats_.get_all_source_latency();
+    os << "Interarrival p50/p99 ns: " << lat.interarrival.percentile(0.5) << " / "
+       << lat.interarrival.percentile(0.99) << "\n";
+
+    std::vector<SourceStats> sources;
+    stats_.get_all_source_stats(sources); // sorted by src_id
+    for (const SourceStats& s : sources) {
+        os << "src " << s.src_id << ": rx=" << s.rx_count << " malformed=" << s.malformed
+           << " gaps=" << s.gaps << " reorders=" << s.reorders
+           << " duplicates=" << s.duplicates << " last_seq=" << s.last_seq
+           << " last_ts_ns=" << s.last_ts_ns << "\n";
+    }
+}
+
+} // namespace nng
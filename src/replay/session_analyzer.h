@@ -0,0 +1,98 @@
+#pragma once
+#include "gateway/recording_reader.h"
+#include "gateway/sequence_tracker.h"
+#include "gateway/stats_manager.h"
+#include "gateway/telemetry_parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace nng {
+
+struct AnalysisOptions {
+    std::size_t threads = 0;       // 0: one per core
+    bool crc_enabled = true;       // as GatewayConfig::crc_enabled
+    std::size_t reorder_window = 1024; // as GatewayConfig::reorder_window
+    std::size_t window_chunks = 0; // chunks parsed per round; 0: 4 per thread
+};
+
+// Offline analysis of a recording: the parse / sequence tracking / stats
+// work of a Gateway replay, spread over all cores, with results identical
+// to a single-threaded run.
+//
+// The file is processed in windows of chunks, each in two parallel steps:
+//   1. parse: threads take whole chunks (each with its own mapped reader)
+//      and reduce every datagram to compact per-frame results;
+//   2. track: thread p owns the sources with src_id % threads == p and
+//      walks the window's results in file order, running its own
+//      SequenceTracker and writing its own StatsShard.
+// Every source is tracked by one thread in recorded order, so gaps,
+// reorders and duplicates come out exactly as in a sequential replay;
+// parse errors (counted against src_id 0, as the gateway does) belong to
+// partition 0. Frames carry their recorded receive time, so timestamps
+// are reproducible too. Legacy files have no chunks: they are parsed on
+// the calling thread in fixed-size blocks and only tracking runs in
+// parallel.
+class SessionAnalyzer {
+public:
+    explicit SessionAnalyzer(const AnalysisOptions& options = {});
+    ~SessionAnalyzer();
+
+    SessionAnalyzer(const SessionAnalyzer&) = delete;
+    SessionAnalyzer& operator=(const SessionAnalyzer&) = delete;
+
+    // Analyze the whole file; false if it cannot be opened. Stops at the
+    // first unreadable chunk, as replay does.
+    bool run(const std::string& path);
+
+    // Sum of the partitions' shards
+    const StatsManager& stats() const { return stats_; }
+    uint64_t datagrams() const { return datagrams_; }
+    std::size_t threads() const { return threads_; }
+
+    // Global counters then one line per source, sorted by src_id
+    void write_report(std::ostream& os) const;
+
+private:
+    static constexpr std::size_t LEGACY_BLOCK_FRAMES = 16384;
+
+    // One result of parse_frames(), reduced to what tracking needs
+    struct FrameResult {
+        uint64_t rx_ts_ns;
+        uint64_t sender_ts_ns;
+        uint32_t seq;
+        uint16_t src_id;
+        uint8_t  error; // ParseError
+    };
+
+    struct Block {
+        std::vector<FrameResult> results;
+        uint64_t datagrams = 0;
+        bool ok = true;
+    };
+
+    // Parse chunk `chunk` with reader into block
+    void parse_chunk(RecordingReader& reader, std::size_t chunk, Block& block) const;
+    // Parse one datagram, appending its results
+    void parse_datagram(const RecordedFrame& frame, ParsedFrameBatch& parsed, Block& block) const;
+    // Track partition p's frames of blocks [0, count)
+    void track_partition(std::size_t p, std::size_t count);
+    // Run fn(i) for i in [0, n) spread over the worker threads
+    template <typename Fn>
+    void parallel_for(std::size_t n, Fn fn);
+
+    bool run_chunked(const std::string& path, RecordingReader& reader);
+    bool run_legacy(RecordingReader& reader);
+
+    AnalysisOptions options_;
+    std::size_t threads_;
+    StatsManager stats_;
+    std::vector<std::unique_ptr<SequenceTracker>> trackers_; // one per partition
+    std::vector<Block> window_;
+    uint64_t datagrams_ = 0;
+};
+
+} // namespace nng
@@ -0,0 +1,118 @@
+#include "sensor_sim/beam_scanner.h"
+#include <cmath>
+
+namespace nng {
+
+namespace {
+
+double wrap_360(double deg) {
+    if (deg >= 0.0 && deg < 360.0) // WorldModel keeps azimuths here already
+        return deg;
+    double r = std::fmod(deg, 360.0);
+    if (r < 0.0)
+        r += 360.0;
+    return r >= 360.0 ? 0.0 : r;
+}
+
+} // anonymous namespace
+
+AzimuthIndex::AzimuthIndex(double bucket_deg, double max_range_m)
+    : bucket_deg_(bucket_deg > 0.0 && bucket_deg <= 360.0 ? bucket_deg : 1.0),
+      max_range_m_(max_range_m),
+      start_(static_cast<std::size_t>(std::ceil(360.0 / bucket_deg_)) + 1, 0) {}
+
+std::size_t AzimuthIndex::bucket_of(double az_deg) const {
+    std::size_t b = static_cast<std::size_t>(az_deg / bucket_deg_);
+    return b < buckets() ? b : buckets() - 1;
+}
+
+void AzimuthIndex::build(const std::vector<WorldObject>& objects) {
+    std::size_t nb = buckets();
+    start_.assign(nb + 1, 0);
+    bucket_.resize(objects.size());
+
+    // Count per bucket (shifted by one), then prefix-sum into starts
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        const WorldObject& obj = objects[i];
+        if (max_range_m_ > 0.0 && obj.range_m > max_range_m_) {
+            bucket_[i] = UINT32_MAX;
+            continue;
+        }
+        std::size_t b = bucket_of(wrap_360(obj.azimuth_deg));
+        bucket_[i] = static_cast<uint32_t>(b);
+        start_[b + 1]++;
+        kept++;
+    }
+    for (std::size_t b = 0; b < nb; ++b)
+        start_[b + 1] += start_[b];
+
+    items_.resize(kept);
+    azimuth_.resize(kept);
+    // Place in object order, with a write cursor per bucket
+    std::vector<uint32_t>& cursor = cursor_;
+    cursor.assign(start_.begin(), start_.end() - 1);
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        uint32_t b = bucket_[i];
+        if (b == UINT32_MAX)
+            continue;
+        uint32_t at = cursor[b]++;
+        items_[at] = static_cast<uint32_t>(i);
+        azimuth_[at] = wrap_360(objects[i].azimuth_deg);
+    }
+}
+
+void AzimuthIndex::query(double from_deg, double len_deg, std::vector<uint32_t>& out) const {
+    if (len_deg <= 0.0)
+        return;
+    if (len_deg >= 360.0) {
+        out.insert(out.end(), items_.begin(), items_.end());
+        return;
+    }
+    double from = wrap_360(from_deg);
+    std::size_t nb = buckets();
+    std::size_t first = bucket_of(from);
+    // Buckets the arc touches: the first, plus one per bucket_deg_ of reach
+    // beyond the first bucket's start
+    double reach = from - static_cast<double>(first) * bucket_deg_ + len_deg;
+    std::size_t count = static_cast<std::size_t>(std::ceil(reach / bucket_deg_));
+    if (count > nb)
+        count = nb;
+
+    for (std::size_t k = 0; k < count; ++k) {
+        std::size_t b = (first + k) % nb;
+        // Only the arc's end buckets can hold objects outside it
+        bool edge = k == 0 || k + 1 == count;
+        for (uint32_t at = start_[b]; at < start_[b + 1]; ++at) {
+            if (edge) {
+                double d = azimuth_[at] - from;
+                if (d < 0.0)
+                    d += 360.0;
+                if (d >= len_deg)
+                    continue;
+            }
+            out.push_back(items_[at]);
+        }
+    }
+}
+
+BeamScanner::BeamScanner(const BeamOptions& options)
+    : options_(options), centre_deg_(wrap_360(options.start_deg)) {}
+
+void BeamScanner::advance(double dt_s) {
+    double sweep = options_.rpm * 6.0 * dt_s; // 360 deg / 60 s
+    from_deg_ = centre_deg_ - options_.width_deg / 2.0;
+    len_deg_ = sweep + options_.width_deg;
+    centre_deg_ = wrap_360(centre_deg_ + sweep);
+}
+
+void BeamScanner::select(const AzimuthIndex& index, const std::vector<WorldObject>& objects,
+                         std::vector<WorldObject>& out) {
+    out.clear();
+    hits_.clear();
+    index.query(from_deg_, len_deg_, hits_);
+    for (uint32_t i : hits_)
+        out.push_back(objects[i]);
+}
+
+} // namespace nng
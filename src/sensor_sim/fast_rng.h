@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace nng {
+
+// Which random engine the simulator draws from.
+//
+// STD: std::mt19937 with the std:: distributions, as always. The engine's
+// bits are fixed by the standard but the distributions are not, so a seed
+// reproduces a run only with the same standard library.
+//
+// FAST: FastRng (xoshiro256++) with the transforms below. Roughly an order
+// of magnitude cheaper per draw, and a seed reproduces a run on any
+// platform with IEEE doubles and the same libm (log/sqrt/sin/cos). Its
+// stream is unrelated to STD's: the same seed gives different frames.
+enum class RngMode { STD, FAST };
+
+// xoshiro256++ (Blackman & Vigna), seeded through splitmix64. A
+// UniformRandomBitGenerator, so the std:: distributions accept it too.
+class FastRng {
+public:
+    using result_type = uint64_t;
+
+    explicit FastRng(uint64_t seed = 1) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        for (auto& word : s_) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        uint64_t result = rotl(s_[0] + s_[3], 23) + s_[0];
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, 1), 53 random bits
+    double uniform01() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+    // Uniform in [0, n) for n <= 2^32 (multiply-shift, bias below n / 2^32)
+    uint64_t below(uint64_t n) { return ((*this)() >> 32) * n >> 32; }
+    // Uniform in [lo, hi]
+    int uniform_int(int lo, int hi) {
+        return lo + static_cast<int>(below(static_cast<uint64_t>(hi - lo) + 1));
+    }
+
+    // One standard normal deviate (ziggurat: mostly a table compare and a
+    // multiply, no transcendental calls)
+    double normal();
+    // n of them into out, in draw order
+    void fill_normal(double* out, std::size_t n);
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+} // namespace nng
@@ -1,25 +1,44 @@
 #include "sensor_sim/fault_injector.h"
-#include <algorithm>
+#include <utility>
 
 namespace nng {
 
-FaultInjector::FaultInjector(const FaultConfig& config, uint32_t seed)
-    : config_(config), rng_(seed) {}
+FaultInjector::FaultInjector(const FaultConfig& config, uint32_t seed, RngMode mode)
+    : config_(config), mode_(mode), rng_(seed), fast_(seed) {}
 
-void FaultInjector::apply(std::vector<std::vector<uint8_t>>& frames) {
+double FaultInjector::roll_pct() {
+    if (mode_ == RngMode::FAST)
+        return fast_.uniform01() * 100.0;
+    std::uniform_real_distribution<double> pct(0.0, 100.0);
+    return pct(rng_);
+}
+
+std::size_t FaultInjector::pick(std::size_t hi) {
+    if (mode_ == RngMode::FAST)
+        return static_cast<std::size_t>(fast_.below(static_cast<uint64_t>(hi) + 1));
+    std::uniform_int_distribution<std::size_t> dist(0, hi);
+    return dist(rng_);
+}
+
+const FaultPlan& FaultInjector::plan(const FrameView* frames, std::size_t count) {
     last_stats_ = FaultStats{};
+    std::vector<uint32_t>& order = plan_.order;
+    order.clear();
+    plan_.flips.clear();
 
-    if (frames.empty())
-        return;
+    if (count == 0)
+        return plan_;
 
-    std::uniform_real_distribution<double> pct(0.0, 100.0);
+    order.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        order[i] = static_cast<uint32_t>(i);
 
     // 1. Corruption (before loss, so corrupted frames may also be dropped)
     if (config_.corrupt_pct > 0.0) {
-        for (auto& frame : frames) {
-            if (pct(rng_) < config_.corrupt_pct && !frame.empty()) {
-                std::uniform_int_distribution<size_t> byte_dist(0, frame.size() - 1);
-                frame[byte_dist(rng_)] ^= 0xFF;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (roll_pct() < config_.corrupt_pct && frames[i].len > 0) {
+                plan_.flips.push_back({static_cast<uint32_t>(i),
+                                       static_cast<uint32_t>(pick(frames[i].len - 1))});
                 last_stats_.corrupted++;
             }
         }
@@ -27,44 +46,85 @@ void FaultInjector::apply(std::vector<std::vector<uint8_t>>& frames) {
 
     // 2. Duplication (before loss, so duplicates may be dropped)
     if (config_.duplicate_pct > 0.0) {
-        std::vector<std::vector<uint8_t>> extras;
-        for (size_t i = 0; i < frames.size(); ++i) {
-            if (pct(rng_) < config_.duplicate_pct) {
-                extras.push_back(frames[i]);
-                last_stats_.duplicated++;
+        std::size_t dups = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (roll_pct() < config_.duplicate_pct) {
+                order.push_back(static_cast<uint32_t>(i));
+                dups++;
             }
         }
-        // Insert duplicates at random positions
-        for (auto& dup : extras) {
-            std::uniform_int_distribution<size_t> pos_dist(0, frames.size());
-            auto pos = frames.begin() + static_cast<ptrdiff_t>(pos_dist(rng_));
-            frames.insert(pos, std::move(dup));
+        last_stats_.duplicated += static_cast<uint32_t>(dups);
+        // Move each duplicate (queued at the end) to a random position among
+        // the frames placed so far. Only 4-byte indices shift.
+        for (std::size_t d = 0; d < dups; ++d) {
+            std::size_t placed = count + d;
+            std::size_t pos = pick(placed);
+            uint32_t dup = order[placed];
+            for (std::size_t j = placed; j > pos; --j)
+                order[j] = order[j - 1];
+            order[pos] = dup;
         }
     }
 
     // 3. Loss
     if (config_.loss_pct > 0.0) {
-        auto new_end = std::remove_if(frames.begin(), frames.end(),
-            [&](const std::vector<uint8_t>&) {
-                if (pct(rng_) < config_.loss_pct) {
-                    last_stats_.dropped++;
-                    return true;
-                }
-                return false;
-            });
-        frames.erase(new_end, frames.end());
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            if (roll_pct() < config_.loss_pct)
+                last_stats_.dropped++;
+            else
+                order[kept++] = order[i];
+        }
+        order.resize(kept);
     }
 
     // 4. Reorder (swap adjacent pairs)
-    if (config_.reorder_pct > 0.0 && frames.size() >= 2) {
-        for (size_t i = 0; i + 1 < frames.size(); ++i) {
-            if (pct(rng_) < config_.reorder_pct) {
-                std::swap(frames[i], frames[i + 1]);
+    if (config_.reorder_pct > 0.0 && order.size() >= 2) {
+        for (std::size_t i = 0; i + 1 < order.size(); ++i) {
+            if (roll_pct() < config_.reorder_pct) {
+                std::swap(order[i], order[i + 1]);
                 last_stats_.reordered++;
                 ++i; // skip the swapped pair
             }
         }
     }
+    return plan_;
+}
+
+void FaultInjector::apply(std::vector<std::vector<uint8_t>>& frames) {
+    views_.resize(frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        views_[i] = FrameView{frames[i].data(), frames[i].size()};
+    const FaultPlan& p = plan(views_.data(), views_.size());
+
+    for (const auto& f : p.flips)
+        frames[f.frame][f.byte] ^= 0xFF;
+
+    // Frames sent once are moved; a duplicated one is copied until its last send
+    uses_.assign(frames.size(), 0);
+    for (uint32_t i : p.order)
+        uses_[i]++;
+    std::vector<std::vector<uint8_t>> out;
+    out.reserve(p.order.size());
+    for (uint32_t i : p.order) {
+        if (--uses_[i] == 0)
+            out.push_back(std::move(frames[i]));
+        else
+            out.push_back(frames[i]);
+    }
+    frames.swap(out);
+}
+
+void FaultInjector::apply(FrameArena& arena, std::vector<FrameView>& out) {
+    const FrameView* views = arena.views();
+    const FaultPlan& p = plan(views, arena.size());
+
+    for (const auto& f : p.flips)
+        arena.data(f.frame)[f.byte] ^= 0xFF;
+
+    out.resize(p.order.size());
+    for (std::size_t i = 0; i < p.order.size(); ++i)
+        out[i] = views[p.order[i]];
 }
 
 } // namespace nng
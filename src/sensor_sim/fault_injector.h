@@ -1,6 +1,9 @@
 #pragma once
+#include "sensor_sim/fast_rng.h"
+#include "sensor_sim/frame_arena.h"
 #include <vector>
 #include <random>
+#include <cstddef>
 #include <cstdint>
 
 namespace nng {
@@ -12,13 +15,36 @@ struct FaultConfig {
     double corrupt_pct   = 0.0;
 };
 
+// The faults for one batch as indices into it: nothing is copied or moved.
+// order is the send order (an index may appear twice when duplicated, or
+// not at all when lost); flips are the bytes to XOR with 0xFF, applied to
+// the batch before it is sent.
+struct FaultPlan {
+    struct Flip {
+        uint32_t frame;
+        uint32_t byte;
+    };
+    std::vector<uint32_t> order;
+    std::vector<Flip> flips;
+};
+
 class FaultInjector {
 public:
-    explicit FaultInjector(const FaultConfig& config, uint32_t seed = 99);
+    explicit FaultInjector(const FaultConfig& config, uint32_t seed = 99,
+                           RngMode mode = RngMode::STD);
 
     // Apply faults to a batch of frames IN PLACE.
     void apply(std::vector<std::vector<uint8_t>>& frames);
 
+    // Same faults for the frames of an arena, which stay where they are:
+    // corrupted bytes are flipped in the arena and out gets the views to
+    // send, in order. Both forms draw the RNG identically.
+    void apply(FrameArena& arena, std::vector<FrameView>& out);
+
+    // The faults for count frames (only their lengths are read); valid
+    // until the next call. apply() is this plus carrying the plan out.
+    const FaultPlan& plan(const FrameView* frames, std::size_t count);
+
     struct FaultStats {
         uint32_t dropped    = 0;
         uint32_t reordered  = 0;
@@ -29,9 +55,19 @@ public:
     FaultStats last_stats() const { return last_stats_; }
 
 private:
+    // Uniform in [0, 100)
+    double roll_pct();
+    // Uniform in [0, hi]
+    std::size_t pick(std::size_t hi);
+
     FaultConfig config_;
+    RngMode mode_;
     std::mt19937 rng_;
+    FastRng fast_;
     FaultStats last_stats_;
+    FaultPlan plan_;
+    std::vector<FrameView> views_;   // apply(vector) input to plan()
+    std::vector<uint32_t> uses_;     // apply(vector): sends left per frame
 };
 
 } // namespace nng
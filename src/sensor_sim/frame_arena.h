@@ -0,0 +1,59 @@
+#pragma once
+#include "gateway/frame_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nng {
+
+// A tick's frames serialized back to back into one reusable buffer, with
+// an offsets table: frame i is bytes [offset(i), offset(i + 1)). clear()
+// keeps the capacity, so once the buffers have grown to a tick's size
+// building the next tick allocates nothing. views() can go straight to
+// IFrameSink::send_batch().
+class FrameArena {
+public:
+    void clear() {
+        bytes_.clear();
+        offsets_.assign(1, 0);
+    }
+
+    void reserve(std::size_t frames, std::size_t bytes) {
+        offsets_.reserve(frames + 1);
+        views_.reserve(frames);
+        bytes_.reserve(bytes);
+    }
+
+    // Room for a len-byte frame at the end; valid until the next append
+    uint8_t* append(std::size_t len) {
+        std::size_t at = bytes_.size();
+        bytes_.resize(at + len);
+        offsets_.push_back(static_cast<uint32_t>(at + len));
+        return bytes_.data() + at;
+    }
+
+    std::size_t size() const { return offsets_.size() - 1; }
+    bool empty() const { return size() == 0; }
+    std::size_t bytes() const { return bytes_.size(); }
+
+    const uint8_t* data(std::size_t i) const { return bytes_.data() + offsets_[i]; }
+    uint8_t* data(std::size_t i) { return bytes_.data() + offsets_[i]; }
+    std::size_t length(std::size_t i) const { return offsets_[i + 1] - offsets_[i]; }
+    // size() + 1 entries, the last being bytes()
+    const std::vector<uint32_t>& offsets() const { return offsets_; }
+
+    // One view per frame, in order; valid until the arena next changes
+    const FrameView* views() {
+        views_.resize(size());
+        for (std::size_t i = 0; i < size(); ++i)
+            views_[i] = FrameView{data(i), length(i)};
+        return views_.data();
+    }
+
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<uint32_t> offsets_ = {0};
+    std::vector<FrameView> views_;
+};
+
+} // namespace nng
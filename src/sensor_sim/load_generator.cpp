@@ -0,0 +1,68 @@
+#include "sensor_sim/load_generator.h"
+
+namespace nng {
+
+LoadGenerator::LoadGenerator(const LoadOptions& options, uint16_t src_id, uint32_t seed)
+    : options_(options),
+      measurer_(src_id, seed, options.rng),
+      period_ns_(options.rate_fps > 0.0 ? 1e9 / options.rate_fps : 0.0),
+      scheduled_(options.rate_fps > 0.0 && options.duration_s > 0.0
+                     ? static_cast<uint64_t>(options.rate_fps * options.duration_s)
+                     : 0) {
+    if (options_.max_batch == 0)
+        options_.max_batch = 1;
+    arena_.reserve(options_.max_batch,
+                   options_.max_batch * (FRAME_HEADER_SIZE + sizeof(TrackPayload)));
+}
+
+void LoadGenerator::start(uint64_t steady_ns, uint64_t wall_ns) {
+    start_steady_ns_ = steady_ns;
+    start_wall_ns_ = wall_ns;
+    last_send_ns_ = steady_ns;
+}
+
+uint64_t LoadGenerator::due_ns(uint64_t k) const {
+    // From k, not by adding up periods, so rounding does not drift
+    return start_steady_ns_ + static_cast<uint64_t>(static_cast<double>(k) * period_ns_);
+}
+
+std::size_t LoadGenerator::send_due(const std::vector<WorldObject>& objects, uint64_t now_ns,
+                                    IFrameSink& sink) {
+    arena_.clear();
+    uint64_t k = sent_;
+    for (; k < scheduled_ && k - sent_ < options_.max_batch; ++k) {
+        uint64_t due = due_ns(k);
+        if (due > now_ns)
+            break;
+        uint64_t ts = start_wall_ns_ + (due - start_steady_ns_);
+        if (objects.empty()) {
+            measurer_.generate_heartbeat(ts, arena_);
+        } else {
+            if (next_object_ >= objects.size())
+                next_object_ = 0;
+            measurer_.generate_track(objects[next_object_++], ts, arena_);
+        }
+        lag_.record(now_ns - due);
+    }
+
+    std::size_t n = static_cast<std::size_t>(k - sent_);
+    if (n == 0)
+        return 0;
+    datagrams_ += sink.send_batch(arena_.views(), n);
+    sent_ = k;
+    last_send_ns_ = now_ns;
+    return n;
+}
+
+LoadStats LoadGenerator::stats() const {
+    LoadStats s;
+    s.scheduled = scheduled_;
+    s.frames = sent_;
+    s.datagrams = datagrams_;
+    s.elapsed_ns = last_send_ns_ - start_steady_ns_;
+    s.requested_fps = options_.rate_fps;
+    lag_.add_to(s.send_lag_ns);
+    return s;
+}
+
+} // namespace nng
@@ -0,0 +1,77 @@
+#pragma once
+#include "common/histogram.h"
+#include "gateway/frame_source.h"
+#include "sensor_sim/frame_arena.h"
+#include "sensor_sim/measurement_generator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nng {
+
+struct LoadOptions {
+    double rate_fps = 10000.0;   // frames per second asked for
+    double duration_s = 10.0;    // rate_fps * duration_s frames in all
+    std::size_t max_batch = 64;  // frames per send_batch() at most
+    RngMode rng = RngMode::STD;
+};
+
+struct LoadStats {
+    uint64_t scheduled = 0;  // frames on the timeline
+    uint64_t frames = 0;     // frames sent so far
+    uint64_t datagrams = 0;  // datagrams the sink accepted
+    uint64_t elapsed_ns = 0; // timeline start to the last send
+    double requested_fps = 0.0;
+    HistogramSnapshot send_lag_ns; // time sent minus time due, per frame
+
+    double achieved_fps() const {
+        return elapsed_ns ? static_cast<double>(frames) * 1e9 / static_cast<double>(elapsed_ns) : 0.0;
+    }
+};
+
+// Open-loop sender: frame k is due at start + k / rate_fps whether or not
+// frame k - 1 went out on time, and carries that due time (on the wall
+// clock) in header.ts_ns. A slow send path therefore never lowers the
+// offered load or hides its own delay: frames that fall behind are sent
+// as soon as possible, in bursts of up to max_batch, still stamped with
+// when they should have left, so the gateway's sender->receive latency
+// includes the time they waited here (no coordinated omission).
+//
+// Frames are TRACK frames for the objects passed in, round robin, or
+// HEARTBEAT frames when there are none. Single-threaded; times are ns.
+class LoadGenerator {
+public:
+    LoadGenerator(const LoadOptions& options, uint16_t src_id, uint32_t seed = 123);
+
+    // Put the timeline's start at steady_ns, which is wall_ns on the
+    // clock the frames are stamped with
+    void start(uint64_t steady_ns, uint64_t wall_ns);
+
+    // Steady time frame k is due
+    uint64_t due_ns(uint64_t k) const;
+    // When the next unsent frame is due; meaningless once done()
+    uint64_t next_due_ns() const { return due_ns(sent_); }
+    bool done() const { return sent_ >= scheduled_; }
+
+    // Send one batch of the frames due by now_ns (at most max_batch, oldest
+    // first). Returns how many were sent; 0 if none is due yet.
+    std::size_t send_due(const std::vector<WorldObject>& objects, uint64_t now_ns, IFrameSink& sink);
+
+    LoadStats stats() const;
+
+private:
+    LoadOptions options_;
+    MeasurementGenerator measurer_;
+    FrameArena arena_;
+    Histogram lag_;
+    double period_ns_;
+    uint64_t scheduled_;
+    uint64_t start_steady_ns_ = 0;
+    uint64_t start_wall_ns_ = 0;
+    uint64_t sent_ = 0;
+    uint64_t datagrams_ = 0;
+    uint64_t last_send_ns_ = 0;
+    std::size_t next_object_ = 0;
+};
+
+} // namespace nng
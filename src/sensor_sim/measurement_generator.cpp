@@ -2,16 +2,57 @@
 #include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 namespace nng {
 
-MeasurementGenerator::MeasurementGenerator(uint16_t src_id, uint32_t seed)
-    : src_id_(src_id), rng_(seed) {
+MeasurementGenerator::MeasurementGenerator(uint16_t src_id, uint32_t seed, RngMode mode)
+    : src_id_(src_id), mode_(mode), rng_(seed), fast_(seed) {
     std::memset(track_update_counts_, 0, sizeof(track_update_counts_));
 }
 
-std::vector<uint8_t> MeasurementGenerator::build_frame(
-        MsgType type, const uint8_t* payload,
+const MeasurementGenerator::ObjectConstants& MeasurementGenerator::constants(const WorldObject& obj) {
+    // RCS, speed and heading do not change over an object's life, so pow()
+    // and cos() run once per object. The slot is keyed on the inputs
+    // themselves: a reused id or changed value just misses.
+    if (constants_.empty())
+        constants_.assign(65536, ObjectConstants{std::numeric_limits<double>::quiet_NaN(), 0.0, 0.0, 0.0, 0.0});
+    ObjectConstants& c = constants_[obj.id & 0xFFFF];
+    if (!(c.rcs_dbsm == obj.rcs_dbsm)) {
+        c.rcs_dbsm = obj.rcs_dbsm;
+        c.rcs_linear = std::pow(10.0, obj.rcs_dbsm / 10.0);
+    }
+    if (!(c.speed_mps == obj.speed_mps && c.heading_deg == obj.heading_deg)) {
+        c.speed_mps = obj.speed_mps;
+        c.heading_deg = obj.heading_deg;
+        c.closing_mps = -obj.speed_mps * std::cos(obj.heading_deg * 3.14159265 / 180.0);
+    }
+    return c;
+}
+
+const double* MeasurementGenerator::draw_normals(std::size_t n) {
+    if (mode_ != RngMode::FAST)
+        return nullptr;
+    normals_.resize(n);
+    fast_.fill_normal(normals_.data(), n);
+    return normals_.data();
+}
+
+void MeasurementGenerator::track_noise(const double* batch, std::size_t i,
+                                       std::normal_distribution<double>& noise, double z[3]) {
+    if (batch) {
+        z[0] = batch[3 * i];
+        z[1] = batch[3 * i + 1];
+        z[2] = batch[3 * i + 2];
+    } else {
+        z[0] = noise(rng_);
+        z[1] = noise(rng_);
+        z[2] = noise(rng_);
+    }
+}
+
+void MeasurementGenerator::write_frame(
+        uint8_t* dst, MsgType type, const uint8_t* payload,
         uint16_t payload_len, uint64_t timestamp_ns) {
     TelemetryHeader hdr{};
     hdr.version = PROTOCOL_VERSION;
@@ -21,43 +62,146 @@ std::vector<uint8_t> MeasurementGenerator::build_frame(
     hdr.ts_ns = timestamp_ns;
     hdr.payload_len = payload_len;
 
-    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + payload_len);
-    serialize_header(hdr, buf.data());
+    serialize_header(hdr, dst);
     if (payload && payload_len > 0)
-        std::memcpy(buf.data() + FRAME_HEADER_SIZE, payload, payload_len);
+        std::memcpy(dst + FRAME_HEADER_SIZE, payload, payload_len);
+}
 
+std::vector<uint8_t> MeasurementGenerator::build_frame(
+        MsgType type, const uint8_t* payload,
+        uint16_t payload_len, uint64_t timestamp_ns) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + payload_len);
+    write_frame(buf.data(), type, payload, payload_len, timestamp_ns);
     return buf;
 }
 
-std::vector<std::vector<uint8_t>> MeasurementGenerator::generate_plots(
-        const std::vector<WorldObject>& objects, uint64_t timestamp_ns) {
-    std::vector<std::vector<uint8_t>> frames;
-    frames.reserve(objects.size());
-
-    for (const auto& obj : objects) {
-        // Detection probability: p = clamp(rcs_linear / (range_km^2), 0.1, 1.0)
-        double rcs_linear = std::pow(10.0, obj.rcs_dbsm / 10.0);
-        double range_km = obj.range_m / 1000.0;
-        double p_detect = std::clamp(rcs_linear / (range_km * range_km), 0.1, 1.0);
+bool MeasurementGenerator::make_plot(const WorldObject& obj, const double* z, PlotPayload& pp) {
+    // Detection probability: p = clamp(rcs_linear / (range_km^2), 0.1, 1.0)
+    const ObjectConstants& c = constants(obj);
+    double range_km = obj.range_m / 1000.0;
+    double p_detect = std::clamp(c.rcs_linear / (range_km * range_km), 0.1, 1.0);
 
+    double u;
+    if (z) {
+        u = fast_.uniform01();
+    } else {
         std::uniform_real_distribution<double> det_dist(0.0, 1.0);
-        if (det_dist(rng_) > p_detect)
-            continue;
+        u = det_dist(rng_);
+    }
+    if (u > p_detect)
+        return false;
 
-        // Add measurement noise
+    // Add measurement noise: azimuth, elevation, range, amplitude
+    double n[4];
+    if (z) {
+        for (int k = 0; k < 4; ++k)
+            n[k] = z[k] * obj.noise_stddev;
+    } else {
         std::normal_distribution<double> noise(0.0, obj.noise_stddev);
+        for (int k = 0; k < 4; ++k)
+            n[k] = noise(rng_);
+    }
+
+    pp = PlotPayload{};
+    pp.plot_id = plot_id_++;
+    pp.azimuth_mdeg = static_cast<int32_t>((obj.azimuth_deg + n[0] * 0.01) * 1000.0);
+    pp.elevation_mdeg = static_cast<int32_t>((obj.elevation_deg + n[1] * 0.01) * 1000.0);
+    pp.range_m = static_cast<uint32_t>(std::max(0.0, obj.range_m + n[2]));
+    pp.amplitude_db = static_cast<int16_t>(obj.rcs_dbsm * 10.0 + n[3] * 5.0);
+    pp.doppler_mps = static_cast<int16_t>(c.closing_mps);
+    pp.quality = static_cast<uint8_t>(std::clamp(static_cast<int>(p_detect * 100.0), 10, 100));
+    return true;
+}
+
+void MeasurementGenerator::make_track(const WorldObject& obj, const double z[3], TrackPayload& tp) {
+    uint16_t tid_idx = static_cast<uint16_t>(obj.id & 0xFFFF);
+
+    tp = TrackPayload{};
+    tp.track_id = obj.id;
+    tp.classification = static_cast<uint8_t>(obj.classification);
+
+    // Threat level based on hostility and classification
+    if (!obj.is_hostile) {
+        tp.threat_level = static_cast<uint8_t>(ThreatLevel::LOW);
+    } else {
+        switch (obj.classification) {
+            case TrackClass::MISSILE:
+            case TrackClass::ROCKET_ARTILLERY:
+                tp.threat_level = static_cast<uint8_t>(ThreatLevel::CRITICAL);
+                break;
+            case TrackClass::UAV_SMALL:
+            case TrackClass::UAV_LARGE:
+                tp.threat_level = static_cast<uint8_t>(ThreatLevel::HIGH);
+                break;
+            default:
+                tp.threat_level = static_cast<uint8_t>(ThreatLevel::MEDIUM);
+                break;
+        }
+    }
+
+    tp.iff_status = obj.is_hostile
+        ? static_cast<uint8_t>(IffStatus::FOE)
+        : static_cast<uint8_t>(IffStatus::FRIEND);
+
+    tp.azimuth_mdeg = static_cast<int32_t>(obj.azimuth_deg * 1000.0 + z[0] * obj.noise_stddev * 10.0);
+    tp.elevation_mdeg = static_cast<int32_t>(obj.elevation_deg * 1000.0 + z[1] * obj.noise_stddev * 10.0);
+    tp.range_m = static_cast<uint32_t>(std::max(0.0, obj.range_m + z[2] * obj.noise_stddev));
+    tp.velocity_mps = static_cast<int16_t>(constants(obj).closing_mps);
+    tp.rcs_dbsm = static_cast<int16_t>(obj.rcs_dbsm * 100.0);
+    tp.update_count = ++track_update_counts_[tid_idx];
+}
+
+void MeasurementGenerator::make_heartbeat(uint64_t timestamp_ns, HeartbeatPayload& hb) {
+    hb = HeartbeatPayload{};
+    hb.subsystem_id = src_id_;
+    hb.state = static_cast<uint8_t>(SubsystemState::OK);
+    if (mode_ == RngMode::FAST) {
+        hb.cpu_pct = static_cast<uint8_t>(fast_.uniform_int(10, 60));
+        hb.mem_pct = static_cast<uint8_t>(fast_.uniform_int(20, 70));
+    } else {
+        std::uniform_int_distribution<int> cpu_dist(10, 60);
+        std::uniform_int_distribution<int> mem_dist(20, 70);
+        hb.cpu_pct = static_cast<uint8_t>(cpu_dist(rng_));
+        hb.mem_pct = static_cast<uint8_t>(mem_dist(rng_));
+    }
+    hb.uptime_s = static_cast<uint32_t>(timestamp_ns / 1000000000ULL);
+    hb.error_code = 0;
+}
+
+void MeasurementGenerator::set_track_delta(uint32_t keyframe_interval) {
+    if (keyframe_interval == 0)
+        delta_.reset();
+    else
+        delta_ = std::make_unique<TrackDeltaEncoder>(keyframe_interval);
+    delta_len_ = 0;
+}
 
-        PlotPayload pp{};
-        pp.plot_id = plot_id_++;
-        pp.azimuth_mdeg = static_cast<int32_t>((obj.azimuth_deg + noise(rng_) * 0.01) * 1000.0);
-        pp.elevation_mdeg = static_cast<int32_t>((obj.elevation_deg + noise(rng_) * 0.01) * 1000.0);
-        pp.range_m = static_cast<uint32_t>(std::max(0.0, obj.range_m + noise(rng_)));
-        pp.amplitude_db = static_cast<int16_t>(obj.rcs_dbsm * 10.0 + noise(rng_) * 5.0);
-        pp.doppler_mps = static_cast<int16_t>(-obj.speed_mps * std::cos(obj.heading_deg * 3.14159265 / 180.0));
-        pp.quality = static_cast<uint8_t>(std::clamp(static_cast<int>(p_detect * 100.0), 10, 100));
-
-        frames.push_back(build_frame(MsgType::PLOT,
-            reinterpret_cast<const uint8_t*>(&pp), sizeof(PlotPayload), timestamp_ns));
+template <typename Emit>
+void MeasurementGenerator::add_track_delta(const TrackPayload& tp, Emit&& emit) {
+    if (delta_len_ + TRACK_DELTA_MAX_RECORD > sizeof(delta_payload_))
+        flush_track_delta(emit);
+    delta_len_ += delta_->encode(tp, delta_payload_ + delta_len_);
+}
+
+template <typename Emit>
+void MeasurementGenerator::flush_track_delta(Emit&& emit) {
+    if (delta_len_ == 0)
+        return;
+    emit(delta_payload_, static_cast<uint16_t>(delta_len_));
+    delta_len_ = 0;
+}
+
+std::vector<std::vector<uint8_t>> MeasurementGenerator::generate_plots(
+        const std::vector<WorldObject>& objects, uint64_t timestamp_ns) {
+    std::vector<std::vector<uint8_t>> frames;
+    frames.reserve(objects.size());
+
+    const double* z = draw_normals(4 * objects.size());
+    PlotPayload pp;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        if (make_plot(objects[i], z ? z + 4 * i : nullptr, pp))
+            frames.push_back(build_frame(MsgType::PLOT,
+                reinterpret_cast<const uint8_t*>(&pp), sizeof(PlotPayload), timestamp_ns));
     }
     return frames;
 }
@@ -67,67 +211,92 @@ std::vector<std::vector<uint8_t>> MeasurementGenerator::generate_tracks(
     std::vector<std::vector<uint8_t>> frames;
     frames.reserve(objects.size());
 
+    const double* batch = draw_normals(3 * objects.size());
     std::normal_distribution<double> noise(0.0, 1.0);
-
-    for (const auto& obj : objects) {
-        uint16_t tid_idx = static_cast<uint16_t>(obj.id & 0xFFFF);
-
-        TrackPayload tp{};
-        tp.track_id = obj.id;
-        tp.classification = static_cast<uint8_t>(obj.classification);
-
-        // Threat level based on hostility and classification
-        if (!obj.is_hostile) {
-            tp.threat_level = static_cast<uint8_t>(ThreatLevel::LOW);
-        } else {
-            switch (obj.classification) {
-                case TrackClass::MISSILE:
-                case TrackClass::ROCKET_ARTILLERY:
-                    tp.threat_level = static_cast<uint8_t>(ThreatLevel::CRITICAL);
-                    break;
-                case TrackClass::UAV_SMALL:
-                case TrackClass::UAV_LARGE:
-                    tp.threat_level = static_cast<uint8_t>(ThreatLevel::HIGH);
-                    break;
-                default:
-                    tp.threat_level = static_cast<uint8_t>(ThreatLevel::MEDIUM);
-                    break;
-            }
-        }
-
-        tp.iff_status = obj.is_hostile
-            ? static_cast<uint8_t>(IffStatus::FOE)
-            : static_cast<uint8_t>(IffStatus::FRIEND);
-
-        tp.azimuth_mdeg = static_cast<int32_t>(obj.azimuth_deg * 1000.0 + noise(rng_) * obj.noise_stddev * 10.0);
-        tp.elevation_mdeg = static_cast<int32_t>(obj.elevation_deg * 1000.0 + noise(rng_) * obj.noise_stddev * 10.0);
-        tp.range_m = static_cast<uint32_t>(std::max(0.0, obj.range_m + noise(rng_) * obj.noise_stddev));
-        tp.velocity_mps = static_cast<int16_t>(-obj.speed_mps * std::cos(obj.heading_deg * 3.14159265 / 180.0));
-        tp.rcs_dbsm = static_cast<int16_t>(obj.rcs_dbsm * 100.0);
-        tp.update_count = ++track_update_counts_[tid_idx];
-
-        frames.push_back(build_frame(MsgType::TRACK,
-            reinterpret_cast<const uint8_t*>(&tp), sizeof(TrackPayload), timestamp_ns));
+    TrackPayload tp;
+    double z[3];
+    auto emit = [&](const uint8_t* payload, uint16_t len) {
+        frames.push_back(build_frame(MsgType::TRACK_DELTA, payload, len, timestamp_ns));
+    };
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        track_noise(batch, i, noise, z);
+        make_track(objects[i], z, tp);
+        if (delta_)
+            add_track_delta(tp, emit);
+        else
+            frames.push_back(build_frame(MsgType::TRACK,
+                reinterpret_cast<const uint8_t*>(&tp), sizeof(TrackPayload), timestamp_ns));
     }
+    if (delta_)
+        flush_track_delta(emit);
     return frames;
 }
 
 std::vector<uint8_t> MeasurementGenerator::generate_heartbeat(uint64_t timestamp_ns) {
-    std::uniform_int_distribution<int> cpu_dist(10, 60);
-    std::uniform_int_distribution<int> mem_dist(20, 70);
-
-    HeartbeatPayload hb{};
-    hb.subsystem_id = src_id_;
-    hb.state = static_cast<uint8_t>(SubsystemState::OK);
-    hb.cpu_pct = static_cast<uint8_t>(cpu_dist(rng_));
-    hb.mem_pct = static_cast<uint8_t>(mem_dist(rng_));
-    hb.uptime_s = static_cast<uint32_t>(timestamp_ns / 1000000000ULL);
-    hb.error_code = 0;
-
+    HeartbeatPayload hb;
+    make_heartbeat(timestamp_ns, hb);
     return build_frame(MsgType::HEARTBEAT,
         reinterpret_cast<const uint8_t*>(&hb), sizeof(HeartbeatPayload), timestamp_ns);
 }
 
+void MeasurementGenerator::generate_plots(const std::vector<WorldObject>& objects,
+                                          uint64_t timestamp_ns, FrameArena& out) {
+    const double* z = draw_normals(4 * objects.size());
+    PlotPayload pp;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        if (make_plot(objects[i], z ? z + 4 * i : nullptr, pp))
+            append_frame(out, MsgType::PLOT, pp, timestamp_ns);
+    }
+}
+
+void MeasurementGenerator::generate_tracks(const std::vector<WorldObject>& objects,
+                                           uint64_t timestamp_ns, FrameArena& out) {
+    const double* batch = draw_normals(3 * objects.size());
+    std::normal_distribution<double> noise(0.0, 1.0);
+    TrackPayload tp;
+    double z[3];
+    auto emit = [&](const uint8_t* payload, uint16_t len) {
+        write_frame(out.append(FRAME_HEADER_SIZE + len), MsgType::TRACK_DELTA, payload, len,
+                    timestamp_ns);
+    };
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        track_noise(batch, i, noise, z);
+        make_track(objects[i], z, tp);
+        if (delta_)
+            add_track_delta(tp, emit);
+        else
+            append_frame(out, MsgType::TRACK, tp, timestamp_ns);
+    }
+    if (delta_)
+        flush_track_delta(emit);
+}
+
+void MeasurementGenerator::generate_track(const WorldObject& obj, uint64_t timestamp_ns,
+                                          FrameArena& out) {
+    const double* batch = draw_normals(3);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    TrackPayload tp;
+    double z[3];
+    track_noise(batch, 0, noise, z);
+    make_track(obj, z, tp);
+    if (!delta_) {
+        append_frame(out, MsgType::TRACK, tp, timestamp_ns);
+        return;
+    }
+    // One update, one frame: still smaller than a TRACK
+    add_track_delta(tp, [](const uint8_t*, uint16_t) {});
+    flush_track_delta([&](const uint8_t* payload, uint16_t len) {
+        write_frame(out.append(FRAME_HEADER_SIZE + len), MsgType::TRACK_DELTA, payload, len,
+                    timestamp_ns);
+    });
+}
+
+void MeasurementGenerator::generate_heartbeat(uint64_t timestamp_ns, FrameArena& out) {
+    HeartbeatPayload hb;
+    make_heartbeat(timestamp_ns, hb);
+    append_frame(out, MsgType::HEARTBEAT, hb, timestamp_ns);
+}
+
 std::vector<uint8_t> MeasurementGenerator::generate_engagement(
         uint16_t weapon_id, WeaponMode mode, uint32_t assigned_track,
         uint16_t rounds, int16_t barrel_temp, uint16_t bursts,
@@ -1,7 +1,11 @@
 #pragma once
 #include "common/protocol.h"
+#include "common/track_delta.h"
 #include "common/types.h"
 #include "sensor_sim/object_generator.h"
+#include "sensor_sim/fast_rng.h"
+#include "sensor_sim/frame_arena.h"
+#include <memory>
 #include <vector>
 #include <random>
 #include <cstdint>
@@ -10,37 +14,101 @@ namespace nng {
 
 class MeasurementGenerator {
 public:
-    explicit MeasurementGenerator(uint16_t src_id, uint32_t seed = 123);
+    // mode picks the random engine (see RngMode); FAST also draws each
+    // call's noise as one batch of normals
+    explicit MeasurementGenerator(uint16_t src_id, uint32_t seed = 123,
+                                  RngMode mode = RngMode::STD);
 
     // Generate PLOT frames from world objects (raw detections with noise).
     // Objects may not be detected based on RCS/range probability.
     std::vector<std::vector<uint8_t>> generate_plots(
         const std::vector<WorldObject>& objects, uint64_t timestamp_ns);
 
-    // Generate TRACK frames from world objects (associated detections).
+    // Generate TRACK frames from world objects (associated detections), or
+    // with set_track_delta() TRACK_DELTA frames packing as many updates as
+    // a payload holds.
     std::vector<std::vector<uint8_t>> generate_tracks(
         const std::vector<WorldObject>& objects, uint64_t timestamp_ns);
 
     // Generate a HEARTBEAT frame.
     std::vector<uint8_t> generate_heartbeat(uint64_t timestamp_ns);
 
+    // The same frames (same seqs and random draws) appended to an arena
+    // instead of one vector each, for building a whole tick without
+    // allocating
+    void generate_plots(const std::vector<WorldObject>& objects, uint64_t timestamp_ns,
+                        FrameArena& out);
+    void generate_tracks(const std::vector<WorldObject>& objects, uint64_t timestamp_ns,
+                         FrameArena& out);
+    void generate_heartbeat(uint64_t timestamp_ns, FrameArena& out);
+    // One object's TRACK frame
+    void generate_track(const WorldObject& obj, uint64_t timestamp_ns, FrameArena& out);
+
     // Generate an ENGAGEMENT_STATUS frame.
     std::vector<uint8_t> generate_engagement(
         uint16_t weapon_id, WeaponMode mode, uint32_t assigned_track,
         uint16_t rounds, int16_t barrel_temp, uint16_t bursts,
         uint64_t timestamp_ns);
 
+    // Send tracks as TRACK_DELTA records, with a keyframe of each track
+    // every keyframe_interval updates (see TrackDeltaEncoder); 0 goes back
+    // to one TRACK frame per update. Takes effect from the next call.
+    void set_track_delta(uint32_t keyframe_interval);
+    const TrackDeltaEncoder* track_delta() const { return delta_.get(); }
+
     uint32_t seq() const { return seq_; }
+    RngMode rng_mode() const { return mode_; }
 
 private:
     std::vector<uint8_t> build_frame(MsgType type, const uint8_t* payload,
                                       uint16_t payload_len, uint64_t timestamp_ns);
+    // Header (taking the next seq) and payload into dst
+    void write_frame(uint8_t* dst, MsgType type, const uint8_t* payload,
+                     uint16_t payload_len, uint64_t timestamp_ns);
+    template <typename P>
+    void append_frame(FrameArena& out, MsgType type, const P& payload, uint64_t timestamp_ns) {
+        write_frame(out.append(FRAME_HEADER_SIZE + sizeof(P)), type,
+                    reinterpret_cast<const uint8_t*>(&payload), sizeof(P), timestamp_ns);
+    }
+    // Payload for one object; false if the object is not detected. z: the
+    // object's 4 standard normals from draw_normals() (FAST), or null to
+    // draw from rng_
+    bool make_plot(const WorldObject& obj, const double* z, PlotPayload& pp);
+    // z: azimuth, elevation and range noise as standard normals
+    void make_track(const WorldObject& obj, const double z[3], TrackPayload& tp);
+    void make_heartbeat(uint64_t timestamp_ns, HeartbeatPayload& hb);
+    // TRACK_DELTA: add tp's record to the payload being packed, first
+    // handing a payload it would not fit in to emit(payload, len)
+    template <typename Emit> void add_track_delta(const TrackPayload& tp, Emit&& emit);
+    template <typename Emit> void flush_track_delta(Emit&& emit);
+    // FAST: n standard normals in one batch; STD: null
+    const double* draw_normals(std::size_t n);
+    // Object i's track noise, from batch or else from noise
+    void track_noise(const double* batch, std::size_t i,
+                     std::normal_distribution<double>& noise, double z[3]);
+
+    // Per-object values derived from fields that never change
+    struct ObjectConstants {
+        double rcs_dbsm;
+        double rcs_linear;  // 10^(rcs_dbsm / 10)
+        double speed_mps;
+        double heading_deg;
+        double closing_mps; // -speed * cos(heading)
+    };
+    const ObjectConstants& constants(const WorldObject& obj);
 
     uint16_t src_id_;
     uint32_t seq_ = 0;
+    RngMode mode_;
     std::mt19937 rng_;
+    FastRng fast_;
+    std::vector<double> normals_;     // draw_normals() batch, reused
+    std::vector<ObjectConstants> constants_; // by id & 0xFFFF, filled on first use
     uint32_t plot_id_ = 1;
     uint16_t track_update_counts_[65536] = {}; // per track_id update counter
+    std::unique_ptr<TrackDeltaEncoder> delta_; // null: TRACK frames
+    uint8_t delta_payload_[MAX_PAYLOAD_SIZE];  // TRACK_DELTA records being packed
+    std::size_t delta_len_ = 0;
 };
 
 } // namespace nng
@@ -0,0 +1,200 @@
+#include "sensor_sim/scenario_renderer.h"
+#include "sensor_sim/world_model.h"
+#include "gateway/recording_reader.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace nng {
+
+namespace {
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Records every frame it is sent, stamped with the tick being rendered
+class RecordingSink : public IFrameSink {
+public:
+    RecordingSink(FrameRecorder& recorder, const uint64_t& ts_ns)
+        : recorder_(recorder), ts_ns_(ts_ns) {}
+
+    bool send(const std::vector<uint8_t>& buf) override {
+        return recorder_.record(ts_ns_, buf.data(), buf.size());
+    }
+
+    using IFrameSink::send_batch;
+    std::size_t send_batch(const FrameView* frames, std::size_t count) override {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!recorder_.record(ts_ns_, frames[i]))
+                return i;
+        }
+        return count;
+    }
+
+private:
+    FrameRecorder& recorder_;
+    const uint64_t& ts_ns_;
+};
+
+} // anonymous namespace
+
+std::string ScenarioRenderer::part_path(const std::string& path, std::size_t i) {
+    return path + ".part" + std::to_string(i);
+}
+
+bool ScenarioRenderer::render(const std::string& path, std::string* error) {
+    stats_ = RenderStats{};
+    const uint64_t start = steady_ns();
+    const std::size_t sensors = options_.array.sensors;
+    std::string why;
+    if (sensors == 0 || options_.rate_hz <= 0.0) {
+        if (error)
+            *error = "nothing to render";
+        return false;
+    }
+    std::size_t workers = options_.array.threads > 0 ? options_.array.threads : 1;
+    if (workers > sensors)
+        workers = sensors;
+
+    // Worker 0 renders on the calling thread
+    std::vector<SensorArrayStats> slice_stats(workers);
+    std::vector<uint64_t> ticks(workers, 0);
+    std::vector<std::string> errors(workers);
+    std::vector<char> ok(workers, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t w = 1; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            ok[w] = render_slice(w, workers, part_path(path, w), slice_stats[w], ticks[w], errors[w]);
+        });
+    }
+    ok[0] = render_slice(0, workers, part_path(path, 0), slice_stats[0], ticks[0], errors[0]);
+    for (auto& t : threads)
+        t.join();
+
+    bool rendered = true;
+    for (std::size_t w = 0; w < workers; ++w) {
+        if (!ok[w] && rendered) {
+            why = errors[w];
+            rendered = false;
+        }
+        stats_.sensors.merge(slice_stats[w]);
+    }
+    stats_.ticks = ticks[0];
+
+    const uint64_t merge_start = steady_ns();
+    bool merged = rendered && merge(path, workers, why);
+    stats_.merge_ns = steady_ns() - merge_start;
+    for (std::size_t w = 0; w < workers; ++w)
+        std::remove(part_path(path, w).c_str());
+    if (!merged) {
+        std::remove(path.c_str());
+        if (error)
+            *error = why;
+        return false;
+    }
+    stats_.elapsed_ns = steady_ns() - start;
+    return true;
+}
+
+bool ScenarioRenderer::render_slice(std::size_t worker, std::size_t workers,
+                                    const std::string& part, SensorArrayStats& stats,
+                                    uint64_t& ticks, std::string& error) {
+    const std::size_t sensors = options_.array.sensors;
+    SensorArrayOptions slice = options_.array;
+    slice.first_sensor = options_.array.first_sensor + worker * sensors / workers;
+    slice.sensors = (worker + 1) * sensors / workers - worker * sensors / workers;
+    slice.total_sensors = options_.array.total_sensors > 0 ? options_.array.total_sensors
+                                                           : options_.array.first_sensor + sensors;
+    slice.threads = 1;
+
+    // Parts are read back once: no compression, no O_DIRECT
+    FrameRecorder recorder;
+    if (!recorder.open(part)) {
+        error = "cannot write " + part;
+        return false;
+    }
+    uint64_t ts_ns = options_.epoch_ns;
+    SensorArray array(slice);
+    if (!array.start([&](std::size_t) { return std::make_unique<RecordingSink>(recorder, ts_ns); })) {
+        error = "cannot create sensors " + std::to_string(slice.first_sensor) + ".." +
+                std::to_string(slice.first_sensor + slice.sensors - 1);
+        return false;
+    }
+
+    // The same world, tick for tick, as a live run with this seed
+    ObjectGenerator generator(options_.profile, options_.array.seed);
+    WorldModel world;
+    for (auto& obj : generator.generate_initial())
+        world.add_object(obj);
+
+    const double dt = 1.0 / options_.rate_hz;
+    const uint64_t total_ticks = static_cast<uint64_t>(options_.duration_s * options_.rate_hz);
+    uint64_t tick = 0;
+    for (; tick < total_ticks; ++tick) {
+        if (options_.cancel && options_.cancel->load(std::memory_order_relaxed))
+            break;
+        double current_time_s = static_cast<double>(tick) * dt;
+        ts_ns = options_.epoch_ns + static_cast<uint64_t>(current_time_s * 1e9);
+        auto spawned = generator.maybe_spawn(current_time_s);
+        if (spawned)
+            world.add_object(*spawned);
+        world.tick(dt, current_time_s);
+        array.tick(world.objects(), ts_ns, tick);
+    }
+    array.stop();
+    stats = array.stats();
+    ticks = tick;
+    recorder.close();
+    if (recorder.write_errors() > 0) {
+        error = "write to " + part + " failed";
+        return false;
+    }
+    return true;
+}
+
+bool ScenarioRenderer::merge(const std::string& path, std::size_t parts, std::string& error) {
+    std::vector<std::unique_ptr<RecordingReader>> readers;
+    std::vector<RecordedFrame> heads(parts);
+    std::vector<char> live(parts, 0);
+    for (std::size_t i = 0; i < parts; ++i) {
+        readers.push_back(std::make_unique<RecordingReader>());
+        if (!readers[i]->open(part_path(path, i), true)) {
+            error = "cannot read " + part_path(path, i);
+            return false;
+        }
+        readers[i]->set_read_ahead(2);
+        live[i] = readers[i]->next(heads[i]);
+    }
+
+    FrameRecorder out;
+    if (!out.open(path, options_.recorder)) {
+        error = "cannot write " + path;
+        return false;
+    }
+    // A linear pick over the parts (one per worker, so few): earliest
+    // timestamp, lower slice first on a tie, which keeps sensor order
+    while (true) {
+        std::size_t best = parts;
+        for (std::size_t i = 0; i < parts; ++i) {
+            if (live[i] && (best == parts || heads[i].rx_ts_ns < heads[best].rx_ts_ns))
+                best = i;
+        }
+        if (best == parts)
+            break;
+        out.record(heads[best].rx_ts_ns, heads[best].data, heads[best].len);
+        live[best] = readers[best]->next(heads[best]);
+    }
+    out.close();
+    stats_.frames = out.frame_count();
+    if (out.write_errors() > 0 || out.dropped_frames() > 0) {
+        error = "write to " + path + " failed";
+        return false;
+    }
+    return true;
+}
+
+} // namespace nng
@@ -0,0 +1,76 @@
+#pragma once
+#include "sensor_sim/object_generator.h"
+#include "sensor_sim/sensor_array.h"
+#include "gateway/frame_recorder.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nng {
+
+struct RenderOptions {
+    ScenarioProfile profile;
+    double rate_hz = 50.0;      // scenario ticks per second of scenario time
+    double duration_s = 10.0;
+    uint64_t epoch_ns = 0;      // timestamp of tick 0
+    // Sensors, faults, protocol and scanning as for a live run. Its threads
+    // field is the number of render workers (capped at sensors).
+    SensorArrayOptions array;
+    RecorderOptions recorder;   // of the merged output file
+    // Checked between ticks; set to stop early (what is rendered is kept)
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+struct RenderStats {
+    uint64_t ticks = 0;
+    uint64_t frames = 0;       // records in the output file
+    uint64_t elapsed_ns = 0;   // wall time, render and merge
+    uint64_t merge_ns = 0;     // ... of which the merge
+    SensorArrayStats sensors;  // generated, faults applied
+
+    // Scenario seconds rendered per wall second
+    double speedup(double rate_hz) const {
+        return elapsed_ns ? static_cast<double>(ticks) / rate_hz * 1e9 /
+                            static_cast<double>(elapsed_ns)
+                          : 0.0;
+    }
+};
+
+// Renders a scenario offline into a recording (FrameRecorder format),
+// as fast as the CPU allows: the ObjectGenerator / WorldModel /
+// MeasurementGenerator / FaultInjector pipeline of a live sensor_sim run,
+// with no socket and no sleeping. Each frame is recorded with its tick's
+// synthetic timestamp (epoch_ns + tick / rate_hz) as receive time, which
+// is also the timestamp in its header.
+//
+// The sensors are split into contiguous slices, one per worker. Each
+// worker steps its own copy of the world (generator and model are
+// deterministic from the seed, so every copy is the same world), measures
+// it with its slice as a SensorArray slice, and records to a part file
+// next to the output. The parts are then merged by timestamp, slices in
+// sensor order within a tick, so the output is the same frames in the
+// same order whatever the worker count, and equals what the live
+// simulator sends.
+class ScenarioRenderer {
+public:
+    explicit ScenarioRenderer(const RenderOptions& options) : options_(options) {}
+
+    // Render to path; on failure error says why and no output is left
+    bool render(const std::string& path, std::string* error = nullptr);
+
+    const RenderStats& stats() const { return stats_; }
+
+    // Part file of worker i while rendering to path
+    static std::string part_path(const std::string& path, std::size_t i);
+
+private:
+    bool render_slice(std::size_t worker, std::size_t workers, const std::string& part,
+                      SensorArrayStats& stats, uint64_t& ticks, std::string& error);
+    bool merge(const std::string& path, std::size_t parts, std::string& error);
+
+    RenderOptions options_;
+    RenderStats stats_;
+};
+
+} // namespace nng
@@ -0,0 +1,199 @@
+#include "sensor_sim/sensor_array.h"
+#include "common/container.h"
+
+namespace nng {
+
+namespace {
+
+// Seeds of sensor k. Sensor 0 keeps the single-sensor seeds (seed + 100,
+// seed + 200); the others are spaced well apart from them.
+constexpr uint32_t SENSOR_SEED_STRIDE = 1000003;
+
+void add_faults(SensorArrayStats& stats, const FaultInjector::FaultStats& faults) {
+    stats.dropped += faults.dropped;
+    stats.reordered += faults.reordered;
+    stats.duplicated += faults.duplicated;
+    stats.corrupted += faults.corrupted;
+}
+
+} // anonymous namespace
+
+void SensorArrayStats::merge(const SensorArrayStats& o) {
+    frames += o.frames;
+    datagrams += o.datagrams;
+    dropped += o.dropped;
+    reordered += o.reordered;
+    duplicated += o.duplicated;
+    corrupted += o.corrupted;
+    painted += o.painted;
+}
+
+SensorArray::Sensor::Sensor(uint16_t src_id, uint32_t seed, const FaultConfig& faults,
+                            RngMode rng, const BeamOptions& beam)
+    : measurer(src_id, seed + 100, rng), injector(faults, seed + 200, rng), beam(beam) {}
+
+SensorArray::SensorArray(const SensorArrayOptions& options)
+    : options_(options), index_(1.0, options.max_range_m) {}
+
+SensorArray::~SensorArray() {
+    stop();
+}
+
+bool SensorArray::start(const SinkFactory& make_sink) {
+    stop();
+    sensors_.clear();
+    threads_.clear();
+    const std::size_t total = options_.total_sensors > 0 ? options_.total_sensors
+                                                         : options_.first_sensor + options_.sensors;
+    if (options_.sensors == 0 || options_.first_sensor + options_.sensors > total ||
+        options_.first_src_id + options_.first_sensor + (options_.sensors - 1) > UINT16_MAX)
+        return false;
+
+    std::size_t thread_count = options_.threads > 0 ? options_.threads : 1;
+    if (thread_count > options_.sensors)
+        thread_count = options_.sensors;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        auto thread = std::make_unique<Thread>();
+        thread->sink = make_sink(t);
+        if (!thread->sink) {
+            threads_.clear();
+            return false;
+        }
+        threads_.push_back(std::move(thread));
+    }
+    for (std::size_t k = 0; k < options_.sensors; ++k) {
+        const std::size_t global = options_.first_sensor + k;
+        uint32_t seed = options_.seed + static_cast<uint32_t>(global) * SENSOR_SEED_STRIDE;
+        // Beams spread evenly, so the sensors do not paint in lockstep
+        BeamOptions beam = options_.beam;
+        beam.start_deg += 360.0 * static_cast<double>(global) / static_cast<double>(total);
+        sensors_.push_back(std::make_unique<Sensor>(src_id(k), seed, options_.faults, options_.rng, beam));
+        sensors_.back()->measurer.set_track_delta(options_.track_delta_keyframes);
+        threads_[k % thread_count]->sensors.push_back(sensors_.back().get());
+    }
+
+    const FaultConfig& f = options_.faults;
+    faulty_ = f.loss_pct > 0.0 || f.reorder_pct > 0.0 || f.duplicate_pct > 0.0 || f.corrupt_pct > 0.0;
+    stopping_ = false;
+    generation_ = 0;
+    for (std::size_t t = 1; t < threads_.size(); ++t)
+        threads_[t]->worker = std::thread(&SensorArray::worker_loop, this, std::ref(*threads_[t]));
+    return true;
+}
+
+void SensorArray::tick(const std::vector<WorldObject>& objects, uint64_t timestamp_ns,
+                       uint64_t tick_no) {
+    if (threads_.empty())
+        return;
+    // Workers are all idle until generation_ moves
+    if (options_.scan)
+        index_.build(objects);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        objects_ = &objects;
+        timestamp_ns_ = timestamp_ns;
+        tick_no_ = tick_no;
+        pending_ = threads_.size() - 1;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    run_tick(*threads_[0]);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    objects_ = nullptr;
+}
+
+void SensorArray::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& t : threads_) {
+        if (t->worker.joinable())
+            t->worker.join();
+    }
+}
+
+SensorArrayStats SensorArray::stats() const {
+    SensorArrayStats total;
+    for (const auto& t : threads_)
+        total.merge(t->stats);
+    return total;
+}
+
+void SensorArray::worker_loop(Thread& t) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+            if (stopping_)
+                return;
+            seen = generation_;
+        }
+        run_tick(t);
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last = --pending_ == 0;
+        }
+        if (last)
+            done_cv_.notify_one();
+    }
+}
+
+void SensorArray::run_tick(Thread& t) {
+    // Read under no lock: tick() does not touch these until every thread is done
+    const std::vector<WorldObject>& objects = *objects_;
+    const uint64_t ts = timestamp_ns_;
+    const bool heartbeat = options_.heartbeat_ticks > 0 && tick_no_ % options_.heartbeat_ticks == 0;
+
+    for (Sensor* s : t.sensors) {
+        const std::vector<WorldObject>* seen = &objects;
+        if (options_.scan) {
+            s->beam.advance(options_.tick_s);
+            s->beam.select(index_, objects, t.painted);
+            t.stats.painted += t.painted.size();
+            seen = &t.painted;
+        }
+
+        // The tick is built in the thread's arena: no allocation per frame
+        t.arena.clear();
+        s->measurer.generate_tracks(*seen, ts, t.arena);
+        s->measurer.generate_plots(*seen, ts, t.arena);
+        if (heartbeat)
+            s->measurer.generate_heartbeat(ts, t.arena);
+        t.stats.frames += t.arena.size();
+
+        if (!options_.v2) {
+            if (!faulty_) {
+                t.stats.datagrams += t.sink->send_batch(t.arena.views(), t.arena.size());
+            } else {
+                // Faults only reorder the views; lost and corrupted frames
+                // are handled without moving any payload
+                s->injector.apply(t.arena, t.sends);
+                add_faults(t.stats, s->injector.last_stats());
+                t.stats.datagrams += t.sink->send_batch(t.sends.data(), t.sends.size());
+            }
+            continue;
+        }
+
+        // v2: many frames per datagram, one CRC each; faults then hit
+        // whole datagrams, as on the wire
+        ContainerBuilder builder;
+        for (std::size_t i = 0; i < t.arena.size(); ++i)
+            builder.add(t.arena.data(i), t.arena.length(i));
+        builder.flush();
+        t.frames = builder.take();
+
+        s->injector.apply(t.frames);
+        add_faults(t.stats, s->injector.last_stats());
+
+        t.stats.datagrams += t.sink->send_batch(t.frames);
+    }
+}
+
+} // namespace nng
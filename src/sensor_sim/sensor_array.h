@@ -0,0 +1,139 @@
+#pragma once
+#include "sensor_sim/beam_scanner.h"
+#include "sensor_sim/fault_injector.h"
+#include "sensor_sim/measurement_generator.h"
+#include "sensor_sim/object_generator.h"
+#include "gateway/frame_source.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nng {
+
+struct SensorArrayOptions {
+    std::size_t sensors = 1;
+    std::size_t threads = 1;     // each with its own sink; capped at sensors
+    uint16_t first_src_id = 1;   // sensor k sends as first_src_id + k
+    // A slice of a larger array (e.g. one render worker's share): this
+    // array's sensors are first_sensor.. of total_sensors (0: sensors), and
+    // their src_ids, seeds and beam offsets are those of the whole array
+    std::size_t first_sensor = 0;
+    std::size_t total_sensors = 0;
+    uint32_t seed = 42;
+    FaultConfig faults;
+    bool v2 = false;             // pack each sensor's tick into v2 containers
+    uint32_t heartbeat_ticks = 50; // a heartbeat every this many ticks (0: none)
+    RngMode rng = RngMode::STD;  // engine of every sensor's generator and injector
+    // Tracks as TRACK_DELTA frames with a keyframe every this many updates
+    // of a track (0: a TRACK frame per update)
+    uint32_t track_delta_keyframes = 0;
+
+    // Scanning: each sensor only measures what its rotating beam paints on
+    // the tick (see BeamScanner); otherwise every object, every tick
+    bool scan = false;
+    BeamOptions beam;            // sensor k starts at beam.start_deg + k * 360 / sensors
+    double tick_s = 0.02;        // beam advance per tick
+    double max_range_m = 0.0;    // objects further away are never painted (0: no limit)
+};
+
+// Send counters, summed over sensors
+struct SensorArrayStats {
+    uint64_t frames = 0;    // frames generated (before faults)
+    uint64_t datagrams = 0; // datagrams the sinks accepted
+    uint64_t dropped = 0;
+    uint64_t reordered = 0;
+    uint64_t duplicated = 0;
+    uint64_t corrupted = 0;
+    uint64_t painted = 0;   // objects measured in scan mode, summed over sensors
+
+    void merge(const SensorArrayStats& o);
+};
+
+// Several simulated radars looking at one world. Each sensor has its own
+// MeasurementGenerator (so its own src_id and sequence space), its own
+// FaultInjector, and seeds derived from the run seed and its index only,
+// so what a sensor sends does not depend on the thread count. Sensor 0
+// uses the seeds a single-sensor run always has.
+//
+// Sensors are split over the threads (sensor k on thread k % threads).
+// tick() hands every thread the same read-only world snapshot and returns
+// once all of them have measured it and sent the results through their
+// own sink; thread 0's share runs on the calling thread.
+class SensorArray {
+public:
+    using SinkFactory = std::function<std::unique_ptr<IFrameSink>(std::size_t thread)>;
+
+    explicit SensorArray(const SensorArrayOptions& options = {});
+    ~SensorArray();
+
+    SensorArray(const SensorArray&) = delete;
+    SensorArray& operator=(const SensorArray&) = delete;
+
+    // Create the sensors and a sink per thread and start the workers.
+    // False if there are no sensors, their src_ids would not fit in 16
+    // bits, or a sink could not be created.
+    bool start(const SinkFactory& make_sink);
+
+    // Measure objects at timestamp_ns on every sensor and send. objects
+    // must not change until this returns.
+    void tick(const std::vector<WorldObject>& objects, uint64_t timestamp_ns, uint64_t tick_no);
+
+    // Join the workers (also done by the destructor)
+    void stop();
+
+    std::size_t sensors() const { return sensors_.size(); }
+    std::size_t threads() const { return threads_.size(); }
+    uint16_t src_id(std::size_t sensor) const {
+        return static_cast<uint16_t>(options_.first_src_id + options_.first_sensor + sensor);
+    }
+    SensorArrayStats stats() const;
+
+private:
+    struct Sensor {
+        Sensor(uint16_t src_id, uint32_t seed, const FaultConfig& faults, RngMode rng,
+               const BeamOptions& beam);
+
+        MeasurementGenerator measurer;
+        FaultInjector injector;
+        BeamScanner beam;
+    };
+
+    struct Thread {
+        std::unique_ptr<IFrameSink> sink;
+        std::vector<Sensor*> sensors;
+        std::vector<WorldObject> painted;         // scan mode: one sensor's beam
+        FrameArena arena;                         // one sensor's tick, reused
+        std::vector<FrameView> sends;             // ... in send order, after faults
+        std::vector<std::vector<uint8_t>> frames; // v2 containers
+        SensorArrayStats stats;
+        std::thread worker;
+    };
+
+    void run_tick(Thread& t);
+    void worker_loop(Thread& t);
+
+    SensorArrayOptions options_;
+    bool faulty_ = false; // any fault configured: frames go through the injector
+    std::vector<std::unique_ptr<Sensor>> sensors_;
+    std::vector<std::unique_ptr<Thread>> threads_;
+
+    // The tick being run: written under mutex_ before generation_ moves
+    const std::vector<WorldObject>* objects_ = nullptr;
+    uint64_t timestamp_ns_ = 0;
+    uint64_t tick_no_ = 0;
+    AzimuthIndex index_; // scan mode: objects_ by azimuth, built by tick()
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    std::size_t pending_ = 0; // workers still on this tick
+    bool stopping_ = false;
+};
+
+} // namespace nng
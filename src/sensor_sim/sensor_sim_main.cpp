@@ -1,11 +1,14 @@
 #include "sensor_sim/object_generator.h"
 #include "sensor_sim/world_model.h"
-#include "sensor_sim/measurement_generator.h"
-#include "sensor_sim/fault_injector.h"
+#include "sensor_sim/sensor_array.h"
+#include "sensor_sim/load_generator.h"
 #include "sensor_sim/scenario_loader.h"
+#include "sensor_sim/scenario_renderer.h"
 #include "gateway/udp_socket.h"
+#include "gateway/shm_ring.h"
 #include "common/logger.h"
 #include <iostream>
+#include <memory>
 #include <string>
 #include <chrono>
 #include <thread>
@@ -32,9 +35,91 @@ void print_usage(const char* prog) {
               << "  --reorder <pct>     Reorder percentage (default: 0)\n"
               << "  --duplicate <pct>   Duplicate percentage (default: 0)\n"
               << "  --corrupt <pct>     Corruption percentage (default: 0)\n"
+              << "  --wall-clock        Stamp frames with wall-clock time (gateway wire latency)\n"
+              << "  --gso               Send equal-size frames with UDP GSO\n"
+              << "  --shm <name>        Send through the gateway's shared-memory ring (--rx shm), not UDP\n"
+              << "  --v2                Pack each tick's frames into protocol v2 containers\n"
+              << "  --track-delta <n>   Send tracks as TRACK_DELTA, a keyframe every n updates\n"
+              << "  --sensors <n>       Radars watching the same world, src_id 1..n (default: 1)\n"
+              << "  --threads <n>       Sender threads, each with its own socket (default: 1)\n"
+              << "  --scan-rpm <rpm>    Rotating beam: measure only what it paints each tick\n"
+              << "  --beam-width <deg>  Beam width with --scan-rpm (default: 3)\n"
+              << "  --max-range <m>     With --scan-rpm, objects further away are not seen\n"
+              << "  --fast-rng          xoshiro256++ engine: faster, its own reproducible stream\n"
+              << "  --load <fps>        Open-loop load: send fps frames/s on a fixed timeline,\n"
+              << "                      stamped with their due wall-clock time (one sensor)\n"
+              << "  --batch <n>         Most frames per send in --load mode (default: 64)\n"
+              << "  --render <out.bin>  Render the run into a recording as fast as possible,\n"
+              << "                      sensors split over --threads workers (nothing is sent)\n"
               << "  --help              Show this help\n";
 }
 
+static uint64_t steady_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static uint64_t wall_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// --load: the world still moves at rate_hz, but frames leave on the load
+// generator's timeline instead of once per tick
+static int run_load(nng::ObjectGenerator& generator, nng::WorldModel& world,
+                    nng::IFrameSink& sink, const nng::LoadOptions& options,
+                    double rate_hz, uint32_t seed) {
+    nng::LoadGenerator load(options, 1, seed + 100);
+    const double dt = 1.0 / rate_hz;
+    const uint64_t tick_ns = static_cast<uint64_t>(dt * 1e9);
+
+    uint64_t start = steady_now_ns();
+    load.start(start, wall_now_ns());
+    uint64_t next_tick = start + tick_ns;
+    uint64_t next_progress = start + 1000000000ULL;
+    int tick = 0;
+
+    while (!load.done() && !g_shutdown.load()) {
+        uint64_t now = steady_now_ns();
+        while (next_tick <= now) {
+            double current_time_s = ++tick * dt;
+            auto spawned = generator.maybe_spawn(current_time_s);
+            if (spawned)
+                world.add_object(*spawned);
+            world.step(dt, current_time_s);
+            next_tick += tick_ns;
+        }
+        if (now >= next_progress) {
+            auto s = load.stats();
+            std::cout << "Progress: " << s.frames << "/" << s.scheduled << " frames\r" << std::flush;
+            next_progress += 1000000000ULL;
+        }
+
+        // Behind schedule: keep sending, never wait
+        if (load.send_due(world.objects(), now, sink) > 0)
+            continue;
+
+        uint64_t wake = load.next_due_ns() < next_tick ? load.next_due_ns() : next_tick;
+        if (wake > now)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wake - now));
+    }
+
+    auto s = load.stats();
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::cout << "\n\n=== Load Summary ===\n"
+              << "Frames sent:     " << s.frames << " of " << s.scheduled << "\n"
+              << "Datagrams sent:  " << s.datagrams << "\n"
+              << "Duration:        " << s.elapsed_ns / 1000000 << " ms\n"
+              << "Requested rate:  " << s.requested_fps << " frames/sec\n"
+              << "Achieved rate:   " << s.achieved_fps() << " frames/sec\n"
+              << "Send lag (us):   p50=" << us(s.send_lag_ns.percentile(0.50))
+              << " p99=" << us(s.send_lag_ns.percentile(0.99))
+              << " p99.9=" << us(s.send_lag_ns.percentile(0.999))
+              << " max=" << us(s.send_lag_ns.max) << "\n"
+              << "End-to-end latency: see the gateway's Sender->receive percentiles\n";
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     std::string profile_name = "patrol";
     std::string profile_file;
@@ -47,6 +132,20 @@ int main(int argc, char* argv[]) {
     double reorder_pct = 0.0;
     double duplicate_pct = 0.0;
     double corrupt_pct = 0.0;
+    bool wall_clock = false;
+    bool gso = false;
+    std::string shm_name; // non-empty: shared-memory ring instead of UDP
+    bool v2 = false;
+    uint32_t track_delta = 0;
+    std::size_t sensors = 1;
+    std::size_t threads = 1;
+    double load_fps = 0.0;
+    std::size_t load_batch = 64;
+    bool fast_rng = false;
+    double scan_rpm = 0.0;
+    double beam_width_deg = 3.0;
+    double max_range_m = 0.0;
+    std::string render_path;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -72,6 +171,34 @@ int main(int argc, char* argv[]) {
             duplicate_pct = std::stod(argv[++i]);
         } else if (arg == "--corrupt" && i + 1 < argc) {
             corrupt_pct = std::stod(argv[++i]);
+        } else if (arg == "--wall-clock") {
+            wall_clock = true;
+        } else if (arg == "--gso") {
+            gso = true;
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (arg == "--v2") {
+            v2 = true;
+        } else if (arg == "--track-delta" && i + 1 < argc) {
+            track_delta = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--sensors" && i + 1 < argc) {
+            sensors = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--scan-rpm" && i + 1 < argc) {
+            scan_rpm = std::stod(argv[++i]);
+        } else if (arg == "--beam-width" && i + 1 < argc) {
+            beam_width_deg = std::stod(argv[++i]);
+        } else if (arg == "--max-range" && i + 1 < argc) {
+            max_range_m = std::stod(argv[++i]);
+        } else if (arg == "--fast-rng") {
+            fast_rng = true;
+        } else if (arg == "--load" && i + 1 < argc) {
+            load_fps = std::stod(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            load_batch = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--render" && i + 1 < argc) {
+            render_path = argv[++i];
         } else if (arg == "--help") {
             print_usage(argv[0]);
             return 0;
@@ -82,6 +209,17 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (load_fps > 0.0 && (sensors > 1 || threads > 1 || v2 || track_delta > 0 || loss_pct > 0.0 ||
+                           reorder_pct > 0.0 || duplicate_pct > 0.0 || corrupt_pct > 0.0)) {
+        std::cerr << "--load sends TRACK frames as one v1 sensor without faults\n";
+        return 1;
+    }
+
+    if (!render_path.empty() && (load_fps > 0.0 || !shm_name.empty())) {
+        std::cerr << "--render writes a file: it cannot be combined with --load or --shm\n";
+        return 1;
+    }
+
     // Set up signal handler
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
@@ -108,31 +246,117 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    const std::string target = !render_path.empty() ? "render to " + render_path
+                             : shm_name.empty()     ? host + ":" + std::to_string(port)
+                                                    : "shared-memory ring " + shm_name;
     std::cout << "=== Sensor Simulator ===\n"
               << "Profile:   " << profile.name << "\n"
-              << "Target:    " << host << ":" << port << "\n"
+              << "Target:    " << target << "\n"
               << "Rate:      " << rate_hz << " Hz\n"
               << "Duration:  " << duration_s << " s\n"
               << "Seed:      " << seed << "\n"
               << "Faults:    loss=" << loss_pct << "% reorder=" << reorder_pct
-              << "% dup=" << duplicate_pct << "% corrupt=" << corrupt_pct << "%\n\n";
+              << "% dup=" << duplicate_pct << "% corrupt=" << corrupt_pct << "%\n"
+              << "Protocol:  " << (v2 ? "v2 (containers)" : "v1")
+              << (track_delta > 0 ? ", TRACK_DELTA" : "") << "\n"
+              << "RNG:       " << (fast_rng ? "fast (xoshiro256++)" : "std (mt19937)") << "\n"
+              << "Sensors:   " << sensors << " on " << threads << " thread(s)\n";
+    if (scan_rpm > 0.0)
+        std::cout << "Scan:      " << scan_rpm << " rpm, " << beam_width_deg << " deg beam\n";
+    std::cout << "\n";
+
+    auto array_options_for = [&] {
+        nng::SensorArrayOptions o;
+        o.sensors = sensors;
+        o.threads = threads;
+        o.seed = seed;
+        o.faults.loss_pct = loss_pct;
+        o.faults.reorder_pct = reorder_pct;
+        o.faults.duplicate_pct = duplicate_pct;
+        o.faults.corrupt_pct = corrupt_pct;
+        o.v2 = v2;
+        o.track_delta_keyframes = track_delta;
+        o.rng = fast_rng ? nng::RngMode::FAST : nng::RngMode::STD;
+        o.scan = scan_rpm > 0.0;
+        o.beam.rpm = scan_rpm;
+        o.beam.width_deg = beam_width_deg;
+        o.tick_s = 1.0 / rate_hz;
+        o.max_range_m = max_range_m;
+        return o;
+    };
+
+    if (!render_path.empty()) {
+        nng::RenderOptions render;
+        render.profile = profile;
+        render.rate_hz = rate_hz;
+        render.duration_s = duration_s;
+        render.epoch_ns = wall_clock ? wall_now_ns() : 0;
+        render.array = array_options_for();
+        render.cancel = &g_shutdown;
+        nng::ScenarioRenderer renderer(render);
+        std::string error;
+        if (!renderer.render(render_path, &error)) {
+            std::cerr << "Render failed: " << error << "\n";
+            return 1;
+        }
+        const nng::RenderStats& r = renderer.stats();
+        std::cout << "=== Render Summary ===\n"
+                  << "Ticks:           " << r.ticks << " (" << static_cast<double>(r.ticks) / rate_hz
+                  << " s of scenario)\n"
+                  << "Frames recorded: " << r.frames << "\n"
+                  << "Frames dropped:  " << r.sensors.dropped << "\n"
+                  << "Frames reordered:" << r.sensors.reordered << "\n"
+                  << "Frames duped:    " << r.sensors.duplicated << "\n"
+                  << "Frames corrupted:" << r.sensors.corrupted << "\n"
+                  << "Duration:        " << r.elapsed_ns / 1000000 << " ms (merge "
+                  << r.merge_ns / 1000000 << " ms)\n"
+                  << "Speed:           " << r.speedup(rate_hz) << "x real time\n";
+        return 0;
+    }
 
     // Create components
     nng::ObjectGenerator generator(profile, seed);
     nng::WorldModel world;
-    nng::MeasurementGenerator measurer(1, seed + 100);
-
-    nng::FaultConfig fault_config;
-    fault_config.loss_pct = loss_pct;
-    fault_config.reorder_pct = reorder_pct;
-    fault_config.duplicate_pct = duplicate_pct;
-    fault_config.corrupt_pct = corrupt_pct;
-    nng::FaultInjector injector(fault_config, seed + 200);
-
-    // Connect to gateway
-    nng::UdpFrameSink sink;
-    if (!sink.connect(host, port)) {
-        std::cerr << "Failed to connect to " << host << ":" << port << "\n";
+
+    // One sink per sender thread: a UDP socket, or a place on the shared ring
+    auto make_sink = [&](std::size_t) -> std::unique_ptr<nng::IFrameSink> {
+        if (!shm_name.empty()) {
+            auto sink = std::make_unique<nng::ShmFrameSink>();
+            if (!sink->connect(shm_name))
+                return nullptr;
+            return sink;
+        }
+        auto sink = std::make_unique<nng::UdpFrameSink>();
+        if (!sink->connect(host, port))
+            return nullptr;
+        sink->set_gso(gso);
+        return sink;
+    };
+
+    if (load_fps > 0.0) {
+        std::unique_ptr<nng::IFrameSink> sink = make_sink(0);
+        if (!sink) {
+            std::cerr << "Failed to connect to " << target << "\n";
+            return 1;
+        }
+        for (auto& obj : generator.generate_initial())
+            world.add_object(obj);
+        std::cout << "Initial objects: " << world.active_count() << "\n"
+                  << "Open-loop load:  " << load_fps << " frames/s, batches of up to "
+                  << load_batch << "\n";
+        nng::LoadOptions load_options;
+        load_options.rate_fps = load_fps;
+        load_options.duration_s = duration_s;
+        load_options.max_batch = load_batch;
+        load_options.rng = fast_rng ? nng::RngMode::FAST : nng::RngMode::STD;
+        return run_load(generator, world, *sink, load_options, rate_hz, seed);
+    }
+
+    nng::SensorArray array(array_options_for());
+
+    bool started = array.start(make_sink);
+    if (!started) {
+        std::cerr << "Failed to start " << sensors << " sensor(s) sending to " << target << "\n";
         return 1;
     }
 
@@ -149,18 +373,19 @@ int main(int argc, char* argv[]) {
     const int total_ticks = static_cast<int>(duration_s * rate_hz);
     int tick = 0;
 
-    uint64_t frames_sent = 0;
-    uint64_t frames_dropped = 0;
-    uint64_t frames_reordered = 0;
-    uint64_t frames_duplicated = 0;
-    uint64_t frames_corrupted = 0;
-
     auto start_time = std::chrono::steady_clock::now();
     auto next_tick_time = start_time;
 
+    // Scenario time is relative to the start unless stamping wall-clock time
+    uint64_t epoch_base_ns = 0;
+    if (wall_clock) {
+        epoch_base_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
     while (tick < total_ticks && !g_shutdown.load()) {
         double current_time_s = tick * dt;
-        uint64_t timestamp_ns = static_cast<uint64_t>(current_time_s * 1e9);
+        uint64_t timestamp_ns = epoch_base_ns + static_cast<uint64_t>(current_time_s * 1e9);
 
         // Maybe spawn new object
         auto spawned = generator.maybe_spawn(current_time_s);
@@ -168,39 +393,9 @@ int main(int argc, char* argv[]) {
             world.add_object(*spawned);
         }
 
-        // Tick world
+        // Tick world; every sensor measures the same snapshot
         world.tick(dt, current_time_s);
-
-        // Generate frames
-        auto tracks = measurer.generate_tracks(world.objects(), timestamp_ns);
-        auto plots = measurer.generate_plots(world.objects(), timestamp_ns);
-
-        // Combine frames
-        std::vector<std::vector<uint8_t>> frames;
-        frames.insert(frames.end(), tracks.begin(), tracks.end());
-        frames.insert(frames.end(), plots.begin(), plots.end());
-
-        // Generate heartbeat every 50 ticks
-        if (tick % 50 == 0) {
-            auto hb = measurer.generate_heartbeat(timestamp_ns);
-            frames.push_back(hb);
-        }
-
-        // Apply faults
-        injector.apply(frames);
-
-        auto fault_stats = injector.last_stats();
-        frames_dropped += fault_stats.dropped;
-        frames_reordered += fault_stats.reordered;
-        frames_duplicated += fault_stats.duplicated;
-        frames_corrupted += fault_stats.corrupted;
-
-        // Send frames
-        for (const auto& frame : frames) {
-            if (sink.send(frame)) {
-                frames_sent++;
-            }
-        }
+        array.tick(world.objects(), timestamp_ns, static_cast<uint64_t>(tick));
 
         tick++;
 
@@ -215,23 +410,29 @@ int main(int argc, char* argv[]) {
         // Progress update every second
         if (tick % static_cast<int>(rate_hz) == 0) {
             std::cout << "Progress: " << tick << "/" << total_ticks
-                      << " ticks, " << frames_sent << " frames sent\r" << std::flush;
+                      << " ticks, " << array.stats().frames << " frames sent\r" << std::flush;
         }
     }
 
     auto end_time = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
-    sink.close();
+    array.stop();
+    nng::SensorArrayStats totals = array.stats();
+    // In v2 mode fault counters are per datagram, frames_sent per frame
+    uint64_t frames_sent = v2 ? totals.frames : totals.datagrams;
 
     std::cout << "\n\n=== Summary ===\n"
               << "Ticks:           " << tick << "\n"
               << "Frames sent:     " << frames_sent << "\n"
-              << "Frames dropped:  " << frames_dropped << "\n"
-              << "Frames reordered:" << frames_reordered << "\n"
-              << "Frames duped:    " << frames_duplicated << "\n"
-              << "Frames corrupted:" << frames_corrupted << "\n"
-              << "Duration:        " << elapsed.count() << " ms\n";
+              << "Datagrams sent:  " << totals.datagrams << "\n"
+              << "Frames dropped:  " << totals.dropped << "\n"
+              << "Frames reordered:" << totals.reordered << "\n"
+              << "Frames duped:    " << totals.duplicated << "\n"
+              << "Frames corrupted:" << totals.corrupted << "\n";
+    if (scan_rpm > 0.0)
+        std::cout << "Objects painted: " << totals.painted << "\n";
+    std::cout << "Duration:        " << elapsed.count() << " ms\n";
 
     if (elapsed.count() > 0) {
         double rate = static_cast<double>(frames_sent) * 1000.0 / elapsed.count();
@@ -1,54 +1,157 @@
 #include "sensor_sim/world_model.h"
 #include <cmath>
-#include <algorithm>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace nng {
 
 static constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
 static constexpr double RAD_TO_DEG = 180.0 / 3.14159265358979323846;
-static constexpr double MIN_RANGE_M = 50.0;
+
+// x wrapped into [0, 360) without a loop: x - 360 * floor(x / 360),
+// floor from a truncating int conversion, then two selects for rounding
+// of x / 360 at the edges. The SIMD path below computes the same thing.
+static inline double wrap_360(double x) {
+    double q = x * (1.0 / 360.0);
+    double t = static_cast<double>(static_cast<int32_t>(q));
+    t -= t > q ? 1.0 : 0.0;
+    double r = x - 360.0 * t;
+    r += r < 0.0 ? 360.0 : 0.0;
+    r -= r >= 360.0 ? 360.0 : 0.0;
+    return r;
+}
+
+// Advance object i (the scalar tail of step())
+static inline void step_one(double* range, double* az, const double* radial,
+                            const double* tangential, std::size_t i, double dt) {
+    // Radial component changes range, tangential changes azimuth
+    double r = range[i] + radial[i] * dt;
+    range[i] = r;
+    // Too close for a bearing change (and about to be dropped)
+    if (r > WorldModel::MIN_RANGE_M)
+        az[i] = wrap_360(az[i] + tangential[i] * dt / r * RAD_TO_DEG);
+}
+
+#if defined(__SSE2__)
+static inline __m128d select_pd(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+static inline __m128d wrap_360_pd(__m128d x) {
+    const __m128d full = _mm_set1_pd(360.0);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    __m128d q = _mm_mul_pd(x, _mm_set1_pd(1.0 / 360.0));
+    __m128d t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(q));
+    t = _mm_sub_pd(t, _mm_and_pd(_mm_cmpgt_pd(t, q), one));
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(full, t));
+    r = _mm_add_pd(r, _mm_and_pd(_mm_cmplt_pd(r, zero), full));
+    r = _mm_sub_pd(r, _mm_and_pd(_mm_cmpge_pd(r, full), full));
+    return r;
+}
+
+// Two objects per step. Every lane computes the bearing change and the
+// mask keeps the old azimuth where range <= MIN_RANGE_M (a divisor
+// clamped to MIN_RANGE_M keeps those lanes finite).
+static std::size_t step_sse2(double* range, double* az, const double* radial,
+                             const double* tangential, std::size_t n, double dt) {
+    const __m128d vdt = _mm_set1_pd(dt);
+    const __m128d min_range = _mm_set1_pd(WorldModel::MIN_RANGE_M);
+    const __m128d to_deg = _mm_set1_pd(RAD_TO_DEG);
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d r = _mm_add_pd(_mm_loadu_pd(range + i), _mm_mul_pd(_mm_loadu_pd(radial + i), vdt));
+        _mm_storeu_pd(range + i, r);
+        __m128d a = _mm_loadu_pd(az + i);
+        __m128d d = _mm_div_pd(_mm_mul_pd(_mm_loadu_pd(tangential + i), vdt), _mm_max_pd(r, min_range));
+        __m128d moved = wrap_360_pd(_mm_add_pd(a, _mm_mul_pd(d, to_deg)));
+        _mm_storeu_pd(az + i, select_pd(_mm_cmpgt_pd(r, min_range), moved, a));
+    }
+    return i;
+}
+#endif
 
 void WorldModel::add_object(WorldObject obj) {
+    double heading_rad = obj.heading_deg * DEG_TO_RAD;
+    kin_.range_m.push_back(obj.range_m);
+    kin_.azimuth_deg.push_back(obj.azimuth_deg);
+    kin_.radial_mps.push_back(obj.speed_mps * std::cos(heading_rad));
+    kin_.tangential_mps.push_back(obj.speed_mps * std::sin(heading_rad));
+    kin_.expires_s.push_back(obj.spawn_time_s + obj.lifetime_s);
+    objects();
     objects_.push_back(std::move(obj));
 }
 
-const std::vector<WorldObject>& WorldModel::tick(double dt, double current_time_s) {
-    for (auto& obj : objects_) {
-        double heading_rad = obj.heading_deg * DEG_TO_RAD;
+void WorldModel::reserve(std::size_t n) {
+    kin_.range_m.reserve(n);
+    kin_.azimuth_deg.reserve(n);
+    kin_.radial_mps.reserve(n);
+    kin_.tangential_mps.reserve(n);
+    kin_.expires_s.reserve(n);
+    objects_.reserve(n);
+}
 
-        // Radial component: positive heading component changes range
-        double radial_delta = obj.speed_mps * std::cos(heading_rad) * dt;
-        obj.range_m += radial_delta;
+void WorldModel::step(double dt, double current_time_s) {
+    std::size_t n = kin_.size();
+    double* range = kin_.range_m.data();
+    double* az = kin_.azimuth_deg.data();
+    const double* radial = kin_.radial_mps.data();
+    const double* tangential = kin_.tangential_mps.data();
 
-        // Tangential component: changes azimuth
-        if (obj.range_m > MIN_RANGE_M) {
-            double tangential_delta = obj.speed_mps * std::sin(heading_rad) * dt;
-            obj.azimuth_deg += tangential_delta / obj.range_m * RAD_TO_DEG;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    i = step_sse2(range, az, radial, tangential, n, dt);
+#endif
+    for (; i < n; ++i)
+        step_one(range, az, radial, tangential, i, dt);
 
-            // Normalize azimuth to [0, 360)
-            while (obj.azimuth_deg < 0.0) obj.azimuth_deg += 360.0;
-            while (obj.azimuth_deg >= 360.0) obj.azimuth_deg -= 360.0;
-        }
+    // Remove expired or too-close objects
+    for (i = 0; i < kin_.size();) {
+        if (kin_.range_m[i] < MIN_RANGE_M || current_time_s > kin_.expires_s[i])
+            swap_remove(i);
+        else
+            ++i;
     }
+    stale_ = true;
+}
 
-    // Remove expired or too-close objects
-    objects_.erase(
-        std::remove_if(objects_.begin(), objects_.end(),
-            [current_time_s](const WorldObject& obj) {
-                if (obj.range_m < MIN_RANGE_M) return true;
-                if (current_time_s > obj.spawn_time_s + obj.lifetime_s) return true;
-                return false;
-            }),
-        objects_.end());
+const std::vector<WorldObject>& WorldModel::tick(double dt, double current_time_s) {
+    step(dt, current_time_s);
+    return objects();
+}
 
-    return objects_;
+void WorldModel::swap_remove(std::size_t i) {
+    std::size_t last = kin_.size() - 1;
+    if (i != last) {
+        kin_.range_m[i] = kin_.range_m[last];
+        kin_.azimuth_deg[i] = kin_.azimuth_deg[last];
+        kin_.radial_mps[i] = kin_.radial_mps[last];
+        kin_.tangential_mps[i] = kin_.tangential_mps[last];
+        kin_.expires_s[i] = kin_.expires_s[last];
+        objects_[i] = std::move(objects_[last]);
+    }
+    kin_.range_m.pop_back();
+    kin_.azimuth_deg.pop_back();
+    kin_.radial_mps.pop_back();
+    kin_.tangential_mps.pop_back();
+    kin_.expires_s.pop_back();
+    objects_.pop_back();
 }
 
 std::size_t WorldModel::active_count() const {
-    return objects_.size();
+    return kin_.size();
 }
 
 const std::vector<WorldObject>& WorldModel::objects() const {
+    if (stale_) {
+        for (std::size_t i = 0; i < objects_.size(); ++i) {
+            objects_[i].range_m = kin_.range_m[i];
+            objects_[i].azimuth_deg = kin_.azimuth_deg[i];
+        }
+        stale_ = false;
+    }
     return objects_;
 }
 
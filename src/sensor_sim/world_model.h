@@ -5,15 +5,52 @@
 
 namespace nng {
 
+// Per-object state tick() reads and writes, one array per field; index i
+// is objects()[i]. Heading and speed never change once an object is
+// added, so they are kept as the two velocity components.
+struct WorldKinematics {
+    std::vector<double> range_m;
+    std::vector<double> azimuth_deg;
+    std::vector<double> radial_mps;     // speed * cos(heading): range rate
+    std::vector<double> tangential_mps; // speed * sin(heading)
+    std::vector<double> expires_s;      // spawn_time_s + lifetime_s
+
+    std::size_t size() const { return range_m.size(); }
+};
+
+// Objects are held as structure-of-arrays so step() can run over them
+// without trig. With SSE2 it advances two objects at a time (step_sse2),
+// where a masked select keeps the old azimuth for lanes at range <=
+// MIN_RANGE_M instead of a branch; the scalar step_one, which does
+// branch, takes the odd object left over (or all of them without SSE2).
+// Expired objects are swap-removed (the last object takes the freed
+// index, so order is not kept). objects() is the array-of-structs view
+// for callers of the WorldObject API, brought up to date on demand.
 class WorldModel {
 public:
+    // Objects closer than this are dropped
+    static constexpr double MIN_RANGE_M = 50.0;
+
     void add_object(WorldObject obj);
+    void reserve(std::size_t n);
+
+    // Advance every object by dt and drop the expired ones
+    void step(double dt, double current_time_s);
+    // step(), then the updated objects()
     const std::vector<WorldObject>& tick(double dt, double current_time_s);
+
     std::size_t active_count() const;
     const std::vector<WorldObject>& objects() const;
+    const WorldKinematics& kinematics() const { return kin_; }
 
 private:
-    std::vector<WorldObject> objects_;
+    void swap_remove(std::size_t i);
+
+    WorldKinematics kin_;
+    // Fields step() does not touch; range and azimuth are copied in from
+    // kin_ by objects() when stale
+    mutable std::vector<WorldObject> objects_;
+    mutable bool stale_ = false;
 };
 
 } // namespace nng
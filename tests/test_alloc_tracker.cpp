@@ -0,0 +1,197 @@
+#include "common/alloc_tracker.h"
+#include "control_node/command_handler.h"
+#include "control_node/metrics_exporter.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+const ThreadAllocs* find_thread(const AllocReport& r, const std::string& name) {
+    for (const auto& t : r.threads)
+        if (t.name == name)
+            return &t;
+    return nullptr;
+}
+
+std::vector<uint8_t> heartbeat_frame(uint32_t seq) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(HeartbeatPayload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    hdr.src_id = 3;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(hdr, buf.data());
+    return buf;
+}
+
+// One allocation and free of n bytes through the hooked operators. Called
+// explicitly and passed through a volatile, so unlike a matched new/delete
+// expression the optimizer may not remove the pair.
+void alloc_and_free(std::size_t n) {
+    void* volatile p = ::operator new(n);
+    ::operator delete(p);
+}
+
+// Counting is global: every test leaves it off
+class AllocTrackerTest : public ::testing::Test {
+protected:
+    void TearDown() override { AllocTracker::set_enabled(false); }
+};
+
+} // anonymous namespace
+
+TEST_F(AllocTrackerTest, HooksInstalled) {
+    EXPECT_TRUE(AllocTracker::installed());
+}
+
+TEST_F(AllocTrackerTest, SizeBuckets) {
+    EXPECT_EQ(AllocTracker::size_bucket(0), 0u);
+    EXPECT_EQ(AllocTracker::size_bucket(1), 1u);
+    EXPECT_EQ(AllocTracker::size_bucket(7), 3u);
+    EXPECT_EQ(AllocTracker::size_bucket(8), 4u);
+    EXPECT_EQ(AllocTracker::size_bucket(100), 7u);
+    EXPECT_EQ(AllocTracker::size_bucket(SIZE_MAX), ALLOC_SIZE_BUCKETS - 1);
+}
+
+TEST_F(AllocTrackerTest, CountsPerNamedThreadWhileEnabled) {
+    AllocTracker::set_enabled(true);
+    std::thread t([] {
+        AllocTracker::name_thread("alloc_test_hot", true);
+        for (int i = 0; i < 3; ++i)
+            alloc_and_free(100);
+        AllocTracker::set_enabled(false);
+        // Not counted
+        alloc_and_free(sizeof(int));
+    });
+    t.join();
+
+    AllocReport r = AllocTracker::report();
+    const ThreadAllocs* hot = find_thread(r, "alloc_test_hot");
+    ASSERT_NE(hot, nullptr);
+    EXPECT_TRUE(hot->hot);
+    EXPECT_EQ(hot->counts.allocs, 3u);
+    EXPECT_EQ(hot->counts.frees, 3u);
+    EXPECT_EQ(hot->counts.bytes, 300u);
+    EXPECT_EQ(hot->counts.sizes[AllocTracker::size_bucket(100)], 3u);
+    EXPECT_GE(r.hot.allocs, 3u);
+    EXPECT_GE(r.total.allocs, r.hot.allocs);
+}
+
+TEST_F(AllocTrackerTest, ResetMovesBaseline) {
+    std::thread t([] {
+        AllocTracker::name_thread("alloc_test_reset", false);
+        AllocTracker::set_enabled(true);
+        alloc_and_free(sizeof(int));
+        AllocTracker::reset();
+        alloc_and_free(sizeof(int));
+        alloc_and_free(sizeof(int));
+        AllocTracker::set_enabled(false);
+    });
+    t.join();
+
+    const ThreadAllocs* after = find_thread(AllocTracker::report(), "alloc_test_reset");
+    ASSERT_NE(after, nullptr);
+    EXPECT_FALSE(after->hot);
+    EXPECT_EQ(after->counts.allocs, 2u);
+}
+
+TEST_F(AllocTrackerTest, GetAlloc) {
+    StatsManager stats;
+    CommandHandler handler(stats, Logger::instance());
+    EXPECT_EQ(handler.handle("SET ALLOC=MAYBE"), "ERR INVALID_ALLOC_VALUE");
+    EXPECT_EQ(handler.handle("SET ALLOC=ON"), "OK ALLOC=ON");
+    EXPECT_TRUE(AllocTracker::enabled());
+    for (int i = 0; i < 4; ++i)
+        stats.record_rx(1, i, 0);
+
+    std::string resp = handler.handle("GET ALLOC");
+    EXPECT_EQ(resp.rfind("ALLOC enabled=1\n", 0), 0u) << resp;
+    EXPECT_NE(resp.find("\nframes=4\n"), std::string::npos) << resp;
+    EXPECT_NE(resp.find("\nhot_allocs_per_frame="), std::string::npos);
+    EXPECT_EQ(handler.handle("GET ALLOC extra"), "ERR UNKNOWN_COMMAND");
+
+    EXPECT_EQ(handler.handle("SET ALLOC=RESET"), "OK ALLOC=RESET");
+    resp = handler.handle("GET ALLOC");
+    EXPECT_NE(resp.find("\nframes=0\n"), std::string::npos) << resp;
+    EXPECT_EQ(handler.handle("SET ALLOC=OFF"), "OK ALLOC=OFF");
+    EXPECT_FALSE(AllocTracker::enabled());
+}
+
+TEST_F(AllocTrackerTest, MetricsScrapeAllocatesNothingOnceWarm) {
+    StatsManager stats;
+    stats.set_writer_shards(2);
+    for (uint16_t src = 0; src < 500; ++src) {
+        stats.shard(src % 2).record_rx(src, 1, 1000);
+        stats.shard(src % 2).record_gap(src, 2);
+    }
+    std::thread t([&] {
+        AllocTracker::name_thread("alloc_test_scrape", false);
+        MetricsExporter exporter(stats);
+        exporter.render(); // grows the buffers
+        AllocTracker::set_enabled(true);
+        for (int i = 0; i < 3; ++i)
+            exporter.render();
+        AllocTracker::set_enabled(false);
+    });
+    t.join();
+
+    const ThreadAllocs* scrape = find_thread(AllocTracker::report(), "alloc_test_scrape");
+    ASSERT_NE(scrape, nullptr);
+    EXPECT_EQ(scrape->counts.allocs, 0u);
+}
+
+// The goal the tracker is for: once warmed up, the ingest thread
+// processes frames without touching the heap
+TEST_F(AllocTrackerTest, IngestSteadyStateAllocatesNothing) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    Logger::instance().set_level(Severity::WARN);
+
+    MemoryFrameChannel channel(1024);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    auto send = [&](uint32_t from, uint32_t n) {
+        std::vector<std::vector<uint8_t>> frames;
+        for (uint32_t i = 0; i < n; ++i)
+            frames.push_back(heartbeat_frame(from + i));
+        for (const auto& f : frames)
+            channel.sink().send(f);
+        for (int i = 0; i < 400 && gateway.stats().get_global_stats().rx_total < from + n; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ASSERT_EQ(gateway.stats().get_global_stats().rx_total, from + n);
+    };
+
+    // Warm-up: first-seen source state, lazily grown buffers
+    send(0, 200);
+    AllocTracker::reset();
+    AllocTracker::set_enabled(true);
+    send(200, 500);
+    AllocTracker::set_enabled(false);
+
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+    Logger::instance().set_level(Severity::INFO);
+
+    const ThreadAllocs* ingest = find_thread(AllocTracker::report(), "ingest0");
+    ASSERT_NE(ingest, nullptr);
+    EXPECT_TRUE(ingest->hot);
+    EXPECT_EQ(ingest->counts.allocs, 0u);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "sensor_sim/beam_scanner.h"
+#include <algorithm>
+
+using namespace nng;
+
+static WorldObject at(uint32_t id, double az, double range = 10000.0) {
+    WorldObject obj{};
+    obj.id = id;
+    obj.azimuth_deg = az;
+    obj.range_m = range;
+    return obj;
+}
+
+static std::vector<uint32_t> query(const AzimuthIndex& idx, double from, double len) {
+    std::vector<uint32_t> out;
+    idx.query(from, len, out);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+TEST(AzimuthIndex, QueryArcs) {
+    std::vector<WorldObject> objects = {at(1, 0.0), at(2, 10.5), at(3, 11.0), at(4, 180.0),
+                                        at(5, 359.5), at(6, 720.25)};
+    AzimuthIndex idx;
+    idx.build(objects);
+    EXPECT_EQ(idx.size(), 6u);
+
+    EXPECT_EQ(query(idx, 10.0, 1.0), (std::vector<uint32_t>{1}));       // [10, 11)
+    EXPECT_EQ(query(idx, 10.0, 1.01), (std::vector<uint32_t>{1, 2}));
+    // Wraps through north; 720.25 is 0.25
+    EXPECT_EQ(query(idx, 359.0, 2.0), (std::vector<uint32_t>{0, 4, 5}));
+    EXPECT_EQ(query(idx, -1.0, 2.0), (std::vector<uint32_t>{0, 4, 5}));
+    EXPECT_EQ(query(idx, 0.0, 360.0).size(), 6u);
+    EXPECT_TRUE(query(idx, 200.0, 100.0).empty());
+    // Nearly the whole circle, starting mid-bucket: only [11.0, 10.5) is outside
+    EXPECT_EQ(query(idx, 11.0, 359.5), (std::vector<uint32_t>{0, 2, 3, 4, 5}));
+}
+
+TEST(AzimuthIndex, MaxRangeLeavesFarObjectsOut) {
+    std::vector<WorldObject> objects = {at(1, 5.0, 1000.0), at(2, 5.0, 90000.0)};
+    AzimuthIndex idx(1.0, 50000.0);
+    idx.build(objects);
+    EXPECT_EQ(idx.size(), 1u);
+    EXPECT_EQ(query(idx, 0.0, 360.0), (std::vector<uint32_t>{0}));
+}
+
+TEST(BeamScanner, ZeroWidthPaintsEachObjectOncePerRevolution) {
+    std::vector<WorldObject> objects;
+    for (uint32_t i = 0; i < 1000; ++i)
+        objects.push_back(at(i + 1, i * 0.36 + 0.1));
+    AzimuthIndex idx;
+    idx.build(objects);
+
+    BeamOptions opt;
+    opt.rpm = 60.0; // 360 deg/s
+    opt.width_deg = 0.0;
+    BeamScanner beam(opt);
+    std::vector<int> painted(objects.size(), 0);
+    std::vector<WorldObject> out;
+    std::size_t most = 0;
+    for (int tick = 0; tick < 100; ++tick) { // one revolution at 100 Hz
+        beam.advance(0.01);
+        beam.select(idx, objects, out);
+        most = std::max(most, out.size());
+        for (const auto& obj : out)
+            painted[obj.id - 1]++;
+    }
+    for (int n : painted)
+        EXPECT_EQ(n, 1);
+    // Bounded per-tick work: a 3.6 degree sector of evenly spread objects
+    EXPECT_LE(most, 11u);
+    EXPECT_NEAR(beam.azimuth_deg(), 0.0, 1e-6);
+}
+
+TEST(BeamScanner, WidthSetsDwell) {
+    std::vector<WorldObject> objects = {at(1, 90.0)};
+    AzimuthIndex idx;
+    idx.build(objects);
+
+    BeamOptions opt;
+    opt.rpm = 10.0 / 6.0; // 10 deg/s: 1 deg per 0.1 s tick
+    opt.width_deg = 5.0;
+    BeamScanner beam(opt);
+    std::vector<WorldObject> out;
+    int hits = 0;
+    for (int tick = 0; tick < 360; ++tick) {
+        beam.advance(0.1);
+        beam.select(idx, objects, out);
+        hits += static_cast<int>(out.size());
+    }
+    // Painted while within half a beam width of the centre path
+    EXPECT_GE(hits, 5);
+    EXPECT_LE(hits, 7);
+}
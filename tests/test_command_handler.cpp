@@ -1,4 +1,6 @@
 #include "control_node/command_handler.h"
+#include "control_node/keyword_map.h"
+#include "control_node/tcp_framer.h"
 #include "gateway/stats_manager.h"
 #include "common/logger.h"
 #include <gtest/gtest.h>
@@ -103,3 +105,348 @@ TEST_F(CommandHandlerTest, CaseInsensitiveCommand) {
     EXPECT_NE(response1.find("HEALTH"), std::string::npos);
     EXPECT_NE(response2.find("HEALTH"), std::string::npos);
 }
+
+TEST_F(CommandHandlerTest, StatsIncludeFiltered) {
+    stats_->record_filtered(7);
+    std::string response = handler_->handle("GET STATS");
+    EXPECT_NE(response.find("filtered_total=7"), std::string::npos);
+}
+
+TEST_F(CommandHandlerTest, SetFilterWithoutGateway) {
+    EXPECT_EQ(handler_->handle("SET FILTER=type=TRACK"), "ERR FILTER_UNAVAILABLE");
+    EXPECT_EQ(handler_->handle("GET FILTER"), "ERR FILTER_UNAVAILABLE");
+}
+
+TEST_F(CommandHandlerTest, SetFilter) {
+    IngressFilter filter;
+    handler_->set_ingress_filter(&filter);
+
+    EXPECT_EQ(handler_->handle("SET FILTER=type=track; src=1-4"), "OK FILTER=TYPE=TRACK; SRC=1-4");
+    EXPECT_TRUE(filter.allows(2, static_cast<uint8_t>(MsgType::TRACK)));
+    EXPECT_FALSE(filter.allows(5, static_cast<uint8_t>(MsgType::TRACK)));
+    EXPECT_EQ(handler_->handle("GET FILTER"), "FILTER TYPE=TRACK; SRC=1-4");
+
+    // A bad spec leaves the current rules in place
+    EXPECT_EQ(handler_->handle("SET FILTER=type=nope"), "ERR INVALID_FILTER");
+    EXPECT_FALSE(filter.allows(5, static_cast<uint8_t>(MsgType::TRACK)));
+
+    EXPECT_EQ(handler_->handle("SET FILTER=ALL"), "OK FILTER=ALL");
+    EXPECT_TRUE(filter.accepts_all());
+}
+
+TEST_F(CommandHandlerTest, RuntimeKnobs) {
+    EXPECT_EQ(handler_->handle("SET RECORD=ON"), "ERR RECORDING_UNAVAILABLE");
+    EXPECT_EQ(handler_->handle("SET PLOT_SAMPLE=4"), "ERR RUNTIME_UNAVAILABLE");
+    EXPECT_EQ(handler_->handle("GET RUNTIME"), "ERR RUNTIME_UNAVAILABLE");
+
+    RuntimeConfig runtime;
+    handler_->set_runtime_config(&runtime);
+
+    EXPECT_EQ(handler_->handle("SET CRC=OFF"), "OK CRC=OFF");
+    EXPECT_FALSE(runtime.crc());
+    EXPECT_FALSE(handler_->crc_enabled());
+
+    EXPECT_EQ(handler_->handle("SET RECORD=ON"), "ERR RECORDING_UNAVAILABLE");
+    runtime.set_recorder_open(true);
+    EXPECT_EQ(handler_->handle("set record=off"), "OK RECORD=OFF");
+    EXPECT_FALSE(runtime.recording());
+    EXPECT_EQ(handler_->handle("SET RECORD=maybe"), "ERR INVALID_RECORD_VALUE");
+
+    EXPECT_EQ(handler_->handle("SET EVENT_LEVEL=warn"), "OK EVENT_LEVEL=WARN");
+    EXPECT_EQ(runtime.event_level(), Severity::WARN);
+    EXPECT_EQ(handler_->handle("SET EVENT_LEVEL=LOUD"), "ERR INVALID_EVENT_LEVEL");
+
+    EXPECT_EQ(handler_->handle("SET PLOT_SAMPLE=8"), "OK PLOT_SAMPLE=8");
+    EXPECT_EQ(runtime.plot_sample(), 8u);
+    EXPECT_EQ(handler_->handle("SET PLOT_SAMPLE=0"), "ERR INVALID_PLOT_SAMPLE");
+
+    EXPECT_EQ(handler_->handle("SET OVERLOAD=on"), "OK OVERLOAD=ON");
+    EXPECT_TRUE(runtime.overloaded());
+    EXPECT_EQ(handler_->handle("SET OVERLOAD=sometimes"), "ERR INVALID_OVERLOAD_MODE");
+
+    // The runtime's filter is used when no other was given
+    EXPECT_EQ(handler_->handle("SET FILTER=src=3"), "OK FILTER=SRC=3");
+    EXPECT_FALSE(runtime.filter().accepts_all());
+
+    std::string text = handler_->handle("GET RUNTIME");
+    EXPECT_EQ(text.rfind("RUNTIME\n", 0), 0u);
+    EXPECT_NE(text.find("crc=OFF\n"), std::string::npos);
+    EXPECT_NE(text.find("record=OFF\nrecorder=OPEN\n"), std::string::npos);
+    EXPECT_NE(text.find("event_level=WARN\neffective_event_level=WARN\n"), std::string::npos);
+    EXPECT_NE(text.find("plot_sample=8\n"), std::string::npos);
+    EXPECT_NE(text.find("overload_mode=ON\noverload_detected=0\noverloaded=1\noverload_entries=1\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("filter=SRC=3"), std::string::npos);
+}
+
+TEST_F(CommandHandlerTest, Profile) {
+    EXPECT_EQ(handler_->handle("GET PROFILE"), "ERR PROFILE_UNAVAILABLE");
+    EXPECT_EQ(handler_->handle("SET PROFILE=ON"), "ERR PROFILE_UNAVAILABLE");
+
+    StageProfiler profiler;
+    handler_->set_profiler(&profiler);
+    EXPECT_EQ(handler_->handle("SET PROFILE=on"), "OK PROFILE=ON");
+    EXPECT_TRUE(profiler.enabled());
+    EXPECT_EQ(handler_->handle("SET PROFILE=often"), "ERR INVALID_PROFILE_VALUE");
+
+#if NNG_PROFILE
+    profiler.attach("ingest0");
+    for (int i = 0; i < 3; ++i) {
+        NNG_PROFILE_SCOPE(PARSE);
+    }
+    StageProfiler::detach();
+
+    std::string text = handler_->handle("GET PROFILE");
+    EXPECT_EQ(text.rfind("PROFILE thread=all\nenabled=1\n", 0), 0u);
+    EXPECT_NE(text.find("\nthreads=ingest0\n"), std::string::npos);
+    EXPECT_NE(text.find("\nparse_count=3\n"), std::string::npos);
+    EXPECT_NE(text.find("\ntrack_count=0\n"), std::string::npos);
+    EXPECT_NE(text.find("\nrecord_total_ns=0"), std::string::npos);
+    EXPECT_EQ(handler_->handle("GET PROFILE ingest0").rfind("PROFILE thread=ingest0\n", 0), 0u);
+    EXPECT_EQ(handler_->handle("GET PROFILE dispatch"), "ERR UNKNOWN_THREAD");
+
+    EXPECT_EQ(handler_->handle("SET PROFILE=RESET"), "OK PROFILE=RESET");
+    EXPECT_NE(handler_->handle("GET PROFILE").find("\nparse_count=0\n"), std::string::npos);
+#else
+    EXPECT_EQ(handler_->handle("GET PROFILE"), "ERR PROFILE_NOT_BUILT");
+#endif
+    EXPECT_EQ(handler_->handle("SET PROFILE=OFF"), "OK PROFILE=OFF");
+    EXPECT_FALSE(profiler.enabled());
+}
+
+TEST_F(CommandHandlerTest, Tracks) {
+    EXPECT_EQ(handler_->handle("GET TRACKS"), "ERR TRACKS_UNAVAILABLE");
+
+    TrackPicture picture(64, 0);
+    picture.set_writers(1);
+    TrackPayload t{};
+    t.track_id = 42;
+    t.classification = 1;
+    t.threat_level = 3;
+    t.range_m = 1500;
+    t.azimuth_mdeg = -2000;
+    picture.table(0).update(9, t, 1);
+    t.track_id = 43;
+    t.threat_level = 1;
+    picture.table(0).update(9, t, 1);
+    handler_->set_track_picture(&picture);
+
+    std::string all = handler_->handle("GET TRACKS");
+    EXPECT_EQ(all.rfind("TRACKS count=2 shown=2 dropped=0\nsrc_id=9 track_id=42 class=1 threat=3 "
+                        "iff=0 az_mdeg=-2000 el_mdeg=0 range_m=1500 velocity_mps=0 rcs_dbsm=0 "
+                        "updates=1 age_ms=", 0), 0u) << all;
+    EXPECT_NE(all.find("\nsrc_id=9 track_id=43 "), std::string::npos);
+
+    std::string high = handler_->handle("GET TRACKS threat>=2");
+    EXPECT_EQ(high.rfind("TRACKS count=1 shown=1", 0), 0u) << high;
+    EXPECT_EQ(high.find("track_id=43"), std::string::npos);
+    EXPECT_EQ(handler_->handle("GET TRACKS threat>=x"), "ERR INVALID_TRACK_FILTER");
+    EXPECT_EQ(handler_->handle("GET TRACKS threat>=256"), "ERR INVALID_TRACK_FILTER");
+    EXPECT_EQ(handler_->handle("GET TRACKS range<5"), "ERR INVALID_TRACK_FILTER");
+    EXPECT_EQ(handler_->handle("GET TRACKS threat>=1 more"), "ERR UNKNOWN_COMMAND");
+}
+
+// This binary does not link nng_alloc_hooks (see test_alloc_tracker)
+TEST_F(CommandHandlerTest, AllocWithoutHooks) {
+    EXPECT_EQ(handler_->handle("GET ALLOC"), "ERR ALLOC_NOT_INSTALLED");
+    EXPECT_EQ(handler_->handle("SET ALLOC=ON"), "ERR ALLOC_NOT_INSTALLED");
+}
+
+TEST_F(CommandHandlerTest, Forward) {
+    EXPECT_EQ(handler_->handle("GET FORWARD"), "ERR FORWARD_UNAVAILABLE");
+    EXPECT_EQ(handler_->handle("SET FORWARD_FILTER=type=TRACK"), "ERR FORWARD_UNAVAILABLE");
+
+    ForwardOptions options;
+    options.targets = {"239.1.2.3:6000"};
+    ForwardHub hub(options);
+    handler_->set_forwarding(&hub);
+    EXPECT_EQ(handler_->handle("GET FORWARD"),
+              "FORWARD targets=1 filter=ALL\nframes=0\nfiltered=0\ndatagrams=0\nsend_failures=0");
+    EXPECT_EQ(handler_->handle("SET FORWARD_FILTER=type=bogus"), "ERR INVALID_FILTER");
+    std::string ok = handler_->handle("SET FORWARD_FILTER=type=TRACK");
+    EXPECT_EQ(ok.rfind("OK FORWARD_FILTER=", 0), 0u) << ok;
+    EXPECT_FALSE(hub.filter().allows(1, static_cast<uint8_t>(MsgType::PLOT)));
+    EXPECT_TRUE(hub.filter().allows(1, static_cast<uint8_t>(MsgType::TRACK)));
+    EXPECT_EQ(handler_->handle("GET FORWARD now"), "ERR UNKNOWN_COMMAND");
+}
+
+TEST_F(CommandHandlerTest, GetLatency) {
+    const uint64_t base = 1700000000ULL * 1000000000ULL;
+    for (uint64_t i = 0; i < 10; ++i)
+        stats_->record_rx(7, static_cast<uint32_t>(i), base + i * 1000 + 500, base + i * 1000);
+
+    std::string all = handler_->handle("GET LATENCY");
+    EXPECT_EQ(all.rfind("LATENCY src=all\n", 0), 0u);
+    EXPECT_NE(all.find("interarrival_count=9\n"), std::string::npos);
+    EXPECT_NE(all.find("latency_count=10\n"), std::string::npos);
+    EXPECT_NE(all.find("latency_max_ns=500"), std::string::npos);
+
+    std::string one = handler_->handle("get latency 0x7");
+    EXPECT_EQ(one.rfind("LATENCY src=7\n", 0), 0u);
+    EXPECT_NE(one.find("interarrival_p50_ns=1000\n"), std::string::npos);
+    EXPECT_NE(one.find("latency_p999_ns=500\n"), std::string::npos);
+
+    EXPECT_EQ(handler_->handle("GET LATENCY 8"), "ERR UNKNOWN_SOURCE");
+    EXPECT_EQ(handler_->handle("GET LATENCY abc"), "ERR INVALID_SOURCE");
+    EXPECT_EQ(handler_->handle("GET LATENCY 70000"), "ERR INVALID_SOURCE");
+}
+
+TEST_F(CommandHandlerTest, GetRates) {
+    stats_->record_rx(7, 0, 0);
+
+    std::string all = handler_->handle("GET RATES");
+    EXPECT_EQ(all.rfind("RATES src=all\n", 0), 0u);
+    EXPECT_NE(all.find("rx_1s="), std::string::npos);
+    EXPECT_NE(all.find("gaps_10s="), std::string::npos);
+    EXPECT_NE(all.find("crc_fail_60s="), std::string::npos);
+
+    EXPECT_EQ(handler_->handle("GET RATES 7").rfind("RATES src=7\n", 0), 0u);
+    EXPECT_EQ(handler_->handle("GET RATES 8"), "ERR UNKNOWN_SOURCE");
+    EXPECT_EQ(handler_->handle("GET RATES x"), "ERR INVALID_SOURCE");
+}
+
+TEST_F(CommandHandlerTest, StatsSnapshotAge) {
+    std::string r = handler_->handle("GET STATS");
+    EXPECT_NE(r.find("snapshot_version="), std::string::npos);
+    EXPECT_NE(r.find("snapshot_age_us="), std::string::npos);
+
+    // With a max age, polls share one snapshot
+    EXPECT_EQ(handler_->handle("SET STATS_MAX_AGE_MS=60000"), "OK STATS_MAX_AGE_MS=60000");
+    handler_->handle("GET STATS");
+    stats_->record_rx(1, 0, 1);
+    EXPECT_NE(handler_->handle("GET STATS").find("rx_total=0\n"), std::string::npos);
+    EXPECT_EQ(handler_->handle("SET STATS_MAX_AGE_MS=0"), "OK STATS_MAX_AGE_MS=0");
+    EXPECT_NE(handler_->handle("GET STATS").find("rx_total=1\n"), std::string::npos);
+    EXPECT_EQ(handler_->handle("SET STATS_MAX_AGE_MS=soon"), "ERR INVALID_STATS_MAX_AGE");
+}
+
+TEST_F(CommandHandlerTest, SetCategoryLogLevel) {
+    Logger::instance().set_level(Severity::INFO);
+    EXPECT_EQ(handler_->handle("SET LOG_LEVEL.TRACKING=DEBUG"), "OK LOG_LEVEL.TRACKING=DEBUG");
+    EXPECT_EQ(Logger::instance().get_level(EventCategory::TRACKING), Severity::DEBUG);
+    EXPECT_EQ(Logger::instance().get_level(EventCategory::NETWORK), Severity::INFO);
+    EXPECT_TRUE(Logger::instance().enabled(Severity::DEBUG, EventCategory::TRACKING));
+    EXPECT_FALSE(Logger::instance().enabled(Severity::DEBUG, EventCategory::NETWORK));
+
+    EXPECT_EQ(handler_->handle("set log_level.health=warn"), "OK LOG_LEVEL.HEALTH=WARN");
+    EXPECT_EQ(Logger::instance().get_level(EventCategory::HEALTH), Severity::WARN);
+
+    EXPECT_EQ(handler_->handle("SET LOG_LEVEL.RADAR=DEBUG"), "ERR INVALID_LOG_CATEGORY");
+    EXPECT_EQ(handler_->handle("SET LOG_LEVEL.THREAT=LOUD"), "ERR INVALID_LOG_LEVEL");
+
+    // The global level resets every category
+    EXPECT_EQ(handler_->handle("SET LOG_LEVEL=ERROR"), "OK LOG_LEVEL=ERROR");
+    EXPECT_EQ(Logger::instance().get_level(EventCategory::TRACKING), Severity::ERROR);
+    EXPECT_EQ(handler_->get_config("LOG_LEVEL.TRACKING"), "");
+    Logger::instance().set_level(Severity::INFO);
+}
+
+TEST_F(CommandHandlerTest, ParseSubscribe) {
+    SubscribeRequest req;
+    ASSERT_TRUE(CommandHandler::parse_subscribe("network,health", false, req));
+    EXPECT_EQ(req.category_mask, (1u << static_cast<unsigned>(EventCategory::NETWORK)) |
+                                     (1u << static_cast<unsigned>(EventCategory::HEALTH)));
+    EXPECT_FALSE(req.stats);
+
+    ASSERT_TRUE(CommandHandler::parse_subscribe("STATS 250", false, req));
+    EXPECT_TRUE(req.stats);
+    EXPECT_EQ(req.interval_ms, 250u);
+    EXPECT_EQ(req.category_mask, 0u);
+
+    ASSERT_TRUE(CommandHandler::parse_subscribe("all", false, req));
+    EXPECT_EQ(req.category_mask, ~0u);
+
+    EXPECT_FALSE(CommandHandler::parse_subscribe("", false, req));
+    EXPECT_FALSE(CommandHandler::parse_subscribe("STATS", false, req));
+    EXPECT_FALSE(CommandHandler::parse_subscribe("STATS -5", false, req));
+    EXPECT_FALSE(CommandHandler::parse_subscribe("NETWORK,RADAR", false, req));
+    EXPECT_FALSE(CommandHandler::parse_subscribe("NETWORK,", false, req));
+    EXPECT_FALSE(CommandHandler::parse_subscribe("NETWORK extra", false, req));
+
+    // UNSUBSCRIBE: no interval, and no arguments means everything
+    ASSERT_TRUE(CommandHandler::parse_subscribe("STATS", true, req));
+    EXPECT_TRUE(req.stats);
+    ASSERT_TRUE(CommandHandler::parse_subscribe("", true, req));
+    EXPECT_TRUE(req.stats);
+    EXPECT_EQ(req.category_mask, ~0u);
+
+    // Without a connection there is nothing to stream to
+    EXPECT_EQ(handler_->handle("SUBSCRIBE NETWORK"), "ERR STREAMING_UNAVAILABLE");
+}
+
+TEST_F(CommandHandlerTest, BatchAnswersEachCommand) {
+    std::string framed = handler_->handle("BATCH\nGET health\n\nSET CRC=off\r\nFOO\nbatch GET stats");
+    TcpFramer framer;
+    framer.feed(reinterpret_cast<const uint8_t*>(framed.data()), framed.size());
+    std::vector<std::string> responses;
+    while (framer.has_frame())
+        responses.push_back(framer.pop_frame());
+    EXPECT_EQ(framer.buffered_bytes(), 0u);
+    ASSERT_EQ(responses.size(), 4u); // blank line skipped
+    EXPECT_NE(responses[0].find("HEALTH"), std::string::npos);
+    EXPECT_EQ(responses[1], "OK CRC=OFF");
+    EXPECT_FALSE(handler_->crc_enabled());
+    EXPECT_EQ(responses[2], "ERR UNKNOWN_COMMAND");
+    EXPECT_EQ(responses[3], "ERR NESTED_BATCH");
+
+    // respond() frames plain commands and passes a batch through
+    std::vector<uint8_t> out;
+    handler_->respond("GET health", out);
+    handler_->respond("BATCH GET health\nGET health", out);
+    framer.feed(out.data(), out.size());
+    int frames = 0;
+    while (framer.has_frame()) {
+        EXPECT_NE(framer.pop_frame().find("HEALTH"), std::string::npos);
+        ++frames;
+    }
+    EXPECT_EQ(frames, 3);
+}
+
+TEST_F(CommandHandlerTest, BatchLimits) {
+    auto single = [](const std::string& framed) {
+        TcpFramer framer;
+        framer.feed(reinterpret_cast<const uint8_t*>(framed.data()), framed.size());
+        return framer.pop_frame();
+    };
+    EXPECT_EQ(single(handler_->handle("BATCH")), "ERR EMPTY_BATCH");
+    EXPECT_EQ(single(handler_->handle("BATCH \n \n")), "ERR EMPTY_BATCH");
+
+    std::string big = "BATCH";
+    for (std::size_t i = 0; i <= CommandHandler::MAX_BATCH; ++i)
+        big += "\nGET health";
+    EXPECT_EQ(single(handler_->handle(big)), "ERR BATCH_TOO_LARGE");
+
+    // Only the exact verb starts a batch
+    EXPECT_EQ(handler_->handle("BATCHES"), "ERR UNKNOWN_COMMAND");
+}
+
+TEST(KeywordMapTest, CaseInsensitiveLookup) {
+    enum class Color { RED, GREEN, BLUE };
+    static constexpr Keyword<Color> WORDS[] = {
+        {"RED", Color::RED}, {"GREEN", Color::GREEN}, {"BLUE", Color::BLUE}};
+    static constexpr auto MAP = make_keyword_map(WORDS);
+    static_assert(MAP.perfect(), "no collision-free seed");
+    static_assert(decltype(MAP)::SLOTS == 8, "two slots per keyword, rounded up");
+
+    Color c = Color::RED;
+    EXPECT_TRUE(MAP.find("green", c));
+    EXPECT_EQ(c, Color::GREEN);
+    EXPECT_TRUE(MAP.find("Blue", c));
+    EXPECT_EQ(c, Color::BLUE);
+    EXPECT_FALSE(MAP.find("BLU", c));
+    EXPECT_FALSE(MAP.find("BLUEs", c));
+    EXPECT_FALSE(MAP.find("", c));
+}
+
+TEST_F(CommandHandlerTest, TokenizerEdgeCases) {
+    EXPECT_EQ(handler_->handle("  get \t health  "), "HEALTH OK");
+    EXPECT_EQ(handler_->handle("GET HEALTH now"), "ERR UNKNOWN_COMMAND");
+    EXPECT_EQ(handler_->handle("GETS HEALTH"), "ERR UNKNOWN_COMMAND");
+    EXPECT_EQ(handler_->handle("GET health\n"), "HEALTH OK");
+    EXPECT_EQ(handler_->handle("get latency  ALL "), handler_->handle("GET LATENCY"));
+    EXPECT_EQ(handler_->handle("SET crc = off"), "OK CRC=OFF");
+    EXPECT_EQ(handler_->handle("set my.key=Mixed Case"), "OK MY.KEY=Mixed Case");
+    EXPECT_EQ(handler_->get_config("MY.KEY"), "Mixed Case");
+    EXPECT_EQ(handler_->handle("SET CRC.X=1"), "OK CRC.X=1"); // only LOG_LEVEL takes a suffix
+    EXPECT_EQ(handler_->handle("SET STATS_MAX_AGE_MS=-5"), "ERR INVALID_STATS_MAX_AGE");
+}
@@ -0,0 +1,106 @@
+#include "common/compression.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+std::vector<uint8_t> repetitive(std::size_t n) {
+    // TRACK-like records: mostly constant fields, a slowly changing counter
+    std::vector<uint8_t> v(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v[i] = static_cast<uint8_t>((i % 48) < 40 ? (i % 48) : (i / 48) & 0xFF);
+    return v;
+}
+
+std::vector<uint8_t> random_bytes(std::size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> v(n);
+    for (auto& b : v)
+        b = static_cast<uint8_t>(rng());
+    return v;
+}
+
+void round_trip(Codec codec, const std::vector<uint8_t>& src) {
+    std::vector<uint8_t> packed(src.size() + src.size() / 255 + 64);
+    std::size_t n = compress_block(codec, src.data(), src.size(), packed.data(), packed.size());
+    ASSERT_GT(n, 0u);
+    std::vector<uint8_t> out(src.size());
+    ASSERT_TRUE(decompress_block(codec, packed.data(), n, out.data(), out.size()));
+    EXPECT_EQ(out, src);
+}
+
+} // anonymous namespace
+
+TEST(CompressionTest, ParseAndName) {
+    Codec c;
+    EXPECT_TRUE(parse_codec("lz4", c));
+    EXPECT_EQ(c, Codec::LZ4);
+    EXPECT_TRUE(parse_codec("NONE", c));
+    EXPECT_EQ(c, Codec::NONE);
+    EXPECT_TRUE(parse_codec("zstd", c));
+    EXPECT_EQ(c, Codec::ZSTD);
+    EXPECT_FALSE(parse_codec("gzip", c));
+    EXPECT_STREQ(codec_name(Codec::LZ4), "lz4");
+    EXPECT_TRUE(codec_available(Codec::NONE));
+    EXPECT_TRUE(codec_available(Codec::LZ4));
+}
+
+TEST(CompressionTest, Lz4RoundTripRepetitive) {
+    auto src = repetitive(256 * 1024);
+    round_trip(Codec::LZ4, src);
+
+    std::vector<uint8_t> packed(src.size());
+    std::size_t n = compress_block(Codec::LZ4, src.data(), src.size(), packed.data(), packed.size());
+    EXPECT_LT(n, src.size() / 4);
+}
+
+TEST(CompressionTest, Lz4RoundTripRandomAndSmall) {
+    round_trip(Codec::LZ4, random_bytes(64 * 1024, 7));
+    for (std::size_t n : {1u, 4u, 12u, 13u, 17u, 100u})
+        round_trip(Codec::LZ4, random_bytes(n, static_cast<uint32_t>(n)));
+    round_trip(Codec::LZ4, std::vector<uint8_t>(1000, 0xAB));
+}
+
+TEST(CompressionTest, Lz4EmptyInput) {
+    uint8_t packed[16];
+    std::size_t n = compress_block(Codec::LZ4, nullptr, 0, packed, sizeof(packed));
+    ASSERT_GT(n, 0u);
+    uint8_t out[1];
+    EXPECT_TRUE(decompress_block(Codec::LZ4, packed, n, out, 0));
+}
+
+TEST(CompressionTest, OutputTooSmallReturnsZero) {
+    auto src = random_bytes(4096, 3);
+    std::vector<uint8_t> packed(src.size() - 1);
+    EXPECT_EQ(compress_block(Codec::LZ4, src.data(), src.size(), packed.data(), packed.size()), 0u);
+    EXPECT_EQ(compress_block(Codec::NONE, src.data(), src.size(), packed.data(), packed.size()), 0u);
+}
+
+TEST(CompressionTest, Lz4RejectsCorruptInput) {
+    auto src = repetitive(16 * 1024);
+    std::vector<uint8_t> packed(src.size());
+    std::size_t n = compress_block(Codec::LZ4, src.data(), src.size(), packed.data(), packed.size());
+    ASSERT_GT(n, 0u);
+
+    std::vector<uint8_t> out(src.size());
+    // Truncated
+    EXPECT_FALSE(decompress_block(Codec::LZ4, packed.data(), n / 2, out.data(), out.size()));
+    // Wrong expected size
+    EXPECT_FALSE(decompress_block(Codec::LZ4, packed.data(), n, out.data(), out.size() - 1));
+
+    // Offset pointing before the start of the output
+    const uint8_t bad[] = {0x14, 'a', 0xFF, 0x00, 0x50, 'b', 'c', 'd', 'e', 'f'};
+    EXPECT_FALSE(decompress_block(Codec::LZ4, bad, sizeof(bad), out.data(), 14));
+}
+
+TEST(CompressionTest, ZstdRoundTripWhenAvailable) {
+    if (!codec_available(Codec::ZSTD))
+        GTEST_SKIP() << "built without libzstd";
+    round_trip(Codec::ZSTD, repetitive(128 * 1024));
+    round_trip(Codec::ZSTD, random_bytes(8 * 1024, 11));
+}
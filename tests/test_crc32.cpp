@@ -37,3 +37,52 @@ TEST(Crc32, IncrementalMatchesSingleCall) {
 
     EXPECT_EQ(full, final_crc);
 }
+
+static const nng::Crc32Impl ALL_IMPLS[] = {
+    nng::Crc32Impl::TABLE, nng::Crc32Impl::SLICE8, nng::Crc32Impl::SLICE16,
+    nng::Crc32Impl::PCLMUL, nng::Crc32Impl::ARMV8,
+};
+
+TEST(Crc32, ActiveImplIsSupported) {
+    EXPECT_TRUE(nng::crc32_impl_supported(nng::crc32_active_impl()));
+    EXPECT_TRUE(nng::crc32_impl_supported(nng::Crc32Impl::TABLE));
+}
+
+TEST(Crc32, EveryImplMatchesCheckValue) {
+    const char* input = "123456789";
+    for (auto impl : ALL_IMPLS) {
+        if (!nng::crc32_impl_supported(impl))
+            continue;
+        EXPECT_EQ(nng::crc32_update_with(impl, 0, reinterpret_cast<const uint8_t*>(input), 9),
+                  0xCBF43926u) << nng::crc32_impl_name(impl);
+    }
+}
+
+TEST(Crc32, EveryImplMatchesTableOnAllLengthsAndAlignments) {
+    std::vector<uint8_t> buf(600);
+    uint32_t x = 12345;
+    for (auto& b : buf) {
+        x = x * 1103515245u + 12345u;
+        b = static_cast<uint8_t>(x >> 16);
+    }
+
+    for (auto impl : ALL_IMPLS) {
+        if (!nng::crc32_impl_supported(impl))
+            continue;
+        for (std::size_t offset = 0; offset < 8; ++offset) {
+            for (std::size_t len = 0; len + offset <= buf.size(); len += (len < 200 ? 1 : 37)) {
+                const uint8_t* p = buf.data() + offset;
+                uint32_t expected = nng::crc32_update_with(nng::Crc32Impl::TABLE, 0, p, len);
+                ASSERT_EQ(nng::crc32_update_with(impl, 0, p, len), expected)
+                    << nng::crc32_impl_name(impl) << " offset=" << offset << " len=" << len;
+            }
+        }
+
+        // Incremental, across a chunk boundary that splits a fold block
+        uint32_t full = nng::crc32_update_with(impl, 0, buf.data(), buf.size());
+        uint32_t part = nng::crc32_update_with(impl, 0, buf.data(), 131);
+        part = nng::crc32_update_with(impl, part, buf.data() + 131, buf.size() - 131);
+        EXPECT_EQ(part, full) << nng::crc32_impl_name(impl);
+        EXPECT_EQ(nng::crc32(buf.data(), buf.size()), full);
+    }
+}
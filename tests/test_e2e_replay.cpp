@@ -209,3 +209,53 @@ TEST_F(E2EReplayTest, MultipleReplaysProduceSameStats) {
     EXPECT_EQ(stats1.reorder_total, stats2.reorder_total);
     EXPECT_EQ(stats1.malformed_total, stats2.malformed_total);
 }
+
+TEST_F(E2EReplayTest, GapStormIsCoalesced) {
+    // One source skipping every other sequence number: 200 gaps
+    {
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(record_file_));
+        for (uint32_t i = 0; i <= 200; ++i) {
+            TelemetryHeader hdr{};
+            hdr.version = PROTOCOL_VERSION;
+            hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+            hdr.src_id = 0x0042;
+            hdr.seq = i * 2;
+            hdr.ts_ns = 1000 + i;
+            hdr.payload_len = sizeof(HeartbeatPayload);
+            uint8_t frame[FRAME_HEADER_SIZE + sizeof(HeartbeatPayload)] = {};
+            serialize_header(hdr, frame);
+            ASSERT_TRUE(recorder.record(1000 + i, frame, sizeof(frame)));
+        }
+        recorder.close();
+    }
+
+    GatewayConfig gw_config;
+    gw_config.crc_enabled = false;
+    gw_config.replay_path = record_file_;
+    gw_config.log_level = Severity::WARN;
+    gw_config.event_window_ms = 60000;
+    gw_config.event_burst = 3;
+
+    Gateway gateway(gw_config);
+    int gap_events = 0;
+    uint32_t summarized = 0;
+    uint32_t summarized_frames = 0;
+    gateway.events().subscribe(EventCategory::NETWORK, [&](const EventRecord& e) {
+        if (e.id != EventId::EVT_SEQ_GAP)
+            return;
+        if (e.fields.kind == EventDetail::Kind::COALESCED) {
+            summarized += e.fields.coalesced.count;
+            summarized_frames += e.fields.coalesced.amount;
+        } else {
+            ++gap_events;
+        }
+    });
+    gateway.run();
+
+    EXPECT_EQ(gateway.stats().get_global_stats().gap_total, 200u);
+    EXPECT_EQ(gap_events, 3);
+    EXPECT_EQ(summarized, 197u) << "the rest comes out as one summary at shutdown";
+    EXPECT_EQ(summarized_frames, 197u);
+    EXPECT_EQ(gateway.events_coalesced(), 197u);
+}
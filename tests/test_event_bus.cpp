@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "common/event_bus.h"
 #include <atomic>
+#include <chrono>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -142,3 +144,256 @@ TEST(EventBus, ThreadSafePublish) {
 
     EXPECT_EQ(count.load(), threads * per_thread);
 }
+
+TEST(EventBus, CallbackMayChangeSubscriptionsDuringPublish) {
+    EventBus bus;
+    int first = 0, added = 0;
+    uint32_t id = 0;
+    id = bus.subscribe(EventCategory::TRACKING, [&](const EventRecord&) {
+        first++;
+        bus.unsubscribe(id);
+        bus.subscribe(EventCategory::TRACKING, [&](const EventRecord&) { added++; });
+    });
+
+    // The publish in progress keeps walking the list it started with
+    bus.publish(make_event(EventCategory::TRACKING, EventId::EVT_TRACK_NEW));
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(added, 0);
+
+    bus.publish(make_event(EventCategory::TRACKING, EventId::EVT_TRACK_NEW));
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(added, 1);
+}
+
+TEST(EventBus, SubscribeWhilePublishing) {
+    EventBus bus;
+    std::atomic<int> count{0};
+    bus.subscribe_all([&](const EventRecord&) { count++; });
+
+    std::atomic<bool> done{false};
+    std::thread publisher([&] {
+        for (int i = 0; i < 2000; ++i)
+            bus.publish(make_event(EventCategory::NETWORK, EventId::EVT_SEQ_GAP));
+        done = true;
+    });
+    while (!done.load()) {
+        auto id = bus.subscribe(EventCategory::NETWORK, [](const EventRecord&) {});
+        bus.unsubscribe(id);
+    }
+    publisher.join();
+    EXPECT_EQ(count.load(), 2000);
+}
+
+TEST(EventName, EveryEventIdHasItsName) {
+    static_assert(std::string_view(event_name(EventId::EVT_SEQ_GAP)) == "EVT_SEQ_GAP",
+                  "event_name() is usable at compile time");
+    for (const auto& e : EVENT_ID_NAMES)
+        EXPECT_STREQ(event_name(e.id), e.name);
+    EXPECT_STREQ(event_name(EventId::EVT_HEARTBEAT_DEGRADE), "EVT_HEARTBEAT_DEGRADE");
+}
+
+TEST(EventName, UnknownIdsMapToUnknown) {
+    EXPECT_STREQ(event_name(static_cast<EventId>(0x0107)), "UNKNOWN");
+    EXPECT_STREQ(event_name(static_cast<EventId>(0x0900)), "UNKNOWN");
+    EXPECT_STREQ(event_name(static_cast<EventId>(0xFFFF)), "UNKNOWN");
+}
+
+TEST(EventBus, HasSubscribersTracksSubscriptions) {
+    EventBus bus;
+    EXPECT_FALSE(bus.has_subscribers(EventCategory::TRACKING));
+
+    auto a = bus.subscribe(EventCategory::TRACKING, [](const EventRecord&) {});
+    EXPECT_TRUE(bus.has_subscribers(EventCategory::TRACKING));
+    EXPECT_FALSE(bus.has_subscribers(EventCategory::HEALTH));
+
+    auto b = bus.subscribe_all([](const EventRecord&) {});
+    EXPECT_TRUE(bus.has_subscribers(EventCategory::HEALTH));
+
+    bus.unsubscribe(b);
+    EXPECT_FALSE(bus.has_subscribers(EventCategory::HEALTH));
+    bus.unsubscribe(a);
+    bus.unsubscribe(a); // unknown id is a no-op
+    EXPECT_FALSE(bus.has_subscribers(EventCategory::TRACKING));
+}
+
+TEST(EventDetail, RendersEachKind) {
+    EventDetail d;
+    EXPECT_EQ(d.render(), "");
+
+    d.kind = EventDetail::Kind::TRACK;
+    d.src_id = 18;
+    d.track.track_id = 1042;
+    d.track.classification = 5;
+    d.track.threat_level = 3;
+    EXPECT_EQ(d.render(), "src_id=18 track_id=1042 class=5 threat=3");
+
+    d.kind = EventDetail::Kind::SEQUENCE;
+    d.seq.expected = 10;
+    d.seq.actual = 13;
+    d.seq.gap = 3;
+    EXPECT_EQ(d.render(), "src_id=18 expected=10 actual=13 gap=3");
+    d.seq.gap = 0;
+    EXPECT_EQ(d.render(), "src_id=18 expected=10 actual=13");
+
+    d.kind = EventDetail::Kind::FRAME_ERROR;
+    d.frame_error.error = "TRUNCATED";
+    d.frame_error.frame_len = 30;
+    EXPECT_EQ(d.render(), "error=TRUNCATED len=30");
+
+    d.kind = EventDetail::Kind::HEARTBEAT;
+    d.heartbeat.subsystem_id = 2;
+    d.heartbeat.state = 1;
+    d.heartbeat.cpu_pct = 95;
+    d.heartbeat.mem_pct = 40;
+    EXPECT_EQ(d.render(), "subsystem=2 state=1 cpu=95% mem=40%");
+
+    d.kind = EventDetail::Kind::COALESCED;
+    d.src_id = 7;
+    d.coalesced.count = 147;
+    d.coalesced.amount = 147;
+    d.coalesced.window_ms = 1000;
+    EXPECT_EQ(d.render(), "src_id=7 suppressed=147 window_ms=1000");
+    d.coalesced.amount = 900;
+    EXPECT_EQ(d.render(), "src_id=7 suppressed=147 total=900 window_ms=1000");
+}
+
+TEST(EventBus, StructuredDetailDeliveredAndRenderedOnDemand) {
+    EventBus bus;
+    EventRecord received{};
+    bus.subscribe(EventCategory::TRACKING, [&](const EventRecord& e) { received = e; });
+
+    EventRecord sent{};
+    sent.id = EventId::EVT_TRACK_NEW;
+    sent.category = EventCategory::TRACKING;
+    sent.fields.kind = EventDetail::Kind::PLOT;
+    sent.fields.src_id = 7;
+    sent.fields.plot.plot_id = 99;
+    sent.fields.plot.range_m = 5000;
+    bus.publish(sent);
+
+    EXPECT_TRUE(received.detail.empty());
+    EXPECT_EQ(received.fields.plot.plot_id, 99u);
+    EXPECT_EQ(received.detail_text(), "src_id=7 plot_id=99 range=5000m");
+}
+
+TEST(EventBus, AsyncSubscriberDeliversOnDispatcherThread) {
+    EventBus bus;
+    std::atomic<int> count{0};
+    std::thread::id publisher = std::this_thread::get_id();
+    std::atomic<bool> other_thread{true};
+    auto id = bus.subscribe_async(EventCategory::TRACKING, [&](const EventRecord& e) {
+        if (std::this_thread::get_id() == publisher)
+            other_thread = false;
+        EXPECT_EQ(e.category, EventCategory::TRACKING);
+        count++;
+    });
+    bus.publish(make_event(EventCategory::TRACKING, EventId::EVT_TRACK_NEW));
+    bus.publish(make_event(EventCategory::NETWORK, EventId::EVT_SEQ_GAP));
+    bus.publish(make_event(EventCategory::TRACKING, EventId::EVT_TRACK_UPDATE));
+    bus.flush();
+
+    EXPECT_EQ(count.load(), 2);
+    EXPECT_TRUE(other_thread.load());
+    SubscriberStats st;
+    ASSERT_TRUE(bus.subscriber_stats(id, st));
+    EXPECT_EQ(st.delivered, 2u);
+    EXPECT_EQ(st.dropped, 0u);
+    EXPECT_EQ(st.queued, 0u);
+}
+
+TEST(EventBus, SlowAsyncSubscriberDropsWithoutBlockingPublisher) {
+    EventBus bus;
+    std::atomic<bool> release{false};
+    std::atomic<int> sync_count{0};
+    auto slow = bus.subscribe_all_async([&](const EventRecord&) {
+        while (!release.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, AsyncOptions{4, EventOverflow::DROP});
+    bus.subscribe_all([&](const EventRecord&) { sync_count++; });
+
+    for (int i = 0; i < 100; ++i)
+        bus.publish(make_event(EventCategory::HEALTH, EventId::EVT_HEARTBEAT_OK));
+    EXPECT_EQ(sync_count.load(), 100) << "the publisher must not wait for the slow subscriber";
+
+    release = true;
+    bus.flush();
+    SubscriberStats st;
+    ASSERT_TRUE(bus.subscriber_stats(slow, st));
+    EXPECT_GT(st.dropped, 0u);
+    EXPECT_EQ(st.delivered + st.dropped, 100u);
+}
+
+TEST(EventBus, DroppingAsyncSubscriberWithRoomLosesNothing) {
+    // Publishers on several threads, fewer events than the queue holds: a
+    // drop could only be a push that lost a race, not a full queue
+    EventBus bus;
+    constexpr int publishers = 4;
+    constexpr int per_publisher = 1000;
+    std::atomic<int> delivered{0};
+    auto id = bus.subscribe_all_async([&](const EventRecord&) { delivered++; },
+        AsyncOptions{publishers * per_publisher, EventOverflow::DROP});
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < publishers; ++p) {
+        threads.emplace_back([&bus]() {
+            for (int i = 0; i < per_publisher; ++i)
+                bus.publish(make_event(EventCategory::NETWORK, EventId::EVT_SEQ_GAP));
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    bus.flush();
+
+    SubscriberStats st;
+    ASSERT_TRUE(bus.subscriber_stats(id, st));
+    EXPECT_EQ(st.dropped, 0u);
+    EXPECT_EQ(delivered.load(), publishers * per_publisher);
+}
+
+TEST(EventBus, BlockingAsyncSubscriberLosesNothing) {
+    EventBus bus;
+    std::vector<uint64_t> seen;
+    auto id = bus.subscribe_async(EventCategory::NETWORK, [&](const EventRecord& e) {
+        seen.push_back(e.timestamp_ns);
+    }, AsyncOptions{8, EventOverflow::BLOCK});
+
+    for (uint64_t i = 0; i < 1000; ++i)
+        bus.publish(EventRecord{EventId::EVT_SEQ_GAP, EventCategory::NETWORK, Severity::INFO, i, ""});
+    bus.flush();
+
+    ASSERT_EQ(seen.size(), 1000u);
+    for (uint64_t i = 0; i < seen.size(); ++i)
+        EXPECT_EQ(seen[i], i);
+    SubscriberStats st;
+    ASSERT_TRUE(bus.subscriber_stats(id, st));
+    EXPECT_EQ(st.dropped, 0u);
+}
+
+TEST(EventBus, UnsubscribeAsyncDrainsQueue) {
+    EventBus bus;
+    std::atomic<int> count{0};
+    auto id = bus.subscribe_all_async([&](const EventRecord&) { count++; });
+    for (int i = 0; i < 50; ++i)
+        bus.publish(make_event(EventCategory::IFF, EventId::EVT_IFF_FOE));
+    bus.unsubscribe(id);
+
+    EXPECT_EQ(count.load(), 50);
+    EXPECT_FALSE(bus.has_subscribers(EventCategory::IFF));
+    SubscriberStats st;
+    EXPECT_FALSE(bus.subscriber_stats(id, st));
+}
+
+TEST(EventBus, AsyncSubscriberMayUnsubscribeItself) {
+    EventBus bus;
+    std::atomic<uint32_t> id{0};
+    std::atomic<int> count{0};
+    id = bus.subscribe_all_async([&](const EventRecord&) {
+        if (count++ == 0)
+            bus.unsubscribe(id.load());
+    });
+    bus.publish(make_event(EventCategory::IFF, EventId::EVT_IFF_FOE));
+    for (int i = 0; i < 100 && bus.has_subscribers(EventCategory::IFF); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_FALSE(bus.has_subscribers(EventCategory::IFF));
+    EXPECT_EQ(count.load(), 1);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "gateway/event_coalescer.h"
+#include <vector>
+
+using namespace nng;
+
+namespace {
+constexpr uint64_t MS = 1000000ULL;
+}
+
+TEST(EventCoalescer, BurstPassesThenSuppresses) {
+    EventCoalescer c(1000 * MS, 3);
+    CoalescedEvents summary;
+    int passed = 0;
+    for (int i = 0; i < 10; ++i)
+        passed += c.admit(EventId::EVT_SEQ_GAP, 7, 2, 100 * MS + i, summary) ? 1 : 0;
+    EXPECT_EQ(passed, 3);
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_EQ(c.suppressed_total(), 7u);
+}
+
+TEST(EventCoalescer, NextWindowReportsSummaryFirst) {
+    EventCoalescer c(1000 * MS, 1);
+    CoalescedEvents summary;
+    EXPECT_TRUE(c.admit(EventId::EVT_SEQ_GAP, 7, 4, 0 + 1, summary));
+    EXPECT_FALSE(c.admit(EventId::EVT_SEQ_GAP, 7, 5, 10 * MS, summary));
+    EXPECT_FALSE(c.admit(EventId::EVT_SEQ_GAP, 7, 6, 20 * MS, summary));
+
+    EXPECT_TRUE(c.admit(EventId::EVT_SEQ_GAP, 7, 1, 1001 * MS, summary));
+    EXPECT_EQ(summary.count, 2u);
+    EXPECT_EQ(summary.amount, 11u);
+    EXPECT_EQ(summary.id, EventId::EVT_SEQ_GAP);
+    EXPECT_EQ(summary.src_id, 7);
+    EXPECT_EQ(summary.window_ns, 1000 * MS);
+
+    // Already reported: a flush has nothing left to say
+    std::vector<CoalescedEvents> out;
+    c.flush(5000 * MS, out);
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(EventCoalescer, FlushEmitsClosedWindowsOnly) {
+    EventCoalescer c(1000 * MS, 0);
+    CoalescedEvents summary;
+    c.admit(EventId::EVT_CRC_FAIL, 0, 1, 1, summary);
+    c.admit(EventId::EVT_CRC_FAIL, 0, 1, 2, summary);
+    c.admit(EventId::EVT_SEQ_REORDER, 9, 1, 500 * MS, summary);
+    EXPECT_EQ(c.next_flush_ns(), 1000 * MS + 1);
+
+    std::vector<CoalescedEvents> out;
+    c.flush(999 * MS, out);
+    EXPECT_TRUE(out.empty());
+
+    c.flush(1200 * MS, out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].id, EventId::EVT_CRC_FAIL);
+    EXPECT_EQ(out[0].count, 2u);
+    EXPECT_EQ(c.next_flush_ns(), 1500 * MS);
+
+    out.clear();
+    c.flush_all(out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].id, EventId::EVT_SEQ_REORDER);
+    EXPECT_EQ(out[0].src_id, 9);
+}
+
+TEST(EventCoalescer, KeysAreIndependent) {
+    EventCoalescer c(1000 * MS, 1);
+    CoalescedEvents summary;
+    EXPECT_TRUE(c.admit(EventId::EVT_SEQ_GAP, 1, 1, 1, summary));
+    EXPECT_TRUE(c.admit(EventId::EVT_SEQ_GAP, 2, 1, 1, summary));
+    EXPECT_TRUE(c.admit(EventId::EVT_SEQ_REORDER, 1, 1, 1, summary));
+    EXPECT_FALSE(c.admit(EventId::EVT_SEQ_GAP, 1, 1, 2, summary));
+}
+
+TEST(EventCoalescer, OtherEventsAndDisabledAlwaysPass) {
+    EventCoalescer c(1000 * MS, 0);
+    CoalescedEvents summary;
+    EXPECT_TRUE(c.admit(EventId::EVT_SOURCE_ONLINE, 1, 1, 1, summary));
+    EXPECT_TRUE(c.admit(EventId::EVT_TRACK_NEW, 1, 1, 1, summary));
+
+    EventCoalescer off(0, 0);
+    EXPECT_FALSE(off.enabled());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_TRUE(off.admit(EventId::EVT_SEQ_GAP, 1, 1, i, summary));
+    EXPECT_EQ(off.suppressed_total(), 0u);
+}
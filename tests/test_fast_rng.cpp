@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "sensor_sim/fast_rng.h"
+#include <cmath>
+#include <vector>
+
+using namespace nng;
+
+TEST(FastRng, SameSeedSameStream) {
+    FastRng a(42), b(42), c(43);
+    bool differs = false;
+    for (int i = 0; i < 1000; ++i) {
+        uint64_t x = a();
+        EXPECT_EQ(x, b());
+        differs |= x != c();
+    }
+    EXPECT_TRUE(differs);
+
+    a.seed(7);
+    b.seed(7);
+    EXPECT_EQ(a(), b());
+}
+
+TEST(FastRng, UniformInRange) {
+    FastRng rng(1);
+    double sum = 0.0;
+    const int n = 100000;
+    for (int i = 0; i < n; ++i) {
+        double u = rng.uniform01();
+        ASSERT_GE(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        sum += u;
+    }
+    EXPECT_NEAR(sum / n, 0.5, 0.01);
+
+    std::vector<int> hits(7, 0);
+    for (int i = 0; i < 70000; ++i) {
+        int v = rng.uniform_int(10, 16);
+        ASSERT_GE(v, 10);
+        ASSERT_LE(v, 16);
+        hits[static_cast<std::size_t>(v - 10)]++;
+    }
+    for (int h : hits)
+        EXPECT_NEAR(h, 10000, 500);
+}
+
+TEST(FastRng, NormalMoments) {
+    FastRng rng(2);
+    std::vector<double> z(200000);
+    rng.fill_normal(z.data(), z.size());
+    double sum = 0.0, sq = 0.0;
+    std::size_t beyond_3 = 0, beyond_r = 0;
+    for (double v : z) {
+        ASSERT_TRUE(std::isfinite(v));
+        sum += v;
+        sq += v * v;
+        beyond_3 += std::fabs(v) > 3.0;
+        beyond_r += std::fabs(v) > 3.45; // past the ziggurat's tail start
+    }
+    double mean = sum / z.size();
+    EXPECT_NEAR(mean, 0.0, 0.01);
+    EXPECT_NEAR(sq / z.size() - mean * mean, 1.0, 0.02);
+    // P(|z| > 3) = 0.27%, P(|z| > 3.45) = 0.056%
+    EXPECT_NEAR(static_cast<double>(beyond_3) / z.size(), 0.0027, 0.0006);
+    EXPECT_GT(beyond_r, 60u);
+    EXPECT_LT(beyond_r, 170u);
+}
+
+TEST(FastRng, BatchIsDrawOrder) {
+    FastRng a(3), b(3);
+    double batch[7];
+    a.fill_normal(batch, 7);
+    for (double v : batch)
+        EXPECT_EQ(v, b.normal());
+}
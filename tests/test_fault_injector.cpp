@@ -169,3 +169,84 @@ TEST(FaultInjector, StatsResetEachApply) {
     fi.apply(frames2);
     EXPECT_EQ(fi.last_stats().dropped, 5u) << "Stats should reset between apply calls";
 }
+
+TEST(FaultInjector, ArenaMatchesVectorApply) {
+    FaultConfig cfg;
+    cfg.loss_pct = 20.0;
+    cfg.reorder_pct = 30.0;
+    cfg.duplicate_pct = 25.0;
+    cfg.corrupt_pct = 15.0;
+    FaultInjector by_vector(cfg, 7);
+    FaultInjector by_arena(cfg, 7);
+
+    FrameArena arena;
+    std::vector<FrameView> out;
+    for (int tick = 0; tick < 10; ++tick) {
+        auto frames = make_frames(200);
+        arena.clear();
+        for (const auto& f : frames)
+            std::copy(f.begin(), f.end(), arena.append(f.size()));
+
+        by_vector.apply(frames);
+        by_arena.apply(arena, out);
+
+        ASSERT_EQ(out.size(), frames.size());
+        for (std::size_t i = 0; i < out.size(); ++i)
+            EXPECT_EQ(std::vector<uint8_t>(out[i].data, out[i].data + out[i].len), frames[i]);
+        EXPECT_EQ(by_arena.last_stats().dropped, by_vector.last_stats().dropped);
+        EXPECT_EQ(by_arena.last_stats().duplicated, by_vector.last_stats().duplicated);
+        EXPECT_EQ(by_arena.last_stats().reordered, by_vector.last_stats().reordered);
+        EXPECT_EQ(by_arena.last_stats().corrupted, by_vector.last_stats().corrupted);
+    }
+}
+
+TEST(FaultInjector, ArenaSendsPointIntoArena) {
+    FaultConfig cfg;
+    cfg.duplicate_pct = 100.0;
+    FaultInjector fi(cfg, 42);
+
+    FrameArena arena;
+    for (const auto& f : make_frames(20))
+        std::copy(f.begin(), f.end(), arena.append(f.size()));
+    std::vector<FrameView> out;
+    fi.apply(arena, out);
+
+    // Every frame sent twice, both times straight from its arena bytes
+    ASSERT_EQ(out.size(), 40u);
+    std::vector<int> sends(20, 0);
+    for (const auto& v : out) {
+        bool found = false;
+        for (std::size_t i = 0; i < arena.size(); ++i) {
+            if (v.data == arena.data(i) && v.len == arena.length(i)) {
+                sends[i]++;
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found);
+    }
+    for (int n : sends)
+        EXPECT_EQ(n, 2);
+}
+
+TEST(FaultInjector, FastRngModeAppliesFaults) {
+    FaultConfig cfg;
+    cfg.loss_pct = 100.0;
+    FaultInjector all_lost(cfg, 42, RngMode::FAST);
+    auto frames = make_frames(50);
+    all_lost.apply(frames);
+    EXPECT_TRUE(frames.empty());
+
+    cfg.loss_pct = 30.0;
+    cfg.duplicate_pct = 20.0;
+    cfg.reorder_pct = 20.0;
+    cfg.corrupt_pct = 10.0;
+    FaultInjector a(cfg, 5, RngMode::FAST), b(cfg, 5, RngMode::FAST);
+    auto fa = make_frames(1000), fb = make_frames(1000);
+    a.apply(fa);
+    b.apply(fb);
+    EXPECT_EQ(fa, fb);
+    EXPECT_GT(a.last_stats().dropped, 250u);
+    EXPECT_LT(a.last_stats().dropped, 450u);
+    EXPECT_GT(a.last_stats().duplicated, 0u);
+    EXPECT_GT(a.last_stats().corrupted, 0u);
+}
@@ -0,0 +1,214 @@
+#include "gateway/frame_forwarder.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "gateway/telemetry_parser.h"
+#include "gateway/udp_socket.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+// Keeps every datagram it is handed
+class CaptureSink : public IFrameSink {
+public:
+    explicit CaptureSink(std::vector<std::vector<uint8_t>>& out) : out_(out) {}
+    bool send(const std::vector<uint8_t>& buf) override {
+        out_.push_back(buf);
+        return true;
+    }
+
+private:
+    std::vector<std::vector<uint8_t>>& out_;
+};
+
+TelemetryHeader header(MsgType type, uint16_t src_id, uint32_t seq, uint16_t payload_len) {
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(type);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.ts_ns = 1000 + seq;
+    hdr.payload_len = payload_len;
+    return hdr;
+}
+
+std::vector<uint8_t> track_frame(uint16_t src_id, uint32_t seq) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(TrackPayload));
+    serialize_header(header(MsgType::TRACK, src_id, seq, sizeof(TrackPayload)), buf.data());
+    TrackPayload t{};
+    t.track_id = seq;
+    std::memcpy(buf.data() + FRAME_HEADER_SIZE, &t, sizeof(t));
+    return buf;
+}
+
+// Every frame of the datagrams, checked as the gateway would
+ParsedFrameBatch parse_all(const std::vector<std::vector<uint8_t>>& datagrams) {
+    std::vector<FrameView> views;
+    for (const auto& d : datagrams)
+        views.push_back(FrameView{d.data(), d.size()});
+    ParsedFrameBatch parsed;
+    parse_frames(views.data(), views.size(), true, parsed);
+    return parsed;
+}
+
+} // anonymous namespace
+
+TEST(FrameForwarderTest, PacksFramesIntoContainers) {
+    std::vector<std::vector<uint8_t>> sent;
+    FrameForwarder fwd(CONTAINER_MAX_DATAGRAM, true, nullptr);
+    fwd.add_sink(std::make_unique<CaptureSink>(sent));
+
+    uint8_t payload[sizeof(TrackPayload)] = {};
+    for (uint32_t i = 0; i < 200; ++i) {
+        std::memcpy(payload, &i, sizeof(i));
+        ASSERT_TRUE(fwd.add(header(MsgType::TRACK, 3, i, sizeof(payload)), payload));
+    }
+    EXPECT_TRUE(sent.empty()); // nothing goes out before flush()
+    fwd.flush();
+
+    // 43-byte frames: 34 fill a 1472-byte container exactly
+    ASSERT_EQ(sent.size(), 6u);
+    for (const auto& d : sent) {
+        EXPECT_TRUE(is_container(d.data(), d.size()));
+        EXPECT_LE(d.size(), CONTAINER_MAX_DATAGRAM);
+    }
+    ParsedFrameBatch parsed = parse_all(sent);
+    ASSERT_EQ(parsed.count, 200u);
+    EXPECT_EQ(parsed.error_count, 0u);
+    for (uint32_t i = 0; i < 200; ++i) {
+        EXPECT_EQ(parsed.headers[i].seq, i);
+        EXPECT_EQ(parsed.headers[i].src_id, 3);
+        uint32_t id = 0;
+        std::memcpy(&id, parsed.payload_ptrs[i], sizeof(id));
+        EXPECT_EQ(id, i);
+    }
+
+    ForwardStats s = fwd.stats();
+    EXPECT_EQ(s.frames, 200u);
+    EXPECT_EQ(s.datagrams, 6u);
+    EXPECT_EQ(s.send_failures, 0u);
+
+    // Flushing with nothing queued sends nothing
+    fwd.flush();
+    EXPECT_EQ(sent.size(), 6u);
+}
+
+TEST(FrameForwarderTest, FlushesOnItsOwnWhenFull) {
+    std::vector<std::vector<uint8_t>> sent;
+    FrameForwarder fwd(64, false, nullptr); // one 43-byte frame per container
+    fwd.add_sink(std::make_unique<CaptureSink>(sent));
+    uint8_t payload[sizeof(TrackPayload)] = {};
+    for (uint32_t i = 0; i <= FrameForwarder::MAX_PENDING; ++i)
+        fwd.add(header(MsgType::TRACK, 1, i, sizeof(payload)), payload);
+    EXPECT_EQ(sent.size(), FrameForwarder::MAX_PENDING);
+    fwd.flush();
+    ASSERT_EQ(sent.size(), FrameForwarder::MAX_PENDING + 1);
+    EXPECT_EQ(parse_all(sent).count, FrameForwarder::MAX_PENDING + 1);
+}
+
+TEST(FrameForwarderTest, FilterAndEverySink) {
+    IngressFilter filter;
+    ASSERT_TRUE(filter.set("type=TRACK;src=1-2"));
+    std::vector<std::vector<uint8_t>> a, b;
+    FrameForwarder fwd(CONTAINER_MAX_DATAGRAM, true, &filter);
+    fwd.add_sink(std::make_unique<CaptureSink>(a));
+    fwd.add_sink(std::make_unique<CaptureSink>(b));
+
+    uint8_t payload[sizeof(TrackPayload)] = {};
+    EXPECT_TRUE(fwd.add(header(MsgType::TRACK, 1, 0, sizeof(TrackPayload)), payload));
+    EXPECT_FALSE(fwd.add(header(MsgType::PLOT, 1, 1, sizeof(PlotPayload)), payload));
+    EXPECT_FALSE(fwd.add(header(MsgType::TRACK, 9, 0, sizeof(TrackPayload)), payload));
+    EXPECT_TRUE(fwd.add(header(MsgType::TRACK, 2, 0, sizeof(TrackPayload)), payload));
+    fwd.flush();
+
+    EXPECT_EQ(a, b);
+    ParsedFrameBatch parsed = parse_all(a);
+    ASSERT_EQ(parsed.count, 2u);
+    EXPECT_EQ(parsed.headers[0].src_id, 1);
+    EXPECT_EQ(parsed.headers[1].src_id, 2);
+    ForwardStats s = fwd.stats();
+    EXPECT_EQ(s.frames, 2u);
+    EXPECT_EQ(s.filtered, 2u);
+    EXPECT_EQ(s.datagrams, 2u); // one container, two sinks
+}
+
+TEST(FrameForwarderTest, ParseTarget) {
+    std::string host;
+    uint16_t port = 0;
+    EXPECT_TRUE(parse_forward_target("239.1.2.3:6000", host, port));
+    EXPECT_EQ(host, "239.1.2.3");
+    EXPECT_EQ(port, 6000);
+    EXPECT_FALSE(parse_forward_target("239.1.2.3", host, port));
+    EXPECT_FALSE(parse_forward_target(":6000", host, port));
+    EXPECT_FALSE(parse_forward_target("127.0.0.1:", host, port));
+    EXPECT_FALSE(parse_forward_target("127.0.0.1:0", host, port));
+    EXPECT_FALSE(parse_forward_target("127.0.0.1:70000", host, port));
+    EXPECT_FALSE(parse_forward_target("127.0.0.1:60x", host, port));
+
+    ForwardOptions options;
+    options.targets = {"127.0.0.1:6000", "not-an-address:6000"};
+    ForwardHub hub(options);
+    std::string error;
+    EXPECT_FALSE(hub.set_writers(1, &error));
+    EXPECT_EQ(error, "not-an-address:6000");
+    EXPECT_EQ(hub.writers(), 0u);
+}
+
+TEST(FrameForwarderTest, GatewayForwardsValidatedFrames) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    UdpFrameSource downstream;
+    const uint16_t port = 19911;
+    ASSERT_TRUE(downstream.bind(port));
+    downstream.set_timeout_ms(20);
+
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    config.forward.targets = {"127.0.0.1:" + std::to_string(port)};
+
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    // 50 frames, then a duplicate and a corrupt one: neither goes downstream
+    for (uint32_t i = 0; i < 50; ++i)
+        channel.sink().send(track_frame(5, i));
+    channel.sink().send(track_frame(5, 49));
+    channel.sink().send(std::vector<uint8_t>{1, 2, 3});
+
+    std::vector<std::vector<uint8_t>> received;
+    FrameBatch batch(64);
+    for (int i = 0; i < 100 && parse_all(received).count < 50; ++i) {
+        std::size_t n = downstream.receive_batch(batch);
+        for (std::size_t k = 0; k < n; ++k)
+            received.emplace_back(batch[k].data, batch[k].data + batch[k].len);
+    }
+    // Anything further would have arrived by now
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::size_t n = downstream.receive_batch(batch);
+    for (std::size_t k = 0; k < n; ++k)
+        received.emplace_back(batch[k].data, batch[k].data + batch[k].len);
+
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    ParsedFrameBatch parsed = parse_all(received);
+    ASSERT_EQ(parsed.count, 50u);
+    for (uint32_t i = 0; i < 50; ++i)
+        EXPECT_EQ(parsed.headers[i].seq, i);
+    ForwardStats s = gateway.forwarding().stats();
+    EXPECT_EQ(s.frames, 50u);
+    EXPECT_EQ(s.datagrams, received.size());
+}
@@ -1,8 +1,12 @@
 #include "gateway/frame_recorder.h"
+#include "gateway/recording_reader.h"
+#include "common/protocol.h"
 #include <gtest/gtest.h>
 #include <fstream>
 #include <cstdio>
 #include <vector>
+#include <cstring>
+#include <unistd.h>
 
 using namespace nng;
 
@@ -81,39 +85,27 @@ TEST_F(FrameRecorderTest, ReadBackRecordedFrames) {
     }
 
     // Read back and verify
-    std::ifstream file(test_file_, std::ios::binary);
-    ASSERT_TRUE(file.is_open());
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(test_file_));
+    EXPECT_TRUE(reader.is_chunked());
 
     int frame_count = 0;
-    while (file.good()) {
-        uint64_t ts;
-        file.read(reinterpret_cast<char*>(&ts), sizeof(ts));
-        if (!file.good()) break;
-
-        uint32_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        if (!file.good()) break;
-
-        std::vector<uint8_t> data(len);
-        if (len > 0) {
-            file.read(reinterpret_cast<char*>(data.data()), len);
-            if (!file.good()) break;
-        }
-
+    RecordedFrame f;
+    while (reader.next(f)) {
         frame_count++;
 
         if (frame_count == 1) {
-            EXPECT_EQ(ts, 1000u);
-            EXPECT_EQ(len, 3u);
-            EXPECT_EQ(data[0], 0x01);
-            EXPECT_EQ(data[1], 0x02);
-            EXPECT_EQ(data[2], 0x03);
+            EXPECT_EQ(f.rx_ts_ns, 1000u);
+            EXPECT_EQ(f.len, 3u);
+            EXPECT_EQ(f.data[0], 0x01);
+            EXPECT_EQ(f.data[1], 0x02);
+            EXPECT_EQ(f.data[2], 0x03);
         } else if (frame_count == 2) {
-            EXPECT_EQ(ts, 2000u);
-            EXPECT_EQ(len, 4u);
+            EXPECT_EQ(f.rx_ts_ns, 2000u);
+            EXPECT_EQ(f.len, 4u);
         } else if (frame_count == 3) {
-            EXPECT_EQ(ts, 3000u);
-            EXPECT_EQ(len, 2u);
+            EXPECT_EQ(f.rx_ts_ns, 3000u);
+            EXPECT_EQ(f.len, 2u);
         }
     }
 
@@ -140,16 +132,12 @@ TEST_F(FrameRecorderTest, RecordEmptyFrame) {
     recorder.close();
 
     // Read back
-    std::ifstream file(test_file_, std::ios::binary);
-    ASSERT_TRUE(file.is_open());
-
-    uint64_t ts;
-    file.read(reinterpret_cast<char*>(&ts), sizeof(ts));
-    EXPECT_EQ(ts, 1000u);
-
-    uint32_t len;
-    file.read(reinterpret_cast<char*>(&len), sizeof(len));
-    EXPECT_EQ(len, 0u);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(test_file_));
+    RecordedFrame f;
+    ASSERT_TRUE(reader.next(f));
+    EXPECT_EQ(f.rx_ts_ns, 1000u);
+    EXPECT_EQ(f.len, 0u);
 }
 
 TEST_F(FrameRecorderTest, OpenOverwritesExisting) {
@@ -175,22 +163,278 @@ TEST_F(FrameRecorderTest, OpenOverwritesExisting) {
     }
 
     // Verify only one frame in file
-    std::ifstream file(test_file_, std::ios::binary);
-    ASSERT_TRUE(file.is_open());
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(test_file_));
+    RecordedFrame f;
+    ASSERT_TRUE(reader.next(f));
+    EXPECT_EQ(f.rx_ts_ns, 9999u);
+    ASSERT_EQ(f.len, 1u);
+    EXPECT_EQ(f.data[0], 0xAA);
+
+    // No more frames
+    EXPECT_FALSE(reader.next(f));
+}
+
+namespace {
 
+struct ReadFrame {
     uint64_t ts;
-    file.read(reinterpret_cast<char*>(&ts), sizeof(ts));
-    EXPECT_EQ(ts, 9999u);
+    std::vector<uint8_t> data;
+};
 
-    uint32_t len;
-    file.read(reinterpret_cast<char*>(&len), sizeof(len));
-    EXPECT_EQ(len, 1u);
+std::vector<ReadFrame> read_frames(const std::string& path) {
+    std::vector<ReadFrame> frames;
+    RecordingReader reader;
+    if (!reader.open(path))
+        return frames;
+    RecordedFrame f;
+    while (reader.next(f))
+        frames.push_back(ReadFrame{f.rx_ts_ns, std::vector<uint8_t>(f.data, f.data + f.len)});
+    return frames;
+}
 
-    uint8_t byte;
-    file.read(reinterpret_cast<char*>(&byte), 1);
-    EXPECT_EQ(byte, 0xAA);
+std::vector<uint8_t> pattern(std::size_t len, uint8_t seed) {
+    std::vector<uint8_t> v(len);
+    for (std::size_t i = 0; i < len; ++i)
+        v[i] = static_cast<uint8_t>(seed + i * 7);
+    return v;
+}
 
-    // No more frames
-    file.read(reinterpret_cast<char*>(&ts), sizeof(ts));
-    EXPECT_FALSE(file.good());
+} // anonymous namespace
+
+TEST_F(FrameRecorderTest, FramesSpanManyBlocks) {
+    RecorderOptions opts;
+    opts.block_bytes = 4096; // raised to MIN_BLOCK_BYTES
+    opts.block_count = 2;    // record() has to wait for the writer
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+
+    constexpr int N = 20000;
+    for (int i = 0; i < N; ++i) {
+        auto data = pattern(static_cast<std::size_t>(i % 300), static_cast<uint8_t>(i));
+        ASSERT_TRUE(recorder.record(static_cast<uint64_t>(i), data.data(), data.size()));
+    }
+    recorder.close();
+    EXPECT_GT(recorder.blocks_written(), 10u);
+    EXPECT_EQ(recorder.dropped_frames(), 0u);
+    EXPECT_EQ(recorder.write_errors(), 0u);
+
+    auto frames = read_frames(test_file_);
+    ASSERT_EQ(frames.size(), static_cast<std::size_t>(N));
+    for (int i = 0; i < N; ++i) {
+        ASSERT_EQ(frames[i].ts, static_cast<uint64_t>(i));
+        ASSERT_EQ(frames[i].data, pattern(static_cast<std::size_t>(i % 300), static_cast<uint8_t>(i)));
+    }
+}
+
+TEST_F(FrameRecorderTest, FrameLargerThanChunkIsDropped) {
+    FrameRecorder recorder;
+    RecorderOptions opts;
+    opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+    auto big = pattern(FrameRecorder::MIN_BLOCK_BYTES, 9);
+    EXPECT_FALSE(recorder.record(42, big.data(), big.size()));
+    EXPECT_EQ(recorder.dropped_frames(), 1u);
+
+    auto max = pattern(65535, 3); // any datagram fits
+    EXPECT_TRUE(recorder.record(43, max.data(), max.size()));
+    recorder.close();
+
+    auto frames = read_frames(test_file_);
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].ts, 43u);
+    EXPECT_EQ(frames[0].data, max);
+}
+
+TEST_F(FrameRecorderTest, DirectIoAndPreallocation) {
+    RecorderOptions opts;
+    opts.block_bytes = 8192;
+    opts.direct_io = true; // falls back to buffered where unsupported
+    opts.preallocate_bytes = 1 << 20;
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+    for (int i = 0; i < 1000; ++i) {
+        auto data = pattern(50, static_cast<uint8_t>(i));
+        ASSERT_TRUE(recorder.record(static_cast<uint64_t>(i), data.data(), data.size()));
+    }
+    recorder.close();
+
+    // Preallocation must not leave a zero-filled tail after the trailer
+    std::ifstream file(test_file_, std::ios::binary | std::ios::ate);
+    file.seekg(-static_cast<std::streamoff>(sizeof(RecordingTrailer)), std::ios::end);
+    RecordingTrailer t{};
+    file.read(reinterpret_cast<char*>(&t), sizeof(t));
+    EXPECT_EQ(t.magic, TRAILER_MAGIC);
+    EXPECT_EQ(read_frames(test_file_).size(), 1000u);
+}
+
+TEST_F(FrameRecorderTest, DropWhenFullIsCounted) {
+    RecorderOptions opts;
+    opts.block_bytes = 4096;
+    opts.block_count = 2;
+    opts.drop_when_full = true;
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+
+    constexpr uint64_t N = 20000;
+    auto data = pattern(200, 1);
+    uint64_t accepted = 0;
+    for (uint64_t i = 0; i < N; ++i)
+        accepted += recorder.record(i, data.data(), data.size()) ? 1 : 0;
+    recorder.close();
+
+    EXPECT_EQ(accepted, recorder.frame_count());
+    EXPECT_EQ(recorder.frame_count() + recorder.dropped_frames(), N);
+    EXPECT_EQ(recorder.stalls(), 0u);
+    EXPECT_EQ(read_frames(test_file_).size(), recorder.frame_count());
+}
+
+TEST_F(FrameRecorderTest, ReopenStartsFresh) {
+    FrameRecorder recorder;
+    uint8_t frame[] = {1, 2, 3};
+    ASSERT_TRUE(recorder.open(test_file_));
+    recorder.record(1, frame, sizeof(frame));
+    ASSERT_TRUE(recorder.open(test_file_)); // closes and truncates
+    EXPECT_EQ(recorder.frame_count(), 0u);
+    recorder.record(2, frame, sizeof(frame));
+    recorder.close();
+    auto frames = read_frames(test_file_);
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].ts, 2u);
+}
+
+TEST_F(FrameRecorderTest, ChunkIndexDescribesChunks) {
+    RecorderOptions opts;
+    opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES;
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+
+    // 1000 frames of 1 KiB from sources 1..4, then one from src 3000
+    std::vector<uint8_t> frame(1024, 0);
+    frame[0] = PROTOCOL_VERSION;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        uint16_t src = static_cast<uint16_t>(1 + i % 4);
+        std::memcpy(&frame[2], &src, sizeof(src));
+        ASSERT_TRUE(recorder.record(1000 + i * 10, frame.data(), frame.size()));
+    }
+    uint16_t far_src = 3000;
+    std::memcpy(&frame[2], &far_src, sizeof(far_src));
+    ASSERT_TRUE(recorder.record(20000, frame.data(), frame.size()));
+    recorder.close();
+
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(test_file_));
+    const auto& chunks = reader.chunks();
+    ASSERT_GE(chunks.size(), 7u); // 1 MiB over ~127 KiB chunks
+    EXPECT_EQ(reader.frame_total(), 1001u);
+
+    uint64_t next_frame = 0;
+    for (const auto& c : chunks) {
+        EXPECT_EQ(c.header.magic, CHUNK_MAGIC);
+        EXPECT_EQ(c.header.first_frame, next_frame);
+        EXPECT_EQ(c.offset % 8, 0u);
+        EXPECT_LE(c.header.min_ts_ns, c.header.max_ts_ns);
+        EXPECT_EQ(c.header.min_ts_ns, 1000 + c.header.first_frame * 10);
+        EXPECT_TRUE(chunk_may_contain(c.header, 1));
+        EXPECT_TRUE(chunk_may_contain(c.header, 4));
+        EXPECT_FALSE(chunk_may_contain(c.header, 5));
+        next_frame += c.header.frame_count;
+    }
+    EXPECT_TRUE(chunk_may_contain(chunks.back().header, 3000));
+    EXPECT_EQ(chunks.back().header.max_ts_ns, 20000u);
+}
+
+TEST_F(FrameRecorderTest, ReaderRebuildsMissingIndex) {
+    RecorderOptions opts;
+    opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES;
+    {
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(test_file_, opts));
+        auto data = pattern(1000, 5);
+        for (uint64_t i = 0; i < 500; ++i)
+            ASSERT_TRUE(recorder.record(i, data.data(), data.size()));
+        recorder.close();
+    }
+
+    // Cut off the index and trailer, as if the writer had died
+    RecordingReader full;
+    ASSERT_TRUE(full.open(test_file_));
+    uint64_t chunk_end = full.chunks().back().offset + full.chunks().back().header.disk_bytes;
+    std::size_t chunk_count = full.chunks().size();
+    full.close();
+    ASSERT_EQ(::truncate(test_file_.c_str(), static_cast<off_t>(chunk_end)), 0);
+
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(test_file_));
+    EXPECT_EQ(reader.chunks().size(), chunk_count);
+    EXPECT_EQ(read_frames(test_file_).size(), 500u);
+}
+
+TEST_F(FrameRecorderTest, Lz4ChunksRoundTripWithReadAhead) {
+    RecorderOptions opts;
+    opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES;
+    opts.codec = Codec::LZ4;
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+
+    // TRACK-like frames: same layout, a few changing fields
+    constexpr uint64_t N = 5000;
+    std::vector<uint8_t> frame(64, 0);
+    frame[0] = PROTOCOL_VERSION;
+    for (uint64_t i = 0; i < N; ++i) {
+        uint32_t seq = static_cast<uint32_t>(i);
+        std::memcpy(&frame[4], &seq, sizeof(seq));
+        ASSERT_TRUE(recorder.record(1000 + i, frame.data(), frame.size()));
+    }
+    recorder.close();
+    EXPECT_GT(recorder.raw_bytes(), 0u);
+    EXPECT_LT(recorder.stored_bytes() * 2, recorder.raw_bytes());
+
+    RecordingReader reader;
+    reader.set_read_ahead(2);
+    ASSERT_TRUE(reader.open(test_file_));
+    ASSERT_GT(reader.chunks().size(), 2u);
+    EXPECT_EQ(reader.chunks()[0].header.codec, static_cast<uint16_t>(Codec::LZ4));
+
+    RecordedFrame f;
+    for (uint64_t i = 0; i < N; ++i) {
+        ASSERT_TRUE(reader.next(f));
+        ASSERT_EQ(f.rx_ts_ns, 1000 + i);
+        ASSERT_EQ(f.len, frame.size());
+        uint32_t seq;
+        std::memcpy(&seq, f.data + 4, sizeof(seq));
+        ASSERT_EQ(seq, i);
+    }
+    EXPECT_FALSE(reader.next(f));
+
+    // Seeking backwards restarts the read-ahead behind the target chunk
+    ASSERT_TRUE(reader.seek_frame(N / 2));
+    uint64_t count = 0;
+    while (reader.next(f))
+        ASSERT_EQ(f.rx_ts_ns, 1000 + N / 2 + count++);
+    EXPECT_EQ(count, N - N / 2);
+}
+
+TEST_F(FrameRecorderTest, IncompressibleFramesRoundTrip) {
+    RecorderOptions opts;
+    opts.codec = Codec::LZ4;
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.open(test_file_, opts));
+    uint32_t x = 12345;
+    std::vector<uint8_t> data(500);
+    for (uint64_t i = 0; i < 200; ++i) {
+        for (auto& b : data) {
+            x = x * 1664525u + 1013904223u;
+            b = static_cast<uint8_t>(x >> 24);
+        }
+        ASSERT_TRUE(recorder.record(i, data.data(), data.size()));
+    }
+    recorder.close();
+    // Only the record headers compress; never stored larger than raw
+    EXPECT_LE(recorder.stored_bytes(), recorder.raw_bytes());
+    EXPECT_GT(recorder.stored_bytes() * 10, recorder.raw_bytes() * 9);
+
+    auto frames = read_frames(test_file_);
+    ASSERT_EQ(frames.size(), 200u);
+    EXPECT_EQ(frames.back().data, data);
 }
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "common/histogram.h"
+#include <cstdint>
+
+using namespace nng;
+
+TEST(Histogram, BucketsAreMonotonicAndTight) {
+    std::size_t prev = 0;
+    for (uint64_t v = 0; v < 100000; ++v) {
+        std::size_t b = HistogramLayout::bucket(v);
+        ASSERT_GE(b, prev);
+        ASSERT_LT(b, HistogramLayout::BUCKETS);
+        ASSERT_GE(HistogramLayout::upper_bound(b), v);
+        // Within 1/16 of the value
+        ASSERT_LE(HistogramLayout::upper_bound(b) - v, v / 16 + 1) << v;
+        prev = b;
+    }
+    EXPECT_EQ(HistogramLayout::bucket(7), 7u);
+    EXPECT_EQ(HistogramLayout::bucket(UINT64_MAX), HistogramLayout::BUCKETS - 1);
+}
+
+TEST(Histogram, Percentiles) {
+    Histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v)
+        h.record(v * 1000); // 1us .. 1ms
+    HistogramSnapshot s;
+    h.add_to(s);
+    EXPECT_EQ(s.count, 1000u);
+    EXPECT_EQ(s.max, 1000000u);
+
+    auto near = [](uint64_t got, uint64_t want) {
+        return got >= want && got <= want + want / 16;
+    };
+    EXPECT_TRUE(near(s.percentile(0.50), 500000)) << s.percentile(0.50);
+    EXPECT_TRUE(near(s.percentile(0.99), 990000)) << s.percentile(0.99);
+    EXPECT_EQ(s.percentile(0.999), 1000000u); // capped at the exact max
+    EXPECT_EQ(s.percentile(1.0), 1000000u);
+    EXPECT_EQ(HistogramSnapshot{}.percentile(0.5), 0u);
+}
+
+TEST(Histogram, OverflowBucketReportsMax) {
+    Histogram h;
+    h.record(100);
+    h.record(1ULL << 40);
+    HistogramSnapshot s;
+    h.add_to(s);
+    EXPECT_EQ(s.percentile(1.0), 1ULL << 40);
+}
+
+TEST(Histogram, MergeAndReset) {
+    Histogram a, b;
+    a.record(10);
+    b.record(20);
+    b.record(30);
+    a.add(b);
+    EXPECT_EQ(a.count(), 3u);
+
+    HistogramSnapshot s1, s2;
+    a.add_to(s1);
+    b.add_to(s2);
+    s1.merge(s2);
+    EXPECT_EQ(s1.count, 5u);
+    EXPECT_EQ(s1.max, 30u);
+
+    a.reset();
+    EXPECT_EQ(a.count(), 0u);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "gateway/ingress_filter.h"
+#include "common/types.h"
+#include <thread>
+#include <atomic>
+
+using namespace nng;
+
+static const uint8_t PLOT = static_cast<uint8_t>(MsgType::PLOT);
+static const uint8_t TRACK = static_cast<uint8_t>(MsgType::TRACK);
+static const uint8_t HEARTBEAT = static_cast<uint8_t>(MsgType::HEARTBEAT);
+static const uint8_t ENGAGEMENT = static_cast<uint8_t>(MsgType::ENGAGEMENT);
+
+TEST(IngressFilter, DefaultAcceptsAll) {
+    IngressFilter f;
+    EXPECT_TRUE(f.accepts_all());
+    EXPECT_EQ(f.spec(), "ALL");
+    EXPECT_TRUE(f.allows(0, PLOT));
+    EXPECT_TRUE(f.allows(0xFFFF, 0xFF));
+}
+
+TEST(IngressFilter, TypeClause) {
+    IngressFilter f;
+    ASSERT_TRUE(f.set("type=TRACK,engagement"));
+    EXPECT_FALSE(f.accepts_all());
+    EXPECT_TRUE(f.allows(1, TRACK));
+    EXPECT_TRUE(f.allows(500, ENGAGEMENT));
+    EXPECT_FALSE(f.allows(1, PLOT));
+    EXPECT_FALSE(f.allows(1, HEARTBEAT));
+}
+
+TEST(IngressFilter, SourceClauseWithRangesAndHex) {
+    IngressFilter f;
+    ASSERT_TRUE(f.set("src=1-8,12,0x20"));
+    for (uint16_t s = 1; s <= 8; ++s)
+        EXPECT_TRUE(f.allows(s, PLOT)) << s;
+    EXPECT_FALSE(f.allows(0, PLOT));
+    EXPECT_FALSE(f.allows(9, PLOT));
+    EXPECT_TRUE(f.allows(12, HEARTBEAT));
+    EXPECT_TRUE(f.allows(0x20, TRACK));
+    EXPECT_FALSE(f.allows(0xFFFF, TRACK));
+}
+
+TEST(IngressFilter, BothClausesMustMatch) {
+    IngressFilter f;
+    ASSERT_TRUE(f.set(" src = 3 ; type = 2 "));
+    EXPECT_TRUE(f.allows(3, TRACK));
+    EXPECT_FALSE(f.allows(3, PLOT));
+    EXPECT_FALSE(f.allows(4, TRACK));
+    EXPECT_EQ(f.spec(), "SRC = 3 ; TYPE = 2");
+}
+
+TEST(IngressFilter, AllAndOffResetToAcceptAll) {
+    IngressFilter f;
+    ASSERT_TRUE(f.set("type=PLOT"));
+    ASSERT_TRUE(f.set("off"));
+    EXPECT_TRUE(f.accepts_all());
+    ASSERT_TRUE(f.set("type=PLOT"));
+    ASSERT_TRUE(f.set(""));
+    EXPECT_TRUE(f.allows(1, TRACK));
+    EXPECT_EQ(f.spec(), "ALL");
+}
+
+TEST(IngressFilter, InvalidSpecKeepsRules) {
+    IngressFilter f;
+    ASSERT_TRUE(f.set("type=TRACK"));
+
+    std::string error;
+    EXPECT_FALSE(f.set("type=BOGUS", &error));
+    EXPECT_NE(error.find("BOGUS"), std::string::npos);
+    EXPECT_FALSE(f.set("src=9-3"));
+    EXPECT_FALSE(f.set("src=70000"));
+    EXPECT_FALSE(f.set("dst=1"));
+    EXPECT_FALSE(f.set("type"));
+
+    EXPECT_TRUE(f.allows(1, TRACK));
+    EXPECT_FALSE(f.allows(1, PLOT));
+    EXPECT_EQ(f.spec(), "TYPE=TRACK");
+}
+
+TEST(IngressFilter, SetWhileReading) {
+    IngressFilter f;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        // Every table ever published allows src 1 TRACK
+        while (!done.load())
+            ASSERT_TRUE(f.allows(1, TRACK));
+    });
+    for (int i = 0; i < 200; ++i)
+        ASSERT_TRUE(f.set(i % 2 ? "src=1" : "type=TRACK"));
+    done.store(true);
+    reader.join();
+}
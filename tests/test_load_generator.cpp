@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "sensor_sim/load_generator.h"
+#include "gateway/telemetry_parser.h"
+
+using namespace nng;
+
+namespace {
+
+// Keeps what was sent and how it was batched
+class CaptureSink : public IFrameSink {
+public:
+    using IFrameSink::send_batch;
+    bool send(const std::vector<uint8_t>& buf) override {
+        frames.push_back(buf);
+        return true;
+    }
+    std::size_t send_batch(const FrameView* views, std::size_t count) override {
+        batches.push_back(count);
+        return IFrameSink::send_batch(views, count);
+    }
+
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<std::size_t> batches;
+};
+
+WorldObject make_object(uint32_t id) {
+    WorldObject obj{};
+    obj.id = id;
+    obj.classification = TrackClass::FIXED_WING;
+    obj.range_m = 5000.0;
+    obj.azimuth_deg = 90.0;
+    obj.elevation_deg = 5.0;
+    obj.speed_mps = 100.0;
+    obj.noise_stddev = 1.0;
+    return obj;
+}
+
+uint64_t header_ts(const std::vector<uint8_t>& frame) {
+    ParsedFrame pf;
+    EXPECT_EQ(parse_frame(frame.data(), frame.size(), false, pf), ParseError::OK);
+    return pf.header.ts_ns;
+}
+
+constexpr uint64_t START = 1000000000ULL;
+constexpr uint64_t WALL = 1700000000000000000ULL;
+
+} // namespace
+
+TEST(LoadGenerator, SendsNothingBeforeDue) {
+    LoadOptions opt;
+    opt.rate_fps = 1000.0; // 1 ms apart
+    opt.duration_s = 1.0;
+    LoadGenerator load(opt, 1);
+    load.start(START, WALL);
+    CaptureSink sink;
+
+    EXPECT_EQ(load.send_due({make_object(1)}, START - 1, sink), 0u);
+    EXPECT_EQ(load.send_due({make_object(1)}, START, sink), 1u);  // frame 0 due at start
+    EXPECT_EQ(load.send_due({make_object(1)}, START + 999999, sink), 0u);
+    EXPECT_EQ(load.next_due_ns(), START + 1000000);
+    EXPECT_EQ(load.stats().scheduled, 1000u);
+}
+
+TEST(LoadGenerator, FallsBehindWithoutLoweringLoad) {
+    LoadOptions opt;
+    opt.rate_fps = 1000.0;
+    opt.duration_s = 1.0;
+    opt.max_batch = 16;
+    LoadGenerator load(opt, 1);
+    load.start(START, WALL);
+    CaptureSink sink;
+    std::vector<WorldObject> objects = {make_object(1), make_object(2)};
+
+    // Stalled for 50 ms: the 51 frames due by then go out in bursts
+    uint64_t now = START + 50000000;
+    std::size_t sent = 0;
+    while (std::size_t n = load.send_due(objects, now, sink))
+        sent += n;
+    EXPECT_EQ(sent, 51u);
+    ASSERT_EQ(sink.batches.size(), 4u);
+    EXPECT_EQ(sink.batches[0], 16u);
+    EXPECT_EQ(sink.batches[3], 3u);
+
+    // Each frame still carries its own due time, not the late send time
+    for (std::size_t k = 0; k < sink.frames.size(); ++k)
+        EXPECT_EQ(header_ts(sink.frames[k]), WALL + k * 1000000);
+
+    // Lag is measured from the due time: frame 0 waited the full 50 ms
+    auto s = load.stats();
+    EXPECT_EQ(s.send_lag_ns.count, 51u);
+    EXPECT_EQ(s.send_lag_ns.max, 50000000u);
+}
+
+TEST(LoadGenerator, RunsToScheduleAndReportsRate) {
+    LoadOptions opt;
+    opt.rate_fps = 2000.0;
+    opt.duration_s = 0.5;
+    LoadGenerator load(opt, 7);
+    load.start(START, WALL);
+    CaptureSink sink;
+
+    // A sender that keeps up exactly: one frame at each due time
+    while (!load.done())
+        ASSERT_EQ(load.send_due({}, load.next_due_ns(), sink), 1u);
+
+    auto s = load.stats();
+    EXPECT_EQ(s.frames, 1000u);
+    EXPECT_EQ(s.datagrams, 1000u);
+    EXPECT_EQ(s.send_lag_ns.max, 0u);
+    EXPECT_NEAR(s.achieved_fps(), 2000.0, 5.0);
+
+    // No objects: heartbeats
+    ParsedFrame pf;
+    ASSERT_EQ(parse_frame(sink.frames[0].data(), sink.frames[0].size(), false, pf), ParseError::OK);
+    EXPECT_EQ(pf.header.msg_type, static_cast<uint8_t>(MsgType::HEARTBEAT));
+    EXPECT_EQ(pf.header.src_id, 7);
+}
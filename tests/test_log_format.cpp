@@ -4,6 +4,8 @@
 #include <sstream>
 #include <regex>
 #include <set>
+#include <string>
+#include <vector>
 
 using namespace nng;
 
@@ -190,3 +192,39 @@ TEST_F(LogFormatTest, EventNamePadding) {
     // Should start with EVT_TRACK_NEW and be padded
     EXPECT_TRUE(event_portion.find("EVT_TRACK_NEW") == 0);
 }
+
+TEST(LogLineFormatterTest, ExactBytes) {
+    LogLineFormatter fmt;
+    std::string out;
+    // 2025-07-15T14:23:01.001Z
+    fmt.append(out, 1752589381001000000ULL, Severity::INFO, EventCategory::TRACKING,
+               "EVT_TRACK_NEW", "src=0x0012 track_id=1041");
+    EXPECT_EQ(out, "2025-07-15T14:23:01.001Z [INFO ] [TRACKING  ] EVT_TRACK_NEW       "
+                   "src=0x0012 track_id=1041\n");
+}
+
+TEST(LogLineFormatterTest, LongNameIsCut) {
+    LogLineFormatter fmt;
+    std::string out;
+    fmt.append(out, 0, Severity::FATAL, EventCategory::CONTROL,
+               "EVT_A_VERY_LONG_EVENT_NAME", "");
+    EXPECT_EQ(out, "1970-01-01T00:00:00.000Z [FATAL] [CONTROL   ] EVT_A_VERY_LONG_EVEN\n");
+}
+
+TEST(LogLineFormatterTest, PrefixFollowsSecondChanges) {
+    LogLineFormatter fmt;
+    std::string out;
+    fmt.append(out, 1752589381999000000ULL, Severity::WARN, EventCategory::NETWORK, "E", "a");
+    fmt.append(out, 1752589382000000000ULL, Severity::WARN, EventCategory::NETWORK, "E", "b");
+    fmt.append(out, 1752589381500000000ULL, Severity::WARN, EventCategory::NETWORK, "E", "c");
+
+    std::istringstream iss(out);
+    std::string line;
+    std::vector<std::string> stamps;
+    while (std::getline(iss, line))
+        stamps.push_back(line.substr(0, 24));
+    ASSERT_EQ(stamps.size(), 3u);
+    EXPECT_EQ(stamps[0], "2025-07-15T14:23:01.999Z");
+    EXPECT_EQ(stamps[1], "2025-07-15T14:23:02.000Z");
+    EXPECT_EQ(stamps[2], "2025-07-15T14:23:01.500Z"); // clock stepped back
+}
@@ -4,7 +4,10 @@
 #include <regex>
 #include <thread>
 #include <vector>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
+#include <algorithm>
 
 using namespace nng;
 
@@ -20,8 +23,51 @@ protected:
         oss.str("");
         oss.clear();
     }
+
+    void TearDown() override {
+        logger.stop_async();
+    }
 };
 
+namespace {
+
+// Stream buffer whose writes block until released
+class GateBuf : public std::streambuf {
+public:
+    void release() {
+        std::lock_guard<std::mutex> lock(m_);
+        open_ = true;
+        cv_.notify_all();
+    }
+    std::size_t size() const { return data_.size(); }
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        wait();
+        data_.append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+    int_type overflow(int_type c) override {
+        wait();
+        if (c != traits_type::eof())
+            data_ += traits_type::to_char_type(c);
+        return c;
+    }
+
+private:
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [this] { return open_; });
+    }
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool open_ = false;
+    std::string data_;
+};
+
+} // anonymous namespace
+
 TEST_F(LoggerTest, InfoMessageMatchesFormat) {
     logger.log(Severity::INFO, EventCategory::TRACKING,
                "EVT_TRACK_NEW", "src=0x0012 track_id=1041");
@@ -159,6 +205,16 @@ TEST_F(LoggerTest, GetLevelReturnsWhatWasSet) {
     EXPECT_EQ(logger.get_level(), Severity::DEBUG);
 }
 
+TEST_F(LoggerTest, EnabledFollowsLevel) {
+    logger.set_level(Severity::WARN);
+    EXPECT_FALSE(logger.enabled(Severity::DEBUG));
+    EXPECT_FALSE(logger.enabled(Severity::INFO));
+    EXPECT_TRUE(logger.enabled(Severity::WARN));
+    EXPECT_TRUE(logger.enabled(Severity::FATAL));
+    logger.set_level(Severity::DEBUG);
+    EXPECT_TRUE(logger.enabled(Severity::DEBUG));
+}
+
 TEST_F(LoggerTest, AllSeveritiesProduceOutput) {
     logger.set_level(Severity::DEBUG);
     Severity levels[] = {Severity::DEBUG, Severity::INFO, Severity::WARN,
@@ -194,3 +250,151 @@ TEST_F(LoggerTest, ThreadSafetyNoCorruption) {
     EXPECT_EQ(line_count, threads * iterations)
         << "Expected " << threads * iterations << " lines, got " << line_count;
 }
+
+TEST_F(LoggerTest, AsyncLineMatchesSyncFormat) {
+    logger.start_async();
+    ASSERT_TRUE(logger.is_async());
+    logger.log(Severity::WARN, EventCategory::NETWORK, "EVT_SEQ_GAP", "src=0x0003 gap=2");
+    EventDetail d;
+    d.kind = EventDetail::Kind::SEQUENCE;
+    d.src_id = 3;
+    d.seq = {10, 12, 2};
+    logger.log_event(Severity::WARN, EventCategory::NETWORK, EventId::EVT_SEQ_GAP, d);
+    logger.flush();
+
+    std::string out = oss.str();
+    std::regex pattern(
+        R"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{3}Z \[WARN \] \[NETWORK   \] EVT_SEQ_GAP         (.*)\n)");
+    std::istringstream lines(out);
+    std::string line;
+    std::vector<std::string> details;
+    while (std::getline(lines, line)) {
+        std::smatch m;
+        line += '\n';
+        ASSERT_TRUE(std::regex_match(line, m, pattern)) << "[" << line << "]";
+        details.push_back(m[1]);
+    }
+    ASSERT_EQ(details.size(), 2u);
+    EXPECT_EQ(details[0], "src=0x0003 gap=2");
+    EXPECT_EQ(details[1], d.render()); // rendered by the writer thread
+}
+
+TEST_F(LoggerTest, AsyncTruncatesLongText) {
+    logger.start_async();
+    logger.log(Severity::INFO, EventCategory::CONTROL, "EVT_CONFIG_CHANGE",
+               std::string(1000, 'x'));
+    logger.flush();
+    std::string out = oss.str();
+    EXPECT_EQ(std::count(out.begin(), out.end(), 'x'),
+              static_cast<long>(LogRecord::TEXT_MAX));
+}
+
+TEST_F(LoggerTest, AsyncThreadSafetyNoLostLines) {
+    logger.start_async();
+    constexpr int threads = 8;
+    constexpr int iterations = 200;
+    uint64_t dropped_before = logger.dropped();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            for (int i = 0; i < iterations; ++i) {
+                logger.log(Severity::INFO, EventCategory::TRACKING, "EVT_TRACK_UPDATE",
+                           "thread=" + std::to_string(t) + " i=" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    logger.flush();
+
+    std::string output = oss.str();
+    auto line_count = std::count(output.begin(), output.end(), '\n');
+    EXPECT_EQ(logger.dropped(), dropped_before);
+    EXPECT_EQ(line_count, threads * iterations);
+}
+
+TEST_F(LoggerTest, AsyncProducersWithRoomDropNothing) {
+    // Fewer records than the queue holds: a drop could only be a push that
+    // lost a race with the other producers, not a full queue
+    logger.start_async();
+    constexpr int threads = 8;
+    constexpr int iterations = static_cast<int>(Logger::DEFAULT_ASYNC_CAPACITY) / threads;
+    uint64_t dropped_before = logger.dropped();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&]() {
+            for (int i = 0; i < iterations; ++i)
+                logger.log(Severity::INFO, EventCategory::NETWORK, "EVT_SEQ_GAP", "x");
+        });
+    }
+    for (auto& th : pool) th.join();
+    logger.flush();
+
+    std::string output = oss.str();
+    EXPECT_EQ(logger.dropped(), dropped_before);
+    EXPECT_EQ(std::count(output.begin(), output.end(), '\n'), threads * iterations);
+}
+
+TEST_F(LoggerTest, AsyncFullQueueCountsDrops) {
+    GateBuf buf;
+    std::ostream gated(&buf);
+    logger.set_output(gated);
+    logger.start_async();
+
+    // The writer blocks on its first batch, so the queue fills up
+    constexpr int total = static_cast<int>(Logger::DEFAULT_ASYNC_CAPACITY) * 2;
+    uint64_t dropped_before = logger.dropped();
+    for (int i = 0; i < total; ++i)
+        logger.log(Severity::INFO, EventCategory::CONTROL, "EVT_CONFIG_CHANGE", "fill");
+    uint64_t dropped = logger.dropped() - dropped_before;
+    EXPECT_GT(dropped, 0u);
+
+    buf.release();
+    logger.stop_async(); // drains what was queued
+    EXPECT_FALSE(logger.is_async());
+    std::size_t line_len = std::string("2025-07-15T14:23:01.001Z [INFO ] [CONTROL   ] ").size() +
+                           LogRecord::NAME_MAX + 5;
+    EXPECT_EQ(buf.size() / line_len, static_cast<std::size_t>(total) - dropped);
+    logger.set_output(oss);
+}
+
+TEST_F(LoggerTest, StopAsyncReturnsToSyncWrites) {
+    logger.start_async();
+    logger.log(Severity::INFO, EventCategory::CONTROL, "EVT_CONFIG_CHANGE", "queued");
+    logger.stop_async();
+    EXPECT_NE(oss.str().find("queued"), std::string::npos);
+
+    logger.log(Severity::INFO, EventCategory::CONTROL, "EVT_CONFIG_CHANGE", "direct");
+    EXPECT_NE(oss.str().find("direct"), std::string::npos);
+}
+
+TEST_F(LoggerTest, PerCategoryLevel) {
+    logger.set_level(Severity::WARN);
+    logger.set_level(EventCategory::TRACKING, Severity::DEBUG);
+    EXPECT_TRUE(logger.enabled(Severity::DEBUG)); // some category passes DEBUG
+    EXPECT_TRUE(logger.enabled(Severity::DEBUG, EventCategory::TRACKING));
+    EXPECT_FALSE(logger.enabled(Severity::INFO, EventCategory::NETWORK));
+    EXPECT_EQ(logger.get_level(), Severity::WARN);
+
+    logger.log(Severity::DEBUG, EventCategory::TRACKING, "EVT_TRACK_UPDATE", "kept");
+    logger.log(Severity::INFO, EventCategory::NETWORK, "EVT_SOURCE_ONLINE", "filtered");
+    EXPECT_NE(oss.str().find("kept"), std::string::npos);
+    EXPECT_EQ(oss.str().find("filtered"), std::string::npos);
+
+    logger.set_level(EventCategory::TRACKING, Severity::WARN);
+    EXPECT_FALSE(logger.enabled(Severity::DEBUG));
+
+    logger.set_level(EventCategory::HEALTH, Severity::ERROR);
+    logger.set_level(Severity::INFO); // overrides per-category levels
+    EXPECT_EQ(logger.get_level(EventCategory::HEALTH), Severity::INFO);
+}
+
+TEST(LoggerParseTest, SeverityAndCategoryNames) {
+    Severity sev;
+    EXPECT_TRUE(parse_severity("alarm", sev));
+    EXPECT_EQ(sev, Severity::ALARM);
+    EXPECT_FALSE(parse_severity("INFO ", sev));
+    EventCategory cat;
+    EXPECT_TRUE(parse_category("Engagement", cat));
+    EXPECT_EQ(cat, EventCategory::ENGAGEMENT);
+    EXPECT_FALSE(parse_category("", cat));
+}
@@ -207,3 +207,96 @@ TEST(MeasurementGenerator, UpdateCountIncrements) {
     auto tp = deserialize_track(pf.payload_ptr);
     EXPECT_EQ(tp.update_count, 2) << "Second track update should have update_count=2";
 }
+
+TEST(MeasurementGenerator, ArenaMatchesVectorFrames) {
+    std::vector<WorldObject> objects;
+    for (int i = 0; i < 8; ++i) {
+        auto obj = i % 2 ? make_close_object() : make_far_stealth_object();
+        obj.id = static_cast<uint32_t>(i + 1);
+        objects.push_back(obj);
+    }
+    MeasurementGenerator by_vector(0x0001, 42);
+    MeasurementGenerator by_arena(0x0001, 42);
+    FrameArena arena;
+
+    for (uint64_t tick = 1; tick <= 5; ++tick) {
+        uint64_t ts = tick * 1000000;
+        auto expected = by_vector.generate_tracks(objects, ts);
+        auto plots = by_vector.generate_plots(objects, ts);
+        expected.insert(expected.end(), plots.begin(), plots.end());
+        expected.push_back(by_vector.generate_heartbeat(ts));
+
+        arena.clear();
+        by_arena.generate_tracks(objects, ts, arena);
+        by_arena.generate_plots(objects, ts, arena);
+        by_arena.generate_heartbeat(ts, arena);
+
+        ASSERT_EQ(arena.size(), expected.size());
+        const FrameView* views = arena.views();
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(views[i].len, expected[i].size());
+            EXPECT_EQ(std::vector<uint8_t>(views[i].data, views[i].data + views[i].len), expected[i]);
+        }
+        EXPECT_EQ(arena.offsets().back(), arena.bytes());
+    }
+}
+
+TEST(MeasurementGenerator, ArenaStopsGrowing) {
+    std::vector<WorldObject> objects;
+    for (int i = 0; i < 20; ++i) {
+        auto obj = make_close_object();
+        obj.id = static_cast<uint32_t>(i + 1);
+        objects.push_back(obj);
+    }
+    MeasurementGenerator mg(0x0001, 42);
+    FrameArena arena;
+    arena.reserve(64, 8192);
+
+    arena.clear();
+    mg.generate_tracks(objects, 1000000, arena);
+    const uint8_t* first = arena.data(0);
+    const FrameView* views = arena.views();
+    for (uint64_t tick = 2; tick <= 50; ++tick) {
+        arena.clear();
+        mg.generate_tracks(objects, tick * 1000000, arena);
+        ASSERT_EQ(arena.size(), objects.size());
+        // Same buffers every tick: nothing was reallocated
+        EXPECT_EQ(arena.data(0), first);
+        EXPECT_EQ(arena.views(), views);
+    }
+}
+
+TEST(MeasurementGenerator, FastRngDeterministicAndValid) {
+    std::vector<WorldObject> objects;
+    for (int i = 0; i < 50; ++i) {
+        auto obj = i % 2 ? make_close_object() : make_far_stealth_object();
+        obj.id = static_cast<uint32_t>(i + 1);
+        objects.push_back(obj);
+    }
+    MeasurementGenerator a(0x0001, 42, RngMode::FAST);
+    MeasurementGenerator b(0x0001, 42, RngMode::FAST);
+    MeasurementGenerator std_mode(0x0001, 42);
+
+    std::size_t detected = 0;
+    for (uint64_t tick = 1; tick <= 5; ++tick) {
+        auto plots = a.generate_plots(objects, tick);
+        detected += plots.size();
+        EXPECT_EQ(plots, b.generate_plots(objects, tick));
+        auto tracks = a.generate_tracks(objects, tick);
+        EXPECT_EQ(tracks, b.generate_tracks(objects, tick));
+        EXPECT_NE(tracks, std_mode.generate_tracks(objects, tick));
+
+        for (const auto& f : tracks) {
+            ParsedFrame pf;
+            ASSERT_EQ(parse_frame(f.data(), f.size(), false, pf), ParseError::OK);
+            auto tp = deserialize_track(pf.payload_ptr);
+            // Noise stays small: within 10 sigma of the true azimuth
+            double az = tp.azimuth_mdeg / 1000.0;
+            EXPECT_TRUE(std::fabs(az - 45.0) < 5.0 || std::fabs(az - 200.0) < 5.0) << az;
+        }
+    }
+    // p_detect is 0.4 for the close objects and 0.1 for the far ones:
+    // about 62 of 250
+    EXPECT_GT(detected, 35u);
+    EXPECT_LT(detected, 95u);
+}
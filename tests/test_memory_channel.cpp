@@ -0,0 +1,87 @@
+#include "gateway/memory_channel.h"
+#include "gateway/gateway.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+std::vector<uint8_t> heartbeat_frame(uint32_t seq) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(HeartbeatPayload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    hdr.src_id = 7;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(hdr, buf.data());
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(MemoryChannelTest, FramesArriveInOrder) {
+    MemoryFrameChannel channel(16);
+    auto source = channel.source(10);
+
+    for (uint32_t i = 0; i < 5; ++i)
+        ASSERT_TRUE(channel.sink().send(heartbeat_frame(i)));
+
+    FrameBatch batch(64);
+    ASSERT_EQ(source->receive_batch(batch), 5u);
+    for (uint32_t i = 0; i < 5; ++i)
+        EXPECT_EQ(deserialize_header(batch[i].data).seq, i);
+    EXPECT_EQ(channel.sent(), 5u);
+
+    // Empty: times out with nothing
+    EXPECT_EQ(source->receive_batch(batch), 0u);
+}
+
+TEST(MemoryChannelTest, FullChannelDropsAndRecovers) {
+    MemoryFrameChannel channel(4);
+    auto source = channel.source(10);
+    auto frame = heartbeat_frame(0);
+
+    for (int i = 0; i < 6; ++i)
+        channel.sink().send(frame);
+    EXPECT_EQ(channel.sent(), 4u);
+    EXPECT_EQ(channel.dropped(), 2u);
+
+    // Receiving frees the slots again
+    FrameBatch batch(8);
+    EXPECT_EQ(source->receive_batch(batch), 4u);
+    EXPECT_TRUE(channel.sink().send(frame));
+    EXPECT_EQ(channel.sent(), 5u);
+}
+
+TEST(MemoryChannelTest, GatewayReadsFromSourceFactory) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    for (uint32_t i = 0; i < 100; ++i)
+        channel.sink().send(heartbeat_frame(i));
+    for (int i = 0; i < 200 && gateway.stats().get_global_stats().rx_total < 100; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    gateway.stop();
+    t.join();
+    EXPECT_EQ(gateway.stats().get_global_stats().rx_total, 100u);
+    EXPECT_EQ(gateway.stats().get_source_stats(7).rx_count, 100u);
+    Logger::instance().set_output(std::cout);
+}
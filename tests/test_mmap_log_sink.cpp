@@ -0,0 +1,121 @@
+#include "common/mmap_log_sink.h"
+#include "common/logger.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+using namespace nng;
+
+class MmapLogSinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        base_ = "/tmp/test_mmap_log_sink_" + std::to_string(rand()) + ".log";
+    }
+
+    void TearDown() override {
+        for (int i = 0; i < 16; ++i)
+            std::remove((base_ + "." + std::to_string(i)).c_str());
+    }
+
+    static std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    static bool exists(const std::string& path) {
+        struct stat st{};
+        return ::stat(path.c_str(), &st) == 0;
+    }
+
+    std::string base_;
+};
+
+TEST_F(MmapLogSinkTest, WritesAndTrimsOnClose) {
+    MmapLogSink sink;
+    ASSERT_TRUE(sink.open(base_, 8192));
+    EXPECT_TRUE(sink.is_open());
+    sink.stream() << "first line\n" << "second line\n";
+    sink.stream().flush();
+    EXPECT_EQ(sink.bytes_written(), 23u);
+    sink.close();
+    EXPECT_FALSE(sink.is_open());
+
+    EXPECT_EQ(read_file(base_ + ".0"), "first line\nsecond line\n");
+}
+
+TEST_F(MmapLogSinkTest, RotatesWithoutSplittingLines) {
+    MmapLogSink sink;
+    ASSERT_TRUE(sink.open(base_, MmapLogSink::MIN_SEGMENT_BYTES));
+    std::string line(99, 'a');
+    line += '\n';
+    constexpr int lines = 100; // 10000 bytes over 4096-byte segments
+    for (int i = 0; i < lines; ++i)
+        sink.stream().write(line.data(), static_cast<std::streamsize>(line.size()));
+    EXPECT_EQ(sink.segment_index(), 2u);
+    sink.close();
+
+    std::string all;
+    for (int i = 0; i < 3; ++i) {
+        std::string seg = read_file(base_ + "." + std::to_string(i));
+        EXPECT_EQ(seg.size() % line.size(), 0u) << "segment " << i << " splits a line";
+        EXPECT_LE(seg.size(), MmapLogSink::MIN_SEGMENT_BYTES);
+        all += seg;
+    }
+    EXPECT_EQ(all.size(), line.size() * lines);
+    EXPECT_EQ(sink.write_errors(), 0u);
+    EXPECT_EQ(sink.trim_errors(), 0u);
+}
+
+TEST_F(MmapLogSinkTest, OversizedWriteSpansSegments) {
+    MmapLogSink sink;
+    ASSERT_TRUE(sink.open(base_, MmapLogSink::MIN_SEGMENT_BYTES));
+    std::string big(MmapLogSink::MIN_SEGMENT_BYTES * 2 + 10, 'z');
+    sink.stream().write(big.data(), static_cast<std::streamsize>(big.size()));
+    sink.close();
+    EXPECT_EQ(read_file(base_ + ".0") + read_file(base_ + ".1") + read_file(base_ + ".2"), big);
+}
+
+TEST_F(MmapLogSinkTest, MaxSegmentsDeletesOldest) {
+    MmapLogSink sink;
+    ASSERT_TRUE(sink.open(base_, MmapLogSink::MIN_SEGMENT_BYTES, 2));
+    std::string chunk(MmapLogSink::MIN_SEGMENT_BYTES, 'x');
+    for (int i = 0; i < 4; ++i)
+        sink.stream().write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    EXPECT_EQ(sink.segment_index(), 3u);
+    sink.close();
+    EXPECT_FALSE(exists(base_ + ".0"));
+    EXPECT_FALSE(exists(base_ + ".1"));
+    EXPECT_TRUE(exists(base_ + ".2"));
+    EXPECT_TRUE(exists(base_ + ".3"));
+}
+
+TEST_F(MmapLogSinkTest, OpenFailsForMissingDirectory) {
+    MmapLogSink sink;
+    EXPECT_FALSE(sink.open("/nonexistent_dir_for_test/gateway.log"));
+    EXPECT_FALSE(sink.is_open());
+}
+
+TEST_F(MmapLogSinkTest, LoggerWritesThroughSink) {
+    MmapLogSink sink;
+    ASSERT_TRUE(sink.open(base_, 16384));
+    Logger& logger = Logger::instance();
+    logger.set_level(Severity::DEBUG);
+    logger.set_output(sink.stream());
+    logger.log(Severity::INFO, EventCategory::CONTROL, "EVT_CONFIG_CHANGE", "via mmap");
+    logger.start_async();
+    logger.log(Severity::WARN, EventCategory::NETWORK, "EVT_SEQ_GAP", "async via mmap");
+    logger.stop_async();
+
+    std::ostringstream discard;
+    logger.set_output(discard);
+    sink.close();
+
+    std::string content = read_file(base_ + ".0");
+    EXPECT_NE(content.find("EVT_CONFIG_CHANGE   via mmap\n"), std::string::npos);
+    EXPECT_NE(content.find("EVT_SEQ_GAP         async via mmap\n"), std::string::npos);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "common/mpsc_queue.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace nng;
+
+TEST(MpscQueueTest, PushPopFifo) {
+    MpscQueue<int> q(4);
+    EXPECT_EQ(q.capacity(), 4u);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(q.try_push(i));
+    EXPECT_FALSE(q.try_push(99)); // full
+
+    int v = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(q.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(q.try_pop(v));
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MpscQueueTest, WrapsAround) {
+    MpscQueue<int> q(2);
+    int v = 0;
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+        ASSERT_TRUE(q.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+}
+
+TEST(MpscQueueTest, BatchPushIsContiguousAndPartial) {
+    MpscQueue<int> q(8);
+    int a[5] = {10, 11, 12, 13, 14};
+    int b[5] = {20, 21, 22, 23, 24};
+    EXPECT_EQ(q.try_push_n(a, 5), 5u);
+    EXPECT_EQ(q.try_push_n(b, 5), 3u); // only 3 slots left
+
+    int out[8] = {};
+    EXPECT_EQ(q.try_pop_n(out, 8), 8u);
+    EXPECT_EQ(out[0], 10);
+    EXPECT_EQ(out[4], 14);
+    EXPECT_EQ(out[5], 20);
+    EXPECT_EQ(out[7], 22);
+}
+
+TEST(MpscQueueTest, ConcurrentProducersKeepPerProducerOrder) {
+    MpscQueue<uint64_t> q(128);
+    const int producers = 4;
+    const uint64_t per_producer = 50000;
+
+    // value = producer << 32 | sequence
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p, per_producer]() {
+            uint64_t next = 0;
+            uint64_t buf[4];
+            while (next < per_producer) {
+                std::size_t want = 0;
+                while (want < 4 && next + want < per_producer) {
+                    buf[want] = (static_cast<uint64_t>(p) << 32) | (next + want);
+                    ++want;
+                }
+                std::size_t n = q.try_push_n(buf, want);
+                next += n;
+                if (n == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<uint64_t> next_seq(producers, 0);
+    uint64_t total = 0;
+    uint64_t out[32];
+    while (total < producers * per_producer) {
+        std::size_t n = q.try_pop_n(out, 32);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto p = static_cast<std::size_t>(out[i] >> 32);
+            ASSERT_LT(p, next_seq.size());
+            ASSERT_EQ(out[i] & 0xFFFFFFFFu, next_seq[p]);
+            next_seq[p]++;
+        }
+        total += n;
+        if (n == 0)
+            std::this_thread::yield();
+    }
+    for (auto& t : threads)
+        t.join();
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MpscQueueTest, ConcurrentPushNeverFailsWithRoom) {
+    // Room for everything ever pushed, so no push may report full, however
+    // producers and the consumer interleave
+    const int producers = 4;
+    const uint64_t per_producer = 50000;
+    MpscQueue<uint64_t> q(producers * per_producer);
+
+    std::atomic<uint64_t> failures{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, &failures, p, per_producer]() {
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                uint64_t v = (static_cast<uint64_t>(p) << 32) | i;
+                if (!q.try_push(v))
+                    failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    uint64_t total = 0;
+    uint64_t out[32];
+    while (total < producers * per_producer &&
+           total + failures.load(std::memory_order_relaxed) < producers * per_producer) {
+        std::size_t n = q.try_pop_n(out, 32);
+        total += n;
+        if (n == 0)
+            std::this_thread::yield();
+    }
+    for (auto& t : threads)
+        t.join();
+    EXPECT_EQ(failures.load(), 0u);
+    EXPECT_EQ(total + q.size(), producers * per_producer);
+}
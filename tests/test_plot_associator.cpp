@@ -0,0 +1,234 @@
+#include "gateway/plot_associator.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+TrackPayload track_at(uint32_t track_id, int32_t az_mdeg, uint32_t range_m) {
+    TrackPayload t{};
+    t.track_id = track_id;
+    t.azimuth_mdeg = az_mdeg;
+    t.range_m = range_m;
+    return t;
+}
+
+PlotPayload plot_at(uint32_t plot_id, int32_t az_mdeg, uint32_t range_m) {
+    PlotPayload p{};
+    p.plot_id = plot_id;
+    p.azimuth_mdeg = az_mdeg;
+    p.range_m = range_m;
+    return p;
+}
+
+PlotAssociation associate(PlotAssociator& a, uint16_t src_id, const PlotPayload& p,
+                          uint64_t now_ns = 0) {
+    return a.associate(src_id, PlotView(reinterpret_cast<const uint8_t*>(&p)), now_ns);
+}
+
+template <typename Payload>
+std::vector<uint8_t> frame(MsgType type, uint16_t src_id, uint32_t seq, const Payload& payload) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(Payload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(type);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(Payload);
+    serialize_header(hdr, buf.data());
+    std::memcpy(buf.data() + FRAME_HEADER_SIZE, &payload, sizeof(Payload));
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(PlotAssociatorTest, NearestTrackInsideTheGate) {
+    PlotAssociator a;
+    a.update(1, track_at(10, 45000, 20000), 0);
+    a.update(1, track_at(11, 45500, 20100), 0);
+    a.update(1, track_at(12, 90000, 20000), 0);
+    EXPECT_EQ(a.size(), 3u);
+
+    PlotAssociation r = associate(a, 1, plot_at(1, 45400, 20080));
+    ASSERT_EQ(r.result, PlotAssociation::Result::ASSOCIATED);
+    EXPECT_EQ(r.track_id, 11u);
+    EXPECT_EQ(r.track_src, 1u);
+    EXPECT_EQ(r.d_az_mdeg, -100);
+    EXPECT_EQ(r.d_range_m, -20);
+
+    // Outside every gate: a candidate
+    r = associate(a, 1, plot_at(2, 45000, 21000));
+    EXPECT_EQ(r.result, PlotAssociation::Result::CANDIDATE);
+    // The gate is an ellipse: inside each half-width, outside together
+    r = associate(a, 1, plot_at(3, 90800, 20400));
+    EXPECT_EQ(r.result, PlotAssociation::Result::CANDIDATE);
+
+    AssociationStats s = a.stats();
+    EXPECT_EQ(s.plots, 3u);
+    EXPECT_EQ(s.associated, 1u);
+    EXPECT_EQ(s.candidates, 2u);
+    EXPECT_EQ(s.tracks, 3u);
+}
+
+TEST(PlotAssociatorTest, AzimuthWrapsAndSourcesStayApart) {
+    PlotAssociator a;
+    a.update(1, track_at(1, 359800, 5000), 0);
+    PlotAssociation r = associate(a, 1, plot_at(1, 300, 5000));
+    ASSERT_EQ(r.result, PlotAssociation::Result::ASSOCIATED);
+    EXPECT_EQ(r.d_az_mdeg, 500);
+    r = associate(a, 1, plot_at(2, -100, 5000));
+    ASSERT_EQ(r.result, PlotAssociation::Result::ASSOCIATED);
+    EXPECT_EQ(r.d_az_mdeg, 100);
+
+    // Another sensor's track is not gated against unless asked
+    EXPECT_EQ(associate(a, 2, plot_at(3, 359800, 5000)).result,
+              PlotAssociation::Result::CANDIDATE);
+    AssociationOptions o;
+    o.same_source = false;
+    PlotAssociator shared(o);
+    shared.update(1, track_at(1, 359800, 5000), 0);
+    r = associate(shared, 2, plot_at(3, 359800, 5000));
+    ASSERT_EQ(r.result, PlotAssociation::Result::ASSOCIATED);
+    EXPECT_EQ(r.track_src, 1u);
+}
+
+TEST(PlotAssociatorTest, TracksMoveExpireAndRemove) {
+    AssociationOptions o;
+    o.ttl_ms = 1000;
+    o.capacity = 4;
+    PlotAssociator a(o);
+    a.update(1, track_at(1, 10000, 10000), 0);
+    // Moved far away: only found at its new position
+    a.update(1, track_at(1, 200000, 80000), 100);
+    EXPECT_EQ(associate(a, 1, plot_at(1, 10000, 10000), 100).result,
+              PlotAssociation::Result::CANDIDATE);
+    EXPECT_EQ(associate(a, 1, plot_at(2, 200000, 80000), 100).result,
+              PlotAssociation::Result::ASSOCIATED);
+    EXPECT_EQ(a.size(), 1u);
+
+    // Full: new tracks are dropped and counted
+    for (uint32_t id = 2; id <= 5; ++id)
+        a.update(1, track_at(id, 0, id * 10000), 100);
+    EXPECT_EQ(a.size(), 4u);
+    EXPECT_EQ(a.stats().dropped, 1u);
+    EXPECT_TRUE(a.remove(1, 2));
+    EXPECT_FALSE(a.remove(1, 2));
+    EXPECT_TRUE(a.update(1, track_at(5, 0, 50000), 100));
+
+    // Past the TTL a track is not gated against, and the sweep frees it
+    uint64_t late = 100 + 1000000000ULL + 1;
+    EXPECT_EQ(associate(a, 1, plot_at(3, 200000, 80000), late).result,
+              PlotAssociation::Result::CANDIDATE);
+    a.expire(late);
+    EXPECT_EQ(a.size(), 0u);
+    EXPECT_EQ(a.stats().tracks, 0u);
+}
+
+TEST(PlotAssociatorTest, MatchesExhaustiveGating) {
+    // Dense random picture, with churn so removals reshuffle the index
+    AssociationOptions o;
+    o.gate_az_mdeg = 2000;
+    o.gate_range_m = 800;
+    o.max_range_m = 60000;
+    o.ttl_ms = 0;
+    PlotAssociator a(o);
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int32_t> az(0, 359999);
+    std::uniform_int_distribution<uint32_t> range(0, 70000);
+    std::vector<TrackPayload> live;
+    for (uint32_t id = 0; id < 3000; ++id) {
+        live.push_back(track_at(id, az(rng), range(rng)));
+        a.update(1, live.back(), 0);
+    }
+    for (uint32_t id = 0; id < 3000; id += 3) {
+        ASSERT_TRUE(a.remove(1, id));
+        live[id].track_id = UINT32_MAX;
+    }
+
+    std::size_t associated = 0;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        PlotPayload p = plot_at(i, az(rng), range(rng));
+        double best = 2.0;
+        for (const TrackPayload& t : live) {
+            if (t.track_id == UINT32_MAX)
+                continue;
+            int32_t d_az = p.azimuth_mdeg - t.azimuth_mdeg;
+            if (d_az > 180000)
+                d_az -= 360000;
+            else if (d_az <= -180000)
+                d_az += 360000;
+            double x = d_az / 2000.0;
+            double y = (static_cast<double>(p.range_m) - t.range_m) / 800.0;
+            best = std::min(best, x * x + y * y);
+        }
+        PlotAssociation r = associate(a, 1, p);
+        ASSERT_EQ(r.result == PlotAssociation::Result::ASSOCIATED, best <= 1.0) << i;
+        if (best > 1.0)
+            continue;
+        ++associated;
+        double x = r.d_az_mdeg / 2000.0;
+        double y = r.d_range_m / 800.0;
+        EXPECT_DOUBLE_EQ(x * x + y * y, best);
+    }
+    EXPECT_GT(associated, 100u);
+    // Each plot looked at a few cells' worth of tracks, not all 2000
+    EXPECT_LT(a.stats().gated, 5000u * 100);
+}
+
+TEST(PlotAssociatorTest, GatewayRaisesAssociationEvents) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    MemoryFrameChannel channel(64);
+    channel.sink().send(frame(MsgType::TRACK, 4, 0, track_at(77, 30000, 12000)));
+    channel.sink().send(frame(MsgType::PLOT, 4, 1, plot_at(1, 30200, 12050)));
+    channel.sink().send(frame(MsgType::PLOT, 4, 2, plot_at(2, 100000, 12000)));
+    channel.sink().send(frame(MsgType::PLOT, 4, 2, plot_at(2, 100000, 12000))); // duplicate
+
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.association.enabled = true;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    Gateway gateway(config);
+    std::mutex mutex;
+    std::vector<EventRecord> events;
+    gateway.events().subscribe(EventCategory::TRACKING, [&](const EventRecord& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(e);
+    });
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 400; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (events.size() >= 3 && gateway.stats().get_global_stats().rx_total >= 4)
+                break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    // The duplicate raises nothing
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].id, EventId::EVT_TRACK_UPDATE);
+    EXPECT_EQ(events[1].id, EventId::EVT_PLOT_ASSOCIATED);
+    EXPECT_EQ(events[1].detail_text(), "src_id=4 plot_id=1 track_id=77 d_az=200mdeg d_range=50m");
+    EXPECT_EQ(events[2].id, EventId::EVT_TRACK_NEW);
+    EXPECT_EQ(events[2].fields.plot.plot_id, 2u);
+
+    AssociationStats s = gateway.association_stats();
+    EXPECT_EQ(s.plots, 2u);
+    EXPECT_EQ(s.associated, 1u);
+    EXPECT_EQ(s.candidates, 1u);
+    EXPECT_EQ(s.tracks, 1u);
+}
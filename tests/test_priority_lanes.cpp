@@ -0,0 +1,199 @@
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "gateway/pipeline.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+template <typename Payload>
+std::vector<uint8_t> frame(MsgType type, uint16_t src_id, uint32_t seq, const Payload& payload) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(Payload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(type);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.ts_ns = 1000 + seq;
+    hdr.payload_len = sizeof(Payload);
+    serialize_header(hdr, buf.data());
+    std::memcpy(buf.data() + FRAME_HEADER_SIZE, &payload, sizeof(Payload));
+    return buf;
+}
+
+std::vector<uint8_t> plot_frame(uint16_t src_id, uint32_t seq) {
+    PlotPayload p{};
+    p.plot_id = seq;
+    return frame(MsgType::PLOT, src_id, seq, p);
+}
+
+std::vector<uint8_t> engagement_frame(uint16_t src_id, uint32_t seq) {
+    EngagementPayload e{};
+    e.weapon_id = 7;
+    return frame(MsgType::ENGAGEMENT, src_id, seq, e);
+}
+
+template <typename Payload>
+FrameOutcome outcome(MsgType type, const Payload& payload) {
+    FrameOutcome out;
+    out.header.msg_type = static_cast<uint8_t>(type);
+    out.header.payload_len = sizeof(Payload);
+    out.payload_len = sizeof(Payload);
+    std::memcpy(out.payload, &payload, sizeof(Payload));
+    return out;
+}
+
+// Event ids of the TRACKING and ENGAGEMENT events, in publish order
+struct EventOrder {
+    explicit EventOrder(EventBus& bus, int bulk_delay_us = 0) {
+        bus.subscribe(EventCategory::TRACKING, [this, bulk_delay_us](const EventRecord& e) {
+            if (bulk_delay_us > 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(bulk_delay_us));
+            add(e.id);
+        });
+        bus.subscribe(EventCategory::ENGAGEMENT, [this](const EventRecord& e) { add(e.id); });
+    }
+    void add(EventId id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.push_back(id);
+    }
+    std::size_t position(EventId id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<std::size_t>(std::find(ids.begin(), ids.end(), id) - ids.begin());
+    }
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ids.size();
+    }
+
+    std::mutex mutex;
+    std::vector<EventId> ids;
+};
+
+// Queue plots then one engagement before the gateway starts, so the
+// first receive takes them as one batch; returns where the engagement's
+// event was published among the events
+std::size_t engagement_position(GatewayConfig config, int plots, int bulk_delay_us = 0) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    MemoryFrameChannel channel(256);
+    for (int i = 0; i < plots; ++i)
+        channel.sink().send(plot_frame(1, static_cast<uint32_t>(i)));
+    channel.sink().send(engagement_frame(2, 0));
+
+    config.crc_enabled = false;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    Gateway gateway(config);
+    EventOrder order(gateway.events(), bulk_delay_us);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 400 && order.size() < static_cast<std::size_t>(plots) + 1; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+    EXPECT_EQ(order.size(), static_cast<std::size_t>(plots) + 1);
+    return order.position(EventId::EVT_WEAPON_STATUS);
+}
+
+} // anonymous namespace
+
+TEST(PriorityLaneTest, Classify) {
+    EXPECT_EQ(classify_lane(outcome(MsgType::ENGAGEMENT, EngagementPayload{})), Lane::PRIORITY);
+    EXPECT_EQ(classify_lane(outcome(MsgType::PLOT, PlotPayload{})), Lane::BULK);
+
+    HeartbeatPayload hb{};
+    hb.state = static_cast<uint8_t>(SubsystemState::OK);
+    EXPECT_EQ(classify_lane(outcome(MsgType::HEARTBEAT, hb)), Lane::BULK);
+    hb.state = static_cast<uint8_t>(SubsystemState::DEGRADED);
+    EXPECT_EQ(classify_lane(outcome(MsgType::HEARTBEAT, hb)), Lane::BULK);
+    hb.state = static_cast<uint8_t>(SubsystemState::ERROR);
+    EXPECT_EQ(classify_lane(outcome(MsgType::HEARTBEAT, hb)), Lane::PRIORITY);
+    hb.state = static_cast<uint8_t>(SubsystemState::OFFLINE);
+    EXPECT_EQ(classify_lane(outcome(MsgType::HEARTBEAT, hb)), Lane::PRIORITY);
+
+    TrackPayload track{};
+    track.threat_level = static_cast<uint8_t>(ThreatLevel::LOW);
+    EXPECT_EQ(classify_lane(outcome(MsgType::TRACK, track)), Lane::BULK);
+    track.threat_level = static_cast<uint8_t>(ThreatLevel::MEDIUM);
+    EXPECT_EQ(classify_lane(outcome(MsgType::TRACK, track)), Lane::BULK);
+    track.threat_level = static_cast<uint8_t>(ThreatLevel::HIGH);
+    EXPECT_EQ(classify_lane(outcome(MsgType::TRACK, track)), Lane::PRIORITY);
+    track.threat_level = static_cast<uint8_t>(ThreatLevel::CRITICAL);
+    FrameOutcome critical = outcome(MsgType::TRACK, track);
+    EXPECT_EQ(classify_lane(critical), Lane::PRIORITY);
+
+    // A truncated payload cannot be trusted to be critical
+    critical.payload_len = sizeof(TrackPayload) - 1;
+    EXPECT_EQ(classify_lane(critical), Lane::BULK);
+
+    // Timers: a lost critical track and a silent source go first, faults do not
+    FrameOutcome lost = outcome(MsgType::TRACK, track);
+    lost.header = TelemetryHeader{};
+    lost.expiry = TimerExpiry::TRACK_LOST;
+    EXPECT_EQ(classify_lane(lost), Lane::PRIORITY);
+    FrameOutcome timeout;
+    timeout.expiry = TimerExpiry::SOURCE_TIMEOUT;
+    EXPECT_EQ(classify_lane(timeout), Lane::PRIORITY);
+    FrameOutcome bad = outcome(MsgType::ENGAGEMENT, EngagementPayload{});
+    bad.error = ParseError::CRC_MISMATCH;
+    EXPECT_EQ(classify_lane(bad), Lane::BULK);
+}
+
+TEST(PriorityLaneTest, InlineBatchPublishesPriorityFirst) {
+    GatewayConfig config;
+    EXPECT_EQ(engagement_position(config, 50), 0u);
+
+    // One lane: arrival order
+    config.priority_lanes = false;
+    EXPECT_EQ(engagement_position(config, 50), 50u);
+}
+
+TEST(PriorityLaneTest, PipelinedPriorityBypassesBulkBacklog) {
+    // Every plot event takes 1 ms to deliver: the engagement, validated
+    // right behind them, must not wait for the 200 queued ahead of it
+    GatewayConfig config;
+    config.pipelined = true;
+    std::size_t pos = engagement_position(config, 200, 1000);
+    EXPECT_LT(pos, 20u);
+}
+
+TEST(PriorityLaneTest, PerLaneQueueStats) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.pipelined = true;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    Gateway gateway(config);
+    EventOrder order(gateway.events());
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    for (uint32_t i = 0; i < 30; ++i)
+        channel.sink().send(plot_frame(1, i));
+    for (uint32_t i = 0; i < 5; ++i)
+        channel.sink().send(engagement_frame(2, i));
+    for (int i = 0; i < 400 && order.size() < 35; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    PipelineStats p = gateway.pipeline_stats();
+    EXPECT_EQ(p.priority.enqueued, 5u);
+    EXPECT_EQ(p.priority.depth, 0u);
+    EXPECT_EQ(p.priority.dropped, 0u);
+    EXPECT_EQ(p.dispatch.enqueued, 30u);
+    EXPECT_EQ(p.dispatch.depth, 0u);
+}
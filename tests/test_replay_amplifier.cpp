@@ -0,0 +1,225 @@
+#include "replay/replay_amplifier.h"
+#include "gateway/frame_recorder.h"
+#include "gateway/telemetry_parser.h"
+#include "common/container.h"
+#include "common/crc32.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+std::vector<uint8_t> heartbeat(uint16_t src_id, uint32_t seq, bool with_crc = true) {
+    std::vector<uint8_t> buf(sizeof(TelemetryHeader) + sizeof(HeartbeatPayload) + (with_crc ? 4 : 0), 0);
+    TelemetryHeader h{};
+    h.version = PROTOCOL_VERSION;
+    h.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    h.src_id = src_id;
+    h.seq = seq;
+    h.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(h, buf.data());
+    if (with_crc) {
+        uint32_t crc = crc32(buf.data(), buf.size() - 4);
+        std::memcpy(buf.data() + buf.size() - 4, &crc, sizeof(crc));
+    }
+    return buf;
+}
+
+// Datagrams handed to any of the sinks, in arrival order
+struct Capture {
+    std::mutex mutex;
+    std::vector<std::vector<uint8_t>> datagrams;
+};
+
+class CaptureSink : public IFrameSink {
+public:
+    explicit CaptureSink(Capture& capture) : capture_(capture) {}
+    bool send(const std::vector<uint8_t>& buf) override {
+        std::lock_guard<std::mutex> lock(capture_.mutex);
+        capture_.datagrams.push_back(buf);
+        return true;
+    }
+
+private:
+    Capture& capture_;
+};
+
+// (src_id, seq) of every frame received, per src_id, CRC checked
+std::map<uint16_t, std::vector<uint32_t>> seqs_by_source(const Capture& capture) {
+    std::map<uint16_t, std::vector<uint32_t>> out;
+    ParsedFrameBatch parsed;
+    for (const auto& d : capture.datagrams) {
+        FrameView view{d.data(), d.size()};
+        parse_frames(&view, 1, true, parsed);
+        EXPECT_EQ(parsed.error_count, 0u);
+        for (std::size_t i = 0; i < parsed.count; ++i)
+            out[parsed.headers[i].src_id].push_back(parsed.headers[i].seq);
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+class ReplayAmplifierTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_file_ = "/tmp/test_replay_amplifier_" + std::to_string(rand()) + ".bin";
+    }
+
+    void TearDown() override {
+        std::remove(test_file_.c_str());
+    }
+
+    // Sources 1 and 2, 1 ms apart; source 2 has a recorded gap (seq 3 missing)
+    // and the last datagram is a v2 container holding one frame of each
+    void record_session() {
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(test_file_));
+        uint64_t ts = 1000000;
+        for (uint32_t i = 0; i < 6; ++i) {
+            auto a = heartbeat(1, i);
+            ASSERT_TRUE(recorder.record(ts, a.data(), a.size()));
+            ts += 1000000;
+            if (i == 3)
+                continue;
+            auto b = heartbeat(2, i);
+            ASSERT_TRUE(recorder.record(ts, b.data(), b.size()));
+            ts += 1000000;
+        }
+        auto c = pack_containers({heartbeat(1, 6, false), heartbeat(2, 6, false)});
+        ASSERT_EQ(c.size(), 1u);
+        ASSERT_TRUE(recorder.record(ts, c[0].data(), c[0].size()));
+        recorder.close();
+    }
+
+    ReplayAmplifier::SinkFactory capture_sinks() {
+        return [this](std::size_t) { return std::make_unique<CaptureSink>(capture_); };
+    }
+
+    std::string test_file_;
+    Capture capture_;
+};
+
+TEST_F(ReplayAmplifierTest, CopiesBecomeDistinctSources) {
+    record_session();
+    AmplifyOptions opts;
+    opts.copies = 4;
+    opts.speed = 0.0;
+    ReplayAmplifier amp(opts);
+    ASSERT_TRUE(amp.open(test_file_));
+    EXPECT_EQ(amp.recorded_frames(), 12u);
+    EXPECT_EQ(amp.src_stride(), 3u); // highest src_id + 1
+    ASSERT_TRUE(amp.run(capture_sinks()));
+    EXPECT_EQ(amp.frames_sent(), 48u);
+    EXPECT_EQ(amp.send_failures(), 0u);
+    ASSERT_EQ(capture_.datagrams.size(), 48u);
+
+    auto seqs = seqs_by_source(capture_);
+    ASSERT_EQ(seqs.size(), 8u);
+    for (uint16_t k = 0; k < 4; ++k) {
+        EXPECT_EQ(seqs[1 + 3 * k], (std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6}));
+        EXPECT_EQ(seqs[2 + 3 * k], (std::vector<uint32_t>{0, 1, 2, 4, 5, 6})); // gap kept
+    }
+}
+
+TEST_F(ReplayAmplifierTest, LoopsContinueSequenceNumbers) {
+    record_session();
+    AmplifyOptions opts;
+    opts.copies = 2;
+    opts.src_stride = 100;
+    opts.speed = 0.0;
+    opts.loops = 3;
+    ReplayAmplifier amp(opts);
+    ASSERT_TRUE(amp.open(test_file_));
+    ASSERT_TRUE(amp.run(capture_sinks()));
+    EXPECT_EQ(amp.frames_sent(), 12u * 2 * 3);
+
+    auto seqs = seqs_by_source(capture_);
+    ASSERT_EQ(seqs.size(), 4u);
+    for (uint16_t src : {1, 101}) {
+        std::vector<uint32_t> expected;
+        for (uint32_t s = 0; s < 21; ++s)
+            expected.push_back(s);
+        EXPECT_EQ(seqs[src], expected);
+    }
+    for (uint16_t src : {2, 102}) {
+        EXPECT_EQ(seqs[src], (std::vector<uint32_t>{0, 1, 2, 4, 5, 6, 7, 8, 9, 11, 12, 13,
+                                                    14, 15, 16, 18, 19, 20}));
+    }
+}
+
+TEST_F(ReplayAmplifierTest, SenderThreadsShareTheCopies) {
+    record_session();
+    AmplifyOptions opts;
+    opts.copies = 5;
+    opts.threads = 3;
+    opts.speed = 0.0;
+    ReplayAmplifier amp(opts);
+    ASSERT_TRUE(amp.open(test_file_));
+    EXPECT_EQ(amp.threads(), 3u);
+    ASSERT_TRUE(amp.run(capture_sinks()));
+    EXPECT_EQ(amp.frames_sent(), 60u);
+
+    auto seqs = seqs_by_source(capture_);
+    ASSERT_EQ(seqs.size(), 10u);
+    for (const auto& s : seqs)
+        EXPECT_EQ(s.second.size(), s.first % 3 == 1 ? 7u : 6u);
+
+    // More threads than copies: one copy per thread
+    AmplifyOptions many = opts;
+    many.threads = 16;
+    ReplayAmplifier amp2(many);
+    ASSERT_TRUE(amp2.open(test_file_));
+    EXPECT_EQ(amp2.threads(), 5u);
+}
+
+TEST_F(ReplayAmplifierTest, TargetRateSetsSpeed) {
+    record_session();
+    AmplifyOptions opts;
+    opts.copies = 4;
+    opts.target_fps = 4000.0; // 48 datagrams per loop: 12 ms
+    opts.spin_ns = 0;
+    ReplayAmplifier amp(opts);
+    ASSERT_TRUE(amp.open(test_file_));
+    EXPECT_EQ(amp.recorded_span_ns(), 11000000u);
+    EXPECT_NEAR(amp.speed(), 1.0, 1e-9); // 12 records over 11 ms + one 1 ms interval
+
+    uint64_t start = ReplayPacer::now_ns();
+    ASSERT_TRUE(amp.run(capture_sinks()));
+    uint64_t elapsed = ReplayPacer::now_ns() - start;
+    EXPECT_GE(elapsed, 11000000u);
+    EXPECT_EQ(amp.frames_sent(), 48u);
+
+    PacingStats p = amp.pacing_stats();
+    EXPECT_EQ(p.frames, 48u);
+    EXPECT_EQ(p.slots, 12u); // the 4 copies of a record go out together
+}
+
+TEST_F(ReplayAmplifierTest, RejectsSrcIdOverflow) {
+    record_session();
+    AmplifyOptions opts;
+    opts.copies = 700;
+    opts.src_stride = 100;
+    ReplayAmplifier amp(opts);
+    EXPECT_FALSE(amp.open(test_file_));
+    EXPECT_FALSE(amp.run(capture_sinks()));
+
+    opts.copies = 600; // highest src_id 59902
+    ReplayAmplifier fits(opts);
+    EXPECT_TRUE(fits.open(test_file_));
+}
+
+TEST_F(ReplayAmplifierTest, MissingFileAndSink) {
+    ReplayAmplifier amp;
+    EXPECT_FALSE(amp.open("/tmp/does_not_exist_nng_amplify.bin"));
+
+    record_session();
+    ASSERT_TRUE(amp.open(test_file_));
+    EXPECT_FALSE(amp.run([](std::size_t) { return std::unique_ptr<IFrameSink>(); }));
+}
@@ -1,7 +1,14 @@
 #include "replay/replay_engine.h"
 #include "gateway/frame_recorder.h"
+#include "gateway/telemetry_parser.h"
+#include "common/container.h"
+#include "common/crc32.h"
 #include <gtest/gtest.h>
+#include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
 
 using namespace nng;
 
@@ -188,3 +195,462 @@ TEST_F(ReplayEngineTest, ByteIdenticalFrames) {
         }
     }
 }
+
+TEST_F(ReplayEngineTest, ReceiveBatchReadsIntoSlots) {
+    std::vector<std::vector<uint8_t>> original_frames;
+    {
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(test_file_));
+        for (int i = 0; i < 10; ++i) {
+            std::vector<uint8_t> frame(static_cast<std::size_t>(i + 1), static_cast<uint8_t>(i));
+            original_frames.push_back(frame);
+            recorder.record(i * 1000, FrameView{frame.data(), frame.size()});
+        }
+        recorder.close();
+    }
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open(test_file_));
+    replay.set_speed(0.0);
+
+    // Capacity 4: batches of 4, 4, 2
+    FrameBatch batch(4);
+    std::size_t total = 0;
+    std::vector<std::size_t> sizes;
+    while (!replay.is_done()) {
+        std::size_t n = replay.receive_batch(batch);
+        if (n == 0)
+            break;
+        sizes.push_back(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto& expected = original_frames[total + i];
+            ASSERT_EQ(batch[i].len, expected.size());
+            EXPECT_EQ(std::memcmp(batch[i].data, expected.data(), expected.size()), 0);
+        }
+        total += n;
+    }
+
+    EXPECT_EQ(total, 10u);
+    EXPECT_EQ(sizes, (std::vector<std::size_t>{4, 4, 2}));
+    EXPECT_EQ(replay.frames_replayed(), 10u);
+}
+
+namespace {
+
+// 10000 frames of 400 bytes (tens of chunks), frame i at 1000 + 100*i ns
+void record_numbered(const std::string& path, Codec codec = Codec::NONE) {
+    FrameRecorder recorder;
+    RecorderOptions opts;
+    opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES;
+    opts.codec = codec;
+    ASSERT_TRUE(recorder.open(path, opts));
+    std::vector<uint8_t> frame(400, 0);
+    for (uint32_t i = 0; i < 10000; ++i) {
+        std::memcpy(frame.data(), &i, sizeof(i));
+        recorder.record(1000 + uint64_t{i} * 100, frame.data(), frame.size());
+    }
+    recorder.close();
+}
+
+uint32_t frame_number(const std::vector<uint8_t>& buf) {
+    uint32_t n = 0;
+    std::memcpy(&n, buf.data(), sizeof(n));
+    return n;
+}
+
+} // anonymous namespace
+
+TEST_F(ReplayEngineTest, SeekFrameUsesIndex) {
+    record_numbered(test_file_);
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open(test_file_));
+    replay.set_speed(0.0);
+    EXPECT_TRUE(replay.is_chunked());
+    EXPECT_EQ(replay.frame_total(), 10000u);
+
+    std::vector<uint8_t> buf;
+    for (uint64_t target : {7777u, 0u, 9999u, 320u}) {
+        ASSERT_TRUE(replay.seek_frame(target));
+        EXPECT_EQ(replay.frames_replayed(), target);
+        ASSERT_TRUE(replay.receive(buf));
+        EXPECT_EQ(frame_number(buf), target);
+    }
+    EXPECT_FALSE(replay.seek_frame(10000));
+    EXPECT_TRUE(replay.is_done());
+}
+
+TEST_F(ReplayEngineTest, SeekTimeFindsFirstFrameAtOrAfter) {
+    record_numbered(test_file_);
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open(test_file_));
+    replay.set_speed(0.0);
+
+    std::vector<uint8_t> buf;
+    ASSERT_TRUE(replay.seek_time(1000 + 4242 * 100));
+    ASSERT_TRUE(replay.receive(buf));
+    EXPECT_EQ(frame_number(buf), 4242u);
+
+    ASSERT_TRUE(replay.seek_time(1000 + 5000 * 100 + 1)); // between frames
+    EXPECT_EQ(replay.frames_replayed(), 5001u);
+    ASSERT_TRUE(replay.receive(buf));
+    EXPECT_EQ(frame_number(buf), 5001u);
+
+    // Reading continues across chunk boundaries after a seek
+    std::size_t rest = 1;
+    while (replay.receive(buf))
+        ++rest;
+    EXPECT_EQ(rest, 10000u - 5001u);
+
+    EXPECT_FALSE(replay.seek_time(1000 + 10000 * 100));
+}
+
+TEST_F(ReplayEngineTest, ReadsLegacyFormat) {
+    // Headerless [ts][len][data] stream written by older recorders
+    {
+        std::ofstream out(test_file_, std::ios::binary);
+        for (uint32_t i = 0; i < 5; ++i) {
+            uint64_t ts = 100 * (i + 1);
+            uint32_t len = 4;
+            out.write(reinterpret_cast<const char*>(&ts), sizeof(ts));
+            out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+            out.write(reinterpret_cast<const char*>(&i), sizeof(i));
+        }
+    }
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open(test_file_));
+    replay.set_speed(0.0);
+    EXPECT_FALSE(replay.is_chunked());
+    EXPECT_EQ(replay.frame_total(), 0u);
+
+    std::vector<uint8_t> buf;
+    ASSERT_TRUE(replay.seek_time(300));
+    ASSERT_TRUE(replay.receive(buf));
+    EXPECT_EQ(frame_number(buf), 2u);
+    ASSERT_TRUE(replay.seek_frame(4));
+    ASSERT_TRUE(replay.receive(buf));
+    EXPECT_EQ(frame_number(buf), 4u);
+    EXPECT_TRUE(replay.is_done());
+
+    ASSERT_TRUE(replay.seek_frame(0));
+    std::size_t n = 0;
+    while (replay.receive(buf))
+        ++n;
+    EXPECT_EQ(n, 5u);
+}
+
+TEST_F(ReplayEngineTest, NextViewPointsIntoMapping) {
+    record_numbered(test_file_);
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open(test_file_));
+    replay.set_speed(0.0);
+    EXPECT_TRUE(replay.is_mapped());
+
+    RecordedFrame first;
+    ASSERT_TRUE(replay.next_view(first));
+    RecordedFrame f;
+    uint32_t expected = 1;
+    while (replay.next_view(f)) {
+        uint32_t n;
+        std::memcpy(&n, f.data, sizeof(n));
+        ASSERT_EQ(n, expected++);
+        ASSERT_EQ(f.len, 400u);
+    }
+    EXPECT_EQ(expected, 10000u);
+    EXPECT_TRUE(replay.is_done());
+
+    // Raw chunks are not copied: earlier views stay valid until close
+    uint32_t n;
+    std::memcpy(&n, first.data, sizeof(n));
+    EXPECT_EQ(n, 0u);
+    EXPECT_EQ(first.rx_ts_ns, 1000u);
+}
+
+TEST_F(ReplayEngineTest, MappedAndStreamReadsAgree) {
+    for (Codec codec : {Codec::NONE, Codec::LZ4}) {
+        record_numbered(test_file_, codec);
+        RecordingReader stream, mapped;
+        ASSERT_TRUE(stream.open(test_file_));
+        ASSERT_TRUE(mapped.open(test_file_, true));
+        EXPECT_FALSE(stream.is_mapped());
+        EXPECT_TRUE(mapped.is_mapped());
+        mapped.set_read_ahead(3);
+
+        ASSERT_TRUE(stream.seek_frame(2500));
+        ASSERT_TRUE(mapped.seek_frame(2500));
+        RecordedFrame a, b;
+        std::size_t n = 0;
+        while (stream.next(a)) {
+            ASSERT_TRUE(mapped.next(b));
+            ASSERT_EQ(a.rx_ts_ns, b.rx_ts_ns);
+            ASSERT_EQ(a.len, b.len);
+            ASSERT_EQ(std::memcmp(a.data, b.data, a.len), 0);
+            ++n;
+        }
+        EXPECT_FALSE(mapped.next(b));
+        EXPECT_TRUE(mapped.at_end());
+        EXPECT_EQ(n, 7500u);
+    }
+}
+
+TEST_F(ReplayEngineTest, MappedLegacyIgnoresTruncatedRecord) {
+    {
+        std::ofstream out(test_file_, std::ios::binary);
+        for (uint32_t i = 0; i < 3; ++i) {
+            uint64_t ts = 100 * (i + 1);
+            uint32_t len = 4;
+            out.write(reinterpret_cast<const char*>(&ts), sizeof(ts));
+            out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+            out.write(reinterpret_cast<const char*>(&i), sizeof(i));
+        }
+        // Writer killed mid-record
+        uint64_t ts = 400;
+        uint32_t len = 100;
+        out.write(reinterpret_cast<const char*>(&ts), sizeof(ts));
+        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        out.write("ab", 2);
+    }
+
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(test_file_, true));
+    EXPECT_TRUE(reader.is_mapped());
+    RecordedFrame f;
+    std::size_t n = 0;
+    while (reader.next(f))
+        ++n;
+    EXPECT_EQ(n, 3u);
+
+    ASSERT_TRUE(reader.seek_time(250));
+    ASSERT_TRUE(reader.next(f));
+    EXPECT_EQ(f.rx_ts_ns, 300u);
+}
+
+namespace {
+
+// Advances 100 ns per read, so waits end a tick past their deadline
+// however the test is scheduled
+std::atomic<uint64_t> manual_clock_ns{0};
+uint64_t manual_clock() { return manual_clock_ns.fetch_add(100) + 100; }
+
+} // anonymous namespace
+
+TEST_F(ReplayEngineTest, PacedBatchesGroupFramesOfOneSlot) {
+    {
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(test_file_));
+        uint8_t data[8] = {};
+        // Three frames within 20 us, then two 5 ms later
+        for (uint64_t ts : {1000000u, 1010000u, 1020000u, 6000000u, 6010000u})
+            ASSERT_TRUE(recorder.record(ts, data, sizeof(data)));
+        recorder.close();
+    }
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open(test_file_));
+    replay.set_speed(1.0);
+    replay.pacer().set_clock(&manual_clock);
+    replay.pacer().set_spin_ns(10000000); // spin on the manual clock, never sleep
+    FrameBatch batch(16);
+
+    uint64_t start = manual_clock();
+    EXPECT_EQ(replay.receive_batch(batch), 3u);
+    EXPECT_FALSE(replay.is_done());
+    EXPECT_EQ(replay.receive_batch(batch), 2u);
+    uint64_t elapsed = manual_clock() - start;
+    EXPECT_TRUE(replay.is_done());
+    EXPECT_EQ(replay.frames_replayed(), 5u);
+    EXPECT_GE(elapsed, 5000000u);
+
+    PacingStats p = replay.pacing_stats();
+    EXPECT_EQ(p.frames, 5u);
+    EXPECT_EQ(p.slots, 2u);
+    // Each slot goes out a tick after its first frame is due: the 2nd and
+    // 3rd of slot one and the 2nd of slot two leave early
+    EXPECT_EQ(p.early_frames, 3u);
+    EXPECT_LE(p.late_frames, 2u);
+    EXPECT_LE(p.max_late_ns, 100u);
+    EXPECT_GT(p.max_early_ns, 19000u); // the 3rd of slot one, 20 us early
+    EXPECT_LE(p.max_early_ns, 20000u);
+}
+
+namespace {
+
+// v1 heartbeat frame, with a trailing CRC32 if with_crc
+std::vector<uint8_t> heartbeat(uint16_t src_id, uint32_t seq, bool with_crc = true) {
+    std::vector<uint8_t> buf(sizeof(TelemetryHeader) + sizeof(HeartbeatPayload) + (with_crc ? 4 : 0), 0);
+    TelemetryHeader h{};
+    h.version = PROTOCOL_VERSION;
+    h.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    h.src_id = src_id;
+    h.seq = seq;
+    h.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(h, buf.data());
+    if (with_crc) {
+        uint32_t crc = crc32(buf.data(), buf.size() - 4);
+        std::memcpy(buf.data() + buf.size() - 4, &crc, sizeof(crc));
+    }
+    return buf;
+}
+
+// Frames with the given receive times; the frame number is the seq
+void record_at(const std::string& path, uint16_t src_id, const std::vector<uint64_t>& ts) {
+    FrameRecorder recorder;
+    RecorderOptions opts;
+    opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES;
+    ASSERT_TRUE(recorder.open(path, opts));
+    for (std::size_t i = 0; i < ts.size(); ++i) {
+        auto frame = heartbeat(src_id, static_cast<uint32_t>(i));
+        ASSERT_TRUE(recorder.record(ts[i], frame.data(), frame.size()));
+    }
+    recorder.close();
+}
+
+TelemetryHeader parsed_header(const std::vector<uint8_t>& buf) {
+    ParsedFrame f;
+    EXPECT_EQ(parse_frame(buf.data(), buf.size(), true, f), ParseError::OK);
+    return f.header;
+}
+
+} // anonymous namespace
+
+TEST_F(ReplayEngineTest, MergesFilesInTimestampOrder) {
+    std::string second = test_file_ + ".b";
+    std::vector<uint64_t> ts_a, ts_b;
+    for (uint64_t i = 0; i < 3000; ++i) {
+        ts_a.push_back(1000 + i * 30);          // steady
+        ts_b.push_back(1000 + i * 45 + i % 7);  // faster drift, ties with a
+    }
+    record_at(test_file_, 1, ts_a);
+    record_at(second, 2, ts_b);
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open({ReplayInput{test_file_, 0}, ReplayInput{second, 0}}));
+    replay.set_speed(0.0);
+    EXPECT_EQ(replay.input_count(), 2u);
+    EXPECT_EQ(replay.frame_total(), 6000u);
+
+    FrameBatch batch(64);
+    uint64_t last_ts = 0;
+    uint32_t next_seq[3] = {0, 0, 0};
+    std::size_t n = 0;
+    std::vector<uint8_t> frame;
+    while (!replay.is_done()) {
+        std::size_t got = replay.receive_batch(batch);
+        for (std::size_t i = 0; i < got; ++i) {
+            frame.assign(batch[i].data, batch[i].data + batch[i].len);
+            TelemetryHeader h = parsed_header(frame);
+            ASSERT_TRUE(h.src_id == 1 || h.src_id == 2);
+            // Each file's frames stay in order
+            EXPECT_EQ(h.seq, next_seq[h.src_id]++);
+            uint64_t ts = h.src_id == 1 ? ts_a[h.seq] : ts_b[h.seq];
+            EXPECT_GE(ts, last_ts);
+            last_ts = ts;
+            ++n;
+        }
+    }
+    EXPECT_EQ(n, 6000u);
+    EXPECT_EQ(replay.frames_replayed(), 6000u);
+    std::remove(second.c_str());
+}
+
+TEST_F(ReplayEngineTest, MergeTiesGoToEarlierInput) {
+    std::string second = test_file_ + ".b";
+    record_at(test_file_, 1, {100, 200, 300});
+    record_at(second, 2, {100, 200, 300});
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open({ReplayInput{test_file_, 0}, ReplayInput{second, 0}}));
+    replay.set_speed(0.0);
+    std::vector<uint8_t> buf;
+    std::vector<uint16_t> order;
+    while (replay.receive(buf))
+        order.push_back(parsed_header(buf).src_id);
+    EXPECT_EQ(order, (std::vector<uint16_t>{1, 2, 1, 2, 1, 2}));
+    EXPECT_TRUE(replay.is_done());
+    std::remove(second.c_str());
+}
+
+TEST_F(ReplayEngineTest, SrcOffsetRemapsAndKeepsCrcValid) {
+    std::string second = test_file_ + ".b";
+    record_at(test_file_, 5, {100, 300});
+    record_at(second, 5, {200, 400});
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open({ReplayInput{test_file_, 0}, ReplayInput{second, 1000}}));
+    replay.set_speed(0.0);
+    std::vector<uint8_t> buf;
+    std::vector<uint16_t> ids;
+    while (replay.receive(buf))
+        ids.push_back(parsed_header(buf).src_id); // CRC checked
+    EXPECT_EQ(ids, (std::vector<uint16_t>{5, 1005, 5, 1005}));
+
+    // next_view() hands out remapped copies for offset inputs
+    ASSERT_TRUE(replay.seek_time(0));
+    RecordedFrame f;
+    ASSERT_TRUE(replay.next_view(f));
+    ASSERT_TRUE(replay.next_view(f));
+    ParsedFrame pf;
+    ASSERT_EQ(parse_frame(f.data, f.len, true, pf), ParseError::OK);
+    EXPECT_EQ(pf.header.src_id, 1005u);
+    std::remove(second.c_str());
+}
+
+TEST_F(ReplayEngineTest, RemapSrcIdsInContainer) {
+    auto containers = pack_containers({heartbeat(7, 0, false), heartbeat(8, 1, false)});
+    ASSERT_EQ(containers.size(), 1u);
+    std::vector<uint8_t>& c = containers[0];
+    remap_src_ids(c.data(), c.size(), 100);
+
+    FrameView view{c.data(), c.size()};
+    ParsedFrameBatch parsed;
+    ASSERT_EQ(parse_frames(&view, 1, true, parsed), 2u);
+    EXPECT_EQ(parsed.error_count, 0u);
+    EXPECT_EQ(parsed.headers[0].src_id, 107u);
+    EXPECT_EQ(parsed.headers[1].src_id, 108u);
+
+    // A frame whose CRC was already bad stays bad
+    auto bad = heartbeat(7, 0);
+    bad.back() ^= 0xFF;
+    remap_src_ids(bad.data(), bad.size(), 100);
+    ParsedFrame f;
+    EXPECT_EQ(parse_frame(bad.data(), bad.size(), true, f), ParseError::CRC_MISMATCH);
+}
+
+TEST_F(ReplayEngineTest, SeekAcrossMergedInputs) {
+    std::string second = test_file_ + ".b";
+    record_at(test_file_, 1, {100, 200, 300, 400});
+    record_at(second, 2, {150, 250});
+
+    ReplayFrameSource replay;
+    ASSERT_TRUE(replay.open({ReplayInput{test_file_, 0}, ReplayInput{second, 0}}));
+    replay.set_speed(0.0);
+    EXPECT_FALSE(replay.seek_frame(1)); // frame numbers are per file
+
+    // The second file has nothing at or after 260 and drops out
+    ASSERT_TRUE(replay.seek_time(260));
+    EXPECT_EQ(replay.frames_replayed(), 2u);
+    std::vector<uint8_t> buf;
+    std::vector<uint32_t> seqs;
+    while (replay.receive(buf)) {
+        EXPECT_EQ(parsed_header(buf).src_id, 1u);
+        seqs.push_back(parsed_header(buf).seq);
+    }
+    EXPECT_EQ(seqs, (std::vector<uint32_t>{2, 3}));
+
+    ASSERT_TRUE(replay.seek_time(0));
+    std::size_t n = 0;
+    while (replay.receive(buf))
+        ++n;
+    EXPECT_EQ(n, 6u);
+    EXPECT_FALSE(replay.seek_time(500));
+    EXPECT_TRUE(replay.is_done());
+    std::remove(second.c_str());
+}
+
+TEST_F(ReplayEngineTest, OpenFailsIfAnyInputMissing) {
+    record_at(test_file_, 1, {100});
+    ReplayFrameSource replay;
+    EXPECT_FALSE(replay.open({ReplayInput{test_file_, 0},
+                              ReplayInput{"/tmp/nonexistent_nng_merge.bin", 0}}));
+    EXPECT_FALSE(replay.is_open());
+}
@@ -0,0 +1,44 @@
+#include "replay/replay_pacer.h"
+#include <gtest/gtest.h>
+
+using namespace nng;
+
+TEST(ReplayPacerTest, WaitUntilReturnsAtOrAfterDeadline) {
+    ReplayPacer pacer;
+    for (uint64_t delay_ns : {0u, 50000u, 300000u, 2000000u}) {
+        uint64_t deadline = ReplayPacer::now_ns() + delay_ns;
+        uint64_t released = pacer.wait_until(deadline);
+        EXPECT_GE(released, deadline);
+        EXPECT_GE(ReplayPacer::now_ns(), deadline);
+    }
+}
+
+TEST(ReplayPacerTest, PastDeadlineReturnsAtOnce) {
+    ReplayPacer pacer;
+    uint64_t now = ReplayPacer::now_ns();
+    uint64_t released = pacer.wait_until(now - 1000000);
+    EXPECT_LT(released - now, 1000000u);
+}
+
+TEST(ReplayPacerTest, RecordsLateAndEarlyFrames) {
+    ReplayPacer pacer;
+    pacer.record(1000, 1000);  // on time
+    pacer.record(1000, 4000);  // 3 us late
+    pacer.record(10000, 9000); // 1 us early
+    pacer.count_slot();
+    pacer.count_slot();
+
+    PacingStats s = pacer.stats();
+    EXPECT_EQ(s.frames, 3u);
+    EXPECT_EQ(s.slots, 2u);
+    EXPECT_EQ(s.late_frames, 1u);
+    EXPECT_EQ(s.early_frames, 1u);
+    EXPECT_EQ(s.max_late_ns, 3000u);
+    EXPECT_EQ(s.max_early_ns, 1000u);
+    EXPECT_EQ(s.late_ns.count, 2u);
+    EXPECT_DOUBLE_EQ(s.mean_abs_error_ns, 4000.0 / 3);
+
+    pacer.reset();
+    EXPECT_EQ(pacer.stats().frames, 0u);
+    EXPECT_EQ(pacer.stats().max_late_ns, 0u);
+}
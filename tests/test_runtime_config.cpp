@@ -0,0 +1,180 @@
+#include "gateway/runtime_config.h"
+#include "gateway/gateway.h"
+#include "gateway/frame_recorder.h"
+#include "common/crc32.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+template <typename P>
+std::vector<uint8_t> frame(MsgType type, uint16_t src_id, uint32_t seq, const P& payload) {
+    std::vector<uint8_t> buf(sizeof(TelemetryHeader) + sizeof(P) + 4, 0);
+    TelemetryHeader h{};
+    h.version = PROTOCOL_VERSION;
+    h.msg_type = static_cast<uint8_t>(type);
+    h.src_id = src_id;
+    h.seq = seq;
+    h.payload_len = sizeof(P);
+    serialize_header(h, buf.data());
+    std::memcpy(buf.data() + sizeof(TelemetryHeader), &payload, sizeof(P));
+    uint32_t crc = crc32(buf.data(), buf.size() - 4);
+    std::memcpy(buf.data() + buf.size() - 4, &crc, sizeof(crc));
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(RuntimeConfigTest, OverloadRaisesEventLevel) {
+    RuntimeConfig r;
+    EXPECT_EQ(r.effective_event_level(), Severity::DEBUG);
+    EXPECT_FALSE(r.overloaded());
+
+    r.set_overload_detected(true);
+    EXPECT_TRUE(r.overloaded());
+    EXPECT_EQ(r.effective_event_level(), Severity::INFO);
+    EXPECT_EQ(r.overload_entries(), 1u);
+
+    // A forced mode overrides the monitor
+    r.set_overload_mode(OverloadMode::OFF);
+    EXPECT_FALSE(r.overloaded());
+    EXPECT_EQ(r.effective_event_level(), Severity::DEBUG);
+    r.set_overload_detected(false);
+    r.set_overload_mode(OverloadMode::ON);
+    EXPECT_TRUE(r.overloaded());
+    EXPECT_EQ(r.overload_entries(), 2u);
+
+    // Never lowers a level already above INFO
+    r.set_event_level(Severity::ALARM);
+    EXPECT_EQ(r.effective_event_level(), Severity::ALARM);
+    r.set_overload_mode(OverloadMode::AUTO);
+    EXPECT_FALSE(r.overloaded());
+    EXPECT_EQ(r.effective_event_level(), Severity::ALARM);
+}
+
+TEST(RuntimeConfigTest, RecordingNeedsRecorder) {
+    RuntimeConfig r;
+    EXPECT_FALSE(r.set_recording(true));
+    EXPECT_FALSE(r.recording());
+    EXPECT_TRUE(r.set_recording(false));
+
+    r.set_recorder_open(true);
+    EXPECT_TRUE(r.recording());
+    EXPECT_TRUE(r.set_recording(false));
+    EXPECT_FALSE(r.recording());
+    EXPECT_TRUE(r.set_recording(true));
+    r.set_recorder_open(false);
+    EXPECT_FALSE(r.recording());
+
+    r.set_plot_sample(0);
+    EXPECT_EQ(r.plot_sample(), 1u);
+}
+
+TEST(OverloadMonitorTest, Hysteresis) {
+    OverloadOptions opts;
+    opts.enter_samples = 2;
+    opts.exit_samples = 3;
+    OverloadMonitor m(opts);
+
+    EXPECT_FALSE(m.sample(0.9, 0.1)); // one high sample is not enough
+    EXPECT_FALSE(m.sample(0.1, 0.1));
+    EXPECT_FALSE(m.sample(0.1, 0.99));
+    EXPECT_TRUE(m.sample(0.9, 0.1)); // queue then CPU: either signal counts
+
+    // Between the marks holds the state
+    EXPECT_TRUE(m.sample(0.5, 0.5));
+    EXPECT_TRUE(m.sample(0.1, 0.1));
+    EXPECT_TRUE(m.sample(0.1, 0.1));
+    EXPECT_TRUE(m.sample(0.1, 0.8)); // CPU still over its low mark
+    EXPECT_TRUE(m.sample(0.1, 0.1));
+    EXPECT_TRUE(m.sample(0.1, 0.1));
+    EXPECT_FALSE(m.sample(0.1, 0.1));
+}
+
+class RuntimeGatewayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = "/tmp/test_runtime_config_" + std::to_string(rand()) + ".bin";
+        Logger::instance().set_output(log_);
+        Logger::instance().set_level(Severity::ERROR);
+
+        // 100 plots and 5 engagements from source 1
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(path_));
+        uint64_t ts = 1000000;
+        uint32_t seq = 0;
+        for (uint32_t i = 0; i < 100; ++i) {
+            PlotPayload plot{};
+            plot.plot_id = i;
+            auto f = frame(MsgType::PLOT, 1, seq++, plot);
+            ASSERT_TRUE(recorder.record(ts += 1000, f.data(), f.size()));
+            if (i % 20 == 0) {
+                EngagementPayload eng{};
+                auto e = frame(MsgType::ENGAGEMENT, 1, seq++, eng);
+                ASSERT_TRUE(recorder.record(ts += 1000, e.data(), e.size()));
+            }
+        }
+        recorder.close();
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    struct Counts {
+        int plots = 0;
+        int engagements = 0;
+    };
+
+    Counts replay(const GatewayConfig& base, OverloadMode mode = OverloadMode::AUTO) {
+        GatewayConfig config = base;
+        config.replay_path = path_;
+        config.log_level = Severity::ERROR;
+        Gateway gateway(config);
+        gateway.runtime().set_overload_mode(mode);
+        Counts c;
+        gateway.events().subscribe_all([&c](const EventRecord& e) {
+            if (e.id == EventId::EVT_TRACK_NEW)
+                ++c.plots;
+            else if (e.id == EventId::EVT_WEAPON_STATUS)
+                ++c.engagements;
+        });
+        gateway.run();
+        EXPECT_EQ(gateway.stats().get_global_stats().rx_total, 105u);
+        return c;
+    }
+
+    std::string path_;
+    std::ostringstream log_;
+};
+
+TEST_F(RuntimeGatewayTest, KnobsShapeEvents) {
+    GatewayConfig config;
+    Counts all = replay(config);
+    EXPECT_EQ(all.plots, 100);
+    EXPECT_EQ(all.engagements, 5);
+
+    config.plot_sample = 10;
+    Counts sampled = replay(config);
+    EXPECT_EQ(sampled.plots, 11); // plots whose seq is a multiple of 10
+    EXPECT_EQ(sampled.engagements, 5);
+
+    config.plot_sample = 1;
+    config.event_level = Severity::INFO;
+    Counts info = replay(config);
+    EXPECT_EQ(info.plots, 0);
+    EXPECT_EQ(info.engagements, 5);
+}
+
+TEST_F(RuntimeGatewayTest, ForcedOverloadShedsDebugEvents) {
+    GatewayConfig config;
+    Counts shed = replay(config, OverloadMode::ON);
+    EXPECT_EQ(shed.plots, 0);
+    EXPECT_EQ(shed.engagements, 5); // INFO and above still flow
+}
@@ -0,0 +1,154 @@
+#include "sensor_sim/scenario_renderer.h"
+#include "sensor_sim/world_model.h"
+#include "gateway/recording_reader.h"
+#include "gateway/telemetry_parser.h"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+struct Frame {
+    uint64_t ts_ns;
+    std::vector<uint8_t> bytes;
+    bool operator==(const Frame& o) const { return ts_ns == o.ts_ns && bytes == o.bytes; }
+};
+
+std::string temp_path(const char* name) {
+    return "/tmp/nng_render_" + std::to_string(::getpid()) + "_" + name + ".bin";
+}
+
+std::vector<Frame> read_all(const std::string& path) {
+    std::vector<Frame> out;
+    RecordingReader reader;
+    EXPECT_TRUE(reader.open(path));
+    RecordedFrame f;
+    while (reader.next(f))
+        out.push_back(Frame{f.rx_ts_ns, std::vector<uint8_t>(f.data, f.data + f.len)});
+    return out;
+}
+
+RenderOptions options(std::size_t sensors, std::size_t threads) {
+    RenderOptions o;
+    o.profile = profile_raid();
+    o.rate_hz = 50.0;
+    o.duration_s = 2.0;
+    o.epoch_ns = 1000000000ULL;
+    o.array.sensors = sensors;
+    o.array.threads = threads;
+    o.array.seed = 7;
+    o.array.faults.loss_pct = 2.0;
+    o.array.faults.reorder_pct = 2.0;
+    return o;
+}
+
+// Records each datagram with the tick it was sent on, as the renderer does
+class CaptureSink : public IFrameSink {
+public:
+    CaptureSink(std::vector<Frame>& out, const uint64_t& ts) : out_(out), ts_(ts) {}
+    bool send(const std::vector<uint8_t>& buf) override {
+        out_.push_back(Frame{ts_, buf});
+        return true;
+    }
+
+private:
+    std::vector<Frame>& out_;
+    const uint64_t& ts_;
+};
+
+} // anonymous namespace
+
+TEST(ScenarioRendererTest, WorkerCountDoesNotChangeTheRecording) {
+    const std::string one = temp_path("one");
+    const std::string four = temp_path("four");
+    ScenarioRenderer a(options(5, 1));
+    ASSERT_TRUE(a.render(one));
+    ScenarioRenderer b(options(5, 4));
+    ASSERT_TRUE(b.render(four));
+
+    EXPECT_EQ(a.stats().ticks, 100u);
+    EXPECT_GT(a.stats().frames, 0u);
+    EXPECT_EQ(a.stats().frames, b.stats().frames);
+    EXPECT_GT(a.stats().sensors.dropped, 0u);
+    EXPECT_EQ(a.stats().sensors.dropped, b.stats().sensors.dropped);
+    std::vector<Frame> fa = read_all(one);
+    std::vector<Frame> fb = read_all(four);
+    ASSERT_EQ(fa.size(), a.stats().frames);
+    EXPECT_TRUE(fa == fb);
+
+    // Part files are gone
+    for (std::size_t i = 0; i < 4; ++i)
+        EXPECT_FALSE(std::ifstream(ScenarioRenderer::part_path(four, i)).good());
+    std::remove(one.c_str());
+    std::remove(four.c_str());
+}
+
+TEST(ScenarioRendererTest, MatchesLiveRun) {
+    RenderOptions o = options(3, 2);
+    const std::string path = temp_path("live");
+    ScenarioRenderer renderer(o);
+    ASSERT_TRUE(renderer.render(path));
+
+    // The live simulator's loop, one sink, sensors in order
+    o.array.threads = 1;
+    std::vector<Frame> live;
+    uint64_t ts = 0;
+    SensorArray array(o.array);
+    ASSERT_TRUE(array.start([&](std::size_t) { return std::make_unique<CaptureSink>(live, ts); }));
+    ObjectGenerator generator(o.profile, o.array.seed);
+    WorldModel world;
+    for (auto& obj : generator.generate_initial())
+        world.add_object(obj);
+    const double dt = 1.0 / o.rate_hz;
+    for (int tick = 0; tick < 100; ++tick) {
+        double t = tick * dt;
+        ts = o.epoch_ns + static_cast<uint64_t>(t * 1e9);
+        auto spawned = generator.maybe_spawn(t);
+        if (spawned)
+            world.add_object(*spawned);
+        world.tick(dt, t);
+        array.tick(world.objects(), ts, static_cast<uint64_t>(tick));
+    }
+    array.stop();
+
+    std::vector<Frame> rendered = read_all(path);
+    ASSERT_EQ(rendered.size(), live.size());
+    EXPECT_TRUE(rendered == live);
+    std::remove(path.c_str());
+}
+
+TEST(ScenarioRendererTest, SyntheticTimestamps) {
+    RenderOptions o = options(2, 2);
+    o.array.faults = FaultConfig{};
+    const std::string path = temp_path("ts");
+    ScenarioRenderer renderer(o);
+    ASSERT_TRUE(renderer.render(path));
+
+    uint64_t last = 0;
+    for (const Frame& f : read_all(path)) {
+        EXPECT_GE(f.ts_ns, last);
+        last = f.ts_ns;
+        // Receive time is the tick's, as stamped in the header
+        ParsedFrame pf;
+        ASSERT_EQ(parse_frame(f.bytes.data(), f.bytes.size(), false, pf), ParseError::OK);
+        EXPECT_EQ(pf.header.ts_ns, f.ts_ns);
+    }
+    // The last tick is 1.98 s in
+    EXPECT_NEAR(static_cast<double>(last - o.epoch_ns), 1.98e9, 1e3);
+    std::remove(path.c_str());
+}
+
+TEST(ScenarioRendererTest, FailsCleanly) {
+    std::string error;
+    ScenarioRenderer bad_path(options(2, 2));
+    EXPECT_FALSE(bad_path.render("/nonexistent-dir/out.bin", &error));
+    EXPECT_NE(error.find("cannot write"), std::string::npos);
+
+    ScenarioRenderer none(options(0, 1));
+    EXPECT_FALSE(none.render(temp_path("none"), &error));
+    EXPECT_EQ(error, "nothing to render");
+}
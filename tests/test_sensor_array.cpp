@@ -0,0 +1,205 @@
+#include "sensor_sim/sensor_array.h"
+#include "sensor_sim/world_model.h"
+#include "gateway/telemetry_parser.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+using Datagrams = std::vector<std::vector<uint8_t>>;
+
+class CaptureSink : public IFrameSink {
+public:
+    explicit CaptureSink(Datagrams& out) : out_(out) {}
+    bool send(const std::vector<uint8_t>& buf) override {
+        out_.push_back(buf);
+        return true;
+    }
+
+private:
+    Datagrams& out_;
+};
+
+// Datagrams of each src_id, in the order sent
+std::map<uint16_t, Datagrams> by_source(const std::vector<Datagrams>& sinks) {
+    std::map<uint16_t, Datagrams> out;
+    for (const auto& sink : sinks) {
+        for (const auto& d : sink) {
+            ParsedFrame pf;
+            parse_frame(d.data(), d.size(), false, pf);
+            out[pf.header.src_id].push_back(d);
+        }
+    }
+    return out;
+}
+
+// Per-thread capture of a run of ticks over a patrol world
+std::vector<Datagrams> run(SensorArrayOptions opts, int ticks) {
+    ObjectGenerator generator(profile_patrol(), 42);
+    WorldModel world;
+    for (auto& obj : generator.generate_initial())
+        world.add_object(obj);
+
+    std::vector<Datagrams> sinks(opts.threads);
+    SensorArray array(opts);
+    EXPECT_TRUE(array.start([&sinks](std::size_t t) { return std::make_unique<CaptureSink>(sinks[t]); }));
+    for (int tick = 0; tick < ticks; ++tick) {
+        double t = tick * 0.02;
+        world.tick(0.02, t);
+        array.tick(world.objects(), static_cast<uint64_t>(t * 1e9), static_cast<uint64_t>(tick));
+    }
+    array.stop();
+    return sinks;
+}
+
+} // anonymous namespace
+
+TEST(SensorArrayTest, ThreadCountDoesNotChangeWhatSensorsSend) {
+    SensorArrayOptions opts;
+    opts.sensors = 5;
+    opts.faults.loss_pct = 10.0;
+    opts.faults.reorder_pct = 5.0;
+    opts.threads = 1;
+    auto one = by_source(run(opts, 60));
+    opts.threads = 3;
+    auto three = by_source(run(opts, 60));
+
+    ASSERT_EQ(one.size(), 5u);
+    EXPECT_EQ(one, three);
+    // Different seeds: sensors do not send identical streams
+    EXPECT_NE(one[1], one[2]);
+}
+
+TEST(SensorArrayTest, SensorZeroMatchesSingleSensorRun) {
+    SensorArrayOptions opts;
+    opts.sensors = 3;
+    opts.threads = 2;
+    opts.seed = 7;
+    opts.faults.loss_pct = 5.0;
+    auto sent = by_source(run(opts, 30));
+
+    // What sensor_sim always sent with one sensor
+    ObjectGenerator generator(profile_patrol(), 42);
+    WorldModel world;
+    for (auto& obj : generator.generate_initial())
+        world.add_object(obj);
+    MeasurementGenerator measurer(1, opts.seed + 100);
+    FaultInjector injector(opts.faults, opts.seed + 200);
+    Datagrams expected;
+    for (int tick = 0; tick < 30; ++tick) {
+        double t = tick * 0.02;
+        world.tick(0.02, t);
+        uint64_t ts = static_cast<uint64_t>(t * 1e9);
+        auto frames = measurer.generate_tracks(world.objects(), ts);
+        auto plots = measurer.generate_plots(world.objects(), ts);
+        frames.insert(frames.end(), plots.begin(), plots.end());
+        if (tick % 50 == 0)
+            frames.push_back(measurer.generate_heartbeat(ts));
+        injector.apply(frames);
+        expected.insert(expected.end(), frames.begin(), frames.end());
+    }
+    EXPECT_EQ(sent[1], expected);
+}
+
+TEST(SensorArrayTest, EachSensorHasItsOwnSequenceSpace) {
+    SensorArrayOptions opts;
+    opts.sensors = 4;
+    opts.threads = 4;
+    opts.first_src_id = 100;
+    opts.heartbeat_ticks = 10;
+    auto sent = by_source(run(opts, 20));
+    ASSERT_EQ(sent.size(), 4u);
+
+    for (uint16_t src = 100; src < 104; ++src) {
+        const Datagrams& d = sent[src];
+        ASSERT_FALSE(d.empty());
+        int heartbeats = 0;
+        for (std::size_t i = 0; i < d.size(); ++i) {
+            ParsedFrame pf;
+            ASSERT_EQ(parse_frame(d[i].data(), d[i].size(), false, pf), ParseError::OK);
+            EXPECT_EQ(pf.header.seq, i); // no faults: contiguous from 0
+            if (pf.header.msg_type == static_cast<uint8_t>(MsgType::HEARTBEAT))
+                ++heartbeats;
+        }
+        EXPECT_EQ(heartbeats, 2);
+    }
+}
+
+TEST(SensorArrayTest, CountsAndLimits) {
+    SensorArrayOptions opts;
+    opts.sensors = 3;
+    opts.threads = 8; // capped at one thread per sensor
+    std::vector<Datagrams> sinks(8);
+    SensorArray array(opts);
+    ASSERT_TRUE(array.start([&sinks](std::size_t t) { return std::make_unique<CaptureSink>(sinks[t]); }));
+    EXPECT_EQ(array.threads(), 3u);
+    EXPECT_EQ(array.src_id(2), 3u);
+
+    WorldObject obj{};
+    obj.id = 1;
+    obj.range_m = 5000.0;
+    obj.lifetime_s = 100.0;
+    obj.rcs_dbsm = 20.0;
+    std::vector<WorldObject> objects{obj};
+    array.tick(objects, 0, 0);
+    SensorArrayStats s = array.stats();
+    EXPECT_GE(s.frames, 6u); // a track and a heartbeat per sensor, at least
+    EXPECT_EQ(s.datagrams, s.frames);
+
+    SensorArrayOptions wide;
+    wide.sensors = 2;
+    wide.first_src_id = 65535;
+    SensorArray overflow(wide);
+    EXPECT_FALSE(overflow.start([&sinks](std::size_t t) { return std::make_unique<CaptureSink>(sinks[t]); }));
+
+    SensorArray no_sink(opts);
+    EXPECT_FALSE(no_sink.start([](std::size_t) { return std::unique_ptr<IFrameSink>(); }));
+}
+
+TEST(SensorArrayTest, ScanOnlyMeasuresPaintedObjects) {
+    std::vector<WorldObject> objects;
+    for (uint32_t i = 0; i < 360; ++i) {
+        WorldObject obj{};
+        obj.id = i + 1;
+        obj.azimuth_deg = i + 0.5;
+        obj.range_m = 5000.0;
+        obj.rcs_dbsm = 30.0; // always detected
+        obj.noise_stddev = 1.0;
+        objects.push_back(obj);
+    }
+
+    SensorArrayOptions opts;
+    opts.sensors = 2;
+    opts.threads = 2;
+    opts.heartbeat_ticks = 0;
+    opts.scan = true;
+    opts.beam.rpm = 60.0; // 36 deg per 0.1 s tick: 10 ticks per revolution
+    opts.beam.width_deg = 0.0;
+    opts.tick_s = 0.1;
+
+    std::vector<Datagrams> sinks(2);
+    SensorArray array(opts);
+    ASSERT_TRUE(array.start([&sinks](std::size_t t) { return std::make_unique<CaptureSink>(sinks[t]); }));
+    for (uint64_t tick = 0; tick < 10; ++tick)
+        array.tick(objects, tick, tick);
+    array.stop();
+
+    // One revolution: each sensor paints every object once, a track and a
+    // plot each, 36 objects per tick
+    SensorArrayStats stats = array.stats();
+    EXPECT_EQ(stats.painted, 720u);
+    EXPECT_EQ(stats.frames, 1440u);
+    for (const auto& [src, frames] : by_source(sinks)) {
+        std::map<uint32_t, int> tracks;
+        for (const auto& f : frames) {
+            ParsedFrame pf;
+            ASSERT_EQ(parse_frame(f.data(), f.size(), false, pf), ParseError::OK);
+            if (pf.header.msg_type == static_cast<uint8_t>(MsgType::TRACK))
+                tracks[deserialize_track(pf.payload_ptr).track_id]++;
+        }
+        EXPECT_EQ(tracks.size(), 360u) << "src " << src;
+    }
+}
@@ -74,3 +74,143 @@ TEST(SequenceTracker, LargeGap) {
     EXPECT_EQ(ev.result, SeqResult::GAP);
     EXPECT_EQ(ev.gap_size, 999u);
 }
+
+TEST(SequenceTracker, FlatIsDefault) {
+    SequenceTracker st;
+    EXPECT_EQ(st.storage(), SeqStorage::FLAT);
+}
+
+TEST(SequenceTracker, FlatExtremeSourceIds) {
+    SequenceTracker st(SeqStorage::FLAT);
+    EXPECT_EQ(st.track(0, 7).result, SeqResult::FIRST);
+    EXPECT_EQ(st.track(0xFFFF, 9).result, SeqResult::FIRST);
+    EXPECT_EQ(st.track(0, 8).result, SeqResult::OK);
+    EXPECT_EQ(st.track(0xFFFF, 10).result, SeqResult::OK);
+    EXPECT_EQ(st.source_count(), 2u);
+
+    st.reset(0xFFFF);
+    st.reset(0xFFFF); // already reset
+    st.reset(0x1234); // never seen
+    EXPECT_EQ(st.source_count(), 1u);
+    st.reset_all();
+    EXPECT_EQ(st.source_count(), 0u);
+    EXPECT_EQ(st.track(0, 9).result, SeqResult::FIRST);
+}
+
+TEST(SequenceTracker, StorageBackendsAgree) {
+    SequenceTracker flat(SeqStorage::FLAT);
+    SequenceTracker map(SeqStorage::HASH_MAP);
+    // default window: the random reorders below reach past it
+
+    // Deterministic mix of in-order, gaps, reorders and duplicates
+    uint32_t lcg = 12345;
+    uint32_t next[16] = {};
+    for (int i = 0; i < 20000; ++i) {
+        lcg = lcg * 1103515245u + 12345u;
+        uint16_t src = static_cast<uint16_t>((lcg >> 8) % 16 * 4099);
+        uint32_t& n = next[(lcg >> 8) % 16];
+        uint32_t r = (lcg >> 16) % 100;
+        uint32_t seq = r < 80 ? n++ : r < 90 ? (n += 3) : n - 1 - (r % 70);
+        if (r == 99)
+            flat.reset(src), map.reset(src);
+
+        SeqEvent a = flat.track(src, seq);
+        SeqEvent b = map.track(src, seq);
+        ASSERT_EQ(a.result, b.result) << i;
+        ASSERT_EQ(a.expected_seq, b.expected_seq) << i;
+        ASSERT_EQ(a.gap_size, b.gap_size) << i;
+    }
+    EXPECT_EQ(flat.source_count(), map.source_count());
+}
+
+TEST(SequenceTracker, CallerHeldStateAgrees) {
+    SequenceTracker own(SeqStorage::FLAT, 256);
+    SequenceTracker windows(SeqStorage::FLAT, 256);
+    SeqState states[16];
+    uint64_t* bits[16] = {};
+
+    uint32_t lcg = 777;
+    uint32_t next[16] = {};
+    for (int i = 0; i < 20000; ++i) {
+        lcg = lcg * 1103515245u + 12345u;
+        std::size_t k = (lcg >> 8) % 16;
+        uint16_t src = static_cast<uint16_t>(k * 4099);
+        uint32_t r = (lcg >> 16) % 100;
+        uint32_t seq = r < 80 ? next[k]++ : r < 90 ? (next[k] += 3) : next[k] - 1 - (r % 300);
+
+        if (!bits[k])
+            bits[k] = windows.window(src);
+        SeqEvent a = own.track(src, seq);
+        SeqEvent b = windows.track(states[k], bits[k], src, seq);
+        ASSERT_EQ(a.result, b.result) << i;
+        ASSERT_EQ(a.expected_seq, b.expected_seq) << i;
+        ASSERT_EQ(a.gap_size, b.gap_size) << i;
+    }
+    // The window of a source stays where it is
+    EXPECT_EQ(windows.window(4099), bits[1]);
+}
+
+TEST(SequenceTracker, WindowSizeRounding) {
+    EXPECT_EQ(SequenceTracker().window_size(), SequenceTracker::DEFAULT_WINDOW);
+    EXPECT_EQ(SequenceTracker(SeqStorage::FLAT, 1).window_size(), 64u);
+    EXPECT_EQ(SequenceTracker(SeqStorage::FLAT, 1000).window_size(), 1024u);
+    EXPECT_EQ(SequenceTracker(SeqStorage::FLAT, 100000).window_size(), 4096u);
+}
+
+TEST(SequenceTracker, DeepReorderWithinLargeWindow) {
+    for (SeqStorage storage : {SeqStorage::FLAT, SeqStorage::HASH_MAP}) {
+        SequenceTracker st(storage, 1024);
+        st.track(1, 0);
+        auto gap = st.track(1, 500);
+        EXPECT_EQ(gap.result, SeqResult::GAP);
+        EXPECT_EQ(gap.gap_size, 499u);
+        EXPECT_EQ(st.track(1, 10).result, SeqResult::REORDER);
+        EXPECT_EQ(st.track(1, 10).result, SeqResult::DUPLICATE);
+        EXPECT_EQ(st.track(1, 0).result, SeqResult::DUPLICATE);
+        EXPECT_EQ(st.track(1, 500).result, SeqResult::DUPLICATE);
+    }
+
+    // The default 64 window has forgotten 10 by then
+    SequenceTracker small;
+    small.track(1, 0);
+    small.track(1, 500);
+    EXPECT_EQ(small.track(1, 10).result, SeqResult::REORDER);
+    EXPECT_EQ(small.track(1, 10).result, SeqResult::REORDER);
+}
+
+TEST(SequenceTracker, WindowSlidesOverOldBits) {
+    SequenceTracker st(SeqStorage::FLAT, 128);
+    for (uint32_t seq = 0; seq < 1000; ++seq)
+        ASSERT_NE(st.track(1, seq).result, SeqResult::GAP);
+    // 872..999 are in the window and seen; skipping ahead reuses the slots
+    // of the oldest ones
+    EXPECT_EQ(st.track(1, 990).result, SeqResult::DUPLICATE);
+    EXPECT_EQ(st.track(1, 1100).result, SeqResult::GAP);
+    EXPECT_EQ(st.track(1, 1050).result, SeqResult::REORDER);
+    EXPECT_EQ(st.track(1, 1060).result, SeqResult::REORDER);
+    EXPECT_EQ(st.track(1, 1050).result, SeqResult::DUPLICATE);
+    EXPECT_EQ(st.track(1, 999).result, SeqResult::DUPLICATE); // still in the window
+    EXPECT_EQ(st.track(1, 950).result, SeqResult::REORDER);   // out of it
+}
+
+TEST(SequenceTracker, SequenceWrapAround) {
+    SequenceTracker st;
+    st.track(1, 0xFFFFFFFEu);
+    EXPECT_EQ(st.track(1, 0xFFFFFFFFu).result, SeqResult::OK);
+    EXPECT_EQ(st.track(1, 0).result, SeqResult::OK);
+    EXPECT_EQ(st.track(1, 1).result, SeqResult::OK);
+    EXPECT_EQ(st.track(1, 0xFFFFFFFFu).result, SeqResult::DUPLICATE);
+
+    // A gap spanning the wrap
+    auto ev = st.track(1, 10);
+    EXPECT_EQ(ev.result, SeqResult::GAP);
+    EXPECT_EQ(ev.gap_size, 8u);
+    EXPECT_EQ(ev.expected_seq, 2u);
+
+    SequenceTracker wrap_gap;
+    wrap_gap.track(2, 0xFFFFFFF0u);
+    ev = wrap_gap.track(2, 5);
+    EXPECT_EQ(ev.result, SeqResult::GAP);
+    EXPECT_EQ(ev.gap_size, 20u);
+    EXPECT_EQ(wrap_gap.track(2, 0xFFFFFFFAu).result, SeqResult::REORDER);
+}
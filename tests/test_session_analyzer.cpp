@@ -0,0 +1,204 @@
+#include "replay/session_analyzer.h"
+#include "gateway/frame_recorder.h"
+#include "gateway/telemetry_parser.h"
+#include "common/crc32.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace nng;
+
+namespace {
+
+struct Datagram {
+    uint64_t rx_ts_ns;
+    std::vector<uint8_t> bytes;
+};
+
+std::vector<uint8_t> heartbeat(uint16_t src_id, uint32_t seq, uint64_t ts_ns) {
+    std::vector<uint8_t> buf(sizeof(TelemetryHeader) + sizeof(HeartbeatPayload) + 4, 0);
+    TelemetryHeader h{};
+    h.version = PROTOCOL_VERSION;
+    h.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    h.src_id = src_id;
+    h.seq = seq;
+    h.ts_ns = ts_ns;
+    h.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(h, buf.data());
+    uint32_t crc = crc32(buf.data(), buf.size() - 4);
+    std::memcpy(buf.data() + buf.size() - 4, &crc, sizeof(crc));
+    return buf;
+}
+
+// 40 sources, with gaps, reorders, duplicates, CRC failures and runts
+std::vector<Datagram> make_session(std::size_t n) {
+    std::vector<Datagram> out;
+    std::vector<uint32_t> next_seq(40, 0);
+    uint32_t x = 7;
+    for (std::size_t i = 0; i < n; ++i) {
+        x = x * 1664525u + 1013904223u;
+        auto src = static_cast<uint16_t>(1 + (x >> 8) % 40);
+        uint32_t roll = (x >> 20) % 100;
+        uint64_t ts = 1000000 + i * 1000;
+        uint32_t& seq = next_seq[src - 1];
+        if (roll < 2)
+            seq += 3; // gap
+        auto bytes = heartbeat(src, seq++, ts);
+        if (roll == 5)
+            bytes[sizeof(TelemetryHeader)] ^= 0xFF; // CRC mismatch
+        if (roll == 6)
+            bytes.resize(5); // too short
+        out.push_back(Datagram{ts, bytes});
+        if (roll == 7)
+            out.push_back(out.back()); // duplicate
+        if (roll == 8 && out.size() >= 2)
+            std::swap(out[out.size() - 1].bytes, out[out.size() - 2].bytes); // reorder
+    }
+    return out;
+}
+
+// What a sequential replay through the gateway's validate path counts
+void reference(const std::vector<Datagram>& session, StatsManager& stats) {
+    SequenceTracker tracker(SeqStorage::FLAT, 1024);
+    for (const auto& d : session) {
+        ParsedFrame f;
+        ParseError err = parse_frame(d.bytes.data(), d.bytes.size(), true, f);
+        if (err != ParseError::OK) {
+            stats.record_malformed(0);
+            if (err == ParseError::CRC_MISMATCH)
+                stats.record_crc_fail(0);
+            continue;
+        }
+        SeqEvent ev = tracker.track(f.header.src_id, f.header.seq);
+        stats.record_rx(f.header.src_id, f.header.seq, d.rx_ts_ns, f.header.ts_ns);
+        if (ev.result == SeqResult::GAP)
+            stats.record_gap(f.header.src_id, ev.gap_size);
+        else if (ev.result == SeqResult::REORDER)
+            stats.record_reorder(f.header.src_id);
+        else if (ev.result == SeqResult::DUPLICATE)
+            stats.record_duplicate(f.header.src_id);
+    }
+}
+
+std::string report(const std::string& path, std::size_t threads, std::size_t window_chunks = 0) {
+    AnalysisOptions opts;
+    opts.threads = threads;
+    opts.window_chunks = window_chunks;
+    SessionAnalyzer analyzer(opts);
+    EXPECT_TRUE(analyzer.run(path));
+    std::ostringstream os;
+    analyzer.write_report(os);
+    return os.str();
+}
+
+} // anonymous namespace
+
+class SessionAnalyzerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_file_ = "/tmp/test_session_analyzer_" + std::to_string(rand()) + ".bin";
+        session_ = make_session(40000);
+    }
+
+    void TearDown() override {
+        std::remove(test_file_.c_str());
+    }
+
+    void record_session() {
+        RecorderOptions opts;
+        opts.block_bytes = FrameRecorder::MIN_BLOCK_BYTES; // ~30 chunks
+        FrameRecorder recorder;
+        ASSERT_TRUE(recorder.open(test_file_, opts));
+        for (const auto& d : session_)
+            ASSERT_TRUE(recorder.record(d.rx_ts_ns, d.bytes.data(), d.bytes.size()));
+        recorder.close();
+    }
+
+    void write_legacy() {
+        std::ofstream out(test_file_, std::ios::binary);
+        for (const auto& d : session_) {
+            auto len = static_cast<uint32_t>(d.bytes.size());
+            out.write(reinterpret_cast<const char*>(&d.rx_ts_ns), sizeof(d.rx_ts_ns));
+            out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+            out.write(reinterpret_cast<const char*>(d.bytes.data()), len);
+        }
+    }
+
+    std::string test_file_;
+    std::vector<Datagram> session_;
+};
+
+TEST_F(SessionAnalyzerTest, MatchesSequentialReplay) {
+    record_session();
+    StatsManager expected;
+    reference(session_, expected);
+
+    AnalysisOptions opts;
+    opts.threads = 4;
+    SessionAnalyzer analyzer(opts);
+    ASSERT_TRUE(analyzer.run(test_file_));
+    EXPECT_EQ(analyzer.datagrams(), session_.size());
+
+    GlobalStats e = expected.get_global_stats();
+    GlobalStats g = analyzer.stats().get_global_stats();
+    EXPECT_GT(e.gap_total, 0u);
+    EXPECT_GT(e.reorder_total, 0u);
+    EXPECT_GT(e.duplicate_total, 0u);
+    EXPECT_GT(e.crc_fail_total, 0u);
+    EXPECT_EQ(g.rx_total, e.rx_total);
+    EXPECT_EQ(g.malformed_total, e.malformed_total);
+    EXPECT_EQ(g.crc_fail_total, e.crc_fail_total);
+    EXPECT_EQ(g.gap_total, e.gap_total);
+    EXPECT_EQ(g.reorder_total, e.reorder_total);
+    EXPECT_EQ(g.duplicate_total, e.duplicate_total);
+
+    std::vector<SourceStats> es, gs;
+    expected.get_all_source_stats(es);
+    analyzer.stats().get_all_source_stats(gs);
+    ASSERT_EQ(gs.size(), es.size());
+    for (std::size_t i = 0; i < es.size(); ++i) {
+        EXPECT_EQ(gs[i].src_id, es[i].src_id);
+        EXPECT_EQ(gs[i].rx_count, es[i].rx_count);
+        EXPECT_EQ(gs[i].malformed, es[i].malformed);
+        EXPECT_EQ(gs[i].gaps, es[i].gaps);
+        EXPECT_EQ(gs[i].reorders, es[i].reorders);
+        EXPECT_EQ(gs[i].duplicates, es[i].duplicates);
+        EXPECT_EQ(gs[i].last_seq, es[i].last_seq);
+        EXPECT_EQ(gs[i].last_ts_ns, es[i].last_ts_ns);
+    }
+}
+
+TEST_F(SessionAnalyzerTest, ReportIndependentOfThreadCount) {
+    record_session();
+    std::string one = report(test_file_, 1);
+    EXPECT_EQ(report(test_file_, 4), one);
+    EXPECT_EQ(report(test_file_, 3, 1), one); // one chunk per round
+    EXPECT_EQ(report(test_file_, 7, 5), one);
+}
+
+TEST_F(SessionAnalyzerTest, LegacyFormat) {
+    write_legacy();
+    StatsManager expected;
+    reference(session_, expected);
+
+    std::string one = report(test_file_, 1);
+    EXPECT_EQ(report(test_file_, 4), one);
+
+    AnalysisOptions opts;
+    opts.threads = 4;
+    SessionAnalyzer analyzer(opts);
+    ASSERT_TRUE(analyzer.run(test_file_));
+    EXPECT_EQ(analyzer.datagrams(), session_.size());
+    EXPECT_EQ(analyzer.stats().get_global_stats().gap_total,
+              expected.get_global_stats().gap_total);
+    EXPECT_EQ(analyzer.stats().get_global_stats().rx_total,
+              expected.get_global_stats().rx_total);
+}
+
+TEST_F(SessionAnalyzerTest, MissingFile) {
+    SessionAnalyzer analyzer;
+    EXPECT_FALSE(analyzer.run("/tmp/does_not_exist_nng_analyze.bin"));
+}
@@ -0,0 +1,253 @@
+#include "gateway/shm_ring.h"
+#include "gateway/gateway.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+// Per-process names, so parallel test runs do not share rings
+std::string ring_name(const char* test) {
+    return "nng-test-" + std::to_string(::getpid()) + "-" + test;
+}
+
+std::vector<uint8_t> frame(uint16_t src_id, uint32_t seq) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(HeartbeatPayload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(hdr, buf.data());
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(ShmRingTest, RoundTrip) {
+    const std::string name = ring_name("roundtrip");
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(name, 64));
+    source.set_timeout_ms(10);
+    ShmFrameSink sink;
+    ASSERT_TRUE(sink.connect(name));
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint32_t i = 0; i < 10; ++i)
+        frames.push_back(frame(3, i));
+    EXPECT_EQ(sink.send_batch(frames), 10u);
+
+    FrameBatch batch(64);
+    ASSERT_EQ(source.receive_batch(batch), 10u);
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(batch[i].len, frames[i].size());
+        EXPECT_EQ(std::memcmp(batch[i].data, frames[i].data(), frames[i].size()), 0);
+        EXPECT_GT(batch[i].rx_ts_ns, 0u);
+    }
+    EXPECT_EQ(source.receive_batch(batch), 0u); // times out empty
+    EXPECT_EQ(source.ring().sent(), 10u);
+    EXPECT_EQ(source.ring().dropped(), 0u);
+
+    std::vector<uint8_t> one;
+    EXPECT_TRUE(sink.send(frames[4]));
+    EXPECT_TRUE(source.receive(one));
+    EXPECT_EQ(one, frames[4]);
+}
+
+TEST(ShmRingTest, SinkNeedsOpenRing) {
+    const std::string name = ring_name("open");
+    ShmFrameSink sink;
+    EXPECT_FALSE(sink.connect(name));
+
+    auto source = std::make_unique<ShmFrameSource>();
+    ASSERT_TRUE(source->open(name, 16));
+    ASSERT_TRUE(sink.connect(name));
+    EXPECT_TRUE(sink.send(frame(1, 0)));
+
+    // Closing removes the name; attached senders see the ring closed
+    source.reset();
+    EXPECT_FALSE(sink.send(frame(1, 1)));
+    ShmFrameSink late;
+    EXPECT_FALSE(late.connect(name));
+}
+
+TEST(ShmRingTest, FullRingDropsUnlessBlocking) {
+    const std::string name = ring_name("full");
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(name, 4));
+    source.set_timeout_ms(10);
+    ShmFrameSink sink;
+    ASSERT_TRUE(sink.connect(name));
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint32_t i = 0; i < 6; ++i)
+        frames.push_back(frame(1, i));
+    EXPECT_EQ(sink.send_batch(frames), 4u);
+    EXPECT_EQ(source.ring().dropped(), 2u);
+
+    // Slots lent out by a receive are only free after the next one
+    FrameBatch batch(8);
+    ASSERT_EQ(source.receive_batch(batch), 4u);
+    EXPECT_FALSE(sink.send(frames[4]));
+    EXPECT_EQ(source.receive_batch(batch), 0u);
+    EXPECT_EQ(sink.send_batch(frames), 4u);
+
+    // Blocking: the sender waits for the receiver instead
+    ShmFrameSink blocking;
+    ASSERT_TRUE(blocking.connect(name));
+    blocking.set_blocking(true);
+    std::thread sender([&] {
+        for (uint32_t i = 0; i < 1000; ++i)
+            blocking.send(frame(2, i));
+    });
+    uint32_t next = 0;
+    std::size_t others = 0;
+    for (int tries = 0; next < 1000 && tries < 10000; ++tries) {
+        std::size_t n = source.receive_batch(batch);
+        for (std::size_t i = 0; i < n; ++i) {
+            TelemetryHeader hdr = deserialize_header(batch[i].data);
+            if (hdr.src_id != 2) {
+                ++others;
+                continue;
+            }
+            EXPECT_EQ(hdr.seq, next);
+            ++next;
+        }
+    }
+    sender.join();
+    EXPECT_EQ(next, 1000u);
+    EXPECT_EQ(others, 4u);
+}
+
+TEST(ShmRingTest, SeveralSenders) {
+    const std::string name = ring_name("mpsc");
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(name, 256));
+    source.set_timeout_ms(10);
+
+    constexpr uint16_t SENDERS = 4;
+    constexpr uint32_t FRAMES = 5000;
+    std::vector<std::thread> threads;
+    for (uint16_t s = 0; s < SENDERS; ++s) {
+        threads.emplace_back([&name, s] {
+            ShmFrameSink sink;
+            ASSERT_TRUE(sink.connect(name));
+            sink.set_blocking(true);
+            for (uint32_t i = 0; i < FRAMES; ++i)
+                sink.send(frame(s, i));
+        });
+    }
+
+    // Each sender's frames arrive in its order, none lost
+    std::vector<uint32_t> next(SENDERS, 0);
+    FrameBatch batch(64);
+    uint64_t total = 0;
+    for (int tries = 0; total < SENDERS * FRAMES && tries < 100000; ++tries) {
+        std::size_t n = source.receive_batch(batch);
+        for (std::size_t i = 0; i < n; ++i) {
+            TelemetryHeader hdr = deserialize_header(batch[i].data);
+            ASSERT_LT(hdr.src_id, SENDERS);
+            ASSERT_EQ(hdr.seq, next[hdr.src_id]);
+            ++next[hdr.src_id];
+        }
+        total += n;
+    }
+    for (auto& t : threads)
+        t.join();
+    EXPECT_EQ(total, uint64_t{SENDERS} * FRAMES);
+    EXPECT_EQ(source.ring().dropped(), 0u);
+}
+
+TEST(ShmRingTest, WakesSleepingReceiver) {
+    const std::string name = ring_name("wake");
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(name, 16));
+    source.set_timeout_ms(5000);
+    ShmFrameSink sink;
+    ASSERT_TRUE(sink.connect(name));
+
+    std::thread sender([&sink] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        sink.send(frame(1, 0));
+    });
+    FrameBatch batch(8);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(source.receive_batch(batch), 1u);
+    auto waited = std::chrono::steady_clock::now() - start;
+    sender.join();
+    // Woken by the send, long before the timeout
+    EXPECT_LT(waited, std::chrono::milliseconds(2000));
+}
+
+TEST(ShmRingTest, AcrossProcesses) {
+    const std::string name = ring_name("fork");
+    ShmFrameSource source;
+    ASSERT_TRUE(source.open(name, 64));
+    source.set_timeout_ms(100);
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        ShmFrameSink sink;
+        if (!sink.connect(name))
+            ::_exit(1);
+        sink.set_blocking(true);
+        for (uint32_t i = 0; i < 500; ++i)
+            sink.send(frame(9, i));
+        ::_exit(0);
+    }
+
+    FrameBatch batch(64);
+    uint32_t next = 0;
+    for (int tries = 0; next < 500 && tries < 200; ++tries) {
+        std::size_t n = source.receive_batch(batch);
+        for (std::size_t i = 0; i < n; ++i)
+            EXPECT_EQ(deserialize_header(batch[i].data).seq, next++);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_EQ(next, 500u);
+}
+
+TEST(ShmRingTest, GatewayReceivesFromRing) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.rx_backend = RxBackend::SHM;
+    config.shm_name = ring_name("gateway");
+    config.shm_slots = 256;
+
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    ShmFrameSink sink;
+    ASSERT_TRUE(sink.connect(config.shm_name));
+    sink.set_blocking(true);
+    for (uint32_t i = 0; i < 1000; ++i)
+        sink.send(frame(7, i));
+    for (int i = 0; i < 400 && gateway.stats().get_global_stats().rx_total < 1000; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+    EXPECT_EQ(gateway.stats().get_global_stats().rx_total, 1000u);
+    EXPECT_EQ(gateway.stats().get_source_stats(7).gaps, 0u);
+    // The ring is gone with the gateway
+    EXPECT_FALSE(sink.send(frame(7, 1000)));
+}
@@ -0,0 +1,154 @@
+#include "gateway/source_record.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "gateway/stats_manager.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+std::vector<uint8_t> heartbeat_frame(uint16_t src_id, uint32_t seq) {
+    HeartbeatPayload hb{};
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(hb));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(hb);
+    serialize_header(hdr, buf.data());
+    std::memcpy(buf.data() + FRAME_HEADER_SIZE, &hb, sizeof(hb));
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(SourceRecordTest, TwoCacheLines) {
+    EXPECT_EQ(sizeof(SourceRecord), 2 * CACHE_LINE_SIZE);
+    EXPECT_EQ(alignof(SourceRecord), CACHE_LINE_SIZE);
+    // What an in-order frame touches shares the first line
+    EXPECT_LT(offsetof(SourceRecord, rates), CACHE_LINE_SIZE);
+    EXPECT_GE(offsetof(SourceRecord, window), CACHE_LINE_SIZE);
+}
+
+TEST(SourceRecordTest, ResolvedRecordCountsLikeSrcId) {
+    StatsShard by_id;
+    StatsShard by_record;
+    by_id.record_rx(7, 10, 1000);
+    by_id.record_gap(7, 3);
+    by_id.record_reorder(7);
+    by_id.record_duplicate(7);
+    by_id.record_rx(7, 11, 2000);
+
+    SourceRecord& s = by_record.resolve(7);
+    EXPECT_EQ(&s, &by_record.resolve(7));
+    by_record.record_rx(s, 10, 1000);
+    by_record.record_gap(s, 3);
+    by_record.record_reorder(s);
+    by_record.record_duplicate(s);
+    by_record.record_rx(s, 11, 2000);
+
+    SourceStats a, b;
+    ASSERT_TRUE(by_id.add_source(7, a));
+    ASSERT_TRUE(by_record.add_source(7, b));
+    EXPECT_EQ(a.rx_count, b.rx_count);
+    EXPECT_EQ(a.gaps, b.gaps);
+    EXPECT_EQ(a.reorders, b.reorders);
+    EXPECT_EQ(a.duplicates, b.duplicates);
+    EXPECT_EQ(a.last_seq, b.last_seq);
+    EXPECT_EQ(a.last_ts_ns, b.last_ts_ns);
+    EXPECT_EQ(b.rx_count, 2u);
+    EXPECT_EQ(b.last_seq, 11u);
+}
+
+TEST(SourceRecordTest, ResetsKeepOrClearWriterState) {
+    StatsShard shard;
+    SourceRecord& s = shard.resolve(3);
+    uint64_t bits = 0;
+    s.seq.next_expected = 42;
+    s.seq.initialized = true;
+    s.window = &bits;
+    s.timer_armed = true;
+    s.last_frame_ns = 99;
+    shard.record_rx(s, 41, 1000);
+
+    // A stats reset leaves the writer where it was
+    shard.reset();
+    SourceStats st;
+    shard.add_source(3, st);
+    EXPECT_EQ(st.rx_count, 0u);
+    EXPECT_TRUE(s.seq.initialized);
+    EXPECT_EQ(s.seq.next_expected, 42u);
+    EXPECT_EQ(s.window, &bits);
+
+    // A new writer starts from nothing, but the counts stay. Records
+    // are resolved per frame, which counts the source as seen again.
+    shard.record_rx(shard.resolve(3), 42, 2000);
+    shard.reset_writer_state();
+    EXPECT_FALSE(s.seq.initialized);
+    EXPECT_EQ(s.window, nullptr);
+    EXPECT_FALSE(s.timer_armed);
+    EXPECT_EQ(s.last_frame_ns, 0u);
+    st = SourceStats{};
+    shard.add_source(3, st);
+    EXPECT_EQ(st.rx_count, 1u);
+}
+
+TEST(SourceRecordTest, SourceTimeoutFollowsTheLatestFrame) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.source_timeout_ms = 100;
+    config.timer_tick_ms = 10;
+    config.source_factory = [&channel](std::size_t) { return channel.source(5); };
+    Gateway gateway(config);
+    std::mutex mutex;
+    std::vector<uint16_t> timeouts;
+    gateway.events().subscribe(EventCategory::NETWORK, [&](const EventRecord& e) {
+        if (e.id != EventId::EVT_SOURCE_TIMEOUT)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        timeouts.push_back(e.fields.src_id);
+    });
+    std::thread t([&gateway] { gateway.run(); });
+
+    // Source 1 keeps sending well inside the timeout; source 2 falls silent
+    channel.sink().send(heartbeat_frame(2, 0));
+    for (uint32_t seq = 0; seq < 25; ++seq) {
+        channel.sink().send(heartbeat_frame(1, seq));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(timeouts.size(), 1u);
+        EXPECT_EQ(timeouts[0], 2u);
+    }
+
+    // Then source 1 times out too, once
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (timeouts.size() >= 2)
+                break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    ASSERT_EQ(timeouts.size(), 2u);
+    EXPECT_EQ(timeouts[1], 1u);
+}
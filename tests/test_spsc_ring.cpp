@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "common/spsc_ring.h"
+#include <thread>
+#include <vector>
+
+using namespace nng;
+
+TEST(SpscRingTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(SpscRing<int>(1).capacity(), 1u);
+    EXPECT_EQ(SpscRing<int>(5).capacity(), 8u);
+    EXPECT_EQ(SpscRing<int>(64).capacity(), 64u);
+    EXPECT_EQ(SpscRing<int>(0).capacity(), 1u);
+}
+
+TEST(SpscRingTest, PushPopFifo) {
+    SpscRing<int> ring(4);
+    EXPECT_TRUE(ring.empty());
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(ring.try_push(i));
+    EXPECT_FALSE(ring.try_push(99)); // full
+    EXPECT_EQ(ring.size(), 4u);
+
+    int v = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(ring.try_pop(v)); // empty
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, WrapsAround) {
+    SpscRing<int> ring(4);
+    int v = 0;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(ring.try_push(i));
+        ASSERT_TRUE(ring.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+}
+
+TEST(SpscRingTest, BatchPushPopPartial) {
+    SpscRing<int> ring(8);
+    int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(ring.try_push_n(in, 10), 8u); // only 8 fit
+
+    int out[10] = {};
+    EXPECT_EQ(ring.try_pop_n(out, 3), 3u);
+    EXPECT_EQ(out[2], 2);
+    EXPECT_EQ(ring.try_push_n(in + 8, 2), 2u);
+    EXPECT_EQ(ring.try_pop_n(out, 10), 7u);
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[6], 9);
+    EXPECT_EQ(ring.try_pop_n(out, 10), 0u);
+}
+
+TEST(SpscRingTest, ConcurrentProducerConsumer) {
+    SpscRing<uint64_t> ring(64);
+    const uint64_t count = 200000;
+
+    std::thread producer([&]() {
+        uint64_t buf[8];
+        uint64_t next = 0;
+        while (next < count) {
+            std::size_t want = 0;
+            while (want < 8 && next + want < count) {
+                buf[want] = next + want;
+                ++want;
+            }
+            next += ring.try_push_n(buf, want);
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t out[16];
+    while (expected < count) {
+        std::size_t n = ring.try_pop_n(out, 16);
+        for (std::size_t i = 0; i < n; ++i)
+            ASSERT_EQ(out[i], expected++);
+        if (n == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,140 @@
+#include "gateway/stage_profiler.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+#if NNG_PROFILE
+
+namespace {
+
+void busy_wait_us(int us) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+} // anonymous namespace
+
+TEST(StageProfilerTest, ScopesRecordOnlyWhenEnabled) {
+    StageProfiler profiler;
+    profiler.attach("t");
+    {
+        NNG_PROFILE_SCOPE(TRACK);
+    }
+    profiler.set_enabled(true);
+    for (int i = 0; i < 4; ++i) {
+        NNG_PROFILE_SCOPE(TRACK);
+        busy_wait_us(200);
+    }
+    StageProfiler::detach();
+    {
+        // Detached threads record nothing
+        NNG_PROFILE_SCOPE(TRACK);
+    }
+
+    ProfileReport r;
+    ASSERT_TRUE(r.compiled);
+    ASSERT_TRUE(profiler.report(r));
+    EXPECT_TRUE(r.enabled);
+    const StageTiming& t = r.stages[static_cast<std::size_t>(ProfileStage::TRACK)];
+    EXPECT_EQ(t.ns.count, 4u);
+    // Ticks come back as ns: ~200 us each, within the histogram's 1/16
+    EXPECT_GE(t.ns.percentile(0.5), 180000u);
+    EXPECT_LT(t.ns.percentile(0.5), 2000000u);
+    EXPECT_GE(t.total_ns, 4u * 180000u);
+    EXPECT_EQ(r.stages[static_cast<std::size_t>(ProfileStage::PARSE)].ns.count, 0u);
+}
+
+TEST(StageProfilerTest, ThreadsAreKeptApartAndReused) {
+    StageProfiler profiler;
+    profiler.set_enabled(true);
+    auto work = [&profiler](const char* name, int n) {
+        NNG_PROFILE_THREAD(profiler, name);
+        for (int i = 0; i < n; ++i) {
+            NNG_PROFILE_SCOPE(LOG);
+        }
+    };
+    std::thread a(work, "a", 3);
+    a.join();
+    std::thread b(work, "b", 5);
+    b.join();
+    std::thread again(work, "a", 1);
+    again.join();
+
+    ProfileReport r;
+    ASSERT_TRUE(profiler.report(r));
+    ASSERT_EQ(r.threads.size(), 2u);
+    EXPECT_EQ(r.stages[static_cast<std::size_t>(ProfileStage::LOG)].ns.count, 9u);
+    ASSERT_TRUE(profiler.report(r, "a"));
+    EXPECT_EQ(r.stages[static_cast<std::size_t>(ProfileStage::LOG)].ns.count, 4u);
+    EXPECT_FALSE(profiler.report(r, "c"));
+
+    profiler.reset();
+    ASSERT_TRUE(profiler.report(r));
+    EXPECT_EQ(r.stages[static_cast<std::size_t>(ProfileStage::LOG)].ns.count, 0u);
+}
+
+TEST(StageProfilerTest, GatewayTimesEachStage) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.log_level = Severity::DEBUG;
+    config.profile = true;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    for (uint32_t i = 0; i < 50; ++i) {
+        std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(HeartbeatPayload));
+        TelemetryHeader hdr{};
+        hdr.version = PROTOCOL_VERSION;
+        hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+        hdr.src_id = 3;
+        hdr.seq = i;
+        hdr.payload_len = sizeof(HeartbeatPayload);
+        serialize_header(hdr, buf.data());
+        channel.sink().send(buf);
+    }
+    for (int i = 0; i < 200 && gateway.stats().get_global_stats().rx_total < 50; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    ProfileReport r;
+    ASSERT_TRUE(gateway.profiler().report(r));
+    ASSERT_EQ(r.threads.size(), 1u);
+    EXPECT_EQ(r.threads[0], "ingest0");
+    auto count = [&r](ProfileStage s) { return r.stages[static_cast<std::size_t>(s)].ns.count; };
+    EXPECT_GE(count(ProfileStage::RECEIVE), 1u);
+    EXPECT_EQ(count(ProfileStage::PARSE), count(ProfileStage::RECEIVE));
+    EXPECT_EQ(count(ProfileStage::TRACK), 50u);
+    EXPECT_EQ(count(ProfileStage::STATS), 50u);
+    EXPECT_EQ(count(ProfileStage::DISPATCH), 50u);
+    // Every heartbeat is logged at DEBUG, plus the source coming online
+    EXPECT_GE(count(ProfileStage::LOG), 50u);
+    EXPECT_EQ(count(ProfileStage::RECORD), 0u);
+}
+
+#else
+
+TEST(StageProfilerTest, CompiledOut) {
+    ProfileReport r;
+    EXPECT_FALSE(r.compiled);
+}
+
+#endif
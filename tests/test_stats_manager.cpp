@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "gateway/stats_manager.h"
+#include <atomic>
 #include <thread>
 #include <vector>
 
@@ -174,3 +175,348 @@ TEST_F(StatsManagerTest, ThreadSafetyConcurrentWriteAndRead) {
     EXPECT_EQ(sm.get_global_stats().rx_total,
               static_cast<uint64_t>(writers * per_writer));
 }
+
+TEST_F(StatsManagerTest, MergeFromSumsShards) {
+    StatsManager a, b;
+    a.record_rx(1, 0, 100);
+    a.record_rx(1, 1, 200);
+    a.record_gap(1, 3);
+    b.record_rx(2, 0, 150);
+    b.record_rx(1, 7, 300);
+    b.record_duplicate(2);
+
+    sm.record_rx(9, 0, 1); // replaced by the merge
+    sm.merge_from({&a, &b});
+
+    auto g = sm.get_global_stats();
+    EXPECT_EQ(g.rx_total, 4u);
+    EXPECT_EQ(g.gap_total, 3u);
+    EXPECT_EQ(g.duplicate_total, 1u);
+
+    auto s1 = sm.get_source_stats(1);
+    EXPECT_EQ(s1.rx_count, 3u);
+    EXPECT_EQ(s1.gaps, 3u);
+    EXPECT_EQ(s1.last_seq, 7u);   // most recent shard wins
+    EXPECT_EQ(s1.last_ts_ns, 300u);
+    EXPECT_EQ(sm.get_source_stats(2).duplicates, 1u);
+    EXPECT_EQ(sm.get_source_stats(9).rx_count, 0u);
+    EXPECT_EQ(sm.get_all_source_stats().size(), 2u);
+}
+
+TEST_F(StatsManagerTest, RecordLatencyStages) {
+    const uint64_t base = 1700000000ULL * 1000000000ULL; // wall-clock ns
+
+    // sender -> kernel 50us, kernel -> dequeue 20us, kernel -> done 30us
+    sm.record_latency(base, base + 50000, base + 70000, base + 80000);
+    // Simulation-relative sender timestamp: wire stage skipped
+    sm.record_latency(12345, base, base + 10000, base + 40000);
+
+    auto lat = sm.get_latency_stats();
+    EXPECT_EQ(lat.wire.count, 1u);
+    EXPECT_EQ(lat.wire.mean_ns(), 50000u);
+    EXPECT_EQ(lat.queue.count, 2u);
+    EXPECT_EQ(lat.queue.mean_ns(), 15000u);
+    EXPECT_EQ(lat.queue.max_ns, 20000u);
+    EXPECT_EQ(lat.process.count, 2u);
+    EXPECT_EQ(lat.process.max_ns, 40000u);
+
+    StatsManager other;
+    other.record_latency(base, base + 90000, base + 90000, base + 95000);
+    StatsManager merged;
+    merged.merge_from({&sm, &other});
+    auto m = merged.get_latency_stats();
+    EXPECT_EQ(m.wire.count, 2u);
+    EXPECT_EQ(m.wire.max_ns, 90000u);
+    EXPECT_EQ(m.process.count, 3u);
+
+    sm.reset();
+    EXPECT_EQ(sm.get_latency_stats().process.count, 0u);
+}
+
+TEST_F(StatsManagerTest, WriterShardsSumOnRead) {
+    sm.set_writer_shards(2);
+    EXPECT_EQ(sm.writer_shards(), 2u);
+    StatsShard& a = sm.shard(0);
+    StatsShard& b = sm.shard(1);
+
+    sm.record_rx(1, 0, 50); // unsharded writes still count
+    a.record_rx(1, 1, 100);
+    a.record_gap(1, 4);
+    b.record_rx(1, 9, 300);
+    b.record_rx(0xFFFF, 0, 200);
+    b.record_crc_fail(0xFFFF);
+    b.record_filtered(6);
+
+    auto g = sm.get_global_stats();
+    EXPECT_EQ(g.rx_total, 4u);
+    EXPECT_EQ(g.gap_total, 4u);
+    EXPECT_EQ(g.crc_fail_total, 1u);
+    EXPECT_EQ(g.filtered_total, 6u);
+    EXPECT_EQ(sm.get_health(), HealthState::ERROR);
+
+    auto s1 = sm.get_source_stats(1);
+    EXPECT_EQ(s1.src_id, 1);
+    EXPECT_EQ(s1.rx_count, 3u);
+    EXPECT_EQ(s1.gaps, 4u);
+    EXPECT_EQ(s1.last_seq, 9u); // most recent shard wins
+    EXPECT_EQ(sm.get_source_stats(0xFFFF).malformed, 1u);
+    EXPECT_EQ(sm.get_source_stats(7).rx_count, 0u);
+    EXPECT_EQ(sm.get_all_source_stats().size(), 2u);
+
+    // Growing keeps existing shards and their counts
+    sm.set_writer_shards(1);
+    EXPECT_EQ(sm.writer_shards(), 2u);
+    EXPECT_EQ(&sm.shard(0), &a);
+
+    sm.reset();
+    EXPECT_EQ(sm.get_global_stats().rx_total, 0u);
+    EXPECT_TRUE(sm.get_all_source_stats().empty());
+    a.record_rx(3, 0, 1);
+    EXPECT_EQ(sm.get_source_stats(3).rx_count, 1u);
+}
+
+TEST_F(StatsManagerTest, ShardLatencyStages) {
+    const uint64_t base = 1700000000ULL * 1000000000ULL;
+    sm.set_writer_shards(2);
+    sm.shard(0).record_latency(base, base + 50000, base + 70000, base + 80000);
+    sm.shard(1).record_latency(12345, base, base + 10000, base + 40000);
+
+    auto lat = sm.get_latency_stats();
+    EXPECT_EQ(lat.wire.count, 1u);
+    EXPECT_EQ(lat.queue.count, 2u);
+    EXPECT_EQ(lat.queue.max_ns, 20000u);
+    EXPECT_EQ(lat.process.max_ns, 40000u);
+}
+
+TEST_F(StatsManagerTest, ShardedWritersWithConcurrentReader) {
+    constexpr int writers = 4;
+    constexpr int per_writer = 20000;
+    sm.set_writer_shards(writers);
+    std::atomic<bool> done{false};
+
+    std::thread reader([&]() {
+        uint64_t last = 0;
+        while (!done.load()) {
+            uint64_t rx = sm.get_global_stats().rx_total;
+            EXPECT_GE(rx, last); // counters only grow
+            last = rx;
+            sm.get_all_source_stats();
+        }
+    });
+
+    std::vector<std::thread> pool;
+    for (int w = 0; w < writers; ++w) {
+        pool.emplace_back([&, w]() {
+            StatsShard& shard = sm.shard(w);
+            for (int i = 0; i < per_writer; ++i)
+                shard.record_rx(static_cast<uint16_t>(w * 1000 + i % 100), i, i);
+        });
+    }
+    for (auto& th : pool) th.join();
+    done.store(true);
+    reader.join();
+
+    EXPECT_EQ(sm.get_global_stats().rx_total, static_cast<uint64_t>(writers * per_writer));
+    EXPECT_EQ(sm.get_all_source_stats().size(), static_cast<std::size_t>(writers * 100));
+    EXPECT_EQ(sm.get_source_stats(1000).rx_count, static_cast<uint64_t>(per_writer / 100));
+}
+
+TEST_F(StatsManagerTest, SourceLatencyHistograms) {
+    const uint64_t base = 1700000000ULL * 1000000000ULL;
+    // Frames every 10 ms, 2 ms after the sender stamped them
+    for (uint64_t i = 0; i < 100; ++i) {
+        uint64_t sent = base + i * 10000000ULL;
+        sm.record_rx(4, static_cast<uint32_t>(i), sent + 2000000ULL, sent);
+    }
+    sm.record_rx(5, 0, base, 12345); // simulation-relative: no latency sample
+
+    SourceLatency lat;
+    ASSERT_TRUE(sm.get_source_latency(4, lat));
+    EXPECT_EQ(lat.interarrival.count, 99u);
+    EXPECT_EQ(lat.interarrival.max, 10000000u);
+    EXPECT_EQ(lat.latency.count, 100u);
+    EXPECT_EQ(lat.latency.percentile(0.99), 2000000u);
+
+    ASSERT_TRUE(sm.get_source_latency(5, lat));
+    EXPECT_EQ(lat.latency.count, 0u);
+    EXPECT_FALSE(sm.get_source_latency(6, lat));
+
+    // Shards contribute the same way
+    sm.set_writer_shards(1);
+    sm.shard(0).record_rx(4, 100, base + 1000000000ULL, base + 999000000ULL);
+    sm.shard(0).record_rx(4, 101, base + 1001000000ULL, base + 1000000000ULL);
+    ASSERT_TRUE(sm.get_source_latency(4, lat));
+    EXPECT_EQ(lat.latency.count, 102u);
+    EXPECT_EQ(lat.interarrival.count, 100u); // first shard frame has no predecessor there
+    EXPECT_EQ(sm.get_all_source_latency().latency.count, 102u);
+
+    sm.reset();
+    EXPECT_FALSE(sm.get_source_latency(4, lat));
+}
+
+TEST_F(StatsManagerTest, SnapshotIsConsistentAndVersioned) {
+    sm.set_writer_shards(1);
+    sm.record_rx(2, 0, 10);
+    sm.shard(0).record_rx(1, 0, 20);
+    sm.shard(0).record_gap(1, 2);
+
+    auto a = sm.snapshot();
+    EXPECT_EQ(a->global.rx_total, 2u);
+    EXPECT_EQ(a->health, HealthState::DEGRADED);
+    ASSERT_EQ(a->sources.size(), 2u);
+    EXPECT_EQ(a->sources[0].src_id, 1); // sorted
+    EXPECT_EQ(a->sources[0].gaps, 2u);
+    EXPECT_LT(a->age_ns(), 10ULL * 1000000000ULL);
+
+    // A reader holding a snapshot keeps its view
+    sm.shard(0).record_rx(1, 1, 30);
+    EXPECT_EQ(a->global.rx_total, 2u);
+
+    // Within max age the same snapshot is shared; 0 always rebuilds
+    auto b = sm.snapshot(60ULL * 1000000000ULL);
+    EXPECT_EQ(b, a);
+    auto c = sm.snapshot();
+    EXPECT_GT(c->version, a->version);
+    EXPECT_EQ(c->global.rx_total, 3u);
+    EXPECT_EQ(sm.snapshot(60ULL * 1000000000ULL), c);
+
+    sm.reset();
+    EXPECT_EQ(sm.snapshot(60ULL * 1000000000ULL)->global.rx_total, 0u);
+}
+
+TEST_F(StatsManagerTest, SnapshotReadersDoNotStopShardWriter) {
+    sm.set_writer_shards(1);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&, r]() {
+            uint64_t last_version = 0;
+            while (!done.load()) {
+                auto snap = sm.snapshot(r ? 1000000 : 0);
+                EXPECT_GE(snap->version, last_version);
+                last_version = snap->version;
+                uint64_t per_source = 0;
+                for (const auto& s : snap->sources)
+                    per_source += s.rx_count;
+                (void)per_source;
+            }
+        });
+    }
+    StatsShard& shard = sm.shard(0);
+    for (uint32_t i = 0; i < 50000; ++i)
+        shard.record_rx(static_cast<uint16_t>(i % 50), i, i);
+    done.store(true);
+    for (auto& t : readers) t.join();
+    EXPECT_EQ(sm.snapshot()->global.rx_total, 50000u);
+}
+
+TEST(RateWindowTest, AddAndSumBySecond) {
+    RateWindow w;
+    w.add(RateMetric::RX, 5, 100);
+    w.add(RateMetric::RX, 3, 101);
+    w.add(RateMetric::GAPS, 1, 101);
+
+    RateCounts c;
+    w.sum(101, 1, c);
+    EXPECT_EQ(c[RateMetric::RX], 3u);
+    EXPECT_EQ(c[RateMetric::GAPS], 1u);
+
+    RateCounts both;
+    w.sum(101, 10, both);
+    EXPECT_EQ(both[RateMetric::RX], 8u);
+}
+
+TEST(RateWindowTest, StaleSlotIsRecycled) {
+    RateWindow w;
+    w.add(RateMetric::MALFORMED, 7, 10);
+    // Same slot, one lap later: the old second is dropped, not summed
+    w.add(RateMetric::RX, 1, 10 + RateWindow::SLOTS);
+
+    RateCounts c;
+    w.sum(10 + RateWindow::SLOTS, RateWindow::SLOTS, c);
+    EXPECT_EQ(c[RateMetric::MALFORMED], 0u);
+    EXPECT_EQ(c[RateMetric::RX], 1u);
+}
+
+TEST(RateWindowTest, MergeKeepsNewerSecond) {
+    RateWindow a, b;
+    a.add(RateMetric::RX, 4, 200);
+    b.add(RateMetric::RX, 6, 200);
+    // Seconds 5 and 5 + SLOTS share a slot; a's newer second wins
+    b.add(RateMetric::RX, 9, 5);
+    a.add(RateMetric::RX, 2, 5 + RateWindow::SLOTS);
+
+    a.merge(b);
+    RateCounts c;
+    a.sum(200, 1, c);
+    EXPECT_EQ(c[RateMetric::RX], 10u);
+
+    RateCounts lap;
+    a.sum(5 + RateWindow::SLOTS, 1, lap);
+    EXPECT_EQ(lap[RateMetric::RX], 2u);
+}
+
+TEST(RateWindowTest, WindowedRatesUseCompletedSeconds) {
+    RateWindow w;
+    for (uint32_t s = 40; s < 100; ++s)
+        w.add(RateMetric::RX, 10, s);
+    w.add(RateMetric::RX, 1000, 100); // current second, not yet complete
+
+    WindowedRates r = windowed_rates({&w}, 100);
+    EXPECT_DOUBLE_EQ(r.last_1s[RateMetric::RX], 10.0);
+    EXPECT_DOUBLE_EQ(r.last_10s[RateMetric::RX], 10.0);
+    EXPECT_DOUBLE_EQ(r.last_60s[RateMetric::RX], 10.0);
+    EXPECT_DOUBLE_EQ(r.last_10s[RateMetric::GAPS], 0.0);
+}
+
+TEST_F(StatsManagerTest, WindowedRatesPerSource) {
+    for (uint32_t i = 0; i < 20; ++i)
+        sm.record_rx(3, i, 0);
+    sm.record_gap(3, 2);
+
+    // Counts land in the current second, which the windows only report
+    // once it completes; check the lookups rather than the values
+    WindowedRates r;
+    EXPECT_TRUE(sm.get_source_rates(3, r));
+    EXPECT_GE(r.last_60s[RateMetric::RX], 0.0);
+    EXPECT_FALSE(sm.get_source_rates(4, r));
+
+    WindowedRates g = sm.get_global_rates();
+    EXPECT_GE(g.last_60s[RateMetric::GAPS], 0.0);
+}
+
+TEST_F(StatsManagerTest, HealthRecoversOnceFaultsAge) {
+    RateWindow w;
+    w.add(RateMetric::CRC_FAIL, 1, 1000);
+    RateCounts recent;
+    w.sum(1005, StatsManager::HEALTH_WINDOW_S, recent);
+    EXPECT_EQ(health_of(recent), HealthState::ERROR);
+
+    RateCounts later;
+    w.sum(1000 + StatsManager::HEALTH_WINDOW_S, StatsManager::HEALTH_WINDOW_S, later);
+    EXPECT_EQ(health_of(later), HealthState::OK);
+}
+
+TEST_F(StatsManagerTest, AllSourceStatsIntoReusedVector) {
+    sm.set_writer_shards(2);
+    sm.record_rx(9, 0, 0);
+    sm.record_rx(600, 0, 0);
+    sm.shard(0).record_rx(9, 1, 0);
+    sm.shard(1).record_duplicate(4);
+    sm.shard(1).record_rx(70, 0, 0);
+
+    std::vector<SourceStats> out;
+    sm.get_all_source_stats(out);
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_EQ(out[0].src_id, 4);
+    EXPECT_EQ(out[0].duplicates, 1u);
+    EXPECT_EQ(out[1].src_id, 9);
+    EXPECT_EQ(out[1].rx_count, 2u);
+    EXPECT_EQ(out[2].src_id, 70);
+    EXPECT_EQ(out[3].src_id, 600);
+
+    const SourceStats* data = out.data();
+    sm.get_all_source_stats(out);
+    EXPECT_EQ(out.size(), 4u);
+    EXPECT_EQ(out.data(), data);
+}
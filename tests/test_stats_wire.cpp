@@ -0,0 +1,153 @@
+#include "control_node/stats_wire.h"
+#include "control_node/command_handler.h"
+#include "gateway/stats_manager.h"
+#include "common/logger.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace nng;
+
+namespace {
+
+StatsSnapshot snapshot_with(std::vector<SourceStats> sources, uint64_t version) {
+    StatsSnapshot snap;
+    snap.sources = std::move(sources);
+    snap.version = version;
+    return snap;
+}
+
+SourceStats source(uint16_t id, uint64_t rx) {
+    SourceStats s;
+    s.src_id = id;
+    s.rx_count = rx;
+    s.last_seq = static_cast<uint32_t>(rx);
+    s.last_ts_ns = rx * 1000;
+    return s;
+}
+
+} // anonymous namespace
+
+TEST(StatsWireTest, GlobalRoundTrip) {
+    StatsSnapshot snap;
+    snap.global.rx_total = 1000;
+    snap.global.gap_total = 7;
+    snap.global.filtered_total = 3;
+    snap.health = HealthState::DEGRADED;
+    snap.version = 42;
+
+    std::string out;
+    encode_stats_wire(snap, out);
+    EXPECT_EQ(out.size(), sizeof(StatsWireHeader) + sizeof(GlobalStatsRecord));
+
+    StatsWireView view;
+    ASSERT_TRUE(decode_stats_wire(out.data(), out.size(), view));
+    EXPECT_EQ(view.kind, StatsWireKind::STATS);
+    EXPECT_FALSE(view.delta);
+    EXPECT_EQ(view.health, HealthState::DEGRADED);
+    EXPECT_EQ(view.version, 42u);
+    EXPECT_EQ(view.global.rx_total, 1000u);
+    EXPECT_EQ(view.global.gap_total, 7u);
+    EXPECT_EQ(view.global.filtered_total, 3u);
+}
+
+TEST(StatsWireTest, SourcesDeltaCarriesOnlyChanges) {
+    StatsSnapshot v1 = snapshot_with({source(1, 10), source(2, 20), source(5, 50)}, 1);
+    StatsSnapshot v2 = snapshot_with({source(1, 10), source(2, 25), source(3, 1), source(5, 50)}, 2);
+
+    std::string full;
+    encode_sources_wire(v1, nullptr, full);
+    EXPECT_EQ(full.size(), sizeof(StatsWireHeader) + 3 * sizeof(SourceStatsRecord));
+    StatsWireView view;
+    ASSERT_TRUE(decode_stats_wire(full.data(), full.size(), view));
+    SourceStatsTable table;
+    ASSERT_TRUE(table.apply(view));
+    EXPECT_EQ(table.version, 1u);
+    ASSERT_EQ(table.sources.size(), 3u);
+
+    std::string delta;
+    encode_sources_wire(v2, &v1, delta);
+    ASSERT_TRUE(decode_stats_wire(delta.data(), delta.size(), view));
+    EXPECT_TRUE(view.delta);
+    EXPECT_EQ(view.base_version, 1u);
+    ASSERT_EQ(view.sources.size(), 2u); // 2 changed, 3 is new
+    EXPECT_EQ(view.sources[0].src_id, 2u);
+    EXPECT_EQ(view.sources[1].src_id, 3u);
+
+    ASSERT_TRUE(table.apply(view));
+    EXPECT_EQ(table.version, 2u);
+    ASSERT_EQ(table.sources.size(), 4u);
+    for (std::size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(table.sources[i].src_id, v2.sources[i].src_id);
+        EXPECT_EQ(table.sources[i].rx_count, v2.sources[i].rx_count);
+        EXPECT_EQ(table.sources[i].last_ts_ns, v2.sources[i].last_ts_ns);
+    }
+
+    // A delta against another version is refused
+    SourceStatsTable stale;
+    stale.version = 7;
+    EXPECT_FALSE(stale.apply(view));
+}
+
+TEST(StatsWireTest, RemovedSourceGivesFullResponse) {
+    StatsSnapshot v1 = snapshot_with({source(1, 10), source(2, 20)}, 1);
+    StatsSnapshot v2 = snapshot_with({source(2, 20)}, 2);
+    std::string out;
+    encode_sources_wire(v2, &v1, out);
+    StatsWireView view;
+    ASSERT_TRUE(decode_stats_wire(out.data(), out.size(), view));
+    EXPECT_FALSE(view.delta);
+    ASSERT_EQ(view.sources.size(), 1u);
+    EXPECT_EQ(view.sources[0].src_id, 2u);
+}
+
+TEST(StatsWireTest, RejectsMalformed) {
+    StatsWireView view;
+    std::string err = "ERR UNKNOWN_COMMAND";
+    EXPECT_FALSE(decode_stats_wire(err.data(), err.size(), view));
+
+    std::string out;
+    encode_sources_wire(snapshot_with({source(1, 1)}, 1), nullptr, out);
+    EXPECT_FALSE(decode_stats_wire(out.data(), out.size() - 1, view)); // truncated record
+    out[4] = 9; // version
+    EXPECT_FALSE(decode_stats_wire(out.data(), out.size(), view));
+}
+
+TEST(StatsWireTest, HandlerServesDeltasAgainstRecentVersions) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+    StatsManager stats;
+    CommandHandler handler(stats, Logger::instance());
+    stats.record_rx(1, 1, 1000);
+    stats.record_rx(2, 1, 1000);
+
+    StatsWireView view;
+    std::string r = handler.handle("GET SOURCES BIN");
+    ASSERT_TRUE(decode_stats_wire(r.data(), r.size(), view));
+    EXPECT_FALSE(view.delta);
+    EXPECT_EQ(view.sources.size(), 2u);
+    uint64_t v1 = view.version;
+
+    stats.record_rx(2, 2, 2000);
+    r = handler.handle("get sources bin since=" + std::to_string(v1));
+    ASSERT_TRUE(decode_stats_wire(r.data(), r.size(), view));
+    EXPECT_TRUE(view.delta);
+    EXPECT_EQ(view.base_version, v1);
+    ASSERT_EQ(view.sources.size(), 1u);
+    EXPECT_EQ(view.sources[0].src_id, 2u);
+    EXPECT_EQ(view.sources[0].rx_count, 2u);
+
+    // A version the handler never served: full response
+    r = handler.handle("GET SOURCES BIN SINCE=999999");
+    ASSERT_TRUE(decode_stats_wire(r.data(), r.size(), view));
+    EXPECT_FALSE(view.delta);
+    EXPECT_EQ(view.sources.size(), 2u);
+
+    r = handler.handle("GET STATS BIN");
+    ASSERT_TRUE(decode_stats_wire(r.data(), r.size(), view));
+    EXPECT_EQ(view.kind, StatsWireKind::STATS);
+    EXPECT_EQ(view.global.rx_total, 3u);
+
+    EXPECT_EQ(handler.handle("GET SOURCES BIN SINCE=abc"), "ERR INVALID_VERSION");
+    EXPECT_EQ(handler.handle("GET SOURCES"), "ERR UNKNOWN_COMMAND");
+    EXPECT_EQ(handler.handle("GET STATS BIN SINCE=1"), "ERR UNKNOWN_COMMAND");
+}
@@ -129,3 +129,66 @@ TEST(TcpFramerTest, LargePayload) {
     EXPECT_TRUE(framer.has_frame());
     EXPECT_EQ(framer.pop_frame(), payload);
 }
+
+TEST(TcpFramerTest, PopViewDoesNotCopy) {
+    TcpFramer framer;
+    auto a = TcpFramer::encode("ALPHA");
+    auto b = TcpFramer::encode("BRAVO");
+    a.insert(a.end(), b.begin(), b.end());
+    framer.feed(a.data(), a.size());
+
+    std::string_view first = framer.pop_view();
+    std::string_view second = framer.pop_view();
+    EXPECT_EQ(first, "ALPHA");
+    EXPECT_EQ(second, "BRAVO");
+    EXPECT_EQ(second.data(), first.data() + first.size() + TcpFramer::HEADER_SIZE);
+    EXPECT_FALSE(framer.has_frame());
+    EXPECT_TRUE(framer.pop_view().empty());
+}
+
+TEST(TcpFramerTest, EncodeAppend) {
+    std::vector<uint8_t> out = {0xAA};
+    TcpFramer::encode_append("HI", out);
+    TcpFramer::encode_append("", out);
+    EXPECT_EQ(out, (std::vector<uint8_t>{0xAA, 0, 0, 0, 2, 'H', 'I', 0, 0, 0, 0}));
+
+    TcpFramer framer;
+    framer.feed(out.data() + 1, out.size() - 1);
+    EXPECT_EQ(framer.pop_frame(), "HI");
+    ASSERT_TRUE(framer.has_frame());
+    EXPECT_EQ(framer.pop_frame(), "");
+}
+
+TEST(TcpFramerTest, ManySmallFeedsKeepOrder) {
+    // Byte-at-a-time feeds across many frames exercise compaction and growth
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 2000; ++i)
+        TcpFramer::encode_append(std::string(static_cast<std::size_t>(i % 97), 'a' + i % 26), stream);
+
+    TcpFramer framer;
+    int next = 0;
+    for (std::size_t i = 0; i < stream.size(); i += 7) {
+        framer.feed(stream.data() + i, std::min<std::size_t>(7, stream.size() - i));
+        while (framer.has_frame()) {
+            std::string_view f = framer.pop_view();
+            ASSERT_EQ(f, std::string(static_cast<std::size_t>(next % 97), 'a' + next % 26));
+            ++next;
+        }
+    }
+    EXPECT_EQ(next, 2000);
+    EXPECT_EQ(framer.buffered_bytes(), 0u);
+}
+
+TEST(TcpFramerTest, OversizedLengthDropsPartialData) {
+    TcpFramer framer;
+    auto ok = TcpFramer::encode("KEEP");
+    framer.feed(ok.data(), ok.size());
+    uint8_t bogus[6] = {0xFF, 0xFF, 0xFF, 0xFF, 1, 2};
+    framer.feed(bogus, sizeof(bogus));
+    EXPECT_EQ(framer.buffered_bytes(), 0u);
+    EXPECT_EQ(framer.pop_frame(), "KEEP");
+    EXPECT_FALSE(framer.has_frame());
+
+    framer.feed(ok.data(), ok.size());
+    EXPECT_EQ(framer.pop_frame(), "KEEP");
+}
@@ -2,13 +2,143 @@
 #include "control_node/control_node.h"
 #include "gateway/stats_manager.h"
 #include "common/logger.h"
+#include "control_node/tcp_framer.h"
 #include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <poll.h>
+#include <dirent.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
 #include <sstream>
 #include <thread>
+#include <vector>
 #include <chrono>
 
 using namespace nng;
 
+namespace {
+
+// Send a raw HTTP request and read until the server closes
+std::string http_get(uint16_t port, const std::string& request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return "";
+    }
+    ::send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0)
+        response.append(buf, static_cast<std::size_t>(n));
+    ::close(fd);
+    return response;
+}
+
+int connect_raw(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Threads in this process, from /proc/self/status
+int thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("Threads:", 0) == 0)
+            return std::stoi(line.substr(8));
+    }
+    return -1;
+}
+
+// Next frame from fd, or "" after timeout_ms
+std::string read_frame(int fd, TcpFramer& framer, int timeout_ms = 2000) {
+    uint8_t buf[4096];
+    while (!framer.has_frame()) {
+        struct pollfd pfd{};
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, timeout_ms) <= 0)
+            return "";
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+            return "";
+        framer.feed(buf, static_cast<std::size_t>(n));
+    }
+    return framer.pop_frame();
+}
+
+bool send_frame(int fd, const std::string& cmd) {
+    auto f = TcpFramer::encode(cmd);
+    return ::send(fd, f.data(), f.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(f.size());
+}
+
+EventRecord network_event(const std::string& detail) {
+    EventRecord e{};
+    e.id = EventId::EVT_SEQ_GAP;
+    e.category = EventCategory::NETWORK;
+    e.severity = Severity::WARN;
+    e.timestamp_ns = 1;
+    e.detail = detail;
+    return e;
+}
+
+// True once the server closes fd without sending anything
+bool closed_by_peer(int fd, int timeout_ms = 2000) {
+    struct pollfd p{fd, POLLIN, 0};
+    if (::poll(&p, 1, timeout_ms) <= 0)
+        return false;
+    char c;
+    return ::recv(fd, &c, 1, 0) == 0;
+}
+
+// Highest open fd in this process, from /proc/self/fd
+int highest_fd() {
+    int highest = -1;
+    DIR* dir = ::opendir("/proc/self/fd");
+    if (!dir)
+        return -1;
+    while (struct dirent* e = ::readdir(dir))
+        highest = std::max(highest, std::atoi(e->d_name));
+    ::closedir(dir);
+    return highest;
+}
+
+// Process CPU time, user plus system
+std::chrono::microseconds cpu_time() {
+    struct rusage ru{};
+    ::getrusage(RUSAGE_SELF, &ru);
+    return std::chrono::seconds(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           std::chrono::microseconds(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+bool wait_for_clients(const ControlNode& node, std::size_t n) {
+    for (int i = 0; i < 200 && node.client_count() != n; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return node.client_count() == n;
+}
+
+} // anonymous namespace
+
 class TcpLoopbackTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -150,6 +280,452 @@ TEST_F(TcpLoopbackTest, GetStats) {
     node.stop();
 }
 
+TEST_F(TcpLoopbackTest, MetricsEndpoint) {
+    stats_->record_rx(5, 0, 0);
+    ControlNode node(19907, *stats_, Logger::instance());
+    node.set_metrics_port(19908);
+    ASSERT_TRUE(node.start());
+
+    std::string r = http_get(19908, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+    EXPECT_EQ(r.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(r.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(r.find("\nnng_rx_frames_total 1\n"), std::string::npos);
+    EXPECT_NE(r.find("nng_source_rx_frames_total{src=\"5\"} 1\n"), std::string::npos);
+
+    auto body = r.find("\r\n\r\n");
+    ASSERT_NE(body, std::string::npos);
+    std::string length = "Content-Length: " + std::to_string(r.size() - body - 4) + "\r\n";
+    EXPECT_NE(r.find(length), std::string::npos);
+
+    EXPECT_EQ(http_get(19908, "GET /other HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0), 0u);
+    EXPECT_EQ(http_get(19908, "POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0), 0u);
+
+    node.stop();
+    EXPECT_FALSE(node.is_running());
+}
+
+TEST_F(TcpLoopbackTest, MetricsTricklingScraperIsCutOff) {
+    stats_->record_rx(5, 0, 0);
+    ControlNode node(19919, *stats_, Logger::instance());
+    node.set_metrics_port(19920);
+    ASSERT_TRUE(node.start());
+
+    // A request trickled in a byte at a time never finishes its headers;
+    // each byte comes well inside any per-read timeout
+    int slow = connect_raw(19920);
+    ASSERT_GE(slow, 0);
+    std::atomic<bool> done{false};
+    std::thread trickle([&] {
+        const std::string partial = "GET /metrics HTTP/1.1\r\nX-Slow: ";
+        for (std::size_t i = 0; !done.load() && i < 60; ++i) {
+            char c = i < partial.size() ? partial[i] : 'x';
+            ::send(slow, &c, 1, MSG_NOSIGNAL);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Served once the slow connection's time is up, not after it gives up
+    auto start = std::chrono::steady_clock::now();
+    std::string r = http_get(19920, "GET /metrics HTTP/1.1\r\n\r\n");
+    auto waited = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(r.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_LT(waited, std::chrono::milliseconds(4000));
+
+    done = true;
+    trickle.join();
+    ::close(slow);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, ManyClientsShareOneThread) {
+    ControlNode node(19909, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    int threads = thread_count();
+
+    constexpr std::size_t CLIENTS = 300;
+    std::vector<std::unique_ptr<CliClient>> clients;
+    for (std::size_t i = 0; i < CLIENTS; ++i) {
+        clients.push_back(std::make_unique<CliClient>());
+        ASSERT_TRUE(clients.back()->connect("127.0.0.1", 19909));
+    }
+    for (auto& c : clients)
+        EXPECT_NE(c->send_command("GET health").find("HEALTH"), std::string::npos);
+    EXPECT_TRUE(wait_for_clients(node, CLIENTS));
+    EXPECT_EQ(thread_count(), threads);
+
+    for (auto& c : clients)
+        c->close();
+    EXPECT_TRUE(wait_for_clients(node, 0));
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, ReconnectsDoNotAccumulate) {
+    ControlNode node(19910, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    int threads = thread_count();
+
+    for (int i = 0; i < 200; ++i) {
+        CliClient client;
+        ASSERT_TRUE(client.connect("127.0.0.1", 19910));
+        EXPECT_NE(client.send_command("GET health").find("OK"), std::string::npos);
+        client.close();
+    }
+    EXPECT_TRUE(wait_for_clients(node, 0));
+    EXPECT_EQ(thread_count(), threads);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, ClientsOverCapAreClosed) {
+    ControlNode node(19922, *stats_, Logger::instance());
+    node.set_max_clients(2);
+    ASSERT_TRUE(node.start());
+
+    CliClient a, b;
+    ASSERT_TRUE(a.connect("127.0.0.1", 19922));
+    ASSERT_TRUE(b.connect("127.0.0.1", 19922));
+    ASSERT_TRUE(wait_for_clients(node, 2));
+    int extra = connect_raw(19922);
+    ASSERT_GE(extra, 0);
+    EXPECT_TRUE(closed_by_peer(extra));
+    EXPECT_EQ(node.clients_rejected(), 1u);
+    EXPECT_EQ(node.client_count(), 2u);
+    ::close(extra);
+
+    // A slot frees up once a client leaves
+    a.close();
+    ASSERT_TRUE(wait_for_clients(node, 1));
+    CliClient c;
+    ASSERT_TRUE(c.connect("127.0.0.1", 19922));
+    EXPECT_NE(c.send_command("GET health").find("HEALTH"), std::string::npos);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, OutOfFdsRefusesWithoutSpinning) {
+    ControlNode node(19923, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+
+    // Leave the process no free fd below the limit
+    struct rlimit saved{};
+    ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &saved), 0);
+    struct rlimit tight = saved;
+    tight.rlim_cur = static_cast<rlim_t>(highest_fd() + 1);
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &tight), 0);
+    std::vector<int> fillers;
+    for (int d; (d = ::dup(fd)) >= 0;)
+        fillers.push_back(d);
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(19923);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    bool connected = ::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+    bool refused = connected && closed_by_peer(fd);
+    uint64_t rejected = node.clients_rejected();
+    auto cpu_before = cpu_time();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    auto cpu_spent = cpu_time() - cpu_before;
+
+    for (int d : fillers)
+        ::close(d);
+    ::setrlimit(RLIMIT_NOFILE, &saved);
+    ::close(fd);
+
+    EXPECT_TRUE(connected);
+    EXPECT_TRUE(refused);
+    EXPECT_EQ(rejected, 1u);
+    EXPECT_LT(cpu_spent, std::chrono::milliseconds(100));
+
+    // Accepting works again once fds are back
+    CliClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 19923));
+    EXPECT_NE(client.send_command("GET health").find("HEALTH"), std::string::npos);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, PipelinedCommandsAnsweredInOrder) {
+    ControlNode node(19911, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    int fd = connect_raw(19911);
+    ASSERT_GE(fd, 0);
+
+    // Three commands in one write, the last split over two
+    std::vector<uint8_t> out;
+    for (const char* cmd : {"GET health", "INVALID", "GET stats"}) {
+        auto f = TcpFramer::encode(cmd);
+        out.insert(out.end(), f.begin(), f.end());
+    }
+    ASSERT_EQ(::send(fd, out.data(), out.size() - 3, 0), static_cast<ssize_t>(out.size() - 3));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(::send(fd, out.data() + out.size() - 3, 3, 0), 3);
+
+    TcpFramer framer;
+    uint8_t buf[4096];
+    std::vector<std::string> responses;
+    while (responses.size() < 3) {
+        while (framer.has_frame())
+            responses.push_back(framer.pop_frame());
+        if (responses.size() < 3) {
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            ASSERT_GT(n, 0);
+            framer.feed(buf, static_cast<std::size_t>(n));
+        }
+    }
+    EXPECT_NE(responses[0].find("HEALTH"), std::string::npos);
+    EXPECT_NE(responses[1].find("ERR"), std::string::npos);
+    EXPECT_NE(responses[2].find("rx_total"), std::string::npos);
+    ::close(fd);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, ClientPipelinesCommands) {
+    ControlNode node(19916, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    stats_->record_rx(1, 1, 1000);
+    CliClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 19916));
+
+    auto responses = client.send_commands({"GET health", "INVALID", "GET stats"});
+    ASSERT_EQ(responses.size(), 3u);
+    EXPECT_NE(responses[0].find("HEALTH"), std::string::npos);
+    EXPECT_EQ(responses[1], "ERR UNKNOWN_COMMAND");
+    EXPECT_NE(responses[2].find("rx_total=1"), std::string::npos);
+
+    // Far more than fits in the socket buffers before anything is read
+    std::vector<std::string> many(20000, "GET stats");
+    responses = client.send_commands(many);
+    ASSERT_EQ(responses.size(), many.size());
+    for (const auto& r : responses)
+        ASSERT_NE(r.find("rx_total=1"), std::string::npos);
+    EXPECT_NE(client.send_command("GET health").find("HEALTH"), std::string::npos);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, BatchAnsweredWithOneFramePerCommand) {
+    ControlNode node(19917, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    CliClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 19917));
+
+    std::vector<std::string> sweep;
+    for (int i = 0; i < 50; ++i)
+        sweep.push_back(i % 2 ? "GET RATES" : "GET health");
+    auto responses = client.send_batch(sweep);
+    ASSERT_EQ(responses.size(), sweep.size());
+    for (std::size_t i = 0; i < sweep.size(); ++i)
+        EXPECT_NE(responses[i].find(i % 2 ? "RATES" : "HEALTH"), std::string::npos) << i;
+
+    // Pipelined batches stay in order with plain commands
+    responses = client.send_commands({"BATCH\nGET health\nSET CRC=ON", "INVALID"});
+    ASSERT_EQ(responses.size(), 2u); // the batch's second answer is still unread
+    EXPECT_NE(responses[0].find("HEALTH"), std::string::npos);
+    EXPECT_EQ(responses[1], "OK CRC=ON");
+    EXPECT_EQ(client.send_command("GET health").rfind("ERR", 0), 0u); // INVALID's answer
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, ClientPollsBinaryStats) {
+    ControlNode node(19918, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    CliClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 19918));
+    for (uint16_t src = 1; src <= 1000; ++src)
+        stats_->record_rx(src, 1, 1000);
+    stats_->publish_snapshot();
+
+    GlobalStats g;
+    HealthState health = HealthState::ERROR;
+    ASSERT_TRUE(client.get_stats(g, &health));
+    EXPECT_EQ(g.rx_total, 1000u);
+    EXPECT_EQ(health, HealthState::OK);
+
+    SourceStatsTable table;
+    ASSERT_TRUE(client.poll_sources(table));
+    ASSERT_EQ(table.sources.size(), 1000u);
+    stats_->record_rx(500, 2, 2000);
+    stats_->publish_snapshot(); // the node reuses snapshots up to 100 ms old
+    ASSERT_TRUE(client.poll_sources(table));
+    ASSERT_EQ(table.sources.size(), 1000u);
+    EXPECT_EQ(table.sources[499].src_id, 500u);
+    EXPECT_EQ(table.sources[499].rx_count, 2u);
+    EXPECT_EQ(table.sources[499].last_seq, 2u);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, BurstLargerThanOneReadTurnIsAnsweredFully) {
+    ControlNode node(19921, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    int fd = connect_raw(19921);
+    ASSERT_GE(fd, 0);
+
+    // Several MAX_READ_PER_TURN worth of commands in one burst
+    auto cmd = TcpFramer::encode("GET health");
+    const std::size_t count = 4 * ControlNode::MAX_READ_PER_TURN / cmd.size();
+    std::vector<uint8_t> burst;
+    for (std::size_t i = 0; i < count; ++i)
+        burst.insert(burst.end(), cmd.begin(), cmd.end());
+    std::thread writer([&] { ::send(fd, burst.data(), burst.size(), MSG_NOSIGNAL); });
+
+    TcpFramer framer;
+    std::size_t answered = 0;
+    for (; answered < count; ++answered) {
+        std::string r = read_frame(fd, framer);
+        if (r.find("HEALTH") == std::string::npos)
+            break;
+    }
+    EXPECT_EQ(answered, count);
+    writer.join();
+    ::close(fd);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, StalledClientDoesNotBlockOthers) {
+    ControlNode node(19912, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+
+    // A client that sends many commands and never reads the answers
+    int stalled = connect_raw(19912);
+    ASSERT_GE(stalled, 0);
+    auto cmd = TcpFramer::encode("GET stats");
+    std::vector<uint8_t> burst;
+    for (int i = 0; i < 20000; ++i)
+        burst.insert(burst.end(), cmd.begin(), cmd.end());
+    std::thread writer([&] { ::send(stalled, burst.data(), burst.size(), MSG_NOSIGNAL); });
+
+    CliClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 19912));
+    EXPECT_NE(client.send_command("GET health").find("HEALTH"), std::string::npos);
+    client.close();
+
+    // stop() closes the stalled connection, unblocking its writer
+    node.stop();
+    writer.join();
+    ::close(stalled);
+}
+
+TEST_F(TcpLoopbackTest, SubscribeStreamsMatchingEvents) {
+    EventBus bus;
+    ControlNode node(19913, *stats_, Logger::instance());
+    node.set_event_bus(&bus);
+    ASSERT_TRUE(node.start());
+    int fd = connect_raw(19913);
+    ASSERT_GE(fd, 0);
+    TcpFramer framer;
+
+    ASSERT_TRUE(send_frame(fd, "subscribe NETWORK"));
+    EXPECT_EQ(read_frame(fd, framer), "OK SUBSCRIBED");
+
+    EventRecord health{};
+    health.id = EventId::EVT_HEARTBEAT_OK;
+    health.category = EventCategory::HEALTH;
+    health.severity = Severity::INFO;
+    bus.publish(health); // not subscribed
+    bus.publish(network_event("src_id=7 first"));
+    std::string push = read_frame(fd, framer);
+    EXPECT_EQ(push.rfind("PUSH EVENT ", 0), 0u);
+    EXPECT_NE(push.find("NETWORK"), std::string::npos);
+    EXPECT_NE(push.find("EVT_SEQ_GAP"), std::string::npos);
+    EXPECT_NE(push.find("src_id=7 first"), std::string::npos);
+
+    // Commands still work between pushes
+    ASSERT_TRUE(send_frame(fd, "GET HEALTH"));
+    EXPECT_EQ(read_frame(fd, framer).rfind("HEALTH", 0), 0u);
+
+    ASSERT_TRUE(send_frame(fd, "UNSUBSCRIBE NETWORK"));
+    EXPECT_EQ(read_frame(fd, framer), "OK UNSUBSCRIBED");
+    bus.publish(network_event("after"));
+    bus.flush();
+    EXPECT_EQ(read_frame(fd, framer, 100), "");
+
+    ASSERT_TRUE(send_frame(fd, "SUBSCRIBE RADAR"));
+    EXPECT_EQ(read_frame(fd, framer), "ERR INVALID_SUBSCRIBE");
+    ::close(fd);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, SubscribeStatsPushesPeriodically) {
+    ControlNode node(19914, *stats_, Logger::instance());
+    ASSERT_TRUE(node.start());
+    int fd = connect_raw(19914);
+    ASSERT_GE(fd, 0);
+    TcpFramer framer;
+
+    ASSERT_TRUE(send_frame(fd, "SUBSCRIBE STATS 20"));
+    EXPECT_EQ(read_frame(fd, framer), "OK SUBSCRIBED STATS interval_ms=20");
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        std::string push = read_frame(fd, framer);
+        EXPECT_EQ(push.rfind("PUSH STATS\nrx_total=", 0), 0u);
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+    // Events need a bus
+    ASSERT_TRUE(send_frame(fd, "SUBSCRIBE ALL"));
+    std::string r;
+    do {
+        r = read_frame(fd, framer);
+    } while (r.rfind("PUSH ", 0) == 0);
+    EXPECT_EQ(r, "ERR EVENTS_UNAVAILABLE");
+    ::close(fd);
+    node.stop();
+}
+
+TEST_F(TcpLoopbackTest, SlowSubscriberLagsWithoutStallingPublisher) {
+    EventBus bus;
+    ControlNode node(19915, *stats_, Logger::instance());
+    node.set_event_bus(&bus);
+    ASSERT_TRUE(node.start());
+    int fd = connect_raw(19915);
+    ASSERT_GE(fd, 0);
+    TcpFramer framer;
+    ASSERT_TRUE(send_frame(fd, "SUBSCRIBE ALL"));
+    EXPECT_EQ(read_frame(fd, framer), "OK SUBSCRIBED");
+
+    // Far more than the push backlog, while the client reads nothing
+    std::string detail(1000, 'x');
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20000; ++i) {
+        bus.publish(network_event(detail));
+        if (i % 500 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    bus.flush();
+    for (int i = 0; i < 100 && node.pushes_dropped() == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_GT(node.pushes_dropped(), 0u);
+
+    // Catch up until a push published now gets through; a quiet read only
+    // means the node is slow, so "last" goes out again rather than being
+    // taken as a sign the backlog drained. Lost pushes are reported once
+    // delivery resumes, before the next push that does get through.
+    bool lag_seen = false, last_seen = false;
+    uint64_t reported = 0;
+    bus.publish(network_event("last"));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(8);
+    while (!last_seen && std::chrono::steady_clock::now() < deadline) {
+        std::string r = read_frame(fd, framer, 200);
+        if (r.empty()) {
+            bus.publish(network_event("last"));
+        } else if (r.rfind("PUSH LAGGING dropped=", 0) == 0) {
+            lag_seen = true;
+            reported += std::stoull(r.substr(21));
+        } else if (r.find("last") != std::string::npos) {
+            last_seen = true;
+        }
+    }
+    EXPECT_TRUE(last_seen);
+    EXPECT_TRUE(lag_seen);
+    EXPECT_GT(reported, 0u);
+    // pushes_dropped() also counts events lost to a full event queue
+    EXPECT_LE(reported, node.pushes_dropped());
+    EXPECT_EQ(node.lag_disconnects(), 0u);
+    ::close(fd);
+    node.stop();
+}
+
 TEST_F(TcpLoopbackTest, ClientConnectFail) {
     CliClient client;
 
@@ -2,8 +2,10 @@
 #include "gateway/telemetry_parser.h"
 #include "common/protocol.h"
 #include "common/crc32.h"
+#include "common/container.h"
 #include <vector>
 #include <cstring>
+#include <cstddef>
 
 using namespace nng;
 
@@ -207,3 +209,420 @@ TEST(TelemetryParser, ValidEngagement) {
     EXPECT_EQ(parsed.assigned_track, 1042u);
     EXPECT_EQ(parsed.rounds_remaining, 480);
 }
+
+// Mix of valid frames and every kind of header error, longer than one
+// SIMD step and not a multiple of it
+static std::vector<std::vector<uint8_t>> build_mixed_frames(bool crc) {
+    std::vector<std::vector<uint8_t>> frames;
+    PlotPayload pp{};
+    for (uint32_t i = 0; i < 45; ++i) {
+        TelemetryHeader hdr{};
+        hdr.version = PROTOCOL_VERSION;
+        hdr.msg_type = static_cast<uint8_t>(MsgType::PLOT);
+        hdr.src_id = 1;
+        hdr.seq = i;
+        hdr.payload_len = sizeof(PlotPayload);
+        pp.plot_id = i;
+        auto buf = build_frame(hdr, reinterpret_cast<const uint8_t*>(&pp), crc);
+
+        switch (i % 9) {
+            case 1: buf.resize(10); break;                          // TOO_SHORT
+            case 3: buf[0] = 7; break;                              // BAD_VERSION
+            case 4: buf[1] = 0x09; break;                           // BAD_MSG_TYPE
+            case 5: buf[1] = 0x00; break;                           // BAD_MSG_TYPE
+            case 6: buf[16] = 0xFF; buf[17] = 0xFF; break;          // PAYLOAD_TOO_LONG
+            case 7: buf.resize(buf.size() - 2); break;              // TRUNCATED
+            case 8: if (crc) buf[FRAME_HEADER_SIZE] ^= 0x01; break; // CRC_MISMATCH
+            default: break;
+        }
+        frames.push_back(std::move(buf));
+    }
+    return frames;
+}
+
+static void expect_batch_matches_scalar(bool crc) {
+    auto frames = build_mixed_frames(crc);
+    std::vector<FrameView> views;
+    for (const auto& f : frames)
+        views.push_back(FrameView{f.data(), f.size()});
+
+    ParsedFrameBatch batch;
+    std::size_t ok = parse_frames(views.data(), views.size(), crc, batch);
+    ASSERT_EQ(batch.count, frames.size());
+
+    std::size_t expected_ok = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        ParsedFrame pf{};
+        ParseError err = parse_frame(frames[i].data(), frames[i].size(), crc, pf);
+        EXPECT_EQ(batch.errors[i], err) << "frame " << i;
+        EXPECT_EQ(batch.ok(i), err == ParseError::OK) << "frame " << i;
+        if (err == ParseError::OK) {
+            ++expected_ok;
+            ParsedFrame bf = batch.frame(i);
+            EXPECT_EQ(bf.header.seq, pf.header.seq);
+            EXPECT_EQ(bf.payload_ptr, pf.payload_ptr);
+            EXPECT_EQ(bf.crc, pf.crc);
+            EXPECT_EQ(bf.has_crc, crc);
+        }
+    }
+    EXPECT_EQ(ok, expected_ok);
+    EXPECT_EQ(batch.error_count, frames.size() - expected_ok);
+}
+
+TEST(TelemetryParser, BatchMatchesScalarNoCrc) {
+    expect_batch_matches_scalar(false);
+}
+
+TEST(TelemetryParser, BatchMatchesScalarWithCrc) {
+    expect_batch_matches_scalar(true);
+}
+
+TEST(TelemetryParser, BatchReuseClearsErrorBits) {
+    auto frames = build_mixed_frames(false);
+    std::vector<FrameView> views;
+    for (const auto& f : frames)
+        views.push_back(FrameView{f.data(), f.size()});
+
+    ParsedFrameBatch batch(64);
+    parse_frames(views.data(), views.size(), false, batch);
+    EXPECT_GT(batch.error_count, 0u);
+
+    // Second pass over only the first (valid) frame
+    EXPECT_EQ(parse_frames(views.data(), 1, false, batch), 1u);
+    EXPECT_EQ(batch.count, 1u);
+    EXPECT_EQ(batch.error_count, 0u);
+    EXPECT_EQ(batch.error_bits[0], 0u);
+}
+
+// --- Protocol v2 containers ---
+
+static std::vector<std::vector<uint8_t>> build_track_frames(uint32_t count) {
+    std::vector<std::vector<uint8_t>> frames;
+    TrackPayload tp{};
+    for (uint32_t i = 0; i < count; ++i) {
+        TelemetryHeader hdr{};
+        hdr.version = PROTOCOL_VERSION;
+        hdr.msg_type = static_cast<uint8_t>(MsgType::TRACK);
+        hdr.src_id = 3;
+        hdr.seq = i;
+        hdr.payload_len = sizeof(TrackPayload);
+        tp.track_id = 1000 + i;
+        frames.push_back(build_frame(hdr, reinterpret_cast<const uint8_t*>(&tp), false));
+    }
+    return frames;
+}
+
+static std::vector<FrameView> views_of(const std::vector<std::vector<uint8_t>>& dgrams) {
+    std::vector<FrameView> views;
+    for (const auto& d : dgrams)
+        views.push_back(FrameView{d.data(), d.size()});
+    return views;
+}
+
+TEST(TelemetryParser, ContainersPackToMtuAndParseInOrder) {
+    auto frames = build_track_frames(100);
+    auto containers = pack_containers(frames);
+
+    // 43-byte frames: 34 fit a 1472-byte datagram with header and CRC
+    EXPECT_EQ(containers.size(), 3u);
+    for (const auto& c : containers) {
+        EXPECT_LE(c.size(), CONTAINER_MAX_DATAGRAM);
+        EXPECT_TRUE(is_container(c.data(), c.size()));
+    }
+
+    auto views = views_of(containers);
+    ParsedFrameBatch batch;
+    EXPECT_EQ(parse_frames(views.data(), views.size(), true, batch), 100u);
+    ASSERT_EQ(batch.count, 100u);
+    for (uint32_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(batch.errors[i], ParseError::OK);
+        EXPECT_EQ(batch.headers[i].seq, i);
+        EXPECT_EQ(batch.frame_lens[i], FRAME_HEADER_SIZE + sizeof(TrackPayload));
+        EXPECT_EQ(deserialize_track(batch.payload_ptrs[i]).track_id, 1000 + i);
+        EXPECT_LT(batch.sources[i], containers.size());
+    }
+    EXPECT_EQ(batch.sources[0], 0u);
+    EXPECT_EQ(batch.sources[99], 2u);
+}
+
+TEST(TelemetryParser, MixedV1AndV2Datagrams) {
+    auto frames = build_track_frames(40);
+
+    // v1 frames with per-frame CRC around a container
+    std::vector<std::vector<uint8_t>> dgrams;
+    for (int i = 0; i < 20; ++i) {
+        TelemetryHeader hdr = deserialize_header(frames[0].data());
+        hdr.seq = 500 + i;
+        dgrams.push_back(build_frame(hdr, frames[0].data() + FRAME_HEADER_SIZE, true));
+    }
+    auto containers = pack_containers(frames);
+    ASSERT_EQ(containers.size(), 2u);
+    dgrams.insert(dgrams.begin() + 10, containers[0]);
+    dgrams.push_back(containers[1]);
+
+    auto views = views_of(dgrams);
+    ParsedFrameBatch batch;
+    EXPECT_EQ(parse_frames(views.data(), views.size(), true, batch), 60u);
+    EXPECT_EQ(batch.error_count, 0u);
+    EXPECT_EQ(batch.headers[9].seq, 509u);
+    EXPECT_EQ(batch.headers[10].seq, 0u);  // first frame of the container
+    EXPECT_EQ(batch.sources[10], 10u);
+    EXPECT_EQ(batch.sources[59], 21u);
+}
+
+TEST(TelemetryParser, ContainerCrcChecks) {
+    auto frames = build_track_frames(10);
+    auto with_crc = pack_containers(frames, CONTAINER_MAX_DATAGRAM, true);
+    auto no_crc = pack_containers(frames, CONTAINER_MAX_DATAGRAM, false);
+    ASSERT_EQ(with_crc.size(), 1u);
+    ASSERT_EQ(no_crc.size(), 1u);
+
+    // Corrupt one payload byte: the whole container is rejected once
+    auto bad = with_crc[0];
+    bad[CONTAINER_HEADER_SIZE + FRAME_HEADER_SIZE + 2] ^= 0x40;
+    FrameView v{bad.data(), bad.size()};
+    ParsedFrameBatch batch;
+    EXPECT_EQ(parse_frames(&v, 1, true, batch), 0u);
+    ASSERT_EQ(batch.count, 1u);
+    EXPECT_EQ(batch.errors[0], ParseError::CRC_MISMATCH);
+    EXPECT_FALSE(batch.ok(0));
+
+    // With CRC validation off the container is accepted as is
+    EXPECT_EQ(parse_frames(&v, 1, false, batch), 10u);
+
+    // CRC required but not present
+    FrameView nv{no_crc[0].data(), no_crc[0].size()};
+    EXPECT_EQ(parse_frames(&nv, 1, true, batch), 0u);
+    EXPECT_EQ(batch.errors[0], ParseError::CRC_MISMATCH);
+    EXPECT_EQ(parse_frames(&nv, 1, false, batch), 10u);
+}
+
+TEST(TelemetryParser, MalformedContainers) {
+    auto frames = build_track_frames(5);
+    auto c = pack_containers(frames, CONTAINER_MAX_DATAGRAM, false)[0];
+    ParsedFrameBatch batch;
+
+    // Truncated datagram
+    FrameView trunc{c.data(), c.size() - 10};
+    EXPECT_EQ(parse_frames(&trunc, 1, false, batch), 0u);
+    EXPECT_EQ(batch.errors[0], ParseError::TRUNCATED);
+
+    FrameView tiny{c.data(), 3};
+    parse_frames(&tiny, 1, false, batch);
+    EXPECT_EQ(batch.errors[0], ParseError::TOO_SHORT);
+
+    // A bad inner msg_type is reported and skipped
+    auto bad_type = c;
+    std::size_t frame_len = FRAME_HEADER_SIZE + sizeof(TrackPayload);
+    bad_type[CONTAINER_HEADER_SIZE + 2 * frame_len + 1] = 0x7F;
+    FrameView bt{bad_type.data(), bad_type.size()};
+    EXPECT_EQ(parse_frames(&bt, 1, false, batch), 4u);
+    ASSERT_EQ(batch.count, 5u);
+    EXPECT_EQ(batch.errors[2], ParseError::BAD_MSG_TYPE);
+    EXPECT_EQ(batch.headers[4].seq, 4u);
+
+    // frame_count larger than the body holds
+    auto overcount = c;
+    ContainerHeader ch = deserialize_container_header(overcount.data());
+    ch.frame_count = 7;
+    serialize_container_header(ch, overcount.data());
+    FrameView oc{overcount.data(), overcount.size()};
+    EXPECT_EQ(parse_frames(&oc, 1, false, batch), 5u);
+    ASSERT_EQ(batch.count, 6u);
+    EXPECT_EQ(batch.errors[5], ParseError::TOO_SHORT);
+}
+
+TEST(TelemetryParser, ContainerBuilderSplitsAtLimit) {
+    auto frames = build_track_frames(10);
+    // Room for exactly three 43-byte frames
+    std::size_t limit = CONTAINER_HEADER_SIZE + 3 * frames[0].size() + FRAME_CRC_SIZE;
+    ContainerBuilder builder(limit, true);
+    for (const auto& f : frames)
+        builder.add(f);
+    builder.flush();
+    auto out = builder.take();
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_EQ(out[0].size(), limit);
+    EXPECT_EQ(deserialize_container_header(out[3].data()).frame_count, 1u);
+    EXPECT_TRUE(builder.take().empty());
+}
+
+TEST(TelemetryParser, IngressFilterDropsBeforeCrc) {
+    // 40 v1 frames with CRC, alternating sources 1 and 2 (covers both the
+    // SSE2 and scalar paths)
+    std::vector<std::vector<uint8_t>> dgrams;
+    TrackPayload tp{};
+    for (uint32_t i = 0; i < 40; ++i) {
+        TelemetryHeader hdr{};
+        hdr.version = PROTOCOL_VERSION;
+        hdr.msg_type = static_cast<uint8_t>(MsgType::TRACK);
+        hdr.src_id = static_cast<uint16_t>(1 + i % 2);
+        hdr.seq = i;
+        hdr.payload_len = sizeof(TrackPayload);
+        dgrams.push_back(build_frame(hdr, reinterpret_cast<const uint8_t*>(&tp), true));
+    }
+    // A corrupt frame from the filtered source is dropped, not a CRC failure
+    dgrams[2].back() ^= 0xFF;
+
+    IngressFilter filter;
+    ASSERT_TRUE(filter.set("src=2"));
+    auto views = views_of(dgrams);
+    ParsedFrameBatch batch;
+    EXPECT_EQ(parse_frames(views.data(), views.size(), true, batch, &filter), 20u);
+    EXPECT_EQ(batch.count, 20u);
+    EXPECT_EQ(batch.error_count, 0u);
+    EXPECT_EQ(batch.filtered_count, 20u);
+    for (std::size_t i = 0; i < batch.count; ++i) {
+        EXPECT_EQ(batch.headers[i].src_id, 2u);
+        EXPECT_EQ(batch.sources[i], 2 * i + 1);
+    }
+
+    // Accept-all filter behaves like no filter
+    ASSERT_TRUE(filter.set("ALL"));
+    EXPECT_EQ(parse_frames(views.data(), views.size(), true, batch, &filter), 39u);
+    EXPECT_EQ(batch.filtered_count, 0u);
+    EXPECT_EQ(batch.error_count, 1u);
+}
+
+TEST(TelemetryParser, IngressFilterContainerFrames) {
+    auto frames = build_track_frames(10);
+    // Make every other frame a PLOT header (payload bytes do not matter here)
+    for (std::size_t i = 0; i < frames.size(); i += 2)
+        frames[i][offsetof(TelemetryHeader, msg_type)] = static_cast<uint8_t>(MsgType::PLOT);
+    auto containers = pack_containers(frames);
+    ASSERT_EQ(containers.size(), 1u);
+
+    IngressFilter filter;
+    ASSERT_TRUE(filter.set("type=TRACK"));
+    FrameView v{containers[0].data(), containers[0].size()};
+    ParsedFrameBatch batch;
+    EXPECT_EQ(parse_frames(&v, 1, true, batch, &filter), 5u);
+    EXPECT_EQ(batch.filtered_count, 5u);
+    for (std::size_t i = 0; i < batch.count; ++i) {
+        EXPECT_EQ(batch.headers[i].msg_type, static_cast<uint8_t>(MsgType::TRACK));
+        EXPECT_EQ(batch.headers[i].seq, 2 * i + 1);
+    }
+}
+
+TEST(TelemetryParser, ViewsReadFieldsInPlace) {
+    TrackPayload tp{};
+    tp.track_id = 0xA1B2C3D4;
+    tp.classification = static_cast<uint8_t>(TrackClass::MISSILE);
+    tp.threat_level = static_cast<uint8_t>(ThreatLevel::CRITICAL);
+    tp.iff_status = 2;
+    tp.azimuth_mdeg = -123456;
+    tp.elevation_mdeg = 4567;
+    tp.range_m = 98765;
+    tp.velocity_mps = -321;
+    tp.rcs_dbsm = -12;
+    tp.update_count = 65000;
+
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::TRACK);
+    hdr.src_id = 0xBEEF;
+    hdr.seq = 0x01020304;
+    hdr.ts_ns = 0x1122334455667788ULL;
+    hdr.payload_len = sizeof(TrackPayload);
+    auto buf = build_frame(hdr, reinterpret_cast<const uint8_t*>(&tp), false);
+
+    // Views over an odd address: fields are read unaligned
+    std::vector<uint8_t> shifted(buf.size() + 1);
+    std::memcpy(shifted.data() + 1, buf.data(), buf.size());
+    HeaderView h(shifted.data() + 1);
+    EXPECT_EQ(h.version(), PROTOCOL_VERSION);
+    EXPECT_EQ(h.msg_type(), static_cast<uint8_t>(MsgType::TRACK));
+    EXPECT_EQ(h.src_id(), 0xBEEF);
+    EXPECT_EQ(h.seq(), 0x01020304u);
+    EXPECT_EQ(h.ts_ns(), 0x1122334455667788ULL);
+    EXPECT_EQ(h.payload_len(), sizeof(TrackPayload));
+    TelemetryHeader copy = h.copy();
+    EXPECT_EQ(std::memcmp(&hdr, &copy, sizeof(hdr)), 0);
+
+    TrackView t(shifted.data() + 1 + FRAME_HEADER_SIZE);
+    EXPECT_EQ(t.track_id(), 0xA1B2C3D4u);
+    EXPECT_EQ(t.classification(), tp.classification);
+    EXPECT_EQ(t.threat_level(), tp.threat_level);
+    EXPECT_EQ(t.iff_status(), 2);
+    EXPECT_EQ(t.azimuth_mdeg(), -123456);
+    EXPECT_EQ(t.elevation_mdeg(), 4567);
+    EXPECT_EQ(t.range_m(), 98765u);
+    EXPECT_EQ(t.velocity_mps(), -321);
+    EXPECT_EQ(t.rcs_dbsm(), -12);
+    EXPECT_EQ(t.update_count(), 65000);
+
+    // Wire order is little-endian whatever the host
+    const uint8_t le[] = {0x04, 0x03, 0x02, 0x01};
+    EXPECT_EQ(load_le<uint32_t>(le), 0x01020304u);
+    EXPECT_EQ(byte_swap<uint16_t>(0x1234), 0x3412);
+    EXPECT_EQ(byte_swap<int32_t>(0x01020304), 0x04030201);
+    EXPECT_EQ(byte_swap<uint64_t>(0x0102030405060708ULL), 0x0807060504030201ULL);
+}
+
+TEST(TelemetryParser, PayloadViewsMatchDeserialize) {
+    PlotPayload pp{};
+    pp.plot_id = 77;
+    pp.azimuth_mdeg = -90000;
+    pp.elevation_mdeg = 1500;
+    pp.range_m = 42000;
+    pp.amplitude_db = -30;
+    pp.doppler_mps = 250;
+    pp.quality = 9;
+    uint8_t pbuf[sizeof(PlotPayload)];
+    serialize_plot(pp, pbuf);
+    PlotView p(pbuf);
+    EXPECT_EQ(p.plot_id(), pp.plot_id);
+    EXPECT_EQ(p.azimuth_mdeg(), pp.azimuth_mdeg);
+    EXPECT_EQ(p.elevation_mdeg(), pp.elevation_mdeg);
+    EXPECT_EQ(p.range_m(), pp.range_m);
+    EXPECT_EQ(p.amplitude_db(), pp.amplitude_db);
+    EXPECT_EQ(p.doppler_mps(), pp.doppler_mps);
+    EXPECT_EQ(p.quality(), pp.quality);
+
+    HeartbeatPayload hb{};
+    hb.subsystem_id = 513;
+    hb.state = static_cast<uint8_t>(SubsystemState::DEGRADED);
+    hb.cpu_pct = 55;
+    hb.mem_pct = 66;
+    hb.uptime_s = 86400;
+    hb.error_code = 0xE01;
+    uint8_t hbuf[sizeof(HeartbeatPayload)];
+    serialize_heartbeat(hb, hbuf);
+    HeartbeatView v(hbuf);
+    EXPECT_EQ(v.subsystem_id(), hb.subsystem_id);
+    EXPECT_EQ(v.state(), hb.state);
+    EXPECT_EQ(v.cpu_pct(), hb.cpu_pct);
+    EXPECT_EQ(v.mem_pct(), hb.mem_pct);
+    EXPECT_EQ(v.uptime_s(), hb.uptime_s);
+    EXPECT_EQ(v.error_code(), hb.error_code);
+
+    EngagementPayload ep{};
+    ep.weapon_id = 3;
+    ep.mode = 2;
+    ep.assigned_track = 123456;
+    ep.rounds_remaining = 480;
+    ep.barrel_temp_c = -5;
+    ep.burst_count = 17;
+    uint8_t ebuf[sizeof(EngagementPayload)];
+    serialize_engagement(ep, ebuf);
+    EngagementView e(ebuf);
+    EXPECT_EQ(e.weapon_id(), ep.weapon_id);
+    EXPECT_EQ(e.mode(), ep.mode);
+    EXPECT_EQ(e.assigned_track(), ep.assigned_track);
+    EXPECT_EQ(e.rounds_remaining(), ep.rounds_remaining);
+    EXPECT_EQ(e.barrel_temp_c(), ep.barrel_temp_c);
+    EXPECT_EQ(e.burst_count(), ep.burst_count);
+
+    ContainerHeader ch{};
+    ch.version = PROTOCOL_VERSION_V2;
+    ch.flags = CONTAINER_FLAG_CRC;
+    ch.frame_count = 34;
+    ch.body_len = 1462;
+    uint8_t cbuf[sizeof(ContainerHeader)];
+    serialize_container_header(ch, cbuf);
+    ContainerView c(cbuf);
+    EXPECT_EQ(c.version(), PROTOCOL_VERSION_V2);
+    EXPECT_EQ(c.flags(), CONTAINER_FLAG_CRC);
+    EXPECT_EQ(c.frame_count(), 34);
+    EXPECT_EQ(c.body_len(), 1462);
+}
@@ -0,0 +1,138 @@
+#include "common/thread_placement.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "common/protocol.h"
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+// A CPU this process may run on
+int allowed_cpu() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0)
+        return 0;
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &set))
+            return c;
+    }
+    return 0;
+}
+
+std::vector<uint8_t> heartbeat(uint16_t src_id, uint32_t seq) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(HeartbeatPayload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::HEARTBEAT);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(HeartbeatPayload);
+    serialize_header(hdr, buf.data());
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(ThreadPlacementTest, CpuLists) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(parse_cpu_list("8, 0-3 ,2", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8}));
+    EXPECT_EQ(format_cpu_list(cpus), "0-3,8");
+    EXPECT_EQ(format_cpu_list({5}), "5");
+
+    EXPECT_FALSE(parse_cpu_list("", cpus));
+    EXPECT_FALSE(parse_cpu_list("3-1", cpus));
+    EXPECT_FALSE(parse_cpu_list("1,x", cpus));
+    EXPECT_FALSE(parse_cpu_list("-2", cpus));
+    EXPECT_FALSE(parse_cpu_list("99999", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8})); // unchanged on error
+}
+
+TEST(ThreadPlacementTest, Spec) {
+    ThreadPlacement p;
+    EXPECT_TRUE(p.empty());
+    EXPECT_EQ(p.spec(), "OFF");
+
+    ASSERT_TRUE(p.set("Worker=4-7; ingest=0,1;dispatcher=8;WRITER=9;control=9"));
+    EXPECT_FALSE(p.empty());
+    EXPECT_EQ(p.role(ThreadRole::INGEST), (std::vector<int>{0, 1}));
+    EXPECT_EQ(p.role(ThreadRole::WORKER), (std::vector<int>{4, 5, 6, 7}));
+    EXPECT_EQ(p.spec(), "ingest=0-1;worker=4-7;dispatcher=8;writer=9;control=9");
+
+    std::string error;
+    EXPECT_FALSE(p.set("ingest=0;gpu=1", &error));
+    EXPECT_EQ(error, "unknown thread role 'gpu'");
+    EXPECT_FALSE(p.set("ingest", &error));
+    EXPECT_EQ(error, "expected role=cpus in 'ingest'");
+    EXPECT_FALSE(p.set("ingest=a-b", &error));
+    EXPECT_EQ(error, "bad cpu list 'a-b'");
+    EXPECT_EQ(p.role(ThreadRole::DISPATCHER), (std::vector<int>{8})); // unchanged
+
+    ASSERT_TRUE(p.set("off"));
+    EXPECT_TRUE(p.empty());
+    EXPECT_STREQ(thread_role_name(ThreadRole::DISPATCHER), "dispatcher");
+}
+
+TEST(ThreadPlacementTest, PinsCallingThread) {
+    const int cpu = allowed_cpu();
+    ThreadPlacement p;
+    ASSERT_TRUE(p.set("ingest=" + std::to_string(cpu) + ";worker=1023"));
+
+    std::thread t([&] {
+        // Nothing configured for the role: left alone, not a failure
+        EXPECT_TRUE(p.pin(ThreadRole::DISPATCHER));
+        ASSERT_TRUE(p.pin(ThreadRole::INGEST, 3));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        ASSERT_EQ(::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set), 0);
+        EXPECT_EQ(CPU_COUNT(&set), 1);
+        EXPECT_TRUE(CPU_ISSET(cpu, &set));
+        EXPECT_EQ(::sched_getcpu(), cpu);
+        // A CPU the host does not have
+        EXPECT_FALSE(p.pin(ThreadRole::WORKER));
+
+        std::vector<uint8_t> buf(1 << 20, 1);
+        EXPECT_TRUE(place_on_local_node(buf.data(), buf.size()));
+        EXPECT_GE(current_numa_node(), 0);
+        EXPECT_LT(static_cast<std::size_t>(current_numa_node()), numa_node_count());
+    });
+    t.join();
+}
+
+TEST(ThreadPlacementTest, GatewayRunsPinned) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    const std::string cpu = std::to_string(allowed_cpu());
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.pipelined = true;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    ASSERT_TRUE(config.placement.set("ingest=" + cpu + ";worker=" + cpu + ";dispatcher=" + cpu));
+
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+    for (uint32_t i = 0; i < 100; ++i)
+        channel.sink().send(heartbeat(4, i));
+    for (int i = 0; i < 400 && gateway.stats().get_global_stats().rx_total < 100; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    EXPECT_EQ(gateway.stats().get_global_stats().rx_total, 100u);
+    EXPECT_NE(log.str().find("cpus=ingest=" + cpu), std::string::npos);
+    EXPECT_EQ(log.str().find("Cannot pin"), std::string::npos);
+}
@@ -0,0 +1,102 @@
+#include "gateway/timer_wheel.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace nng;
+
+TEST(TimerWheelTest, FiresInDeadlineTick) {
+    TimerWheel wheel(8, 10); // 10 ns ticks
+    wheel.arm(1, 55);
+    wheel.arm(2, 130);
+    EXPECT_EQ(wheel.size(), 2u);
+
+    std::vector<uint32_t> fired;
+    EXPECT_EQ(wheel.advance(49, fired), 0u);
+    EXPECT_EQ(wheel.advance(50, fired), 1u); // tick 5
+    EXPECT_EQ(fired, std::vector<uint32_t>{1});
+    EXPECT_FALSE(wheel.armed(1));
+    EXPECT_TRUE(wheel.armed(2));
+    EXPECT_EQ(wheel.advance(1000, fired), 1u);
+    EXPECT_EQ(fired.back(), 2u);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, RearmAndCancel) {
+    TimerWheel wheel(4, 1);
+    std::vector<uint32_t> fired;
+    wheel.arm(0, 100);
+    wheel.arm(1, 100);
+    // Pushed back before it fires, as on every frame of a live source
+    for (uint64_t t = 10; t < 5000; t += 10) {
+        wheel.arm(0, t + 100);
+        wheel.advance(t, fired);
+    }
+    EXPECT_EQ(fired, std::vector<uint32_t>{1});
+    wheel.cancel(0);
+    wheel.cancel(0);
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_EQ(wheel.advance(100000, fired), 0u);
+
+    // A deadline already passed fires in the next tick
+    wheel.arm(3, 5);
+    EXPECT_EQ(wheel.advance(100000, fired), 0u);
+    EXPECT_EQ(wheel.advance(100001, fired), 1u);
+}
+
+TEST(TimerWheelTest, SetNowOnlyWhenEmpty) {
+    TimerWheel wheel(2, 1);
+    wheel.set_now(1'000'000'000'000ULL);
+    wheel.arm(0, 1'000'000'000'050ULL);
+    wheel.set_now(0); // ignored: a timer is armed
+    std::vector<uint32_t> fired;
+    EXPECT_EQ(wheel.advance(1'000'000'000'049ULL, fired), 0u);
+    EXPECT_EQ(wheel.advance(1'000'000'000'050ULL, fired), 1u);
+}
+
+// Against a plain list of deadlines: every timer fires in exactly its
+// tick, over deadlines on every level and past the top one
+TEST(TimerWheelTest, MatchesReference) {
+    constexpr std::size_t N = 2000;
+    TimerWheel wheel(N, 1, 777);
+    std::mt19937_64 rng(5);
+    std::vector<uint64_t> deadline(N, 0);
+    const uint64_t spans[] = {50, 3000, 200000, 20000000, 1ULL << 32};
+    uint64_t now = 777;
+    for (uint32_t id = 0; id < N; ++id) {
+        deadline[id] = now + rng() % spans[id % 5];
+        wheel.arm(id, deadline[id]);
+    }
+
+    std::vector<uint32_t> fired;
+    std::size_t total = 0;
+    while (wheel.size() > 0) {
+        uint64_t step = 1 + rng() % 5000;
+        // Jump over empty stretches to keep the test quick
+        uint64_t next = UINT64_MAX;
+        for (uint32_t id = 0; id < N; ++id)
+            if (wheel.armed(id))
+                next = std::min(next, deadline[id]);
+        now = std::max(now + step, std::min(next, now + 1000000));
+        fired.clear();
+        total += wheel.advance(now, fired);
+        for (uint32_t id : fired) {
+            ASSERT_LE(deadline[id], now) << id;
+            deadline[id] = UINT64_MAX;
+        }
+        for (uint32_t id = 0; id < N; ++id) {
+            if (wheel.armed(id)) {
+                ASSERT_GT(deadline[id], now) << id;
+            }
+        }
+        // Some get re-armed while others are pending
+        if (total < N / 2 && !fired.empty()) {
+            uint32_t id = fired[0];
+            deadline[id] = now + 1 + rng() % 100000;
+            wheel.arm(id, deadline[id]);
+            --total;
+        }
+    }
+    EXPECT_EQ(total, N);
+}
@@ -0,0 +1,283 @@
+#include "common/track_delta.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include "gateway/telemetry_parser.h"
+#include "gateway/track_table.h"
+#include "sensor_sim/measurement_generator.h"
+#include "sensor_sim/object_generator.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+TrackPayload track(uint32_t id, uint16_t count, int32_t az, uint32_t range) {
+    TrackPayload t{};
+    t.track_id = id;
+    t.classification = static_cast<uint8_t>(TrackClass::FIXED_WING);
+    t.threat_level = static_cast<uint8_t>(ThreatLevel::MEDIUM);
+    t.iff_status = static_cast<uint8_t>(IffStatus::FOE);
+    t.azimuth_mdeg = az;
+    t.elevation_mdeg = 10000;
+    t.range_m = range;
+    t.velocity_mps = -200;
+    t.rcs_dbsm = 1000;
+    t.update_count = count;
+    return t;
+}
+
+bool same(const TrackPayload& a, const TrackPayload& b) {
+    return std::memcmp(&a, &b, sizeof(TrackPayload)) == 0;
+}
+
+// Decode one record of buf against base
+bool decode(const uint8_t* buf, std::size_t len, const TrackPayload* base, TrackPayload& out) {
+    TrackDelta d;
+    return read_track_delta(buf, len, d) == len && apply_track_delta(d, base, out);
+}
+
+std::vector<WorldObject> objects(std::size_t n) {
+    std::vector<WorldObject> out;
+    for (std::size_t i = 0; i < n; ++i) {
+        WorldObject obj{};
+        obj.id = static_cast<uint32_t>(i + 1);
+        obj.classification = TrackClass::UAV_LARGE;
+        obj.azimuth_deg = 10.0 + static_cast<double>(i);
+        obj.elevation_deg = 5.0;
+        obj.range_m = 20000.0 + 100.0 * static_cast<double>(i);
+        obj.speed_mps = 150.0;
+        obj.heading_deg = 180.0;
+        obj.rcs_dbsm = 5.0;
+        obj.is_hostile = (i % 2) == 0;
+        obj.noise_stddev = 1.0;
+        out.push_back(obj);
+    }
+    return out;
+}
+
+// Move every object a little, as between two radar ticks
+void advance(std::vector<WorldObject>& objs) {
+    for (auto& o : objs) {
+        o.range_m -= 3.0;
+        o.azimuth_deg += 0.01;
+    }
+}
+
+} // anonymous namespace
+
+TEST(TrackDeltaTest, RoundTrip) {
+    uint8_t buf[TRACK_DELTA_MAX_RECORD];
+    TrackPayload prev = track(77, 1, 45000, 5000);
+    TrackPayload out;
+
+    std::size_t key = write_track_delta(nullptr, prev, buf);
+    ASSERT_TRUE(decode(buf, key, nullptr, out));
+    EXPECT_TRUE(same(out, prev));
+
+    // Small moves: a few bytes
+    TrackPayload next = track(77, 2, 45012, 4997);
+    std::size_t n = write_track_delta(&prev, next, buf);
+    EXPECT_LE(n, 7u);
+    ASSERT_TRUE(decode(buf, n, &prev, out));
+    EXPECT_TRUE(same(out, next));
+
+    // Nothing but the count moved on: id, mask and ref
+    TrackPayload still = next;
+    still.update_count = 3;
+    EXPECT_EQ(write_track_delta(&next, still, buf), 3u);
+
+    // Every field at its extremes, counts wrapping
+    TrackPayload far = track(0xFFFFFFFF, 0, INT32_MIN, 0xFFFFFFFF);
+    far.velocity_mps = INT16_MAX;
+    far.rcs_dbsm = INT16_MIN;
+    far.classification = 8;
+    TrackPayload base = track(0xFFFFFFFF, 0xFFFF, INT32_MAX, 0);
+    base.velocity_mps = INT16_MIN;
+    n = write_track_delta(&base, far, buf);
+    EXPECT_LE(n, TRACK_DELTA_MAX_RECORD);
+    ASSERT_TRUE(decode(buf, n, &base, out));
+    EXPECT_TRUE(same(out, far));
+    n = write_track_delta(nullptr, far, buf);
+    ASSERT_TRUE(decode(buf, n, nullptr, out));
+    EXPECT_TRUE(same(out, far));
+}
+
+TEST(TrackDeltaTest, RejectsWrongBaseAndBadRecords) {
+    uint8_t buf[TRACK_DELTA_MAX_RECORD];
+    TrackPayload a = track(5, 10, 1000, 9000);
+    TrackPayload b = track(5, 11, 1010, 8990);
+    TrackPayload c = track(5, 12, 1020, 8980);
+    std::size_t n = write_track_delta(&b, c, buf);
+
+    TrackDelta d;
+    ASSERT_EQ(read_track_delta(buf, n, d), n);
+    EXPECT_FALSE(d.keyframe());
+    EXPECT_EQ(d.ref, 11);
+    TrackPayload out;
+    EXPECT_FALSE(apply_track_delta(d, nullptr, out)); // no state
+    EXPECT_FALSE(apply_track_delta(d, &a, out));      // missed update 11
+    EXPECT_TRUE(apply_track_delta(d, &b, out));
+
+    // Every truncation is caught
+    for (std::size_t len = 0; len < n; ++len)
+        EXPECT_EQ(read_track_delta(buf, len, d), 0u) << len;
+    // Overlong varint
+    const uint8_t overlong[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x01, TRACK_DELTA_KEY};
+    EXPECT_EQ(read_track_delta(overlong, sizeof(overlong), d), 0u);
+}
+
+TEST(TrackDeltaTest, EncoderKeyframes) {
+    TrackDeltaEncoder enc(4);
+    uint8_t buf[TRACK_DELTA_MAX_RECORD];
+    TrackDelta d;
+    std::vector<bool> keys;
+    for (uint16_t i = 1; i <= 9; ++i) {
+        std::size_t n = enc.encode(track(3, i, 100 * i, 5000 - i), buf);
+        ASSERT_GT(read_track_delta(buf, n, d), 0u);
+        keys.push_back(d.keyframe());
+    }
+    EXPECT_EQ(keys, (std::vector<bool>{true, false, false, false, true, false, false, false, true}));
+    EXPECT_EQ(enc.keyframes(), 3u);
+    EXPECT_EQ(enc.deltas(), 6u);
+
+    // Another track in the same slot, and reset(), start over with a keyframe
+    enc.encode(track(3 + 65536, 1, 0, 0), buf);
+    EXPECT_EQ(enc.keyframes(), 4u);
+    enc.reset();
+    std::size_t n = enc.encode(track(3, 10, 1000, 4990), buf);
+    ASSERT_GT(read_track_delta(buf, n, d), 0u);
+    EXPECT_TRUE(d.keyframe());
+}
+
+TEST(TrackDeltaTest, TableDecodesAgainstStoredTrack) {
+    TrackTable table(64, 0);
+    TrackDeltaEncoder enc(8);
+    uint8_t buf[TRACK_DELTA_MAX_RECORD];
+    TrackDelta d;
+    TrackPayload out;
+    TrackRecord rec;
+
+    std::vector<TrackPayload> sent;
+    for (uint16_t i = 1; i <= 12; ++i)
+        sent.push_back(track(42, i, 3000 + 7 * i, 12000 - 5 * i));
+
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+        std::size_t n = enc.encode(sent[i], buf);
+        ASSERT_EQ(read_track_delta(buf, n, d), n);
+        // Update 4 is lost: 5..8 have no base, 9 is a keyframe
+        if (i == 3)
+            continue;
+        bool ok = table.apply(9, d, 1000 + i, out);
+        EXPECT_EQ(ok, i < 3 || i >= 8) << i;
+        if (ok) {
+            EXPECT_TRUE(same(out, sent[i]));
+        }
+        ASSERT_TRUE(table.find(9, 42, rec));
+        EXPECT_TRUE(same(rec.track, sent[i < 3 || i >= 8 ? i : 2]));
+    }
+    EXPECT_EQ(table.delta_rejected(), 4u);
+}
+
+TEST(TrackDeltaTest, GeneratorPacksTracks) {
+    std::vector<WorldObject> objs = objects(200);
+    MeasurementGenerator full(7, 42);
+    MeasurementGenerator packed(7, 42);
+    packed.set_track_delta(16);
+
+    TrackTable table(1024, 0);
+    std::size_t full_bytes = 0;
+    std::size_t packed_bytes = 0;
+    for (int tick = 0; tick < 20; ++tick) {
+        auto expect = full.generate_tracks(objs, 1000 + tick);
+        FrameArena arena;
+        packed.generate_tracks(objs, 1000 + tick, arena);
+        for (const auto& f : expect)
+            full_bytes += f.size();
+        packed_bytes += arena.bytes();
+
+        // The packed frames carry the same tracks
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < arena.size(); ++i) {
+            ParsedFrame pf;
+            ASSERT_EQ(parse_frame(arena.data(i), arena.length(i), false, pf), ParseError::OK);
+            ASSERT_EQ(pf.header.msg_type, static_cast<uint8_t>(MsgType::TRACK_DELTA));
+            EXPECT_LE(pf.header.payload_len, MAX_PAYLOAD_SIZE);
+            TrackDelta d;
+            TrackPayload out;
+            for (std::size_t at = 0; at < pf.header.payload_len;) {
+                std::size_t n = read_track_delta(pf.payload_ptr + at, pf.header.payload_len - at, d);
+                ASSERT_GT(n, 0u);
+                at += n;
+                ASSERT_TRUE(table.apply(7, d, 1000 + tick, out));
+                ASSERT_LT(next, expect.size());
+                EXPECT_TRUE(same(out, deserialize_track(expect[next].data() + FRAME_HEADER_SIZE)));
+                ++next;
+            }
+        }
+        EXPECT_EQ(next, objs.size());
+        advance(objs);
+    }
+    // Header per frame, not per track: several times smaller
+    EXPECT_LT(packed_bytes * 4, full_bytes);
+    EXPECT_EQ(packed.track_delta()->keyframes(), 200u * 2);
+
+    // The vector overload and one-object frames encode the same way
+    MeasurementGenerator single(7, 42);
+    single.set_track_delta(16);
+    EXPECT_EQ(single.generate_tracks({objs[0]}, 5).size(), 1u);
+    FrameArena one;
+    single.generate_track(objs[0], 6, one);
+    ASSERT_EQ(one.size(), 1u);
+    EXPECT_LT(one.length(0), FRAME_HEADER_SIZE + sizeof(TrackPayload));
+}
+
+TEST(TrackDeltaTest, GatewayKeepsPictureFromDeltas) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    MemoryFrameChannel channel(1024);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    std::vector<WorldObject> objs = objects(300);
+    MeasurementGenerator full(3, 42);
+    MeasurementGenerator packed(3, 42);
+    packed.set_track_delta(8);
+    std::vector<std::vector<uint8_t>> expect;
+    uint64_t frames = 0;
+    for (int tick = 0; tick < 10; ++tick) {
+        expect = full.generate_tracks(objs, 1000 + tick);
+        for (const auto& f : packed.generate_tracks(objs, 1000 + tick)) {
+            channel.sink().send(f);
+            ++frames;
+        }
+        advance(objs);
+    }
+    auto& stats = gateway.stats();
+    for (int i = 0; i < 400 && stats.get_global_stats().rx_total < frames; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    EXPECT_EQ(stats.get_global_stats().rx_total, frames);
+    EXPECT_EQ(gateway.tracks().delta_rejected(), 0u);
+    std::vector<TrackRecord> picture;
+    gateway.tracks().snapshot(picture, TrackQuery{});
+    ASSERT_EQ(picture.size(), objs.size());
+    for (const TrackRecord& r : picture) {
+        const TrackPayload want = deserialize_track(expect[r.track.track_id - 1].data() + FRAME_HEADER_SIZE);
+        EXPECT_TRUE(same(r.track, want)) << r.track.track_id;
+        EXPECT_EQ(r.update_count, 10u);
+    }
+}
@@ -0,0 +1,208 @@
+#include "gateway/track_table.h"
+#include "gateway/gateway.h"
+#include "gateway/memory_channel.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+using namespace nng;
+
+namespace {
+
+TrackPayload track(uint32_t id, uint8_t threat = 1, uint32_t range_m = 1000) {
+    TrackPayload t{};
+    t.track_id = id;
+    t.threat_level = threat;
+    t.range_m = range_m;
+    t.azimuth_mdeg = static_cast<int32_t>(range_m);
+    return t;
+}
+
+std::vector<uint8_t> track_frame(uint16_t src_id, uint32_t seq, const TrackPayload& t) {
+    std::vector<uint8_t> buf(FRAME_HEADER_SIZE + sizeof(TrackPayload));
+    TelemetryHeader hdr{};
+    hdr.version = PROTOCOL_VERSION;
+    hdr.msg_type = static_cast<uint8_t>(MsgType::TRACK);
+    hdr.src_id = src_id;
+    hdr.seq = seq;
+    hdr.payload_len = sizeof(TrackPayload);
+    serialize_header(hdr, buf.data());
+    std::memcpy(buf.data() + FRAME_HEADER_SIZE, &t, sizeof(t));
+    return buf;
+}
+
+} // anonymous namespace
+
+TEST(TrackTableTest, UpdateAndFind) {
+    TrackTable table(64, 0);
+    EXPECT_EQ(table.capacity(), 64u);
+    EXPECT_TRUE(table.update(1, track(7, 2, 500), 100));
+    EXPECT_TRUE(table.update(2, track(7, 3, 900), 150));
+    EXPECT_TRUE(table.update(1, track(7, 4, 600), 200));
+    EXPECT_EQ(table.size(), 2u);
+
+    TrackRecord rec;
+    ASSERT_TRUE(table.find(1, 7, rec));
+    EXPECT_EQ(rec.src_id, 1u);
+    EXPECT_EQ(rec.update_count, 2u);
+    EXPECT_EQ(rec.last_update_ns, 200u);
+    EXPECT_EQ(rec.track.threat_level, 4u);
+    EXPECT_EQ(rec.track.range_m, 600u);
+    ASSERT_TRUE(table.find(2, 7, rec));
+    EXPECT_EQ(rec.update_count, 1u);
+    EXPECT_FALSE(table.find(3, 7, rec));
+}
+
+TEST(TrackTableTest, FullTableDropsNewTracks) {
+    TrackTable table(16, 0); // room for 12
+    for (uint32_t id = 0; id < 12; ++id)
+        EXPECT_TRUE(table.update(1, track(id), 0));
+    EXPECT_FALSE(table.update(1, track(99), 0));
+    EXPECT_EQ(table.dropped(), 1u);
+    // Known tracks still update
+    EXPECT_TRUE(table.update(1, track(3), 1));
+    EXPECT_EQ(table.size(), 12u);
+}
+
+TEST(TrackTableTest, RemoveKeepsClustersReachable) {
+    // Every removal order over a crowded table leaves the rest findable
+    for (uint32_t drop = 0; drop < 12; ++drop) {
+        TrackTable table(16, 0);
+        for (uint32_t id = 0; id < 12; ++id)
+            table.update(5, track(id), 0);
+        ASSERT_TRUE(table.remove(5, drop));
+        EXPECT_FALSE(table.remove(5, drop));
+        TrackRecord rec;
+        for (uint32_t id = 0; id < 12; ++id)
+            EXPECT_EQ(table.find(5, id, rec), id != drop) << "drop=" << drop << " id=" << id;
+        EXPECT_EQ(table.size(), 11u);
+    }
+}
+
+TEST(TrackTableTest, StaleTracksExpire) {
+    TrackTable table(16, 1000, 10);
+    table.update(1, track(1), 0);
+    table.update(1, track(2), 0);
+    table.update(1, track(3), 0);
+    // Snapshots leave stale records out straight away
+    std::vector<TrackRecord> out;
+    table.scan(out, TrackQuery{0, 5000});
+    EXPECT_TRUE(out.empty());
+
+    // Track 3 is kept alive; the others time out 1000 ns after their update
+    table.update(1, track(3), 900);
+    std::vector<TrackRecord> lost;
+    EXPECT_EQ(table.expire(999, lost), 0u);
+    EXPECT_EQ(table.expire(1010, lost), 2u);
+    ASSERT_EQ(lost.size(), 2u);
+    EXPECT_EQ(lost[0].src_id, 1u);
+    EXPECT_NE(lost[0].track.track_id, 3u);
+    EXPECT_NE(lost[1].track.track_id, 3u);
+    EXPECT_EQ(table.size(), 1u);
+    EXPECT_EQ(table.expired(), 2u);
+    TrackRecord rec;
+    EXPECT_TRUE(table.find(1, 3, rec));
+    EXPECT_FALSE(table.find(1, 1, rec));
+
+    lost.clear();
+    EXPECT_EQ(table.expire(1910, lost), 1u);
+    EXPECT_EQ(table.size(), 0u);
+    // Freed timers are reused
+    for (uint32_t id = 0; id < 12; ++id)
+        EXPECT_TRUE(table.update(2, track(id), 2000));
+    EXPECT_EQ(table.expire(3010, lost), 12u);
+}
+
+TEST(TrackPictureTest, SnapshotMergesFiltersAndSorts) {
+    TrackPicture picture(64, 0);
+    picture.set_writers(2);
+    picture.table(0).update(1, track(10, 1), 100);
+    picture.table(0).update(1, track(11, 4), 100);
+    picture.table(0).update(2, track(10, 3, 111), 100);
+    // Seen by the other worker too, more recently
+    picture.table(1).update(2, track(10, 3, 222), 300);
+    picture.table(1).update(3, track(1, 4), 100);
+
+    std::vector<TrackRecord> out;
+    picture.snapshot(out, TrackQuery{});
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_EQ(picture.size(), 5u);
+    // Threat 4 first (src 1 before 3), then 3, then 1
+    EXPECT_EQ(out[0].src_id, 1u);
+    EXPECT_EQ(out[0].track.track_id, 11u);
+    EXPECT_EQ(out[1].src_id, 3u);
+    EXPECT_EQ(out[2].src_id, 2u);
+    EXPECT_EQ(out[2].track.range_m, 222u);
+    EXPECT_EQ(out[3].track.threat_level, 1u);
+
+    picture.snapshot(out, TrackQuery{3, 0});
+    EXPECT_EQ(out.size(), 3u);
+}
+
+TEST(TrackTableTest, ReadersNeverSeeTornRecords) {
+    TrackTable table(1024, 0);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint32_t round = 1; round < 2000; ++round)
+            for (uint32_t id = 0; id < 256; ++id) {
+                // range and azimuth always written together
+                table.update(1, track(id, 1, round * 1000 + id), round);
+                if (round % 7 == 0 && id % 5 == 0)
+                    table.remove(1, id);
+            }
+        done = true;
+    });
+
+    std::vector<TrackRecord> out;
+    std::size_t scans = 0;
+    while (!done.load() || scans == 0) {
+        out.clear();
+        table.scan(out, TrackQuery{});
+        for (const auto& r : out) {
+            const TrackPayload t = r.track;
+            ASSERT_EQ(static_cast<uint32_t>(t.azimuth_mdeg), t.range_m);
+            ASSERT_EQ(t.range_m % 1000, t.track_id);
+        }
+        ++scans;
+    }
+    writer.join();
+    EXPECT_GT(scans, 0u);
+}
+
+TEST(TrackPictureTest, GatewayKeepsLatestTrackState) {
+    std::ostringstream log;
+    Logger::instance().set_output(log);
+
+    MemoryFrameChannel channel(256);
+    GatewayConfig config;
+    config.crc_enabled = false;
+    config.track_capacity = 1024;
+    config.source_factory = [&channel](std::size_t) { return channel.source(10); };
+    Gateway gateway(config);
+    std::thread t([&gateway] { gateway.run(); });
+    for (int i = 0; i < 200 && !gateway.is_running(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(gateway.is_running());
+
+    uint32_t seq = 0;
+    for (uint32_t round = 0; round < 3; ++round)
+        for (uint32_t id = 1; id <= 10; ++id)
+            channel.sink().send(track_frame(4, seq++, track(id, 2, 100 * round + id)));
+    // A late frame (reorder) does not roll a track back
+    channel.sink().send(track_frame(4, 5, track(1, 2, 1)));
+    for (int i = 0; i < 400 && gateway.stats().get_global_stats().rx_total < 31; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    gateway.stop();
+    t.join();
+    Logger::instance().set_output(std::cout);
+
+    std::vector<TrackRecord> out;
+    gateway.tracks().snapshot(out, TrackQuery{});
+    ASSERT_EQ(out.size(), 10u);
+    EXPECT_EQ(out[0].src_id, 4u);
+    EXPECT_EQ(out[0].track.track_id, 1u);
+    EXPECT_EQ(out[0].track.range_m, 201u);
+    EXPECT_EQ(out[0].update_count, 3u);
+}
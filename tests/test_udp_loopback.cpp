@@ -71,6 +71,79 @@ TEST(UdpLoopbackTest, SendMultipleDatagrams) {
     sink.close();
 }
 
+TEST(UdpLoopbackTest, ReceiveBatchDrainsQueuedDatagrams) {
+    UdpFrameSource source;
+    UdpFrameSink sink;
+
+    uint16_t port = 19880;
+    ASSERT_TRUE(source.bind(port));
+    source.set_timeout_ms(1000);
+    ASSERT_TRUE(sink.connect("127.0.0.1", port));
+
+    const int count = 20;
+    for (int i = 0; i < count; ++i) {
+        std::vector<uint8_t> send_buf(static_cast<std::size_t>(i + 1), static_cast<uint8_t>(i));
+        EXPECT_TRUE(sink.send(send_buf));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // All queued datagrams should come back in one call, in order
+    FrameBatch batch(64);
+    std::size_t n = source.receive_batch(batch);
+    ASSERT_EQ(n, static_cast<std::size_t>(count));
+    ASSERT_EQ(batch.size(), n);
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(batch[i].len, static_cast<std::size_t>(i + 1));
+        EXPECT_EQ(batch[i].data[0], static_cast<uint8_t>(i));
+        EXPECT_EQ(batch[i].data, batch.slot(i)); // received in place
+    }
+
+    source.close();
+    sink.close();
+}
+
+TEST(UdpLoopbackTest, ReceiveBatchRespectsCapacity) {
+    UdpFrameSource source;
+    UdpFrameSink sink;
+
+    uint16_t port = 19881;
+    ASSERT_TRUE(source.bind(port));
+    source.set_timeout_ms(1000);
+    ASSERT_TRUE(sink.connect("127.0.0.1", port));
+
+    for (int i = 0; i < 10; ++i) {
+        std::vector<uint8_t> send_buf = {static_cast<uint8_t>(i)};
+        EXPECT_TRUE(sink.send(send_buf));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    FrameBatch small(4);
+    EXPECT_EQ(source.receive_batch(small), 4u);
+    EXPECT_EQ(small[0].data[0], 0);
+    FrameBatch large(64);
+    EXPECT_EQ(source.receive_batch(large), 6u);
+    EXPECT_EQ(large[0].data[0], 4);
+    EXPECT_EQ(large[5].data[0], 9);
+
+    source.close();
+    sink.close();
+}
+
+TEST(UdpLoopbackTest, ReceiveBatchTimeout) {
+    UdpFrameSource source;
+
+    ASSERT_TRUE(source.bind(19882));
+    source.set_timeout_ms(100);
+
+    FrameBatch batch(64);
+    EXPECT_EQ(source.receive_batch(batch), 0u);
+    EXPECT_TRUE(batch.empty());
+
+    source.close();
+}
+
 TEST(UdpLoopbackTest, ReceiveTimeout) {
     UdpFrameSource source;
 
@@ -142,3 +215,165 @@ TEST(UdpLoopbackTest, SinkConnectAndClose) {
     sink.close();
     EXPECT_FALSE(sink.is_open());
 }
+
+TEST(UdpLoopbackTest, BusyPollReceivesBatch) {
+    UdpFrameSource source;
+    ASSERT_TRUE(source.bind(19883));
+    source.set_timeout_ms(1000);
+    source.set_busy_poll_us(50000);
+
+    UdpFrameSink sink;
+    ASSERT_TRUE(sink.connect("127.0.0.1", 19883));
+
+    // Datagram arrives while the receiver is spinning
+    std::thread sender([&sink]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        sink.send({0xAB, 0xCD});
+    });
+
+    FrameBatch batch(8);
+    EXPECT_EQ(source.receive_batch(batch), 1u);
+    ASSERT_EQ(batch[0].len, 2u);
+    EXPECT_EQ(batch[0].data[0], 0xAB);
+    sender.join();
+
+    sink.send({0x01});
+    std::vector<uint8_t> buf;
+    EXPECT_TRUE(source.receive(buf));
+    EXPECT_EQ(buf, std::vector<uint8_t>{0x01});
+}
+
+TEST(UdpLoopbackTest, BusyPollFallsBackToTimeout) {
+    UdpFrameSource source;
+    ASSERT_TRUE(source.bind(19884));
+    source.set_timeout_ms(100);
+    source.set_busy_poll_us(20000);
+
+    // Spin budget, then the normal blocking timeout
+    FrameBatch batch(8);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(source.receive_batch(batch), 0u);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(elapsed, 100);
+    EXPECT_LE(elapsed, 600);
+}
+
+TEST(UdpLoopbackTest, ReceiveBatchCarriesKernelTimestamp) {
+    UdpFrameSource source;
+    ASSERT_TRUE(source.bind(19885));
+    source.set_timeout_ms(1000);
+
+    UdpFrameSink sink;
+    ASSERT_TRUE(sink.connect("127.0.0.1", 19885));
+
+    auto realtime = []() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    uint64_t before = realtime();
+    EXPECT_TRUE(sink.send({1, 2, 3}));
+    EXPECT_TRUE(sink.send({4, 5, 6}));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    FrameBatch batch(8);
+    ASSERT_EQ(source.receive_batch(batch), 2u);
+    uint64_t after = realtime();
+
+    // Stamped by the kernel on arrival, before we dequeued
+    EXPECT_GE(batch[0].rx_ts_ns, before);
+    EXPECT_LE(batch[1].rx_ts_ns, after - 10000000ULL);
+    EXPECT_LE(batch[0].rx_ts_ns, batch[1].rx_ts_ns);
+}
+
+// Drain count datagrams from source, checking each is {i, i, ...} of len
+static void expect_frames(UdpFrameSource& source, int count, std::size_t len) {
+    FrameBatch batch(64);
+    int received = 0;
+    while (received < count) {
+        std::size_t n = source.receive_batch(batch);
+        ASSERT_GT(n, 0u) << "stalled after " << received << " frames";
+        for (std::size_t i = 0; i < n; ++i, ++received) {
+            ASSERT_EQ(batch[i].len, len);
+            EXPECT_EQ(batch[i].data[0], static_cast<uint8_t>(received));
+        }
+    }
+}
+
+TEST(UdpLoopbackTest, SendBatchUsesOneCallPerChunk) {
+    UdpFrameSource source;
+    ASSERT_TRUE(source.bind(19886));
+    source.set_timeout_ms(1000);
+
+    UdpFrameSink sink;
+    ASSERT_TRUE(sink.connect("127.0.0.1", 19886));
+
+    // More than one sendmmsg() chunk
+    const int count = 150;
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < count; ++i)
+        frames.push_back(std::vector<uint8_t>(40, static_cast<uint8_t>(i)));
+    EXPECT_EQ(sink.send_batch(frames), static_cast<std::size_t>(count));
+
+    expect_frames(source, count, 40);
+}
+
+TEST(UdpLoopbackTest, SendBatchGsoSplitsIntoFrames) {
+    UdpFrameSource source;
+    ASSERT_TRUE(source.bind(19887));
+    source.set_timeout_ms(1000);
+
+    UdpFrameSink sink;
+    ASSERT_TRUE(sink.connect("127.0.0.1", 19887));
+    sink.set_gso(true);
+
+    // Same-size frames, one odd one out in the middle, then more than one run
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < 100; ++i)
+        frames.push_back(std::vector<uint8_t>(64, static_cast<uint8_t>(i)));
+    frames[50].resize(10);
+    EXPECT_EQ(sink.send_batch(frames), frames.size());
+
+    // Kernels without UDP GSO fall back to sendmmsg: same datagrams either way
+    FrameBatch batch(64);
+    int received = 0;
+    while (received < 100) {
+        std::size_t n = source.receive_batch(batch);
+        ASSERT_GT(n, 0u) << "stalled after " << received << " frames";
+        for (std::size_t i = 0; i < n; ++i, ++received) {
+            EXPECT_EQ(batch[i].len, received == 50 ? 10u : 64u);
+            EXPECT_EQ(batch[i].data[0], static_cast<uint8_t>(received));
+        }
+    }
+}
+
+TEST(UdpLoopbackTest, SendBatchSkipsAFrameThatFails) {
+    UdpFrameSource source;
+    ASSERT_TRUE(source.bind(19889));
+    source.set_timeout_ms(1000);
+
+    UdpFrameSink sink;
+    ASSERT_TRUE(sink.connect("127.0.0.1", 19889));
+
+    // Frame 4 is over the UDP limit: sendmmsg() stops there, the rest still go
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < 10; ++i)
+        frames.push_back(std::vector<uint8_t>(40, static_cast<uint8_t>(i)));
+    frames[4].assign(70000, 4);
+    EXPECT_EQ(sink.send_batch(frames), 9u);
+
+    FrameBatch batch(64);
+    int received = 0;
+    while (received < 9) {
+        std::size_t n = source.receive_batch(batch);
+        ASSERT_GT(n, 0u) << "stalled after " << received << " frames";
+        for (std::size_t i = 0; i < n; ++i, ++received)
+            EXPECT_EQ(batch[i].data[0], static_cast<uint8_t>(received < 4 ? received : received + 1));
+    }
+}
+
+TEST(UdpLoopbackTest, SendBatchOnClosedSinkSendsNothing) {
+    UdpFrameSink sink;
+    std::vector<std::vector<uint8_t>> frames = {{1}, {2}};
+    EXPECT_EQ(sink.send_batch(frames), 0u);
+}
@@ -104,3 +104,82 @@ TEST(WorldModel, ManyObjectsSomeExpire) {
     // 10 even-ID objects should be expired (lifetime=2, t=3)
     EXPECT_EQ(wm.active_count(), 10u);
 }
+
+TEST(WorldModel, AzimuthWrapsBothWays) {
+    WorldModel wm;
+    // Counter-clockwise from 1 degree, and clockwise from 359
+    WorldObject ccw = make_obj(1, 1000.0, 100.0, -90.0, 60.0);
+    ccw.azimuth_deg = 1.0;
+    WorldObject cw = make_obj(2, 1000.0, 100.0, 90.0, 60.0);
+    cw.azimuth_deg = 359.0;
+    wm.add_object(ccw);
+    wm.add_object(cw);
+
+    wm.tick(1.0, 1.0);
+    double step_deg = 100.0 / 1000.0 * 180.0 / 3.14159265358979323846;
+    for (const auto& obj : wm.objects()) {
+        if (obj.id == 1)
+            EXPECT_NEAR(obj.azimuth_deg, 361.0 - step_deg, 1e-9);
+        else
+            EXPECT_NEAR(obj.azimuth_deg, step_deg - 1.0, 1e-9);
+    }
+}
+
+TEST(WorldModel, SwapRemoveKeepsColumnsAligned) {
+    WorldModel wm;
+    for (uint32_t i = 0; i < 10; ++i) {
+        // Every third object dies at t=3; each range encodes its id
+        double lt = (i % 3 == 0) ? 2.0 : 100.0;
+        wm.add_object(make_obj(i + 1, 10000.0 + i, 0.0, 0.0, lt));
+    }
+    wm.tick(0.1, 3.0);
+    ASSERT_EQ(wm.active_count(), 6u);
+
+    const auto& objs = wm.objects();
+    const WorldKinematics& kin = wm.kinematics();
+    ASSERT_EQ(objs.size(), kin.size());
+    std::vector<bool> seen(11, false);
+    for (std::size_t i = 0; i < objs.size(); ++i) {
+        EXPECT_NE((objs[i].id - 1) % 3, 0u);
+        EXPECT_DOUBLE_EQ(kin.range_m[i], 10000.0 + (objs[i].id - 1));
+        EXPECT_DOUBLE_EQ(objs[i].range_m, kin.range_m[i]);
+        EXPECT_EQ(kin.expires_s[i], 100.0);
+        seen[objs[i].id] = true;
+    }
+    for (uint32_t id : {2u, 3u, 5u, 6u, 8u, 9u})
+        EXPECT_TRUE(seen[id]);
+}
+
+TEST(WorldModel, StepWithoutViewThenAdd) {
+    WorldModel wm;
+    wm.add_object(make_obj(1, 10000.0, 100.0, 0.0, 60.0));
+    wm.step(1.0, 1.0);
+    wm.step(1.0, 2.0);
+    EXPECT_DOUBLE_EQ(wm.kinematics().range_m[0], 10200.0);
+
+    // Adding brings the existing objects up to date first
+    wm.add_object(make_obj(2, 5000.0, 0.0, 0.0, 60.0));
+    ASSERT_EQ(wm.objects().size(), 2u);
+    EXPECT_NEAR(wm.objects()[0].range_m, 10200.0, 1e-9);
+    EXPECT_DOUBLE_EQ(wm.objects()[1].range_m, 5000.0);
+}
+
+TEST(WorldModel, HundredThousandObjects) {
+    WorldModel wm;
+    const uint32_t n = 100000;
+    wm.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        // Half head inbound fast enough to cross MIN_RANGE_M within 10 s
+        bool inbound = i % 2 == 0;
+        wm.add_object(make_obj(i + 1, inbound ? 500.0 : 20000.0, 100.0,
+                               inbound ? 180.0 : static_cast<double>(i % 360), 1000.0));
+    }
+    for (int t = 1; t <= 10; ++t)
+        wm.step(1.0, t);
+    EXPECT_EQ(wm.active_count(), n / 2);
+    for (const auto& obj : wm.objects()) {
+        EXPECT_GE(obj.azimuth_deg, 0.0);
+        EXPECT_LT(obj.azimuth_deg, 360.0);
+        EXPECT_GT(obj.range_m, WorldModel::MIN_RANGE_M);
+    }
+}